@@ -15,5 +15,6 @@
 #include <anki/collision/Cone.h>
 
 #include <anki/collision/Functions.h>
+#include <anki/collision/FunctionsSoa.h>
 
 /// @defgroup collision Collision detection module
@@ -141,8 +141,9 @@
 #endif
 
 // Graphics backend
-#define ANKI_GR_BACKEND_GL 0
-#define ANKI_GR_BACKEND_VULKAN 1
+#define ANKI_GR_BACKEND_GL ${_ANKI_GR_BACKEND_GL}
+#define ANKI_GR_BACKEND_VULKAN ${_ANKI_GR_BACKEND_VULKAN}
+#define ANKI_GR_BACKEND_NULL ${_ANKI_GR_BACKEND_NULL}
 
 // Some compiler attributes
 #if ANKI_COMPILER_GCC_COMPATIBLE
@@ -32,3 +32,6 @@
 
 /// @defgroup vulkan Vulkan backend
 /// @ingroup graphics
+
+/// @defgroup null Null backend
+/// @ingroup graphics
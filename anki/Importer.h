@@ -6,5 +6,6 @@
 #pragma once
 
 #include <anki/importer/GltfImporter.h>
+#include <anki/importer/ImageImporter.h>
 
 /// @defgroup importer Importers
@@ -0,0 +1,179 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/collision/FunctionsSoa.h>
+#include <anki/collision/Functions.h>
+#include <anki/collision/Aabb.h>
+#include <anki/collision/Sphere.h>
+#include <anki/collision/Cone.h>
+
+namespace anki
+{
+
+/// Write the results of the 4 volumes that start from "first". Only the bits inside [begin, end) are written.
+static void writeMask(U32 first, U32 begin, U32 end, U32 results, WeakArray<U64> mask)
+{
+	ANKI_ASSERT((first % 4) == 0);
+	U32 valid = 0xFu;
+	if(first < begin)
+	{
+		valid &= 0xFu << (begin - first);
+	}
+
+	if(first + 4 > end)
+	{
+		valid &= 0xFu >> (first + 4 - end);
+	}
+
+	U64& word = mask[first / 64];
+	const U32 shift = first % 64;
+	word = (word & ~(U64(valid) << shift)) | (U64(results & valid) << shift);
+}
+
+#if !ANKI_SIMD_SSE
+static void writeBit(U32 idx, Bool set, WeakArray<U64> mask)
+{
+	const U64 bit = U64(1) << U64(idx % 64);
+	if(set)
+	{
+		mask[idx / 64] |= bit;
+	}
+	else
+	{
+		mask[idx / 64] &= ~bit;
+	}
+}
+#endif
+
+void testCollisionSoa(const Sphere& sphere, const AabbSoa& boxes, U32 begin, U32 end, WeakArray<U64> mask)
+{
+	ANKI_ASSERT(begin <= end && end <= mask.getSize() * 64);
+	ANKI_ASSERT(sphere.getCenter().w() == 0.0f);
+
+#if ANKI_SIMD_SSE
+	// Same math as testCollision(const Aabb&, const Sphere&): find the closest point of the box and compare its
+	// squared distance with the squared radius
+	const Array<__m128, 3> center = {_mm_set1_ps(sphere.getCenter().x()), _mm_set1_ps(sphere.getCenter().y()),
+									 _mm_set1_ps(sphere.getCenter().z())};
+	const __m128 radiusSq = _mm_set1_ps(sphere.getRadius() * sphere.getRadius());
+
+	for(U32 i = begin & ~3u; i < end; i += 4)
+	{
+		Array<__m128, 3> sub;
+		for(U32 axis = 0; axis < 3; ++axis)
+		{
+			const __m128 boxMin = _mm_loadu_ps(boxes.m_min[axis] + i);
+			const __m128 boxMax = _mm_loadu_ps(boxes.m_max[axis] + i);
+			const __m128 gt = _mm_cmpgt_ps(center[axis], boxMax);
+			const __m128 lt = _mm_cmplt_ps(center[axis], boxMin);
+
+			const __m128 m = _mm_or_ps(_mm_and_ps(gt, boxMax), _mm_andnot_ps(gt, center[axis]));
+			const __m128 closestPoint = _mm_or_ps(_mm_and_ps(lt, boxMin), _mm_andnot_ps(lt, m));
+
+			sub[axis] = _mm_sub_ps(center[axis], closestPoint);
+		}
+
+		// Add in the order of _mm_dp_ps
+		const __m128 lengthSq =
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(sub[0], sub[0]), _mm_mul_ps(sub[1], sub[1])), _mm_mul_ps(sub[2], sub[2]));
+
+		writeMask(i, begin, end, U32(_mm_movemask_ps(_mm_cmple_ps(lengthSq, radiusSq))), mask);
+	}
+#else
+	for(U32 i = begin; i < end; ++i)
+	{
+		const Aabb box(Vec4(boxes.m_min[0][i], boxes.m_min[1][i], boxes.m_min[2][i], 0.0f),
+					   Vec4(boxes.m_max[0][i], boxes.m_max[1][i], boxes.m_max[2][i], 0.0f));
+		writeBit(i, testCollision(box, sphere), mask);
+	}
+#endif
+}
+
+void testCollisionSoa(const Aabb& aabb, const AabbSoa& boxes, U32 begin, U32 end, WeakArray<U64> mask)
+{
+	ANKI_ASSERT(begin <= end && end <= mask.getSize() * 64);
+
+#if ANKI_SIMD_SSE
+	const Array<__m128, 3> aabbMin = {_mm_set1_ps(aabb.getMin().x()), _mm_set1_ps(aabb.getMin().y()),
+									  _mm_set1_ps(aabb.getMin().z())};
+	const Array<__m128, 3> aabbMax = {_mm_set1_ps(aabb.getMax().x()), _mm_set1_ps(aabb.getMax().y()),
+									  _mm_set1_ps(aabb.getMax().z())};
+
+	for(U32 i = begin & ~3u; i < end; i += 4)
+	{
+		__m128 separated = _mm_setzero_ps();
+		for(U32 axis = 0; axis < 3; ++axis)
+		{
+			const __m128 gt0 = _mm_cmpgt_ps(aabbMin[axis], _mm_loadu_ps(boxes.m_max[axis] + i));
+			const __m128 gt1 = _mm_cmpgt_ps(_mm_loadu_ps(boxes.m_min[axis] + i), aabbMax[axis]);
+			separated = _mm_or_ps(separated, _mm_or_ps(gt0, gt1));
+		}
+
+		writeMask(i, begin, end, ~U32(_mm_movemask_ps(separated)), mask);
+	}
+#else
+	for(U32 i = begin; i < end; ++i)
+	{
+		const Aabb box(Vec4(boxes.m_min[0][i], boxes.m_min[1][i], boxes.m_min[2][i], 0.0f),
+					   Vec4(boxes.m_max[0][i], boxes.m_max[1][i], boxes.m_max[2][i], 0.0f));
+		writeBit(i, testCollision(aabb, box), mask);
+	}
+#endif
+}
+
+void testCollisionSoa(const Cone& cone, const SphereSoa& spheres, U32 begin, U32 end, WeakArray<U64> mask)
+{
+	ANKI_ASSERT(begin <= end && end <= mask.getSize() * 64);
+	ANKI_ASSERT(cone.getOrigin().w() == 0.0f && cone.getDirection().w() == 0.0f);
+
+#if ANKI_SIMD_SSE
+	// Same math as testCollision(const Sphere&, const Cone&)
+	const F32 coneAngle = cone.getAngle() / 2.0f;
+	const __m128 cosAngle = _mm_set1_ps(cos(coneAngle));
+	const __m128 sinAngle = _mm_set1_ps(sin(coneAngle));
+	const __m128 length = _mm_set1_ps(cone.getLength());
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const Array<__m128, 3> origin = {_mm_set1_ps(cone.getOrigin().x()), _mm_set1_ps(cone.getOrigin().y()),
+									 _mm_set1_ps(cone.getOrigin().z())};
+	const Array<__m128, 3> dir = {_mm_set1_ps(cone.getDirection().x()), _mm_set1_ps(cone.getDirection().y()),
+								  _mm_set1_ps(cone.getDirection().z())};
+
+	for(U32 i = begin & ~3u; i < end; i += 4)
+	{
+		Array<__m128, 3> v;
+		for(U32 axis = 0; axis < 3; ++axis)
+		{
+			v[axis] = _mm_sub_ps(_mm_loadu_ps(spheres.m_center[axis] + i), origin[axis]);
+		}
+
+		// Add in the order of _mm_dp_ps
+		const __m128 vLenSq =
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(v[0], v[0]), _mm_mul_ps(v[1], v[1])), _mm_mul_ps(v[2], v[2]));
+		const __m128 v1Len =
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(v[0], dir[0]), _mm_mul_ps(v[1], dir[1])), _mm_mul_ps(v[2], dir[2]));
+
+		const __m128 distanceClosestPoint =
+			_mm_sub_ps(_mm_mul_ps(cosAngle, _mm_sqrt_ps(_mm_sub_ps(vLenSq, _mm_mul_ps(v1Len, v1Len)))),
+					   _mm_mul_ps(v1Len, sinAngle));
+
+		const __m128 radius = _mm_loadu_ps(spheres.m_radius + i);
+		const __m128 angleCull = _mm_cmpgt_ps(distanceClosestPoint, radius);
+		const __m128 frontCull = _mm_cmpgt_ps(v1Len, _mm_add_ps(radius, length));
+		const __m128 backCull = _mm_cmplt_ps(v1Len, _mm_xor_ps(radius, signBit));
+
+		const __m128 culled = _mm_or_ps(angleCull, _mm_or_ps(frontCull, backCull));
+		writeMask(i, begin, end, ~U32(_mm_movemask_ps(culled)), mask);
+	}
+#else
+	for(U32 i = begin; i < end; ++i)
+	{
+		const Sphere sphere(Vec4(spheres.m_center[0][i], spheres.m_center[1][i], spheres.m_center[2][i], 0.0f),
+							spheres.m_radius[i]);
+		writeBit(i, testCollision(sphere, cone), mask);
+	}
+#endif
+}
+
+} // end namespace anki
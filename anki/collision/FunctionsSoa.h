@@ -0,0 +1,46 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/collision/Common.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup collision
+/// @{
+
+/// Many AABBs in structure-of-arrays layout. The arrays don't need any alignment.
+class AabbSoa
+{
+public:
+	Array<const F32*, 3> m_min = {}; ///< The X, Y and Z of the min points.
+	Array<const F32*, 3> m_max = {}; ///< The X, Y and Z of the max points.
+};
+
+/// Many spheres in structure-of-arrays layout. The arrays don't need any alignment.
+class SphereSoa
+{
+public:
+	Array<const F32*, 3> m_center = {}; ///< The X, Y and Z of the centers.
+	const F32* m_radius = nullptr;
+};
+
+/// Test a shape against the volumes [begin, end) of SoA arrays, 4 volumes at a time. The bit i of the mask is set if
+/// the shape collides with the volume i and cleared if it doesn't. The rest of the bits are not touched. The arrays
+/// should be readable from begin rounded down to a multiple of 4 to end rounded up to a multiple of 4. The results are
+/// identical to the ones of testCollision().
+void testCollisionSoa(const Sphere& sphere, const AabbSoa& boxes, U32 begin, U32 end, WeakArray<U64> mask);
+
+/// @copydoc testCollisionSoa(const Sphere&, const AabbSoa&, U32, U32, WeakArray<U64>)
+void testCollisionSoa(const Aabb& aabb, const AabbSoa& boxes, U32 begin, U32 end, WeakArray<U64> mask);
+
+/// @copydoc testCollisionSoa(const Sphere&, const AabbSoa&, U32, U32, WeakArray<U64>)
+void testCollisionSoa(const Cone& cone, const SphereSoa& spheres, U32 begin, U32 end, WeakArray<U64> mask);
+/// @}
+
+} // end namespace anki
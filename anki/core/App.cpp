@@ -86,6 +86,9 @@ public:
 	U64 m_vkGpuMem = 0;
 	U32 m_vkCmdbCount = 0;
 
+	PtrSize m_stagingUsedMem = 0;
+	PtrSize m_stagingAllocatedMem = 0;
+
 	PtrSize m_drawableCount = 0;
 
 	static const U32 BUFFERED_FRAMES = 16;
@@ -137,6 +140,8 @@ public:
 			labelUint(m_freeCount, "Total frees");
 			labelBytes(m_vkCpuMem, "Vulkan CPU");
 			labelBytes(m_vkGpuMem, "Vulkan GPU");
+			labelBytes(m_stagingUsedMem, "Staging used");
+			labelBytes(m_stagingAllocatedMem, "Staging total");
 
 			ImGui::Text("----");
 			ImGui::Text("Vulkan:");
@@ -624,6 +629,15 @@ Error App::mainLoop()
 				statsUi.m_vkGpuMem = grStats.m_gpuMemory;
 				statsUi.m_vkCmdbCount = grStats.m_commandBufferCount;
 
+				statsUi.m_stagingUsedMem = 0;
+				statsUi.m_stagingAllocatedMem = 0;
+				const StagingGpuMemoryStats& stagingStats = m_stagingMem->getStats();
+				for(U32 i = 0; i < U32(StagingGpuMemoryType::COUNT); ++i)
+				{
+					statsUi.m_stagingUsedMem += stagingStats.m_usedMemory[i];
+					statsUi.m_stagingAllocatedMem += stagingStats.m_allocatedMemory[i];
+				}
+
 				statsUi.m_drawableCount = rqueue.countAllRenderables();
 			}
 
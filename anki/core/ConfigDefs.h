@@ -7,6 +7,8 @@ ANKI_CONFIG_OPTION(core_uniformPerFrameMemorySize, 16_MB, 1_MB, 1_GB)
 ANKI_CONFIG_OPTION(core_storagePerFrameMemorySize, 16_MB, 1_MB, 1_GB)
 ANKI_CONFIG_OPTION(core_vertexPerFrameMemorySize, 10_MB, 1_MB, 1_GB)
 ANKI_CONFIG_OPTION(core_textureBufferPerFrameMemorySize, 1_MB, 1_MB, 1_GB)
+ANKI_CONFIG_OPTION(core_stagingMemoryTuneFrameCount, 120, 1, 1024,
+				   "The staging memory is resized to fit the peak usage of that many frames")
 
 ANKI_CONFIG_OPTION(width, 1920, 16, 16 * 1024, "Width")
 ANKI_CONFIG_OPTION(height, 1080, 16, 16 * 1024, "Height")
@@ -60,6 +60,8 @@ Error NativeWindow::init(NativeWindowInitInfo& init, HeapAllocator<U8>& alloc)
 	flags |= SDL_WINDOW_OPENGL;
 #elif ANKI_GR_BACKEND_VULKAN
 	flags |= SDL_WINDOW_VULKAN;
+#elif ANKI_GR_BACKEND_NULL
+	flags |= SDL_WINDOW_HIDDEN; // Nothing will be presented
 #endif
 
 	if(init.m_fullscreenDesktopRez)
@@ -11,109 +11,356 @@
 namespace anki
 {
 
+/// An always mapped GPU buffer.
+class StagingGpuMemoryManager::Chunk
+{
+public:
+	BufferPtr m_buff;
+	U8* m_mappedMem = nullptr;
+	PtrSize m_size = 0;
+	Atomic<PtrSize> m_offset = {0};
+};
+
+/// The memory of a type for one of the frames in flight. It starts with one chunk and it grows by adding more.
+class StagingGpuMemoryManager::PerFrame
+{
+public:
+	Array<Chunk*, MAX_CHUNKS_PER_FRAME> m_chunks = {};
+	Atomic<U32> m_chunkCount = {0};
+	Mutex m_growMtx;
+};
+
+class StagingGpuMemoryManager::PerType
+{
+public:
+	Array<PerFrame, MAX_FRAMES_IN_FLIGHT> m_frames;
+	PtrSize m_minChunkSize = 0; ///< The size of the chunks will never drop below that.
+	U32 m_alignment = 0;
+	PtrSize m_maxAllocSize = 0;
+	PtrSize m_threadBlockSize = 0;
+	BufferUsageBit m_usage = BufferUsageBit::NONE;
+	DynamicArray<PtrSize> m_usedMemoryHistory; ///< The memory used in the last few frames.
+};
+
+/// A range of a chunk that a single thread allocates from.
+class StagingGpuMemoryManager::ThreadBlock
+{
+public:
+	Chunk* m_chunk = nullptr;
+	PtrSize m_offset = 0;
+	PtrSize m_end = 0;
+	U64 m_frame = MAX_U64; ///< The block is valid only in that frame.
+};
+
+/// Thread local storage.
+class alignas(ANKI_CACHE_LINE_SIZE) StagingGpuMemoryManager::ThreadLocal
+{
+public:
+	ThreadId m_tid = 0;
+	Array<ThreadBlock, U(StagingGpuMemoryType::COUNT)> m_blocks;
+};
+
+thread_local StagingGpuMemoryManager::ThreadLocal* StagingGpuMemoryManager::m_threadLocal = nullptr;
+thread_local U64 StagingGpuMemoryManager::m_threadLocalUuid = 0;
+
+static Atomic<U64> g_stagingGpuMemoryManagerUuid = {1};
+
 StagingGpuMemoryManager::~StagingGpuMemoryManager()
 {
+	if(m_gr == nullptr)
+	{
+		return;
+	}
+
 	m_gr->finish();
 
-	for(auto& it : m_perFrameBuffers)
+	for(PerType* type : m_types)
+	{
+		if(type == nullptr)
+		{
+			continue;
+		}
+
+		for(PerFrame& frame : type->m_frames)
+		{
+			for(U32 i = 0; i < frame.m_chunkCount.getNonAtomically(); ++i)
+			{
+				deleteChunk(frame.m_chunks[i]);
+			}
+		}
+
+		type->m_usedMemoryHistory.destroy(m_alloc);
+		m_alloc.deleteInstance(type);
+	}
+
+	for(ThreadLocal* tlocal : m_allThreadLocal)
 	{
-		it.m_buff->unmap();
-		it.m_buff.reset(nullptr);
+		m_alloc.deleteInstance(tlocal);
 	}
+	m_allThreadLocal.destroy(m_alloc);
 }
 
 Error StagingGpuMemoryManager::init(GrManager* gr, const ConfigSet& cfg)
 {
 	m_gr = gr;
+	m_alloc = gr->getAllocator();
+	m_uuid = g_stagingGpuMemoryManagerUuid.fetchAdd(1);
+	m_historyLength = max<U32>(MAX_FRAMES_IN_FLIGHT, cfg.getNumberU32("core_stagingMemoryTuneFrameCount"));
 
-	m_perFrameBuffers[StagingGpuMemoryType::UNIFORM].m_size = cfg.getNumberU32("core_uniformPerFrameMemorySize");
-	m_perFrameBuffers[StagingGpuMemoryType::STORAGE].m_size = cfg.getNumberU32("core_storagePerFrameMemorySize");
-	m_perFrameBuffers[StagingGpuMemoryType::VERTEX].m_size = cfg.getNumberU32("core_vertexPerFrameMemorySize");
-	m_perFrameBuffers[StagingGpuMemoryType::TEXTURE].m_size = cfg.getNumberU32("core_textureBufferPerFrameMemorySize");
+	const GpuDeviceCapabilities& caps = gr->getDeviceCapabilities();
 
-	initBuffer(StagingGpuMemoryType::UNIFORM, gr->getDeviceCapabilities().m_uniformBufferBindOffsetAlignment,
-			   gr->getDeviceCapabilities().m_uniformBufferMaxRange, BufferUsageBit::ALL_UNIFORM, *gr);
+	initType(StagingGpuMemoryType::UNIFORM, cfg.getNumberU32("core_uniformPerFrameMemorySize"),
+			 caps.m_uniformBufferBindOffsetAlignment, caps.m_uniformBufferMaxRange, BufferUsageBit::ALL_UNIFORM);
 
-	initBuffer(StagingGpuMemoryType::STORAGE,
-			   max(gr->getDeviceCapabilities().m_storageBufferBindOffsetAlignment,
-				   gr->getDeviceCapabilities().m_sbtRecordAlignment),
-			   gr->getDeviceCapabilities().m_storageBufferMaxRange, BufferUsageBit::ALL_STORAGE | BufferUsageBit::SBT,
-			   *gr);
+	initType(StagingGpuMemoryType::STORAGE, cfg.getNumberU32("core_storagePerFrameMemorySize"),
+			 max(caps.m_storageBufferBindOffsetAlignment, caps.m_sbtRecordAlignment), caps.m_storageBufferMaxRange,
+			 BufferUsageBit::ALL_STORAGE | BufferUsageBit::SBT);
 
-	initBuffer(StagingGpuMemoryType::VERTEX, 16, MAX_U32, BufferUsageBit::VERTEX | BufferUsageBit::INDEX, *gr);
+	initType(StagingGpuMemoryType::VERTEX, cfg.getNumberU32("core_vertexPerFrameMemorySize"), 16, MAX_U32,
+			 BufferUsageBit::VERTEX | BufferUsageBit::INDEX);
 
-	initBuffer(StagingGpuMemoryType::TEXTURE, gr->getDeviceCapabilities().m_textureBufferBindOffsetAlignment,
-			   gr->getDeviceCapabilities().m_textureBufferMaxRange, BufferUsageBit::ALL_TEXTURE, *gr);
+	initType(StagingGpuMemoryType::TEXTURE, cfg.getNumberU32("core_textureBufferPerFrameMemorySize"),
+			 caps.m_textureBufferBindOffsetAlignment, caps.m_textureBufferMaxRange, BufferUsageBit::ALL_TEXTURE);
 
 	return Error::NONE;
 }
 
-void StagingGpuMemoryManager::initBuffer(StagingGpuMemoryType type, U32 alignment, PtrSize maxAllocSize,
-										 BufferUsageBit usage, GrManager& gr)
+void StagingGpuMemoryManager::initType(StagingGpuMemoryType usage, PtrSize size, U32 alignment, PtrSize maxAllocSize,
+									   BufferUsageBit bufferUsage)
+{
+	PerType* type = m_alloc.newInstance<PerType>();
+	m_types[usage] = type;
+
+	// The size in the config is for all frames in flight
+	type->m_minChunkSize = getAlignedRoundDown(alignment, size / MAX_FRAMES_IN_FLIGHT);
+	type->m_alignment = alignment;
+	type->m_maxAllocSize = maxAllocSize;
+	type->m_threadBlockSize = getAlignedRoundUp(alignment, THREAD_BLOCK_SIZE);
+	type->m_usage = bufferUsage;
+	type->m_usedMemoryHistory.create(m_alloc, m_historyLength, 0);
+
+	for(PerFrame& frame : type->m_frames)
+	{
+		frame.m_chunks[0] = newChunk(*type, type->m_minChunkSize);
+		frame.m_chunkCount.setNonAtomically(1);
+	}
+}
+
+StagingGpuMemoryManager::Chunk* StagingGpuMemoryManager::newChunk(const PerType& type, PtrSize size)
+{
+	ANKI_ASSERT(isAligned(type.m_alignment, size));
+
+	Chunk* chunk = m_alloc.newInstance<Chunk>();
+	chunk->m_size = size;
+	chunk->m_buff = m_gr->newBuffer(BufferInitInfo(size, type.m_usage, BufferMapAccessBit::WRITE, "Staging"));
+	chunk->m_mappedMem = static_cast<U8*>(chunk->m_buff->map(0, size, BufferMapAccessBit::WRITE));
+
+	return chunk;
+}
+
+void StagingGpuMemoryManager::deleteChunk(Chunk* chunk)
+{
+	chunk->m_buff->unmap();
+	m_alloc.deleteInstance(chunk);
+}
+
+Error StagingGpuMemoryManager::allocateFromChunks(PerType& type, PtrSize size, Chunk*& chunk, PtrSize& offset)
+{
+	PerFrame& frame = type.m_frames[m_frame % MAX_FRAMES_IN_FLIGHT];
+
+	while(true)
+	{
+		const U32 chunkCount = frame.m_chunkCount.load();
+		Chunk& crntChunk = *frame.m_chunks[chunkCount - 1];
+
+		offset = crntChunk.m_offset.fetchAdd(size);
+		if(offset + size <= crntChunk.m_size)
+		{
+			chunk = &crntChunk;
+			return Error::NONE;
+		}
+
+		// The chunk is full. One thread adds a new chunk and the rest try again
+		LockGuard<Mutex> lock(frame.m_growMtx);
+		if(frame.m_chunkCount.load() == chunkCount)
+		{
+			if(chunkCount == MAX_CHUNKS_PER_FRAME)
+			{
+				return Error::OUT_OF_MEMORY;
+			}
+
+			const PtrSize newSize = max(crntChunk.m_size * 2, getAlignedRoundUp(type.m_alignment, size));
+			frame.m_chunks[chunkCount] = newChunk(type, newSize);
+			frame.m_chunkCount.store(chunkCount + 1);
+		}
+	}
+}
+
+StagingGpuMemoryManager::ThreadLocal& StagingGpuMemoryManager::getThreadLocal()
 {
-	auto& perframe = m_perFrameBuffers[type];
+	if(ANKI_LIKELY(m_threadLocalUuid == m_uuid))
+	{
+		return *m_threadLocal;
+	}
+
+	// The thread never allocated or it allocated from another manager
+	const ThreadId tid = Thread::getCurrentThreadId();
+	ThreadLocal* out = nullptr;
+
+	LockGuard<Mutex> lock(m_allThreadLocalMtx);
+	for(ThreadLocal* tlocal : m_allThreadLocal)
+	{
+		if(tlocal->m_tid == tid)
+		{
+			out = tlocal;
+			break;
+		}
+	}
 
-	perframe.m_buff = gr.newBuffer(BufferInitInfo(perframe.m_size, usage, BufferMapAccessBit::WRITE, "Staging"));
-	perframe.m_alloc.init(perframe.m_size, alignment, maxAllocSize);
-	perframe.m_mappedMem = static_cast<U8*>(perframe.m_buff->map(0, perframe.m_size, BufferMapAccessBit::WRITE));
+	if(out == nullptr)
+	{
+		out = m_alloc.newInstance<ThreadLocal>();
+		out->m_tid = tid;
+		m_allThreadLocal.emplaceBack(m_alloc, out);
+	}
+
+	m_threadLocal = out;
+	m_threadLocalUuid = m_uuid;
+	return *out;
 }
 
 void* StagingGpuMemoryManager::allocateFrame(PtrSize size, StagingGpuMemoryType usage, StagingGpuMemoryToken& token)
 {
-	PerFrameBuffer& buff = m_perFrameBuffers[usage];
-	Error err = buff.m_alloc.allocate(size, token.m_offset);
-	if(err)
+	void* out = tryAllocateFrame(size, usage, token);
+	if(ANKI_UNLIKELY(out == nullptr))
 	{
 		ANKI_CORE_LOGF("Out of staging GPU memory. Usage: %u", U32(usage));
 	}
 
-	token.m_buffer = buff.m_buff;
-	token.m_range = size;
-	token.m_type = usage;
-
-	return buff.m_mappedMem + token.m_offset;
+	return out;
 }
 
 void* StagingGpuMemoryManager::tryAllocateFrame(PtrSize size, StagingGpuMemoryType usage, StagingGpuMemoryToken& token)
 {
-	PerFrameBuffer& buff = m_perFrameBuffers[usage];
-	const Error err = buff.m_alloc.allocate(size, token.m_offset);
-	if(!err)
+	ANKI_ASSERT(size > 0);
+	PerType& type = *m_types[usage];
+	const PtrSize alignedSize = getAlignedRoundUp(type.m_alignment, size);
+	ANKI_ASSERT(alignedSize <= type.m_maxAllocSize && "Too high!");
+
+	Chunk* chunk;
+	PtrSize offset;
+	Error err = Error::NONE;
+	if(alignedSize <= type.m_threadBlockSize / 4)
 	{
-		token.m_buffer = buff.m_buff;
-		token.m_range = size;
-		token.m_type = usage;
-		return buff.m_mappedMem + token.m_offset;
+		// Small allocation, use the block of the thread
+		ThreadBlock& block = getThreadLocal().m_blocks[usage];
+		if(block.m_frame != m_frame || block.m_offset + alignedSize > block.m_end)
+		{
+			err = allocateFromChunks(type, type.m_threadBlockSize, block.m_chunk, block.m_offset);
+			block.m_end = block.m_offset + type.m_threadBlockSize;
+			block.m_frame = (err) ? MAX_U64 : m_frame;
+		}
+
+		chunk = block.m_chunk;
+		offset = block.m_offset;
+		block.m_offset += alignedSize;
 	}
 	else
+	{
+		err = allocateFromChunks(type, alignedSize, chunk, offset);
+	}
+
+	if(err)
 	{
 		token = {};
 		return nullptr;
 	}
+
+	ANKI_ASSERT(isAligned(type.m_alignment, offset) && offset + alignedSize <= chunk->m_size);
+	token.m_buffer = chunk->m_buff;
+	token.m_offset = offset;
+	token.m_range = size;
+	token.m_type = usage;
+
+	return chunk->m_mappedMem + offset;
 }
 
 void StagingGpuMemoryManager::endFrame()
 {
 	for(StagingGpuMemoryType usage = StagingGpuMemoryType::UNIFORM; usage < StagingGpuMemoryType::COUNT; ++usage)
 	{
-		PerFrameBuffer& buff = m_perFrameBuffers[usage];
+		recycleFrame(usage);
+	}
+
+	++m_frame;
+}
+
+void StagingGpuMemoryManager::recycleFrame(StagingGpuMemoryType usage)
+{
+	PerType& type = *m_types[usage];
+
+	// Gather the stats of the frame that ended
+	const PerFrame& crntFrame = type.m_frames[m_frame % MAX_FRAMES_IN_FLIGHT];
+	PtrSize usedMemory = 0;
+	PtrSize crntFrameMemory = 0;
+	for(U32 i = 0; i < crntFrame.m_chunkCount.getNonAtomically(); ++i)
+	{
+		const Chunk& chunk = *crntFrame.m_chunks[i];
+		usedMemory += min(chunk.m_offset.getNonAtomically(), chunk.m_size);
+		crntFrameMemory += chunk.m_size;
+	}
+
+	type.m_usedMemoryHistory[U32(m_frame % m_historyLength)] = usedMemory;
+	PtrSize highWaterMark = 0;
+	for(PtrSize used : type.m_usedMemoryHistory)
+	{
+		highWaterMark = max(highWaterMark, used);
+	}
 
-		if(buff.m_mappedMem)
+	m_stats.m_usedMemory[usage] = usedMemory;
+	m_stats.m_highWaterMark[usage] = highWaterMark;
+
+	switch(usage)
+	{
+	case StagingGpuMemoryType::UNIFORM:
+		ANKI_TRACE_INC_COUNTER(STAGING_UNIFORMS_SIZE, crntFrameMemory - usedMemory);
+		break;
+	case StagingGpuMemoryType::STORAGE:
+		ANKI_TRACE_INC_COUNTER(STAGING_STORAGE_SIZE, crntFrameMemory - usedMemory);
+		break;
+	default:
+		break;
+	}
+
+	// Prepare the frame that starts. The GPU is done with its memory. If it grew or if it's too big resize it to the
+	// high water mark plus some slack
+	PerFrame& nextFrame = type.m_frames[(m_frame + 1) % MAX_FRAMES_IN_FLIGHT];
+	const U32 chunkCount = nextFrame.m_chunkCount.getNonAtomically();
+	const PtrSize tunedSize =
+		max(type.m_minChunkSize, getAlignedRoundUp(type.m_alignment, highWaterMark + highWaterMark / 4));
+
+	if(chunkCount > 1 || nextFrame.m_chunks[0]->m_size > tunedSize * 2)
+	{
+		for(U32 i = 0; i < chunkCount; ++i)
 		{
-			// Increase the counters
-			switch(usage)
-			{
-			case StagingGpuMemoryType::UNIFORM:
-				ANKI_TRACE_INC_COUNTER(STAGING_UNIFORMS_SIZE, buff.m_alloc.getUnallocatedMemorySize());
-				break;
-			case StagingGpuMemoryType::STORAGE:
-				ANKI_TRACE_INC_COUNTER(STAGING_STORAGE_SIZE, buff.m_alloc.getUnallocatedMemorySize());
-				break;
-			default:
-				break;
-			}
+			deleteChunk(nextFrame.m_chunks[i]);
+			nextFrame.m_chunks[i] = nullptr;
+		}
 
-			buff.m_alloc.endFrame();
+		nextFrame.m_chunks[0] = newChunk(type, tunedSize);
+		nextFrame.m_chunkCount.setNonAtomically(1);
+	}
+	else
+	{
+		nextFrame.m_chunks[0]->m_offset.setNonAtomically(0);
+	}
+
+	m_stats.m_allocatedMemory[usage] = 0;
+	for(const PerFrame& frame : type.m_frames)
+	{
+		for(U32 i = 0; i < frame.m_chunkCount.getNonAtomically(); ++i)
+		{
+			m_stats.m_allocatedMemory[usage] += frame.m_chunks[i]->m_size;
 		}
 	}
 }
@@ -7,7 +7,7 @@
 
 #include <anki/core/Common.h>
 #include <anki/gr/Buffer.h>
-#include <anki/gr/utils/FrameGpuAllocator.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -62,7 +62,18 @@ public:
 	}
 };
 
-/// Manages staging GPU memory.
+/// Staging GPU memory statistics.
+class StagingGpuMemoryStats
+{
+public:
+	Array<PtrSize, U(StagingGpuMemoryType::COUNT)> m_usedMemory = {}; ///< The memory used in the last frame.
+	Array<PtrSize, U(StagingGpuMemoryType::COUNT)> m_highWaterMark = {}; ///< Max memory used in the last few frames.
+	Array<PtrSize, U(StagingGpuMemoryType::COUNT)> m_allocatedMemory = {}; ///< The size of all GPU buffers.
+};
+
+/// Manages staging GPU memory. Every frame in flight has its own GPU buffers for each StagingGpuMemoryType. When a
+/// frame runs out of memory more buffers are created and when the frame is recycled its memory is resized to fit the
+/// peak usage of the last few frames. Threads allocate from small blocks they own to avoid contention.
 class StagingGpuMemoryManager : public NonCopyable
 {
 public:
@@ -80,23 +91,53 @@ public:
 
 	/// Allocate staging memory for various operations. The memory will be reclaimed at the begining of the
 	/// N-(MAX_FRAMES_IN_FLIGHT-1) frame.
+	/// @return nullptr if it's out of memory.
 	void* tryAllocateFrame(PtrSize size, StagingGpuMemoryType usage, StagingGpuMemoryToken& token);
 
-private:
-	class PerFrameBuffer
+	/// Get the statistics of the last frame.
+	const StagingGpuMemoryStats& getStats() const
 	{
-	public:
-		PtrSize m_size = 0;
-		BufferPtr m_buff;
-		U8* m_mappedMem = nullptr; ///< Cache it
-		FrameGpuAllocator m_alloc;
-	};
+		return m_stats;
+	}
+
+private:
+	static constexpr U32 MAX_CHUNKS_PER_FRAME = 16;
+	static constexpr PtrSize THREAD_BLOCK_SIZE = 16 * 1024;
+
+	class Chunk;
+	class PerFrame;
+	class PerType;
+	class ThreadBlock;
+	class ThreadLocal;
 
 	GrManager* m_gr = nullptr;
-	Array<PerFrameBuffer, U(StagingGpuMemoryType::COUNT)> m_perFrameBuffers;
+	GrAllocator<U8> m_alloc;
+	U64 m_uuid = 0; ///< Identifies the manager in the thread local storage.
+	U64 m_frame = 0;
+	U32 m_historyLength = 0;
+
+	Array<PerType*, U(StagingGpuMemoryType::COUNT)> m_types = {};
+
+	DynamicArray<ThreadLocal*> m_allThreadLocal;
+	Mutex m_allThreadLocalMtx;
+
+	StagingGpuMemoryStats m_stats;
+
+	static thread_local ThreadLocal* m_threadLocal;
+	static thread_local U64 m_threadLocalUuid;
+
+	void initType(StagingGpuMemoryType type, PtrSize size, U32 alignment, PtrSize maxAllocSize, BufferUsageBit usage);
+
+	Chunk* newChunk(const PerType& type, PtrSize size);
+
+	void deleteChunk(Chunk* chunk);
+
+	ANKI_USE_RESULT Error allocateFromChunks(PerType& type, PtrSize size, Chunk*& chunk, PtrSize& offset);
+
+	ThreadLocal& getThreadLocal();
 
-	void initBuffer(StagingGpuMemoryType type, U32 alignment, PtrSize maxAllocSize, BufferUsageBit usage,
-					GrManager& gr);
+	/// Gather the statistics of the frame that ended and prepare the memory of the frame that starts.
+	void recycleFrame(StagingGpuMemoryType usage);
 };
 /// @}
 
@@ -8,6 +8,7 @@
 #include <anki/gr/GrObject.h>
 #include <anki/gr/Framebuffer.h>
 #include <anki/util/Functions.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -101,6 +102,10 @@ enum class CommandBufferFlag : U8
 
 	/// Will contain compute work.
 	COMPUTE_WORK = 1 << 6,
+
+	/// Will be submitted to the async compute queue. It can only contain compute and transfer work. If the GPU doesn't
+	/// have an async compute queue (see GpuDeviceCapabilities::m_asyncCompute) it goes to the general queue.
+	ASYNC_COMPUTE = 1 << 7,
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(CommandBufferFlag)
 
@@ -130,7 +135,11 @@ public:
 
 	/// Finalize and submit if it's primary command buffer and just finalize if it's second level.
 	/// @param[out] fence Optionaly create fence.
-	void flush(FencePtr* fence = nullptr);
+	/// @param[in] waitFences The GPU will wait for the work of these fences to finish before it starts executing this
+	///                       command buffer. Use it to synchronize with work flushed to a different queue.
+	/// @param crossQueueFence Set it if the fence will be in the waitFences of a command buffer of the other queue. It
+	///                        costs a semaphore so don't set it for fences that only the CPU waits on.
+	void flush(FencePtr* fence = nullptr, ConstWeakArray<FencePtr> waitFences = {}, Bool crossQueueFence = false);
 
 	/// @name State manipulation
 	/// @{
@@ -449,6 +458,10 @@ public:
 
 	Bool isEmpty() const;
 
+	/// The number of drawcalls that were dropped because their pipeline was still being created in the background.
+	/// Work that is cached across frames should check it and re-render if it grew while recording.
+	U32 getSkippedDrawcallCount() const;
+
 	/// The command buffer will co-own a pointer. Useful to track the lifetime of bindless resources.
 	void addReference(GrObjectPtr ptr);
 	/// @}
@@ -159,12 +159,32 @@ static void getFormatInfo(Format fmt, U& texelComponents, U& texelBytes, U& bloc
 		blockSize = 4;
 		blockBytes = 16;
 		break;
+	case Format::BC4_UNORM_BLOCK:
+	case Format::BC4_SNORM_BLOCK:
+		texelComponents = 1;
+		blockSize = 4;
+		blockBytes = 8;
+		break;
+	case Format::BC5_UNORM_BLOCK:
+	case Format::BC5_SNORM_BLOCK:
+		texelComponents = 2;
+		blockSize = 4;
+		blockBytes = 16;
+		break;
 	case Format::BC6H_SFLOAT_BLOCK:
 	case Format::BC6H_UFLOAT_BLOCK:
 		texelComponents = 3;
 		blockSize = 4;
 		blockBytes = 16;
 		break;
+	case Format::BC7_SRGB_BLOCK:
+	case Format::BC7_UNORM_BLOCK:
+	case Format::ASTC_4x4_SRGB_BLOCK:
+	case Format::ASTC_4x4_UNORM_BLOCK:
+		texelComponents = 4;
+		blockSize = 4;
+		blockBytes = 16;
+		break;
 	case Format::D16_UNORM:
 		texelComponents = 1;
 		texelBytes = texelComponents * 2;
@@ -9,8 +9,16 @@ ANKI_CONFIG_OPTION(gr_debugMarkers, 0, 0, 1)
 ANKI_CONFIG_OPTION(gr_maxBindlessTextures, 256, 8, 1024)
 ANKI_CONFIG_OPTION(gr_maxBindlessImages, 32, 8, 1024)
 ANKI_CONFIG_OPTION(gr_rayTracing, 0, 0, 1, "Try enabling ray tracing")
+ANKI_CONFIG_OPTION(gr_asyncCompute, 1, 0, 1, "Use a separate queue for compute work if the GPU has one")
 
 // Vulkan
 ANKI_CONFIG_OPTION(gr_diskShaderCacheMaxSize, 128_MB, 1_MB, 1_GB)
+ANKI_CONFIG_OPTION(gr_pipelineCreationThreadCount, 0, 0, 16,
+				   "Threads that create graphics pipelines. Drawcalls are skipped until they are ready so cached "
+				   "renders (static shadows, probes) might miss objects. 0 creates them synchronously")
+ANKI_CONFIG_OPTION(gr_pipelineManifest, 1, 0, 1, "Store the created pipelines to disk and pre-create them next time")
 ANKI_CONFIG_OPTION(gr_vkminor, 2, 2, 2)
 ANKI_CONFIG_OPTION(gr_vkmajor, 1, 1, 1)
+
+// Null
+ANKI_CONFIG_OPTION(gr_nullRecordCommands, 0, 0, 1, "Keep the command stream of the last frame. For debugging")
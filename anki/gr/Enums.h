@@ -354,6 +354,79 @@ inline Bool formatIsCompressed(const Format fmt)
 		   || (fmt >= Format::PVRTC1_2BPP_UNORM_BLOCK_IMG && fmt <= Format::PVRTC2_4BPP_SRGB_BLOCK_IMG);
 }
 
+/// Get the bits of a texel. For the compressed formats it's the average. For the depth stencil formats it's the sum of
+/// the components, the actual size is implementation defined.
+inline U32 getFormatBitsPerTexel(const Format fmt)
+{
+	ANKI_ASSERT(fmt != Format::NONE);
+
+	if(fmt == Format::R4G4_UNORM_PACK8 || (fmt >= Format::R8_UNORM && fmt <= Format::R8_SRGB) || fmt == Format::S8_UINT)
+	{
+		return 8;
+	}
+	else if(fmt <= Format::A1R5G5B5_UNORM_PACK16 || (fmt >= Format::R8G8_UNORM && fmt <= Format::R8G8_SRGB)
+			|| (fmt >= Format::R16_UNORM && fmt <= Format::R16_SFLOAT) || fmt == Format::D16_UNORM)
+	{
+		return 16;
+	}
+	else if((fmt >= Format::R8G8B8_UNORM && fmt <= Format::B8G8R8_SRGB) || fmt == Format::D16_UNORM_S8_UINT)
+	{
+		return 24;
+	}
+	else if(fmt <= Format::A2B10G10R10_SINT_PACK32 || (fmt >= Format::R16G16_UNORM && fmt <= Format::R16G16_SFLOAT)
+			|| (fmt >= Format::R32_UINT && fmt <= Format::R32_SFLOAT)
+			|| (fmt >= Format::B10G11R11_UFLOAT_PACK32 && fmt <= Format::E5B9G9R9_UFLOAT_PACK32)
+			|| fmt == Format::X8_D24_UNORM_PACK32 || fmt == Format::D32_SFLOAT || fmt == Format::D24_UNORM_S8_UINT)
+	{
+		return 32;
+	}
+	else if(fmt == Format::D32_SFLOAT_S8_UINT)
+	{
+		return 40;
+	}
+	else if(fmt >= Format::R16G16B16_UNORM && fmt <= Format::R16G16B16_SFLOAT)
+	{
+		return 48;
+	}
+	else if((fmt >= Format::R16G16B16A16_UNORM && fmt <= Format::R16G16B16A16_SFLOAT)
+			|| (fmt >= Format::R32G32_UINT && fmt <= Format::R32G32_SFLOAT)
+			|| (fmt >= Format::R64_UINT && fmt <= Format::R64_SFLOAT))
+	{
+		return 64;
+	}
+	else if(fmt >= Format::R32G32B32_UINT && fmt <= Format::R32G32B32_SFLOAT)
+	{
+		return 96;
+	}
+	else if((fmt >= Format::R32G32B32A32_UINT && fmt <= Format::R32G32B32A32_SFLOAT)
+			|| (fmt >= Format::R64G64_UINT && fmt <= Format::R64G64_SFLOAT))
+	{
+		return 128;
+	}
+	else if(fmt >= Format::R64G64B64_UINT && fmt <= Format::R64G64B64_SFLOAT)
+	{
+		return 192;
+	}
+	else if(fmt >= Format::R64G64B64A64_UINT && fmt <= Format::R64G64B64A64_SFLOAT)
+	{
+		return 256;
+	}
+	else if((fmt >= Format::BC1_RGB_UNORM_BLOCK && fmt <= Format::BC1_RGBA_SRGB_BLOCK)
+			|| (fmt >= Format::BC4_UNORM_BLOCK && fmt <= Format::BC4_SNORM_BLOCK)
+			|| (fmt >= Format::ETC2_R8G8B8_UNORM_BLOCK && fmt <= Format::ETC2_R8G8B8A1_SRGB_BLOCK)
+			|| (fmt >= Format::EAC_R11_UNORM_BLOCK && fmt <= Format::EAC_R11_SNORM_BLOCK)
+			|| (fmt >= Format::PVRTC1_2BPP_UNORM_BLOCK_IMG && fmt <= Format::PVRTC2_4BPP_SRGB_BLOCK_IMG))
+	{
+		return 4;
+	}
+	else
+	{
+		// The rest of the compressed formats. The ASTC with blocks bigger than 4x4 are smaller but that's fine
+		ANKI_ASSERT(formatIsCompressed(fmt));
+		return 8;
+	}
+}
+
 inline DepthStencilAspectBit computeFormatAspect(const Format fmt)
 {
 	DepthStencilAspectBit out = formatIsDepth(fmt) ? DepthStencilAspectBit::DEPTH : DepthStencilAspectBit::NONE;
@@ -68,7 +68,7 @@ public:
 	/// Swap buffers
 	void swapBuffers();
 
-	/// Wait for all work to finish.
+	/// Wait for all work to finish. That includes the pipelines that are created in the background.
 	void finish();
 
 	/// @name Object creation methods. They are thread-safe.
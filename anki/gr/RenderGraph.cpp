@@ -9,6 +9,8 @@
 #include <anki/gr/Sampler.h>
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/CommandBuffer.h>
+#include <anki/gr/Fence.h>
+#include <anki/gr/utils/TransientResourceAliasing.h>
 #include <anki/util/Tracer.h>
 #include <anki/util/BitSet.h>
 #include <anki/util/File.h>
@@ -25,6 +27,11 @@ static inline U32 getTextureSurfOrVolCount(const TexturePtr& tex)
 	return tex->getMipmapCount() * tex->getLayerCount() * (textureTypeIsCube(tex->getTextureType()) ? 6 : 1);
 }
 
+static inline U32 getTextureSurfOrVolCount(const TextureInitInfo& init)
+{
+	return init.m_mipmapCount * init.m_layerCount * (textureTypeIsCube(init.m_type) ? 6 : 1);
+}
+
 /// Contains some extra things for render targets.
 class RenderGraph::RT
 {
@@ -32,6 +39,8 @@ public:
 	DynamicArray<TextureUsageBit> m_surfOrVolUsages;
 	DynamicArray<U16> m_lastBatchThatTransitionedIt;
 	TexturePtr m_texture; ///< Hold a reference.
+	U32 m_aliasedRtIdx = MAX_U32; ///< The transient RT that used the same texture earlier in the frame.
+	U32 m_firstBatch = MAX_U32; ///< The first batch that uses the RT.
 	Bool m_imported;
 };
 
@@ -100,6 +109,59 @@ public:
 	}
 };
 
+/// Tracks the batches of the two queues that accessed a resource. It finds the batches that need to wait on the other
+/// queue.
+class RenderGraph::QueueSync
+{
+public:
+	Array<U32, 2> m_lastBatchThatUsedIt = {{MAX_U32, MAX_U32}}; ///< One for each queue.
+	Array<U32, 2> m_lastBatchThatModifiedIt = {{MAX_U32, MAX_U32}}; ///< Wrote it or changed its usage.
+	U64 m_prevUsage = 0; ///< The usage before m_usageBatch.
+	U64 m_usage = 0; ///< The usage in m_usageBatch.
+	U32 m_usageBatch = MAX_U32;
+
+	/// Add an access of the resource.
+	/// @return The batch of the other queue that needs to finish before the access or MAX_U32.
+	U32 access(U32 batchIdx, Bool asyncCompute, U64 usage, Bool write)
+	{
+		if(m_usageBatch != batchIdx)
+		{
+			m_prevUsage = m_usage;
+			m_usage = usage;
+			m_usageBatch = batchIdx;
+		}
+		else
+		{
+			m_usage |= usage;
+		}
+
+		const U32 crntQueue = (asyncCompute) ? 1 : 0;
+		const U32 otherQueue = 1 - crntQueue;
+		const Bool modifies = write || usage != m_prevUsage;
+
+		// Wait for the writes of the other queue. If this access modifies the resource wait for the reads as well
+		const U32 waitBatchIdx = (modifies) ? m_lastBatchThatUsedIt[otherQueue] : m_lastBatchThatModifiedIt[otherQueue];
+
+		m_lastBatchThatUsedIt[crntQueue] = batchIdx;
+		if(modifies)
+		{
+			m_lastBatchThatModifiedIt[crntQueue] = batchIdx;
+		}
+
+		return waitBatchIdx;
+	}
+};
+
+/// A command buffer of the graph and its synchronization with the other queue.
+class RenderGraph::Submission
+{
+public:
+	CommandBufferPtr m_cmdb;
+	U32 m_waitSubmissionIdx = MAX_U32; ///< The submission of the other queue to wait on.
+	Bool m_signal = false; ///< A submission of the other queue waits on this one.
+	Bool m_asyncCompute = false;
+};
+
 /// Contains some extra things the RenderPassBase cannot hold.
 class RenderGraph::Pass
 {
@@ -143,6 +205,8 @@ public:
 	DynamicArray<BufferBarrier> m_bufferBarriersBefore;
 	DynamicArray<ASBarrier> m_asBarriersBefore;
 	CommandBuffer* m_cmdb; ///< Someone else holds the ref already so have a ptr here.
+	U32 m_waitBatchIdx = MAX_U32; ///< The batch of the other queue that should finish before this one starts.
+	Bool m_asyncCompute = false; ///< Runs in the async compute queue.
 };
 
 /// The RenderGraph build context.
@@ -157,7 +221,7 @@ public:
 	DynamicArray<Buffer> m_buffers;
 	DynamicArray<AS> m_as;
 
-	DynamicArray<CommandBufferPtr> m_graphicsCmdbs;
+	DynamicArray<Submission> m_submissions;
 
 	Bool m_gatherStatistics = false;
 
@@ -167,6 +231,66 @@ public:
 	}
 };
 
+/// The parts of the BakeContext that only depend on the RenderGraphDescription and the initial usages of the imported
+/// resources. The renderer builds almost the same graph every frame so it's kept between frames.
+class RenderGraph::CompiledGraph
+{
+public:
+	class Pass
+	{
+	public:
+		U32 m_batchIdx;
+		Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS> m_colorUsages;
+		TextureUsageBit m_dsUsage;
+	};
+
+	DynamicArray<Pass> m_passes;
+	DynamicArray<Batch> m_batches; ///< The Batch::m_cmdb is not used.
+	DynamicArray<TextureUsageBit> m_rtFinalUsages; ///< The usages of all the surfaces or volumes at the end.
+	DynamicArray<BufferUsageBit> m_bufferFinalUsages;
+	DynamicArray<AccelerationStructureUsageBit> m_asFinalUsages;
+	DynamicArray<U32> m_rtAliases; ///< The RT::m_aliasedRtIdx of all RTs.
+	DynamicArray<U64> m_key; ///< What computeDescriptionHash() hashed. Two descriptions may have the same hash.
+	PtrSize m_transientMemoryBeforeAliasing = 0;
+	PtrSize m_transientMemoryAfterAliasing = 0;
+	U64 m_hash = 0; ///< The hash of the description.
+	U64 m_lastUsedVersion = 0;
+
+	void destroy(GrAllocator<U8> alloc)
+	{
+		m_passes.destroy(alloc);
+		for(Batch& batch : m_batches)
+		{
+			batch.m_passIndices.destroy(alloc);
+			batch.m_textureBarriersBefore.destroy(alloc);
+			batch.m_bufferBarriersBefore.destroy(alloc);
+			batch.m_asBarriersBefore.destroy(alloc);
+		}
+		m_batches.destroy(alloc);
+		m_rtFinalUsages.destroy(alloc);
+		m_bufferFinalUsages.destroy(alloc);
+		m_asFinalUsages.destroy(alloc);
+		m_rtAliases.destroy(alloc);
+		m_key.destroy(alloc);
+	}
+
+	Bool matches(ConstWeakArray<U64> key) const
+	{
+		return m_key.getSize() == key.getSize() && memcmp(&m_key[0], &key[0], m_key.getSizeInBytes()) == 0;
+	}
+};
+
+template<typename T, typename TAlloc>
+static void copyArray(const DynamicArray<T>& src, TAlloc alloc, DynamicArray<T>& dst)
+{
+	ANKI_ASSERT(dst.getSize() == 0);
+	dst.resizeStorage(alloc, src.getSize());
+	for(const T& x : src)
+	{
+		dst.emplaceBack(alloc, x);
+	}
+}
+
 void FramebufferDescription::bake()
 {
 	ANKI_ASSERT(m_hash == 0 && "Already baked");
@@ -263,6 +387,14 @@ RenderGraph::~RenderGraph()
 	}
 
 	m_importedRenderTargets.destroy(getAllocator());
+
+	for(CompiledGraph* graph : m_compiledGraphCache)
+	{
+		graph->destroy(getAllocator());
+		getAllocator().deleteInstance(graph);
+	}
+
+	m_compiledGraphCache.destroy(getAllocator());
 }
 
 RenderGraph* RenderGraph::newInstance(GrManager* manager)
@@ -341,7 +473,7 @@ void RenderGraph::reset()
 		p.m_secondLevelCmdbs.destroy(m_ctx->m_alloc);
 	}
 
-	m_ctx->m_graphicsCmdbs.destroy(m_ctx->m_alloc);
+	m_ctx->m_submissions.destroy(m_ctx->m_alloc);
 
 	m_ctx->m_alloc = StackAllocator<U8>();
 	m_ctx = nullptr;
@@ -662,30 +794,16 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 		RT& outRt = ctx->m_rts[rtIdx];
 		const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
 
+		// The textures of the transient RTs are created later (see createRenderTargets) because they might alias
 		const Bool imported = inRt.m_importedTex.isCreated();
 		if(imported)
 		{
-			// It's imported
 			outRt.m_texture = inRt.m_importedTex;
 		}
-		else
-		{
-			// Need to create new
-
-			// Create a new TextureInitInfo with the derived usage
-			TextureInitInfo initInf = inRt.m_initInfo;
-			initInf.m_usage = inRt.m_usageDerivedByDeps;
-			ANKI_ASSERT(initInf.m_usage != TextureUsageBit::NONE);
-
-			// Create the new hash
-			const U64 hash = appendHash(&initInf.m_usage, sizeof(initInf.m_usage), inRt.m_hash);
-
-			// Get or create the texture
-			outRt.m_texture = getOrCreateRenderTarget(initInf, hash);
-		}
 
 		// Init the usage
-		const U32 surfOrVolumeCount = getTextureSurfOrVolCount(outRt.m_texture);
+		const U32 surfOrVolumeCount =
+			(imported) ? getTextureSurfOrVolCount(outRt.m_texture) : getTextureSurfOrVolCount(inRt.m_initInfo);
 		outRt.m_surfOrVolUsages.create(alloc, surfOrVolumeCount, TextureUsageBit::NONE);
 		if(imported && inRt.m_importedAndUndefinedUsage)
 		{
@@ -740,7 +858,7 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 	return ctx;
 }
 
-void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+void RenderGraph::initRenderPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -768,30 +886,153 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 			memcpy(&inf, &inDep.m_texture, sizeof(inf));
 		}
 
-		// Create command buffers and framebuffer
-		if(inPass.m_type == RenderPassDescriptionBase::Type::GRAPHICS)
+		if(inPass.m_type != RenderPassDescriptionBase::Type::GRAPHICS
+		   || !static_cast<const GraphicsRenderPassDescription&>(inPass).hasFramebuffer())
 		{
-			const GraphicsRenderPassDescription& graphicsPass =
-				static_cast<const GraphicsRenderPassDescription&>(inPass);
+			ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
+		}
+	}
+}
 
-			if(graphicsPass.hasFramebuffer())
-			{
-				Bool drawsToPresentable;
-				outPass.fb() = getOrCreateFramebuffer(graphicsPass.m_fbDescr, &graphicsPass.m_rtHandles[0],
-													  inPass.m_name.cstr(), drawsToPresentable);
+void RenderGraph::initFramebuffers(const RenderGraphDescription& descr)
+{
+	BakeContext& ctx = *m_ctx;
 
-				outPass.m_fbRenderArea = graphicsPass.m_fbRenderArea;
-				outPass.m_drawsToPresentable = drawsToPresentable;
-			}
-			else
+	for(U32 passIdx = 0; passIdx < ctx.m_passes.getSize(); ++passIdx)
+	{
+		const RenderPassDescriptionBase& inPass = *descr.m_passes[passIdx];
+		if(inPass.m_type != RenderPassDescriptionBase::Type::GRAPHICS)
+		{
+			continue;
+		}
+
+		const GraphicsRenderPassDescription& graphicsPass = static_cast<const GraphicsRenderPassDescription&>(inPass);
+		if(graphicsPass.hasFramebuffer())
+		{
+			Pass& outPass = ctx.m_passes[passIdx];
+
+			Bool drawsToPresentable;
+			outPass.fb() = getOrCreateFramebuffer(graphicsPass.m_fbDescr, &graphicsPass.m_rtHandles[0],
+												  inPass.m_name.cstr(), drawsToPresentable);
+
+			outPass.m_fbRenderArea = graphicsPass.m_fbRenderArea;
+			outPass.m_drawsToPresentable = drawsToPresentable;
+		}
+	}
+}
+
+U64 RenderGraph::computeRenderTargetHash(const RenderGraphDescription::RT& inRt, TextureInitInfo& initInf)
+{
+	// Create a new TextureInitInfo with the derived usage
+	initInf = inRt.m_initInfo;
+	initInf.m_usage = inRt.m_usageDerivedByDeps;
+	ANKI_ASSERT(initInf.m_usage != TextureUsageBit::NONE);
+
+	// Create the new hash
+	return appendHash(&initInf.m_usage, sizeof(initInf.m_usage), inRt.m_hash);
+}
+
+void RenderGraph::initRenderTargetAliasing(const RenderGraphDescription& descr)
+{
+	BakeContext& ctx = *m_ctx;
+	const U32 rtCount = ctx.m_rts.getSize();
+
+	// Find the lifetimes of the transient RTs
+	DynamicArrayAuto<TransientResourceLifetime> lifetimes(ctx.m_alloc, rtCount);
+	DynamicArrayAuto<U32> aliasOf(ctx.m_alloc, rtCount, MAX_U32);
+	BitSet<MAX_RENDER_GRAPH_RENDER_TARGETS, U64> usedByAsyncCompute(false);
+	for(U32 passIdx = 0; passIdx < ctx.m_passes.getSize(); ++passIdx)
+	{
+		const U32 batchIdx = ctx.m_passes[passIdx].m_batchIdx;
+		for(const RenderPassDependency& dep : descr.m_passes[passIdx]->m_rtDeps)
+		{
+			TransientResourceLifetime& lifetime = lifetimes[dep.m_texture.m_handle.m_idx];
+			lifetime.m_firstBatch = min(lifetime.m_firstBatch, batchIdx);
+			lifetime.m_lastBatch = max(lifetime.m_lastBatch, batchIdx);
+
+			if(ctx.m_batches[batchIdx].m_asyncCompute)
 			{
-				ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
+				usedByAsyncCompute.set(dep.m_texture.m_handle.m_idx);
 			}
 		}
-		else
+	}
+
+	m_statistics.m_transientMemoryBeforeAliasing = 0;
+	for(U32 rtIdx = 0; rtIdx < rtCount; ++rtIdx)
+	{
+		TransientResourceLifetime& lifetime = lifetimes[rtIdx];
+		ctx.m_rts[rtIdx].m_firstBatch = lifetime.m_firstBatch;
+
+		if(ctx.m_rts[rtIdx].m_imported)
 		{
-			ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
+			// Imported RTs are not ours to alias. Make them look unused
+			lifetime.m_firstBatch = MAX_U32;
+			continue;
+		}
+
+		TextureInitInfo initInf;
+		lifetime.m_compatibilityKey = computeRenderTargetHash(descr.m_renderTargets[rtIdx], initInf);
+		if(usedByAsyncCompute.get(rtIdx))
+		{
+			// Sharing memory with the RTs of the general queue would add waits between the queues. Alias only with
+			// other RTs of the async compute queue
+			const U8 asyncCompute = 1;
+			lifetime.m_compatibilityKey = appendHash(&asyncCompute, sizeof(asyncCompute), lifetime.m_compatibilityKey);
 		}
+		lifetime.m_memorySize = initInf.computeApproximateMemorySize();
+		m_statistics.m_transientMemoryBeforeAliasing += lifetime.m_memorySize;
+	}
+
+	m_statistics.m_transientMemoryAfterAliasing =
+		computeTransientResourceAliasing(ConstWeakArray<TransientResourceLifetime>(lifetimes), WeakArray<U32>(aliasOf),
+										 ctx.m_alloc);
+
+	for(U32 rtIdx = 0; rtIdx < rtCount; ++rtIdx)
+	{
+		ctx.m_rts[rtIdx].m_aliasedRtIdx = aliasOf[rtIdx];
+	}
+}
+
+void RenderGraph::createRenderTargets(const RenderGraphDescription& descr)
+{
+	BakeContext& ctx = *m_ctx;
+
+	// First create the textures of the RTs that don't alias and then share them with the RTs that do
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		RT& rt = ctx.m_rts[rtIdx];
+		if(!rt.m_imported && rt.m_aliasedRtIdx == MAX_U32)
+		{
+			TextureInitInfo initInf;
+			const U64 hash = computeRenderTargetHash(descr.m_renderTargets[rtIdx], initInf);
+			rt.m_texture = getOrCreateRenderTarget(initInf, hash);
+		}
+	}
+
+	for(RT& rt : ctx.m_rts)
+	{
+		U32 ownerIdx = rt.m_aliasedRtIdx;
+		while(ownerIdx != MAX_U32 && ctx.m_rts[ownerIdx].m_aliasedRtIdx != MAX_U32)
+		{
+			ownerIdx = ctx.m_rts[ownerIdx].m_aliasedRtIdx;
+		}
+
+		if(ownerIdx != MAX_U32)
+		{
+			ANKI_ASSERT(!rt.m_imported && !ctx.m_rts[ownerIdx].m_imported);
+			rt.m_texture = ctx.m_rts[ownerIdx].m_texture;
+		}
+	}
+}
+
+void RenderGraph::setPassDependencies(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+{
+	BakeContext& ctx = *m_ctx;
+
+	for(U32 passIdx = 0; passIdx < ctx.m_passes.getSize(); ++passIdx)
+	{
+		const RenderPassDescriptionBase& inPass = *descr.m_passes[passIdx];
+		Pass& outPass = ctx.m_passes[passIdx];
 
 		// Set dependencies by checking all previous subpasses.
 		U32 prevPassIdx = passIdx;
@@ -806,74 +1047,175 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 	}
 }
 
-void RenderGraph::initBatches()
+void RenderGraph::initBatches(const RenderGraphDescription& descr)
 {
 	ANKI_ASSERT(m_ctx);
+	BakeContext& ctx = *m_ctx;
+	const Bool asyncComputeEnabled = getManager().getDeviceCapabilities().m_asyncCompute;
 
 	U passesAssignedToBatchCount = 0;
-	const U passCount = m_ctx->m_passes.getSize();
+	const U passCount = ctx.m_passes.getSize();
 	ANKI_ASSERT(passCount > 0);
-	Bool setTimestamp = m_ctx->m_gatherStatistics;
+	BitSet<MAX_RENDER_GRAPH_PASSES, U64> prevAsyncPasses(false);
 	while(passesAssignedToBatchCount < passCount)
 	{
-		m_ctx->m_batches.emplaceBack(m_ctx->m_alloc);
-		Batch& batch = m_ctx->m_batches.getBack();
+		// Gather the passes that can run. Every iteration creates one batch for each queue. The async compute passes
+		// can't go first because they need a batch of the general queue to order them after the previous frames
+		DynamicArrayAuto<U32> generalPasses(ctx.m_alloc);
+		DynamicArrayAuto<U32> asyncPasses(ctx.m_alloc);
+		for(U32 i = 0; i < passCount; ++i)
+		{
+			if(!ctx.m_passIsInBatch.get(i) && !passHasUnmetDependencies(ctx, i))
+			{
+				if(asyncComputeEnabled && descr.m_passes[i]->m_asyncCompute && ctx.m_batches.getSize() > 0)
+				{
+					asyncPasses.emplaceBack(i);
+				}
+				else
+				{
+					generalPasses.emplaceBack(i);
+				}
+			}
+		}
 
-		Bool drawsToPresentable = false;
+		// Postpone the general passes that depend on the async passes of the previous iteration if there are other
+		// passes to do in the meantime. That gives the async compute work more time to overlap
+		if(prevAsyncPasses.getAny())
+		{
+			DynamicArrayAuto<U32> independentPasses(ctx.m_alloc);
+			for(U32 passIdx : generalPasses)
+			{
+				Bool dependsOnAsync = false;
+				for(U32 depPassIdx : ctx.m_passes[passIdx].m_dependsOn)
+				{
+					dependsOnAsync = dependsOnAsync || prevAsyncPasses.get(depPassIdx);
+				}
 
-		for(U32 i = 0; i < passCount; ++i)
+				if(!dependsOnAsync)
+				{
+					independentPasses.emplaceBack(passIdx);
+				}
+			}
+
+			if(independentPasses.getSize() > 0 && independentPasses.getSize() < generalPasses.getSize())
+			{
+				generalPasses = std::move(independentPasses);
+			}
+		}
+
+		// Start the async compute work as early as possible. The general passes it doesn't need will run in parallel
+		if(asyncComputeEnabled && generalPasses.getSize() > 1)
 		{
-			if(!m_ctx->m_passIsInBatch.get(i) && !passHasUnmetDependencies(*m_ctx, i))
+			keepPassesOfNextAsyncPass(descr, ctx, generalPasses);
+		}
+
+		// Create the batches
+		for(U32 queue = 0; queue < 2; ++queue)
+		{
+			const DynamicArrayAuto<U32>& passes = (queue == 0) ? generalPasses : asyncPasses;
+			if(passes.getSize() == 0)
 			{
-				// Add to the batch
-				++passesAssignedToBatchCount;
-				batch.m_passIndices.emplaceBack(m_ctx->m_alloc, i);
+				continue;
+			}
+
+			ctx.m_batches.emplaceBack(ctx.m_alloc);
+			Batch& batch = ctx.m_batches.getBack();
+			batch.m_asyncCompute = queue == 1;
 
-				// Will batch draw to the swapchain?
-				drawsToPresentable = drawsToPresentable || m_ctx->m_passes[i].m_drawsToPresentable;
+			for(U32 passIdx : passes)
+			{
+				++passesAssignedToBatchCount;
+				batch.m_passIndices.emplaceBack(ctx.m_alloc, passIdx);
+				ctx.m_passes[passIdx].m_batchIdx = ctx.m_batches.getSize() - 1;
 			}
 		}
 
-		// Get or create cmdb for the batch.
-		// Create a new cmdb if the batch is writing to swapchain. This will help Vulkan to have a dependency of the
-		// swap chain image acquire to the 2nd command buffer instead of adding it to a single big cmdb.
-		if(m_ctx->m_graphicsCmdbs.isEmpty() || drawsToPresentable)
+		// Mark the passes done
+		for(U32 passIdx : generalPasses)
 		{
-			CommandBufferInitInfo cmdbInit;
-			cmdbInit.m_flags = CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::GRAPHICS_WORK;
-			CommandBufferPtr cmdb = getManager().newCommandBuffer(cmdbInit);
+			ctx.m_passIsInBatch.set(passIdx);
+		}
 
-			m_ctx->m_graphicsCmdbs.emplaceBack(m_ctx->m_alloc, cmdb);
+		prevAsyncPasses.unsetAll();
+		for(U32 passIdx : asyncPasses)
+		{
+			ctx.m_passIsInBatch.set(passIdx);
+			prevAsyncPasses.set(passIdx);
 
-			batch.m_cmdb = cmdb.get();
+#if ANKI_ENABLE_ASSERTS
+			for(const RenderPassDependency& dep : descr.m_passes[passIdx]->m_rtDeps)
+			{
+				const RT& rt = ctx.m_rts[dep.m_texture.m_handle.m_idx];
+				ANKI_ASSERT((!rt.m_imported || !(rt.m_texture->getTextureUsage() & TextureUsageBit::PRESENT))
+							&& "The presentable images are only available to the general queue");
+			}
+#endif
+		}
+	}
 
-			// Maybe write a timestamp
-			if(ANKI_UNLIKELY(setTimestamp))
+	// End the frame in the general queue. It's simpler to join the queues there
+	ctx.m_batches.getBack().m_asyncCompute = false;
+}
+
+void RenderGraph::keepPassesOfNextAsyncPass(const RenderGraphDescription& descr, const BakeContext& ctx,
+											 DynamicArrayAuto<U32>& generalPasses)
+{
+	// Find the async pass that waits on the fewest general passes that are not in a batch yet
+	BitSet<MAX_RENDER_GRAPH_PASSES, U64> nearestAncestors(false);
+	U32 nearestAncestorCount = MAX_U32;
+	for(U32 asyncPassIdx = 0; asyncPassIdx < ctx.m_passes.getSize(); ++asyncPassIdx)
+	{
+		if(!descr.m_passes[asyncPassIdx]->m_asyncCompute || ctx.m_passIsInBatch.get(asyncPassIdx))
+		{
+			continue;
+		}
+
+		// The passes depend on passes with lower indices so one backwards walk finds all the ancestors
+		BitSet<MAX_RENDER_GRAPH_PASSES, U64> ancestors(false);
+		ancestors.set(asyncPassIdx);
+		U32 ancestorCount = 0;
+		for(I32 passIdx = I32(asyncPassIdx); passIdx >= 0; --passIdx)
+		{
+			if(!ancestors.get(passIdx) || ctx.m_passIsInBatch.get(passIdx))
 			{
-				setTimestamp = false;
-				TimestampQueryPtr query = getManager().newTimestampQuery();
-				cmdb->resetTimestampQuery(query);
-				cmdb->writeTimestamp(query);
+				continue;
+			}
 
-				m_statistics.m_nextTimestamp = (m_statistics.m_nextTimestamp + 1) % MAX_TIMESTAMPS_BUFFERED;
-				m_statistics.m_timestamps[m_statistics.m_nextTimestamp * 2] = query;
+			ancestorCount += !descr.m_passes[passIdx]->m_asyncCompute;
+			for(U32 depPassIdx : ctx.m_passes[passIdx].m_dependsOn)
+			{
+				ancestors.set(depPassIdx);
 			}
 		}
-		else
+
+		if(ancestorCount > 0 && ancestorCount < nearestAncestorCount)
 		{
-			batch.m_cmdb = m_ctx->m_graphicsCmdbs.getBack().get();
+			nearestAncestors = ancestors;
+			nearestAncestorCount = ancestorCount;
 		}
+	}
 
-		// Mark batch's passes done
-		for(U32 passIdx : m_ctx->m_batches.getBack().m_passIndices)
+	if(nearestAncestorCount == MAX_U32)
+	{
+		return;
+	}
+
+	DynamicArrayAuto<U32> passes(ctx.m_alloc);
+	for(U32 passIdx : generalPasses)
+	{
+		if(nearestAncestors.get(passIdx))
 		{
-			m_ctx->m_passIsInBatch.set(passIdx);
-			m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
+			passes.emplaceBack(passIdx);
 		}
 	}
+
+	if(passes.getSize() > 0 && passes.getSize() < generalPasses.getSize())
+	{
+		generalPasses = std::move(passes);
+	}
 }
 
-void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -913,26 +1255,99 @@ void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackA
 
 					outPass.m_dsUsage = usage;
 				}
+			}
+		}
+	}
+}
 
-				// Do some pre-work for the second level command buffers
-				if(inPass.m_secondLevelCmdbsCount)
-				{
-					outPass.m_secondLevelCmdbs.create(alloc, inPass.m_secondLevelCmdbsCount);
-					CommandBufferInitInfo& cmdbInit = outPass.m_secondLevelCmdbInitInfo;
-					cmdbInit.m_flags = CommandBufferFlag::GRAPHICS_WORK | CommandBufferFlag::SECOND_LEVEL;
-					ANKI_ASSERT(cmdbInit.m_framebuffer.isCreated());
-					cmdbInit.m_colorAttachmentUsages = outPass.m_colorUsages;
-					cmdbInit.m_depthStencilAttachmentUsage = outPass.m_dsUsage;
-				}
+void RenderGraph::initCommandBuffers(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+{
+	BakeContext& ctx = *m_ctx;
+	Bool setTimestamp = ctx.m_gatherStatistics;
+
+	// The batches that the other queue waits on need to be the last in their command buffer
+	BitSet<MAX_RENDER_GRAPH_PASSES, U64> batchIsWaited(false);
+	for(const Batch& batch : ctx.m_batches)
+	{
+		if(batch.m_waitBatchIdx != MAX_U32)
+		{
+			batchIsWaited.set(batch.m_waitBatchIdx);
+		}
+	}
+
+	DynamicArrayAuto<U32> batchSubmissions(ctx.m_alloc, ctx.m_batches.getSize());
+	Array<U32, 2> crntSubmissions = {{MAX_U32, MAX_U32}}; ///< The submission that is recorded for each queue.
+	for(U32 batchIdx = 0; batchIdx < ctx.m_batches.getSize(); ++batchIdx)
+	{
+		Batch& batch = ctx.m_batches[batchIdx];
+		const U32 queue = (batch.m_asyncCompute) ? 1 : 0;
+
+		// Will batch draw to the swapchain?
+		Bool drawsToPresentable = false;
+		for(U32 passIdx : batch.m_passIndices)
+		{
+			drawsToPresentable = drawsToPresentable || ctx.m_passes[passIdx].m_drawsToPresentable;
+		}
+
+		// Get or create cmdb for the batch.
+		// Create a new cmdb if the batch is writing to swapchain. This will help Vulkan to have a dependency of the
+		// swap chain image acquire to the 2nd command buffer instead of adding it to a single big cmdb.
+		// Also create a new one if the batch waits on the other queue, the wait happens at the start of a submission.
+		if(crntSubmissions[queue] == MAX_U32 || drawsToPresentable || batch.m_waitBatchIdx != MAX_U32)
+		{
+			CommandBufferInitInfo cmdbInit;
+			cmdbInit.m_flags = (batch.m_asyncCompute)
+								   ? CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::ASYNC_COMPUTE
+								   : CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::GRAPHICS_WORK;
+			CommandBufferPtr cmdb = getManager().newCommandBuffer(cmdbInit);
+
+			crntSubmissions[queue] = ctx.m_submissions.getSize();
+			ctx.m_submissions.emplaceBack(ctx.m_alloc);
+			Submission& submission = ctx.m_submissions.getBack();
+			submission.m_cmdb = cmdb;
+			submission.m_asyncCompute = batch.m_asyncCompute;
+			if(batch.m_waitBatchIdx != MAX_U32)
+			{
+				submission.m_waitSubmissionIdx = batchSubmissions[batch.m_waitBatchIdx];
 			}
-			else
+
+			// Maybe write a timestamp
+			if(ANKI_UNLIKELY(setTimestamp && !batch.m_asyncCompute))
 			{
-				ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
+				setTimestamp = false;
+				TimestampQueryPtr query = getManager().newTimestampQuery();
+				cmdb->resetTimestampQuery(query);
+				cmdb->writeTimestamp(query);
+
+				m_statistics.m_nextTimestamp = (m_statistics.m_nextTimestamp + 1) % MAX_TIMESTAMPS_BUFFERED;
+				m_statistics.m_timestamps[m_statistics.m_nextTimestamp * 2] = query;
 			}
 		}
-		else
+
+		batch.m_cmdb = ctx.m_submissions[crntSubmissions[queue]].m_cmdb.get();
+		batchSubmissions[batchIdx] = crntSubmissions[queue];
+
+		if(batchIsWaited.get(batchIdx))
 		{
-			ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
+			ctx.m_submissions[crntSubmissions[queue]].m_signal = true;
+			crntSubmissions[queue] = MAX_U32;
+		}
+	}
+
+	// Do some pre-work for the second level command buffers
+	for(U32 passIdx = 0; passIdx < ctx.m_passes.getSize(); ++passIdx)
+	{
+		const RenderPassDescriptionBase& inPass = *descr.m_passes[passIdx];
+		Pass& outPass = ctx.m_passes[passIdx];
+
+		if(inPass.m_secondLevelCmdbsCount)
+		{
+			outPass.m_secondLevelCmdbs.create(alloc, inPass.m_secondLevelCmdbsCount);
+			CommandBufferInitInfo& cmdbInit = outPass.m_secondLevelCmdbInitInfo;
+			cmdbInit.m_flags = CommandBufferFlag::GRAPHICS_WORK | CommandBufferFlag::SECOND_LEVEL;
+			ANKI_ASSERT(cmdbInit.m_framebuffer.isCreated());
+			cmdbInit.m_colorAttachmentUsages = outPass.m_colorUsages;
+			cmdbInit.m_depthStencilAttachmentUsage = outPass.m_dsUsage;
 		}
 	}
 }
@@ -1017,9 +1432,80 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 	BakeContext& ctx = *m_ctx;
 	const StackAllocator<U8>& alloc = ctx.m_alloc;
 
+	// The cross-queue synchronization is tracked for the whole resource and not for every surface
+	DynamicArrayAuto<QueueSync> rtSyncs(ctx.m_alloc, ctx.m_rts.getSize());
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		for(TextureUsageBit usage : ctx.m_rts[rtIdx].m_surfOrVolUsages)
+		{
+			rtSyncs[rtIdx].m_usage |= U64(usage);
+		}
+	}
+
+	DynamicArrayAuto<QueueSync> buffSyncs(ctx.m_alloc, ctx.m_buffers.getSize());
+	for(U32 buffIdx = 0; buffIdx < ctx.m_buffers.getSize(); ++buffIdx)
+	{
+		buffSyncs[buffIdx].m_usage = U64(ctx.m_buffers[buffIdx].m_usage);
+	}
+
+	DynamicArrayAuto<QueueSync> asSyncs(ctx.m_alloc, ctx.m_as.getSize());
+	for(U32 asIdx = 0; asIdx < ctx.m_as.getSize(); ++asIdx)
+	{
+		asSyncs[asIdx].m_usage = U64(ctx.m_as[asIdx].m_usage);
+	}
+
+	Array<U32, 2> lastWaitedBatch = {{MAX_U32, MAX_U32}}; ///< The last batch of the other queue a queue waited on.
+	U32 firstGeneralBatch = MAX_U32;
+	U32 lastAsyncBatch = MAX_U32;
+
 	// For all batches
 	for(Batch& batch : ctx.m_batches)
 	{
+		// The transient RTs that start using an aliased texture continue from the usage of the previous owner. That
+		// way the barriers of their first use also hand the memory over
+		const U32 batchIdx = U32(&batch - &ctx.m_batches[0]);
+		for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+		{
+			RT& rt = ctx.m_rts[rtIdx];
+			if(rt.m_aliasedRtIdx != MAX_U32 && rt.m_firstBatch == batchIdx)
+			{
+				const RT& prevRt = ctx.m_rts[rt.m_aliasedRtIdx];
+				ANKI_ASSERT(prevRt.m_surfOrVolUsages.getSize() == rt.m_surfOrVolUsages.getSize());
+				for(U32 surfOrVolIdx = 0; surfOrVolIdx < rt.m_surfOrVolUsages.getSize(); ++surfOrVolIdx)
+				{
+					rt.m_surfOrVolUsages[surfOrVolIdx] = prevRt.m_surfOrVolUsages[surfOrVolIdx];
+				}
+
+				rtSyncs[rtIdx] = rtSyncs[rt.m_aliasedRtIdx];
+			}
+		}
+
+		// Find the batch of the other queue to wait on
+		U32 waitBatchIdx = MAX_U32;
+		auto waitFor = [&](U32 otherBatchIdx) {
+			if(otherBatchIdx != MAX_U32 && (waitBatchIdx == MAX_U32 || otherBatchIdx > waitBatchIdx))
+			{
+				waitBatchIdx = otherBatchIdx;
+			}
+		};
+
+		if(batch.m_asyncCompute)
+		{
+			// The async compute queue knows nothing about the work of the previous frames that is in the general queue.
+			// Have the first async batch wait on the general queue, the previous frames are before it
+			ANKI_ASSERT(firstGeneralBatch != MAX_U32);
+			if(lastWaitedBatch[1] == MAX_U32)
+			{
+				waitFor(firstGeneralBatch);
+			}
+
+			lastAsyncBatch = batchIdx;
+		}
+		else if(firstGeneralBatch == MAX_U32)
+		{
+			firstGeneralBatch = batchIdx;
+		}
+
 		BitSet<MAX_RENDER_GRAPH_BUFFERS, U64> buffHasBarrierMask(false);
 		BitSet<MAX_RENDER_GRAPH_ACCELERATION_STRUCTURES, U32> asHasBarrierMask(false);
 
@@ -1032,6 +1518,10 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 			for(const RenderPassDependency& dep : pass.m_rtDeps)
 			{
 				setTextureBarrier(batch, dep);
+
+				const TextureUsageBit usage = dep.m_texture.m_usage;
+				waitFor(rtSyncs[dep.m_texture.m_handle.m_idx].access(batchIdx, batch.m_asyncCompute, U64(usage),
+																	 !!(usage & TextureUsageBit::ALL_WRITE)));
 			}
 
 			// Do buffers
@@ -1041,6 +1531,9 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 				const BufferUsageBit depUsage = dep.m_buffer.m_usage;
 				BufferUsageBit& crntUsage = ctx.m_buffers[buffIdx].m_usage;
 
+				waitFor(buffSyncs[buffIdx].access(batchIdx, batch.m_asyncCompute, U64(depUsage),
+												  !!(depUsage & BufferUsageBit::ALL_WRITE)));
+
 				if(depUsage == crntUsage)
 				{
 					continue;
@@ -1085,6 +1578,9 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 				const AccelerationStructureUsageBit depUsage = dep.m_as.m_usage;
 				AccelerationStructureUsageBit& crntUsage = ctx.m_as[asIdx].m_usage;
 
+				waitFor(asSyncs[asIdx].access(batchIdx, batch.m_asyncCompute, U64(depUsage),
+											  !!(depUsage & AccelerationStructureUsageBit::ALL_WRITE)));
+
 				if(depUsage == crntUsage)
 				{
 					continue;
@@ -1121,6 +1617,15 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 			}
 		} // For all passes
 
+		// Skip the wait if the queue already waited on that batch or on a later one
+		const U32 queue = (batch.m_asyncCompute) ? 1 : 0;
+		if(waitBatchIdx != MAX_U32 && (lastWaitedBatch[queue] == MAX_U32 || waitBatchIdx > lastWaitedBatch[queue]))
+		{
+			ANKI_ASSERT(ctx.m_batches[waitBatchIdx].m_asyncCompute != batch.m_asyncCompute);
+			batch.m_waitBatchIdx = waitBatchIdx;
+			lastWaitedBatch[queue] = waitBatchIdx;
+		}
+
 #if ANKI_DBG_RENDER_GRAPH
 		// Sort the barriers to ease the dumped graph
 		std::sort(batch.m_textureBarriersBefore.getBegin(), batch.m_textureBarriersBefore.getEnd(),
@@ -1160,34 +1665,298 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 				  [&](const ASBarrier& a, const ASBarrier& b) { return a.m_idx < b.m_idx; });
 #endif
 	} // For all batches
+
+	// Join the queues at the end of the frame. The next frame and the presentation will only wait on the general queue
+	if(lastAsyncBatch != MAX_U32 && (lastWaitedBatch[0] == MAX_U32 || lastWaitedBatch[0] < lastAsyncBatch))
+	{
+		Batch& lastBatch = ctx.m_batches.getBack();
+		ANKI_ASSERT(!lastBatch.m_asyncCompute);
+		lastBatch.m_waitBatchIdx = lastAsyncBatch;
+	}
 }
 
 void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
 {
 	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_COMPILE);
+	const Second startTime = HighRezTimer::getCurrentTime();
 
 	// Init the context
 	BakeContext& ctx = *newContext(descr, alloc);
 	m_ctx = &ctx;
 
-	// Init the passes and find the dependencies between passes
-	initRenderPassesAndSetDeps(descr, alloc);
+	// Init the passes
+	initRenderPasses(descr, alloc);
 
-	// Walk the graph and create pass batches
-	initBatches();
+	// Find if the same graph was compiled in the past. Compare the whole description since the hash may collide
+	DynamicArrayAuto<U64> key(alloc);
+	const U64 hash = computeDescriptionHash(descr, key);
+	auto it = m_compiledGraphCache.find(hash);
+	const Bool hashFound = it != m_compiledGraphCache.getEnd();
+	if(hashFound && (*it)->matches(key))
+	{
+		restoreCompiledGraph(**it);
+		(*it)->m_lastUsedVersion = m_version;
+		++m_statistics.m_compiledGraphCacheHits;
+
+		createRenderTargets(descr);
+	}
+	else
+	{
+		// Find the dependencies between passes
+		setPassDependencies(descr, alloc);
+
+		// Walk the graph and create pass batches
+		initBatches(descr);
+
+		// Now that we know the batches every pass belongs init the graphics passes
+		initGraphicsPasses(descr);
 
-	// Now that we know the batches every pass belongs init the graphics passes
-	initGraphicsPasses(descr, alloc);
+		// Find the transient RTs that can share textures and create the textures
+		initRenderTargetAliasing(descr);
+		createRenderTargets(descr);
 
-	// Create barriers between batches
-	setBatchBarriers(descr);
+		// Create barriers between batches
+		setBatchBarriers(descr);
+
+		if(!hashFound)
+		{
+			// On a collision keep the graph that is already cached. Collisions are too rare to handle
+			storeCompiledGraph(hash, key);
+		}
+		++m_statistics.m_compiledGraphCacheMisses;
 
 #if ANKI_DBG_RENDER_GRAPH
-	if(dumpDependencyDotFile(descr, ctx, "./"))
+		if(dumpDependencyDotFile(descr, ctx, "./"))
+		{
+			ANKI_LOGF("Won't recover on debug code");
+		}
+#endif
+	}
+
+	// Needs to happen every frame because the framebuffers depend on the actual textures
+	initFramebuffers(descr);
+
+	// Create the command buffers of the batches
+	initCommandBuffers(descr, alloc);
+
+	m_statistics.m_compileTime = HighRezTimer::getCurrentTime() - startTime;
+}
+
+U64 RenderGraph::computeDescriptionHash(const RenderGraphDescription& descr, DynamicArrayAuto<U64>& values) const
+{
+	const BakeContext& ctx = *m_ctx;
+	ANKI_ASSERT(values.getSize() == 0);
+
+	// Render targets. Imported RTs might change from frame to frame (eg the swapchain images) so hash only what
+	// affects the barriers
+	values.emplaceBack(ctx.m_rts.getSize());
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
 	{
-		ANKI_LOGF("Won't recover on debug code");
+		const RT& rt = ctx.m_rts[rtIdx];
+		values.emplaceBack(rt.m_imported);
+
+		if(rt.m_imported)
+		{
+			const Texture& tex = *rt.m_texture;
+			values.emplaceBack(U64(tex.getTextureType()));
+			values.emplaceBack(tex.getMipmapCount());
+			values.emplaceBack(tex.getLayerCount());
+
+			for(TextureUsageBit usage : rt.m_surfOrVolUsages)
+			{
+				values.emplaceBack(U64(usage));
+			}
+		}
+		else
+		{
+			values.emplaceBack(descr.m_renderTargets[rtIdx].m_hash);
+		}
 	}
-#endif
+
+	// Buffers and AS
+	values.emplaceBack(ctx.m_buffers.getSize());
+	for(const Buffer& buff : ctx.m_buffers)
+	{
+		values.emplaceBack(U64(buff.m_usage));
+	}
+
+	values.emplaceBack(ctx.m_as.getSize());
+	for(const AS& as : ctx.m_as)
+	{
+		values.emplaceBack(U64(as.m_usage));
+	}
+
+	// Passes
+	values.emplaceBack(descr.m_passes.getSize());
+	for(const RenderPassDescriptionBase* pass : descr.m_passes)
+	{
+		values.emplaceBack((U64(pass->m_type) << 1) | U64(pass->m_asyncCompute));
+
+		if(pass->m_type == RenderPassDescriptionBase::Type::GRAPHICS)
+		{
+			const GraphicsRenderPassDescription& graphicsPass =
+				static_cast<const GraphicsRenderPassDescription&>(*pass);
+			values.emplaceBack(graphicsPass.m_fbDescr.m_hash);
+
+			for(RenderTargetHandle handle : graphicsPass.m_rtHandles)
+			{
+				values.emplaceBack(handle.m_idx);
+			}
+		}
+
+		values.emplaceBack(pass->m_rtDeps.getSize());
+		for(const RenderPassDependency& dep : pass->m_rtDeps)
+		{
+			const TextureSubresourceInfo& subresource = dep.m_texture.m_subresource;
+			values.emplaceBack(dep.m_texture.m_handle.m_idx);
+			values.emplaceBack(U64(dep.m_texture.m_usage));
+			values.emplaceBack((U64(subresource.m_firstMipmap) << 32) | subresource.m_mipmapCount);
+			values.emplaceBack((U64(subresource.m_firstLayer) << 32) | subresource.m_layerCount);
+			values.emplaceBack((U64(subresource.m_firstFace) << 32) | (U64(subresource.m_faceCount) << 8)
+							   | U64(subresource.m_depthStencilAspect));
+		}
+
+		values.emplaceBack(pass->m_buffDeps.getSize());
+		for(const RenderPassDependency& dep : pass->m_buffDeps)
+		{
+			values.emplaceBack((U64(dep.m_buffer.m_handle.m_idx) << 32) | U64(dep.m_buffer.m_usage));
+		}
+
+		values.emplaceBack(pass->m_asDeps.getSize());
+		for(const RenderPassDependency& dep : pass->m_asDeps)
+		{
+			values.emplaceBack((U64(dep.m_as.m_handle.m_idx) << 32) | U64(dep.m_as.m_usage));
+		}
+	}
+
+	return computeHash(&values[0], values.getSizeInBytes());
+}
+
+void RenderGraph::storeCompiledGraph(U64 hash, ConstWeakArray<U64> key)
+{
+	const BakeContext& ctx = *m_ctx;
+	GrAllocator<U8> alloc = getAllocator();
+
+	CompiledGraph* graph = alloc.newInstance<CompiledGraph>();
+	graph->m_hash = hash;
+	graph->m_lastUsedVersion = m_version;
+
+	graph->m_key.create(alloc, key.getSize());
+	memcpy(&graph->m_key[0], &key[0], key.getSizeInBytes());
+
+	graph->m_passes.create(alloc, ctx.m_passes.getSize());
+	for(U32 passIdx = 0; passIdx < ctx.m_passes.getSize(); ++passIdx)
+	{
+		const Pass& inPass = ctx.m_passes[passIdx];
+		CompiledGraph::Pass& outPass = graph->m_passes[passIdx];
+
+		outPass.m_batchIdx = inPass.m_batchIdx;
+		outPass.m_colorUsages = inPass.m_colorUsages;
+		outPass.m_dsUsage = inPass.m_dsUsage;
+	}
+
+	graph->m_batches.create(alloc, ctx.m_batches.getSize());
+	for(U32 batchIdx = 0; batchIdx < ctx.m_batches.getSize(); ++batchIdx)
+	{
+		const Batch& inBatch = ctx.m_batches[batchIdx];
+		Batch& outBatch = graph->m_batches[batchIdx];
+
+		copyArray(inBatch.m_passIndices, alloc, outBatch.m_passIndices);
+		copyArray(inBatch.m_textureBarriersBefore, alloc, outBatch.m_textureBarriersBefore);
+		copyArray(inBatch.m_bufferBarriersBefore, alloc, outBatch.m_bufferBarriersBefore);
+		copyArray(inBatch.m_asBarriersBefore, alloc, outBatch.m_asBarriersBefore);
+		outBatch.m_cmdb = nullptr;
+		outBatch.m_waitBatchIdx = inBatch.m_waitBatchIdx;
+		outBatch.m_asyncCompute = inBatch.m_asyncCompute;
+	}
+
+	// The final usages of the resources. The imported ones will need them in reset()
+	for(const RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit usage : rt.m_surfOrVolUsages)
+		{
+			graph->m_rtFinalUsages.emplaceBack(alloc, usage);
+		}
+	}
+
+	for(const Buffer& buff : ctx.m_buffers)
+	{
+		graph->m_bufferFinalUsages.emplaceBack(alloc, buff.m_usage);
+	}
+
+	for(const AS& as : ctx.m_as)
+	{
+		graph->m_asFinalUsages.emplaceBack(alloc, as.m_usage);
+	}
+
+	// The aliasing of the transient RTs
+	graph->m_rtAliases.create(alloc, ctx.m_rts.getSize());
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		graph->m_rtAliases[rtIdx] = ctx.m_rts[rtIdx].m_aliasedRtIdx;
+	}
+	graph->m_transientMemoryBeforeAliasing = m_statistics.m_transientMemoryBeforeAliasing;
+	graph->m_transientMemoryAfterAliasing = m_statistics.m_transientMemoryAfterAliasing;
+
+	m_compiledGraphCache.emplace(alloc, hash, graph);
+}
+
+void RenderGraph::restoreCompiledGraph(const CompiledGraph& graph)
+{
+	BakeContext& ctx = *m_ctx;
+	ANKI_ASSERT(graph.m_passes.getSize() == ctx.m_passes.getSize());
+
+	for(U32 passIdx = 0; passIdx < ctx.m_passes.getSize(); ++passIdx)
+	{
+		const CompiledGraph::Pass& inPass = graph.m_passes[passIdx];
+		Pass& outPass = ctx.m_passes[passIdx];
+
+		outPass.m_batchIdx = inPass.m_batchIdx;
+		outPass.m_colorUsages = inPass.m_colorUsages;
+		outPass.m_dsUsage = inPass.m_dsUsage;
+	}
+
+	ctx.m_batches.create(ctx.m_alloc, graph.m_batches.getSize());
+	for(U32 batchIdx = 0; batchIdx < ctx.m_batches.getSize(); ++batchIdx)
+	{
+		const Batch& inBatch = graph.m_batches[batchIdx];
+		Batch& outBatch = ctx.m_batches[batchIdx];
+
+		copyArray(inBatch.m_passIndices, ctx.m_alloc, outBatch.m_passIndices);
+		copyArray(inBatch.m_textureBarriersBefore, ctx.m_alloc, outBatch.m_textureBarriersBefore);
+		copyArray(inBatch.m_bufferBarriersBefore, ctx.m_alloc, outBatch.m_bufferBarriersBefore);
+		copyArray(inBatch.m_asBarriersBefore, ctx.m_alloc, outBatch.m_asBarriersBefore);
+		outBatch.m_waitBatchIdx = inBatch.m_waitBatchIdx;
+		outBatch.m_asyncCompute = inBatch.m_asyncCompute;
+	}
+
+	U32 count = 0;
+	for(RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit& usage : rt.m_surfOrVolUsages)
+		{
+			usage = graph.m_rtFinalUsages[count++];
+		}
+	}
+	ANKI_ASSERT(count == graph.m_rtFinalUsages.getSize());
+
+	for(U32 buffIdx = 0; buffIdx < ctx.m_buffers.getSize(); ++buffIdx)
+	{
+		ctx.m_buffers[buffIdx].m_usage = graph.m_bufferFinalUsages[buffIdx];
+	}
+
+	for(U32 asIdx = 0; asIdx < ctx.m_as.getSize(); ++asIdx)
+	{
+		ctx.m_as[asIdx].m_usage = graph.m_asFinalUsages[asIdx];
+	}
+
+	ANKI_ASSERT(graph.m_rtAliases.getSize() == ctx.m_rts.getSize());
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		ctx.m_rts[rtIdx].m_aliasedRtIdx = graph.m_rtAliases[rtIdx];
+	}
+	m_statistics.m_transientMemoryBeforeAliasing = graph.m_transientMemoryBeforeAliasing;
+	m_statistics.m_transientMemoryAfterAliasing = graph.m_transientMemoryAfterAliasing;
 }
 
 TexturePtr RenderGraph::getTexture(RenderTargetHandle handle) const
@@ -1316,21 +2085,43 @@ void RenderGraph::flush()
 {
 	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_FLUSH);
 
-	for(U32 i = 0; i < m_ctx->m_graphicsCmdbs.getSize(); ++i)
+	// The frame ends in the general queue. Find its last submission
+	U32 lastGeneralSubmission = m_ctx->m_submissions.getSize() - 1;
+	while(m_ctx->m_submissions[lastGeneralSubmission].m_asyncCompute)
 	{
+		--lastGeneralSubmission;
+	}
+
+	// The fences of the submissions that the other queue waits on. A submission is always after the one it waits on
+	DynamicArrayAuto<FencePtr> fences(m_ctx->m_alloc, m_ctx->m_submissions.getSize());
+
+	for(U32 i = 0; i < m_ctx->m_submissions.getSize(); ++i)
+	{
+		Submission& submission = m_ctx->m_submissions[i];
+
 		// Maybe write a timestamp before flush
-		if(ANKI_UNLIKELY(m_ctx->m_gatherStatistics && i == m_ctx->m_graphicsCmdbs.getSize() - 1))
+		if(ANKI_UNLIKELY(m_ctx->m_gatherStatistics && i == lastGeneralSubmission))
 		{
 			TimestampQueryPtr query = getManager().newTimestampQuery();
-			m_ctx->m_graphicsCmdbs[i]->resetTimestampQuery(query);
-			m_ctx->m_graphicsCmdbs[i]->writeTimestamp(query);
+			submission.m_cmdb->resetTimestampQuery(query);
+			submission.m_cmdb->writeTimestamp(query);
 
 			m_statistics.m_timestamps[m_statistics.m_nextTimestamp * 2 + 1] = query;
 			m_statistics.m_cpuStartTimes[m_statistics.m_nextTimestamp] = HighRezTimer::getCurrentTime();
 		}
 
 		// Flush
-		m_ctx->m_graphicsCmdbs[i]->flush();
+		FencePtr* fence = (submission.m_signal) ? &fences[i] : nullptr;
+		if(submission.m_waitSubmissionIdx != MAX_U32)
+		{
+			ANKI_ASSERT(fences[submission.m_waitSubmissionIdx].isCreated());
+			submission.m_cmdb->flush(fence, ConstWeakArray<FencePtr>(&fences[submission.m_waitSubmissionIdx], 1),
+									 submission.m_signal);
+		}
+		else
+		{
+			submission.m_cmdb->flush(fence, {}, submission.m_signal);
+		}
 	}
 }
 
@@ -1389,6 +2180,24 @@ void RenderGraph::periodicCleanup()
 	{
 		ANKI_GR_LOGI("Cleaned %u render targets", rtsCleanedCount);
 	}
+
+	// Remove the compiled graphs that haven't been used for some time
+	DynamicArrayAuto<U64> unusedGraphs(getAllocator());
+	for(const CompiledGraph* graph : m_compiledGraphCache)
+	{
+		if(m_version - graph->m_lastUsedVersion >= PERIODIC_CLEANUP_EVERY)
+		{
+			unusedGraphs.emplaceBack(graph->m_hash);
+		}
+	}
+
+	for(U64 hash : unusedGraphs)
+	{
+		auto it = m_compiledGraphCache.find(hash);
+		(*it)->destroy(getAllocator());
+		getAllocator().deleteInstance(*it);
+		m_compiledGraphCache.erase(getAllocator(), it);
+	}
 }
 
 void RenderGraph::getStatistics(RenderGraphStatistics& statistics) const
@@ -1414,6 +2223,12 @@ void RenderGraph::getStatistics(RenderGraphStatistics& statistics) const
 		statistics.m_gpuTime = -1.0;
 		statistics.m_cpuStartTime = -1.0;
 	}
+
+	statistics.m_compileTime = m_statistics.m_compileTime;
+	statistics.m_compiledGraphCacheHits = m_statistics.m_compiledGraphCacheHits;
+	statistics.m_compiledGraphCacheMisses = m_statistics.m_compiledGraphCacheMisses;
+	statistics.m_transientMemoryBeforeAliasing = m_statistics.m_transientMemoryBeforeAliasing;
+	statistics.m_transientMemoryAfterAliasing = m_statistics.m_transientMemoryAfterAliasing;
 }
 
 #if ANKI_DBG_RENDER_GRAPH
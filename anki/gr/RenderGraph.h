@@ -340,6 +340,7 @@ protected:
 	RenderPassWorkCallback m_callback = nullptr;
 	void* m_userData = nullptr;
 	U32 m_secondLevelCmdbsCount = 0;
+	Bool m_asyncCompute = false;
 
 	DynamicArray<RenderPassDependency> m_rtDeps;
 	DynamicArray<RenderPassDependency> m_buffDeps;
@@ -455,6 +456,14 @@ class ComputeRenderPassDescription : public RenderPassDescriptionBase
 	template<typename, typename>
 	friend class GenericPoolAllocator;
 
+public:
+	/// Hint that the pass can run in the async compute queue in parallel to the graphics work. It will run in the
+	/// general queue if the GPU doesn't have an async compute queue.
+	void setAsyncCompute(Bool async = true)
+	{
+		m_asyncCompute = async;
+	}
+
 private:
 	ComputeRenderPassDescription(RenderGraphDescription* descr)
 		: RenderPassDescriptionBase(Type::NO_GRAPHICS, descr)
@@ -561,6 +570,11 @@ class RenderGraphStatistics
 public:
 	Second m_gpuTime; ///< Time spent in the GPU.
 	Second m_cpuStartTime; ///< Time the work was submited from the CPU (almost)
+	Second m_compileTime; ///< CPU time spent in the last RenderGraph::compileNewGraph.
+	U64 m_compiledGraphCacheHits; ///< How many times a previously compiled graph was reused.
+	U64 m_compiledGraphCacheMisses; ///< How many times the graph had to be compiled from scratch.
+	PtrSize m_transientMemoryBeforeAliasing; ///< Approximate memory of the transient RTs if they were not aliased.
+	PtrSize m_transientMemoryAfterAliasing; ///< Approximate memory of the transient RTs of the last graph.
 };
 
 /// Accepts a descriptor of the frame's render passes and sets the dependencies between them.
@@ -570,6 +584,7 @@ public:
 /// - Command buffer creation for primary and secondary command buffers.
 /// - Framebuffer creation.
 /// - Render target creation (optional since textures can be imported as well).
+/// - Scheduling of compute passes in the async compute queue (see ComputeRenderPassDescription::setAsyncCompute).
 ///
 /// It accepts a description of the frame's render passes (compute and graphics), compiles that description to calculate
 /// dependencies and then populates command buffers with the help of multiple RenderPassWorkCallback.
@@ -633,6 +648,9 @@ private:
 	class TextureBarrier;
 	class BufferBarrier;
 	class ASBarrier;
+	class QueueSync;
+	class Submission;
+	class CompiledGraph;
 
 	/// Render targets of the same type+size+format.
 	class RenderTargetCacheEntry
@@ -652,6 +670,7 @@ private:
 	HashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
 	HashMap<U64, FramebufferPtr> m_fbCache; ///< Framebuffer cache.
 	HashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
+	HashMap<U64, CompiledGraph*> m_compiledGraphCache; ///< Compiled graphs indexed by the hash of their description.
 
 	BakeContext* m_ctx = nullptr;
 	U64 m_version = 0;
@@ -663,6 +682,12 @@ private:
 		Array<TimestampQueryPtr, MAX_TIMESTAMPS_BUFFERED * 2> m_timestamps;
 		Array<Second, MAX_TIMESTAMPS_BUFFERED> m_cpuStartTimes;
 		U8 m_nextTimestamp = 0;
+
+		Second m_compileTime = 0.0;
+		U64 m_compiledGraphCacheHits = 0;
+		U64 m_compiledGraphCacheMisses = 0;
+		PtrSize m_transientMemoryBeforeAliasing = 0;
+		PtrSize m_transientMemoryAfterAliasing = 0;
 	} m_statistics;
 
 	RenderGraph(GrManager* manager, CString name);
@@ -672,10 +697,32 @@ private:
 	static ANKI_USE_RESULT RenderGraph* newInstance(GrManager* manager);
 
 	BakeContext* newContext(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
-	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
-	void initBatches();
-	void initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void initRenderPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void setPassDependencies(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void initBatches(const RenderGraphDescription& descr);
+	void initGraphicsPasses(const RenderGraphDescription& descr);
+	void initRenderTargetAliasing(const RenderGraphDescription& descr);
+	void createRenderTargets(const RenderGraphDescription& descr);
 	void setBatchBarriers(const RenderGraphDescription& descr);
+	void initFramebuffers(const RenderGraphDescription& descr);
+	void initCommandBuffers(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+
+	/// @name Compiled graph cache
+	/// @{
+
+	/// Gather everything that affects the dependencies, the batches and the barriers and hash it.
+	/// @param[out] key The values that were hashed. A cache hit is verified against them.
+	U64 computeDescriptionHash(const RenderGraphDescription& descr, DynamicArrayAuto<U64>& key) const;
+
+	/// Keep the parts of the current context that only depend on the description.
+	void storeCompiledGraph(U64 hash, ConstWeakArray<U64> key);
+
+	/// Populate the current context with the contents of a compiled graph.
+	void restoreCompiledGraph(const CompiledGraph& graph);
+	/// @}
+
+	/// Compute the TextureInitInfo and the hash of a transient RT. RTs with the same hash can share a texture.
+	static U64 computeRenderTargetHash(const RenderGraphDescription::RT& inRt, TextureInitInfo& initInf);
 
 	TexturePtr getOrCreateRenderTarget(const TextureInitInfo& initInf, U64 hash);
 	FramebufferPtr getOrCreateFramebuffer(const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles,
@@ -690,6 +737,10 @@ private:
 
 	static Bool passHasUnmetDependencies(const BakeContext& ctx, U32 passIdx);
 
+	/// Keep only the general passes that the nearest async compute pass needs. The rest will run in parallel to it.
+	static void keepPassesOfNextAsyncPass(const RenderGraphDescription& descr, const BakeContext& ctx,
+										  DynamicArrayAuto<U32>& generalPasses);
+
 	void setTextureBarrier(Batch& batch, const RenderPassDependency& consumer);
 
 	template<typename TFunc>
@@ -95,6 +95,22 @@ public:
 		return true;
 #undef ANKI_CHECK_VAL_VALIDITY
 	}
+
+	/// Compute the memory the texture needs. It's an approximation since the actual size is implementation defined.
+	PtrSize computeApproximateMemorySize() const
+	{
+		const U32 faceCount = (textureTypeIsCube(m_type)) ? 6 : 1;
+		PtrSize bits = 0;
+		for(U32 mip = 0; mip < m_mipmapCount; ++mip)
+		{
+			const PtrSize w = max(m_width >> mip, 1u);
+			const PtrSize h = max(m_height >> mip, 1u);
+			const PtrSize d = (m_type == TextureType::_3D) ? max(m_depth >> mip, 1u) : 1;
+			bits += w * h * d;
+		}
+
+		return bits * getFormatBitsPerTexel(m_format) * faceCount * m_layerCount * m_samples / 8;
+	}
 };
 
 /// GPU texture.
@@ -30,10 +30,14 @@ CommandBuffer* CommandBuffer::newInstance(GrManager* manager, const CommandBuffe
 	return impl;
 }
 
-void CommandBuffer::flush(FencePtr* fence)
+void CommandBuffer::flush(FencePtr* fence, ConstWeakArray<FencePtr> waitFences, Bool crossQueueFence)
 {
 	ANKI_GL_SELF(CommandBufferImpl);
 
+	// There is a single queue, the order of the flushes is enough
+	(void)waitFences;
+	(void)crossQueueFence;
+
 	if(!self.isSecondLevel())
 	{
 		ANKI_ASSERT(!self.m_state.insideRenderPass());
@@ -1280,6 +1284,12 @@ Bool CommandBuffer::isEmpty() const
 	return self.isEmpty();
 }
 
+U32 CommandBuffer::getSkippedDrawcallCount() const
+{
+	// Pipelines are always created before the drawcalls
+	return 0;
+}
+
 void CommandBuffer::blitTextureViews(TextureViewPtr srcView, TextureViewPtr destView)
 {
 	ANKI_ASSERT(!"TODO");
@@ -0,0 +1,39 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/AccelerationStructure.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// AccelerationStructure implementation. Nothing gets built.
+class AccelerationStructureImpl final : public AccelerationStructure
+{
+public:
+	AccelerationStructureImpl(GrManager* manager, CString name)
+		: AccelerationStructure(manager, name)
+	{
+	}
+
+	~AccelerationStructureImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const AccelerationStructureInitInfo& init)
+	{
+		ANKI_ASSERT(init.isValid());
+		m_type = init.m_type;
+		return Error::NONE;
+	}
+};
+/// @}
+
+} // end namespace anki
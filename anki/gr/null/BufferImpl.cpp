@@ -0,0 +1,58 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/BufferImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+
+namespace anki
+{
+
+BufferImpl::~BufferImpl()
+{
+	ANKI_ASSERT(!m_mapped);
+
+	if(m_memory)
+	{
+		getAllocator().getMemoryPool().free(m_memory);
+		static_cast<GrManagerImpl&>(getManager()).decreaseAllocatedMemory(m_size);
+	}
+}
+
+Error BufferImpl::init(const BufferInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+
+	m_size = inf.m_size;
+	m_usage = inf.m_usage;
+	m_access = inf.m_mapAccess;
+
+	// Zero the memory to have deterministic results between runs
+	m_memory = static_cast<U8*>(getAllocator().getMemoryPool().allocate(m_size, 16));
+	memset(m_memory, 0, m_size);
+	static_cast<GrManagerImpl&>(getManager()).increaseAllocatedMemory(m_size);
+
+	// There is no GPU so use the CPU address
+	m_gpuAddress = ptrToNumber(m_memory);
+
+	return Error::NONE;
+}
+
+void* BufferImpl::map(PtrSize offset, PtrSize range, BufferMapAccessBit access)
+{
+	ANKI_ASSERT(access != BufferMapAccessBit::NONE);
+	ANKI_ASSERT((access & m_access) != BufferMapAccessBit::NONE);
+	ANKI_ASSERT(!m_mapped);
+	ANKI_ASSERT(rangeValid(offset, range));
+	(void)range;
+	(void)access;
+
+#if ANKI_EXTRA_CHECKS
+	m_mapped = true;
+#endif
+
+	return m_memory + offset;
+}
+
+} // end namespace anki
@@ -0,0 +1,66 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Buffer.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Buffer implementation. The storage is CPU memory so the contents are real.
+class BufferImpl final : public Buffer
+{
+public:
+	BufferImpl(GrManager* manager, CString name)
+		: Buffer(manager, name)
+	{
+	}
+
+	~BufferImpl();
+
+	ANKI_USE_RESULT Error init(const BufferInitInfo& inf);
+
+	void* map(PtrSize offset, PtrSize range, BufferMapAccessBit access);
+
+	void unmap()
+	{
+#if ANKI_EXTRA_CHECKS
+		ANKI_ASSERT(m_mapped);
+		m_mapped = false;
+#endif
+	}
+
+	Bool usageValid(BufferUsageBit usage) const
+	{
+		return (m_usage & usage) == usage;
+	}
+
+	/// Check if a range is inside the buffer. If range is MAX_PTR_SIZE it means the rest of the buffer.
+	Bool rangeValid(PtrSize offset, PtrSize range) const
+	{
+		return offset < m_size && (range == MAX_PTR_SIZE || offset + range <= m_size);
+	}
+
+	/// The CPU memory. Used to execute the transfer commands.
+	U8* getMemory()
+	{
+		ANKI_ASSERT(m_memory);
+		return m_memory;
+	}
+
+private:
+	U8* m_memory = nullptr;
+#if ANKI_EXTRA_CHECKS
+	Bool m_mapped = false;
+#endif
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,451 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/CommandBuffer.h>
+#include <anki/gr/null/CommandBufferImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+#include <anki/gr/AccelerationStructure.h>
+
+namespace anki
+{
+
+CommandBuffer* CommandBuffer::newInstance(GrManager* manager, const CommandBufferInitInfo& init)
+{
+	CommandBufferImpl* impl = manager->getAllocator().newInstance<CommandBufferImpl>(manager, init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		manager->getAllocator().deleteInstance(impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+void CommandBuffer::flush(FencePtr* fence, ConstWeakArray<FencePtr> waitFences, Bool crossQueueFence)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.endRecording();
+
+	if(!self.isSecondLevel())
+	{
+		self.getGrManagerImpl().flushCommandBuffer(CommandBufferPtr(this), fence, waitFences, crossQueueFence);
+	}
+	else
+	{
+		ANKI_ASSERT(fence == nullptr && waitFences.getSize() == 0 && !crossQueueFence);
+	}
+}
+
+void CommandBuffer::bindVertexBuffer(U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride,
+									 VertexStepRate stepRate)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindVertexBuffer(binding, buff, offset, stride, stepRate);
+}
+
+void CommandBuffer::setVertexAttribute(U32 location, U32 buffBinding, Format fmt, PtrSize relativeOffset)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setVertexAttribute(location, buffBinding, fmt, relativeOffset);
+}
+
+void CommandBuffer::bindIndexBuffer(BufferPtr buff, PtrSize offset, IndexType type)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindIndexBuffer(buff, offset, type);
+}
+
+void CommandBuffer::setPrimitiveRestart(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::PRIMITIVE_RESTART, enable);
+}
+
+void CommandBuffer::setViewport(U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::VIEWPORT, minx, miny, width, height);
+}
+
+void CommandBuffer::setScissor(U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::SCISSOR, minx, miny, width, height);
+}
+
+void CommandBuffer::setFillMode(FillMode mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::FILL_MODE, mode);
+}
+
+void CommandBuffer::setCullMode(FaceSelectionBit mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::CULL_MODE, mode);
+}
+
+void CommandBuffer::setPolygonOffset(F32 factor, F32 units)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::POLYGON_OFFSET, factor, units);
+}
+
+void CommandBuffer::setStencilOperations(FaceSelectionBit face, StencilOperation stencilFail,
+										 StencilOperation stencilPassDepthFail, StencilOperation stencilPassDepthPass)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::STENCIL_OPERATIONS, face, stencilFail, stencilPassDepthFail, stencilPassDepthPass);
+}
+
+void CommandBuffer::setStencilCompareOperation(FaceSelectionBit face, CompareOperation comp)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::STENCIL_COMPARE_OPERATION, face, comp);
+}
+
+void CommandBuffer::setStencilCompareMask(FaceSelectionBit face, U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::STENCIL_COMPARE_MASK, face, mask);
+}
+
+void CommandBuffer::setStencilWriteMask(FaceSelectionBit face, U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::STENCIL_WRITE_MASK, face, mask);
+}
+
+void CommandBuffer::setStencilReference(FaceSelectionBit face, U32 ref)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::STENCIL_REFERENCE, face, ref);
+}
+
+void CommandBuffer::setDepthWrite(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::DEPTH_WRITE, enable);
+}
+
+void CommandBuffer::setDepthCompareOperation(CompareOperation op)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::DEPTH_COMPARE_OPERATION, op);
+}
+
+void CommandBuffer::setAlphaToCoverage(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::ALPHA_TO_COVERAGE, enable);
+}
+
+void CommandBuffer::setColorChannelWriteMask(U32 attachment, ColorBit mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::COLOR_CHANNEL_WRITE_MASK, attachment, mask);
+}
+
+void CommandBuffer::setBlendFactors(U32 attachment, BlendFactor srcRgb, BlendFactor dstRgb, BlendFactor srcA,
+									BlendFactor dstA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::BLEND_FACTORS, attachment, srcRgb, dstRgb, srcA, dstA);
+}
+
+void CommandBuffer::setBlendOperation(U32 attachment, BlendOperation funcRgb, BlendOperation funcA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::BLEND_OPERATION, attachment, funcRgb, funcA);
+}
+
+void CommandBuffer::bindTextureAndSampler(U32 set, U32 binding, TextureViewPtr texView, SamplerPtr sampler,
+										  TextureUsageBit usage, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindTexture(set, binding, texView, usage, arrayIdx);
+	self.bindSampler(set, binding, sampler, arrayIdx);
+}
+
+void CommandBuffer::bindTexture(U32 set, U32 binding, TextureViewPtr texView, TextureUsageBit usage, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindTexture(set, binding, texView, usage, arrayIdx);
+}
+
+void CommandBuffer::bindSampler(U32 set, U32 binding, SamplerPtr sampler, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindSampler(set, binding, sampler, arrayIdx);
+}
+
+void CommandBuffer::bindUniformBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindUniformBuffer(set, binding, buff, offset, range, arrayIdx);
+}
+
+void CommandBuffer::bindStorageBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindStorageBuffer(set, binding, buff, offset, range, arrayIdx);
+}
+
+void CommandBuffer::bindImage(U32 set, U32 binding, TextureViewPtr img, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindImage(set, binding, img, arrayIdx);
+}
+
+void CommandBuffer::bindAccelerationStructure(U32 set, U32 binding, AccelerationStructurePtr as, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindAccelerationStructure(set, binding, as, arrayIdx);
+}
+
+void CommandBuffer::bindTextureBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, Format fmt,
+									  U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindTextureBuffer(set, binding, buff, offset, range, fmt, arrayIdx);
+}
+
+void CommandBuffer::bindAllBindless(U32 set)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindAllBindless(set);
+}
+
+void CommandBuffer::bindShaderProgram(ShaderProgramPtr prog)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindShaderProgram(prog);
+}
+
+void CommandBuffer::beginRenderPass(FramebufferPtr fb,
+									const Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS>& colorAttachmentUsages,
+									TextureUsageBit depthStencilAttachmentUsage, U32 minx, U32 miny, U32 width,
+									U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.beginRenderPass(fb, colorAttachmentUsages, depthStencilAttachmentUsage, minx, miny, width, height);
+}
+
+void CommandBuffer::endRenderPass()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.endRenderPass();
+}
+
+void CommandBuffer::drawElements(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex,
+								 U32 baseVertex, U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawElements(topology, count, instanceCount, firstIndex, baseVertex, baseInstance);
+}
+
+void CommandBuffer::drawArrays(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawArrays(topology, count, instanceCount, first, baseInstance);
+}
+
+void CommandBuffer::drawArraysIndirect(PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawIndirect(false, topology, drawCount, offset, buff);
+}
+
+void CommandBuffer::drawElementsIndirect(PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawIndirect(true, topology, drawCount, offset, buff);
+}
+
+void CommandBuffer::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.dispatchCompute(groupCountX, groupCountY, groupCountZ);
+}
+
+void CommandBuffer::traceRays(BufferPtr sbtBuffer, PtrSize sbtBufferOffset, U32 sbtRecordSize,
+							  U32 hitGroupSbtRecordCount, U32 rayTypeCount, U32 width, U32 height, U32 depth)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.traceRays(sbtBuffer, sbtBufferOffset, sbtRecordSize, hitGroupSbtRecordCount, rayTypeCount, width,
+						   height, depth);
+}
+
+void CommandBuffer::generateMipmaps2d(TextureViewPtr texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.generateMipmaps(texView, false);
+}
+
+void CommandBuffer::generateMipmaps3d(TextureViewPtr texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.generateMipmaps(texView, true);
+}
+
+void CommandBuffer::blitTextureViews(TextureViewPtr srcView, TextureViewPtr destView)
+{
+	ANKI_ASSERT(!"TODO");
+}
+
+void CommandBuffer::clearTextureView(TextureViewPtr texView, const ClearValue& clearValue)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.clearTextureView(texView, clearValue);
+}
+
+void CommandBuffer::copyBufferToTextureView(BufferPtr buff, PtrSize offset, PtrSize range, TextureViewPtr texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.copyBufferToTextureView(buff, offset, range, texView);
+}
+
+void CommandBuffer::fillBuffer(BufferPtr buff, PtrSize offset, PtrSize size, U32 value)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.fillBuffer(buff, offset, size, value);
+}
+
+void CommandBuffer::writeOcclusionQueryResultToBuffer(OcclusionQueryPtr query, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.writeOcclusionQueryResultToBuffer(query, offset, buff);
+}
+
+void CommandBuffer::copyBufferToBuffer(BufferPtr src, PtrSize srcOffset, BufferPtr dst, PtrSize dstOffset,
+									   PtrSize range)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.copyBufferToBuffer(src, srcOffset, dst, dstOffset, range);
+}
+
+void CommandBuffer::buildAccelerationStructure(AccelerationStructurePtr as)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.buildAccelerationStructure(as);
+}
+
+void CommandBuffer::setTextureBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
+									  const TextureSubresourceInfo& subresource)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setTextureBarrier(tex, prevUsage, nextUsage, subresource);
+}
+
+void CommandBuffer::setTextureSurfaceBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
+											 const TextureSurfaceInfo& surf)
+{
+	if(ANKI_UNLIKELY(surf.m_level > 0 && nextUsage == TextureUsageBit::GENERATE_MIPMAPS))
+	{
+		// Same as Vulkan. This transition happens inside generateMipmaps2d
+		return;
+	}
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setTextureBarrier(tex, prevUsage, nextUsage, TextureSubresourceInfo(surf, tex->getDepthStencilAspect()));
+}
+
+void CommandBuffer::setTextureVolumeBarrier(TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
+											const TextureVolumeInfo& vol)
+{
+	ANKI_ASSERT(vol.m_level == 0 || !(nextUsage & TextureUsageBit::GENERATE_MIPMAPS));
+
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setTextureBarrier(tex, prevUsage, nextUsage, TextureSubresourceInfo(vol, tex->getDepthStencilAspect()));
+}
+
+void CommandBuffer::setBufferBarrier(BufferPtr buff, BufferUsageBit before, BufferUsageBit after, PtrSize offset,
+									 PtrSize size)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setBufferBarrier(buff, before, after, offset, size);
+}
+
+void CommandBuffer::setAccelerationStructureBarrier(AccelerationStructurePtr as,
+													AccelerationStructureUsageBit prevUsage,
+													AccelerationStructureUsageBit nextUsage)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setAccelerationStructureBarrier(as, prevUsage, nextUsage);
+}
+
+void CommandBuffer::resetOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.resetOcclusionQuery(query);
+}
+
+void CommandBuffer::beginOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.beginOcclusionQuery(query);
+}
+
+void CommandBuffer::endOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.endOcclusionQuery(query);
+}
+
+void CommandBuffer::pushSecondLevelCommandBuffer(CommandBufferPtr cmdb)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushSecondLevelCommandBuffer(cmdb);
+}
+
+void CommandBuffer::resetTimestampQuery(TimestampQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.resetTimestampQuery(query);
+}
+
+void CommandBuffer::writeTimestamp(TimestampQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.writeTimestamp(query);
+}
+
+Bool CommandBuffer::isEmpty() const
+{
+	ANKI_NULL_SELF_CONST(CommandBufferImpl);
+	return self.isEmpty();
+}
+
+U32 CommandBuffer::getSkippedDrawcallCount() const
+{
+	// Pipelines are always created before the drawcalls
+	return 0;
+}
+
+void CommandBuffer::setPushConstants(const void* data, U32 dataSize)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setPushConstants(data, dataSize);
+}
+
+void CommandBuffer::setRasterizationOrder(RasterizationOrder order)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::RASTERIZATION_ORDER, order);
+}
+
+void CommandBuffer::setLineWidth(F32 width)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState(NullStateType::LINE_WIDTH, width);
+}
+
+void CommandBuffer::addReference(GrObjectPtr ptr)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.addReference(ptr);
+}
+
+} // end namespace anki
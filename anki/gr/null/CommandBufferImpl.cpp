@@ -0,0 +1,652 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/CommandBufferImpl.h>
+#include <anki/gr/null/BufferImpl.h>
+#include <anki/gr/null/TextureImpl.h>
+#include <anki/gr/null/TextureViewImpl.h>
+#include <anki/gr/null/FramebufferImpl.h>
+#include <anki/gr/null/ShaderProgramImpl.h>
+#include <anki/gr/null/OcclusionQueryImpl.h>
+#include <anki/gr/null/TimestampQueryImpl.h>
+#include <anki/gr/Sampler.h>
+#include <anki/gr/AccelerationStructure.h>
+#include <anki/util/HighRezTimer.h>
+
+namespace anki
+{
+
+CommandBufferImpl::~CommandBufferImpl()
+{
+	m_commands.destroy(getAllocator());
+	m_refs.destroy(getAllocator());
+	m_deferredOps.destroy(getAllocator());
+}
+
+Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
+{
+	m_flags = init.m_flags;
+	m_recordCommands = getGrManagerImpl().getRecordCommands();
+	m_stats.m_commandBufferCount = 1;
+
+	if(!!(m_flags & CommandBufferFlag::ASYNC_COMPUTE))
+	{
+		ANKI_ASSERT(!(m_flags & (CommandBufferFlag::GRAPHICS_WORK | CommandBufferFlag::SECOND_LEVEL)));
+
+		// Fallback to the general queue like the real backends do
+		if(getGrManagerImpl().getDeviceCapabilities().m_asyncCompute)
+		{
+			m_stats.m_asyncComputeCommandBufferCount = 1;
+		}
+		else
+		{
+			m_flags &= ~CommandBufferFlag::ASYNC_COMPUTE;
+		}
+	}
+
+	// Second level command buffers are recorded inside the render pass of the primary
+	if(isSecondLevel())
+	{
+		ANKI_ASSERT(init.m_framebuffer.isCreated());
+		m_activeFb = init.m_framebuffer;
+		m_colorAttachmentUsages = init.m_colorAttachmentUsages;
+		m_depthStencilAttachmentUsage = init.m_depthStencilAttachmentUsage;
+	}
+
+	getGrManagerImpl().onCommandBufferCreated();
+
+	return Error::NONE;
+}
+
+void CommandBufferImpl::endRecording()
+{
+	ANKI_ASSERT(!m_finalized);
+	ANKI_ASSERT(isSecondLevel() || !insideRenderPass());
+	m_finalized = true;
+}
+
+void CommandBufferImpl::bindVertexBuffer(U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize stride,
+										 VertexStepRate stepRate)
+{
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*buff).usageValid(BufferUsageBit::VERTEX));
+	ANKI_ASSERT(offset < buff->getSize());
+	ANKI_ASSERT(stride > 0);
+
+	pushCommand(NullCommandType::BIND_VERTEX_BUFFER, binding, buff.get(), offset, stride, stepRate);
+	++m_stats.m_bindingCount;
+	addReference(buff);
+}
+
+void CommandBufferImpl::bindIndexBuffer(const BufferPtr& buff, PtrSize offset, IndexType type)
+{
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*buff).usageValid(BufferUsageBit::INDEX));
+	ANKI_ASSERT(offset < buff->getSize());
+
+	pushCommand(NullCommandType::BIND_INDEX_BUFFER, buff.get(), offset, type);
+	++m_stats.m_bindingCount;
+	m_indexBufferBound = true;
+	addReference(buff);
+}
+
+void CommandBufferImpl::bindTexture(U32 set, U32 binding, const TextureViewPtr& texView, TextureUsageBit usage,
+									U32 arrayIdx)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	const TextureImpl& tex = static_cast<const TextureImpl&>(*view.getTexture());
+	ANKI_ASSERT(tex.usageValid(usage));
+	ANKI_ASSERT(tex.isSubresourceGoodForSampling(view.getSubresource()));
+	(void)view;
+	(void)tex;
+
+	pushCommand(NullCommandType::BIND_TEXTURE, set, binding, texView.get(), usage, arrayIdx);
+	++m_stats.m_bindingCount;
+	addReference(texView);
+}
+
+void CommandBufferImpl::bindSampler(U32 set, U32 binding, const SamplerPtr& sampler, U32 arrayIdx)
+{
+	pushCommand(NullCommandType::BIND_SAMPLER, set, binding, sampler.get(), arrayIdx);
+	++m_stats.m_bindingCount;
+	addReference(sampler);
+}
+
+void CommandBufferImpl::validateBufferBinding(const BufferPtr& buff, BufferUsageBit usage, PtrSize offset,
+											  PtrSize range, U32 alignment, PtrSize maxRange) const
+{
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(!!(impl.getBufferUsage() & usage) && "The buffer was not created with the correct usage");
+	ANKI_ASSERT(impl.rangeValid(offset, range));
+	ANKI_ASSERT(isAligned(alignment, offset) && "Offset is not aligned to the device's requirement");
+
+	range = (range == MAX_PTR_SIZE) ? impl.getSize() - offset : range;
+	ANKI_ASSERT(range <= maxRange && "Range is bigger than what the device supports");
+
+	(void)impl;
+	(void)alignment;
+	(void)maxRange;
+	(void)range;
+}
+
+void CommandBufferImpl::bindUniformBuffer(U32 set, U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize range,
+										  U32 arrayIdx)
+{
+	const GpuDeviceCapabilities& caps = getManager().getDeviceCapabilities();
+	validateBufferBinding(buff, BufferUsageBit::ALL_UNIFORM, offset, range, caps.m_uniformBufferBindOffsetAlignment,
+						  caps.m_uniformBufferMaxRange);
+
+	pushCommand(NullCommandType::BIND_UNIFORM_BUFFER, set, binding, buff.get(), offset, range, arrayIdx);
+	++m_stats.m_bindingCount;
+	addReference(buff);
+}
+
+void CommandBufferImpl::bindStorageBuffer(U32 set, U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize range,
+										  U32 arrayIdx)
+{
+	const GpuDeviceCapabilities& caps = getManager().getDeviceCapabilities();
+	validateBufferBinding(buff, BufferUsageBit::ALL_STORAGE, offset, range, caps.m_storageBufferBindOffsetAlignment,
+						  caps.m_storageBufferMaxRange);
+
+	pushCommand(NullCommandType::BIND_STORAGE_BUFFER, set, binding, buff.get(), offset, range, arrayIdx);
+	++m_stats.m_bindingCount;
+	addReference(buff);
+}
+
+void CommandBufferImpl::bindTextureBuffer(U32 set, U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize range,
+										  Format fmt, U32 arrayIdx)
+{
+	const GpuDeviceCapabilities& caps = getManager().getDeviceCapabilities();
+	validateBufferBinding(buff, BufferUsageBit::ALL_TEXTURE, offset, range, caps.m_textureBufferBindOffsetAlignment,
+						  caps.m_textureBufferMaxRange);
+
+	pushCommand(NullCommandType::BIND_TEXTURE_BUFFER, set, binding, buff.get(), offset, range, fmt, arrayIdx);
+	++m_stats.m_bindingCount;
+	addReference(buff);
+}
+
+void CommandBufferImpl::bindImage(U32 set, U32 binding, const TextureViewPtr& img, U32 arrayIdx)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*img);
+	const TextureImpl& tex = static_cast<const TextureImpl&>(*view.getTexture());
+	ANKI_ASSERT(!!(tex.getTextureUsage() & TextureUsageBit::ALL_IMAGE));
+	ANKI_ASSERT(tex.isSubresourceGoodForImageLoadStore(view.getSubresource()));
+	(void)view;
+	(void)tex;
+
+	pushCommand(NullCommandType::BIND_IMAGE, set, binding, img.get(), arrayIdx);
+	++m_stats.m_bindingCount;
+	addReference(img);
+}
+
+void CommandBufferImpl::bindAccelerationStructure(U32 set, U32 binding, const AccelerationStructurePtr& as,
+												  U32 arrayIdx)
+{
+	ANKI_ASSERT(getManager().getDeviceCapabilities().m_rayTracingEnabled);
+	ANKI_ASSERT(as->getType() == AccelerationStructureType::TOP_LEVEL);
+
+	pushCommand(NullCommandType::BIND_ACCELERATION_STRUCTURE, set, binding, as.get(), arrayIdx);
+	++m_stats.m_bindingCount;
+	addReference(as);
+}
+
+void CommandBufferImpl::setPushConstants(const void* data, U32 dataSize)
+{
+	ANKI_ASSERT(data && dataSize && dataSize % 16 == 0);
+	ANKI_ASSERT(dataSize <= getManager().getDeviceCapabilities().m_pushConstantsSize);
+	ANKI_ASSERT((m_graphicsProg || m_computeProg || m_rtProg) && "Need to have bound a program");
+
+	pushCommand(NullCommandType::SET_PUSH_CONSTANTS, computeHash(data, dataSize), dataSize);
+}
+
+void CommandBufferImpl::bindShaderProgram(const ShaderProgramPtr& prog)
+{
+	const ShaderProgramImpl& impl = static_cast<const ShaderProgramImpl&>(*prog);
+
+	if(impl.isGraphics())
+	{
+		m_graphicsProg = &impl;
+		m_computeProg = nullptr;
+		m_rtProg = nullptr;
+	}
+	else if(impl.isCompute())
+	{
+		m_computeProg = &impl;
+		m_graphicsProg = nullptr;
+		m_rtProg = nullptr;
+	}
+	else
+	{
+		ANKI_ASSERT(impl.isRayTracing());
+		ANKI_ASSERT(getManager().getDeviceCapabilities().m_rayTracingEnabled);
+		m_rtProg = &impl;
+		m_graphicsProg = nullptr;
+		m_computeProg = nullptr;
+	}
+
+	pushCommand(NullCommandType::BIND_SHADER_PROGRAM, prog.get());
+	addReference(prog);
+}
+
+void CommandBufferImpl::beginRenderPass(const FramebufferPtr& fb,
+										const Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS>& colorAttachmentUsages,
+										TextureUsageBit depthStencilAttachmentUsage, U32 minx, U32 miny, U32 width,
+										U32 height)
+{
+	ANKI_ASSERT(!insideRenderPass() && "Already inside a render pass");
+	ANKI_ASSERT(!isSecondLevel());
+	ANKI_ASSERT(!(m_flags & CommandBufferFlag::ASYNC_COMPUTE) && "No graphics work in the async compute queue");
+
+	const FramebufferImpl& impl = static_cast<const FramebufferImpl&>(*fb);
+
+#if ANKI_ENABLE_ASSERTS
+	// The attachments should be in one of the attachment usages
+	for(U32 i = 0; i < impl.getColorAttachmentCount(); ++i)
+	{
+		const TextureUsageBit usage = colorAttachmentUsages[i];
+		ANKI_ASSERT(!!(usage & TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT)
+					&& !(usage & ~TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT) && "Wrong color attachment usage");
+
+		const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*impl.getColorAttachment(i));
+		ANKI_ASSERT(static_cast<const TextureImpl&>(*view.getTexture()).usageValid(usage));
+	}
+
+	if(impl.getDepthStencilAttachment().isCreated())
+	{
+		const TextureUsageBit usage = depthStencilAttachmentUsage;
+		ANKI_ASSERT(!!(usage & TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT)
+					&& "Wrong depth stencil attachment usage");
+
+		const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*impl.getDepthStencilAttachment());
+		ANKI_ASSERT(static_cast<const TextureImpl&>(*view.getTexture()).usageValid(usage));
+	}
+
+	U32 fbWidth, fbHeight;
+	impl.getAttachmentsSize(fbWidth, fbHeight);
+	ANKI_ASSERT(minx < fbWidth && miny < fbHeight);
+	ANKI_ASSERT(width == MAX_U32 || minx + width <= fbWidth);
+	ANKI_ASSERT(height == MAX_U32 || miny + height <= fbHeight);
+#endif
+	(void)impl;
+
+	m_activeFb = fb;
+	m_colorAttachmentUsages = colorAttachmentUsages;
+	m_depthStencilAttachmentUsage = depthStencilAttachmentUsage;
+
+	pushCommand(NullCommandType::BEGIN_RENDER_PASS, fb.get(), minx, miny, width, height);
+	++m_stats.m_renderPassCount;
+	addReference(fb);
+}
+
+void CommandBufferImpl::endRenderPass()
+{
+	ANKI_ASSERT(insideRenderPass() && !isSecondLevel());
+
+	m_activeFb.reset(nullptr);
+	pushCommand(NullCommandType::END_RENDER_PASS);
+}
+
+void CommandBufferImpl::validateDrawcall() const
+{
+	ANKI_ASSERT(m_graphicsProg && "Need to bind a graphics program");
+	ANKI_ASSERT(insideRenderPass() && "Drawcalls should be inside a render pass");
+}
+
+void CommandBufferImpl::drawElements(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex,
+									 U32 baseVertex, U32 baseInstance)
+{
+	validateDrawcall();
+	ANKI_ASSERT(m_indexBufferBound && "Need to bind an index buffer");
+
+	pushCommand(NullCommandType::DRAW, topology, count, instanceCount, firstIndex, baseVertex, baseInstance);
+	++m_stats.m_drawcallCount;
+	m_stats.m_primitiveCount += U64(count) * instanceCount;
+}
+
+void CommandBufferImpl::drawArrays(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first,
+								   U32 baseInstance)
+{
+	validateDrawcall();
+
+	pushCommand(NullCommandType::DRAW, topology, count, instanceCount, first, baseInstance);
+	++m_stats.m_drawcallCount;
+	m_stats.m_primitiveCount += U64(count) * instanceCount;
+}
+
+void CommandBufferImpl::drawIndirect(Bool indexed, PrimitiveTopology topology, U32 drawCount, PtrSize offset,
+									 const BufferPtr& indirectBuff)
+{
+	validateDrawcall();
+	ANKI_ASSERT(!indexed || m_indexBufferBound);
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*indirectBuff).usageValid(BufferUsageBit::INDIRECT_DRAW));
+	ANKI_ASSERT((offset % 4) == 0);
+	ANKI_ASSERT(offset
+					+ ((indexed) ? sizeof(DrawElementsIndirectInfo) : sizeof(DrawArraysIndirectInfo)) * drawCount
+				<= indirectBuff->getSize());
+
+	pushCommand(NullCommandType::DRAW_INDIRECT, indexed, topology, drawCount, offset, indirectBuff.get());
+	m_stats.m_drawcallCount += drawCount;
+	addReference(indirectBuff);
+}
+
+void CommandBufferImpl::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
+{
+	ANKI_ASSERT(m_computeProg && "Need to bind a compute program");
+	ANKI_ASSERT(!!(m_flags & CommandBufferFlag::COMPUTE_WORK));
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(groupCountX > 0 && groupCountY > 0 && groupCountZ > 0);
+
+	pushCommand(NullCommandType::DISPATCH_COMPUTE, groupCountX, groupCountY, groupCountZ);
+	++m_stats.m_dispatchCount;
+}
+
+void CommandBufferImpl::traceRays(const BufferPtr& sbtBuffer, PtrSize sbtBufferOffset, U32 sbtRecordSize,
+								  U32 hitGroupSbtRecordCount, U32 rayTypeCount, U32 width, U32 height, U32 depth)
+{
+	ANKI_ASSERT(m_rtProg && "Need to bind a ray tracing program");
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(hitGroupSbtRecordCount > 0 && rayTypeCount > 0);
+	ANKI_ASSERT((hitGroupSbtRecordCount % rayTypeCount) == 0);
+	ANKI_ASSERT(width > 0 && height > 0 && depth > 0);
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*sbtBuffer).usageValid(BufferUsageBit::SBT));
+	ANKI_ASSERT(isAligned(getManager().getDeviceCapabilities().m_sbtRecordAlignment, sbtBufferOffset));
+	ANKI_ASSERT(sbtBufferOffset + PtrSize(sbtRecordSize) * (1 + rayTypeCount + hitGroupSbtRecordCount)
+				<= sbtBuffer->getSize());
+
+	pushCommand(NullCommandType::TRACE_RAYS, sbtBuffer.get(), sbtBufferOffset, sbtRecordSize, hitGroupSbtRecordCount,
+				rayTypeCount, width, height, depth);
+	++m_stats.m_traceRaysCount;
+	addReference(sbtBuffer);
+}
+
+void CommandBufferImpl::generateMipmaps(const TextureViewPtr& texView, Bool is3d)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	const TextureImpl& tex = static_cast<const TextureImpl&>(*view.getTexture());
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(tex.usageValid(TextureUsageBit::GENERATE_MIPMAPS));
+	ANKI_ASSERT(tex.isSubresourceGoodForMipmapGeneration(view.getSubresource()));
+	ANKI_ASSERT(is3d == (tex.getTextureType() == TextureType::_3D));
+	(void)view;
+	(void)tex;
+
+	pushCommand(NullCommandType::GENERATE_MIPMAPS, texView.get(), is3d);
+	addReference(texView);
+}
+
+void CommandBufferImpl::clearTextureView(const TextureViewPtr& texView, const ClearValue& clearValue)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(static_cast<const TextureImpl&>(*view.getTexture()).usageValid(TextureUsageBit::TRANSFER_DESTINATION));
+	(void)view;
+
+	pushCommand(NullCommandType::CLEAR_TEXTURE_VIEW, texView.get(), computeHash(&clearValue, sizeof(clearValue)));
+	addReference(texView);
+}
+
+void CommandBufferImpl::copyBufferToTextureView(const BufferPtr& buff, PtrSize offset, PtrSize range,
+												const TextureViewPtr& texView)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	const TextureImpl& tex = static_cast<const TextureImpl&>(*view.getTexture());
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(tex.usageValid(TextureUsageBit::TRANSFER_DESTINATION));
+	ANKI_ASSERT(tex.isSubresourceGoodForCopyFromBuffer(view.getSubresource()));
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*buff).usageValid(BufferUsageBit::TRANSFER_SOURCE));
+	ANKI_ASSERT(range > 0 && offset + range <= buff->getSize());
+	(void)view;
+	(void)tex;
+
+	pushCommand(NullCommandType::COPY_BUFFER_TO_TEXTURE_VIEW, buff.get(), offset, range, texView.get());
+	m_stats.m_transferBytes += range;
+	addReference(buff);
+	addReference(texView);
+}
+
+void CommandBufferImpl::fillBuffer(BufferPtr& buff, PtrSize offset, PtrSize size, U32 value)
+{
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::TRANSFER_DESTINATION));
+	ANKI_ASSERT(offset < impl.getSize());
+	ANKI_ASSERT((offset % 4) == 0 && "Should be multiple of 4");
+
+	size = (size == MAX_PTR_SIZE) ? (impl.getSize() - offset) : size;
+	alignRoundUp(4, size); // Needs to be multiple of 4
+	ANKI_ASSERT(offset + size <= impl.getSize());
+
+	pushCommand(NullCommandType::FILL_BUFFER, buff.get(), offset, size, value);
+	m_stats.m_transferBytes += size;
+
+	DeferredOperation op;
+	op.m_type = DeferredOperation::Type::FILL_BUFFER;
+	op.m_object0 = buff.get();
+	op.m_offset0 = offset;
+	op.m_range = size;
+	op.m_value = value;
+	pushDeferredOperation(op);
+	addReference(buff);
+}
+
+void CommandBufferImpl::writeOcclusionQueryResultToBuffer(OcclusionQueryPtr& query, PtrSize offset, BufferPtr& buff)
+{
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::TRANSFER_DESTINATION));
+	ANKI_ASSERT((offset % 4) == 0);
+	ANKI_ASSERT((offset + sizeof(U32)) <= impl.getSize());
+	(void)impl;
+
+	pushCommand(NullCommandType::WRITE_OCCLUSION_QUERY_RESULT_TO_BUFFER, query.get(), offset, buff.get());
+	m_stats.m_transferBytes += sizeof(U32);
+
+	DeferredOperation op;
+	op.m_type = DeferredOperation::Type::WRITE_OCCLUSION_QUERY_RESULT;
+	op.m_object0 = buff.get();
+	op.m_object1 = query.get();
+	op.m_offset0 = offset;
+	pushDeferredOperation(op);
+	addReference(query);
+	addReference(buff);
+}
+
+void CommandBufferImpl::copyBufferToBuffer(BufferPtr& src, PtrSize srcOffset, BufferPtr& dst, PtrSize dstOffset,
+										   PtrSize range)
+{
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*src).usageValid(BufferUsageBit::TRANSFER_SOURCE));
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*dst).usageValid(BufferUsageBit::TRANSFER_DESTINATION));
+	ANKI_ASSERT(range > 0);
+	ANKI_ASSERT(srcOffset + range <= src->getSize());
+	ANKI_ASSERT(dstOffset + range <= dst->getSize());
+
+	pushCommand(NullCommandType::COPY_BUFFER_TO_BUFFER, src.get(), srcOffset, dst.get(), dstOffset, range);
+	m_stats.m_transferBytes += range;
+
+	DeferredOperation op;
+	op.m_type = DeferredOperation::Type::COPY_BUFFER_TO_BUFFER;
+	op.m_object0 = src.get();
+	op.m_object1 = dst.get();
+	op.m_offset0 = srcOffset;
+	op.m_offset1 = dstOffset;
+	op.m_range = range;
+	pushDeferredOperation(op);
+	addReference(src);
+	addReference(dst);
+}
+
+void CommandBufferImpl::buildAccelerationStructure(const AccelerationStructurePtr& as)
+{
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(getManager().getDeviceCapabilities().m_rayTracingEnabled);
+
+	pushCommand(NullCommandType::BUILD_ACCELERATION_STRUCTURE, as.get());
+	addReference(as);
+}
+
+void CommandBufferImpl::setTextureBarrier(const TexturePtr& tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
+										  const TextureSubresourceInfo& subresource)
+{
+	const TextureImpl& impl = static_cast<const TextureImpl&>(*tex);
+	ANKI_ASSERT(!insideRenderPass() && "Barriers are not allowed inside render passes");
+	ANKI_ASSERT(impl.usageValid(prevUsage));
+	ANKI_ASSERT(impl.usageValid(nextUsage));
+	ANKI_ASSERT(((nextUsage & TextureUsageBit::GENERATE_MIPMAPS) == TextureUsageBit::GENERATE_MIPMAPS
+				 || (nextUsage & TextureUsageBit::GENERATE_MIPMAPS) == TextureUsageBit::NONE)
+				&& "GENERATE_MIPMAPS should be alone");
+	ANKI_ASSERT(impl.isSubresourceValid(subresource));
+	(void)impl;
+
+	pushCommand(NullCommandType::TEXTURE_BARRIER, tex.get(), prevUsage, nextUsage,
+				computeHash(&subresource, sizeof(subresource)));
+	++m_stats.m_barrierCount;
+	addReference(tex);
+}
+
+void CommandBufferImpl::setBufferBarrier(const BufferPtr& buff, BufferUsageBit prevUsage, BufferUsageBit nextUsage,
+										 PtrSize offset, PtrSize size)
+{
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(!insideRenderPass() && "Barriers are not allowed inside render passes");
+	ANKI_ASSERT(impl.usageValid(prevUsage));
+	ANKI_ASSERT(impl.usageValid(nextUsage));
+	ANKI_ASSERT(impl.rangeValid(offset, size));
+	(void)impl;
+
+	pushCommand(NullCommandType::BUFFER_BARRIER, buff.get(), prevUsage, nextUsage, offset, size);
+	++m_stats.m_barrierCount;
+	addReference(buff);
+}
+
+void CommandBufferImpl::setAccelerationStructureBarrier(const AccelerationStructurePtr& as,
+														AccelerationStructureUsageBit prevUsage,
+														AccelerationStructureUsageBit nextUsage)
+{
+	ANKI_ASSERT(!insideRenderPass() && "Barriers are not allowed inside render passes");
+
+	pushCommand(NullCommandType::ACCELERATION_STRUCTURE_BARRIER, as.get(), prevUsage, nextUsage);
+	++m_stats.m_barrierCount;
+	addReference(as);
+}
+
+void CommandBufferImpl::resetOcclusionQuery(const OcclusionQueryPtr& query)
+{
+	ANKI_ASSERT(!insideRenderPass());
+
+	pushCommand(NullCommandType::OCCLUSION_QUERY, query.get(), 0);
+	addReference(query);
+}
+
+void CommandBufferImpl::beginOcclusionQuery(const OcclusionQueryPtr& query)
+{
+	pushCommand(NullCommandType::OCCLUSION_QUERY, query.get(), 1);
+	addReference(query);
+}
+
+void CommandBufferImpl::endOcclusionQuery(OcclusionQueryPtr& query)
+{
+	pushCommand(NullCommandType::OCCLUSION_QUERY, query.get(), 2);
+
+	DeferredOperation op;
+	op.m_type = DeferredOperation::Type::END_OCCLUSION_QUERY;
+	op.m_object0 = query.get();
+	pushDeferredOperation(op);
+	addReference(query);
+}
+
+void CommandBufferImpl::resetTimestampQuery(const TimestampQueryPtr& query)
+{
+	ANKI_ASSERT(!insideRenderPass());
+
+	pushCommand(NullCommandType::TIMESTAMP_QUERY, query.get(), 0);
+	addReference(query);
+}
+
+void CommandBufferImpl::writeTimestamp(TimestampQueryPtr& query)
+{
+	pushCommand(NullCommandType::TIMESTAMP_QUERY, query.get(), 1);
+
+	DeferredOperation op;
+	op.m_type = DeferredOperation::Type::WRITE_TIMESTAMP;
+	op.m_object0 = query.get();
+	pushDeferredOperation(op);
+	addReference(query);
+}
+
+void CommandBufferImpl::pushSecondLevelCommandBuffer(const CommandBufferPtr& cmdb)
+{
+	const CommandBufferImpl& impl = static_cast<const CommandBufferImpl&>(*cmdb);
+	ANKI_ASSERT(insideRenderPass() && !isSecondLevel());
+	ANKI_ASSERT(impl.isSecondLevel() && impl.m_finalized && "Should be a flushed second level command buffer");
+	ANKI_ASSERT(impl.m_activeFb == m_activeFb && "Second level and primary should use the same framebuffer");
+
+	pushCommand(NullCommandType::PUSH_SECOND_LEVEL, impl.m_stats.m_commandStreamHash);
+
+	// The second level's commands become part of this command buffer
+	m_stats.m_commandCount += impl.m_stats.m_commandCount;
+	m_stats.m_drawcallCount += impl.m_stats.m_drawcallCount;
+	m_stats.m_primitiveCount += impl.m_stats.m_primitiveCount;
+	m_stats.m_bindingCount += impl.m_stats.m_bindingCount;
+	m_stats.m_commandBufferCount += impl.m_stats.m_commandBufferCount;
+
+	if(m_recordCommands)
+	{
+		for(const NullCommand& cmd : impl.m_commands)
+		{
+			m_commands.emplaceBack(getAllocator(), cmd);
+		}
+	}
+
+	for(const DeferredOperation& op : impl.m_deferredOps)
+	{
+		pushDeferredOperation(op);
+	}
+
+	addReference(cmdb);
+}
+
+void CommandBufferImpl::execute()
+{
+	ANKI_ASSERT(m_finalized);
+	const Second timestamp = HighRezTimer::getCurrentTime();
+
+	for(const DeferredOperation& op : m_deferredOps)
+	{
+		switch(op.m_type)
+		{
+		case DeferredOperation::Type::FILL_BUFFER:
+		{
+			U8* mem = static_cast<BufferImpl&>(*op.m_object0).getMemory() + op.m_offset0;
+			for(PtrSize i = 0; i < op.m_range; i += sizeof(U32))
+			{
+				memcpy(mem + i, &op.m_value, sizeof(U32));
+			}
+			break;
+		}
+		case DeferredOperation::Type::COPY_BUFFER_TO_BUFFER:
+		{
+			const U8* src = static_cast<BufferImpl&>(*op.m_object0).getMemory() + op.m_offset0;
+			U8* dst = static_cast<BufferImpl&>(*op.m_object1).getMemory() + op.m_offset1;
+			memmove(dst, src, op.m_range);
+			break;
+		}
+		case DeferredOperation::Type::END_OCCLUSION_QUERY:
+			static_cast<OcclusionQueryImpl&>(*op.m_object0).setResult(OcclusionQueryResult::VISIBLE);
+			break;
+		case DeferredOperation::Type::WRITE_OCCLUSION_QUERY_RESULT:
+		{
+			const U32 result = 1;
+			memcpy(static_cast<BufferImpl&>(*op.m_object0).getMemory() + op.m_offset0, &result, sizeof(result));
+			break;
+		}
+		case DeferredOperation::Type::WRITE_TIMESTAMP:
+			static_cast<TimestampQueryImpl&>(*op.m_object0).setTimestamp(timestamp);
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+	}
+}
+
+} // end namespace anki
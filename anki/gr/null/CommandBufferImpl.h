@@ -0,0 +1,254 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/CommandBuffer.h>
+#include <anki/gr/null/Common.h>
+#include <anki/gr/null/GrManagerImpl.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Hash.h>
+
+namespace anki
+{
+
+// Forward
+class ShaderProgramImpl;
+
+/// @addtogroup null
+/// @{
+
+/// Command buffer implementation. The commands are validated, counted and hashed. The transfers that produce
+/// something the CPU can observe (buffer fills and copies, query results) are executed at flush time.
+class CommandBufferImpl final : public CommandBuffer
+{
+public:
+	CommandBufferImpl(GrManager* manager, CString name)
+		: CommandBuffer(manager, name)
+	{
+	}
+
+	~CommandBufferImpl();
+
+	ANKI_USE_RESULT Error init(const CommandBufferInitInfo& init);
+
+	void endRecording();
+
+	Bool isSecondLevel() const
+	{
+		return !!(m_flags & CommandBufferFlag::SECOND_LEVEL);
+	}
+
+	Bool isAsyncCompute() const
+	{
+		return !!(m_flags & CommandBufferFlag::ASYNC_COMPUTE);
+	}
+
+	Bool isEmpty() const
+	{
+		return m_stats.m_commandCount == 0;
+	}
+
+	/// All the pipeline state setters end up here. They don't need any validation.
+	template<typename... TArgs>
+	void setState(NullStateType state, const TArgs&... args)
+	{
+		pushCommand(NullCommandType::SET_STATE, state, args...);
+	}
+
+	void bindVertexBuffer(U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate);
+
+	void setVertexAttribute(U32 location, U32 buffBinding, Format fmt, PtrSize relativeOffset)
+	{
+		pushCommand(NullCommandType::SET_VERTEX_ATTRIBUTE, location, buffBinding, fmt, relativeOffset);
+	}
+
+	void bindIndexBuffer(const BufferPtr& buff, PtrSize offset, IndexType type);
+
+	void bindTexture(U32 set, U32 binding, const TextureViewPtr& texView, TextureUsageBit usage, U32 arrayIdx);
+
+	void bindSampler(U32 set, U32 binding, const SamplerPtr& sampler, U32 arrayIdx);
+
+	void bindUniformBuffer(U32 set, U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize range, U32 arrayIdx);
+
+	void bindStorageBuffer(U32 set, U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize range, U32 arrayIdx);
+
+	void bindTextureBuffer(U32 set, U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize range, Format fmt,
+						   U32 arrayIdx);
+
+	void bindImage(U32 set, U32 binding, const TextureViewPtr& img, U32 arrayIdx);
+
+	void bindAccelerationStructure(U32 set, U32 binding, const AccelerationStructurePtr& as, U32 arrayIdx);
+
+	void bindAllBindless(U32 set)
+	{
+		pushCommand(NullCommandType::BIND_ALL_BINDLESS, set);
+	}
+
+	void setPushConstants(const void* data, U32 dataSize);
+
+	void bindShaderProgram(const ShaderProgramPtr& prog);
+
+	void beginRenderPass(const FramebufferPtr& fb,
+						 const Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS>& colorAttachmentUsages,
+						 TextureUsageBit depthStencilAttachmentUsage, U32 minx, U32 miny, U32 width, U32 height);
+
+	void endRenderPass();
+
+	void drawElements(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex, U32 baseVertex,
+					  U32 baseInstance);
+
+	void drawArrays(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance);
+
+	void drawIndirect(Bool indexed, PrimitiveTopology topology, U32 drawCount, PtrSize offset,
+					  const BufferPtr& indirectBuff);
+
+	void dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ);
+
+	void traceRays(const BufferPtr& sbtBuffer, PtrSize sbtBufferOffset, U32 sbtRecordSize, U32 hitGroupSbtRecordCount,
+				   U32 rayTypeCount, U32 width, U32 height, U32 depth);
+
+	void generateMipmaps(const TextureViewPtr& texView, Bool is3d);
+
+	void clearTextureView(const TextureViewPtr& texView, const ClearValue& clearValue);
+
+	void copyBufferToTextureView(const BufferPtr& buff, PtrSize offset, PtrSize range, const TextureViewPtr& texView);
+
+	void fillBuffer(BufferPtr& buff, PtrSize offset, PtrSize size, U32 value);
+
+	void writeOcclusionQueryResultToBuffer(OcclusionQueryPtr& query, PtrSize offset, BufferPtr& buff);
+
+	void copyBufferToBuffer(BufferPtr& src, PtrSize srcOffset, BufferPtr& dst, PtrSize dstOffset, PtrSize range);
+
+	void buildAccelerationStructure(const AccelerationStructurePtr& as);
+
+	void setTextureBarrier(const TexturePtr& tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage,
+						   const TextureSubresourceInfo& subresource);
+
+	void setBufferBarrier(const BufferPtr& buff, BufferUsageBit prevUsage, BufferUsageBit nextUsage, PtrSize offset,
+						  PtrSize size);
+
+	void setAccelerationStructureBarrier(const AccelerationStructurePtr& as, AccelerationStructureUsageBit prevUsage,
+										 AccelerationStructureUsageBit nextUsage);
+
+	void resetOcclusionQuery(const OcclusionQueryPtr& query);
+
+	void beginOcclusionQuery(const OcclusionQueryPtr& query);
+
+	void endOcclusionQuery(OcclusionQueryPtr& query);
+
+	void resetTimestampQuery(const TimestampQueryPtr& query);
+
+	void writeTimestamp(TimestampQueryPtr& query);
+
+	void pushSecondLevelCommandBuffer(const CommandBufferPtr& cmdb);
+
+	void addReference(const GrObjectPtr& ptr)
+	{
+		m_refs.emplaceBack(getAllocator(), ptr);
+	}
+
+	GrManagerImpl& getGrManagerImpl()
+	{
+		return static_cast<GrManagerImpl&>(getManager());
+	}
+
+	/// Execute the deferred work. Called by the GrManagerImpl when the command buffer is flushed.
+	void execute();
+
+	const NullFrameStats& getStats() const
+	{
+		return m_stats;
+	}
+
+	/// Empty if gr_nullRecordCommands is off.
+	ConstWeakArray<NullCommand> getCommands() const
+	{
+		return m_commands;
+	}
+
+private:
+	/// Work that will be executed at flush time.
+	class DeferredOperation
+	{
+	public:
+		enum class Type : U8
+		{
+			FILL_BUFFER,
+			COPY_BUFFER_TO_BUFFER,
+			END_OCCLUSION_QUERY,
+			WRITE_OCCLUSION_QUERY_RESULT,
+			WRITE_TIMESTAMP
+		};
+
+		GrObject* m_object0 = nullptr; ///< The references are held by m_refs.
+		GrObject* m_object1 = nullptr;
+		PtrSize m_offset0 = 0;
+		PtrSize m_offset1 = 0;
+		PtrSize m_range = 0;
+		U32 m_value = 0;
+		Type m_type;
+	};
+
+	CommandBufferFlag m_flags = CommandBufferFlag::NONE;
+	Bool m_finalized = false;
+	Bool m_recordCommands = false;
+	Bool m_indexBufferBound = false;
+
+	FramebufferPtr m_activeFb;
+	Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS> m_colorAttachmentUsages = {};
+	TextureUsageBit m_depthStencilAttachmentUsage = TextureUsageBit::NONE;
+
+	/// The references are held by m_refs.
+	const ShaderProgramImpl* m_graphicsProg = nullptr;
+	const ShaderProgramImpl* m_computeProg = nullptr;
+	const ShaderProgramImpl* m_rtProg = nullptr;
+
+	NullFrameStats m_stats;
+	DynamicArray<NullCommand> m_commands;
+	DynamicArray<GrObjectPtr> m_refs;
+	DynamicArray<DeferredOperation> m_deferredOps;
+
+	Bool insideRenderPass() const
+	{
+		return m_activeFb.isCreated();
+	}
+
+	/// Count a command and hash its type and its arguments into the command stream hash.
+	template<typename... TArgs>
+	void pushCommand(NullCommandType type, const TArgs&... args)
+	{
+		ANKI_ASSERT(!m_finalized);
+		const Array<U64, sizeof...(TArgs) + 1> values = {{U64(type), toNullCommandArgument(args)...}};
+
+		NullCommand cmd;
+		cmd.m_type = type;
+		cmd.m_argumentsHash = computeHash(&values[0], sizeof(values));
+
+		m_stats.m_commandStreamHash =
+			appendHash(&cmd.m_argumentsHash, sizeof(cmd.m_argumentsHash), m_stats.m_commandStreamHash);
+		++m_stats.m_commandCount;
+
+		if(m_recordCommands)
+		{
+			m_commands.emplaceBack(getAllocator(), cmd);
+		}
+	}
+
+	void pushDeferredOperation(const DeferredOperation& op)
+	{
+		m_deferredOps.emplaceBack(getAllocator(), op);
+	}
+
+	/// Validate a uniform, storage or texture buffer binding.
+	void validateBufferBinding(const BufferPtr& buff, BufferUsageBit usage, PtrSize offset, PtrSize range,
+							   U32 alignment, PtrSize maxRange) const;
+
+	/// Validate that the bindings are consistent with the work that follows.
+	void validateDrawcall() const;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,36 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/Common.h>
+#include <anki/util/Hash.h>
+
+namespace anki
+{
+
+NullFrameStats& NullFrameStats::operator+=(const NullFrameStats& b)
+{
+	m_commandBufferCount += b.m_commandBufferCount;
+	m_commandCount += b.m_commandCount;
+	m_renderPassCount += b.m_renderPassCount;
+	m_drawcallCount += b.m_drawcallCount;
+	m_primitiveCount += b.m_primitiveCount;
+	m_dispatchCount += b.m_dispatchCount;
+	m_traceRaysCount += b.m_traceRaysCount;
+	m_barrierCount += b.m_barrierCount;
+	m_bindingCount += b.m_bindingCount;
+	m_transferBytes += b.m_transferBytes;
+	m_asyncComputeCommandBufferCount += b.m_asyncComputeCommandBufferCount;
+	m_queueWaitCount += b.m_queueWaitCount;
+	m_queueSignalCount += b.m_queueSignalCount;
+
+	// The order of the submissions matters
+	m_commandStreamHash = (m_commandStreamHash)
+							  ? appendHash(&b.m_commandStreamHash, sizeof(b.m_commandStreamHash), m_commandStreamHash)
+							  : b.m_commandStreamHash;
+
+	return *this;
+}
+
+} // end namespace anki
@@ -0,0 +1,146 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Common.h>
+#include <anki/gr/GrObject.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+// Forward
+class GrManagerImpl;
+
+/// @addtogroup null
+/// @{
+
+#define ANKI_NULL_LOGI(...) ANKI_LOG("NULL", NORMAL, __VA_ARGS__)
+#define ANKI_NULL_LOGE(...) ANKI_LOG("NULL", ERROR, __VA_ARGS__)
+#define ANKI_NULL_LOGW(...) ANKI_LOG("NULL", WARNING, __VA_ARGS__)
+#define ANKI_NULL_LOGF(...) ANKI_LOG("NULL", FATAL, __VA_ARGS__)
+
+#define ANKI_NULL_SELF(class_) class_& self = *static_cast<class_*>(this)
+#define ANKI_NULL_SELF_CONST(class_) const class_& self = *static_cast<const class_*>(this)
+
+/// The type of a recorded command. One for every CommandBuffer method.
+enum class NullCommandType : U8
+{
+	BIND_VERTEX_BUFFER,
+	SET_VERTEX_ATTRIBUTE,
+	BIND_INDEX_BUFFER,
+	SET_STATE, ///< All the pipeline state setters.
+	BIND_TEXTURE,
+	BIND_SAMPLER,
+	BIND_UNIFORM_BUFFER,
+	BIND_STORAGE_BUFFER,
+	BIND_TEXTURE_BUFFER,
+	BIND_IMAGE,
+	BIND_ACCELERATION_STRUCTURE,
+	BIND_ALL_BINDLESS,
+	SET_PUSH_CONSTANTS,
+	BIND_SHADER_PROGRAM,
+	BEGIN_RENDER_PASS,
+	END_RENDER_PASS,
+	DRAW,
+	DRAW_INDIRECT,
+	DISPATCH_COMPUTE,
+	TRACE_RAYS,
+	GENERATE_MIPMAPS,
+	CLEAR_TEXTURE_VIEW,
+	COPY_BUFFER_TO_TEXTURE_VIEW,
+	FILL_BUFFER,
+	COPY_BUFFER_TO_BUFFER,
+	WRITE_OCCLUSION_QUERY_RESULT_TO_BUFFER,
+	BUILD_ACCELERATION_STRUCTURE,
+	TEXTURE_BARRIER,
+	BUFFER_BARRIER,
+	ACCELERATION_STRUCTURE_BARRIER,
+	OCCLUSION_QUERY,
+	TIMESTAMP_QUERY,
+	PUSH_SECOND_LEVEL,
+
+	COUNT
+};
+
+/// The pipeline state setters. They are all recorded as NullCommandType::SET_STATE.
+enum class NullStateType : U8
+{
+	PRIMITIVE_RESTART,
+	VIEWPORT,
+	SCISSOR,
+	FILL_MODE,
+	CULL_MODE,
+	POLYGON_OFFSET,
+	STENCIL_OPERATIONS,
+	STENCIL_COMPARE_OPERATION,
+	STENCIL_COMPARE_MASK,
+	STENCIL_WRITE_MASK,
+	STENCIL_REFERENCE,
+	DEPTH_WRITE,
+	DEPTH_COMPARE_OPERATION,
+	ALPHA_TO_COVERAGE,
+	COLOR_CHANNEL_WRITE_MASK,
+	BLEND_FACTORS,
+	BLEND_OPERATION,
+	RASTERIZATION_ORDER,
+	LINE_WIDTH
+};
+
+/// A recorded command. The arguments are hashed. Objects are hashed using their UUIDs so the hashes are stable between
+/// runs.
+class NullCommand
+{
+public:
+	U64 m_argumentsHash;
+	NullCommandType m_type;
+};
+
+/// Counters of the work the renderer submitted in a frame.
+class NullFrameStats
+{
+public:
+	U32 m_commandBufferCount = 0;
+	U32 m_commandCount = 0;
+	U32 m_renderPassCount = 0;
+	U32 m_drawcallCount = 0;
+	U64 m_primitiveCount = 0; ///< Of the direct drawcalls.
+	U32 m_dispatchCount = 0;
+	U32 m_traceRaysCount = 0;
+	U32 m_barrierCount = 0;
+	U32 m_bindingCount = 0; ///< Textures, samplers, buffers etc.
+	PtrSize m_transferBytes = 0; ///< Of the buffer copies, fills and uploads.
+	U32 m_asyncComputeCommandBufferCount = 0; ///< The ones that went to the async compute queue.
+	U32 m_queueWaitCount = 0; ///< Number of fences the flushes waited on.
+	U32 m_queueSignalCount = 0; ///< Number of fences that were created for the other queue to wait on.
+
+	/// The hash of the command stream. If two runs produce the same hash they submitted the same work.
+	U64 m_commandStreamHash = 0;
+
+	NullFrameStats& operator+=(const NullFrameStats& b);
+};
+
+/// Convert a command argument to something hashable.
+template<typename T, ANKI_ENABLE(std::is_integral<T>::value || std::is_enum<T>::value)>
+inline U64 toNullCommandArgument(T x)
+{
+	return U64(x);
+}
+
+inline U64 toNullCommandArgument(F32 x)
+{
+	U32 bits;
+	memcpy(&bits, &x, sizeof(bits));
+	return bits;
+}
+
+inline U64 toNullCommandArgument(const GrObject* obj)
+{
+	return (obj) ? obj->getUuid() : 0;
+}
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,32 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Fence.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Fence implementation. The work is executed at flush time so fences are always signaled.
+class FenceImpl final : public Fence
+{
+public:
+	FenceImpl(GrManager* manager, CString name)
+		: Fence(manager, name)
+	{
+	}
+
+	~FenceImpl()
+	{
+	}
+};
+/// @}
+
+} // end namespace anki
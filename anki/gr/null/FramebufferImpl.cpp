@@ -0,0 +1,52 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/FramebufferImpl.h>
+#include <anki/gr/null/TextureViewImpl.h>
+
+namespace anki
+{
+
+Error FramebufferImpl::init(const FramebufferInitInfo& init)
+{
+	ANKI_ASSERT(init.isValid());
+
+	m_colorAttachmentCount = init.m_colorAttachmentCount;
+	for(U32 i = 0; i < m_colorAttachmentCount; ++i)
+	{
+		m_colorAttachments[i] = init.m_colorAttachments[i].m_textureView;
+	}
+	m_depthStencilAttachment = init.m_depthStencilAttachment.m_textureView;
+
+	// All attachments should have the same size
+	for(U32 i = 0; i < m_colorAttachmentCount + 1; ++i)
+	{
+		const TextureViewPtr& view = (i < m_colorAttachmentCount) ? m_colorAttachments[i] : m_depthStencilAttachment;
+		if(!view.isCreated())
+		{
+			continue;
+		}
+
+		const TextureSubresourceInfo& subresource = view->getSubresource();
+		const TexturePtr& tex = static_cast<const TextureViewImpl&>(*view).getTexture();
+		const U32 width = max(tex->getWidth() >> subresource.m_firstMipmap, 1u);
+		const U32 height = max(tex->getHeight() >> subresource.m_firstMipmap, 1u);
+
+		if(m_width == 0)
+		{
+			m_width = width;
+			m_height = height;
+		}
+		else if(m_width != width || m_height != height)
+		{
+			ANKI_NULL_LOGE("Framebuffer attachments have different sizes: %s", getName().cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
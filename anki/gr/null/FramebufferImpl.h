@@ -0,0 +1,64 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Framebuffer.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Framebuffer implementation. It holds the attachments so the command buffers can validate their usage.
+class FramebufferImpl final : public Framebuffer
+{
+public:
+	FramebufferImpl(GrManager* manager, CString name)
+		: Framebuffer(manager, name)
+	{
+	}
+
+	~FramebufferImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const FramebufferInitInfo& init);
+
+	U32 getColorAttachmentCount() const
+	{
+		return m_colorAttachmentCount;
+	}
+
+	const TextureViewPtr& getColorAttachment(U32 i) const
+	{
+		ANKI_ASSERT(i < m_colorAttachmentCount);
+		return m_colorAttachments[i];
+	}
+
+	/// May be empty.
+	const TextureViewPtr& getDepthStencilAttachment() const
+	{
+		return m_depthStencilAttachment;
+	}
+
+	void getAttachmentsSize(U32& width, U32& height) const
+	{
+		width = m_width;
+		height = m_height;
+	}
+
+private:
+	Array<TextureViewPtr, MAX_COLOR_ATTACHMENTS> m_colorAttachments;
+	TextureViewPtr m_depthStencilAttachment;
+	U32 m_colorAttachmentCount = 0;
+	U32 m_width = 0;
+	U32 m_height = 0;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,159 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/GrManagerImpl.h>
+#include <anki/gr/null/CommandBufferImpl.h>
+#include <anki/gr/null/FenceImpl.h>
+#include <anki/gr/null/TextureImpl.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/core/NativeWindow.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+GrManagerImpl::~GrManagerImpl()
+{
+	for(TexturePtr& tex : m_presentableTextures)
+	{
+		tex.reset(nullptr);
+	}
+
+	m_crntFrameCommands.destroy(m_alloc);
+	m_lastFrameCommands.destroy(m_alloc);
+
+	for(BindlessIndices& indices : m_bindless)
+	{
+		ANKI_ASSERT(indices.m_freeIndices.getSize() == indices.m_nextIndex && "Forgot to free some bindless indices");
+		indices.m_freeIndices.destroy(m_alloc);
+	}
+}
+
+Error GrManagerImpl::init(const GrManagerInitInfo& init)
+{
+	ANKI_NULL_LOGI("Initializing the null graphics backend. Nothing will be rendered");
+
+	const ConfigSet& config = *init.m_config;
+
+	// Pretend to be a common desktop GPU
+	m_capabilities.m_uniformBufferBindOffsetAlignment = 256;
+	m_capabilities.m_uniformBufferMaxRange = 64_KB;
+	m_capabilities.m_storageBufferBindOffsetAlignment = 16;
+	m_capabilities.m_storageBufferMaxRange = MAX_U32;
+	m_capabilities.m_textureBufferBindOffsetAlignment = 16;
+	m_capabilities.m_textureBufferMaxRange = MAX_U32;
+	m_capabilities.m_majorApiVersion = 1;
+	m_capabilities.m_minorApiVersion = 2;
+	m_capabilities.m_gpuVendor = GpuVendor::UNKNOWN;
+	m_capabilities.m_rayTracingEnabled = config.getBool("gr_rayTracing");
+	m_capabilities.m_asyncCompute = config.getBool("gr_asyncCompute");
+	m_capabilities.m_shaderGroupHandleSize = 32;
+	m_capabilities.m_sbtRecordAlignment = 64;
+
+	m_bindlessLimits.m_bindlessTextureCount = config.getNumberU32("gr_maxBindlessTextures");
+	m_bindlessLimits.m_bindlessImageCount = config.getNumberU32("gr_maxBindlessImages");
+	m_bindless[0].m_maxIndexCount = m_bindlessLimits.m_bindlessTextureCount;
+	m_bindless[1].m_maxIndexCount = m_bindlessLimits.m_bindlessImageCount;
+
+	m_recordCommands = config.getBool("gr_nullRecordCommands");
+
+	// Create the presentable textures. Same as the Vulkan swapchain. There might not be a window when running headless
+	TextureInitInfo texInit("SwapchainImg");
+	texInit.m_width = (init.m_window) ? init.m_window->getWidth() : config.getNumberU32("width");
+	texInit.m_height = (init.m_window) ? init.m_window->getHeight() : config.getNumberU32("height");
+	texInit.m_format = Format::B8G8R8A8_UNORM;
+	texInit.m_usage = TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::IMAGE_TRACE_RAYS_WRITE
+					  | TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ | TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE
+					  | TextureUsageBit::PRESENT;
+	texInit.m_type = TextureType::_2D;
+
+	for(TexturePtr& tex : m_presentableTextures)
+	{
+		TextureImpl* impl = m_alloc.newInstance<TextureImpl>(this, texInit.getName());
+		tex.reset(impl);
+		ANKI_CHECK(impl->init(texInit));
+	}
+
+	return Error::NONE;
+}
+
+TexturePtr GrManagerImpl::acquireNextPresentableTexture()
+{
+	return m_presentableTextures[m_frame % MAX_FRAMES_IN_FLIGHT];
+}
+
+void GrManagerImpl::endFrame()
+{
+	ANKI_TRACE_SCOPED_EVENT(NULL_END_FRAME);
+
+	LockGuard<Mutex> lock(m_frameMtx);
+
+	m_lastFrameStats = m_crntFrameStats;
+	m_crntFrameStats = NullFrameStats();
+
+	m_lastFrameCommands.destroy(m_alloc);
+	m_lastFrameCommands = std::move(m_crntFrameCommands);
+
+	++m_frame;
+}
+
+void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* fence, ConstWeakArray<FencePtr> waitFences,
+									   Bool crossQueueFence)
+{
+	CommandBufferImpl& impl = static_cast<CommandBufferImpl&>(*cmdb);
+
+	// Execute it now. Fences and queries will be signaled immediately so the waits are always satisfied
+	impl.execute();
+
+	if(fence)
+	{
+		fence->reset(m_alloc.newInstance<FenceImpl>(this, "N/A"));
+	}
+
+	LockGuard<Mutex> lock(m_frameMtx);
+
+	m_crntFrameStats += impl.getStats();
+	m_crntFrameStats.m_queueWaitCount += waitFences.getSize();
+	m_crntFrameStats.m_queueSignalCount += crossQueueFence;
+
+	for(const NullCommand& cmd : impl.getCommands())
+	{
+		m_crntFrameCommands.emplaceBack(m_alloc, cmd);
+	}
+}
+
+U32 GrManagerImpl::allocateBindlessIndex(Bool image)
+{
+	LockGuard<Mutex> lock(m_bindlessMtx);
+	BindlessIndices& indices = m_bindless[image];
+
+	U32 idx;
+	if(indices.m_freeIndices.getSize() > 0)
+	{
+		idx = indices.m_freeIndices.getBack();
+		indices.m_freeIndices.popBack(m_alloc);
+	}
+	else
+	{
+		if(indices.m_nextIndex >= indices.m_maxIndexCount)
+		{
+			ANKI_NULL_LOGF("Out of bindless %s indices", (image) ? "image" : "texture");
+		}
+
+		idx = indices.m_nextIndex++;
+	}
+
+	return idx;
+}
+
+void GrManagerImpl::freeBindlessIndex(Bool image, U32 idx)
+{
+	LockGuard<Mutex> lock(m_bindlessMtx);
+	BindlessIndices& indices = m_bindless[image];
+	ANKI_ASSERT(idx < indices.m_nextIndex);
+	indices.m_freeIndices.emplaceBack(m_alloc, idx);
+}
+
+} // end namespace anki
@@ -0,0 +1,138 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/GrManager.h>
+#include <anki/gr/Texture.h>
+#include <anki/gr/null/Common.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+// Forward
+class CommandBufferImpl;
+
+/// @addtogroup null
+/// @{
+
+/// A GrManager that doesn't talk to any GPU. The objects live in CPU memory, the command buffers are validated and
+/// optionally recorded. Useful for running the renderer on machines without a GPU and for profiling its CPU cost.
+class GrManagerImpl final : public GrManager
+{
+public:
+	GrManagerImpl()
+	{
+	}
+
+	~GrManagerImpl();
+
+	ANKI_USE_RESULT Error init(const GrManagerInitInfo& cfg);
+
+	TexturePtr acquireNextPresentableTexture();
+
+	void endFrame();
+
+	void finish()
+	{
+		// Everything is executed at flush time
+	}
+
+	/// Execute the deferred work of a command buffer and gather its stats and commands.
+	void flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* fence, ConstWeakArray<FencePtr> waitFences,
+							Bool crossQueueFence);
+
+	/// Keep the command stream of every frame. See gr_nullRecordCommands.
+	Bool getRecordCommands() const
+	{
+		return m_recordCommands;
+	}
+
+	/// The stats of the last frame that got swapped.
+	NullFrameStats getLastFrameStats() const
+	{
+		LockGuard<Mutex> lock(m_frameMtx);
+		return m_lastFrameStats;
+	}
+
+	/// The commands of the last frame that got swapped. Empty if gr_nullRecordCommands is off. Not thread-safe against
+	/// endFrame().
+	ConstWeakArray<NullCommand> getLastFrameCommands() const
+	{
+		return m_lastFrameCommands;
+	}
+
+	U64 getFrameCount() const
+	{
+		return m_frame;
+	}
+
+	/// @name Memory accounting
+	/// @{
+	void increaseAllocatedMemory(PtrSize size)
+	{
+		m_allocatedMemory.fetchAdd(size);
+	}
+
+	void decreaseAllocatedMemory(PtrSize size)
+	{
+		m_allocatedMemory.fetchSub(size);
+	}
+
+	PtrSize getAllocatedMemory() const
+	{
+		return m_allocatedMemory.load();
+	}
+	/// @}
+
+	/// @name Bindless
+	/// @{
+	U32 allocateBindlessIndex(Bool image);
+
+	void freeBindlessIndex(Bool image, U32 idx);
+	/// @}
+
+	U32 getCreatedCommandBufferCount() const
+	{
+		return m_createdCommandBufferCount.load();
+	}
+
+	void onCommandBufferCreated()
+	{
+		m_createdCommandBufferCount.fetchAdd(1);
+	}
+
+private:
+	Array<TexturePtr, MAX_FRAMES_IN_FLIGHT> m_presentableTextures;
+	U64 m_frame = 0;
+
+	Bool m_recordCommands = false;
+
+	mutable Mutex m_frameMtx; ///< Protects the frame stats and commands.
+	NullFrameStats m_crntFrameStats;
+	NullFrameStats m_lastFrameStats;
+	DynamicArray<NullCommand> m_crntFrameCommands;
+	DynamicArray<NullCommand> m_lastFrameCommands;
+
+	Atomic<PtrSize> m_allocatedMemory = {0};
+	Atomic<U32> m_createdCommandBufferCount = {0};
+
+	/// Bindless indices. One set for textures and one for images.
+	class BindlessIndices
+	{
+	public:
+		DynamicArray<U32> m_freeIndices;
+		U32 m_nextIndex = 0;
+		U32 m_maxIndexCount = 0;
+	};
+
+	Mutex m_bindlessMtx;
+	Array<BindlessIndices, 2> m_bindless;
+};
+/// @}
+
+} // end namespace anki
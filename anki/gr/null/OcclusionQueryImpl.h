@@ -0,0 +1,46 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/OcclusionQuery.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Occlusion query implementation. There is no rasterization so everything is visible.
+class OcclusionQueryImpl final : public OcclusionQuery
+{
+public:
+	OcclusionQueryImpl(GrManager* manager, CString name)
+		: OcclusionQuery(manager, name)
+	{
+	}
+
+	~OcclusionQueryImpl()
+	{
+	}
+
+	OcclusionQueryResult getResult() const
+	{
+		return OcclusionQueryResult(m_result.load());
+	}
+
+	/// Called when the command buffer that ended the query is flushed.
+	void setResult(OcclusionQueryResult result)
+	{
+		m_result.store(U8(result));
+	}
+
+private:
+	Atomic<U8> m_result = {U8(OcclusionQueryResult::NOT_AVAILABLE)};
+};
+/// @}
+
+} // end namespace anki
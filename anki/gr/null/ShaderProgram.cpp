@@ -0,0 +1,31 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/ShaderProgram.h>
+#include <anki/gr/null/ShaderProgramImpl.h>
+#include <anki/gr/GrManager.h>
+
+namespace anki
+{
+
+ShaderProgram* ShaderProgram::newInstance(GrManager* manager, const ShaderProgramInitInfo& init)
+{
+	ShaderProgramImpl* impl = manager->getAllocator().newInstance<ShaderProgramImpl>(manager, init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		manager->getAllocator().deleteInstance(impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+ConstWeakArray<U8> ShaderProgram::getShaderGroupHandles() const
+{
+	ANKI_NULL_SELF_CONST(ShaderProgramImpl);
+	return self.getShaderGroupHandles();
+}
+
+} // end namespace anki
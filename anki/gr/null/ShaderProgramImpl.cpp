@@ -0,0 +1,67 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/ShaderProgramImpl.h>
+#include <anki/gr/Shader.h>
+#include <anki/gr/GrManager.h>
+
+namespace anki
+{
+
+ShaderProgramImpl::~ShaderProgramImpl()
+{
+	m_shaderGroupHandles.destroy(getAllocator());
+}
+
+Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+
+	if(inf.m_computeShader.isCreated())
+	{
+		m_stages = ShaderTypeBit::COMPUTE;
+	}
+	else if(inf.m_rayTracingShaders.m_rayGenShader.isCreated())
+	{
+		const RayTracingShaders& rt = inf.m_rayTracingShaders;
+		m_stages = ShaderTypeBit::RAY_GEN;
+
+		for(const ShaderPtr& s : rt.m_missShaders)
+		{
+			m_stages |= ShaderTypeBit(1 << s->getShaderType());
+		}
+
+		for(const RayTracingHitGroup& group : rt.m_hitGroups)
+		{
+			if(group.m_closestHitShader.isCreated())
+			{
+				m_stages |= ShaderTypeBit::CLOSEST_HIT;
+			}
+
+			if(group.m_anyHitShader.isCreated())
+			{
+				m_stages |= ShaderTypeBit::ANY_HIT;
+			}
+		}
+
+		const U32 groupCount = 1 + rt.m_missShaders.getSize() + rt.m_hitGroups.getSize();
+		const U32 handleSize = getManager().getDeviceCapabilities().m_shaderGroupHandleSize;
+		m_shaderGroupHandles.create(getAllocator(), groupCount * handleSize, 0);
+	}
+	else
+	{
+		for(ShaderType type = ShaderType::FIRST_GRAPHICS; type <= ShaderType::LAST_GRAPHICS; ++type)
+		{
+			if(inf.m_graphicsShaders[type].isCreated())
+			{
+				m_stages |= ShaderTypeBit(1 << type);
+			}
+		}
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,65 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/ShaderProgram.h>
+#include <anki/gr/null/Common.h>
+#include <anki/util/DynamicArray.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Shader program implementation.
+class ShaderProgramImpl final : public ShaderProgram
+{
+public:
+	ShaderProgramImpl(GrManager* manager, CString name)
+		: ShaderProgram(manager, name)
+	{
+	}
+
+	~ShaderProgramImpl();
+
+	ANKI_USE_RESULT Error init(const ShaderProgramInitInfo& inf);
+
+	ShaderTypeBit getStages() const
+	{
+		ANKI_ASSERT(!!m_stages);
+		return m_stages;
+	}
+
+	Bool isGraphics() const
+	{
+		return !!(m_stages & ShaderTypeBit::ALL_GRAPHICS);
+	}
+
+	Bool isCompute() const
+	{
+		return m_stages == ShaderTypeBit::COMPUTE;
+	}
+
+	Bool isRayTracing() const
+	{
+		return !!(m_stages & ShaderTypeBit::ALL_RAY_TRACING);
+	}
+
+	/// Zeroed handles. Their count is the same as in Vulkan: the ray gen, the miss shaders and the hit groups.
+	ConstWeakArray<U8> getShaderGroupHandles() const
+	{
+		ANKI_ASSERT(isRayTracing());
+		return m_shaderGroupHandles;
+	}
+
+private:
+	ShaderTypeBit m_stages = ShaderTypeBit::NONE;
+	DynamicArray<U8> m_shaderGroupHandles;
+};
+/// @}
+
+} // end namespace anki
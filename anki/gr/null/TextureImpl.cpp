@@ -0,0 +1,67 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/TextureImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+
+namespace anki
+{
+
+TextureImpl::~TextureImpl()
+{
+	static_cast<GrManagerImpl&>(getManager()).decreaseAllocatedMemory(m_memorySize);
+}
+
+Error TextureImpl::init(const TextureInitInfo& init)
+{
+	ANKI_ASSERT(init.isValid());
+
+	m_width = init.m_width;
+	m_height = init.m_height;
+	m_depth = init.m_depth;
+	m_texType = init.m_type;
+
+	if(m_texType == TextureType::_3D)
+	{
+		m_mipCount = min<U32>(init.m_mipmapCount, computeMaxMipmapCount3d(m_width, m_height, m_depth));
+	}
+	else
+	{
+		m_mipCount = min<U32>(init.m_mipmapCount, computeMaxMipmapCount2d(m_width, m_height));
+	}
+
+	m_layerCount = init.m_layerCount;
+	m_format = init.m_format;
+	m_aspect = computeFormatAspect(m_format);
+	m_usage = init.m_usage;
+
+	TextureInitInfo sizeInit = init;
+	sizeInit.m_mipmapCount = U8(m_mipCount);
+	m_memorySize = sizeInit.computeApproximateMemorySize();
+
+	static_cast<GrManagerImpl&>(getManager()).increaseAllocatedMemory(m_memorySize);
+
+	return Error::NONE;
+}
+
+TextureType TextureImpl::computeNewTexTypeOfSubresource(const TextureSubresourceInfo& subresource) const
+{
+	ANKI_ASSERT(isSubresourceValid(subresource));
+	if(textureTypeIsCube(m_texType))
+	{
+		if(subresource.m_faceCount != 6)
+		{
+			ANKI_ASSERT(subresource.m_faceCount == 1);
+			return (subresource.m_layerCount > 1) ? TextureType::_2D_ARRAY : TextureType::_2D;
+		}
+		else if(subresource.m_layerCount == 1)
+		{
+			return TextureType::CUBE;
+		}
+	}
+	return m_texType;
+}
+
+} // end namespace anki
@@ -0,0 +1,43 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Texture.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Texture implementation. It has no storage, it only accounts the memory it would need on the GPU.
+class TextureImpl final : public Texture
+{
+public:
+	TextureImpl(GrManager* manager, CString name)
+		: Texture(manager, name)
+	{
+	}
+
+	~TextureImpl();
+
+	ANKI_USE_RESULT Error init(const TextureInitInfo& init);
+
+	Bool usageValid(TextureUsageBit usage) const
+	{
+		return (usage & m_usage) == usage;
+	}
+
+	/// Same as the Vulkan backend. Cube views with less than 6 faces are 2D views.
+	TextureType computeNewTexTypeOfSubresource(const TextureSubresourceInfo& subresource) const;
+
+private:
+	PtrSize m_memorySize = 0;
+};
+/// @}
+
+} // end namespace anki
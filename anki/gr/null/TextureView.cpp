@@ -0,0 +1,37 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/TextureView.h>
+#include <anki/gr/null/TextureViewImpl.h>
+#include <anki/gr/GrManager.h>
+
+namespace anki
+{
+
+TextureView* TextureView::newInstance(GrManager* manager, const TextureViewInitInfo& init)
+{
+	TextureViewImpl* impl = manager->getAllocator().newInstance<TextureViewImpl>(manager, init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		manager->getAllocator().deleteInstance(impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+U32 TextureView::getOrCreateBindlessTextureIndex()
+{
+	ANKI_NULL_SELF(TextureViewImpl);
+	return self.getOrCreateBindlessIndex(false);
+}
+
+U32 TextureView::getOrCreateBindlessImageIndex()
+{
+	ANKI_NULL_SELF(TextureViewImpl);
+	return self.getOrCreateBindlessIndex(true);
+}
+
+} // end namespace anki
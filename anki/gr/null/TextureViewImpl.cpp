@@ -0,0 +1,53 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/TextureViewImpl.h>
+#include <anki/gr/null/TextureImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+
+namespace anki
+{
+
+TextureViewImpl::~TextureViewImpl()
+{
+	for(U32 i = 0; i < 2; ++i)
+	{
+		if(m_bindlessIndices[i] != MAX_U32)
+		{
+			static_cast<GrManagerImpl&>(getManager()).freeBindlessIndex(i == 1, m_bindlessIndices[i]);
+		}
+	}
+}
+
+Error TextureViewImpl::init(const TextureViewInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+
+	m_subresource = inf;
+	m_tex = inf.m_texture;
+	m_texType = static_cast<const TextureImpl&>(*m_tex).computeNewTexTypeOfSubresource(m_subresource);
+
+	return Error::NONE;
+}
+
+U32 TextureViewImpl::getOrCreateBindlessIndex(Bool image)
+{
+	ANKI_ASSERT(m_subresource.m_mipmapCount == 1 && m_subresource.m_layerCount == 1
+				&& m_subresource.m_faceCount == 1 && "Can only create bindless for a single surface");
+	ANKI_ASSERT((!image && m_tex->isSubresourceGoodForSampling(m_subresource))
+				|| (image && m_tex->isSubresourceGoodForImageLoadStore(m_subresource)));
+
+	LockGuard<SpinLock> lock(m_bindlessIndicesMtx);
+
+	U32& idx = m_bindlessIndices[image];
+	if(idx == MAX_U32)
+	{
+		idx = static_cast<GrManagerImpl&>(getManager()).allocateBindlessIndex(image);
+	}
+
+	return idx;
+}
+
+} // end namespace anki
@@ -0,0 +1,45 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/TextureView.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Texture view implementation.
+class TextureViewImpl final : public TextureView
+{
+public:
+	TextureViewImpl(GrManager* manager, CString name)
+		: TextureView(manager, name)
+	{
+	}
+
+	~TextureViewImpl();
+
+	ANKI_USE_RESULT Error init(const TextureViewInitInfo& inf);
+
+	const TexturePtr& getTexture() const
+	{
+		return m_tex;
+	}
+
+	/// Allocate a bindless index once and keep it for the lifetime of the view. Same as Vulkan.
+	U32 getOrCreateBindlessIndex(Bool image);
+
+private:
+	TexturePtr m_tex; ///< Hold a reference.
+	Array<U32, 2> m_bindlessIndices = {{MAX_U32, MAX_U32}}; ///< Texture and image.
+	SpinLock m_bindlessIndicesMtx;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,24 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/TimestampQuery.h>
+#include <anki/gr/null/TimestampQueryImpl.h>
+#include <anki/gr/GrManager.h>
+
+namespace anki
+{
+
+TimestampQuery* TimestampQuery::newInstance(GrManager* manager)
+{
+	return manager->getAllocator().newInstance<TimestampQueryImpl>(manager, "N/A");
+}
+
+TimestampQueryResult TimestampQuery::getResult(Second& timestamp) const
+{
+	ANKI_NULL_SELF_CONST(TimestampQueryImpl);
+	return self.getResult(timestamp);
+}
+
+} // end namespace anki
@@ -0,0 +1,53 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/TimestampQuery.h>
+#include <anki/gr/null/Common.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Timestamp query implementation. The timestamp is the CPU time the command buffer got flushed.
+class TimestampQueryImpl final : public TimestampQuery
+{
+public:
+	TimestampQueryImpl(GrManager* manager, CString name)
+		: TimestampQuery(manager, name)
+	{
+	}
+
+	~TimestampQueryImpl()
+	{
+	}
+
+	TimestampQueryResult getResult(Second& timestamp) const
+	{
+		LockGuard<SpinLock> lock(m_mtx);
+		timestamp = m_timestamp;
+		return (m_available) ? TimestampQueryResult::AVAILABLE : TimestampQueryResult::NOT_AVAILABLE;
+	}
+
+	/// Called when the command buffer that wrote the query is flushed.
+	void setTimestamp(Second timestamp)
+	{
+		LockGuard<SpinLock> lock(m_mtx);
+		m_timestamp = timestamp;
+		m_available = true;
+	}
+
+private:
+	mutable SpinLock m_mtx;
+	Second m_timestamp = -1.0;
+	Bool m_available = false;
+};
+/// @}
+
+} // end namespace anki
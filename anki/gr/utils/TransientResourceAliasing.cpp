@@ -0,0 +1,82 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/utils/TransientResourceAliasing.h>
+#include <anki/util/DynamicArray.h>
+#include <algorithm>
+
+namespace anki
+{
+
+PtrSize computeTransientResourceAliasing(ConstWeakArray<TransientResourceLifetime> resources, WeakArray<U32> aliasOf,
+										 StackAllocator<U8> alloc)
+{
+	ANKI_ASSERT(resources.getSize() == aliasOf.getSize());
+
+	// Visit the resources in the order they are used
+	DynamicArrayAuto<U32> order(alloc, resources.getSize());
+	for(U32 i = 0; i < resources.getSize(); ++i)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.getBegin(), order.getEnd(), [&](U32 a, U32 b) {
+		return resources[a].m_firstBatch < resources[b].m_firstBatch;
+	});
+
+	// A slot is a piece of memory that is shared by a number of resources
+	class Slot
+	{
+	public:
+		U64 m_compatibilityKey;
+		U32 m_lastBatch; ///< The last batch the memory is in use.
+		U32 m_resourceIdx; ///< The last resource that uses the memory.
+	};
+
+	DynamicArrayAuto<Slot> slots(alloc);
+	PtrSize memorySize = 0;
+
+	for(U32 resourceIdx : order)
+	{
+		const TransientResourceLifetime& resource = resources[resourceIdx];
+		ANKI_ASSERT(!resource.isUsed() || resource.m_firstBatch <= resource.m_lastBatch);
+
+		// Find the compatible slot that got free last. That leaves the older slots for resources with bigger gaps
+		Slot* bestSlot = nullptr;
+		if(resource.isUsed())
+		{
+			for(Slot& slot : slots)
+			{
+				if(slot.m_compatibilityKey == resource.m_compatibilityKey && slot.m_lastBatch < resource.m_firstBatch
+				   && (bestSlot == nullptr || slot.m_lastBatch > bestSlot->m_lastBatch))
+				{
+					bestSlot = &slot;
+				}
+			}
+		}
+
+		if(bestSlot)
+		{
+			aliasOf[resourceIdx] = bestSlot->m_resourceIdx;
+			bestSlot->m_lastBatch = resource.m_lastBatch;
+			bestSlot->m_resourceIdx = resourceIdx;
+		}
+		else
+		{
+			// Needs new memory. The unused resources get their own memory and never get aliased
+			aliasOf[resourceIdx] = MAX_U32;
+			memorySize += resource.m_memorySize;
+
+			if(resource.isUsed())
+			{
+				slots.emplaceBack(Slot{resource.m_compatibilityKey, resource.m_lastBatch, resourceIdx});
+			}
+		}
+	}
+
+	return memorySize;
+}
+
+} // end namespace anki
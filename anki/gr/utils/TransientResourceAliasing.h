@@ -0,0 +1,49 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Common.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup graphics
+/// @{
+
+/// The lifetime of a transient resource of a RenderGraph. The lifetime is expressed in batches.
+class TransientResourceLifetime
+{
+public:
+	U64 m_compatibilityKey = 0; ///< Only resources with the same key can share memory.
+	PtrSize m_memorySize = 0;
+	U32 m_firstBatch = MAX_U32; ///< The first batch that uses the resource. MAX_U32 if it's not used at all.
+	U32 m_lastBatch = 0; ///< The last batch that uses the resource.
+
+	Bool isUsed() const
+	{
+		return m_firstBatch != MAX_U32;
+	}
+
+	Bool overlaps(const TransientResourceLifetime& b) const
+	{
+		return m_firstBatch <= b.m_lastBatch && b.m_firstBatch <= m_lastBatch;
+	}
+};
+
+/// Find the transient resources that can share the same memory because their lifetimes don't overlap. It's a greedy
+/// algorithm that visits the resources in the order of their first use and puts each resource in the compatible slot
+/// that got free last.
+/// @param[in] resources The lifetimes of the resources.
+/// @param[out] aliasOf For every resource the index of the resource that used the same memory before it or MAX_U32 if
+///                     it needs new memory. It should have the same size as resources.
+/// @param alloc Used for temporary allocations.
+/// @return The memory required by all the resources after aliasing.
+PtrSize computeTransientResourceAliasing(ConstWeakArray<TransientResourceLifetime> resources, WeakArray<U32> aliasOf,
+										 StackAllocator<U8> alloc);
+/// @}
+
+} // end namespace anki
@@ -49,10 +49,11 @@ Error BufferImpl::init(const BufferInitInfo& inf)
 	{
 		ci.usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 	}
-	ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	ci.queueFamilyIndexCount = 1;
-	const U32 queueIdx = getGrManagerImpl().getGraphicsQueueFamily();
-	ci.pQueueFamilyIndices = &queueIdx;
+	// Share between the queues to avoid ownership transfers
+	const ConstWeakArray<U32> queueFamilies = getGrManagerImpl().getQueueFamilies();
+	ci.sharingMode = (queueFamilies.getSize() > 1) ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+	ci.queueFamilyIndexCount = queueFamilies.getSize();
+	ci.pQueueFamilyIndices = &queueFamilies[0];
 	ANKI_VK_CHECK(vkCreateBuffer(getDevice(), &ci, nullptr, &m_handle));
 	getGrManagerImpl().trySetVulkanHandleName(inf.getName(), VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, m_handle);
 
@@ -23,18 +23,18 @@ CommandBuffer* CommandBuffer::newInstance(GrManager* manager, const CommandBuffe
 	return impl;
 }
 
-void CommandBuffer::flush(FencePtr* fence)
+void CommandBuffer::flush(FencePtr* fence, ConstWeakArray<FencePtr> waitFences, Bool crossQueueFence)
 {
 	ANKI_VK_SELF(CommandBufferImpl);
 	self.endRecording();
 
 	if(!self.isSecondLevel())
 	{
-		self.getGrManagerImpl().flushCommandBuffer(CommandBufferPtr(this), fence);
+		self.getGrManagerImpl().flushCommandBuffer(CommandBufferPtr(this), fence, waitFences, crossQueueFence);
 	}
 	else
 	{
-		ANKI_ASSERT(fence == nullptr);
+		ANKI_ASSERT(fence == nullptr && waitFences.getSize() == 0 && !crossQueueFence);
 	}
 }
 
@@ -407,6 +407,12 @@ Bool CommandBuffer::isEmpty() const
 	return self.isEmpty();
 }
 
+U32 CommandBuffer::getSkippedDrawcallCount() const
+{
+	ANKI_VK_SELF_CONST(CommandBufferImpl);
+	return self.getSkippedDrawcallCount();
+}
+
 void CommandBuffer::setPushConstants(const void* data, U32 dataSize)
 {
 	ANKI_VK_SELF(CommandBufferImpl);
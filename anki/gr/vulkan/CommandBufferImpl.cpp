@@ -41,7 +41,19 @@ Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
 	m_tid = Thread::getCurrentThreadId();
 	m_flags = init.m_flags;
 
-	ANKI_CHECK(getGrManagerImpl().getCommandBufferFactory().newCommandBuffer(m_tid, m_flags, m_microCmdb));
+	if(!!(m_flags & CommandBufferFlag::ASYNC_COMPUTE))
+	{
+		ANKI_ASSERT(!(m_flags & (CommandBufferFlag::GRAPHICS_WORK | CommandBufferFlag::SECOND_LEVEL)));
+
+		// Fallback to the general queue
+		if(!getGrManagerImpl().getDeviceCapabilities().m_asyncCompute)
+		{
+			m_flags &= ~CommandBufferFlag::ASYNC_COMPUTE;
+		}
+	}
+
+	ANKI_CHECK(getGrManagerImpl().getCommandBufferFactory(isAsyncCompute()).newCommandBuffer(m_tid, m_flags,
+																							   m_microCmdb));
 	m_handle = m_microCmdb->getHandle();
 
 	m_alloc = m_microCmdb->getFastAllocator();
@@ -78,11 +78,22 @@ public:
 		return m_empty;
 	}
 
+	U32 getSkippedDrawcallCount() const
+	{
+		return m_skippedDrawcallCount;
+	}
+
 	Bool isSecondLevel() const
 	{
 		return !!(m_flags & CommandBufferFlag::SECOND_LEVEL);
 	}
 
+	/// It will be submitted to the async compute queue.
+	Bool isAsyncCompute() const
+	{
+		return !!(m_flags & CommandBufferFlag::ASYNC_COMPUTE);
+	}
+
 	void bindVertexBuffer(U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
 	{
 		commandCommon();
@@ -386,6 +397,7 @@ private:
 	Bool m_finalized = false;
 	Bool m_empty = true;
 	Bool m_beganRecording = false;
+	U32 m_skippedDrawcallCount = 0; ///< Drawcalls whose pipeline was still pending.
 #if ANKI_EXTRA_CHECKS
 	U32 m_commandCount = 0;
 	U32 m_setPushConstantsSize = 0;
@@ -480,7 +492,8 @@ private:
 	/// batch.
 	void flushBatches(CommandBufferCommandType type);
 
-	void drawcallCommon();
+	/// @return False if the drawcall should be skipped.
+	Bool drawcallCommon();
 
 	Bool insideRenderPass() const
 	{
@@ -497,6 +510,11 @@ private:
 	/// Flush batched image and buffer barriers.
 	void flushBarriers();
 
+	/// The async compute queue doesn't support the graphics stages. The graphics work of the other queue is already
+	/// synchronized by the semaphore the submit waits on so those stages can be dropped.
+	void fixupBarrierStagesForAsyncCompute(VkPipelineStageFlags& srcStage, VkAccessFlags& srcAccess,
+										   VkPipelineStageFlags& dstStage, VkAccessFlags& dstAccess) const;
+
 	void flushQueryResets();
 
 	void flushWriteQueryResults();
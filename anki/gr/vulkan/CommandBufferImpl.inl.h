@@ -86,6 +86,42 @@ inline void CommandBufferImpl::setStencilReference(FaceSelectionBit face, U32 re
 	}
 }
 
+inline void CommandBufferImpl::fixupBarrierStagesForAsyncCompute(VkPipelineStageFlags& srcStage,
+																 VkAccessFlags& srcAccess,
+																 VkPipelineStageFlags& dstStage,
+																 VkAccessFlags& dstAccess) const
+{
+	if(!isAsyncCompute())
+	{
+		return;
+	}
+
+	const VkPipelineStageFlags computeStages =
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+		| VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT
+		| VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR
+		| VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+	const VkAccessFlags graphicsAccess =
+		VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT
+		| VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+		| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	srcStage &= computeStages;
+	dstStage &= computeStages;
+	srcAccess &= ~graphicsAccess;
+	dstAccess &= ~graphicsAccess;
+
+	if(srcStage == 0)
+	{
+		srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	}
+
+	if(dstStage == 0)
+	{
+		dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	}
+}
+
 inline void CommandBufferImpl::setImageBarrier(VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
 											   VkImageLayout prevLayout, VkPipelineStageFlags dstStage,
 											   VkAccessFlags dstAccess, VkImageLayout newLayout, VkImage img,
@@ -93,6 +129,7 @@ inline void CommandBufferImpl::setImageBarrier(VkPipelineStageFlags srcStage, Vk
 {
 	ANKI_ASSERT(img);
 	commandCommon();
+	fixupBarrierStagesForAsyncCompute(srcStage, srcAccess, dstStage, dstAccess);
 
 	VkImageMemoryBarrier inf = {};
 	inf.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -209,6 +246,7 @@ inline void CommandBufferImpl::setBufferBarrier(VkPipelineStageFlags srcStage, V
 {
 	ANKI_ASSERT(buff);
 	commandCommon();
+	fixupBarrierStagesForAsyncCompute(srcStage, srcAccess, dstStage, dstAccess);
 
 	VkBufferMemoryBarrier b = {};
 	b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
@@ -265,6 +303,7 @@ inline void CommandBufferImpl::setAccelerationStructureBarrierInternal(Accelerat
 	VkPipelineStageFlags dstStage;
 	VkAccessFlags dstAccess;
 	AccelerationStructureImpl::computeBarrierInfo(prevUsage, nextUsage, srcStage, srcAccess, dstStage, dstAccess);
+	fixupBarrierStagesForAsyncCompute(srcStage, srcAccess, dstStage, dstAccess);
 
 #if ANKI_BATCH_COMMANDS
 	flushBatches(CommandBufferCommandType::SET_BARRIER);
@@ -292,7 +331,11 @@ inline void CommandBufferImpl::drawArrays(PrimitiveTopology topology, U32 count,
 										  U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	ANKI_CMD(vkCmdDraw(m_handle, count, instanceCount, first, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -300,7 +343,11 @@ inline void CommandBufferImpl::drawElements(PrimitiveTopology topology, U32 coun
 											U32 baseVertex, U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	ANKI_CMD(vkCmdDrawIndexed(m_handle, count, instanceCount, firstIndex, baseVertex, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -308,7 +355,11 @@ inline void CommandBufferImpl::drawArraysIndirect(PrimitiveTopology topology, U3
 												  BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_DRAW));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -322,7 +373,11 @@ inline void CommandBufferImpl::drawElementsIndirect(PrimitiveTopology topology,
 													BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_DRAW));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -610,7 +665,7 @@ inline void CommandBufferImpl::pushSecondLevelCommandBuffer(CommandBufferPtr cmd
 	m_microCmdb->pushObjectRef(cmdb);
 }
 
-inline void CommandBufferImpl::drawcallCommon()
+inline Bool CommandBufferImpl::drawcallCommon()
 {
 	// Preconditions
 	commandCommon();
@@ -636,6 +691,13 @@ inline void CommandBufferImpl::drawcallCommon()
 
 	if(stateDirty)
 	{
+		if(ANKI_UNLIKELY(!ppline.isCreated()))
+		{
+			// The pipeline is created in the background, skip the drawcall
+			++m_skippedDrawcallCount;
+			return false;
+		}
+
 		ANKI_CMD(vkCmdBindPipeline(m_handle, VK_PIPELINE_BIND_POINT_GRAPHICS, ppline.getHandle()), ANY_OTHER_COMMAND);
 	}
 
@@ -723,6 +785,7 @@ inline void CommandBufferImpl::drawcallCommon()
 #endif
 
 	ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
+	return true;
 }
 
 inline void CommandBufferImpl::commandCommon()
@@ -5,7 +5,7 @@
 
 #include <anki/gr/Fence.h>
 #include <anki/gr/vulkan/FenceImpl.h>
-#include <anki/gr/GrManager.h>
+#include <anki/gr/vulkan/GrManagerImpl.h>
 
 namespace anki
 {
@@ -15,6 +15,15 @@ Fence* Fence::newInstance(GrManager* manager)
 	return manager->getAllocator().newInstance<FenceImpl>(manager, "N/A");
 }
 
+FenceImpl::~FenceImpl()
+{
+	// A signaled semaphore can't be recycled. Have the next submit wait on it
+	if(m_semaphore && !m_semaphoreWaited)
+	{
+		static_cast<GrManagerImpl&>(getManager()).releaseUnwaitedSemaphore(m_semaphore);
+	}
+}
+
 Bool Fence::clientWait(Second seconds)
 {
 	return static_cast<FenceImpl*>(this)->m_fence->clientWait(seconds);
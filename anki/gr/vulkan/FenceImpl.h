@@ -8,6 +8,7 @@
 #include <anki/gr/Fence.h>
 #include <anki/gr/vulkan/VulkanObject.h>
 #include <anki/gr/vulkan/FenceFactory.h>
+#include <anki/gr/vulkan/SemaphoreFactory.h>
 
 namespace anki
 {
@@ -21,14 +22,17 @@ class FenceImpl final : public Fence, public VulkanObject<Fence, FenceImpl>
 public:
 	MicroFencePtr m_fence;
 
+	/// Signaled with m_fence if there is an async compute queue. The other queue waits on it.
+	MicroSemaphorePtr m_semaphore;
+	Bool m_semaphoreAsyncCompute = false; ///< The queue that signals m_semaphore.
+	Bool m_semaphoreWaited = false;
+
 	FenceImpl(GrManager* manager, CString name)
 		: Fence(manager, name)
 	{
 	}
 
-	~FenceImpl()
-	{
-	}
+	~FenceImpl();
 };
 /// @}
 
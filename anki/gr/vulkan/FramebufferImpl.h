@@ -57,6 +57,18 @@ public:
 		stencil = !!(m_aspect & DepthStencilAspectBit::STENCIL);
 	}
 
+	/// Get the formats of the attachments. The depth stencil format goes to the last element.
+	void getAttachmentFormats(Array<VkFormat, MAX_COLOR_ATTACHMENTS + 1>& formats) const
+	{
+		for(U32 i = 0; i < MAX_COLOR_ATTACHMENTS; ++i)
+		{
+			formats[i] = (i < m_colorAttCount) ? m_attachmentDescriptions[i].format : VK_FORMAT_UNDEFINED;
+		}
+
+		formats[MAX_COLOR_ATTACHMENTS] =
+			(hasDepthStencil()) ? m_attachmentDescriptions[m_colorAttCount].format : VK_FORMAT_UNDEFINED;
+	}
+
 	U32 getColorAttachmentCount() const
 	{
 		return m_colorAttCount;
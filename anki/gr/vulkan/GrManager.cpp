@@ -93,6 +93,10 @@ GrManagerStats GrManager::getStats() const
 
 	self.getGpuMemoryManager().getAllocatedMemory(out.m_gpuMemory, out.m_cpuMemory);
 	out.m_commandBufferCount = self.getCommandBufferFactory().getCreatedCommandBufferCount();
+	if(self.getDeviceCapabilities().m_asyncCompute)
+	{
+		out.m_commandBufferCount += self.getCommandBufferFactory(true).getCreatedCommandBufferCount();
+	}
 
 	return out;
 }
@@ -124,7 +128,17 @@ ShaderPtr GrManager::newShader(const ShaderInitInfo& init)
 
 ShaderProgramPtr GrManager::newShaderProgram(const ShaderProgramInitInfo& init)
 {
-	return ShaderProgramPtr(ShaderProgram::newInstance(this, init));
+	ShaderProgramPtr prog(ShaderProgram::newInstance(this, init));
+
+	// Start creating the pipelines that the program used in previous runs. Do it here and not in the program's init()
+	// because the warmup needs to hold references to the program
+	PipelineManifest* manifest = static_cast<GrManagerImpl*>(this)->getPipelineManifest();
+	if(manifest && prog.isCreated() && static_cast<const ShaderProgramImpl&>(*prog).isGraphics())
+	{
+		manifest->warmup(prog);
+	}
+
+	return prog;
 }
 
 CommandBufferPtr GrManager::newCommandBuffer(const CommandBufferInitInfo& init)
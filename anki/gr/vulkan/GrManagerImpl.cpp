@@ -24,9 +24,18 @@ GrManagerImpl::~GrManagerImpl()
 		LockGuard<Mutex> lock(m_globalMtx);
 		vkQueueWaitIdle(m_queue);
 		m_queue = VK_NULL_HANDLE;
+
+		if(m_asyncComputeQueue)
+		{
+			vkQueueWaitIdle(m_asyncComputeQueue);
+		}
 	}
 
+	m_pplineCreationQueue.destroy();
+
 	m_cmdbFactory.destroy();
+	m_asyncComputeCmdbFactory.destroy();
+	m_unwaitedSemaphores.destroy(getAllocator());
 
 	// SECOND THING: The destroy everything that has a reference to GrObjects.
 	for(auto& x : m_perFrame)
@@ -48,6 +57,7 @@ GrManagerImpl::~GrManagerImpl()
 	m_pplineLayoutFactory.destroy();
 	m_descrFactory.destroy();
 
+	m_pplineManifest.destroy();
 	m_pplineCache.destroy(m_device, m_physicalDevice, getAllocator());
 
 	m_fences.destroy();
@@ -106,16 +116,31 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 	ANKI_CHECK(initSurface(init));
 	ANKI_CHECK(initDevice(init));
 	vkGetDeviceQueue(m_device, m_queueIdx, 0, &m_queue);
+	if(m_queueFamilies[1] != MAX_U32)
+	{
+		vkGetDeviceQueue(m_device, m_queueFamilies[1], 0, &m_asyncComputeQueue);
+		m_capabilities.m_asyncCompute = true;
+	}
 
 	m_swapchainFactory.init(this, init.m_config->getBool("gr_vsync"));
 
 	m_crntSwapchain = m_swapchainFactory.newInstance();
 
 	ANKI_CHECK(m_pplineCache.init(m_device, m_physicalDevice, init.m_cacheDirectory, *init.m_config, getAllocator()));
+	m_pplineCreationQueue.init(getAllocator(), m_device, m_pplineCache.m_cacheHandle,
+							   init.m_config->getNumberU32("gr_pipelineCreationThreadCount"));
+	if(init.m_config->getBool("gr_pipelineManifest"))
+	{
+		ANKI_CHECK(m_pplineManifest.init(m_device, init.m_cacheDirectory, *init.m_config, getAllocator()));
+	}
 
 	ANKI_CHECK(initMemory(*init.m_config));
 
 	ANKI_CHECK(m_cmdbFactory.init(getAllocator(), m_device, m_queueIdx));
+	if(m_asyncComputeQueue)
+	{
+		ANKI_CHECK(m_asyncComputeCmdbFactory.init(getAllocator(), m_device, m_queueFamilies[1]));
+	}
 
 	for(PerFrame& f : m_perFrame)
 	{
@@ -465,18 +490,36 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 	}
 
 	m_queueIdx = desiredFamilyIdx;
+	m_queueFamilies[0] = desiredFamilyIdx;
+
+	// Find a compute only family for async compute. Those run in parallel to the graphics work
+	if(init.m_config->getBool("gr_asyncCompute"))
+	{
+		for(U32 i = 0; i < count; ++i)
+		{
+			if((queueInfos[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueInfos[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				m_queueFamilies[1] = i;
+				ANKI_VK_LOGI("Will use queue family %u for async compute", i);
+				break;
+			}
+		}
+	}
 
 	F32 priority = 1.0;
-	VkDeviceQueueCreateInfo q = {};
-	q.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	q.queueFamilyIndex = desiredFamilyIdx;
-	q.queueCount = 1;
-	q.pQueuePriorities = &priority;
+	Array<VkDeviceQueueCreateInfo, 2> q = {};
+	for(U32 i = 0; i < 2; ++i)
+	{
+		q[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		q[i].queueFamilyIndex = m_queueFamilies[i];
+		q[i].queueCount = 1;
+		q[i].pQueuePriorities = &priority;
+	}
 
 	VkDeviceCreateInfo ci = {};
 	ci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	ci.queueCreateInfoCount = 1;
-	ci.pQueueCreateInfos = &q;
+	ci.queueCreateInfoCount = (m_queueFamilies[1] != MAX_U32) ? 2 : 1;
+	ci.pQueueCreateInfos = &q[0];
 
 	// Extensions
 	U32 extCount = 0;
@@ -877,10 +920,13 @@ void GrManagerImpl::resetFrame(PerFrame& frame)
 	frame.m_renderSemaphore.reset(nullptr);
 }
 
-void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence, Bool wait)
+void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence, ConstWeakArray<FencePtr> waitFences,
+										Bool crossQueueFence, Bool wait)
 {
 	CommandBufferImpl& impl = static_cast<CommandBufferImpl&>(*cmdb);
 	VkCommandBuffer handle = impl.getHandle();
+	const Bool asyncCompute = impl.isAsyncCompute();
+	VkQueue queue = (asyncCompute) ? m_asyncComputeQueue : m_queue;
 
 	VkSubmitInfo submit = {};
 	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -888,32 +934,67 @@ void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence
 	MicroFencePtr fence = newFence();
 
 	// Create fence
+	FenceImpl* outFenceImpl = nullptr;
 	if(outFence)
 	{
-		outFence->reset(getAllocator().newInstance<FenceImpl>(this, "Flush"));
-		static_cast<FenceImpl&>(**outFence).m_fence = fence;
+		outFenceImpl = getAllocator().newInstance<FenceImpl>(this, "Flush");
+		outFence->reset(outFenceImpl);
+		outFenceImpl->m_fence = fence;
 	}
 
 	LockGuard<Mutex> lock(m_globalMtx);
 
 	PerFrame& frame = m_perFrame[m_frame % MAX_FRAMES_IN_FLIGHT];
 
+	// Gather the semaphores to wait on. Work from the same queue is already ordered and every binary semaphore can be
+	// waited only once
+	Array<VkSemaphore, 16> waitSemaphores;
+	Array<VkPipelineStageFlags, 16> waitStages;
+	U32 waitSemaphoreCount = 0;
+	auto addWaitSemaphore = [&](MicroSemaphorePtr& semaphore, VkPipelineStageFlags stages) {
+		ANKI_ASSERT(waitSemaphoreCount < waitSemaphores.getSize());
+		waitSemaphores[waitSemaphoreCount] = semaphore->getHandle();
+		waitStages[waitSemaphoreCount] = stages;
+		++waitSemaphoreCount;
+
+		// Can't be reused before this submit is done
+		semaphore->getFence() = fence;
+	};
+
+	for(const FencePtr& waitFence : waitFences)
+	{
+		FenceImpl& waitFenceImpl = static_cast<FenceImpl&>(*waitFence);
+		ANKI_ASSERT((waitFenceImpl.m_semaphore || !m_asyncComputeQueue) && "Fence not flushed with crossQueueFence");
+		if(waitFenceImpl.m_semaphore && !waitFenceImpl.m_semaphoreWaited
+		   && waitFenceImpl.m_semaphoreAsyncCompute != asyncCompute)
+		{
+			addWaitSemaphore(waitFenceImpl.m_semaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			waitFenceImpl.m_semaphoreWaited = true;
+		}
+	}
+
+	// Consume the semaphores that no one waited on. Leave a slot for the acquire semaphore
+	while(!asyncCompute && !m_unwaitedSemaphores.isEmpty() && waitSemaphoreCount < waitSemaphores.getSize() - 1)
+	{
+		addWaitSemaphore(m_unwaitedSemaphores.getBack(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		m_unwaitedSemaphores.popBack(getAllocator());
+	}
+
+	Array<VkSemaphore, 2> signalSemaphores;
+	U32 signalSemaphoreCount = 0;
+
 	// Do some special stuff for the last command buffer
-	VkPipelineStageFlags waitFlags;
 	if(impl.renderedToDefaultFramebuffer())
 	{
-		submit.pWaitSemaphores = &frame.m_acquireSemaphore->getHandle();
-		waitFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-					| VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT; // TODO That depends on how we use the swapchain img
-		submit.pWaitDstStageMask = &waitFlags;
-		submit.waitSemaphoreCount = 1;
+		ANKI_ASSERT(!asyncCompute);
+		// TODO The stages depend on how we use the swapchain img
+		addWaitSemaphore(frame.m_acquireSemaphore,
+						 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
 		// Create the semaphore to signal
 		ANKI_ASSERT(!frame.m_renderSemaphore && "Only one begin/end render pass is allowed with the default fb");
 		frame.m_renderSemaphore = m_semaphores.newInstance(fence);
-
-		submit.signalSemaphoreCount = 1;
-		submit.pSignalSemaphores = &frame.m_renderSemaphore->getHandle();
+		signalSemaphores[signalSemaphoreCount++] = frame.m_renderSemaphore->getHandle();
 
 		frame.m_presentFence = fence;
 
@@ -921,6 +1002,20 @@ void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence
 		m_crntSwapchain->setFence(fence);
 	}
 
+	// The other queue will wait on this submit
+	ANKI_ASSERT(!crossQueueFence || outFenceImpl);
+	if(crossQueueFence && m_asyncComputeQueue)
+	{
+		outFenceImpl->m_semaphore = m_semaphores.newInstance(fence);
+		outFenceImpl->m_semaphoreAsyncCompute = asyncCompute;
+		signalSemaphores[signalSemaphoreCount++] = outFenceImpl->m_semaphore->getHandle();
+	}
+
+	submit.waitSemaphoreCount = waitSemaphoreCount;
+	submit.pWaitSemaphores = (waitSemaphoreCount) ? &waitSemaphores[0] : nullptr;
+	submit.pWaitDstStageMask = (waitSemaphoreCount) ? &waitStages[0] : nullptr;
+	submit.signalSemaphoreCount = signalSemaphoreCount;
+	submit.pSignalSemaphores = (signalSemaphoreCount) ? &signalSemaphores[0] : nullptr;
 	submit.commandBufferCount = 1;
 	submit.pCommandBuffers = &handle;
 
@@ -928,19 +1023,35 @@ void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence
 
 	{
 		ANKI_TRACE_SCOPED_EVENT(VK_QUEUE_SUBMIT);
-		ANKI_VK_CHECKF(vkQueueSubmit(m_queue, 1, &submit, fence->getHandle()));
+		ANKI_VK_CHECKF(vkQueueSubmit(queue, 1, &submit, fence->getHandle()));
 	}
 
 	if(wait)
 	{
-		vkQueueWaitIdle(m_queue);
+		vkQueueWaitIdle(queue);
 	}
 }
 
+void GrManagerImpl::releaseUnwaitedSemaphore(MicroSemaphorePtr semaphore)
+{
+	ANKI_ASSERT(semaphore);
+	LockGuard<Mutex> lock(m_globalMtx);
+	m_unwaitedSemaphores.emplaceBack(getAllocator(), semaphore);
+}
+
 void GrManagerImpl::finish()
 {
+	if(m_pplineCreationQueue.isEnabled())
+	{
+		m_pplineCreationQueue.waitIdle();
+	}
+
 	LockGuard<Mutex> lock(m_globalMtx);
 	vkQueueWaitIdle(m_queue);
+	if(m_asyncComputeQueue)
+	{
+		vkQueueWaitIdle(m_asyncComputeQueue);
+	}
 }
 
 void GrManagerImpl::trySetVulkanHandleName(CString name, VkDebugReportObjectTypeEXT type, U64 handle) const
@@ -18,6 +18,7 @@
 #include <anki/gr/vulkan/SwapchainFactory.h>
 #include <anki/gr/vulkan/PipelineLayout.h>
 #include <anki/gr/vulkan/PipelineCache.h>
+#include <anki/gr/vulkan/PipelineManifest.h>
 #include <anki/gr/vulkan/DescriptorSet.h>
 #include <anki/util/HashMap.h>
 #include <anki/util/File.h>
@@ -52,6 +53,12 @@ public:
 		return m_queueIdx;
 	}
 
+	/// The queue families that share the resources. The general one and the async compute one if there is one.
+	ConstWeakArray<U32> getQueueFamilies() const
+	{
+		return ConstWeakArray<U32>(&m_queueFamilies[0], (m_asyncComputeQueue) ? 2 : 1);
+	}
+
 	const VkPhysicalDeviceProperties& getPhysicalDeviceProperties() const
 	{
 		return m_devProps;
@@ -83,14 +90,16 @@ public:
 	/// @name object_creation
 	/// @{
 
-	CommandBufferFactory& getCommandBufferFactory()
+	CommandBufferFactory& getCommandBufferFactory(Bool asyncCompute = false)
 	{
-		return m_cmdbFactory;
+		ANKI_ASSERT(!asyncCompute || m_asyncComputeQueue);
+		return (asyncCompute) ? m_asyncComputeCmdbFactory : m_cmdbFactory;
 	}
 
-	const CommandBufferFactory& getCommandBufferFactory() const
+	const CommandBufferFactory& getCommandBufferFactory(Bool asyncCompute = false) const
 	{
-		return m_cmdbFactory;
+		ANKI_ASSERT(!asyncCompute || m_asyncComputeQueue);
+		return (asyncCompute) ? m_asyncComputeCmdbFactory : m_cmdbFactory;
 	}
 
 	MicroFencePtr newFence()
@@ -104,7 +113,12 @@ public:
 	}
 	/// @}
 
-	void flushCommandBuffer(CommandBufferPtr ptr, FencePtr* fence, Bool wait = false);
+	void flushCommandBuffer(CommandBufferPtr ptr, FencePtr* fence, ConstWeakArray<FencePtr> waitFences = {},
+							Bool crossQueueFence = false, Bool wait = false);
+
+	/// A FenceImpl is destroyed before some other flush waited on its semaphore. The next flush will wait on it so it
+	/// can be reused.
+	void releaseUnwaitedSemaphore(MicroSemaphorePtr semaphore);
 
 	/// @name Memory
 	/// @{
@@ -160,6 +174,17 @@ public:
 		return m_pplineCache.m_cacheHandle;
 	}
 
+	PipelineCreationQueue& getPipelineCreationQueue()
+	{
+		return m_pplineCreationQueue;
+	}
+
+	/// It's nullptr if the manifest is disabled.
+	PipelineManifest* getPipelineManifest()
+	{
+		return (m_pplineManifest.isEnabled()) ? &m_pplineManifest : nullptr;
+	}
+
 	PipelineLayoutFactory& getPipelineLayoutFactory()
 	{
 		return m_pplineLayoutFactory;
@@ -249,6 +274,8 @@ private:
 	VkDevice m_device = VK_NULL_HANDLE;
 	U32 m_queueIdx = MAX_U32;
 	VkQueue m_queue = VK_NULL_HANDLE;
+	VkQueue m_asyncComputeQueue = VK_NULL_HANDLE;
+	Array<U32, 2> m_queueFamilies = {{MAX_U32, MAX_U32}}; ///< The general and the async compute one.
 	Mutex m_globalMtx;
 
 	VkPhysicalDeviceProperties m_devProps = {};
@@ -292,6 +319,10 @@ private:
 	/// @}
 
 	CommandBufferFactory m_cmdbFactory;
+	CommandBufferFactory m_asyncComputeCmdbFactory;
+
+	/// Semaphores that were signaled but nobody waited on them. Protected by m_globalMtx.
+	DynamicArray<MicroSemaphorePtr> m_unwaitedSemaphores;
 
 	FenceFactory m_fences;
 	SemaphoreFactory m_semaphores;
@@ -309,6 +340,8 @@ private:
 	QueryFactory m_timestampQueryFactory;
 
 	PipelineCache m_pplineCache;
+	PipelineCreationQueue m_pplineCreationQueue;
+	PipelineManifest m_pplineManifest;
 
 	Bool m_r8g8b8ImagesSupported = false;
 	Bool m_s8ImagesSupported = false;
@@ -5,6 +5,7 @@
 
 #include <anki/gr/vulkan/Pipeline.h>
 #include <anki/gr/vulkan/GrManagerImpl.h>
+#include <anki/gr/vulkan/PipelineManifest.h>
 #include <anki/gr/utils/Functions.h>
 #include <anki/util/Tracer.h>
 
@@ -195,6 +196,56 @@ void PipelineStateTracker::updateSuperHash()
 	m_hashes.m_superHash = computeHash(&buff[0], count * sizeof(buff[0]));
 }
 
+void PipelineStateTracker::getRecord(PipelineStateRecord& record) const
+{
+	record = {};
+	record.m_programHash = static_cast<const ShaderProgramImpl&>(*m_state.m_prog).getContentHash();
+
+#define ANKI_COPY_STATE(memb_) memcpy(static_cast<void*>(&record.memb_), &m_state.memb_, sizeof(m_state.memb_))
+	ANKI_COPY_STATE(m_vertex);
+	ANKI_COPY_STATE(m_inputAssembler);
+	ANKI_COPY_STATE(m_tessellation);
+	ANKI_COPY_STATE(m_viewport);
+	ANKI_COPY_STATE(m_rasterizer);
+	ANKI_COPY_STATE(m_depth);
+	ANKI_COPY_STATE(m_stencil);
+	ANKI_COPY_STATE(m_color);
+#undef ANKI_COPY_STATE
+
+	static_cast<const FramebufferImpl&>(*getFb()).getAttachmentFormats(record.m_attachmentFormats);
+	record.m_fbColorAttachmentMask = m_fbColorAttachmentMask;
+	record.m_fbDepth = m_fbDepth;
+	record.m_fbStencil = m_fbStencil;
+	record.m_defaultFb = m_defaultFb;
+}
+
+void PipelineStateTracker::setRecord(const PipelineStateRecord& record, VkRenderPass rpass)
+{
+	ANKI_ASSERT(rpass);
+	reset();
+
+#define ANKI_COPY_STATE(memb_) memcpy(static_cast<void*>(&m_state.memb_), &record.memb_, sizeof(m_state.memb_))
+	ANKI_COPY_STATE(m_vertex);
+	ANKI_COPY_STATE(m_inputAssembler);
+	ANKI_COPY_STATE(m_tessellation);
+	ANKI_COPY_STATE(m_viewport);
+	ANKI_COPY_STATE(m_rasterizer);
+	ANKI_COPY_STATE(m_depth);
+	ANKI_COPY_STATE(m_stencil);
+	ANKI_COPY_STATE(m_color);
+#undef ANKI_COPY_STATE
+
+	// The record has all the state that the program needs
+	m_set.m_attribs.setAll();
+	m_set.m_vertBindings.setAll();
+
+	m_fbColorAttachmentMask = record.m_fbColorAttachmentMask;
+	m_fbDepth = record.m_fbDepth;
+	m_fbStencil = record.m_fbStencil;
+	m_defaultFb = record.m_defaultFb;
+	m_rpass = rpass;
+}
+
 const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateInfo()
 {
 	VkGraphicsPipelineCreateInfo& ci = m_ci.m_ppline;
@@ -383,13 +434,185 @@ const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateIn
 	return ci;
 }
 
+void PipelineCreateInfo::copy(const PipelineCreateInfo& b)
+{
+	*this = b;
+
+	// Fix the pointers. The rest point to memory that is owned by the program
+	m_vert.pVertexAttributeDescriptions = &m_attribs[0];
+	m_vert.pVertexBindingDescriptions = &m_vertBindings[0];
+	m_color.pAttachments = &m_colAttachments[0];
+
+	m_ppline.pVertexInputState = &m_vert;
+	m_ppline.pInputAssemblyState = &m_ia;
+	m_ppline.pViewportState = &m_vp;
+	m_ppline.pRasterizationState = &m_rast;
+	m_ppline.pMultisampleState = &m_ms;
+	m_ppline.pDynamicState = &m_dyn;
+
+	if(b.m_rast.pNext)
+	{
+		m_rast.pNext = &m_rasterOrder;
+	}
+
+	if(b.m_ppline.pDepthStencilState)
+	{
+		m_ppline.pDepthStencilState = &m_ds;
+	}
+
+	if(b.m_ppline.pColorBlendState)
+	{
+		m_ppline.pColorBlendState = &m_color;
+	}
+}
+
+void PipelineCreationQueue::init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache, U32 threadCount)
+{
+	ANKI_ASSERT(dev && pplineCache);
+	m_alloc = alloc;
+	m_dev = dev;
+	m_pplineCache = pplineCache;
+
+	if(threadCount)
+	{
+		ANKI_VK_LOGI("Will create the graphics pipelines in %u background threads", threadCount);
+	}
+
+	m_threads.create(m_alloc, threadCount);
+	for(Thread*& thread : m_threads)
+	{
+		thread = m_alloc.newInstance<Thread>("anki_vkppline");
+		thread->start(this, threadCallback);
+	}
+}
+
+void PipelineCreationQueue::destroy()
+{
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_quit = true;
+		m_newJobCondVar.notifyAll();
+	}
+
+	for(Thread* thread : m_threads)
+	{
+		const Error err = thread->join();
+		(void)err;
+		m_alloc.deleteInstance(thread);
+	}
+
+	m_threads.destroy(m_alloc);
+
+	// Drop the jobs of the programs that are still alive
+	while(!m_jobs.isEmpty())
+	{
+		m_alloc.deleteInstance(m_jobs.popFront());
+	}
+}
+
+Error PipelineCreationQueue::threadCallback(ThreadCallbackInfo& info)
+{
+	PipelineCreationQueue& self = *static_cast<PipelineCreationQueue*>(info.m_userData);
+
+	while(true)
+	{
+		// Get a job
+		PipelineCreationJob* job;
+		{
+			LockGuard<Mutex> lock(self.m_mtx);
+
+			while(self.m_jobs.isEmpty() && !self.m_quit)
+			{
+				self.m_newJobCondVar.wait(self.m_mtx);
+			}
+
+			if(self.m_quit)
+			{
+				break;
+			}
+
+			job = self.m_jobs.popFront();
+			++job->m_factory->m_runningJobCount;
+			++self.m_runningJobCount;
+		}
+
+		// Create the pipeline
+		VkPipeline handle;
+		{
+			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
+			ANKI_VK_CHECKF(
+				vkCreateGraphicsPipelines(self.m_dev, self.m_pplineCache, 1, &job->m_ci.m_ppline, nullptr, &handle));
+		}
+
+		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+
+		job->m_prog->getGrManagerImpl().printPipelineShaderInfo(handle, job->m_prog->getName(),
+																 job->m_prog->getStages(), job->m_hash);
+
+		job->m_factory->setPipelineHandle(job->m_hash, handle);
+
+		// Done
+		{
+			LockGuard<Mutex> lock(self.m_mtx);
+			--job->m_factory->m_runningJobCount;
+			--self.m_runningJobCount;
+			self.m_jobDoneCondVar.notifyAll();
+		}
+
+		self.m_alloc.deleteInstance(job);
+	}
+
+	return Error::NONE;
+}
+
+void PipelineCreationQueue::submitJob(PipelineCreationJob* job)
+{
+	ANKI_ASSERT(isEnabled() && job);
+	LockGuard<Mutex> lock(m_mtx);
+	m_jobs.pushBack(job);
+	m_newJobCondVar.notifyOne();
+}
+
+void PipelineCreationQueue::waitIdle()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	while(!m_jobs.isEmpty() || m_runningJobCount > 0)
+	{
+		m_jobDoneCondVar.wait(m_mtx);
+	}
+}
+
+void PipelineCreationQueue::cancelJobs(PipelineFactory& factory)
+{
+	LockGuard<Mutex> lock(m_mtx);
+
+	auto it = m_jobs.getBegin();
+	while(it != m_jobs.getEnd())
+	{
+		PipelineCreationJob* job = &(*it);
+		++it;
+
+		if(job->m_factory == &factory)
+		{
+			m_jobs.erase(job);
+			m_alloc.deleteInstance(job);
+		}
+	}
+
+	while(factory.m_runningJobCount > 0)
+	{
+		m_jobDoneCondVar.wait(m_mtx);
+	}
+}
+
 class PipelineFactory::PipelineInternal
 {
 public:
-	VkPipeline m_handle = VK_NULL_HANDLE;
+	VkPipeline m_handle = VK_NULL_HANDLE; ///< It's null while the pipeline is created in the background.
 
 	/// The pipeline needs a render pass and the framebuffers are the owners of that. So the internal pipeline will
-	/// hold a ref to the FB in order to hold a ref to the render pass.
+	/// hold a ref to the FB in order to hold a ref to the render pass. The pipelines of the warmup use render passes
+	/// that are owned by the PipelineManifest.
 	FramebufferPtr m_fb;
 };
 
@@ -404,6 +627,11 @@ public:
 
 void PipelineFactory::destroy()
 {
+	if(m_queue && m_queue->isEnabled())
+	{
+		m_queue->cancelJobs(*this);
+	}
+
 	for(auto it : m_pplines)
 	{
 		if(it.m_handle)
@@ -437,24 +665,80 @@ void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline,
 	else
 	{
 		PipelineInternal pp;
-		const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
 		pp.m_fb = state.getFb();
+		m_pplines.emplace(m_alloc, hash, pp);
 
+		if(m_manifest)
 		{
-			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
-			ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &pp.m_handle));
+			PipelineStateRecord record;
+			state.getRecord(record);
+			m_manifest->addRecord(record);
 		}
 
-		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+		ppline.m_handle = createPipeline(state, hash);
+	}
 
-		m_pplines.emplace(m_alloc, hash, pp);
-		ppline.m_handle = pp.m_handle;
+	if(ANKI_UNLIKELY(!ppline.m_handle))
+	{
+		// Still in the queue. Don't bind anything and ask again on the next drawcall
+		state.invalidateLastPipeline();
+	}
+}
+
+void PipelineFactory::warmupPipeline(PipelineStateTracker& state)
+{
+	U64 hash;
+	Bool stateDirty;
+	state.flush(hash, stateDirty);
+
+	LockGuard<SpinLock> lock(m_pplinesMtx);
 
-		// Print shader info
-		const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
-		shaderImpl.getGrManagerImpl().printPipelineShaderInfo(pp.m_handle, shaderImpl.getName(), shaderImpl.getStages(),
-															  hash);
+	if(m_pplines.find(hash) == m_pplines.getEnd())
+	{
+		m_pplines.emplace(m_alloc, hash, PipelineInternal());
+		createPipeline(state, hash);
 	}
 }
 
+VkPipeline PipelineFactory::createPipeline(PipelineStateTracker& state, U64 hash)
+{
+	const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
+	const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
+
+	if(m_queue && m_queue->isEnabled())
+	{
+		PipelineCreationJob* job = m_alloc.newInstance<PipelineCreationJob>();
+		job->m_factory = this;
+		job->m_prog = &shaderImpl;
+		job->m_hash = hash;
+		job->m_ci.copy(state.m_ci);
+
+		m_queue->submitJob(job);
+		return VK_NULL_HANDLE;
+	}
+
+	VkPipeline handle;
+	{
+		ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
+		ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &handle));
+	}
+
+	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+
+	(*m_pplines.find(hash)).m_handle = handle;
+
+	// Print shader info
+	shaderImpl.getGrManagerImpl().printPipelineShaderInfo(handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
+
+	return handle;
+}
+
+void PipelineFactory::setPipelineHandle(U64 hash, VkPipeline handle)
+{
+	LockGuard<SpinLock> lock(m_pplinesMtx);
+	auto it = m_pplines.find(hash);
+	ANKI_ASSERT(it != m_pplines.getEnd() && (*it).m_handle == VK_NULL_HANDLE);
+	(*it).m_handle = handle;
+}
+
 } // end namespace anki
@@ -11,10 +11,16 @@
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/vulkan/FramebufferImpl.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/List.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
 
+// Forward
+class PipelineFactory;
+class PipelineManifest;
+
 /// @addtogroup vulkan
 /// @{
 
@@ -173,6 +179,76 @@ public:
 	}
 };
 
+/// The state that built a graphics pipeline in a form that can be stored to disk and used to re-create the pipeline
+/// in a later run. See PipelineManifest.
+class PipelineStateRecord
+{
+public:
+	U64 m_programHash; ///< See ShaderProgramImpl::getContentHash().
+	PPVertexStateInfo m_vertex;
+	PPInputAssemblerStateInfo m_inputAssembler;
+	PPTessellationStateInfo m_tessellation;
+	PPViewportStateInfo m_viewport;
+	PPRasterizerStateInfo m_rasterizer;
+	PPDepthStateInfo m_depth;
+	PPStencilStateInfo m_stencil;
+	PPColorStateInfo m_color;
+
+	/// The formats of the framebuffer. The depth stencil format is the last one.
+	Array<VkFormat, MAX_COLOR_ATTACHMENTS + 1> m_attachmentFormats;
+	BitSet<MAX_COLOR_ATTACHMENTS, U8> m_fbColorAttachmentMask;
+	Bool m_fbDepth;
+	Bool m_fbStencil;
+	Bool m_defaultFb;
+
+	/// Zero everything, including the padding, because the record will be hashed and written to disk.
+	PipelineStateRecord()
+	{
+		zeroMemory(*this);
+	}
+
+	/// The members are non-copyable to protect the hashing of PipelineInfoState. The record has no such problem.
+	PipelineStateRecord(const PipelineStateRecord& b)
+	{
+		*this = b;
+	}
+
+	PipelineStateRecord& operator=(const PipelineStateRecord& b)
+	{
+		memcpy(static_cast<void*>(this), &b, sizeof(*this));
+		return *this;
+	}
+
+	/// A hash of the whole record. It's the same between runs.
+	U64 computeHash() const
+	{
+		return anki::computeHash(this, sizeof(*this));
+	}
+};
+
+/// The structures that build a VkGraphicsPipelineCreateInfo.
+class PipelineCreateInfo
+{
+public:
+	Array<VkVertexInputBindingDescription, MAX_VERTEX_ATTRIBUTES> m_vertBindings;
+	Array<VkVertexInputAttributeDescription, MAX_VERTEX_ATTRIBUTES> m_attribs;
+	VkPipelineVertexInputStateCreateInfo m_vert;
+	VkPipelineInputAssemblyStateCreateInfo m_ia;
+	VkPipelineViewportStateCreateInfo m_vp;
+	VkPipelineTessellationStateCreateInfo m_tess;
+	VkPipelineRasterizationStateCreateInfo m_rast;
+	VkPipelineMultisampleStateCreateInfo m_ms;
+	VkPipelineDepthStencilStateCreateInfo m_ds;
+	Array<VkPipelineColorBlendAttachmentState, MAX_COLOR_ATTACHMENTS> m_colAttachments;
+	VkPipelineColorBlendStateCreateInfo m_color;
+	VkPipelineDynamicStateCreateInfo m_dyn;
+	VkGraphicsPipelineCreateInfo m_ppline;
+	VkPipelineRasterizationStateRasterizationOrderAMD m_rasterOrder;
+
+	/// Copy another create info and make the internal pointers point to this one.
+	void copy(const PipelineCreateInfo& b);
+};
+
 /// Track changes in the static state.
 class PipelineStateTracker : public NonCopyable
 {
@@ -440,6 +516,19 @@ public:
 		return m_fb;
 	}
 
+	/// The pipeline of the last flush() wasn't bound. Make the next flush() report dirty state.
+	void invalidateLastPipeline()
+	{
+		m_hashes.m_lastSuperHash = 0;
+	}
+
+	/// Store the state that affects the pipeline. Call it after flush().
+	void getRecord(PipelineStateRecord& record) const;
+
+	/// Set the state from a record. It's used to create pipelines without a framebuffer. The shader program needs to be
+	/// bound after that.
+	void setRecord(const PipelineStateRecord& record, VkRenderPass rpass);
+
 	void reset();
 
 private:
@@ -510,25 +599,7 @@ private:
 		}
 	} m_hashes;
 
-	// Create info
-	class CreateInfo
-	{
-	public:
-		Array<VkVertexInputBindingDescription, MAX_VERTEX_ATTRIBUTES> m_vertBindings;
-		Array<VkVertexInputAttributeDescription, MAX_VERTEX_ATTRIBUTES> m_attribs;
-		VkPipelineVertexInputStateCreateInfo m_vert;
-		VkPipelineInputAssemblyStateCreateInfo m_ia;
-		VkPipelineViewportStateCreateInfo m_vp;
-		VkPipelineTessellationStateCreateInfo m_tess;
-		VkPipelineRasterizationStateCreateInfo m_rast;
-		VkPipelineMultisampleStateCreateInfo m_ms;
-		VkPipelineDepthStencilStateCreateInfo m_ds;
-		Array<VkPipelineColorBlendAttachmentState, MAX_COLOR_ATTACHMENTS> m_colAttachments;
-		VkPipelineColorBlendStateCreateInfo m_color;
-		VkPipelineDynamicStateCreateInfo m_dyn;
-		VkGraphicsPipelineCreateInfo m_ppline;
-		VkPipelineRasterizationStateRasterizationOrderAMD m_rasterOrder;
-	} m_ci;
+	PipelineCreateInfo m_ci;
 
 	Bool updateHashes();
 	void updateSuperHash();
@@ -546,13 +617,84 @@ public:
 		return m_handle;
 	}
 
+	/// It's false if the pipeline is still being created in the background.
+	Bool isCreated() const
+	{
+		return m_handle != VK_NULL_HANDLE;
+	}
+
 private:
 	VkPipeline m_handle ANKI_DEBUG_CODE(= 0);
 };
 
+/// A pipeline that will be created by the PipelineCreationQueue.
+class PipelineCreationJob : public IntrusiveListEnabled<PipelineCreationJob>
+{
+public:
+	PipelineFactory* m_factory = nullptr;
+	const ShaderProgramImpl* m_prog = nullptr; ///< Only for printing. The program waits for its jobs to finish.
+	U64 m_hash = 0;
+	PipelineCreateInfo m_ci;
+};
+
+/// Creates graphics pipelines in a number of background threads.
+class PipelineCreationQueue
+{
+	friend class PipelineFactory;
+
+public:
+	PipelineCreationQueue()
+	{
+	}
+
+	~PipelineCreationQueue()
+	{
+		ANKI_ASSERT(m_threads.getSize() == 0 && "Forgot to call destroy()");
+	}
+
+	/// @param threadCount If it's zero the pipelines will be created synchronously.
+	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache, U32 threadCount);
+
+	/// Stop the threads. The jobs that haven't started will be dropped.
+	void destroy();
+
+	Bool isEnabled() const
+	{
+		return m_threads.getSize() > 0;
+	}
+
+	/// Wait for all the submitted jobs to finish.
+	/// @note Thread-safe.
+	void waitIdle();
+
+private:
+	GrAllocator<U8> m_alloc;
+	VkDevice m_dev = VK_NULL_HANDLE;
+	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
+
+	DynamicArray<Thread*> m_threads;
+	IntrusiveList<PipelineCreationJob> m_jobs;
+	Mutex m_mtx;
+	ConditionVariable m_newJobCondVar;
+	ConditionVariable m_jobDoneCondVar;
+	U32 m_runningJobCount = 0; ///< Of all factories.
+	Bool m_quit = false;
+
+	static Error threadCallback(ThreadCallbackInfo& info);
+
+	/// @note Thread-safe.
+	void submitJob(PipelineCreationJob* job);
+
+	/// Drop the jobs of a factory that haven't started and wait for the ones that are running.
+	/// @note Thread-safe.
+	void cancelJobs(PipelineFactory& factory);
+};
+
 /// Given some state it creates/hashes pipelines.
 class PipelineFactory
 {
+	friend class PipelineCreationQueue;
+
 public:
 	PipelineFactory()
 	{
@@ -562,18 +704,29 @@ public:
 	{
 	}
 
-	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache)
+	/// @param queue Create the pipelines in the background if the queue is enabled.
+	/// @param manifest Record the new pipelines to that manifest. Can be nullptr.
+	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache, PipelineCreationQueue* queue,
+			  PipelineManifest* manifest)
 	{
 		m_alloc = alloc;
 		m_dev = dev;
 		m_pplineCache = pplineCache;
+		m_queue = queue;
+		m_manifest = manifest;
 	}
 
 	void destroy();
 
+	/// Get or create a pipeline. If the pipeline is created in the background the stateDirty will be true and the
+	/// ppline will not be created. The drawcall should be skipped in that case.
 	/// @note Thread-safe.
 	void newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty);
 
+	/// Start creating a pipeline without recording it to the manifest. Used to warm up the pipelines of a program.
+	/// @note Thread-safe.
+	void warmupPipeline(PipelineStateTracker& state);
+
 private:
 	class PipelineInternal;
 	class Hasher;
@@ -581,9 +734,19 @@ private:
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev = VK_NULL_HANDLE;
 	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
+	PipelineCreationQueue* m_queue = nullptr;
+	PipelineManifest* m_manifest = nullptr;
 
 	HashMap<U64, PipelineInternal, Hasher> m_pplines;
 	SpinLock m_pplinesMtx;
+
+	U32 m_runningJobCount = 0; ///< Protected by the mutex of the PipelineCreationQueue.
+
+	/// Create or start creating a new pipeline. Needs to be called with m_pplinesMtx locked.
+	VkPipeline createPipeline(PipelineStateTracker& state, U64 hash);
+
+	/// Called by the PipelineCreationQueue when a pipeline is ready.
+	void setPipelineHandle(U64 hash, VkPipeline handle);
 };
 /// @}
 
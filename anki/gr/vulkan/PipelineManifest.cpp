@@ -0,0 +1,266 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/vulkan/PipelineManifest.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
+#include <algorithm>
+
+namespace anki
+{
+
+/// The header of the manifest file. The records follow.
+class PipelineManifestHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_recordSize; ///< If the PipelineStateRecord changes the old manifests will be ignored.
+	U32 m_recordCount;
+};
+
+static const Array<U8, 8> PIPELINE_MANIFEST_MAGIC = {{'A', 'N', 'K', 'I', 'P', 'P', 'M', '1'}};
+
+Error PipelineManifest::init(VkDevice dev, CString cacheDir, const ConfigSet& cfg, GrAllocator<U8> alloc)
+{
+	ANKI_ASSERT(cacheDir && dev);
+	m_alloc = alloc;
+	m_dev = dev;
+	m_maxSize = cfg.getNumberU32("gr_diskShaderCacheMaxSize");
+	m_filename.sprintf(alloc, "%s/vk_pipeline_manifest", &cacheDir[0]);
+
+	return load();
+}
+
+void PipelineManifest::destroy()
+{
+	if(!isEnabled())
+	{
+		return;
+	}
+
+	const Error err = store();
+	if(err)
+	{
+		ANKI_VK_LOGE("An error occurred while storing the pipeline manifest to disk. Will ignore");
+	}
+
+	for(VkRenderPass rpass : m_rpasses)
+	{
+		vkDestroyRenderPass(m_dev, rpass, nullptr);
+	}
+
+	m_rpasses.destroy(m_alloc);
+	m_recordHashes.destroy(m_alloc);
+	m_records.destroy(m_alloc);
+	m_filename.destroy(m_alloc);
+	m_dev = VK_NULL_HANDLE;
+}
+
+Error PipelineManifest::load()
+{
+	if(!fileExists(m_filename.toCString()))
+	{
+		ANKI_VK_LOGI("Pipeline manifest not found: %s", &m_filename[0]);
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_filename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::READ));
+
+	PipelineManifestHeader header;
+	if(file.getSize() < sizeof(header))
+	{
+		ANKI_VK_LOGI("Pipeline manifest appears to be empty: %s", &m_filename[0]);
+		return Error::NONE;
+	}
+
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+
+	if(memcmp(&header.m_magic[0], &PIPELINE_MANIFEST_MAGIC[0], sizeof(header.m_magic)) != 0
+	   || header.m_recordSize != sizeof(PipelineStateRecord)
+	   || file.getSize() != sizeof(header) + PtrSize(header.m_recordCount) * sizeof(PipelineStateRecord))
+	{
+		ANKI_VK_LOGI("Pipeline manifest is not compatible with the current build: %s", &m_filename[0]);
+		return Error::NONE;
+	}
+
+	if(header.m_recordCount == 0)
+	{
+		return Error::NONE;
+	}
+
+	m_records.create(m_alloc, header.m_recordCount);
+	ANKI_CHECK(file.read(&m_records[0], m_records.getSizeInBytes()));
+
+	// Sort them by program for the warmup
+	std::sort(m_records.getBegin(), m_records.getEnd(), [](const PipelineStateRecord& a, const PipelineStateRecord& b) {
+		return a.m_programHash < b.m_programHash;
+	});
+
+	m_loadedRecordCount = m_records.getSize();
+	for(U32 i = 0; i < m_loadedRecordCount; ++i)
+	{
+		m_recordHashes.emplace(m_alloc, m_records[i].computeHash(), i);
+	}
+
+	ANKI_VK_LOGI("Loaded %u pipelines from the pipeline manifest", m_loadedRecordCount);
+	return Error::NONE;
+}
+
+Error PipelineManifest::store()
+{
+	if(m_records.getSize() == m_loadedRecordCount)
+	{
+		// Nothing new
+		return Error::NONE;
+	}
+
+	// If it's too big keep the records of this run and drop some of the old ones
+	const U32 maxRecordCount = U32(min<PtrSize>(m_maxSize / sizeof(PipelineStateRecord), MAX_U32));
+	const U32 newRecordCount = min(m_records.getSize() - m_loadedRecordCount, maxRecordCount);
+	const U32 oldRecordCount = min(m_loadedRecordCount, maxRecordCount - newRecordCount);
+
+	File file;
+	ANKI_CHECK(file.open(m_filename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::WRITE));
+
+	PipelineManifestHeader header;
+	header.m_magic = PIPELINE_MANIFEST_MAGIC;
+	header.m_recordSize = sizeof(PipelineStateRecord);
+	header.m_recordCount = newRecordCount + oldRecordCount;
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	ANKI_CHECK(file.write(&m_records[m_loadedRecordCount], newRecordCount * sizeof(PipelineStateRecord)));
+	if(oldRecordCount)
+	{
+		ANKI_CHECK(file.write(&m_records[0], oldRecordCount * sizeof(PipelineStateRecord)));
+	}
+
+	ANKI_VK_LOGI("Stored %u pipelines to the pipeline manifest", header.m_recordCount);
+	return Error::NONE;
+}
+
+void PipelineManifest::addRecord(const PipelineStateRecord& record)
+{
+	const U64 hash = record.computeHash();
+
+	LockGuard<Mutex> lock(m_mtx);
+	if(m_recordHashes.find(hash) == m_recordHashes.getEnd())
+	{
+		m_recordHashes.emplace(m_alloc, hash, m_records.getSize());
+		m_records.emplaceBack(m_alloc, record);
+	}
+}
+
+VkRenderPass PipelineManifest::getOrCreateRenderPass(const PipelineStateRecord& record)
+{
+	const U64 hash = computeHash(&record.m_attachmentFormats, sizeof(record.m_attachmentFormats));
+
+	auto it = m_rpasses.find(hash);
+	if(it != m_rpasses.getEnd())
+	{
+		return *it;
+	}
+
+	// Only the formats matter for compatibility. The rest is arbitrary
+	Array<VkAttachmentDescription, MAX_COLOR_ATTACHMENTS + 1> attachments = {};
+	Array<VkAttachmentReference, MAX_COLOR_ATTACHMENTS + 1> references = {};
+	U32 colorAttachmentCount = 0;
+	for(U32 i = 0; i < MAX_COLOR_ATTACHMENTS; ++i)
+	{
+		if(record.m_attachmentFormats[i] == VK_FORMAT_UNDEFINED)
+		{
+			break;
+		}
+
+		VkAttachmentDescription& desc = attachments[colorAttachmentCount];
+		desc.format = record.m_attachmentFormats[i];
+		desc.samples = VK_SAMPLE_COUNT_1_BIT;
+		desc.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		desc.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		desc.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		references[colorAttachmentCount].attachment = colorAttachmentCount;
+		references[colorAttachmentCount].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		++colorAttachmentCount;
+	}
+
+	U32 attachmentCount = colorAttachmentCount;
+	const VkFormat dsFormat = record.m_attachmentFormats[MAX_COLOR_ATTACHMENTS];
+	if(dsFormat != VK_FORMAT_UNDEFINED)
+	{
+		VkAttachmentDescription& desc = attachments[attachmentCount];
+		desc.format = dsFormat;
+		desc.samples = VK_SAMPLE_COUNT_1_BIT;
+		desc.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		desc.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		desc.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		references[attachmentCount].attachment = attachmentCount;
+		references[attachmentCount].layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		++attachmentCount;
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = colorAttachmentCount;
+	subpass.pColorAttachments = (colorAttachmentCount) ? &references[0] : nullptr;
+	subpass.pDepthStencilAttachment = (dsFormat != VK_FORMAT_UNDEFINED) ? &references[colorAttachmentCount] : nullptr;
+
+	VkRenderPassCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	ci.attachmentCount = attachmentCount;
+	ci.pAttachments = &attachments[0];
+	ci.subpassCount = 1;
+	ci.pSubpasses = &subpass;
+
+	VkRenderPass rpass;
+	ANKI_VK_CHECKF(vkCreateRenderPass(m_dev, &ci, nullptr, &rpass));
+	m_rpasses.emplace(m_alloc, hash, rpass);
+
+	return rpass;
+}
+
+void PipelineManifest::warmup(const ShaderProgramPtr& prog)
+{
+	ShaderProgramImpl& progImpl = static_cast<ShaderProgramImpl&>(*prog);
+	ANKI_ASSERT(progImpl.isGraphics());
+	const U64 progHash = progImpl.getContentHash();
+
+	// Gather the records of the program
+	DynamicArrayAuto<PipelineStateRecord> records(m_alloc);
+	DynamicArrayAuto<VkRenderPass> rpasses(m_alloc);
+	{
+		LockGuard<Mutex> lock(m_mtx);
+
+		const PipelineStateRecord* end = m_records.getBegin() + m_loadedRecordCount;
+		const PipelineStateRecord* it = std::lower_bound(
+			m_records.getBegin(), end, progHash,
+			[](const PipelineStateRecord& record, U64 hash) { return record.m_programHash < hash; });
+
+		for(; it != end && it->m_programHash == progHash; ++it)
+		{
+			records.emplaceBack(*it);
+			rpasses.emplaceBack(getOrCreateRenderPass(*it));
+		}
+	}
+
+	// Start creating the pipelines
+	for(U32 i = 0; i < records.getSize(); ++i)
+	{
+		PipelineStateTracker state;
+		state.setRecord(records[i], rpasses[i]);
+		state.bindShaderProgram(prog);
+		progImpl.getPipelineFactory().warmupPipeline(state);
+	}
+}
+
+} // end namespace anki
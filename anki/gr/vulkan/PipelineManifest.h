@@ -0,0 +1,76 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/vulkan/Pipeline.h>
+
+namespace anki
+{
+
+// Forward
+class ConfigSet;
+
+/// @addtogroup vulkan
+/// @{
+
+/// On disk list of the graphics pipelines that were created in previous runs. When a new graphics program is created
+/// it starts creating the pipelines that it needed the last time. This way the pipelines are ready before the first
+/// drawcall.
+class PipelineManifest
+{
+public:
+	PipelineManifest()
+	{
+	}
+
+	~PipelineManifest()
+	{
+		ANKI_ASSERT(m_records.getSize() == 0 && "Forgot to call destroy()");
+	}
+
+	ANKI_USE_RESULT Error init(VkDevice dev, CString cacheDir, const ConfigSet& cfg, GrAllocator<U8> alloc);
+
+	/// Store the manifest to disk and destroy it.
+	void destroy();
+
+	Bool isEnabled() const
+	{
+		return m_dev != VK_NULL_HANDLE;
+	}
+
+	/// Add a pipeline to the manifest.
+	/// @note Thread-safe.
+	void addRecord(const PipelineStateRecord& record);
+
+	/// Start creating the pipelines of a graphics program that were recorded in previous runs.
+	/// @note Thread-safe.
+	void warmup(const ShaderProgramPtr& prog);
+
+private:
+	GrAllocator<U8> m_alloc;
+	VkDevice m_dev = VK_NULL_HANDLE;
+	String m_filename;
+	PtrSize m_maxSize = 0;
+
+	/// The first m_loadedRecordCount came from the disk and they are sorted by program hash. The rest are new.
+	DynamicArray<PipelineStateRecord> m_records;
+	U32 m_loadedRecordCount = 0;
+	HashMap<U64, U32> m_recordHashes; ///< Record hash to record index. For fast duplicate detection.
+
+	/// Render passes that are compatible with the framebuffers of the records. Framebuffer formats hash to render pass.
+	HashMap<U64, VkRenderPass> m_rpasses;
+
+	Mutex m_mtx;
+
+	ANKI_USE_RESULT Error load();
+	ANKI_USE_RESULT Error store();
+
+	/// Needs to be called with m_mtx locked.
+	VkRenderPass getOrCreateRenderPass(const PipelineStateRecord& record);
+};
+/// @}
+
+} // end namespace anki
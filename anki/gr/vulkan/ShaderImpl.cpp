@@ -71,6 +71,14 @@ Error ShaderImpl::init(const ShaderInitInfo& inf)
 
 	ANKI_VK_CHECK(vkCreateShaderModule(getDevice(), &ci, nullptr, &m_handle));
 
+	// Don't hash the whole ShaderSpecializationConstValue because of the padding
+	m_contentHash = computeHash(&inf.m_binary[0], inf.m_binary.getSize());
+	for(const ShaderSpecializationConstValue& v : inf.m_constValues)
+	{
+		m_contentHash = appendHash(&v.m_constantId, sizeof(v.m_constantId), m_contentHash);
+		m_contentHash = appendHash(&v.m_uint, sizeof(v.m_uint), m_contentHash);
+	}
+
 	// Get reflection info
 	SpecConstsVector specConstIds;
 	doReflection(inf.m_binary, specConstIds);
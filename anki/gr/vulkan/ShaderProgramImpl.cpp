@@ -209,6 +209,11 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 			inf.pName = "main";
 			inf.module = shaderImpl.m_handle;
 			inf.pSpecializationInfo = shaderImpl.getSpecConstInfo();
+
+			const U64 shaderHash = shaderImpl.m_contentHash;
+			m_graphics.m_contentHash = (m_graphics.m_contentHash)
+										   ? appendHash(&shaderHash, sizeof(shaderHash), m_graphics.m_contentHash)
+										   : shaderHash;
 		}
 	}
 
@@ -218,7 +223,9 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	{
 		m_graphics.m_pplineFactory = getAllocator().newInstance<PipelineFactory>();
 		m_graphics.m_pplineFactory->init(getGrManagerImpl().getAllocator(), getGrManagerImpl().getDevice(),
-										 getGrManagerImpl().getPipelineCache());
+										 getGrManagerImpl().getPipelineCache(),
+										 &getGrManagerImpl().getPipelineCreationQueue(),
+										 getGrManagerImpl().getPipelineManifest());
 	}
 
 	// Create the pipeline if compute
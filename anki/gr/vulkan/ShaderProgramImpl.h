@@ -69,6 +69,13 @@ public:
 		return m_refl;
 	}
 
+	/// A hash of the shaders. Unlike the UUID it's the same between runs. Only for graphics programs.
+	U64 getContentHash() const
+	{
+		ANKI_ASSERT(isGraphics() && m_graphics.m_contentHash);
+		return m_graphics.m_contentHash;
+	}
+
 	/// Only for graphics programs.
 	PipelineFactory& getPipelineFactory()
 	{
@@ -121,6 +128,7 @@ private:
 		Array<VkPipelineShaderStageCreateInfo, U32(ShaderType::FRAGMENT - ShaderType::VERTEX) + 1> m_shaderCreateInfos;
 		U32 m_shaderCreateInfoCount = 0;
 		PipelineFactory* m_pplineFactory = nullptr;
+		U64 m_contentHash = 0;
 	} m_graphics;
 
 	class
@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/importer/GltfImporter.h>
+#include <anki/resource/AnimationBinary.h>
 #include <anki/util/System.h>
 #include <anki/util/ThreadHive.h>
 #include <anki/util/StringList.h>
@@ -1048,56 +1049,102 @@ Error GltfImporter::writeAnimation(const cgltf_animation& anim)
 
 	// Write file
 	File file;
-	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::WRITE));
+	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	AnimationBinaryHeader header = {};
+	memcpy(&header.m_magic[0], ANIMATION_MAGIC, sizeof(header.m_magic));
+	header.m_channelCount = tempChannels.getSize();
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	// Channel info. Positions are quantized in the bounding box of the channel
+	DynamicArrayAuto<AnimationBinaryChannel> binChannels(m_alloc, tempChannels.getSize());
+	for(U32 i = 0; i < tempChannels.getSize(); ++i)
+	{
+		const GltfAnimChannel& channel = tempChannels[i];
+		AnimationBinaryChannel& binChannel = binChannels[i];
+		memset(&binChannel, 0, sizeof(binChannel));
+
+		if(channel.m_name.getLength() >= binChannel.m_name.getSize())
+		{
+			ANKI_GLTF_LOGE("Channel name is too long: %s", channel.m_name.cstr());
+			return Error::USER_DATA;
+		}
+		memcpy(&binChannel.m_name[0], channel.m_name.cstr(), channel.m_name.getLength());
+
+		binChannel.m_positionKeyCount = channel.m_positions.getSize();
+		binChannel.m_rotationKeyCount = channel.m_rotations.getSize();
+		binChannel.m_scaleKeyCount = channel.m_scales.getSize();
 
-	ANKI_CHECK(file.writeText("%s\n<animation>\n", XML_HEADER));
-	ANKI_CHECK(file.writeText("\t<channels>\n"));
+		Vec3 posMin(MAX_F32);
+		Vec3 posMax(MIN_F32);
+		for(const GltfAnimKey<Vec3>& key : channel.m_positions)
+		{
+			posMin = posMin.min(key.m_value);
+			posMax = posMax.max(key.m_value);
+		}
+		binChannel.m_positionMin = (channel.m_positions.getSize()) ? posMin : Vec3(0.0f);
+		binChannel.m_positionRange = (channel.m_positions.getSize()) ? posMax - posMin : Vec3(0.0f);
+	}
+	ANKI_CHECK(file.write(&binChannels[0], binChannels.getSizeInBytes()));
 
-	for(const GltfAnimChannel& channel : tempChannels)
+	// Keys
+	for(U32 i = 0; i < tempChannels.getSize(); ++i)
 	{
-		ANKI_CHECK(file.writeText("\t\t<channel name=\"%s\">\n", channel.m_name.cstr()));
+		const GltfAnimChannel& channel = tempChannels[i];
+		const AnimationBinaryChannel& binChannel = binChannels[i];
 
 		// Positions
-		if(channel.m_positions.getSize())
+		for(const GltfAnimKey<Vec3>& key : channel.m_positions)
+		{
+			const F32 time = F32(key.m_time);
+			ANKI_CHECK(file.write(&time, sizeof(time)));
+		}
+
+		for(const GltfAnimKey<Vec3>& key : channel.m_positions)
 		{
-			ANKI_CHECK(file.writeText("\t\t\t<positionKeys>\n"));
-			for(const GltfAnimKey<Vec3>& key : channel.m_positions)
+			Array<U16, 3> quantized;
+			for(U32 c = 0; c < 3; ++c)
 			{
-				ANKI_CHECK(file.writeText("\t\t\t\t<key time=\"%f\">%f %f %f</key>\n", key.m_time, key.m_value.x(),
-										  key.m_value.y(), key.m_value.z()));
+				const F32 range = binChannel.m_positionRange[c];
+				const F32 unorm = (range > 0.0f) ? (key.m_value[c] - binChannel.m_positionMin[c]) / range : 0.0f;
+				quantized[c] = U16(round(clamp(unorm, 0.0f, 1.0f) * F32(MAX_U16)));
 			}
-			ANKI_CHECK(file.writeText("\t\t\t</positionKeys>\n"));
+
+			ANKI_CHECK(file.write(&quantized[0], sizeof(quantized)));
 		}
 
 		// Rotations
-		if(channel.m_rotations.getSize())
+		for(const GltfAnimKey<Quat>& key : channel.m_rotations)
+		{
+			const F32 time = F32(key.m_time);
+			ANKI_CHECK(file.write(&time, sizeof(time)));
+		}
+
+		for(const GltfAnimKey<Quat>& key : channel.m_rotations)
 		{
-			ANKI_CHECK(file.writeText("\t\t\t<rotationKeys>\n"));
-			for(const GltfAnimKey<Quat>& key : channel.m_rotations)
+			const Quat rot = key.m_value.getNormalized();
+			Array<I16, 4> quantized;
+			for(U32 c = 0; c < 4; ++c)
 			{
-				ANKI_CHECK(file.writeText("\t\t\t\t<key time=\"%f\">%f %f %f %f</key>\n", key.m_time, key.m_value.x(),
-										  key.m_value.y(), key.m_value.z(), key.m_value.w()));
+				quantized[c] = I16(round(clamp(rot[c], -1.0f, 1.0f) * F32(MAX_I16)));
 			}
-			ANKI_CHECK(file.writeText("\t\t\t</rotationKeys>\n"));
+
+			ANKI_CHECK(file.write(&quantized[0], sizeof(quantized)));
 		}
 
 		// Scales
-		if(channel.m_scales.getSize())
+		for(const GltfAnimKey<F32>& key : channel.m_scales)
 		{
-			ANKI_CHECK(file.writeText("\t\t\t<scaleKeys>\n"));
-			for(const GltfAnimKey<F32>& key : channel.m_scales)
-			{
-				ANKI_CHECK(file.writeText("\t\t\t\t<key time=\"%f\">%f</key>\n", key.m_time, key.m_value));
-			}
-			ANKI_CHECK(file.writeText("\t\t\t</scaleKeys>\n"));
+			const F32 time = F32(key.m_time);
+			ANKI_CHECK(file.write(&time, sizeof(time)));
 		}
 
-		ANKI_CHECK(file.writeText("\t\t</channel>\n"));
+		for(const GltfAnimKey<F32>& key : channel.m_scales)
+		{
+			ANKI_CHECK(file.write(&key.m_value, sizeof(key.m_value)));
+		}
 	}
 
-	ANKI_CHECK(file.writeText("\t</channels>\n"));
-	ANKI_CHECK(file.writeText("</animation>\n"));
-
 	return Error::NONE;
 }
 
@@ -249,6 +249,146 @@ static void decimateSubmesh(F32 factor, SubMesh& submesh, GenericMemoryPoolAlloc
 	submesh.m_verts = std::move(newVerts);
 }
 
+/// Compute the bounding sphere and the normal cone of a range of triangles.
+static void computeMeshletBounds(const SubMesh& submesh, U32 firstIdx, U32 idxCount, MeshBinaryFile::Meshlet& meshlet)
+{
+	// Bounding sphere. Use the center of the AABB, it's good enough
+	Vec3 aabbMin(MAX_F32);
+	Vec3 aabbMax(MIN_F32);
+	for(U32 i = firstIdx; i < firstIdx + idxCount; ++i)
+	{
+		const Vec3& pos = submesh.m_verts[submesh.m_indices[i]].m_position;
+		aabbMin = aabbMin.min(pos);
+		aabbMax = aabbMax.max(pos);
+	}
+
+	const Vec3 center = (aabbMin + aabbMax) / 2.0f;
+	F32 radius = 0.0f;
+	for(U32 i = firstIdx; i < firstIdx + idxCount; ++i)
+	{
+		radius = max(radius, (submesh.m_verts[submesh.m_indices[i]].m_position - center).getLength());
+	}
+
+	meshlet.m_sphereCenter = center;
+	meshlet.m_sphereRadius = radius;
+
+	// Normal cone. The axis is the average of the face normals and the angle is the max deviation from it
+	Vec3 axis(0.0f);
+	for(U32 i = firstIdx; i < firstIdx + idxCount; i += 3)
+	{
+		const Vec3& v0 = submesh.m_verts[submesh.m_indices[i + 0]].m_position;
+		const Vec3& v1 = submesh.m_verts[submesh.m_indices[i + 1]].m_position;
+		const Vec3& v2 = submesh.m_verts[submesh.m_indices[i + 2]].m_position;
+		const Vec3 n = (v1 - v0).cross(v2 - v0);
+		const F32 len = n.getLength();
+		if(len > EPSILON)
+		{
+			axis += n / len;
+		}
+	}
+
+	meshlet.m_coneAxis = Vec3(0.0f, 0.0f, 1.0f);
+	meshlet.m_coneCutoff = 1.0f;
+
+	const F32 axisLen = axis.getLength();
+	if(axisLen <= EPSILON)
+	{
+		return;
+	}
+
+	axis /= axisLen;
+	F32 minDot = 1.0f;
+	for(U32 i = firstIdx; i < firstIdx + idxCount; i += 3)
+	{
+		const Vec3& v0 = submesh.m_verts[submesh.m_indices[i + 0]].m_position;
+		const Vec3& v1 = submesh.m_verts[submesh.m_indices[i + 1]].m_position;
+		const Vec3& v2 = submesh.m_verts[submesh.m_indices[i + 2]].m_position;
+		const Vec3 n = (v1 - v0).cross(v2 - v0);
+		const F32 len = n.getLength();
+		if(len > EPSILON)
+		{
+			minDot = min(minDot, axis.dot(n / len));
+		}
+	}
+
+	meshlet.m_coneAxis = axis;
+	if(minDot > 0.0f)
+	{
+		// Store the sine of the half angle. If the normals span more than a hemisphere leave the 1.0 that disables
+		// the cone test
+		meshlet.m_coneCutoff = sqrt(1.0f - minDot * minDot);
+	}
+}
+
+/// Split a submesh into meshlets. The triangles are grouped greedily in the order of the index buffer (that is already
+/// optimized for vertex locality) so every meshlet is a contiguous range of indices and the index buffer stays as is.
+static void generateMeshlets(const SubMesh& submesh, DynamicArrayAuto<MeshBinaryFile::Meshlet>& meshlets)
+{
+	ANKI_ASSERT(submesh.m_firstIdx != MAX_U32);
+
+	// Holds the index of the last meshlet that referenced a vertex
+	DynamicArrayAuto<U32> vertMeshlet(meshlets.getAllocator());
+	vertMeshlet.create(submesh.m_verts.getSize(), MAX_U32);
+
+	const U32 triangleCount = submesh.m_indices.getSize() / 3;
+	U32 firstTriangle = 0;
+	U32 vertCount = 0;
+	for(U32 tri = 0; tri <= triangleCount; ++tri)
+	{
+		// Count the vertices that the triangle adds to the current meshlet
+		U32 newVertCount = 0;
+		const U32 meshletIdx = meshlets.getSize();
+		for(U32 i = 0; i < 3 && tri < triangleCount; ++i)
+		{
+			const U32 idx = submesh.m_indices[tri * 3 + i];
+			Bool isNew = vertMeshlet[idx] != meshletIdx;
+			for(U32 j = 0; j < i; ++j)
+			{
+				isNew = isNew && submesh.m_indices[tri * 3 + j] != idx;
+			}
+
+			newVertCount += isNew;
+		}
+
+		const Bool full = vertCount + newVertCount > MeshBinaryFile::MAX_MESHLET_VERTICES
+						  || tri - firstTriangle == MeshBinaryFile::MAX_MESHLET_TRIANGLES;
+		if((full || tri == triangleCount) && tri > firstTriangle)
+		{
+			// Flush
+			MeshBinaryFile::Meshlet& meshlet = *meshlets.emplaceBack();
+			meshlet.m_firstIndex = submesh.m_firstIdx + firstTriangle * 3;
+			meshlet.m_indexCount = (tri - firstTriangle) * 3;
+			computeMeshletBounds(submesh, firstTriangle * 3, meshlet.m_indexCount, meshlet);
+
+			// All the vertices of the triangle are new now since meshlets.getSize() changed
+			firstTriangle = tri;
+			vertCount = 0;
+			newVertCount = 0;
+			for(U32 i = 0; i < 3 && tri < triangleCount; ++i)
+			{
+				const U32 idx = submesh.m_indices[tri * 3 + i];
+				Bool isNew = true;
+				for(U32 j = 0; j < i; ++j)
+				{
+					isNew = isNew && submesh.m_indices[tri * 3 + j] != idx;
+				}
+
+				newVertCount += isNew;
+			}
+		}
+
+		if(tri < triangleCount)
+		{
+			for(U32 i = 0; i < 3; ++i)
+			{
+				vertMeshlet[submesh.m_indices[tri * 3 + i]] = meshlets.getSize();
+			}
+
+			vertCount += newVertCount;
+		}
+	}
+}
+
 U32 GltfImporter::getMeshTotalVertexCount(const cgltf_mesh& mesh)
 {
 	U32 totalVertexCount = 0;
@@ -609,17 +749,35 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		}
 	}
 
+	// Generate the meshlets
+	DynamicArrayAuto<MeshBinaryFile::Meshlet> meshlets(m_alloc);
+	for(const SubMesh& submesh : submeshes)
+	{
+		generateMeshlets(submesh, meshlets);
+	}
+
 	// Chose the formats of the attributes
 	MeshBinaryFile::Header header = {};
 	{
-		// Positions
-		const Vec3 dist3d = aabbMin.abs().max(aabbMax.abs());
-		const F32 maxPositionDistance = max(max(dist3d.x(), dist3d.y()), dist3d.z());
+		// Positions. Quantize them relative to the bounding box no matter the size of the mesh. Skinned meshes are
+		// transformed by the bones in model space so they keep the floats
 		MeshBinaryFile::VertexAttribute& posa = header.m_vertexAttributes[VertexAttributeLocation::POSITION];
 		posa.m_bufferBinding = 0;
-		posa.m_format = (maxPositionDistance < 2.0) ? Format::R16G16B16A16_SFLOAT : Format::R32G32B32_SFLOAT;
 		posa.m_relativeOffset = 0;
-		posa.m_scale = 1.0f;
+		if(!hasBoneWeights)
+		{
+			const Vec3 halfExtend = (aabbMax - aabbMin) / 2.0f;
+			posa.m_format = Format::R16G16B16A16_SNORM;
+			// Meshes with a zero extent (a point for example) need a positive scale to dequantize
+			posa.m_scale = max(max(max(halfExtend.x(), halfExtend.y()), halfExtend.z()), EPSILON);
+		}
+		else
+		{
+			const Vec3 dist3d = aabbMin.abs().max(aabbMax.abs());
+			const F32 maxPositionDistance = max(max(dist3d.x(), dist3d.y()), dist3d.z());
+			posa.m_format = (maxPositionDistance < 2.0) ? Format::R16G16B16A16_SFLOAT : Format::R32G32B32_SFLOAT;
+			posa.m_scale = 1.0f;
+		}
 
 		// Normals
 		MeshBinaryFile::VertexAttribute& na = header.m_vertexAttributes[VertexAttributeLocation::NORMAL];
@@ -674,7 +832,7 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		{
 			header.m_vertexBuffers[0].m_vertexStride = sizeof(F32) * 3;
 		}
-		else if(posa.m_format == Format::R16G16B16A16_SFLOAT)
+		else if(posa.m_format == Format::R16G16B16A16_SFLOAT || posa.m_format == Format::R16G16B16A16_SNORM)
 		{
 			header.m_vertexBuffers[0].m_vertexStride = sizeof(U16) * 4;
 		}
@@ -710,6 +868,7 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		header.m_subMeshCount = U32(submeshes.getSize());
 		header.m_aabbMin = aabbMin;
 		header.m_aabbMax = aabbMax;
+		header.m_meshletCount = meshlets.getSize();
 	}
 
 	// Open file
@@ -731,6 +890,12 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		ANKI_CHECK(file.write(&out, sizeof(out)));
 	}
 
+	// Write meshlets
+	if(meshlets.getSize())
+	{
+		ANKI_CHECK(file.write(&meshlets[0], meshlets.getSizeInBytes()));
+	}
+
 	// Write indices
 	for(const SubMesh& submesh : submeshes)
 	{
@@ -780,6 +945,24 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 
 			ANKI_CHECK(file.write(&pos16[0], pos16.getSizeInBytes()));
 		}
+		else if(posa.m_format == Format::R16G16B16A16_SNORM)
+		{
+			const Vec3 center = (aabbMin + aabbMax) / 2.0f;
+			DynamicArrayAuto<I16Vec4> pos16(m_alloc);
+			pos16.create(submesh.m_verts.getSize());
+
+			for(U32 v = 0; v < submesh.m_verts.getSize(); ++v)
+			{
+				const Vec3 norm = (submesh.m_verts[v].m_position - center) / posa.m_scale;
+				for(U32 c = 0; c < 3; ++c)
+				{
+					pos16[v][c] = I16(round(clamp(norm[c], -1.0f, 1.0f) * F32(MAX_I16)));
+				}
+				pos16[v].w() = 0;
+			}
+
+			ANKI_CHECK(file.write(&pos16[0], pos16.getSizeInBytes()));
+		}
 		else
 		{
 			ANKI_ASSERT(0);
@@ -0,0 +1,1258 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/importer/ImageImporter.h>
+#include <anki/resource/ImageTranscoder.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/Math.h>
+
+#if ANKI_COMPILER_GCC_COMPATIBLE
+#	pragma GCC diagnostic push
+#	pragma GCC diagnostic ignored "-Wconversion"
+#endif
+#include <stb/stb_image.h>
+#if ANKI_COMPILER_GCC_COMPATIBLE
+#	pragma GCC diagnostic pop
+#endif
+
+namespace anki
+{
+
+/// Bump it when the output of the importer changes. It invalidates the source hashes of all the existing files.
+static constexpr U32 IMPORTER_VERSION = 2;
+
+/// The encoders work on block rows. Batch a few of them per task to amortize the scheduling.
+static constexpr U32 BLOCK_ROWS_PER_TASK = 8;
+
+namespace
+{
+
+/// A single mip of a single face or layer. Always RGBA8.
+class Surface
+{
+public:
+	U32 m_width = 0;
+	U32 m_height = 0;
+	DynamicArrayAuto<U8> m_pixels;
+
+	Surface(GenericMemoryPoolAllocator<U8> alloc)
+		: m_pixels(alloc)
+	{
+	}
+};
+
+/// All the mips of a single face or layer.
+class Image
+{
+public:
+	DynamicArrayAuto<U8> m_fileData;
+	DynamicArrayAuto<Surface> m_mips;
+	Bool m_hasAlpha = false;
+
+	Image(GenericMemoryPoolAllocator<U8> alloc)
+		: m_fileData(alloc)
+		, m_mips(alloc)
+	{
+	}
+};
+
+class GenerateMipsTask
+{
+public:
+	Image* m_image = nullptr;
+	const ImageImporterConfig* m_config = nullptr;
+	U32 m_mipCount = 0;
+
+	void run();
+};
+
+/// Compresses a 4x4 block of RGBA8 texels.
+using CompressBlockCallback = void (*)(const U8* rgba, U8* out);
+
+class CompressTask
+{
+public:
+	const Surface* m_surface = nullptr;
+	U8* m_out = nullptr;
+	U32 m_firstBlockRow = 0;
+	U32 m_blockRowCount = 0;
+	CompressBlockCallback m_compressBlock = nullptr;
+	U32 m_blockSize = 0;
+	Bool m_opaque = false; ///< Ignore the alpha of the surface.
+
+	void run();
+};
+
+/// Packs the fields of a 128bit block starting from the LSB.
+class BlockBitWriter
+{
+public:
+	Array<U8, 16> m_bytes = {};
+	U32 m_bitOffset = 0;
+
+	void write(U32 value, U32 bitCount)
+	{
+		for(U32 i = 0; i < bitCount; ++i)
+		{
+			setBit(m_bitOffset + i, (value >> i) & 1);
+		}
+
+		m_bitOffset += bitCount;
+	}
+
+	void setBit(U32 bit, U32 value)
+	{
+		ANKI_ASSERT(bit < 128 && value <= 1);
+		m_bytes[bit / 8] = U8(m_bytes[bit / 8] | (value << (bit % 8)));
+	}
+};
+
+class SupercompressTask
+{
+public:
+	ConstWeakArray<U8> m_blocks;
+	DynamicArrayAuto<U8> m_out;
+	Bool m_bc3 = false;
+	Error m_err = Error::NONE;
+
+	SupercompressTask(GenericMemoryPoolAllocator<U8> alloc)
+		: m_out(alloc)
+	{
+	}
+
+	void run()
+	{
+		m_err = compressS3tcZlib(m_blocks, m_bc3, m_out);
+	}
+};
+
+} // end anonymous namespace
+
+static F32 sRgbToLinear(F32 c)
+{
+	return (c <= 0.04045f) ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static F32 linearToSRgb(F32 c)
+{
+	return (c <= 0.0031308f) ? c * 12.92f : 1.055f * pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+static U8 quantizeUnorm8(F32 c)
+{
+	return U8(clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+void GenerateMipsTask::run()
+{
+	const Bool gammaCorrect = m_config->m_sRgbInput && !m_config->m_normalMap;
+	const Bool normal = m_config->m_normalMap;
+
+	// Convert the top mip to linear floats. Normals are stored in [-1, 1]
+	Array<F32, 256> toLinear;
+	for(U32 i = 0; i < 256; ++i)
+	{
+		const F32 c = F32(i) / 255.0f;
+		toLinear[i] = (gammaCorrect) ? sRgbToLinear(c) : ((normal) ? c * 2.0f - 1.0f : c);
+	}
+
+	const Surface& top = m_image->m_mips[0];
+	U32 width = top.m_width;
+	U32 height = top.m_height;
+	DynamicArrayAuto<Vec4> prevLevel(m_image->m_mips.getAllocator());
+	prevLevel.create(width * height);
+	for(U32 i = 0; i < width * height; ++i)
+	{
+		const U8* p = &top.m_pixels[i * 4];
+		prevLevel[i] = Vec4(toLinear[p[0]], toLinear[p[1]], toLinear[p[2]], F32(p[3]) / 255.0f);
+	}
+
+	// Box filter the rest
+	DynamicArrayAuto<Vec4> level(m_image->m_mips.getAllocator());
+	for(U32 mip = 1; mip < m_mipCount; ++mip)
+	{
+		const U32 prevWidth = width;
+		width /= 2;
+		height /= 2;
+
+		level.destroy();
+		level.create(width * height);
+
+		Surface& surf = m_image->m_mips[mip];
+		surf.m_width = width;
+		surf.m_height = height;
+		surf.m_pixels.create(width * height * 4);
+
+		for(U32 y = 0; y < height; ++y)
+		{
+			for(U32 x = 0; x < width; ++x)
+			{
+				const U32 srcIdx = (y * 2) * prevWidth + x * 2;
+				Vec4 c = prevLevel[srcIdx] + prevLevel[srcIdx + 1] + prevLevel[srcIdx + prevWidth]
+						 + prevLevel[srcIdx + prevWidth + 1];
+				c *= 0.25f;
+
+				Vec3 rgb = c.xyz();
+				if(normal)
+				{
+					const F32 len = rgb.getLength();
+					rgb = (len > EPSILON) ? rgb / len : Vec3(0.0f, 0.0f, 1.0f);
+					c = Vec4(rgb, c.w());
+					rgb = rgb * 0.5f + 0.5f;
+				}
+				else if(gammaCorrect)
+				{
+					rgb = Vec3(linearToSRgb(rgb.x()), linearToSRgb(rgb.y()), linearToSRgb(rgb.z()));
+				}
+
+				level[y * width + x] = c;
+
+				U8* out = &surf.m_pixels[(y * width + x) * 4];
+				out[0] = quantizeUnorm8(rgb.x());
+				out[1] = quantizeUnorm8(rgb.y());
+				out[2] = quantizeUnorm8(rgb.z());
+				out[3] = quantizeUnorm8(c.w());
+			}
+		}
+
+		std::swap(prevLevel, level);
+	}
+}
+
+void CompressTask::run()
+{
+	const U32 blockWidth = m_surface->m_width / 4;
+	Array<U8, 16 * 4> block;
+
+	for(U32 by = m_firstBlockRow; by < m_firstBlockRow + m_blockRowCount; ++by)
+	{
+		for(U32 bx = 0; bx < blockWidth; ++bx)
+		{
+			for(U32 row = 0; row < 4; ++row)
+			{
+				const U8* src = &m_surface->m_pixels[((by * 4 + row) * m_surface->m_width + bx * 4) * 4];
+				memcpy(&block[row * 16], src, 16);
+			}
+
+			if(m_opaque)
+			{
+				for(U32 t = 0; t < 16; ++t)
+				{
+					block[t * 4 + 3] = 255;
+				}
+			}
+
+			m_compressBlock(&block[0], m_out + (by * blockWidth + bx) * m_blockSize);
+		}
+	}
+}
+
+static U16 packRgb565(const Vec3& c)
+{
+	const U32 r = U32(clamp(c.x(), 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+	const U32 g = U32(clamp(c.y(), 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+	const U32 b = U32(clamp(c.z(), 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+	return U16((r << 11) | (g << 5) | b);
+}
+
+static Vec3 unpackRgb565(U16 c)
+{
+	const U32 r = (c >> 11) & 31;
+	const U32 g = (c >> 5) & 63;
+	const U32 b = c & 31;
+	return Vec3(F32((r << 3) | (r >> 2)), F32((g << 2) | (g >> 4)), F32((b << 3) | (b >> 2)));
+}
+
+/// Given the endpoints pick the best index for each texel. Returns the squared error.
+static F32 fitBc1Indices(const Array<Vec3, 16>& texels, U16 c0, U16 c1, U32& indices)
+{
+	Array<Vec3, 4> palette;
+	palette[0] = unpackRgb565(c0);
+	palette[1] = unpackRgb565(c1);
+	palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+	palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+
+	indices = 0;
+	F32 error = 0.0f;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		U32 bestIdx = 0;
+		F32 bestDist = MAX_F32;
+		for(U32 p = 0; p < 4; ++p)
+		{
+			const Vec3 diff = texels[i] - palette[p];
+			const F32 dist = diff.dot(diff);
+			if(dist < bestDist)
+			{
+				bestDist = dist;
+				bestIdx = p;
+			}
+		}
+
+		indices |= bestIdx << (i * 2);
+		error += bestDist;
+	}
+
+	return error;
+}
+
+/// Solve for the endpoints that minimize the error of the given indices. Returns false if the system is degenerate.
+static Bool refineBc1Endpoints(const Array<Vec3, 16>& texels, U32 indices, Vec3& a, Vec3& b)
+{
+	static const Array<F32, 4> weights = {{1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f}};
+
+	F32 alpha2 = 0.0f;
+	F32 beta2 = 0.0f;
+	F32 alphaBeta = 0.0f;
+	Vec3 alphaX(0.0f);
+	Vec3 betaX(0.0f);
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const F32 alpha = weights[(indices >> (i * 2)) & 3];
+		const F32 beta = 1.0f - alpha;
+		alpha2 += alpha * alpha;
+		beta2 += beta * beta;
+		alphaBeta += alpha * beta;
+		alphaX += texels[i] * alpha;
+		betaX += texels[i] * beta;
+	}
+
+	const F32 denom = alpha2 * beta2 - alphaBeta * alphaBeta;
+	if(absolute(denom) < EPSILON)
+	{
+		return false;
+	}
+
+	const F32 factor = 1.0f / denom;
+	a = (alphaX * beta2 - betaX * alphaBeta) * factor;
+	b = (betaX * alpha2 - alphaX * alphaBeta) * factor;
+	return true;
+}
+
+void compressBc1Block(const U8* rgba, U8* out)
+{
+	Array<Vec3, 16> texels;
+	Vec3 mean(0.0f);
+	for(U32 i = 0; i < 16; ++i)
+	{
+		texels[i] = Vec3(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2]);
+		mean += texels[i];
+	}
+	mean /= 16.0f;
+
+	// Covariance matrix (symmetric)
+	F32 cov[6] = {};
+	for(const Vec3& t : texels)
+	{
+		const Vec3 d = t - mean;
+		cov[0] += d.x() * d.x();
+		cov[1] += d.x() * d.y();
+		cov[2] += d.x() * d.z();
+		cov[3] += d.y() * d.y();
+		cov[4] += d.y() * d.z();
+		cov[5] += d.z() * d.z();
+	}
+
+	// Principal axis with a few power iterations
+	Vec3 axis(1.0f, 1.0f, 1.0f);
+	for(U32 it = 0; it < 4; ++it)
+	{
+		const Vec3 v(cov[0] * axis.x() + cov[1] * axis.y() + cov[2] * axis.z(),
+					 cov[1] * axis.x() + cov[3] * axis.y() + cov[4] * axis.z(),
+					 cov[2] * axis.x() + cov[4] * axis.y() + cov[5] * axis.z());
+		const F32 len = max(max(absolute(v.x()), absolute(v.y())), absolute(v.z()));
+		if(len < EPSILON)
+		{
+			break;
+		}
+		axis = v / len;
+	}
+
+	// Project to the axis to find the extremes
+	F32 minDot = MAX_F32;
+	F32 maxDot = MIN_F32;
+	Vec3 minColor = mean;
+	Vec3 maxColor = mean;
+	for(const Vec3& t : texels)
+	{
+		const F32 d = t.dot(axis);
+		if(d < minDot)
+		{
+			minDot = d;
+			minColor = t;
+		}
+
+		if(d > maxDot)
+		{
+			maxDot = d;
+			maxColor = t;
+		}
+	}
+
+	U16 c0 = packRgb565(maxColor);
+	U16 c1 = packRgb565(minColor);
+	U32 indices = 0;
+
+	if(c0 == c1)
+	{
+		// Solid block, all texels use the first endpoint
+	}
+	else
+	{
+		if(c0 < c1)
+		{
+			swapValues(c0, c1);
+		}
+
+		F32 error = fitBc1Indices(texels, c0, c1, indices);
+
+		// One round of least squares refinement
+		Vec3 a, b;
+		if(refineBc1Endpoints(texels, indices, a, b))
+		{
+			U16 rc0 = packRgb565(a);
+			U16 rc1 = packRgb565(b);
+			if(rc0 < rc1)
+			{
+				swapValues(rc0, rc1);
+			}
+
+			U32 rindices;
+			if(rc0 != rc1 && fitBc1Indices(texels, rc0, rc1, rindices) < error)
+			{
+				c0 = rc0;
+				c1 = rc1;
+				indices = rindices;
+			}
+		}
+	}
+
+	memcpy(out, &c0, 2);
+	memcpy(out + 2, &c1, 2);
+	memcpy(out + 4, &indices, 4);
+}
+
+/// Compress one channel of a 4x4 block of RGBA8 texels to a BC4 block. It's also the alpha block of BC3.
+static void compressBc4Channel(const U8* rgba, U32 channel, U8* out)
+{
+	U8 v0 = 0;
+	U8 v1 = 255;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		v0 = max(v0, rgba[i * 4 + channel]);
+		v1 = min(v1, rgba[i * 4 + channel]);
+	}
+
+	U64 indices = 0;
+	if(v0 != v1)
+	{
+		// 8 value mode because v0 > v1
+		Array<I32, 8> palette;
+		palette[0] = v0;
+		palette[1] = v1;
+		for(I32 i = 2; i < 8; ++i)
+		{
+			palette[i] = ((8 - i) * v0 + (i - 1) * v1) / 7;
+		}
+
+		for(U32 i = 0; i < 16; ++i)
+		{
+			const I32 v = rgba[i * 4 + channel];
+			U64 bestIdx = 0;
+			I32 bestDist = MAX_I32;
+			for(U32 p = 0; p < 8; ++p)
+			{
+				const I32 dist = absolute(v - palette[p]);
+				if(dist < bestDist)
+				{
+					bestDist = dist;
+					bestIdx = p;
+				}
+			}
+
+			indices |= bestIdx << (i * 3);
+		}
+	}
+
+	out[0] = v0;
+	out[1] = v1;
+	memcpy(out + 2, &indices, 6); // Little endian, take the lower 48 bits
+}
+
+void compressBc3Block(const U8* rgba, U8* out)
+{
+	compressBc4Channel(rgba, 3, out);
+	compressBc1Block(rgba, out + 8);
+}
+
+void compressBc4Block(const U8* rgba, U8* out)
+{
+	compressBc4Channel(rgba, 0, out);
+}
+
+void compressBc5Block(const U8* rgba, U8* out)
+{
+	compressBc4Channel(rgba, 0, out);
+	compressBc4Channel(rgba, 1, out + 8);
+}
+
+/// Find the extremes of the texels along their principal axis. Works for RGB and RGBA since a constant alpha doesn't
+/// contribute to the axis.
+static void computePrincipalAxisExtremes(const Array<Vec4, 16>& texels, Vec4& minColor, Vec4& maxColor)
+{
+	Vec4 mean(0.0f);
+	for(const Vec4& t : texels)
+	{
+		mean += t;
+	}
+	mean /= 16.0f;
+
+	// Covariance matrix
+	Array2d<F32, 4, 4> cov = {};
+	for(const Vec4& t : texels)
+	{
+		const Vec4 d = t - mean;
+		for(U32 r = 0; r < 4; ++r)
+		{
+			for(U32 c = 0; c < 4; ++c)
+			{
+				cov[r][c] += d[r] * d[c];
+			}
+		}
+	}
+
+	// Principal axis with a few power iterations
+	Vec4 axis(1.0f);
+	for(U32 it = 0; it < 4; ++it)
+	{
+		Vec4 v(0.0f);
+		for(U32 r = 0; r < 4; ++r)
+		{
+			for(U32 c = 0; c < 4; ++c)
+			{
+				v[r] += cov[r][c] * axis[c];
+			}
+		}
+
+		const F32 len = max(max(absolute(v.x()), absolute(v.y())), max(absolute(v.z()), absolute(v.w())));
+		if(len < EPSILON)
+		{
+			break;
+		}
+		axis = v / len;
+	}
+
+	// Project to the axis to find the extremes
+	F32 minDot = MAX_F32;
+	F32 maxDot = MIN_F32;
+	for(const Vec4& t : texels)
+	{
+		const F32 d = (t - mean).dot(axis);
+		minDot = min(minDot, d);
+		maxDot = max(maxDot, d);
+	}
+
+	const F32 axisLengthSquared = axis.dot(axis);
+	minColor = mean + axis * (minDot / axisLengthSquared);
+	maxColor = mean + axis * (maxDot / axisLengthSquared);
+}
+
+/// Given two endpoints and the interpolation weights (in [0, 64]) pick the best weight for each texel. Returns the
+/// squared error.
+static F32 fitInterpolationIndices(const Array<Vec4, 16>& texels, const Vec4& e0, const Vec4& e1,
+								   ConstWeakArray<U32> weights, Array<U8, 16>& indices)
+{
+	Array<Vec4, 16> palette;
+	for(U32 i = 0; i < weights.getSize(); ++i)
+	{
+		for(U32 c = 0; c < 4; ++c)
+		{
+			palette[i][c] = F32((U32(e0[c]) * (64 - weights[i]) + U32(e1[c]) * weights[i] + 32) >> 6);
+		}
+	}
+
+	F32 error = 0.0f;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		U32 bestIdx = 0;
+		F32 bestDist = MAX_F32;
+		for(U32 p = 0; p < weights.getSize(); ++p)
+		{
+			const Vec4 diff = texels[i] - palette[p];
+			const F32 dist = diff.dot(diff);
+			if(dist < bestDist)
+			{
+				bestDist = dist;
+				bestIdx = p;
+			}
+		}
+
+		indices[i] = U8(bestIdx);
+		error += bestDist;
+	}
+
+	return error;
+}
+
+/// Solve for the endpoints that minimize the error of the given indices. Returns false if the system is degenerate.
+static Bool refineInterpolationEndpoints(const Array<Vec4, 16>& texels, ConstWeakArray<U32> weights,
+										 const Array<U8, 16>& indices, Vec4& e0, Vec4& e1)
+{
+	F32 alpha2 = 0.0f;
+	F32 beta2 = 0.0f;
+	F32 alphaBeta = 0.0f;
+	Vec4 alphaX(0.0f);
+	Vec4 betaX(0.0f);
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const F32 beta = F32(weights[indices[i]]) / 64.0f;
+		const F32 alpha = 1.0f - beta;
+		alpha2 += alpha * alpha;
+		beta2 += beta * beta;
+		alphaBeta += alpha * beta;
+		alphaX += texels[i] * alpha;
+		betaX += texels[i] * beta;
+	}
+
+	const F32 denom = alpha2 * beta2 - alphaBeta * alphaBeta;
+	if(absolute(denom) < EPSILON)
+	{
+		return false;
+	}
+
+	const F32 factor = 1.0f / denom;
+	e0 = (alphaX * beta2 - betaX * alphaBeta) * factor;
+	e1 = (betaX * alpha2 - alphaX * alphaBeta) * factor;
+	return true;
+}
+
+/// The interpolation weights of the 4bit BC7 indices.
+static const Array<U32, 16> BC7_WEIGHTS = {{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64}};
+
+/// Quantize an endpoint to the 7bit channels and the p-bit of BC7 mode 6. Returns the unquantized endpoint.
+static Vec4 quantizeBc7Endpoint(const Vec4& color, UVec4& quantized, U32& pbit)
+{
+	F32 bestError = MAX_F32;
+	Vec4 best(0.0f);
+	for(U32 p = 0; p < 2; ++p)
+	{
+		UVec4 q;
+		Vec4 unquantized;
+		F32 error = 0.0f;
+		for(U32 c = 0; c < 4; ++c)
+		{
+			q[c] = U32(clamp((color[c] - F32(p)) / 2.0f + 0.5f, 0.0f, 127.0f));
+			unquantized[c] = F32((q[c] << 1) | p);
+			error += (unquantized[c] - color[c]) * (unquantized[c] - color[c]);
+		}
+
+		if(error < bestError)
+		{
+			bestError = error;
+			best = unquantized;
+			quantized = q;
+			pbit = p;
+		}
+	}
+
+	return best;
+}
+
+void compressBc7Block(const U8* rgba, U8* out)
+{
+	Array<Vec4, 16> texels;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		texels[i] = Vec4(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]);
+	}
+
+	Vec4 minColor, maxColor;
+	computePrincipalAxisExtremes(texels, minColor, maxColor);
+
+	Array<UVec4, 2> endpoints;
+	Array<U32, 2> pbits;
+	Vec4 e0 = quantizeBc7Endpoint(minColor, endpoints[0], pbits[0]);
+	Vec4 e1 = quantizeBc7Endpoint(maxColor, endpoints[1], pbits[1]);
+	Array<U8, 16> indices;
+	const F32 error = fitInterpolationIndices(texels, e0, e1, BC7_WEIGHTS, indices);
+
+	// One round of least squares refinement
+	Vec4 a, b;
+	if(refineInterpolationEndpoints(texels, BC7_WEIGHTS, indices, a, b))
+	{
+		Array<UVec4, 2> rendpoints;
+		Array<U32, 2> rpbits;
+		e0 = quantizeBc7Endpoint(a, rendpoints[0], rpbits[0]);
+		e1 = quantizeBc7Endpoint(b, rendpoints[1], rpbits[1]);
+
+		Array<U8, 16> rindices;
+		if(fitInterpolationIndices(texels, e0, e1, BC7_WEIGHTS, rindices) < error)
+		{
+			endpoints = rendpoints;
+			pbits = rpbits;
+			indices = rindices;
+		}
+	}
+
+	// The MSB of the index of the 1st texel is implicitly zero. The weights are symmetric so swap the endpoints
+	if(indices[0] >= 8)
+	{
+		swapValues(endpoints[0], endpoints[1]);
+		swapValues(pbits[0], pbits[1]);
+		for(U8& idx : indices)
+		{
+			idx = U8(15 - idx);
+		}
+	}
+
+	BlockBitWriter writer;
+	writer.write(1 << 6, 7); // Mode 6
+	for(U32 c = 0; c < 4; ++c)
+	{
+		writer.write(endpoints[0][c], 7);
+		writer.write(endpoints[1][c], 7);
+	}
+	writer.write(pbits[0], 1);
+	writer.write(pbits[1], 1);
+	writer.write(indices[0], 3);
+	for(U32 i = 1; i < 16; ++i)
+	{
+		writer.write(indices[i], 4);
+	}
+	ANKI_ASSERT(writer.m_bitOffset == 128);
+
+	memcpy(out, &writer.m_bytes[0], 16);
+}
+
+/// The unquantized 3bit and 2bit ASTC weights.
+static const Array<U32, 8> ASTC_WEIGHTS_3BIT = {{0, 9, 18, 27, 37, 46, 55, 64}};
+static const Array<U32, 4> ASTC_WEIGHTS_2BIT = {{0, 21, 43, 64}};
+
+/// Round an endpoint to 8bit channels.
+static Vec4 quantizeAstcEndpoint(const Vec4& color)
+{
+	Vec4 out;
+	for(U32 c = 0; c < 4; ++c)
+	{
+		out[c] = F32(quantizeUnorm8(color[c] / 255.0f));
+	}
+
+	return out;
+}
+
+void compressAstcBlock(const U8* rgba, U8* out)
+{
+	Array<Vec4, 16> texels;
+	Bool opaque = true;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		texels[i] = Vec4(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]);
+		opaque = opaque && rgba[i * 4 + 3] == 255;
+	}
+
+	// Opaque blocks have 3 endpoint channels so they can afford more weight bits. Both fit 8bit endpoints
+	const ConstWeakArray<U32> weights =
+		(opaque) ? ConstWeakArray<U32>(ASTC_WEIGHTS_3BIT) : ConstWeakArray<U32>(ASTC_WEIGHTS_2BIT);
+	const U32 weightBitCount = (opaque) ? 3 : 2;
+	const U32 channelCount = (opaque) ? 3 : 4;
+
+	Vec4 minColor, maxColor;
+	computePrincipalAxisExtremes(texels, minColor, maxColor);
+
+	Array<Vec4, 2> endpoints = {{quantizeAstcEndpoint(minColor), quantizeAstcEndpoint(maxColor)}};
+	Array<U8, 16> indices;
+	const F32 error = fitInterpolationIndices(texels, endpoints[0], endpoints[1], weights, indices);
+
+	// One round of least squares refinement
+	Vec4 a, b;
+	if(refineInterpolationEndpoints(texels, weights, indices, a, b))
+	{
+		const Array<Vec4, 2> rendpoints = {{quantizeAstcEndpoint(a), quantizeAstcEndpoint(b)}};
+		Array<U8, 16> rindices;
+		if(fitInterpolationIndices(texels, rendpoints[0], rendpoints[1], weights, rindices) < error)
+		{
+			endpoints = rendpoints;
+			indices = rindices;
+		}
+	}
+
+	// If the 2nd endpoint is darker the decoder swaps the endpoints and applies blue contraction. Avoid that by
+	// swapping them here. The weights are symmetric
+	if(endpoints[1].x() + endpoints[1].y() + endpoints[1].z() < endpoints[0].x() + endpoints[0].y() + endpoints[0].z())
+	{
+		swapValues(endpoints[0], endpoints[1]);
+		for(U8& idx : indices)
+		{
+			idx = U8(weights.getSize() - 1 - idx);
+		}
+	}
+
+	BlockBitWriter writer;
+	writer.write((opaque) ? 0x53 : 0x42, 11); // Block mode: 4x4 weights of 3 or 2 bits, single plane
+	writer.write(0, 2); // Partition count minus one
+	writer.write((opaque) ? 8 : 12, 4); // Color endpoint mode: LDR RGB or RGBA direct
+	for(U32 c = 0; c < channelCount; ++c)
+	{
+		writer.write(U32(endpoints[0][c]), 8);
+		writer.write(U32(endpoints[1][c]), 8);
+	}
+
+	// The weights are stored bit reversed starting from the top of the block
+	ANKI_ASSERT(writer.m_bitOffset <= 128 - 16 * weightBitCount);
+	for(U32 i = 0; i < 16; ++i)
+	{
+		for(U32 bit = 0; bit < weightBitCount; ++bit)
+		{
+			writer.setBit(127 - (i * weightBitCount + bit), (indices[i] >> bit) & 1);
+		}
+	}
+
+	memcpy(out, &writer.m_bytes[0], 16);
+}
+
+static Error readSourceImage(CString filename, Image& image)
+{
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+	if(file.getSize() == 0)
+	{
+		ANKI_IMPORTER_LOGE("Empty image: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	image.m_fileData.create(U32(file.getSize()));
+	ANKI_CHECK(file.read(&image.m_fileData[0], image.m_fileData.getSize()));
+	return Error::NONE;
+}
+
+static Error decodeSourceImage(CString filename, Image& image, U32& width, U32& height)
+{
+	int stbw, stbh, comp;
+	U8* stbdata = stbi_load_from_memory(&image.m_fileData[0], I32(image.m_fileData.getSize()), &stbw, &stbh, &comp, 4);
+	if(!stbdata)
+	{
+		ANKI_IMPORTER_LOGE("STB failed to read image: %s", filename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	width = U32(stbw);
+	height = U32(stbh);
+	image.m_hasAlpha = comp == 2 || comp == 4;
+
+	Surface& surf = *image.m_mips.emplaceBack(image.m_mips.getAllocator());
+	surf.m_width = width;
+	surf.m_height = height;
+	surf.m_pixels.create(width * height * 4);
+	memcpy(&surf.m_pixels[0], stbdata, surf.m_pixels.getSize());
+
+	stbi_image_free(stbdata);
+	return Error::NONE;
+}
+
+static U64 computeSourceHash(const ImageImporterConfig& config, const DynamicArrayAuto<Image>& images)
+{
+	const U32 options[] = {IMPORTER_VERSION,
+						   U32(config.m_type),
+						   U32(config.m_compressions),
+						   U32(config.m_colorFormat),
+						   config.m_mipmapCount,
+						   config.m_noAlpha,
+						   config.m_normalMap,
+						   config.m_sRgbInput};
+	U64 hash = computeHash(&options[0], sizeof(options));
+
+	for(const Image& image : images)
+	{
+		hash = appendHash(&image.m_fileData[0], image.m_fileData.getSizeInBytes(), hash);
+	}
+
+	return hash;
+}
+
+static Bool isOutputUpToDate(CString filename, U64 sourceHash)
+{
+	if(!fileExists(filename))
+	{
+		return false;
+	}
+
+	File file;
+	AnkiTextureHeader header;
+	if(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY) || file.read(&header, sizeof(header)))
+	{
+		return false;
+	}
+
+	return std::memcmp(&header.m_magic[0], "ANKITEX1", 8) == 0 && header.m_sourceHash == sourceHash;
+}
+
+/// Run the tasks in the hive or in this thread if there is no hive.
+template<typename TTask>
+static void runTasks(ThreadHive* hive, WeakArray<TTask> tasks, GenericMemoryPoolAllocator<U8> alloc)
+{
+	if(tasks.getSize() == 0)
+	{
+		return;
+	}
+
+	if(!hive)
+	{
+		for(TTask& task : tasks)
+		{
+			task.run();
+		}
+		return;
+	}
+
+	DynamicArrayAuto<ThreadHiveTask> hiveTasks(alloc, tasks.getSize());
+	for(U32 i = 0; i < tasks.getSize(); ++i)
+	{
+		hiveTasks[i] = ANKI_THREAD_HIVE_TASK({ self->run(); }, &tasks[i], nullptr, nullptr);
+	}
+
+	hive->submitTasks(&hiveTasks[0], hiveTasks.getSize());
+	hive->waitAllTasks();
+}
+
+/// Compress all the surfaces to a segment that is laid out as [mip][face or layer].
+static void compressSegment(const ImageImporterConfig& config, const DynamicArrayAuto<Image>& images, U32 mipCount,
+							CompressBlockCallback compressBlock, U32 blockSize, Bool opaque,
+							DynamicArrayAuto<U8>& segment)
+{
+	GenericMemoryPoolAllocator<U8> alloc = config.m_allocator;
+
+	PtrSize segmentSize = 0;
+	for(U32 mip = 0; mip < mipCount; ++mip)
+	{
+		const Surface& surf = images[0].m_mips[mip];
+		segmentSize += PtrSize(surf.m_width / 4) * (surf.m_height / 4) * blockSize * images.getSize();
+	}
+	segment.create(U32(segmentSize));
+
+	DynamicArrayAuto<CompressTask> compressTasks(alloc);
+	PtrSize offset = 0;
+	for(U32 mip = 0; mip < mipCount; ++mip)
+	{
+		for(const Image& image : images)
+		{
+			const Surface& surf = image.m_mips[mip];
+			const U32 blockRowCount = surf.m_height / 4;
+			for(U32 row = 0; row < blockRowCount; row += BLOCK_ROWS_PER_TASK)
+			{
+				CompressTask& task = *compressTasks.emplaceBack();
+				task.m_surface = &surf;
+				task.m_out = &segment[U32(offset)];
+				task.m_firstBlockRow = row;
+				task.m_blockRowCount = min(BLOCK_ROWS_PER_TASK, blockRowCount - row);
+				task.m_compressBlock = compressBlock;
+				task.m_blockSize = blockSize;
+				task.m_opaque = opaque;
+			}
+
+			offset += PtrSize(surf.m_width / 4) * (surf.m_height / 4) * blockSize;
+		}
+	}
+	ANKI_ASSERT(offset == segmentSize);
+
+	runTasks(config.m_hive, WeakArray<CompressTask>(compressTasks), alloc);
+}
+
+Error importImage(const ImageImporterConfig& config)
+{
+	GenericMemoryPoolAllocator<U8> alloc = config.m_allocator;
+	const U32 imageCount = config.m_inputFilenames.getSize();
+	HighRezTimer timer;
+	timer.start();
+
+	// Validate the config
+	if(config.m_type == ImageLoaderTextureType::_3D)
+	{
+		ANKI_IMPORTER_LOGE("3D textures are not supported");
+		return Error::USER_DATA;
+	}
+
+	if((config.m_type == ImageLoaderTextureType::_2D && imageCount != 1)
+	   || (config.m_type == ImageLoaderTextureType::CUBE && imageCount != 6)
+	   || (config.m_type == ImageLoaderTextureType::_2D_ARRAY && imageCount < 1))
+	{
+		ANKI_IMPORTER_LOGE("Wrong number of input images for the texture type: %u", imageCount);
+		return Error::USER_DATA;
+	}
+
+	const ImageLoaderDataCompression supportedCompressions =
+		ImageLoaderDataCompression::RAW | ImageLoaderDataCompression::S3TC | ImageLoaderDataCompression::S3TC_ZLIB
+		| ImageLoaderDataCompression::BC7 | ImageLoaderDataCompression::ASTC;
+	if(!!(config.m_compressions & ~supportedCompressions) || !(config.m_compressions & supportedCompressions))
+	{
+		ANKI_IMPORTER_LOGE("Only RAW, S3TC, S3TC_ZLIB, BC7 and ASTC compressions are supported");
+		return Error::USER_DATA;
+	}
+
+	if(config.m_colorFormat > ImageLoaderColorFormat::RG8)
+	{
+		ANKI_IMPORTER_LOGE("Wrong color format");
+		return Error::USER_DATA;
+	}
+
+	if((config.m_colorFormat == ImageLoaderColorFormat::R8 || config.m_colorFormat == ImageLoaderColorFormat::RG8)
+	   && !!(config.m_compressions
+			 & (ImageLoaderDataCompression::S3TC_ZLIB | ImageLoaderDataCompression::BC7
+				| ImageLoaderDataCompression::ASTC)))
+	{
+		ANKI_IMPORTER_LOGE("S3TC_ZLIB, BC7 and ASTC compressions are only supported for RGB and RGBA images");
+		return Error::USER_DATA;
+	}
+
+	// Read the sources and check the cache before decoding anything
+	DynamicArrayAuto<Image> images(alloc);
+	for(U32 i = 0; i < imageCount; ++i)
+	{
+		ANKI_CHECK(readSourceImage(config.m_inputFilenames[i], *images.emplaceBack(alloc)));
+	}
+
+	const U64 sourceHash = computeSourceHash(config, images);
+	if(!config.m_ignoreCache && isOutputUpToDate(config.m_outFilename, sourceHash))
+	{
+		ANKI_IMPORTER_LOGI("Skipping up-to-date image: %s", config.m_outFilename.cstr());
+		return Error::NONE;
+	}
+
+	// Decode the sources
+	U32 width = 0;
+	U32 height = 0;
+	Bool hasAlpha = false;
+	for(U32 i = 0; i < imageCount; ++i)
+	{
+		U32 w, h;
+		ANKI_CHECK(decodeSourceImage(config.m_inputFilenames[i], images[i], w, h));
+
+		if(i == 0)
+		{
+			width = w;
+			height = h;
+		}
+		else if(w != width || h != height)
+		{
+			ANKI_IMPORTER_LOGE("Images don't have the same size: %s", config.m_inputFilenames[i].cstr());
+			return Error::USER_DATA;
+		}
+
+		hasAlpha = hasAlpha || images[i].m_hasAlpha;
+	}
+
+	if(!isPowerOfTwo(width) || !isPowerOfTwo(height) || width < 4 || height < 4 || width > 4096 || height > 4096)
+	{
+		ANKI_IMPORTER_LOGE("Image width and height should be power of 2 in [4, 4096]");
+		return Error::USER_DATA;
+	}
+
+	ImageLoaderColorFormat colorFormat = config.m_colorFormat;
+	if(colorFormat == ImageLoaderColorFormat::NONE)
+	{
+		colorFormat = (hasAlpha && !config.m_noAlpha) ? ImageLoaderColorFormat::RGBA8 : ImageLoaderColorFormat::RGB8;
+	}
+
+	if(colorFormat == ImageLoaderColorFormat::RGBA8 && config.m_normalMap)
+	{
+		ANKI_IMPORTER_LOGE("RGBA images can't be normal maps");
+		return Error::USER_DATA;
+	}
+
+	// Generate the mips
+	U32 mipCount = 0;
+	for(U32 w = width, h = height; w >= 4 && h >= 4 && mipCount < config.m_mipmapCount; w /= 2, h /= 2)
+	{
+		++mipCount;
+	}
+
+	DynamicArrayAuto<GenerateMipsTask> mipTasks(alloc, imageCount);
+	for(U32 i = 0; i < imageCount; ++i)
+	{
+		for(U32 mip = 1; mip < mipCount; ++mip)
+		{
+			images[i].m_mips.emplaceBack(alloc);
+		}
+
+		mipTasks[i].m_image = &images[i];
+		mipTasks[i].m_config = &config;
+		mipTasks[i].m_mipCount = mipCount;
+	}
+
+	runTasks(config.m_hive, WeakArray<GenerateMipsTask>(mipTasks), alloc);
+
+	// Compress
+	const Bool opaque = colorFormat != ImageLoaderColorFormat::RGBA8;
+	const Bool bc3 = colorFormat == ImageLoaderColorFormat::RGBA8;
+	DynamicArrayAuto<U8> s3tcSegment(alloc);
+	if(!!(config.m_compressions & (ImageLoaderDataCompression::S3TC | ImageLoaderDataCompression::S3TC_ZLIB)))
+	{
+		CompressBlockCallback compressBlock;
+		U32 blockSize;
+		switch(colorFormat)
+		{
+		case ImageLoaderColorFormat::RGB8:
+			compressBlock = compressBc1Block;
+			blockSize = 8;
+			break;
+		case ImageLoaderColorFormat::RGBA8:
+			compressBlock = compressBc3Block;
+			blockSize = 16;
+			break;
+		case ImageLoaderColorFormat::R8:
+			compressBlock = compressBc4Block;
+			blockSize = 8;
+			break;
+		default:
+			ANKI_ASSERT(colorFormat == ImageLoaderColorFormat::RG8);
+			compressBlock = compressBc5Block;
+			blockSize = 16;
+		}
+
+		compressSegment(config, images, mipCount, compressBlock, blockSize, opaque, s3tcSegment);
+	}
+
+	DynamicArrayAuto<U8> bc7Segment(alloc);
+	if(!!(config.m_compressions & ImageLoaderDataCompression::BC7))
+	{
+		compressSegment(config, images, mipCount, compressBc7Block, 16, opaque, bc7Segment);
+	}
+
+	DynamicArrayAuto<U8> astcSegment(alloc);
+	if(!!(config.m_compressions & ImageLoaderDataCompression::ASTC))
+	{
+		compressSegment(config, images, mipCount, compressAstcBlock, 16, opaque, astcSegment);
+	}
+
+	// Supercompress every surface of the S3TC segment
+	DynamicArrayAuto<SupercompressTask> supercompressTasks(alloc);
+	if(!!(config.m_compressions & ImageLoaderDataCompression::S3TC_ZLIB))
+	{
+		const U32 blockSize = (bc3) ? 16 : 8;
+		PtrSize offset = 0;
+		for(U32 mip = 0; mip < mipCount; ++mip)
+		{
+			for(U32 i = 0; i < imageCount; ++i)
+			{
+				const Surface& surf = images[i].m_mips[mip];
+				const U32 surfSize = (surf.m_width / 4) * (surf.m_height / 4) * blockSize;
+
+				SupercompressTask& task = *supercompressTasks.emplaceBack(alloc);
+				task.m_blocks = ConstWeakArray<U8>(&s3tcSegment[U32(offset)], surfSize);
+				task.m_bc3 = bc3;
+
+				offset += surfSize;
+			}
+		}
+
+		runTasks(config.m_hive, WeakArray<SupercompressTask>(supercompressTasks), alloc);
+
+		for(const SupercompressTask& task : supercompressTasks)
+		{
+			ANKI_CHECK(task.m_err);
+		}
+	}
+
+	// Write the file. The segments go in the order of ANKITEX_SEGMENT_ORDER
+	File file;
+	ANKI_CHECK(file.open(config.m_outFilename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	AnkiTextureHeader header;
+	zeroMemory(header);
+	memcpy(&header.m_magic[0], "ANKITEX1", 8);
+	header.m_width = width;
+	header.m_height = height;
+	header.m_depthOrLayerCount = imageCount;
+	header.m_type = config.m_type;
+	header.m_colorFormat = colorFormat;
+	header.m_compressionFormats = config.m_compressions;
+	header.m_normal = config.m_normalMap;
+	header.m_mipCount = mipCount;
+	header.m_sourceHash = sourceHash;
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	if(!!(config.m_compressions & ImageLoaderDataCompression::RAW))
+	{
+		U32 channelCount;
+		switch(colorFormat)
+		{
+		case ImageLoaderColorFormat::R8:
+			channelCount = 1;
+			break;
+		case ImageLoaderColorFormat::RG8:
+			channelCount = 2;
+			break;
+		case ImageLoaderColorFormat::RGB8:
+			channelCount = 3;
+			break;
+		default:
+			channelCount = 4;
+		}
+
+		DynamicArrayAuto<U8> texels(alloc);
+		for(U32 mip = 0; mip < mipCount; ++mip)
+		{
+			for(U32 i = 0; i < imageCount; ++i)
+			{
+				const Surface& surf = images[i].m_mips[mip];
+				if(channelCount == 4)
+				{
+					ANKI_CHECK(file.write(&surf.m_pixels[0], surf.m_pixels.getSizeInBytes()));
+				}
+				else
+				{
+					const U32 texelCount = surf.m_width * surf.m_height;
+					texels.resize(texelCount * channelCount);
+					for(U32 t = 0; t < texelCount; ++t)
+					{
+						memcpy(&texels[t * channelCount], &surf.m_pixels[t * 4], channelCount);
+					}
+
+					ANKI_CHECK(file.write(&texels[0], texelCount * channelCount));
+				}
+			}
+		}
+	}
+
+	if(!!(config.m_compressions & ImageLoaderDataCompression::S3TC))
+	{
+		ANKI_CHECK(file.write(&s3tcSegment[0], s3tcSegment.getSizeInBytes()));
+	}
+
+	if(!!(config.m_compressions & ImageLoaderDataCompression::BC7))
+	{
+		ANKI_CHECK(file.write(&bc7Segment[0], bc7Segment.getSizeInBytes()));
+	}
+
+	if(!!(config.m_compressions & ImageLoaderDataCompression::ASTC))
+	{
+		ANKI_CHECK(file.write(&astcSegment[0], astcSegment.getSizeInBytes()));
+	}
+
+	PtrSize supercompressedSize = 0;
+	for(const SupercompressTask& task : supercompressTasks)
+	{
+		const U32 size = task.m_out.getSize();
+		ANKI_CHECK(file.write(&size, sizeof(size)));
+		ANKI_CHECK(file.write(&task.m_out[0], size));
+		supercompressedSize += size + sizeof(size);
+	}
+
+	if(supercompressedSize)
+	{
+		ANKI_IMPORTER_LOGI("S3TC_ZLIB segment is %f%% of the S3TC one",
+						   F64(supercompressedSize) / F64(s3tcSegment.getSizeInBytes()) * 100.0);
+	}
+
+	timer.stop();
+	ANKI_IMPORTER_LOGI("Imported %s (%ux%u, %u mips) in %fms", config.m_outFilename.cstr(), width, height, mipCount,
+					   timer.getElapsedTime() * 1000.0);
+
+	return Error::NONE;
+}
+
+} // end namespace anki
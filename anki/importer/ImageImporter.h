@@ -0,0 +1,71 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/ImageLoader.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+// Forward
+class ThreadHive;
+
+/// @addtogroup importer
+/// @{
+
+#define ANKI_IMPORTER_LOGI(...) ANKI_LOG("IMPR", NORMAL, __VA_ARGS__)
+#define ANKI_IMPORTER_LOGE(...) ANKI_LOG("IMPR", ERROR, __VA_ARGS__)
+#define ANKI_IMPORTER_LOGW(...) ANKI_LOG("IMPR", WARNING, __VA_ARGS__)
+#define ANKI_IMPORTER_LOGF(...) ANKI_LOG("IMPR", FATAL, __VA_ARGS__)
+
+/// @memberof importImage
+class ImageImporterConfig
+{
+public:
+	GenericMemoryPoolAllocator<U8> m_allocator;
+	ConstWeakArray<CString> m_inputFilenames; ///< One for 2D, 6 for cubes, N for arrays.
+	CString m_outFilename;
+	ImageLoaderTextureType m_type = ImageLoaderTextureType::_2D;
+	/// Any combination of RAW, S3TC, S3TC_ZLIB, BC7 and ASTC.
+	ImageLoaderDataCompression m_compressions = ImageLoaderDataCompression::S3TC;
+	/// The channels to store. If NONE it's RGB8 or RGBA8 depending on the alpha of the sources.
+	ImageLoaderColorFormat m_colorFormat = ImageLoaderColorFormat::NONE;
+	U32 m_mipmapCount = MAX_U32;
+	Bool m_noAlpha = false;
+	Bool m_normalMap = false; ///< Filter the mips as unit vectors. It also sets the normal flag of the header.
+	Bool m_sRgbInput = true; ///< If true the mips will be filtered in linear space.
+	Bool m_ignoreCache = false; ///< If false skip the import if the output was produced by the same input and options.
+	ThreadHive* m_hive = nullptr; ///< Optional. If not present it will run single threaded.
+};
+
+/// Converts a number of images to an .ankitex. It generates the mip chain, compresses the surfaces to S3TC (BC1 for
+/// RGB, BC3 for RGBA, BC4 for R and BC5 for RG), BC7 and/or ASTC 4x4, optionally supercompresses the S3TC blocks and
+/// stores a hash of the sources in the header. If an up-to-date output already exists the import is skipped before
+/// decoding any image.
+ANKI_USE_RESULT Error importImage(const ImageImporterConfig& config);
+
+/// Compress a 4x4 block of RGBA8 texels to BC1. Alpha is ignored.
+void compressBc1Block(const U8* rgba, U8* out);
+
+/// Compress a 4x4 block of RGBA8 texels to BC3.
+void compressBc3Block(const U8* rgba, U8* out);
+
+/// Compress the red channel of a 4x4 block of RGBA8 texels to BC4.
+void compressBc4Block(const U8* rgba, U8* out);
+
+/// Compress the red and green channels of a 4x4 block of RGBA8 texels to BC5.
+void compressBc5Block(const U8* rgba, U8* out);
+
+/// Compress a 4x4 block of RGBA8 texels to BC7. It only uses mode 6 (one RGBA subset with 4bit indices).
+void compressBc7Block(const U8* rgba, U8* out);
+
+/// Compress a 4x4 block of RGBA8 texels to ASTC 4x4 LDR. It uses a single partition with direct RGB endpoints and 3bit
+/// weights if the block is opaque or direct RGBA endpoints and 2bit weights if it's not.
+void compressAstcBlock(const U8* rgba, U8* out);
+/// @}
+
+} // end namespace anki
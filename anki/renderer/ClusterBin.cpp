@@ -39,6 +39,37 @@ static Bool insideClusterFrustum(const Array<Plane, 4>& planeArr, const TShape&
 	return true;
 }
 
+/// Allocate memory for the results. Without a staging memory manager (e.g. benchmarks) it falls back to CPU memory.
+static void* allocateFrame(ClusterBinIn& in, PtrSize size, StagingGpuMemoryType type, StagingGpuMemoryToken& token)
+{
+	if(in.m_stagingMem)
+	{
+		return in.m_stagingMem->allocateFrame(size, type, token);
+	}
+
+	token.markUnused();
+	return in.m_tempAlloc.allocate(size);
+}
+
+/// The clusters an object may touch. The ranges are inclusive.
+class ClusterBin::ObjectRange
+{
+public:
+	Array<U16, 3> m_min;
+	Array<U16, 3> m_max;
+
+	void setEmpty()
+	{
+		m_min = {1, 1, 1};
+		m_max = {0, 0, 0};
+	}
+
+	Bool isEmpty() const
+	{
+		return m_min[0] > m_max[0];
+	}
+};
+
 /// Bin context.
 class ClusterBin::BinCtx
 {
@@ -61,6 +92,42 @@ public:
 	Vec4 m_unprojParams;
 
 	Bool m_clusterEdgesDirty;
+
+	// Object-centric binning
+	WeakArray<ObjectRange> m_objectRanges; ///< The ranges of all objects. The objects of each type are contiguous.
+	Array<U32, TYPED_OBJECT_COUNT> m_firstObjectRange; ///< Where each type starts in m_objectRanges.
+	WeakArray<U32> m_tileObjectOffsets; ///< [tileCount][TYPED_OBJECT_COUNT] plus one. Offsets to m_tileObjects.
+	WeakArray<U32> m_tileObjects; ///< Per tile and type the indices of the objects that may touch the tile.
+
+	/// How many objects of a type a tile has to test.
+	U32 getCandidateCount(U32 tileIdx, U32 typeIdx, U32 objectCount) const
+	{
+		if(!m_bin->m_objectCentric)
+		{
+			return objectCount;
+		}
+
+		const U32 key = tileIdx * TYPED_OBJECT_COUNT + typeIdx;
+		return m_tileObjectOffsets[key + 1] - m_tileObjectOffsets[key];
+	}
+
+	/// Get the object index and the clusters of the tile that it may touch.
+	void getCandidate(U32 tileIdx, U32 typeIdx, U32 candidateIdx, U32& objectIdx, U32& clusterZBegin,
+					  U32& clusterZEnd) const
+	{
+		if(!m_bin->m_objectCentric)
+		{
+			objectIdx = candidateIdx;
+			clusterZBegin = 0;
+			clusterZEnd = m_bin->m_clusterCounts[2];
+			return;
+		}
+
+		objectIdx = m_tileObjects[m_tileObjectOffsets[tileIdx * TYPED_OBJECT_COUNT + typeIdx] + candidateIdx];
+		const ObjectRange& range = m_objectRanges[m_firstObjectRange[typeIdx] + objectIdx];
+		clusterZBegin = range.m_min[2];
+		clusterZEnd = range.m_max[2] + 1u;
+	}
 };
 
 class ClusterBin::TileCtx
@@ -76,6 +143,14 @@ public:
 	DynamicArrayAuto<Aabb> m_clusterBoxes;
 	DynamicArrayAuto<Sphere> m_clusterSpheres;
 
+	// For the SIMD kernels
+	DynamicArrayAuto<Vec4> m_splitEdgesWSpaceSoa; ///< [clusterCountZ + 1][3]. The X, Y and Z of the 4 edges of a split.
+	DynamicArrayAuto<F32> m_clusterBoxesSoa; ///< [6][paddedClusterCountZ]. The XYZ of the min and then of the max.
+	DynamicArrayAuto<F32> m_clusterSpheresSoa; ///< [4][paddedClusterCountZ]. The XYZ of the center and the radius.
+	DynamicArrayAuto<U64> m_clusterMask; ///< The clusters that a shape collides with.
+	U32 m_paddedClusterCountZ = MAX_U32;
+	Bool m_simd = false;
+
 	DynamicArrayAuto<ClusterMetaInfo> m_clusterInfos;
 	DynamicArrayAuto<U32> m_indices;
 
@@ -85,11 +160,150 @@ public:
 		: m_clusterEdgesWSpace(alloc)
 		, m_clusterBoxes(alloc)
 		, m_clusterSpheres(alloc)
+		, m_splitEdgesWSpaceSoa(alloc)
+		, m_clusterBoxesSoa(alloc)
+		, m_clusterSpheresSoa(alloc)
+		, m_clusterMask(alloc)
 		, m_clusterInfos(alloc)
 		, m_indices(alloc)
 	{
 	}
 
+	void init(U32 clusterCountZ, U32 avgObjectsPerCluster, Bool simd)
+	{
+		m_clusterCountZ = clusterCountZ;
+		m_paddedClusterCountZ = getAlignedRoundUp(4, clusterCountZ);
+		m_simd = simd;
+
+		m_clusterEdgesWSpace.create((clusterCountZ + 1) * 4);
+		m_clusterBoxes.create(clusterCountZ);
+		m_clusterSpheres.create(clusterCountZ);
+		m_indices.create(clusterCountZ * avgObjectsPerCluster);
+		m_clusterInfos.create(clusterCountZ);
+		m_clusterMask.create((clusterCountZ + 63) / 64, 0);
+
+		if(simd)
+		{
+			m_splitEdgesWSpaceSoa.create((clusterCountZ + 1) * 3);
+
+			// Zero the padding because the kernels read it
+			m_clusterBoxesSoa.create(m_paddedClusterCountZ * 6, 0.0f);
+			m_clusterSpheresSoa.create(m_paddedClusterCountZ * 4, 0.0f);
+		}
+	}
+
+	/// Set the AABB and the sphere of a cluster.
+	void setClusterVolumes(U32 clusterZ, const Vec4& aabbMin, const Vec4& aabbMax)
+	{
+		m_clusterBoxes[clusterZ] = Aabb(aabbMin, aabbMax);
+
+		const Vec4 sphereCenter = (aabbMin + aabbMax) / 2.0f;
+		const F32 sphereRadius = (aabbMin - sphereCenter).getLength();
+		m_clusterSpheres[clusterZ] = Sphere(sphereCenter, sphereRadius);
+
+		if(m_simd)
+		{
+			for(U32 i = 0; i < 3; ++i)
+			{
+				m_clusterBoxesSoa[i * m_paddedClusterCountZ + clusterZ] = aabbMin[i];
+				m_clusterBoxesSoa[(i + 3) * m_paddedClusterCountZ + clusterZ] = aabbMax[i];
+				m_clusterSpheresSoa[i * m_paddedClusterCountZ + clusterZ] = sphereCenter[i];
+			}
+			m_clusterSpheresSoa[3 * m_paddedClusterCountZ + clusterZ] = sphereRadius;
+		}
+	}
+
+	/// Test a shape against the AABBs of the clusters [begin, end) and store the results to m_clusterMask.
+	template<typename TShape>
+	void testClusters(const TShape& shape, U32 begin, U32 end)
+	{
+		for(U32 clusterZ = begin; clusterZ < end; ++clusterZ)
+		{
+			const U64 bit = U64(1) << U64(clusterZ % 64);
+			if(testCollision(shape, m_clusterBoxes[clusterZ]))
+			{
+				m_clusterMask[clusterZ / 64] |= bit;
+			}
+			else
+			{
+				m_clusterMask[clusterZ / 64] &= ~bit;
+			}
+		}
+	}
+
+	/// @copydoc testClusters
+	void testClusters(const Sphere& sphere, U32 begin, U32 end)
+	{
+		if(m_simd)
+		{
+			testCollisionSoa(sphere, getClusterBoxesSoa(), begin, end, WeakArray<U64>(m_clusterMask));
+		}
+		else
+		{
+			testClusters<Sphere>(sphere, begin, end);
+		}
+	}
+
+	/// @copydoc testClusters
+	void testClusters(const Aabb& box, U32 begin, U32 end)
+	{
+		if(m_simd)
+		{
+			testCollisionSoa(box, getClusterBoxesSoa(), begin, end, WeakArray<U64>(m_clusterMask));
+		}
+		else
+		{
+			testClusters<Aabb>(box, begin, end);
+		}
+	}
+
+	/// Test a cone against the spheres of the clusters [begin, end) and store the results to m_clusterMask.
+	void testClusters(const Cone& cone, U32 begin, U32 end)
+	{
+		if(m_simd)
+		{
+			SphereSoa spheres;
+			for(U32 i = 0; i < 3; ++i)
+			{
+				spheres.m_center[i] = &m_clusterSpheresSoa[i * m_paddedClusterCountZ];
+			}
+			spheres.m_radius = &m_clusterSpheresSoa[3 * m_paddedClusterCountZ];
+
+			testCollisionSoa(cone, spheres, begin, end, WeakArray<U64>(m_clusterMask));
+		}
+		else
+		{
+			for(U32 clusterZ = begin; clusterZ < end; ++clusterZ)
+			{
+				const U64 bit = U64(1) << U64(clusterZ % 64);
+				if(testCollision(m_clusterSpheres[clusterZ], cone))
+				{
+					m_clusterMask[clusterZ / 64] |= bit;
+				}
+				else
+				{
+					m_clusterMask[clusterZ / 64] &= ~bit;
+				}
+			}
+		}
+	}
+
+	Bool collidesWithCluster(U32 clusterZ) const
+	{
+		return (m_clusterMask[clusterZ / 64] & (U64(1) << U64(clusterZ % 64))) != 0;
+	}
+
+	AabbSoa getClusterBoxesSoa() const
+	{
+		AabbSoa boxes;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			boxes.m_min[i] = &m_clusterBoxesSoa[i * m_paddedClusterCountZ];
+			boxes.m_max[i] = &m_clusterBoxesSoa[(i + 3) * m_paddedClusterCountZ];
+		}
+		return boxes;
+	}
+
 	WeakArray<U32> getClusterIndices(const U32 clusterZ)
 	{
 		ANKI_ASSERT(clusterZ < m_clusterCountZ);
@@ -115,6 +329,8 @@ void ClusterBin::init(HeapAllocator<U8> alloc, U32 clusterCountX, U32 clusterCou
 	m_totalClusterCount = clusterCountX * clusterCountY * clusterCountZ;
 
 	m_avgObjectsPerCluster = cfg.getNumberU32("r_avgObjectsPerCluster");
+	m_objectCentric = cfg.getBool("r_objectCentricClusterBinning");
+	m_simd = cfg.getBool("r_clusterBinSimd");
 
 	// The actual indices per cluster are
 	// - the object indices per cluster
@@ -147,9 +363,10 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 	}
 
 	// Allocate indices
-	U32* indices = static_cast<U32*>(ctx.m_in->m_stagingMem->allocateFrame(
-		m_indexCount * sizeof(U32), StagingGpuMemoryType::STORAGE, ctx.m_out->m_indicesToken));
+	U32* indices = static_cast<U32*>(allocateFrame(*ctx.m_in, m_indexCount * sizeof(U32), StagingGpuMemoryType::STORAGE,
+												   ctx.m_out->m_indicesToken));
 	ctx.m_lightIds = WeakArray<U32>(indices, m_indexCount);
+	out.m_indices = ConstWeakArray<U32>(indices, m_indexCount);
 
 	// Reserve some indices for empty clusters
 	for(U i = 0; i < TYPED_OBJECT_COUNT; ++i)
@@ -158,33 +375,43 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 	}
 
 	// Allocate clusters
-	U32* clusters = static_cast<U32*>(ctx.m_in->m_stagingMem->allocateFrame(
-		sizeof(U32) * m_totalClusterCount, StagingGpuMemoryType::STORAGE, ctx.m_out->m_clustersToken));
+	U32* clusters = static_cast<U32*>(allocateFrame(*ctx.m_in, sizeof(U32) * m_totalClusterCount,
+													StagingGpuMemoryType::STORAGE, ctx.m_out->m_clustersToken));
 	ctx.m_clusters = WeakArray<U32>(clusters, m_totalClusterCount);
+	out.m_clusters = ConstWeakArray<U32>(clusters, m_totalClusterCount);
 
 	// Create task for writing GPU buffers
-	Array<ThreadHiveTask, ThreadHive::MAX_THREADS + 1> tasks;
-	tasks[0] = ANKI_THREAD_HIVE_TASK(
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS + 2> tasks;
+	U32 taskCount = 0;
+	tasks[taskCount++] = ANKI_THREAD_HIVE_TASK(
 		{
 			ANKI_TRACE_SCOPED_EVENT(R_WRITE_LIGHT_BUFFERS);
 			self->m_bin->writeTypedObjectsToGpuBuffers(*self);
 		},
 		&ctx, nullptr, nullptr);
 
+	// Create the task that finds the tiles of each object. The tiles wait for it
+	ThreadHiveSemaphore* objectsBinnedSem = nullptr;
+	if(m_objectCentric)
+	{
+		objectsBinnedSem = in.m_threadHive->newSemaphore(1);
+		tasks[taskCount++] = ANKI_THREAD_HIVE_TASK(
+			{
+				ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
+				self->m_bin->binObjects(*self);
+			},
+			&ctx, nullptr, objectsBinnedSem);
+	}
+
 	// Create tasks for binning
-	tasks[1] = ANKI_THREAD_HIVE_TASK(
+	const U32 firstTileTask = taskCount;
+	tasks[taskCount++] = ANKI_THREAD_HIVE_TASK(
 		{
 			ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
 			BinCtx& ctx = *self;
 
 			TileCtx tileCtx(ctx.m_in->m_tempAlloc);
-			const U32 clusterCountZ = ctx.m_bin->m_clusterCounts[2];
-			tileCtx.m_clusterEdgesWSpace.create((clusterCountZ + 1) * 4);
-			tileCtx.m_clusterBoxes.create(clusterCountZ);
-			tileCtx.m_clusterSpheres.create(clusterCountZ);
-			tileCtx.m_indices.create(clusterCountZ * ctx.m_bin->m_avgObjectsPerCluster);
-			tileCtx.m_clusterInfos.create(clusterCountZ);
-			tileCtx.m_clusterCountZ = clusterCountZ;
+			tileCtx.init(ctx.m_bin->m_clusterCounts[2], ctx.m_bin->m_avgObjectsPerCluster, ctx.m_bin->m_simd);
 
 			const U32 tileCount = ctx.m_bin->m_clusterCounts[0] * ctx.m_bin->m_clusterCounts[1];
 			U32 tileIdx;
@@ -193,15 +420,15 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 				ctx.m_bin->binTile(tileIdx, ctx, tileCtx);
 			}
 		},
-		&ctx, nullptr, nullptr);
+		&ctx, objectsBinnedSem, nullptr);
 
 	for(U threadIdx = 1; threadIdx < in.m_threadHive->getThreadCount(); ++threadIdx)
 	{
-		tasks[threadIdx + 1] = tasks[1];
+		tasks[taskCount++] = tasks[firstTileTask];
 	}
 
 	// Submit and wait
-	in.m_threadHive->submitTasks(&tasks[0], in.m_threadHive->getThreadCount() + 1);
+	in.m_threadHive->submitTasks(&tasks[0], taskCount);
 	in.m_threadHive->waitAllTasks();
 }
 
@@ -282,13 +509,59 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 
 	// Transform the tile's cluster edges to world space
 	DynamicArrayAuto<Vec4>& clusterEdgesWSpace = tileCtx.m_clusterEdgesWSpace;
-	for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2] + 1; ++clusterZ)
+#if ANKI_SIMD_SSE
+	if(m_simd)
 	{
-		const U32 idx = clusterZ * 4;
-		clusterEdgesWSpace[idx + 0] = (ctx.m_in->m_renderQueue->m_cameraTransform * clusterEdgesVSpace[idx + 0]).xyz0();
-		clusterEdgesWSpace[idx + 1] = (ctx.m_in->m_renderQueue->m_cameraTransform * clusterEdgesVSpace[idx + 1]).xyz0();
-		clusterEdgesWSpace[idx + 2] = (ctx.m_in->m_renderQueue->m_cameraTransform * clusterEdgesVSpace[idx + 2]).xyz0();
-		clusterEdgesWSpace[idx + 3] = (ctx.m_in->m_renderQueue->m_cameraTransform * clusterEdgesVSpace[idx + 3]).xyz0();
+		// Transform the 4 edges of a split at once. The lanes are the edges. The sums are in the order of _mm_dp_ps so
+		// the results are identical to the Mat4 * Vec4 below
+		const Mat4& trf = ctx.m_in->m_renderQueue->m_cameraTransform;
+		Array2d<__m128, 3, 4> rows;
+		for(U32 i = 0; i < 3; ++i)
+		{
+			for(U32 j = 0; j < 4; ++j)
+			{
+				rows[i][j] = _mm_set1_ps(trf(i, j));
+			}
+		}
+
+		for(U32 split = 0; split < m_clusterCounts[2] + 1; ++split)
+		{
+			const U32 idx = split * 4;
+			__m128 x = clusterEdgesVSpace[idx + 0].getSimd();
+			__m128 y = clusterEdgesVSpace[idx + 1].getSimd();
+			__m128 z = clusterEdgesVSpace[idx + 2].getSimd();
+			__m128 w = clusterEdgesVSpace[idx + 3].getSimd();
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			Array<__m128, 4> wspace;
+			for(U32 i = 0; i < 3; ++i)
+			{
+				wspace[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rows[i][0], x), _mm_mul_ps(rows[i][1], y)),
+									   _mm_add_ps(_mm_mul_ps(rows[i][2], z), _mm_mul_ps(rows[i][3], w)));
+				tileCtx.m_splitEdgesWSpaceSoa[split * 3 + i].getSimd() = wspace[i];
+			}
+
+			// Back to AoS for the frustum
+			wspace[3] = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(wspace[0], wspace[1], wspace[2], wspace[3]);
+			for(U32 i = 0; i < 4; ++i)
+			{
+				clusterEdgesWSpace[idx + i].getSimd() = wspace[i];
+			}
+		}
+	}
+	else
+#endif
+	{
+		for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2] + 1; ++clusterZ)
+		{
+			const U32 idx = clusterZ * 4;
+			const Mat4& trf = ctx.m_in->m_renderQueue->m_cameraTransform;
+			clusterEdgesWSpace[idx + 0] = (trf * clusterEdgesVSpace[idx + 0]).xyz0();
+			clusterEdgesWSpace[idx + 1] = (trf * clusterEdgesVSpace[idx + 1]).xyz0();
+			clusterEdgesWSpace[idx + 2] = (trf * clusterEdgesVSpace[idx + 2]).xyz0();
+			clusterEdgesWSpace[idx + 3] = (trf * clusterEdgesVSpace[idx + 3]).xyz0();
+		}
 	}
 
 	// Compute the tile frustum
@@ -305,23 +578,45 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 									clusterEdgesWSpace[beforeLastQuartet + 0], clusterEdgesWSpace[lastQuartet + 0]);
 
 	// Compute the cluster AABBs and spheres
-	DynamicArrayAuto<Aabb>& clusterBoxes = tileCtx.m_clusterBoxes;
-	DynamicArrayAuto<Sphere>& clusterSpheres = tileCtx.m_clusterSpheres;
 	for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
 	{
 		// Compute an AABB and a sphere that contains the cluster
-		Vec4 aabbMin(MAX_F32, MAX_F32, MAX_F32, 0.0f);
-		Vec4 aabbMax(MIN_F32, MIN_F32, MIN_F32, 0.0f);
-		for(U32 i = 0; i < 8; ++i)
+		Vec4 aabbMin;
+		Vec4 aabbMax;
+#if ANKI_SIMD_SSE
+		if(m_simd)
 		{
-			aabbMin = aabbMin.min(clusterEdgesWSpace[clusterZ * 4 + i]);
-			aabbMax = aabbMax.max(clusterEdgesWSpace[clusterZ * 4 + i]);
-		}
+			// Min and max of the edges of the 2 splits and then transpose to get the min and max of the 4 lanes
+			const Vec4* nearSplit = &tileCtx.m_splitEdgesWSpaceSoa[clusterZ * 3];
+			const Vec4* farSplit = &tileCtx.m_splitEdgesWSpaceSoa[(clusterZ + 1) * 3];
+			Array<__m128, 4> mins;
+			Array<__m128, 4> maxs;
+			for(U32 i = 0; i < 3; ++i)
+			{
+				mins[i] = _mm_min_ps(nearSplit[i].getSimd(), farSplit[i].getSimd());
+				maxs[i] = _mm_max_ps(nearSplit[i].getSimd(), farSplit[i].getSimd());
+			}
+			mins[3] = _mm_setzero_ps();
+			maxs[3] = _mm_setzero_ps();
 
-		clusterBoxes[clusterZ] = Aabb(aabbMin, aabbMax);
+			_MM_TRANSPOSE4_PS(mins[0], mins[1], mins[2], mins[3]);
+			_MM_TRANSPOSE4_PS(maxs[0], maxs[1], maxs[2], maxs[3]);
+			aabbMin.getSimd() = _mm_min_ps(_mm_min_ps(mins[0], mins[1]), _mm_min_ps(mins[2], mins[3]));
+			aabbMax.getSimd() = _mm_max_ps(_mm_max_ps(maxs[0], maxs[1]), _mm_max_ps(maxs[2], maxs[3]));
+		}
+		else
+#endif
+		{
+			aabbMin = Vec4(MAX_F32, MAX_F32, MAX_F32, 0.0f);
+			aabbMax = Vec4(MIN_F32, MIN_F32, MIN_F32, 0.0f);
+			for(U32 i = 0; i < 8; ++i)
+			{
+				aabbMin = aabbMin.min(clusterEdgesWSpace[clusterZ * 4 + i]);
+				aabbMax = aabbMax.max(clusterEdgesWSpace[clusterZ * 4 + i]);
+			}
+		}
 
-		const Vec4 sphereCenter = (aabbMin + aabbMax) / 2.0f;
-		clusterSpheres[clusterZ] = Sphere(sphereCenter, (aabbMin - sphereCenter).getLength());
+		tileCtx.setClusterVolumes(clusterZ, aabbMin, aabbMax);
 	}
 
 	// Zero the infos
@@ -341,8 +636,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	// Point lights
 	{
 		Sphere lightSphere;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_pointLights.getSize(); ++i)
+		const U32 candidateCount = ctx.getCandidateCount(tileIdx, 0, ctx.m_in->m_renderQueue->m_pointLights.getSize());
+		for(U32 candidateIdx = 0; candidateIdx < candidateCount; ++candidateIdx)
 		{
+			U32 i, clusterZBegin, clusterZEnd;
+			ctx.getCandidate(tileIdx, 0, candidateIdx, i, clusterZBegin, clusterZEnd);
+
 			const PointLightQueueElement& plight = ctx.m_in->m_renderQueue->m_pointLights[i];
 			lightSphere.setCenter(plight.m_worldPosition.xyz0());
 			lightSphere.setRadius(plight.m_radius);
@@ -352,9 +651,10 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
+			tileCtx.testClusters(lightSphere, clusterZBegin, clusterZEnd);
+			for(U32 clusterZ = clusterZBegin; clusterZ < clusterZEnd; ++clusterZ)
 			{
-				if(!testCollision(lightSphere, clusterBoxes[clusterZ]))
+				if(!tileCtx.collidesWithCluster(clusterZ))
 				{
 					continue;
 				}
@@ -370,8 +670,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 		lightEdges[0] = Vec4(0.0f); // Eye
 		ConvexHullShape spotLightShape(&lightEdges[0], lightEdges.getSize());
 
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_spotLights.getSize(); ++i)
+		const U32 candidateCount = ctx.getCandidateCount(tileIdx, 1, ctx.m_in->m_renderQueue->m_spotLights.getSize());
+		for(U32 candidateIdx = 0; candidateIdx < candidateCount; ++candidateIdx)
 		{
+			U32 i, clusterZBegin, clusterZEnd;
+			ctx.getCandidate(tileIdx, 1, candidateIdx, i, clusterZBegin, clusterZEnd);
+
 			const SpotLightQueueElement& slight = ctx.m_in->m_renderQueue->m_spotLights[i];
 
 			computeEdgesOfFrustum(slight.m_distance, slight.m_outerAngle, slight.m_outerAngle, &lightEdges[1]);
@@ -382,11 +686,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
+			tileCtx.testClusters(Cone(slight.m_worldTransform.getTranslationPart().xyz0(),
+									  -slight.m_worldTransform.getZAxis(), slight.m_distance, slight.m_outerAngle),
+								 clusterZBegin, clusterZEnd);
+			for(U32 clusterZ = clusterZBegin; clusterZ < clusterZEnd; ++clusterZ)
 			{
-				if(!testCollision(clusterSpheres[clusterZ],
-								  Cone(slight.m_worldTransform.getTranslationPart().xyz0(),
-									   -slight.m_worldTransform.getZAxis(), slight.m_distance, slight.m_outerAngle)))
+				if(!tileCtx.collidesWithCluster(clusterZ))
 				{
 					continue;
 				}
@@ -399,8 +704,13 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	// Probes
 	{
 		Aabb probeBox;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_reflectionProbes.getSize(); ++i)
+		const U32 candidateCount =
+			ctx.getCandidateCount(tileIdx, 2, ctx.m_in->m_renderQueue->m_reflectionProbes.getSize());
+		for(U32 candidateIdx = 0; candidateIdx < candidateCount; ++candidateIdx)
 		{
+			U32 i, clusterZBegin, clusterZEnd;
+			ctx.getCandidate(tileIdx, 2, candidateIdx, i, clusterZBegin, clusterZEnd);
+
 			const ReflectionProbeQueueElement& probe = ctx.m_in->m_renderQueue->m_reflectionProbes[i];
 			probeBox.setMin(probe.m_aabbMin);
 			probeBox.setMax(probe.m_aabbMax);
@@ -410,9 +720,10 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
+			tileCtx.testClusters(probeBox, clusterZBegin, clusterZEnd);
+			for(U32 clusterZ = clusterZBegin; clusterZ < clusterZEnd; ++clusterZ)
 			{
-				if(!testCollision(probeBox, clusterBoxes[clusterZ]))
+				if(!tileCtx.collidesWithCluster(clusterZ))
 				{
 					continue;
 				}
@@ -425,8 +736,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	// GI probes
 	{
 		Aabb probeBox;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_giProbes.getSize(); ++i)
+		const U32 candidateCount = ctx.getCandidateCount(tileIdx, 3, ctx.m_in->m_renderQueue->m_giProbes.getSize());
+		for(U32 candidateIdx = 0; candidateIdx < candidateCount; ++candidateIdx)
 		{
+			U32 i, clusterZBegin, clusterZEnd;
+			ctx.getCandidate(tileIdx, 3, candidateIdx, i, clusterZBegin, clusterZEnd);
+
 			const GlobalIlluminationProbeQueueElement& probe = ctx.m_in->m_renderQueue->m_giProbes[i];
 			probeBox.setMin(probe.m_aabbMin);
 			probeBox.setMax(probe.m_aabbMax);
@@ -436,9 +751,10 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
+			tileCtx.testClusters(probeBox, clusterZBegin, clusterZEnd);
+			for(U32 clusterZ = clusterZBegin; clusterZ < clusterZEnd; ++clusterZ)
 			{
-				if(!testCollision(probeBox, clusterBoxes[clusterZ]))
+				if(!tileCtx.collidesWithCluster(clusterZ))
 				{
 					continue;
 				}
@@ -451,8 +767,12 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	// Decals
 	{
 		Obb decalBox;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_decals.getSize(); ++i)
+		const U32 candidateCount = ctx.getCandidateCount(tileIdx, 4, ctx.m_in->m_renderQueue->m_decals.getSize());
+		for(U32 candidateIdx = 0; candidateIdx < candidateCount; ++candidateIdx)
 		{
+			U32 i, clusterZBegin, clusterZEnd;
+			ctx.getCandidate(tileIdx, 4, candidateIdx, i, clusterZBegin, clusterZEnd);
+
 			const DecalQueueElement& decal = ctx.m_in->m_renderQueue->m_decals[i];
 			decalBox.setCenter(decal.m_obbCenter.xyz0());
 			decalBox.setRotation(Mat3x4(Vec3(0.0f), decal.m_obbRotation));
@@ -463,9 +783,10 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 				continue;
 			}
 
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
+			tileCtx.testClusters(decalBox, clusterZBegin, clusterZEnd);
+			for(U32 clusterZ = clusterZBegin; clusterZ < clusterZEnd; ++clusterZ)
 			{
-				if(!testCollision(decalBox, clusterBoxes[clusterZ]))
+				if(!tileCtx.collidesWithCluster(clusterZ))
 				{
 					continue;
 				}
@@ -477,8 +798,13 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 
 	// Fog volumes
 	{
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_fogDensityVolumes.getSize(); ++i)
+		const U32 candidateCount =
+			ctx.getCandidateCount(tileIdx, 5, ctx.m_in->m_renderQueue->m_fogDensityVolumes.getSize());
+		for(U32 candidateIdx = 0; candidateIdx < candidateCount; ++candidateIdx)
 		{
+			U32 i, clusterZBegin, clusterZEnd;
+			ctx.getCandidate(tileIdx, 5, candidateIdx, i, clusterZBegin, clusterZEnd);
+
 			const FogDensityQueueElement& fogVol = ctx.m_in->m_renderQueue->m_fogDensityVolumes[i];
 
 			if(fogVol.m_isBox)
@@ -492,9 +818,10 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 					continue;
 				}
 
-				for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
+				tileCtx.testClusters(box, clusterZBegin, clusterZEnd);
+				for(U32 clusterZ = clusterZBegin; clusterZ < clusterZEnd; ++clusterZ)
 				{
-					if(!testCollision(box, clusterBoxes[clusterZ]))
+					if(!tileCtx.collidesWithCluster(clusterZ))
 					{
 						continue;
 					}
@@ -513,9 +840,10 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 					continue;
 				}
 
-				for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
+				tileCtx.testClusters(sphere, clusterZBegin, clusterZEnd);
+				for(U32 clusterZ = clusterZBegin; clusterZ < clusterZEnd; ++clusterZ)
 				{
-					if(!testCollision(sphere, clusterBoxes[clusterZ]))
+					if(!tileCtx.collidesWithCluster(clusterZ))
 					{
 						continue;
 					}
@@ -573,6 +901,192 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	}
 }
 
+void ClusterBin::binObjects(BinCtx& ctx) const
+{
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+	StackAllocator<U8>& alloc = ctx.m_in->m_tempAlloc;
+
+	const Array<U32, TYPED_OBJECT_COUNT> objectCounts = {
+		rqueue.m_pointLights.getSize(), rqueue.m_spotLights.getSize(), rqueue.m_reflectionProbes.getSize(),
+		rqueue.m_giProbes.getSize(),	rqueue.m_decals.getSize(),		rqueue.m_fogDensityVolumes.getSize()};
+
+	U32 objectCount = 0;
+	for(U32 typeIdx = 0; typeIdx < TYPED_OBJECT_COUNT; ++typeIdx)
+	{
+		ctx.m_firstObjectRange[typeIdx] = objectCount;
+		objectCount += objectCounts[typeIdx];
+	}
+
+	ctx.m_objectRanges = WeakArray<ObjectRange>(alloc.newArray<ObjectRange>(max(objectCount, 1u)), objectCount);
+
+	// Compute the ranges of all objects using their AABBs
+	ObjectRange* range = ctx.m_objectRanges.getBegin();
+	for(const PointLightQueueElement& light : rqueue.m_pointLights)
+	{
+		computeObjectRange(computeAabb(Sphere(light.m_worldPosition.xyz0(), light.m_radius)), ctx, *range++);
+	}
+
+	Array<Vec4, 5> lightEdges;
+	lightEdges[0] = Vec4(0.0f); // Eye
+	ConvexHullShape spotLightShape(&lightEdges[0], lightEdges.getSize());
+	for(const SpotLightQueueElement& light : rqueue.m_spotLights)
+	{
+		computeEdgesOfFrustum(light.m_distance, light.m_outerAngle, light.m_outerAngle, &lightEdges[1]);
+		spotLightShape.setTransform(Transform(light.m_worldTransform));
+		computeObjectRange(computeAabb(spotLightShape), ctx, *range++);
+	}
+
+	for(const ReflectionProbeQueueElement& probe : rqueue.m_reflectionProbes)
+	{
+		computeObjectRange(Aabb(probe.m_aabbMin.xyz0(), probe.m_aabbMax.xyz0()), ctx, *range++);
+	}
+
+	for(const GlobalIlluminationProbeQueueElement& probe : rqueue.m_giProbes)
+	{
+		computeObjectRange(Aabb(probe.m_aabbMin.xyz0(), probe.m_aabbMax.xyz0()), ctx, *range++);
+	}
+
+	for(const DecalQueueElement& decal : rqueue.m_decals)
+	{
+		const Obb decalBox(decal.m_obbCenter.xyz0(), Mat3x4(Vec3(0.0f), decal.m_obbRotation),
+						   decal.m_obbExtend.xyz0());
+		computeObjectRange(computeAabb(decalBox), ctx, *range++);
+	}
+
+	for(const FogDensityQueueElement& fogVol : rqueue.m_fogDensityVolumes)
+	{
+		const Aabb box = (fogVol.m_isBox) ? Aabb(fogVol.m_aabbMin.xyz0(), fogVol.m_aabbMax.xyz0())
+										  : computeAabb(Sphere(fogVol.m_sphereCenter.xyz0(), fogVol.m_sphereRadius));
+		computeObjectRange(box, ctx, *range++);
+	}
+
+	ANKI_ASSERT(range == ctx.m_objectRanges.getBegin() + objectCount);
+
+	// Count the objects per tile and type
+	const U32 tileCount = m_clusterCounts[0] * m_clusterCounts[1];
+	const U32 keyCount = tileCount * TYPED_OBJECT_COUNT;
+	ctx.m_tileObjectOffsets = WeakArray<U32>(alloc.newArray<U32>(keyCount + 1, 0u), keyCount + 1);
+
+	for(U32 typeIdx = 0; typeIdx < TYPED_OBJECT_COUNT; ++typeIdx)
+	{
+		for(U32 i = 0; i < objectCounts[typeIdx]; ++i)
+		{
+			const ObjectRange& r = ctx.m_objectRanges[ctx.m_firstObjectRange[typeIdx] + i];
+			if(r.isEmpty())
+			{
+				continue;
+			}
+
+			for(U32 y = r.m_min[1]; y <= r.m_max[1]; ++y)
+			{
+				for(U32 x = r.m_min[0]; x <= r.m_max[0]; ++x)
+				{
+					++ctx.m_tileObjectOffsets[(y * m_clusterCounts[0] + x) * TYPED_OBJECT_COUNT + typeIdx];
+				}
+			}
+		}
+	}
+
+	// Make the counts the end of each tile's and type's objects
+	for(U32 key = 1; key < keyCount; ++key)
+	{
+		ctx.m_tileObjectOffsets[key] += ctx.m_tileObjectOffsets[key - 1];
+	}
+
+	const U32 tileObjectCount = ctx.m_tileObjectOffsets[keyCount - 1];
+	ctx.m_tileObjectOffsets[keyCount] = tileObjectCount;
+	ctx.m_tileObjects = WeakArray<U32>(alloc.newArray<U32>(max(tileObjectCount, 1u)), tileObjectCount);
+
+	// Write the objects backwards. That moves the offsets to the beginning and keeps the objects sorted
+	for(U32 typeIdx = TYPED_OBJECT_COUNT; typeIdx-- > 0;)
+	{
+		for(U32 i = objectCounts[typeIdx]; i-- > 0;)
+		{
+			const ObjectRange& r = ctx.m_objectRanges[ctx.m_firstObjectRange[typeIdx] + i];
+			if(r.isEmpty())
+			{
+				continue;
+			}
+
+			for(U32 y = r.m_min[1]; y <= r.m_max[1]; ++y)
+			{
+				for(U32 x = r.m_min[0]; x <= r.m_max[0]; ++x)
+				{
+					const U32 key = (y * m_clusterCounts[0] + x) * TYPED_OBJECT_COUNT + typeIdx;
+					ctx.m_tileObjects[--ctx.m_tileObjectOffsets[key]] = i;
+				}
+			}
+		}
+	}
+}
+
+void ClusterBin::computeObjectRange(const Aabb& box, const BinCtx& ctx, ObjectRange& range) const
+{
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+	const F32 near = rqueue.m_cameraNear;
+	const F32 far = rqueue.m_cameraFar;
+
+	range.setEmpty();
+
+	// Move the corners to view space and find the depth range
+	Array<Vec4, 8> viewCorners;
+	F32 minDepth = MAX_F32;
+	F32 maxDepth = MIN_F32;
+	for(U32 i = 0; i < 8; ++i)
+	{
+		const Vec4 corner((i & 1) ? box.getMax().x() : box.getMin().x(), (i & 2) ? box.getMax().y() : box.getMin().y(),
+						  (i & 4) ? box.getMax().z() : box.getMin().z(), 1.0f);
+		viewCorners[i] = rqueue.m_viewMatrix * corner;
+
+		const F32 depth = -viewCorners[i].z();
+		minDepth = min(minDepth, depth);
+		maxDepth = max(maxDepth, depth);
+	}
+
+	if(maxDepth <= near || minDepth >= far)
+	{
+		return;
+	}
+
+	// Project to NDC to find the tiles. If the box crosses the near plane the projection is not reliable so assume
+	// that the object covers the whole screen
+	Array<U32, 2> minTile = {0, 0};
+	Array<U32, 2> maxTile = {m_clusterCounts[0] - 1, m_clusterCounts[1] - 1};
+	if(minDepth > near)
+	{
+		Vec2 minNdc(MAX_F32);
+		Vec2 maxNdc(MIN_F32);
+		for(const Vec4& viewCorner : viewCorners)
+		{
+			const Vec4 clip = rqueue.m_projectionMatrix * viewCorner;
+			const Vec2 ndc = clip.xy() / clip.w();
+			minNdc = minNdc.min(ndc);
+			maxNdc = maxNdc.max(ndc);
+		}
+
+		if(maxNdc.x() < -1.0f || maxNdc.y() < -1.0f || minNdc.x() > 1.0f || minNdc.y() > 1.0f)
+		{
+			return;
+		}
+
+		for(U32 i = 0; i < 2; ++i)
+		{
+			const F32 tileCount = F32(m_clusterCounts[i]);
+			minTile[i] = U32(clamp((minNdc[i] * 0.5f + 0.5f) * tileCount, 0.0f, tileCount - 1.0f));
+			maxTile[i] = U32(clamp((maxNdc[i] * 0.5f + 0.5f) * tileCount, 0.0f, tileCount - 1.0f));
+		}
+	}
+
+	// The reverse of computeClusterNear()
+	const ClustererMagicValues& magic = ctx.m_out->m_shaderMagicValues;
+	const F32 maxClusterZ = F32(m_clusterCounts[2] - 1);
+	const F32 minK = min(sqrt(max(minDepth - magic.m_val1.y(), 0.0f) / magic.m_val1.x()), maxClusterZ);
+	const F32 maxK = min(sqrt(max(maxDepth - magic.m_val1.y(), 0.0f) / magic.m_val1.x()), maxClusterZ);
+
+	range.m_min = {U16(minTile[0]), U16(minTile[1]), U16(minK)};
+	range.m_max = {U16(maxTile[0]), U16(maxTile[1]), U16(maxK)};
+}
+
 void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 {
 	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
@@ -581,8 +1095,9 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	const U32 visiblePointLightCount = rqueue.m_pointLights.getSize();
 	if(visiblePointLightCount)
 	{
-		PointLight* data = static_cast<PointLight*>(ctx.m_in->m_stagingMem->allocateFrame(
-			sizeof(PointLight) * visiblePointLightCount, StagingGpuMemoryType::UNIFORM, ctx.m_out->m_pointLightsToken));
+		PointLight* data =
+			static_cast<PointLight*>(allocateFrame(*ctx.m_in, sizeof(PointLight) * visiblePointLightCount,
+												   StagingGpuMemoryType::UNIFORM, ctx.m_out->m_pointLightsToken));
 
 		WeakArray<PointLight> gpuLights(data, visiblePointLightCount);
 
@@ -620,8 +1135,9 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	const U32 visibleSpotLightCount = rqueue.m_spotLights.getSize();
 	if(visibleSpotLightCount)
 	{
-		SpotLight* data = static_cast<SpotLight*>(ctx.m_in->m_stagingMem->allocateFrame(
-			sizeof(SpotLight) * visibleSpotLightCount, StagingGpuMemoryType::UNIFORM, ctx.m_out->m_spotLightsToken));
+		SpotLight* data =
+			static_cast<SpotLight*>(allocateFrame(*ctx.m_in, sizeof(SpotLight) * visibleSpotLightCount,
+												  StagingGpuMemoryType::UNIFORM, ctx.m_out->m_spotLightsToken));
 
 		WeakArray<SpotLight> gpuLights(data, visibleSpotLightCount);
 
@@ -668,8 +1184,8 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	const U32 visibleDecalCount = rqueue.m_decals.getSize();
 	if(visibleDecalCount)
 	{
-		Decal* data = static_cast<Decal*>(ctx.m_in->m_stagingMem->allocateFrame(
-			sizeof(Decal) * visibleDecalCount, StagingGpuMemoryType::UNIFORM, ctx.m_out->m_decalsToken));
+		Decal* data = static_cast<Decal*>(allocateFrame(*ctx.m_in, sizeof(Decal) * visibleDecalCount,
+														StagingGpuMemoryType::UNIFORM, ctx.m_out->m_decalsToken));
 
 		WeakArray<Decal> gpuDecals(data, visibleDecalCount);
 		TextureView* diffuseAtlas = nullptr;
@@ -717,8 +1233,8 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	if(visibleProbeCount)
 	{
 		ReflectionProbe* data = static_cast<ReflectionProbe*>(
-			ctx.m_in->m_stagingMem->allocateFrame(sizeof(ReflectionProbe) * visibleProbeCount,
-												  StagingGpuMemoryType::UNIFORM, ctx.m_out->m_reflectionProbesToken));
+			allocateFrame(*ctx.m_in, sizeof(ReflectionProbe) * visibleProbeCount, StagingGpuMemoryType::UNIFORM,
+						  ctx.m_out->m_reflectionProbesToken));
 
 		WeakArray<ReflectionProbe> gpuProbes(data, visibleProbeCount);
 
@@ -743,8 +1259,8 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	if(visibleFogVolumeCount)
 	{
 		FogDensityVolume* data = static_cast<FogDensityVolume*>(
-			ctx.m_in->m_stagingMem->allocateFrame(sizeof(FogDensityVolume) * visibleFogVolumeCount,
-												  StagingGpuMemoryType::UNIFORM, ctx.m_out->m_fogDensityVolumesToken));
+			allocateFrame(*ctx.m_in, sizeof(FogDensityVolume) * visibleFogVolumeCount, StagingGpuMemoryType::UNIFORM,
+						  ctx.m_out->m_fogDensityVolumesToken));
 
 		WeakArray<FogDensityVolume> gpuFogVolumes(data, visibleFogVolumeCount);
 
@@ -777,9 +1293,9 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	const U32 visibleGiProbeCount = rqueue.m_giProbes.getSize();
 	if(visibleGiProbeCount)
 	{
-		GlobalIlluminationProbe* data = static_cast<GlobalIlluminationProbe*>(ctx.m_in->m_stagingMem->allocateFrame(
-			sizeof(GlobalIlluminationProbe) * visibleGiProbeCount, StagingGpuMemoryType::UNIFORM,
-			ctx.m_out->m_globalIlluminationProbesToken));
+		GlobalIlluminationProbe* data = static_cast<GlobalIlluminationProbe*>(
+			allocateFrame(*ctx.m_in, sizeof(GlobalIlluminationProbe) * visibleGiProbeCount,
+						  StagingGpuMemoryType::UNIFORM, ctx.m_out->m_globalIlluminationProbesToken));
 
 		WeakArray<GlobalIlluminationProbe> gpuProbes(data, visibleGiProbeCount);
 
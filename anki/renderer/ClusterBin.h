@@ -14,6 +14,7 @@ namespace anki
 // Forward
 class ThreadHiveSemaphore;
 class Config;
+class Aabb;
 
 /// @addtogroup renderer
 /// @{
@@ -27,7 +28,7 @@ public:
 
 	const RenderQueue* m_renderQueue ANKI_DEBUG_CODE(= nullptr);
 
-	StagingGpuMemoryManager* m_stagingMem ANKI_DEBUG_CODE(= nullptr);
+	StagingGpuMemoryManager* m_stagingMem = nullptr; ///< If it's nullptr the results will be written to m_tempAlloc.
 
 	Bool m_shadowsEnabled ANKI_DEBUG_CODE(= false);
 };
@@ -45,6 +46,10 @@ public:
 	StagingGpuMemoryToken m_clustersToken;
 	StagingGpuMemoryToken m_indicesToken;
 
+	/// The CPU view of the memory of m_clustersToken and m_indicesToken. Valid for as long as that memory is.
+	ConstWeakArray<U32> m_clusters;
+	ConstWeakArray<U32> m_indices;
+
 	TextureViewPtr m_diffDecalTexView;
 	TextureViewPtr m_specularRoughnessDecalTexView;
 
@@ -64,6 +69,7 @@ public:
 private:
 	class BinCtx;
 	class TileCtx;
+	class ObjectRange;
 
 	HeapAllocator<U8> m_alloc;
 
@@ -75,8 +81,18 @@ private:
 	DynamicArray<Vec4> m_clusterEdges; ///< Cache those for opt. [tileCount][K+1][4]
 	Vec4 m_prevUnprojParams = Vec4(0.0f); ///< To check if m_tiles is dirty.
 
+	/// Project the objects to tile rectangles and depth ranges first and then refine only inside those. If false every
+	/// tile tests all the objects.
+	Bool m_objectCentric = true;
+
+	Bool m_simd = true; ///< Test many clusters at once with the SoA kernels of the collision module.
+
 	void prepare(BinCtx& ctx);
 
+	void binObjects(BinCtx& ctx) const;
+
+	void computeObjectRange(const Aabb& box, const BinCtx& ctx, ObjectRange& range) const;
+
 	void binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx);
 
 	void writeTypedObjectsToGpuBuffers(BinCtx& ctx) const;
@@ -46,6 +46,8 @@ class GenericCompute;
 class ShadowmapsResolve;
 class RtShadows;
 class AccelerationStructureBuilder;
+class GpuInstanceCulling;
+class GpuSceneUpload;
 
 class RenderingContext;
 class DebugDrawer;
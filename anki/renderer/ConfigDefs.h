@@ -43,11 +43,27 @@ ANKI_CONFIG_OPTION(r_giShadowMapResolution, 128, 4, 2048)
 ANKI_CONFIG_OPTION(r_giMaxCachedProbes, 16, 4, 2048)
 ANKI_CONFIG_OPTION(r_giMaxVisibleProbes, 8, 1, 256)
 
+ANKI_CONFIG_OPTION(r_probeUpdateBudget, 512, 0, 1024 * 1024,
+				   "Estimated cost of the probe refreshes per frame. Probes that are seen for the 1st time ignore it")
+ANKI_CONFIG_OPTION(r_probeRefreshPeriod, 600, 0, 1024 * 1024,
+				   "Frames after which a reflection or GI probe is refreshed. 0 refreshes them never")
+
 ANKI_CONFIG_OPTION(r_motionBlurSamples, 32, 1, 2048)
 
 ANKI_CONFIG_OPTION(r_dbgEnabled, 0, 0, 1)
 
 ANKI_CONFIG_OPTION(r_avgObjectsPerCluster, 16, 16, 256)
+ANKI_CONFIG_OPTION(r_objectCentricClusterBinning, 1, 0, 1,
+				   "Find the tiles of each light, probe etc first instead of testing all objects in every tile")
+ANKI_CONFIG_OPTION(r_clusterBinSimd, 1, 0, 1, "Bin to clusters using SIMD. The results are the same either way")
+
+ANKI_CONFIG_OPTION(r_rtShadowsLightSampling, 0, 0, 1,
+				   "RT shadows trace a few lights per pixel sampled from a light BVH instead of all shadowed lights")
+
+ANKI_CONFIG_OPTION(r_gpuInstanceCulling, 0, 0, 1,
+				   "Cull the G-buffer instances on the GPU against the Hi-Z and draw them with multi-draw indirect")
+ANKI_CONFIG_OPTION(r_gpuInstanceCullingInitialInstanceCount, 1024, 1, 1024 * 1024,
+				   "Initial size of the GPU culling buffers. They grow on demand")
 
 ANKI_CONFIG_OPTION(r_bloomThreshold, 2.5, 0.0, 256.0)
 ANKI_CONFIG_OPTION(r_bloomScale, 2.5, 0.0, 256.0)
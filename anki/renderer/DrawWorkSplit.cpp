@@ -0,0 +1,97 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/DrawWorkSplit.h>
+#include <anki/renderer/RenderQueue.h>
+
+namespace anki
+{
+
+/// A new drawcall calls the draw callback that binds programs and allocates uniforms. An extra instance only appends
+/// a few matrices.
+static const U64 DRAWCALL_COST = 8;
+static const U64 INSTANCE_COST = 1;
+
+static U64 getRenderableCost(ConstWeakArray<RenderableQueueElement> renderables, U32 idx)
+{
+	return (idx > 0 && canMergeRenderableQueueElements(renderables[idx - 1], renderables[idx])) ? INSTANCE_COST
+																								 : DRAWCALL_COST;
+}
+
+U64 DrawWorkSplit::estimateCost(ConstWeakArray<RenderableQueueElement> renderables)
+{
+	U64 cost = 0;
+	for(U32 i = 0; i < renderables.getSize(); ++i)
+	{
+		cost += getRenderableCost(renderables, i);
+	}
+
+	return cost;
+}
+
+void DrawWorkSplit::init(StackAllocator<U8> alloc, ConstWeakArray<ConstWeakArray<RenderableQueueElement>> arrays,
+						 U32 taskCount)
+{
+	ANKI_ASSERT(taskCount > 0);
+
+	U64 totalCost = 0;
+	for(const ConstWeakArray<RenderableQueueElement>& renderables : arrays)
+	{
+		totalCost += estimateCost(renderables);
+	}
+
+	// Every change of task splits at most one range
+	const U32 maxRangeCount = arrays.getSize() + taskCount - 1;
+	m_ranges = WeakArray<Range>(alloc.newArray<Range>(maxRangeCount), maxRangeCount);
+	m_taskFirstRange = WeakArray<U32>(alloc.newArray<U32>(taskCount + 1), taskCount + 1);
+
+	U32 rangeCount = 0;
+	U32 taskIdx = 0;
+	m_taskFirstRange[0] = 0;
+	U64 cost = 0;
+	U64 taskEndCost = totalCost / taskCount;
+
+	for(U32 arrayIdx = 0; arrayIdx < arrays.getSize(); ++arrayIdx)
+	{
+		const ConstWeakArray<RenderableQueueElement>& renderables = arrays[arrayIdx];
+		U32 firstRenderable = 0;
+
+		for(U32 i = 0; i < renderables.getSize(); ++i)
+		{
+			const U64 renderableCost = getRenderableCost(renderables, i);
+
+			// Move to the next task if this one has enough work. Don't split drawcalls that will be merged
+			while(cost > 0 && cost >= taskEndCost && renderableCost == DRAWCALL_COST && taskIdx + 1 < taskCount)
+			{
+				if(i > firstRenderable)
+				{
+					m_ranges[rangeCount++] = {arrayIdx, firstRenderable, i - firstRenderable};
+					firstRenderable = i;
+				}
+
+				++taskIdx;
+				m_taskFirstRange[taskIdx] = rangeCount;
+				taskEndCost = totalCost * (taskIdx + 1) / taskCount;
+			}
+
+			cost += renderableCost;
+		}
+
+		if(renderables.getSize() > firstRenderable)
+		{
+			m_ranges[rangeCount++] = {arrayIdx, firstRenderable, renderables.getSize() - firstRenderable};
+		}
+	}
+
+	ANKI_ASSERT(rangeCount <= maxRangeCount);
+
+	// The rest of the tasks have nothing to draw
+	while(taskIdx < taskCount)
+	{
+		m_taskFirstRange[++taskIdx] = rangeCount;
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,62 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// Splits the drawing of a few arrays of renderables (the faces of a probe, the lights of a shadow pass etc) to the
+/// second level command buffers of a pass. The split is balanced using an estimation of the CPU cost of recording
+/// each renderable and not the renderable count.
+class DrawWorkSplit
+{
+public:
+	/// A range of renderables in one of the arrays.
+	class Range
+	{
+	public:
+		U32 m_arrayIdx;
+		U32 m_firstRenderable;
+		U32 m_renderableCount;
+	};
+
+	/// Do the split.
+	/// @param alloc Allocates the ranges. Nothing is freed so it should be a frame allocator.
+	/// @param arrays The arrays of renderables. Only the sizes of them and the merge keys are read here.
+	/// @param taskCount The number of the second level command buffers.
+	void init(StackAllocator<U8> alloc, ConstWeakArray<ConstWeakArray<RenderableQueueElement>> arrays,
+			  U32 taskCount);
+
+	/// Get the ranges that a second level command buffer will draw. Some tasks might have nothing to draw.
+	ConstWeakArray<Range> getTaskRanges(U32 taskIdx) const
+	{
+		ANKI_ASSERT(taskIdx + 1 < m_taskFirstRange.getSize());
+		const U32 first = m_taskFirstRange[taskIdx];
+		const U32 count = m_taskFirstRange[taskIdx + 1] - first;
+		return (count) ? ConstWeakArray<Range>(&m_ranges[first], count) : ConstWeakArray<Range>();
+	}
+
+	U32 getTaskCount() const
+	{
+		return m_taskFirstRange.getSize() - 1;
+	}
+
+	/// Estimate the cost of recording some renderables. Every drawcall costs more than an extra instance of a
+	/// drawcall.
+	static U64 estimateCost(ConstWeakArray<RenderableQueueElement> renderables);
+
+private:
+	WeakArray<Range> m_ranges;
+	WeakArray<U32> m_taskFirstRange; ///< The ranges of a task. It has one extra element at the end.
+};
+/// @}
+
+} // end namespace anki
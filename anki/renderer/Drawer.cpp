@@ -7,6 +7,8 @@
 #include <anki/renderer/RenderQueue.h>
 #include <anki/resource/TextureResource.h>
 #include <anki/renderer/Renderer.h>
+#include <anki/renderer/GpuInstanceCulling.h>
+#include <anki/renderer/GpuSceneUpload.h>
 #include <anki/util/Tracer.h>
 #include <anki/util/Logger.h>
 
@@ -28,12 +30,6 @@ public:
 	U32 m_minLod = 0;
 };
 
-/// Check if the drawcalls can be merged.
-static Bool canMergeRenderableQueueElements(const RenderableQueueElement& a, const RenderableQueueElement& b)
-{
-	return a.m_callback == b.m_callback && a.m_mergeKey != 0 && a.m_mergeKey == b.m_mergeKey;
-}
-
 RenderableDrawer::~RenderableDrawer()
 {
 }
@@ -45,16 +41,7 @@ void RenderableDrawer::drawRange(Pass pass, const Mat4& viewMat, const Mat4& vie
 	ANKI_ASSERT(begin && end && begin < end);
 
 	DrawContext ctx;
-	ctx.m_queueCtx.m_viewMatrix = viewMat;
-	ctx.m_queueCtx.m_viewProjectionMatrix = viewProjMat;
-	ctx.m_queueCtx.m_projectionMatrix = Mat4::getIdentity(); // TODO
-	ctx.m_queueCtx.m_previousViewProjectionMatrix = prevViewProjMat;
-	ctx.m_queueCtx.m_cameraTransform = ctx.m_queueCtx.m_viewMatrix.getInverse();
-	ctx.m_queueCtx.m_stagingGpuAllocator = &m_r->getStagingGpuMemoryManager();
-	ctx.m_queueCtx.m_commandBuffer = cmdb;
-	ctx.m_queueCtx.m_sampler = sampler;
-	ctx.m_queueCtx.m_key = RenderingKey(pass, 0, 1, false, false);
-	ctx.m_queueCtx.m_debugDraw = false;
+	setupContext(pass, viewMat, viewProjMat, prevViewProjMat, cmdb, sampler, ctx);
 
 	ANKI_ASSERT(minLod < MAX_LOD_COUNT);
 	ctx.m_minLod = minLod;
@@ -70,6 +57,73 @@ void RenderableDrawer::drawRange(Pass pass, const Mat4& viewMat, const Mat4& vie
 	flushDrawcall(ctx);
 }
 
+void RenderableDrawer::drawBuckets(Pass pass, const Mat4& viewMat, const Mat4& viewProjMat,
+								   const Mat4& prevViewProjMat, CommandBufferPtr cmdb, SamplerPtr sampler,
+								   const RenderableQueueElement* renderables, const GpuInstanceBuckets& buckets,
+								   U32 firstBucket, U32 endBucket)
+{
+	ANKI_ASSERT(renderables && firstBucket < endBucket && endBucket <= buckets.getBuckets().getSize());
+
+	DrawContext ctx;
+	setupContext(pass, viewMat, viewProjMat, prevViewProjMat, cmdb, sampler, ctx);
+	ctx.m_queueCtx.m_indirectArgsBuffer = buckets.getIndirectArgsBuffer();
+	ctx.m_queueCtx.m_instanceRemapBuffer = buckets.getInstanceRemapBuffer();
+	ctx.m_queueCtx.m_instanceRemapBufferOffset = buckets.getInstanceRemapBufferOffset();
+	ctx.m_queueCtx.m_instanceRemapBufferRange = buckets.getInstanceCount() * sizeof(U32);
+
+	for(U32 b = firstBucket; b < endBucket; ++b)
+	{
+		const GpuInstanceBucket& bucket = buckets.getBuckets()[b];
+		ctx.m_queueCtx.m_key.setLod(bucket.m_lod);
+
+		if(bucket.m_gpuCulled)
+		{
+			// The instances come from the remap buffer. The callback only needs the 1st to know what to draw
+			ctx.m_userData[0] = renderables[bucket.m_firstInstance].m_userData;
+			ctx.m_queueCtx.m_key.setInstanceCount(1);
+			ctx.m_queueCtx.m_indirectArgs = buckets.getIndirectArgs(b);
+			ctx.m_queueCtx.m_indirectArgsBufferOffset =
+				buckets.getIndirectArgsBufferOffset() + b * sizeof(DrawElementsIndirectInfo);
+		}
+		else
+		{
+			for(U32 i = 0; i < bucket.m_instanceCount; ++i)
+			{
+				ctx.m_userData[i] = renderables[bucket.m_firstInstance + i].m_userData;
+			}
+
+			ctx.m_queueCtx.m_key.setInstanceCount(bucket.m_instanceCount);
+			ctx.m_queueCtx.m_indirectArgs = nullptr;
+		}
+
+		renderables[bucket.m_firstInstance].m_callback(
+			ctx.m_queueCtx, ConstWeakArray<void*>(const_cast<void**>(&ctx.m_userData[0]),
+												  ctx.m_queueCtx.m_key.getInstanceCount()));
+
+		if(bucket.m_instanceCount > 1)
+		{
+			ANKI_TRACE_INC_COUNTER(R_MERGED_DRAWCALLS, bucket.m_instanceCount - 1);
+		}
+	}
+}
+
+void RenderableDrawer::setupContext(Pass pass, const Mat4& viewMat, const Mat4& viewProjMat,
+									const Mat4& prevViewProjMat, CommandBufferPtr cmdb, SamplerPtr sampler,
+									DrawContext& ctx)
+{
+	ctx.m_queueCtx.m_viewMatrix = viewMat;
+	ctx.m_queueCtx.m_viewProjectionMatrix = viewProjMat;
+	ctx.m_queueCtx.m_projectionMatrix = Mat4::getIdentity(); // TODO
+	ctx.m_queueCtx.m_previousViewProjectionMatrix = prevViewProjMat;
+	ctx.m_queueCtx.m_cameraTransform = ctx.m_queueCtx.m_viewMatrix.getInverse();
+	ctx.m_queueCtx.m_stagingGpuAllocator = &m_r->getStagingGpuMemoryManager();
+	ctx.m_queueCtx.m_commandBuffer = cmdb;
+	ctx.m_queueCtx.m_sampler = sampler;
+	ctx.m_queueCtx.m_key = RenderingKey(pass, 0, 1, false, false);
+	ctx.m_queueCtx.m_debugDraw = false;
+	ctx.m_queueCtx.m_gpuSceneBuffer = m_r->getGpuSceneUpload().getBuffer();
+}
+
 void RenderableDrawer::flushDrawcall(DrawContext& ctx)
 {
 	ctx.m_queueCtx.m_key.setLod(ctx.m_cachedRenderElementLods[0]);
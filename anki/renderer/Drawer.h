@@ -15,6 +15,7 @@ namespace anki
 // Forward
 class Renderer;
 class DrawContext;
+class GpuInstanceBuckets;
 
 /// @addtogroup renderer
 /// @{
@@ -36,9 +37,17 @@ public:
 				   CommandBufferPtr cmdb, SamplerPtr sampler, const RenderableQueueElement* begin,
 				   const RenderableQueueElement* end, U32 minLod = 0);
 
+	/// Draw a range of the buckets of the GPU instance culling. Every bucket is a single instanced draw.
+	void drawBuckets(Pass pass, const Mat4& viewMat, const Mat4& viewProjMat, const Mat4& prevViewProjMat,
+					 CommandBufferPtr cmdb, SamplerPtr sampler, const RenderableQueueElement* renderables,
+					 const GpuInstanceBuckets& buckets, U32 firstBucket, U32 endBucket);
+
 private:
 	Renderer* m_r;
 
+	void setupContext(Pass pass, const Mat4& viewMat, const Mat4& viewProjMat, const Mat4& prevViewProjMat,
+					  CommandBufferPtr cmdb, SamplerPtr sampler, DrawContext& ctx);
+
 	void flushDrawcall(DrawContext& ctx);
 
 	void drawSingle(DrawContext& ctx);
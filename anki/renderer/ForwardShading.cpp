@@ -12,6 +12,7 @@
 #include <anki/renderer/DepthDownscale.h>
 #include <anki/renderer/LensFlare.h>
 #include <anki/renderer/VolumetricLightingAccumulation.h>
+#include <anki/renderer/GpuSceneUpload.h>
 
 namespace anki
 {
@@ -81,6 +82,8 @@ void ForwardShading::setDependencies(const RenderingContext& ctx, GraphicsRender
 	{
 		pass.newDependency({m_r->getLensFlare().getIndirectDrawBuffer(), BufferUsageBit::INDIRECT_DRAW});
 	}
+
+	m_r->getGpuSceneUpload().setDependencies(pass);
 }
 
 } // end namespace anki
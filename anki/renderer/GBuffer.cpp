@@ -7,6 +7,8 @@
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/RenderQueue.h>
 #include <anki/renderer/LensFlare.h>
+#include <anki/renderer/GpuInstanceCulling.h>
+#include <anki/renderer/GpuSceneUpload.h>
 #include <anki/util/Logger.h>
 #include <anki/util/Tracer.h>
 #include <anki/core/ConfigSet.h>
@@ -83,9 +85,10 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 	const U32 threadId = rgraphCtx.m_currentSecondLevelCommandBufferIndex;
 	const U32 threadCount = rgraphCtx.m_secondLevelCommandBufferCount;
 
-	// Get some stuff
+	// Get some stuff. With GPU culling the color writes are split in buckets instead of renderables
+	const Bool gpuCulling = m_r->getGpuInstanceCullingEnabled();
 	const U32 earlyZCount = ctx.m_renderQueue->m_earlyZRenderables.getSize();
-	const U32 problemSize = ctx.m_renderQueue->m_renderables.getSize() + earlyZCount;
+	const U32 problemSize = getColorDrawcallCount(ctx) + earlyZCount;
 	U32 start, end;
 	splitThreadedProblem(threadId, threadCount, problemSize, start, end);
 	ANKI_ASSERT(end != start);
@@ -130,12 +133,24 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 	{
 		cmdb->setDepthCompareOperation(CompareOperation::LESS_EQUAL);
 
-		ANKI_ASSERT(colorStart < colorEnd && colorEnd <= I32(ctx.m_renderQueue->m_renderables.getSize()));
-		m_r->getSceneDrawer().drawRange(Pass::GB, ctx.m_matrices.m_view, ctx.m_matrices.m_viewProjectionJitter,
-										ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection, cmdb,
-										m_r->getSamplers().m_trilinearRepeatAniso,
-										ctx.m_renderQueue->m_renderables.getBegin() + colorStart,
-										ctx.m_renderQueue->m_renderables.getBegin() + colorEnd);
+		ANKI_ASSERT(colorStart < colorEnd && colorEnd <= I32(getColorDrawcallCount(ctx)));
+		if(gpuCulling)
+		{
+			m_r->getSceneDrawer().drawBuckets(Pass::GB, ctx.m_matrices.m_view, ctx.m_matrices.m_viewProjectionJitter,
+											  ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection, cmdb,
+											  m_r->getSamplers().m_trilinearRepeatAniso,
+											  ctx.m_renderQueue->m_renderables.getBegin(),
+											  m_r->getGpuInstanceCulling().getBuckets(), U32(colorStart),
+											  U32(colorEnd));
+		}
+		else
+		{
+			m_r->getSceneDrawer().drawRange(Pass::GB, ctx.m_matrices.m_view, ctx.m_matrices.m_viewProjectionJitter,
+											ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection, cmdb,
+											m_r->getSamplers().m_trilinearRepeatAniso,
+											ctx.m_renderQueue->m_renderables.getBegin() + colorStart,
+											ctx.m_renderQueue->m_renderables.getBegin() + colorEnd);
+		}
 	}
 }
 
@@ -181,7 +196,7 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 		},
 		this,
 		computeNumberOfSecondLevelCommandBuffers(ctx.m_renderQueue->m_earlyZRenderables.getSize()
-												 + ctx.m_renderQueue->m_renderables.getSize()));
+												 + getColorDrawcallCount(ctx)));
 
 	for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 	{
@@ -190,6 +205,21 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 
 	TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 	pass.newDependency({m_runCtx.m_crntFrameDepthRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+
+	if(m_r->getGpuInstanceCullingEnabled())
+	{
+		pass.newDependency({m_r->getGpuInstanceCulling().getIndirectArgsBuffer(), BufferUsageBit::INDIRECT_DRAW});
+		pass.newDependency(
+			{m_r->getGpuInstanceCulling().getInstanceRemapBuffer(), BufferUsageBit::STORAGE_GEOMETRY_READ});
+	}
+
+	m_r->getGpuSceneUpload().setDependencies(pass);
+}
+
+U32 GBuffer::getColorDrawcallCount(const RenderingContext& ctx) const
+{
+	return (m_r->getGpuInstanceCullingEnabled()) ? m_r->getGpuInstanceCulling().getBuckets().getBuckets().getSize()
+												 : ctx.m_renderQueue->m_renderables.getSize();
 }
 
 } // end namespace anki
@@ -86,6 +86,9 @@ private:
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& initializer);
 
 	void runInThread(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx) const;
+
+	/// The number of renderables or the number of buckets if the GPU instance culling is enabled.
+	U32 getColorDrawcallCount(const RenderingContext& ctx) const;
 };
 /// @}
 
@@ -6,6 +6,8 @@
 #include <anki/renderer/GlobalIllumination.h>
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/GpuSceneUpload.h>
+#include <anki/renderer/DrawWorkSplit.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
 #include <anki/collision/Aabb.h>
@@ -46,8 +48,8 @@ public:
 	RenderTargetHandle m_lightShadingRt;
 	WeakArray<RenderTargetHandle> m_irradianceProbeRts;
 
-	U32 m_gbufferDrawcallCount ANKI_DEBUG_CODE(= MAX_U32);
-	U32 m_smDrawcallCount ANKI_DEBUG_CODE(= MAX_U32);
+	DrawWorkSplit m_gbufferWorkSplit;
+	DrawWorkSplit m_smWorkSplit;
 
 	static void foo()
 	{
@@ -256,24 +258,32 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 		return;
 	}
 
-	// Compute task counts for some of the passes
+	// Split the drawcalls of the faces to the second level command buffers of some of the passes
 	U32 gbufferTaskCount, smTaskCount;
 	{
-		giCtx->m_gbufferDrawcallCount = 0;
-		giCtx->m_smDrawcallCount = 0;
-		for(const RenderQueue* rq : giCtx->m_probeToUpdateThisFrame->m_renderQueues)
+		Array<ConstWeakArray<RenderableQueueElement>, 6> gbufferRenderables;
+		Array<ConstWeakArray<RenderableQueueElement>, 6> smRenderables;
+		U32 gbufferDrawcallCount = 0;
+		U32 smDrawcallCount = 0;
+		for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
 		{
+			const RenderQueue* rq = giCtx->m_probeToUpdateThisFrame->m_renderQueues[faceIdx];
 			ANKI_ASSERT(rq);
-			giCtx->m_gbufferDrawcallCount += rq->m_renderables.getSize();
+			gbufferRenderables[faceIdx] = rq->m_renderables;
+			gbufferDrawcallCount += rq->m_renderables.getSize();
 
 			if(rq->m_directionalLight.hasShadow())
 			{
-				giCtx->m_smDrawcallCount += rq->m_directionalLight.m_shadowRenderQueues[0]->m_renderables.getSize();
+				smRenderables[faceIdx] = rq->m_directionalLight.m_shadowRenderQueues[0]->m_renderables;
+				smDrawcallCount += smRenderables[faceIdx].getSize();
 			}
 		}
 
-		gbufferTaskCount = computeNumberOfSecondLevelCommandBuffers(giCtx->m_gbufferDrawcallCount);
-		smTaskCount = computeNumberOfSecondLevelCommandBuffers(giCtx->m_smDrawcallCount);
+		gbufferTaskCount = computeNumberOfSecondLevelCommandBuffers(gbufferDrawcallCount);
+		smTaskCount = computeNumberOfSecondLevelCommandBuffers(smDrawcallCount);
+
+		giCtx->m_gbufferWorkSplit.init(rctx.m_tempAllocator, gbufferRenderables, gbufferTaskCount);
+		giCtx->m_smWorkSplit.init(rctx.m_tempAllocator, smRenderables, smTaskCount);
 	}
 
 	// GBuffer
@@ -302,6 +312,7 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({giCtx->m_gbufferDepthRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+		m_r->getGpuSceneUpload().setDependencies(pass);
 	}
 
 	// Shadow pass. Optional
@@ -342,6 +353,7 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({giCtx->m_shadowsRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+		m_r->getGpuSceneUpload().setDependencies(pass);
 	}
 	else
 	{
@@ -381,6 +393,7 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 	// Irradiance pass. First & 2nd bounce
 	{
 		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("GI IR");
+		pass.setAsyncCompute(); // Works on the probe's own G-buffer, not the frame's
 
 		pass.setWork(
 			[](RenderPassWorkContext& rgraphCtx) {
@@ -415,12 +428,17 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 	// - Find a probe to update this frame
 	// - Find a probe to update next frame
 	// - Find the cache entries for each probe
+	ProbeUpdateScheduler& scheduler = m_r->getProbeUpdateScheduler();
 	DynamicArray<GlobalIlluminationProbeQueueElement> newListOfProbes;
 	newListOfProbes.create(ctx.m_tempAllocator, ctx.m_renderQueue->m_giProbes.getSize());
 	DynamicArray<RenderTargetHandle> volumeRts;
 	volumeRts.create(ctx.m_tempAllocator, ctx.m_renderQueue->m_giProbes.getSize());
 	U32 newListOfProbeCount = 0;
-	Bool foundProbeToUpdateNextFrame = false;
+	GlobalIlluminationProbeQueueElement* probeToUpdateNextFrame = nullptr;
+	F32 probeToUpdateNextFramePriority = 0.0f;
+	Bool probeToUpdateNextFrameMandatory = false;
+	ProbeUpdateState probeToUpdateNextFrameState;
+	U32 probeToUpdateNextFrameCell = 0;
 	for(U32 probeIdx = 0; probeIdx < ctx.m_renderQueue->m_giProbes.getSize(); ++probeIdx)
 	{
 		if(newListOfProbeCount + 1 >= m_maxVisibleProbes)
@@ -449,99 +467,118 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 		const Bool cacheEntryDirty = entry.m_uuid != probe.m_uuid || entry.m_volumeSize != probe.m_cellCounts
 									 || entry.m_probeAabbMin != probe.m_aabbMin
 									 || entry.m_probeAabbMax != probe.m_aabbMax;
-		const Bool needsUpdate = cacheEntryDirty || entry.m_renderedCells < probe.m_totalCellCount;
 
-		if(ANKI_LIKELY(!needsUpdate))
+		// The volume can't be used before all of its cells are rendered once. After that the cells are refreshed
+		// and the volume is used while that happens
+		const Bool mandatoryUpdate = cacheEntryDirty || entry.m_updateState.m_lastUpdateTimestamp == 0;
+
+		// The render queues are there only if the probe was scheduled for an update last frame
+		const Bool updateThisFrame = giCtx.m_probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr;
+
+		if(updateThisFrame)
 		{
-			// It's updated, early exit
+			if(cacheEntryDirty)
+			{
+				entry.m_renderedCells = 0;
+				entry.m_uuid = probe.m_uuid;
+				entry.m_probeAabbMin = probe.m_aabbMin;
+				entry.m_probeAabbMax = probe.m_aabbMax;
+				entry.m_volumeSize = probe.m_cellCounts;
+				entry.m_updateState = ProbeUpdateState();
+				m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
+			}
 
+			// Update the cache entry
 			entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
-			volumeRts[newListOfProbeCount] =
-				ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
-			newListOfProbes[newListOfProbeCount++] = probe;
-			continue;
-		}
 
-		// It needs update
+			// Init the cache entry textures
+			const Bool shouldInitTextures = !entry.m_volumeTex.isCreated() || entry.m_volumeSize != probe.m_cellCounts;
+			if(shouldInitTextures)
+			{
+				TextureInitInfo texInit;
+				texInit.m_type = TextureType::_3D;
+				texInit.m_format = Format::B10G11R11_UFLOAT_PACK32;
+				texInit.m_width = probe.m_cellCounts.x() * 6;
+				texInit.m_height = probe.m_cellCounts.y();
+				texInit.m_depth = probe.m_cellCounts.z();
+				texInit.m_usage = TextureUsageBit::ALL_COMPUTE | TextureUsageBit::ALL_SAMPLED;
+				texInit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
+
+				entry.m_volumeTex = m_r->createAndClearRenderTarget(texInit);
+			}
 
-		const Bool canUpdateThisFrame = giCtx.m_probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr;
-		const Bool canUpdateNextFrame = !foundProbeToUpdateNextFrame;
+			// Start a refresh if all the cells are rendered
+			if(entry.m_renderedCells == probe.m_totalCellCount)
+			{
+				entry.m_renderedCells = 0;
+			}
 
-		if(!canUpdateThisFrame && canUpdateNextFrame)
-		{
-			// Probe will (possibly) be updated next frame, inform the probe
+			// Compute the render position
+			const U32 cellToRender = entry.m_renderedCells++;
+			ANKI_ASSERT(cellToRender < probe.m_totalCellCount);
+			unflatten3dArrayIndex(probe.m_cellCounts.z(), probe.m_cellCounts.y(), probe.m_cellCounts.x(),
+								  cellToRender, giCtx.m_cellOfTheProbeToUpdateThisFrame.z(),
+								  giCtx.m_cellOfTheProbeToUpdateThisFrame.y(),
+								  giCtx.m_cellOfTheProbeToUpdateThisFrame.x());
+
+			const U32 cost = ProbeUpdateScheduler::estimateUpdateCost(probe.m_renderQueues);
+			scheduler.consumeBudget(entry.m_updateState, cost);
+			ANKI_TRACE_INC_COUNTER(R_PROBE_UPDATES, 1);
+			ANKI_TRACE_INC_COUNTER(R_PROBE_UPDATE_COST, cost);
+			if(!mandatoryUpdate)
+			{
+				ANKI_TRACE_INC_COUNTER(R_PROBE_REFRESHES, 1);
+			}
+			if(entry.m_renderedCells == probe.m_totalCellCount)
+			{
+				scheduler.markUpdated(entry.m_updateState);
+			}
 
-			foundProbeToUpdateNextFrame = true;
+			// Don't gather renderables next frame. The next cell will be scheduled with the rest of the probes
+			probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData, Vec4(0.0f));
 
-			const U32 cellToRender = (cacheEntryDirty) ? 0 : entry.m_renderedCells;
-			const Vec3 cellPos = computeProbeCellPosition(cellToRender, probe);
-			probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData, cellPos.xyz0());
-			continue;
-		}
-		else if(!canUpdateThisFrame)
-		{
-			// Can't be updated this frame so remove it from the list
-			continue;
+			// Push the probe to the new list
+			giCtx.m_probeToUpdateThisFrame = &newListOfProbes[newListOfProbeCount];
+			newListOfProbes[newListOfProbeCount] = probe;
+			volumeRts[newListOfProbeCount] =
+				ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
+			++newListOfProbeCount;
 		}
-
-		// All good, can use this probe in this frame
-
-		if(cacheEntryDirty)
+		else if(!mandatoryUpdate)
 		{
-			entry.m_renderedCells = 0;
-			entry.m_uuid = probe.m_uuid;
-			entry.m_probeAabbMin = probe.m_aabbMin;
-			entry.m_probeAabbMax = probe.m_aabbMax;
-			entry.m_volumeSize = probe.m_cellCounts;
-			m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
-		}
+			// It's updated (or being refreshed), use it
 
-		// Update the cache entry
-		entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+			scheduler.trackMotion(probe.m_aabbMin, probe.m_aabbMax, entry.m_updateState);
 
-		// Init the cache entry textures
-		const Bool shouldInitTextures = !entry.m_volumeTex.isCreated() || entry.m_volumeSize != probe.m_cellCounts;
-		if(shouldInitTextures)
-		{
-			TextureInitInfo texInit;
-			texInit.m_type = TextureType::_3D;
-			texInit.m_format = Format::B10G11R11_UFLOAT_PACK32;
-			texInit.m_width = probe.m_cellCounts.x() * 6;
-			texInit.m_height = probe.m_cellCounts.y();
-			texInit.m_depth = probe.m_cellCounts.z();
-			texInit.m_usage = TextureUsageBit::ALL_COMPUTE | TextureUsageBit::ALL_SAMPLED;
-			texInit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
-
-			entry.m_volumeTex = m_r->createAndClearRenderTarget(texInit);
+			entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+			volumeRts[newListOfProbeCount] =
+				ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
+			newListOfProbes[newListOfProbeCount++] = probe;
 		}
 
-		// Compute the render position
-		const U32 cellToRender = entry.m_renderedCells++;
-		ANKI_ASSERT(cellToRender < probe.m_totalCellCount);
-		unflatten3dArrayIndex(probe.m_cellCounts.z(), probe.m_cellCounts.y(), probe.m_cellCounts.x(), cellToRender,
-							  giCtx.m_cellOfTheProbeToUpdateThisFrame.z(), giCtx.m_cellOfTheProbeToUpdateThisFrame.y(),
-							  giCtx.m_cellOfTheProbeToUpdateThisFrame.x());
-
-		// Inform probe about its next frame
-		if(entry.m_renderedCells == probe.m_totalCellCount)
+		// Check if a cell of the probe _should_ be updated next frame. If the cache entry is not the probe's it
+		// belongs to some other probe
+		const Bool entryOwned = !cacheEntryDirty || updateThisFrame;
+		const ProbeUpdateState state = (entryOwned) ? entry.m_updateState : ProbeUpdateState();
+		const Bool nextUpdateMandatory = state.m_lastUpdateTimestamp == 0;
+		const F32 priority = scheduler.computePriority(probe.m_aabbMin, probe.m_aabbMax, state, nextUpdateMandatory);
+		if(priority > probeToUpdateNextFramePriority)
 		{
-			// Don't gather renderables next frame if it's done
-			probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData, Vec4(0.0f));
-		}
-		else if(!foundProbeToUpdateNextFrame)
-		{
-			// Gather rendederables from the same probe next frame
-			foundProbeToUpdateNextFrame = true;
-			const Vec3 cellPos = computeProbeCellPosition(entry.m_renderedCells, probe);
-			probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData, cellPos.xyz0());
+			probeToUpdateNextFrame = &probe;
+			probeToUpdateNextFramePriority = priority;
+			probeToUpdateNextFrameMandatory = nextUpdateMandatory;
+			probeToUpdateNextFrameState = state;
+			probeToUpdateNextFrameCell =
+				(entryOwned && entry.m_renderedCells < probe.m_totalCellCount) ? entry.m_renderedCells : 0;
 		}
+	}
 
-		// Push the probe to the new list
-		giCtx.m_probeToUpdateThisFrame = &newListOfProbes[newListOfProbeCount];
-		newListOfProbes[newListOfProbeCount] = probe;
-		volumeRts[newListOfProbeCount] =
-			ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
-		++newListOfProbeCount;
+	// Gather the renderables of a cell next frame if there is enough budget. Otherwise wait for the budget to build up
+	if(probeToUpdateNextFrame && scheduler.canAfford(probeToUpdateNextFrameState, probeToUpdateNextFrameMandatory))
+	{
+		const Vec3 cellPos = computeProbeCellPosition(probeToUpdateNextFrameCell, *probeToUpdateNextFrame);
+		probeToUpdateNextFrame->m_feedbackCallback(true, probeToUpdateNextFrame->m_feedbackCallbackUserData,
+												   cellPos.xyz0());
 	}
 
 	// Replace the probe list in the queue
@@ -564,6 +601,29 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 	}
 }
 
+void GlobalIllumination::finalize()
+{
+	if(!m_drawcallsSkipped.exchange(false))
+	{
+		return;
+	}
+
+	// The cell is incomplete. Render it again
+	ANKI_ASSERT(m_giCtx && m_giCtx->m_probeToUpdateThisFrame);
+	const GlobalIlluminationProbeQueueElement& probe = *m_giCtx->m_probeToUpdateThisFrame;
+	auto it = m_probeUuidToCacheEntryIdx.find(probe.m_uuid);
+	ANKI_ASSERT(it != m_probeUuidToCacheEntryIdx.getEnd());
+	CacheEntry& entry = m_cacheEntries[*it];
+
+	ANKI_ASSERT(entry.m_renderedCells > 0);
+	if(entry.m_renderedCells == probe.m_totalCellCount)
+	{
+		// It was the last cell, the volume is not updated after all
+		entry.m_updateState.m_lastUpdateTimestamp = 0;
+	}
+	--entry.m_renderedCells;
+}
+
 void GlobalIllumination::runGBufferInThread(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx) const
 {
 	ANKI_ASSERT(giCtx.m_probeToUpdateThisFrame);
@@ -571,40 +631,29 @@ void GlobalIllumination::runGBufferInThread(RenderPassWorkContext& rgraphCtx, In
 
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
 	const GlobalIlluminationProbeQueueElement& probe = *giCtx.m_probeToUpdateThisFrame;
+	const U32 skippedDrawcallCount = cmdb->getSkippedDrawcallCount();
 
-	I32 start, end;
-	U32 startu, endu;
-	splitThreadedProblem(rgraphCtx.m_currentSecondLevelCommandBufferIndex, rgraphCtx.m_secondLevelCommandBufferCount,
-						 giCtx.m_gbufferDrawcallCount, startu, endu);
-	start = I32(startu);
-	end = I32(endu);
-
-	I32 drawcallCount = 0;
-	for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+	for(const DrawWorkSplit::Range& range :
+		giCtx.m_gbufferWorkSplit.getTaskRanges(rgraphCtx.m_currentSecondLevelCommandBufferIndex))
 	{
-		const I32 faceDrawcallCount = I32(probe.m_renderQueues[faceIdx]->m_renderables.getSize());
-		const I32 localStart = max(I32(0), start - drawcallCount);
-		const I32 localEnd = min(faceDrawcallCount, end - drawcallCount);
+		const U32 faceIdx = range.m_arrayIdx;
+		const U32 viewportX = faceIdx * m_tileSize;
+		cmdb->setViewport(viewportX, 0, m_tileSize, m_tileSize);
+		cmdb->setScissor(viewportX, 0, m_tileSize, m_tileSize);
 
-		if(localStart < localEnd)
-		{
-			const U32 viewportX = faceIdx * m_tileSize;
-			cmdb->setViewport(viewportX, 0, m_tileSize, m_tileSize);
-			cmdb->setScissor(viewportX, 0, m_tileSize, m_tileSize);
-
-			const RenderQueue& rqueue = *probe.m_renderQueues[faceIdx];
-
-			ANKI_ASSERT(localStart >= 0 && localEnd <= faceDrawcallCount);
-			m_r->getSceneDrawer().drawRange(
-				Pass::GB, rqueue.m_viewMatrix, rqueue.m_viewProjectionMatrix,
-				Mat4::getIdentity(), // Don't care about prev mats since we don't care about velocity
-				cmdb, m_r->getSamplers().m_trilinearRepeat, rqueue.m_renderables.getBegin() + localStart,
-				rqueue.m_renderables.getBegin() + localEnd, MAX_LOD_COUNT - 1);
-		}
+		const RenderQueue& rqueue = *probe.m_renderQueues[faceIdx];
+		const RenderableQueueElement* begin = rqueue.m_renderables.getBegin() + range.m_firstRenderable;
 
-		drawcallCount += faceDrawcallCount;
+		m_r->getSceneDrawer().drawRange(
+			Pass::GB, rqueue.m_viewMatrix, rqueue.m_viewProjectionMatrix,
+			Mat4::getIdentity(), // Don't care about prev mats since we don't care about velocity
+			cmdb, m_r->getSamplers().m_trilinearRepeat, begin, begin + range.m_renderableCount, MAX_LOD_COUNT - 1);
+	}
+
+	if(cmdb->getSkippedDrawcallCount() != skippedDrawcallCount)
+	{
+		giCtx.m_gi->m_drawcallsSkipped.store(true);
 	}
-	ANKI_ASSERT(giCtx.m_gbufferDrawcallCount == U32(drawcallCount));
 
 	// It's secondary, no need to restore the state
 }
@@ -616,43 +665,35 @@ void GlobalIllumination::runShadowmappingInThread(RenderPassWorkContext& rgraphC
 
 	const GlobalIlluminationProbeQueueElement& probe = *giCtx.m_probeToUpdateThisFrame;
 
-	I32 start, end;
-	U32 startu, endu;
-	splitThreadedProblem(rgraphCtx.m_currentSecondLevelCommandBufferIndex, rgraphCtx.m_secondLevelCommandBufferCount,
-						 giCtx.m_smDrawcallCount, startu, endu);
-	start = I32(startu);
-	end = I32(endu);
-
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
 	cmdb->setPolygonOffset(1.0f, 1.0f);
+	const U32 skippedDrawcallCount = cmdb->getSkippedDrawcallCount();
 
-	I32 drawcallCount = 0;
-	for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+	for(const DrawWorkSplit::Range& range :
+		giCtx.m_smWorkSplit.getTaskRanges(rgraphCtx.m_currentSecondLevelCommandBufferIndex))
 	{
+		const U32 faceIdx = range.m_arrayIdx;
 		ANKI_ASSERT(probe.m_renderQueues[faceIdx]);
 		const RenderQueue& faceRenderQueue = *probe.m_renderQueues[faceIdx];
 		ANKI_ASSERT(faceRenderQueue.m_directionalLight.hasShadow());
 		ANKI_ASSERT(faceRenderQueue.m_directionalLight.m_shadowRenderQueues[0]);
 		const RenderQueue& cascadeRenderQueue = *faceRenderQueue.m_directionalLight.m_shadowRenderQueues[0];
 
-		const I32 faceDrawcallCount = I32(cascadeRenderQueue.m_renderables.getSize());
-		const I32 localStart = max(I32(0), start - drawcallCount);
-		const I32 localEnd = min(faceDrawcallCount, end - drawcallCount);
+		const U32 rez = m_shadowMapping.m_rtDescr.m_height;
+		cmdb->setViewport(rez * faceIdx, 0, rez, rez);
+		cmdb->setScissor(rez * faceIdx, 0, rez, rez);
 
-		if(localStart < localEnd)
-		{
-			const U32 rez = m_shadowMapping.m_rtDescr.m_height;
-			cmdb->setViewport(rez * faceIdx, 0, rez, rez);
-			cmdb->setScissor(rez * faceIdx, 0, rez, rez);
-
-			ANKI_ASSERT(localStart >= 0 && localEnd <= faceDrawcallCount);
-			m_r->getSceneDrawer().drawRange(Pass::SM, cascadeRenderQueue.m_viewMatrix,
-											cascadeRenderQueue.m_viewProjectionMatrix,
-											Mat4::getIdentity(), // Don't care about prev matrices here
-											cmdb, m_r->getSamplers().m_trilinearRepeatAniso,
-											cascadeRenderQueue.m_renderables.getBegin() + localStart,
-											cascadeRenderQueue.m_renderables.getBegin() + localEnd, MAX_LOD_COUNT - 1);
-		}
+		const RenderableQueueElement* begin = cascadeRenderQueue.m_renderables.getBegin() + range.m_firstRenderable;
+		m_r->getSceneDrawer().drawRange(Pass::SM, cascadeRenderQueue.m_viewMatrix,
+										cascadeRenderQueue.m_viewProjectionMatrix,
+										Mat4::getIdentity(), // Don't care about prev matrices here
+										cmdb, m_r->getSamplers().m_trilinearRepeatAniso, begin,
+										begin + range.m_renderableCount, MAX_LOD_COUNT - 1);
+	}
+
+	if(cmdb->getSkippedDrawcallCount() != skippedDrawcallCount)
+	{
+		giCtx.m_gi->m_drawcallsSkipped.store(true);
 	}
 
 	// It's secondary, no need to restore the state
@@ -666,6 +707,8 @@ void GlobalIllumination::runLightShading(RenderPassWorkContext& rgraphCtx, Inter
 	const GlobalIlluminationProbeQueueElement& probe = *giCtx.m_probeToUpdateThisFrame;
 
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const U32 skippedDrawcallCount = cmdb->getSkippedDrawcallCount();
+
 	// Set common state for all lights
 	{
 		// NOTE: Use nearest sampler because we don't want the result to sample the near tiles
@@ -716,6 +759,11 @@ void GlobalIllumination::runLightShading(RenderPassWorkContext& rgraphCtx, Inter
 		dsInfo.m_commandBuffer = cmdb;
 		m_lightShading.m_deferred.drawLights(dsInfo);
 	}
+
+	if(cmdb->getSkippedDrawcallCount() != skippedDrawcallCount)
+	{
+		giCtx.m_gi->m_drawcallsSkipped.store(true);
+	}
 }
 
 void GlobalIllumination::runIrradiance(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx)
@@ -8,6 +8,7 @@
 #include <anki/renderer/RendererObject.h>
 #include <anki/renderer/TraditionalDeferredShading.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/ProbeUpdateScheduler.h>
 #include <anki/collision/Forward.h>
 
 namespace anki
@@ -35,6 +36,9 @@ public:
 	/// Populate the rendergraph.
 	void populateRenderGraph(RenderingContext& ctx);
 
+	/// Call it after the rendergraph is recorded.
+	void finalize();
+
 	/// Return the volume RT given a cache entry index.
 	const RenderTargetHandle& getVolumeRenderTarget(const GlobalIlluminationProbeQueueElement& probe) const;
 
@@ -57,7 +61,8 @@ private:
 		UVec3 m_volumeSize = UVec3(0u);
 		Vec3 m_probeAabbMin = Vec3(0.0f);
 		Vec3 m_probeAabbMax = Vec3(0.0f);
-		U32 m_renderedCells = 0;
+		U32 m_renderedCells = 0; ///< The cells rendered by the current update or refresh of the volume.
+		ProbeUpdateState m_updateState;
 	};
 
 	class
@@ -97,6 +102,8 @@ private:
 	} m_irradiance; ///< Irradiance.
 
 	InternalContext* m_giCtx = nullptr;
+	/// Some drawcalls of the cell were not recorded because their pipelines were not ready.
+	Atomic<Bool> m_drawcallsSkipped = {false};
 	DynamicArray<CacheEntry> m_cacheEntries;
 	HashMap<U64, U32> m_probeUuidToCacheEntryIdx;
 	U32 m_tileSize = 0;
@@ -0,0 +1,254 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/GpuInstanceCulling.h>
+#include <anki/renderer/Renderer.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/DepthDownscale.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+GpuInstanceBuckets::~GpuInstanceBuckets()
+{
+	destroyBuffers();
+	m_buckets.destroy(m_alloc);
+}
+
+void GpuInstanceBuckets::init(GrManager* gr, HeapAllocator<U8> alloc, U32 initialInstanceCount)
+{
+	ANKI_ASSERT(gr && initialInstanceCount > 0);
+	m_gr = gr;
+	m_alloc = alloc;
+	createBuffers(nextPowerOfTwo(initialInstanceCount));
+}
+
+void GpuInstanceBuckets::createBuffers(U32 capacity)
+{
+	ANKI_ASSERT(capacity > 0);
+	destroyBuffers();
+
+	// Have a minimum so the per frame offsets of the buffers are aligned enough to be bound as storage
+	m_capacity = max(capacity, MAX_INSTANCES);
+
+	// The CPU writes the AABBs, the slots and the parts of the indirect args that it knows, the GPU the rest. Every
+	// frame in flight has its own part of the buffers. The buffers in use by the GPU are kept alive by the command
+	// buffers
+	BufferInitInfo buffInit("GpuCullingInstances");
+	buffInit.m_size = PtrSize(m_capacity) * MAX_FRAMES_IN_FLIGHT * sizeof(GpuCullingInstance);
+	buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_READ;
+	buffInit.m_mapAccess = BufferMapAccessBit::WRITE;
+	m_instanceBuff = m_gr->newBuffer(buffInit);
+	m_mappedInstances =
+		static_cast<GpuCullingInstance*>(m_instanceBuff->map(0, MAX_PTR_SIZE, BufferMapAccessBit::WRITE));
+
+	buffInit.setName("GpuCullingIndirectArgs");
+	buffInit.m_size = PtrSize(m_capacity) * MAX_FRAMES_IN_FLIGHT * sizeof(DrawElementsIndirectInfo);
+	buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_WRITE | BufferUsageBit::INDIRECT_DRAW;
+	m_argsBuff = m_gr->newBuffer(buffInit);
+	m_mappedArgs =
+		static_cast<DrawElementsIndirectInfo*>(m_argsBuff->map(0, MAX_PTR_SIZE, BufferMapAccessBit::WRITE));
+
+	buffInit.setName("GpuCullingInstanceRemap");
+	buffInit.m_size = PtrSize(m_capacity) * MAX_FRAMES_IN_FLIGHT * sizeof(U32);
+	buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_WRITE | BufferUsageBit::STORAGE_GEOMETRY_READ;
+	buffInit.m_mapAccess = BufferMapAccessBit::NONE;
+	m_remapBuff = m_gr->newBuffer(buffInit);
+}
+
+void GpuInstanceBuckets::destroyBuffers()
+{
+	if(m_instanceBuff)
+	{
+		m_instanceBuff->unmap();
+		m_instanceBuff.reset(nullptr);
+		m_mappedInstances = nullptr;
+	}
+
+	if(m_argsBuff)
+	{
+		m_argsBuff->unmap();
+		m_argsBuff.reset(nullptr);
+		m_mappedArgs = nullptr;
+	}
+
+	m_remapBuff.reset(nullptr);
+}
+
+void GpuInstanceBuckets::update(U64 frame, ConstWeakArray<RenderableQueueElement> renderables,
+								ConstWeakArray<F32> lodDistances)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_GPU_CULLING);
+	ANKI_ASSERT(m_gr);
+	ANKI_ASSERT(lodDistances.getSize() < MAX_LOD_COUNT);
+
+	m_instanceCount = renderables.getSize();
+	if(m_instanceCount > m_capacity)
+	{
+		createBuffers(nextPowerOfTwo(m_instanceCount));
+	}
+
+	m_region = U32(frame % MAX_FRAMES_IN_FLIGHT);
+
+	if(m_buckets.getSize() < m_instanceCount)
+	{
+		m_buckets.resize(m_alloc, m_instanceCount);
+	}
+
+	// Merge the renderables the same way the RenderableDrawer does
+	m_bucketCount = 0;
+	m_cpuDrawnInstanceCount = 0;
+	GpuCullingInstance* instances = m_mappedInstances + PtrSize(m_region) * m_capacity;
+	for(U32 i = 0; i < m_instanceCount; ++i)
+	{
+		const RenderableQueueElement& el = renderables[i];
+		const Bool gpuCulled = el.m_gpuSceneSlot != MAX_U32;
+
+		U32 lod = 0;
+		while(lod < lodDistances.getSize() && el.m_distanceFromCamera >= lodDistances[lod])
+		{
+			++lod;
+		}
+
+		GpuInstanceBucket* bucket = (m_bucketCount) ? &m_buckets[m_bucketCount - 1] : nullptr;
+		if(!bucket || bucket->m_instanceCount == MAX_INSTANCES || bucket->m_lod != lod
+		   || bucket->m_gpuCulled != gpuCulled || !canMergeRenderableQueueElements(renderables[i - 1], el))
+		{
+			bucket = &m_buckets[m_bucketCount++];
+			bucket->m_firstInstance = i;
+			bucket->m_instanceCount = 0;
+			bucket->m_lod = lod;
+			bucket->m_gpuCulled = gpuCulled;
+
+			// The instances of the bucket get their gl_InstanceIndex from there. It's their place in the remap buffer
+			if(gpuCulled)
+			{
+				getIndirectArgs(m_bucketCount - 1)->m_baseInstance = i;
+			}
+		}
+
+		++bucket->m_instanceCount;
+		m_cpuDrawnInstanceCount += !gpuCulled;
+
+		instances[i].m_aabbMin = el.m_aabbMin;
+		instances[i].m_gpuSceneSlot = el.m_gpuSceneSlot;
+		instances[i].m_aabbMax = el.m_aabbMax;
+	}
+}
+
+GpuInstanceCulling::~GpuInstanceCulling()
+{
+}
+
+Error GpuInstanceCulling::init(const ConfigSet& cfg)
+{
+	ANKI_R_LOGI("Initializing GPU instance culling");
+
+	const Error err = initInternal(cfg);
+	if(err)
+	{
+		ANKI_R_LOGE("Failed to initialize GPU instance culling");
+	}
+
+	return err;
+}
+
+Error GpuInstanceCulling::initInternal(const ConfigSet& cfg)
+{
+	m_buckets.init(&getGrManager(), getAllocator(), cfg.getNumberU32("r_gpuInstanceCullingInitialInstanceCount"));
+
+	ANKI_CHECK(getResourceManager().loadResource("shaders/GpuInstanceCulling.ankiprog", m_prog));
+
+	static_assert(MAX_INSTANCES == 64, "The shader processes a bucket with a workgroup of 64 threads");
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variant);
+	m_grProg = variant->getProgram();
+
+	return Error::NONE;
+}
+
+void GpuInstanceCulling::populateRenderGraph(RenderingContext& ctx)
+{
+	m_runCtx.m_ctx = &ctx;
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+
+	m_buckets.update(m_r->getFrameCount(), ctx.m_renderQueue->m_renderables, m_r->getLodDistances());
+
+	m_runCtx.m_argsBuffHandle = rgraph.importBuffer(m_buckets.getIndirectArgsBuffer(), BufferUsageBit::NONE);
+	m_runCtx.m_remapBuffHandle = rgraph.importBuffer(m_buckets.getInstanceRemapBuffer(), BufferUsageBit::NONE);
+
+	// The Hi-Z of the previous frame can be trusted only if nothing that writes depth changed since then
+	const Bool cameraMoved = ctx.m_matrices.m_viewProjection != ctx.m_prevMatrices.m_viewProjection;
+	m_runCtx.m_occlusionCulling = m_r->getFrameCount() > 0 && !cameraMoved
+								  && ctx.m_renderQueue->m_gpuScene.m_updateCount == 0
+								  && !m_buckets.hasCpuDrawnInstances();
+
+	if(m_buckets.getBuckets().getSize() == 0)
+	{
+		return;
+	}
+
+	ComputeRenderPassDescription& rpass = rgraph.newComputeRenderPass("GPU culling");
+
+	rpass.setWork(
+		[](RenderPassWorkContext& rgraphCtx) {
+			GpuInstanceCulling* const self = static_cast<GpuInstanceCulling*>(rgraphCtx.m_userData);
+			self->run(*self->m_runCtx.m_ctx, rgraphCtx);
+		},
+		this, 0);
+
+	// Read the Hi-Z before the DepthDownscale overwrites it
+	TextureSubresourceInfo hizSubresource;
+	hizSubresource.m_mipmapCount = m_r->getDepthDownscale().getMipmapCount();
+	rpass.newDependency({m_r->getDepthDownscale().getHiZRt(), TextureUsageBit::SAMPLED_COMPUTE, hizSubresource});
+	rpass.newDependency({m_runCtx.m_argsBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+	rpass.newDependency({m_runCtx.m_remapBuffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+}
+
+void GpuInstanceCulling::run(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_GPU_CULLING);
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const ConstWeakArray<GpuInstanceBucket> buckets = m_buckets.getBuckets();
+
+	cmdb->bindShaderProgram(m_grProg);
+
+	GpuInstanceCullingUniforms* unis =
+		allocateAndBindUniforms<GpuInstanceCullingUniforms*>(sizeof(GpuInstanceCullingUniforms), cmdb, 0, 0);
+	unis->m_viewProjMat = ctx.m_matrices.m_viewProjectionJitter;
+	unis->m_prevViewProjMat = ctx.m_prevMatrices.m_viewProjectionJitter;
+	unis->m_hizSize = UVec2(m_r->getWidth() / 2, m_r->getHeight() / 2);
+	unis->m_hizMipCount = m_r->getDepthDownscale().getMipmapCount();
+	unis->m_occlusionCulling = m_runCtx.m_occlusionCulling;
+
+	// The buckets that the CPU draws get no work
+	GpuCullingBucket* gpuBuckets =
+		allocateAndBindStorage<GpuCullingBucket*>(sizeof(GpuCullingBucket) * buckets.getSize(), cmdb, 0, 1);
+	for(const GpuInstanceBucket& bucket : buckets)
+	{
+		gpuBuckets->m_firstInstance = bucket.m_firstInstance;
+		gpuBuckets->m_instanceCount = (bucket.m_gpuCulled) ? bucket.m_instanceCount : 0;
+		++gpuBuckets;
+	}
+
+	cmdb->bindStorageBuffer(0, 2, m_buckets.getInstanceBuffer(), m_buckets.getInstanceBufferOffset(),
+							m_buckets.getInstanceCount() * sizeof(GpuCullingInstance));
+	cmdb->bindStorageBuffer(0, 3, m_buckets.getIndirectArgsBuffer(), m_buckets.getIndirectArgsBufferOffset(),
+							buckets.getSize() * sizeof(DrawElementsIndirectInfo));
+	cmdb->bindStorageBuffer(0, 4, m_buckets.getInstanceRemapBuffer(), m_buckets.getInstanceRemapBufferOffset(),
+							m_buckets.getInstanceCount() * sizeof(U32));
+
+	cmdb->bindSampler(0, 5, m_r->getSamplers().m_nearestNearestClamp);
+	TextureSubresourceInfo hizSubresource;
+	hizSubresource.m_mipmapCount = m_r->getDepthDownscale().getMipmapCount();
+	rgraphCtx.bindTexture(0, 6, m_r->getDepthDownscale().getHiZRt(), hizSubresource);
+
+	// One workgroup per bucket
+	cmdb->dispatchCompute(buckets.getSize(), 1, 1);
+}
+
+} // end namespace anki
@@ -0,0 +1,196 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/RendererObject.h>
+#include <anki/shaders/include/GpuInstanceCullingTypes.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// Consecutive renderables that can be drawn with a single instanced draw.
+class GpuInstanceBucket
+{
+public:
+	U32 m_firstInstance; ///< Index to the renderables and to the per-instance GPU data.
+	U32 m_instanceCount;
+	U32 m_lod;
+	Bool m_gpuCulled; ///< If false the renderables can't be culled on the GPU and the drawer draws them as usual.
+};
+
+/// The CPU side of the GPU instance culling. It assigns the renderables to buckets and manages the persistent buffers
+/// of the per-instance data, the instance remap and the indirect arguments. It only needs a GrManager so it can be
+/// tested on its own.
+class GpuInstanceBuckets
+{
+public:
+	GpuInstanceBuckets() = default;
+
+	GpuInstanceBuckets(const GpuInstanceBuckets&) = delete; // Non-copyable
+
+	~GpuInstanceBuckets();
+
+	GpuInstanceBuckets& operator=(const GpuInstanceBuckets&) = delete; // Non-copyable
+
+	void init(GrManager* gr, HeapAllocator<U8> alloc, U32 initialInstanceCount);
+
+	/// Assign the renderables to buckets and write their AABBs and GPU scene slots to the GPU. Call it once per frame
+	/// before any of the getters.
+	/// @param frame The frame number. It picks the part of the buffers that the GPU doesn't use.
+	/// @param renderables The renderables sorted the same way the drawer will draw them.
+	/// @param lodDistances The distances that change the LOD.
+	void update(U64 frame, ConstWeakArray<RenderableQueueElement> renderables, ConstWeakArray<F32> lodDistances);
+
+	ConstWeakArray<GpuInstanceBucket> getBuckets() const
+	{
+		return ConstWeakArray<GpuInstanceBucket>((m_bucketCount) ? &m_buckets[0] : nullptr, m_bucketCount);
+	}
+
+	U32 getInstanceCount() const
+	{
+		return m_instanceCount;
+	}
+
+	/// Some renderables (the skinned for example) are drawn by the CPU. They are not in the Hi-Z of the previous frame
+	/// so their presence makes it unreliable.
+	Bool hasCpuDrawnInstances() const
+	{
+		return m_cpuDrawnInstanceCount > 0;
+	}
+
+	/// The max number of instances that fit in the buffers without growing them.
+	U32 getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	const BufferPtr& getInstanceBuffer() const
+	{
+		return m_instanceBuff;
+	}
+
+	/// Offset of this frame's GpuCullingInstance array.
+	PtrSize getInstanceBufferOffset() const
+	{
+		return PtrSize(m_region) * m_capacity * sizeof(GpuCullingInstance);
+	}
+
+	const BufferPtr& getIndirectArgsBuffer() const
+	{
+		return m_argsBuff;
+	}
+
+	/// Offset of this frame's DrawElementsIndirectInfo array. There is one DrawElementsIndirectInfo per bucket.
+	PtrSize getIndirectArgsBufferOffset() const
+	{
+		return PtrSize(m_region) * m_capacity * sizeof(DrawElementsIndirectInfo);
+	}
+
+	/// Get the CPU visible indirect arguments of a bucket.
+	DrawElementsIndirectInfo* getIndirectArgs(U32 bucketIdx) const
+	{
+		ANKI_ASSERT(bucketIdx < m_bucketCount);
+		return m_mappedArgs + PtrSize(m_region) * m_capacity + bucketIdx;
+	}
+
+	/// The GPU writes the GPU scene slots of the visible instances of every bucket there. They start from the
+	/// bucket's m_firstInstance.
+	const BufferPtr& getInstanceRemapBuffer() const
+	{
+		return m_remapBuff;
+	}
+
+	/// Offset of this frame's U32 array.
+	PtrSize getInstanceRemapBufferOffset() const
+	{
+		return PtrSize(m_region) * m_capacity * sizeof(U32);
+	}
+
+private:
+	GrManager* m_gr = nullptr;
+	HeapAllocator<U8> m_alloc;
+
+	BufferPtr m_instanceBuff;
+	GpuCullingInstance* m_mappedInstances = nullptr;
+	BufferPtr m_argsBuff;
+	DrawElementsIndirectInfo* m_mappedArgs = nullptr;
+	BufferPtr m_remapBuff;
+	U32 m_capacity = 0; ///< Instances per frame.
+	U32 m_region = 0; ///< The part of the buffers that is used this frame.
+
+	DynamicArray<GpuInstanceBucket> m_buckets;
+	U32 m_bucketCount = 0;
+	U32 m_instanceCount = 0;
+	U32 m_cpuDrawnInstanceCount = 0;
+
+	void createBuffers(U32 capacity);
+	void destroyBuffers();
+};
+
+/// Culls the instances of the G-buffer pass against the frustum and the Hi-Z of the previous frame. It writes the GPU
+/// scene slots of the visible ones to the remap buffer and their count to the indirect arguments of their bucket.
+///
+/// The Hi-Z of the previous frame is only valid if nothing moved since then. A camera or an occluder that moved can
+/// reveal an instance that the test still finds occluded. So the occlusion test only runs when the camera and the GPU
+/// scene didn't change and there are no CPU drawn renderables, which can animate without touching the GPU scene. The
+/// rest of the time only the frustum test runs. Lifting that needs a second test of the occluded instances against
+/// the Hi-Z of the current frame and a second G-buffer pass to draw the ones that pass it.
+class GpuInstanceCulling : public RendererObject
+{
+public:
+	GpuInstanceCulling(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~GpuInstanceCulling();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
+
+	/// Populate the rendergraph.
+	void populateRenderGraph(RenderingContext& ctx);
+
+	const GpuInstanceBuckets& getBuckets() const
+	{
+		return m_buckets;
+	}
+
+	/// Get it to set a dependency.
+	BufferHandle getIndirectArgsBuffer() const
+	{
+		return m_runCtx.m_argsBuffHandle;
+	}
+
+	/// Get it to set a dependency.
+	BufferHandle getInstanceRemapBuffer() const
+	{
+		return m_runCtx.m_remapBuffHandle;
+	}
+
+private:
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+	GpuInstanceBuckets m_buckets;
+
+	class
+	{
+	public:
+		RenderingContext* m_ctx = nullptr;
+		BufferHandle m_argsBuffHandle;
+		BufferHandle m_remapBuffHandle;
+		Bool m_occlusionCulling = false;
+	} m_runCtx;
+
+	ANKI_USE_RESULT Error initInternal(const ConfigSet& cfg);
+
+	void run(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
+};
+/// @}
+
+} // end namespace anki
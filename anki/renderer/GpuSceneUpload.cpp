@@ -0,0 +1,96 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/GpuSceneUpload.h>
+#include <anki/renderer/Renderer.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+GpuSceneUpload::~GpuSceneUpload()
+{
+}
+
+Error GpuSceneUpload::init(const ConfigSet& cfg)
+{
+	ANKI_R_LOGI("Initializing GPU scene upload");
+
+	const Error err = initInternal(cfg);
+	if(err)
+	{
+		ANKI_R_LOGE("Failed to initialize GPU scene upload");
+	}
+
+	return err;
+}
+
+Error GpuSceneUpload::initInternal(const ConfigSet& cfg)
+{
+	ANKI_CHECK(getResourceManager().loadResource("shaders/GpuSceneUpload.ankiprog", m_prog));
+
+	const ShaderProgramResourceVariant* variant;
+	m_prog->getOrCreateVariant(variant);
+	m_grProg = variant->getProgram();
+
+	return Error::NONE;
+}
+
+void GpuSceneUpload::populateRenderGraph(RenderingContext& ctx)
+{
+	m_runCtx.m_ctx = &ctx;
+	const GpuSceneQueueElement& el = ctx.m_renderQueue->m_gpuScene;
+
+	m_runCtx.m_buff.reset(el.m_buffer);
+	if(!m_runCtx.m_buff.isCreated())
+	{
+		return;
+	}
+
+	// The last frame's draws were the last to touch it
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+	m_runCtx.m_buffHandle = rgraph.importBuffer(m_runCtx.m_buff, BufferUsageBit::STORAGE_GEOMETRY_READ);
+
+	if(el.m_updateCount == 0)
+	{
+		return;
+	}
+
+	ComputeRenderPassDescription& rpass = rgraph.newComputeRenderPass("GPU scene upload");
+
+	rpass.setWork(
+		[](RenderPassWorkContext& rgraphCtx) {
+			GpuSceneUpload* const self = static_cast<GpuSceneUpload*>(rgraphCtx.m_userData);
+			self->run(*self->m_runCtx.m_ctx, rgraphCtx);
+		},
+		this, 0);
+
+	rpass.newDependency({m_runCtx.m_buffHandle, BufferUsageBit::STORAGE_COMPUTE_WRITE});
+}
+
+void GpuSceneUpload::run(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_GPU_SCENE_UPLOAD);
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const GpuSceneQueueElement& el = ctx.m_renderQueue->m_gpuScene;
+	ANKI_ASSERT(el.m_updateCount > 0);
+
+	cmdb->bindShaderProgram(m_grProg);
+
+	GpuSceneUpdate* updates =
+		allocateAndBindStorage<GpuSceneUpdate*>(sizeof(GpuSceneUpdate) * el.m_updateCount, cmdb, 0, 0);
+	memcpy(updates, el.m_updates, sizeof(GpuSceneUpdate) * el.m_updateCount);
+
+	cmdb->bindStorageBuffer(0, 1, m_runCtx.m_buff, 0, MAX_PTR_SIZE);
+
+	const UVec4 pc(el.m_updateCount, 0, 0, 0);
+	cmdb->setPushConstants(&pc, sizeof(pc));
+
+	const U32 workgroupSize = 64;
+	cmdb->dispatchCompute((el.m_updateCount + workgroupSize - 1) / workgroupSize, 1, 1);
+}
+
+} // end namespace anki
@@ -0,0 +1,66 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/RendererObject.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// Scatters the GPU scene changes of the render queue to the persistent GPU scene buffer. It runs before anything
+/// that draws renderables.
+class GpuSceneUpload : public RendererObject
+{
+public:
+	GpuSceneUpload(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~GpuSceneUpload();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
+
+	/// Populate the rendergraph.
+	void populateRenderGraph(RenderingContext& ctx);
+
+	/// The buffer of the current frame. It might be invalid if the render queue has no GPU scene.
+	const BufferPtr& getBuffer() const
+	{
+		return m_runCtx.m_buff;
+	}
+
+	/// Passes that draw renderables should call this to wait for the upload.
+	void setDependencies(RenderPassDescriptionBase& pass) const
+	{
+		if(m_runCtx.m_buff.isCreated())
+		{
+			pass.newDependency({m_runCtx.m_buffHandle, BufferUsageBit::STORAGE_GEOMETRY_READ});
+		}
+	}
+
+private:
+	ShaderProgramResourcePtr m_prog;
+	ShaderProgramPtr m_grProg;
+
+	class
+	{
+	public:
+		RenderingContext* m_ctx = nullptr;
+		BufferPtr m_buff;
+		BufferHandle m_buffHandle;
+	} m_runCtx;
+
+	ANKI_USE_RESULT Error initInternal(const ConfigSet& cfg);
+
+	void run(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
+};
+/// @}
+
+} // end namespace anki
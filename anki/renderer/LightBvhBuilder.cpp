@@ -0,0 +1,302 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/LightBvhBuilder.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/util/ThreadHive.h>
+
+namespace anki
+{
+
+/// Don't split the lights (or the leaves) to tasks that have less than that.
+static const U32 MIN_LIGHTS_PER_TASK = 512;
+
+/// The bits of every coordinate of the Morton codes.
+static const U32 MORTON_BITS = 10;
+
+/// Spread the lower 10 bits of a number so there are 2 zero bits between them.
+static U32 spreadBits(U32 v)
+{
+	v = (v | (v << 16u)) & 0x030000FFu;
+	v = (v | (v << 8u)) & 0x0300F00Fu;
+	v = (v | (v << 4u)) & 0x030C30C3u;
+	v = (v | (v << 2u)) & 0x09249249u;
+	return v;
+}
+
+static F32 computeLightPower(const Vec3& diffuseColor)
+{
+	return max(0.0f, diffuseColor.dot(Vec3(0.2126f, 0.7152f, 0.0722f)));
+}
+
+/// An empty node has an inverted AABB so it doesn't grow the AABBs of its parents.
+static void initEmptyNode(LightBvhNode& node)
+{
+	node.m_aabbMin = Vec3(MAX_F32);
+	node.m_power = 0.0f;
+	node.m_aabbMax = Vec3(-MAX_F32);
+	node.m_padding0 = 0;
+}
+
+void LightBvhBuilder::init(ThreadHive& hive, StackAllocator<U8> alloc,
+						   ConstWeakArray<PointLightQueueElement> pointLights,
+						   ConstWeakArray<SpotLightQueueElement> spotLights, Bool shadowCastersOnly)
+{
+	m_hive = &hive;
+	m_alloc = alloc;
+	m_pointLights = pointLights;
+	m_spotLights = spotLights;
+	m_shadowCastersOnly = shadowCastersOnly;
+
+	// Split the input lights to chunks
+	const U32 inputLightCount = pointLights.getSize() + spotLights.getSize();
+	const U32 chunkCount =
+		min(max((inputLightCount + MIN_LIGHTS_PER_TASK - 1) / MIN_LIGHTS_PER_TASK, 1u), hive.getThreadCount());
+	const U32 inputLightsPerChunk = (inputLightCount + chunkCount - 1) / chunkCount;
+	m_chunks = WeakArray<Chunk>(alloc.newArray<Chunk>(chunkCount), chunkCount);
+	m_inputLights = WeakArray<LightBvhLight>(alloc.newArray<LightBvhLight>(max(inputLightCount, 1u)), inputLightCount);
+	for(U32 i = 0; i < chunkCount; ++i)
+	{
+		m_chunks[i].m_firstInputLight = min(i * inputLightsPerChunk, inputLightCount);
+		m_chunks[i].m_inputLightCount = min(inputLightsPerChunk, inputLightCount - m_chunks[i].m_firstInputLight);
+	}
+
+	runTasks(chunkCount, [](LightBvhBuilder& self, U32 taskIdx) { self.findChunkLights(taskIdx); });
+
+	// Gather the results of the chunks
+	m_lightCount = 0;
+	m_boundsMin = Vec3(MAX_F32);
+	m_boundsMax = Vec3(-MAX_F32);
+	for(Chunk& chunk : m_chunks)
+	{
+		chunk.m_firstLight = m_lightCount;
+		m_lightCount += chunk.m_lightCount;
+		m_boundsMin = m_boundsMin.min(chunk.m_boundsMin);
+		m_boundsMax = m_boundsMax.max(chunk.m_boundsMax);
+	}
+
+	m_leafCount = nextPowerOfTwo(max(m_lightCount, 1u));
+}
+
+void LightBvhBuilder::build(WeakArray<LightBvhNode> nodes, WeakArray<LightBvhLight> lights)
+{
+	ANKI_ASSERT(nodes.getSize() == getNodeCount());
+	ANKI_ASSERT(lights.getSize() == getLeafCount());
+	m_outNodes = nodes;
+	m_outLights = lights;
+
+	if(m_lightCount > 0)
+	{
+		// Compute the Morton codes of the lights
+		m_pairs = WeakArray<RadixSortPair>(m_alloc.newArray<RadixSortPair>(m_lightCount), m_lightCount);
+		WeakArray<RadixSortPair> scratch(m_alloc.newArray<RadixSortPair>(m_lightCount), m_lightCount);
+
+		runTasks(m_chunks.getSize(), [](LightBvhBuilder& self, U32 taskIdx) { self.computeChunkKeys(taskIdx); });
+
+		// Sort them
+		if(m_lightCount < MIN_LIGHTS_PER_TASK * 2)
+		{
+			m_sortedPairs = radixSort(m_pairs, scratch);
+		}
+		else
+		{
+			ThreadHiveSemaphore* sortedSemaphore;
+			radixSort(*m_hive, m_alloc, m_pairs, scratch, m_sortedPairs, sortedSemaphore);
+			m_hive->waitAllTasks();
+		}
+	}
+
+	// Split the tree to subtrees, one per task
+	U32 subtreeCount = 1;
+	m_subtreeDepth = 0;
+	while(subtreeCount * 2 <= m_hive->getThreadCount() && m_leafCount / (subtreeCount * 2) >= MIN_LIGHTS_PER_TASK)
+	{
+		subtreeCount *= 2;
+		++m_subtreeDepth;
+	}
+
+	m_treeDepth = 0;
+	while((1u << m_treeDepth) < m_leafCount)
+	{
+		++m_treeDepth;
+	}
+
+	// Build the subtrees and then the top of the tree
+	m_tmpNodes = WeakArray<LightBvhNode>(m_alloc.newArray<LightBvhNode>(getNodeCount()), getNodeCount());
+
+	runTasks(subtreeCount, [](LightBvhBuilder& self, U32 taskIdx) { self.buildSubtree(taskIdx); });
+
+	for(U32 depth = m_subtreeDepth; depth-- > 0;)
+	{
+		const U32 firstNode = (1u << depth) - 1;
+		for(U32 nodeIdx = firstNode; nodeIdx < firstNode + (1u << depth); ++nodeIdx)
+		{
+			buildInternalNode(nodeIdx);
+		}
+	}
+
+	const U32 topNodeCount = (1u << m_subtreeDepth) - 1;
+	if(topNodeCount > 0)
+	{
+		memcpy(&m_outNodes[0], &m_tmpNodes[0], sizeof(LightBvhNode) * topNodeCount);
+	}
+}
+
+void LightBvhBuilder::runTasks(U32 taskCount, TaskCallback callback)
+{
+	ANKI_ASSERT(taskCount > 0);
+	if(taskCount == 1)
+	{
+		callback(*this, 0);
+		return;
+	}
+
+	class TaskArgs
+	{
+	public:
+		LightBvhBuilder* m_builder;
+		TaskCallback m_callback;
+		U32 m_taskIdx;
+	};
+
+	TaskArgs* args = m_alloc.newArray<TaskArgs>(taskCount);
+	ThreadHiveTask* tasks = m_alloc.newArray<ThreadHiveTask>(taskCount);
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		args[i] = {this, callback, i};
+		tasks[i] = ANKI_THREAD_HIVE_TASK({ self->m_callback(*self->m_builder, self->m_taskIdx); }, &args[i], nullptr,
+										 nullptr);
+	}
+
+	m_hive->submitTasks(tasks, taskCount);
+	m_hive->waitAllTasks();
+}
+
+Bool LightBvhBuilder::getInputLight(U32 inputLightIdx, LightBvhLight& light) const
+{
+	Bool hasShadow;
+	U32 shadowLayer;
+	if(inputLightIdx < m_pointLights.getSize())
+	{
+		const PointLightQueueElement& pointLight = m_pointLights[inputLightIdx];
+		hasShadow = pointLight.hasShadow();
+		shadowLayer = pointLight.m_shadowLayer;
+		light.m_position = pointLight.m_worldPosition;
+		light.m_radius = pointLight.m_radius;
+		light.m_power = computeLightPower(pointLight.m_diffuseColor);
+	}
+	else
+	{
+		const SpotLightQueueElement& spotLight = m_spotLights[inputLightIdx - m_pointLights.getSize()];
+		hasShadow = spotLight.hasShadow();
+		shadowLayer = spotLight.m_shadowLayer;
+		light.m_position = spotLight.m_worldTransform.getTranslationPart().xyz();
+		light.m_radius = spotLight.m_distance; // The cone is inside that sphere
+		light.m_power = computeLightPower(spotLight.m_diffuseColor);
+	}
+
+	light.m_shadowLayer = (hasShadow) ? shadowLayer : MAX_U32;
+	light.m_padding0 = 0;
+	light.m_padding1 = 0;
+	return hasShadow || !m_shadowCastersOnly;
+}
+
+void LightBvhBuilder::findChunkLights(U32 chunkIdx)
+{
+	Chunk& chunk = m_chunks[chunkIdx];
+	chunk.m_lightCount = 0;
+	chunk.m_boundsMin = Vec3(MAX_F32);
+	chunk.m_boundsMax = Vec3(-MAX_F32);
+
+	for(U32 i = chunk.m_firstInputLight; i < chunk.m_firstInputLight + chunk.m_inputLightCount; ++i)
+	{
+		LightBvhLight& light = m_inputLights[chunk.m_firstInputLight + chunk.m_lightCount];
+		if(getInputLight(i, light))
+		{
+			++chunk.m_lightCount;
+			chunk.m_boundsMin = chunk.m_boundsMin.min(light.m_position);
+			chunk.m_boundsMax = chunk.m_boundsMax.max(light.m_position);
+		}
+	}
+}
+
+void LightBvhBuilder::computeChunkKeys(U32 chunkIdx)
+{
+	const Chunk& chunk = m_chunks[chunkIdx];
+	const Vec3 scale = Vec3(F32((1u << MORTON_BITS) - 1)) / (m_boundsMax - m_boundsMin).max(EPSILON);
+
+	for(U32 i = 0; i < chunk.m_lightCount; ++i)
+	{
+		const LightBvhLight& light = m_inputLights[chunk.m_firstInputLight + i];
+		const Vec3 cell = (light.m_position - m_boundsMin) * scale;
+
+		RadixSortPair& pair = m_pairs[chunk.m_firstLight + i];
+		pair.m_key = (spreadBits(U32(cell.x())) << 2u) | (spreadBits(U32(cell.y())) << 1u) | spreadBits(U32(cell.z()));
+		pair.m_index = chunk.m_firstInputLight + i;
+		pair.m_padding = 0;
+	}
+}
+
+void LightBvhBuilder::buildSubtree(U32 subtreeIdx)
+{
+	// Leaves
+	const U32 subtreeLeafCount = m_leafCount >> m_subtreeDepth;
+	const U32 firstLeaf = subtreeIdx * subtreeLeafCount;
+	for(U32 leafIdx = firstLeaf; leafIdx < firstLeaf + subtreeLeafCount; ++leafIdx)
+	{
+		LightBvhNode& node = m_tmpNodes[m_leafCount - 1 + leafIdx];
+		LightBvhLight& outLight = m_outLights[leafIdx];
+
+		if(leafIdx < m_lightCount)
+		{
+			const LightBvhLight& light = m_inputLights[m_sortedPairs[leafIdx].m_index];
+			outLight = light;
+
+			node.m_aabbMin = light.m_position - light.m_radius;
+			node.m_power = light.m_power;
+			node.m_aabbMax = light.m_position + light.m_radius;
+			node.m_padding0 = 0;
+		}
+		else
+		{
+			zeroMemory(outLight);
+			outLight.m_shadowLayer = MAX_U32;
+			initEmptyNode(node);
+		}
+	}
+
+	// Internal nodes, bottom up
+	for(U32 depth = m_treeDepth; depth-- > m_subtreeDepth;)
+	{
+		const U32 levelNodeCount = 1u << (depth - m_subtreeDepth);
+		const U32 firstNode = (1u << depth) - 1 + subtreeIdx * levelNodeCount;
+		for(U32 nodeIdx = firstNode; nodeIdx < firstNode + levelNodeCount; ++nodeIdx)
+		{
+			buildInternalNode(nodeIdx);
+		}
+	}
+
+	// Copy the subtree to the output
+	for(U32 depth = m_subtreeDepth; depth <= m_treeDepth; ++depth)
+	{
+		const U32 levelNodeCount = 1u << (depth - m_subtreeDepth);
+		const U32 firstNode = (1u << depth) - 1 + subtreeIdx * levelNodeCount;
+		memcpy(&m_outNodes[firstNode], &m_tmpNodes[firstNode], sizeof(LightBvhNode) * levelNodeCount);
+	}
+}
+
+void LightBvhBuilder::buildInternalNode(U32 nodeIdx)
+{
+	const LightBvhNode& left = m_tmpNodes[nodeIdx * 2 + 1];
+	const LightBvhNode& right = m_tmpNodes[nodeIdx * 2 + 2];
+	LightBvhNode& node = m_tmpNodes[nodeIdx];
+
+	node.m_aabbMin = left.m_aabbMin.min(right.m_aabbMin);
+	node.m_power = left.m_power + right.m_power;
+	node.m_aabbMax = left.m_aabbMax.max(right.m_aabbMax);
+	node.m_padding0 = 0;
+}
+
+} // end namespace anki
@@ -0,0 +1,115 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/Common.h>
+#include <anki/Math.h>
+#include <anki/util/RadixSort.h>
+#include <anki/shaders/include/LightBvhTypes.h>
+
+namespace anki
+{
+
+// Forward
+class ThreadHive;
+
+/// @addtogroup renderer
+/// @{
+
+/// Builds a BVH of point and spot lights every frame. The GPU walks it to pick a few lights with probability
+/// proportional to their importance at a point (see computeLightBvhNodeImportance()) instead of visiting all the
+/// lights that touch the point. The leaves are sorted on the Morton code of the lights so lights that are close end up
+/// in the same subtrees. The work is split to ThreadHive tasks.
+class LightBvhBuilder
+{
+public:
+	/// Gather the lights and compute their bounds.
+	/// @param hive The hive to run the tasks. The tasks are waited before the functions return.
+	/// @param alloc Temporary memory. Nothing is freed so it should be a frame allocator.
+	/// @param pointLights The point lights.
+	/// @param spotLights The spot lights.
+	/// @param shadowCastersOnly Skip the lights without shadows.
+	void init(ThreadHive& hive, StackAllocator<U8> alloc, ConstWeakArray<PointLightQueueElement> pointLights,
+			  ConstWeakArray<SpotLightQueueElement> spotLights, Bool shadowCastersOnly);
+
+	/// Build the tree.
+	/// @param[out] nodes An array of getNodeCount() nodes. It's only written so it can be GPU visible memory.
+	/// @param[out] lights An array of getLeafCount() lights. The extra lights have zero power. Same as nodes.
+	void build(WeakArray<LightBvhNode> nodes, WeakArray<LightBvhLight> lights);
+
+	/// The number of lights that are in the tree.
+	U32 getLightCount() const
+	{
+		return m_lightCount;
+	}
+
+	/// The tree is complete so the leaves are the next power of two of the light count.
+	U32 getLeafCount() const
+	{
+		return m_leafCount;
+	}
+
+	U32 getNodeCount() const
+	{
+		return m_leafCount * 2 - 1;
+	}
+
+private:
+	/// A range of the input lights that a task processes.
+	class Chunk
+	{
+	public:
+		U32 m_firstInputLight;
+		U32 m_inputLightCount;
+		U32 m_firstLight; ///< The first light of the chunk if the lights of all chunks were packed.
+		U32 m_lightCount; ///< The lights of the chunk that are in the tree.
+		Vec3 m_boundsMin;
+		Vec3 m_boundsMax;
+	};
+
+	ThreadHive* m_hive = nullptr;
+	StackAllocator<U8> m_alloc;
+	ConstWeakArray<PointLightQueueElement> m_pointLights;
+	ConstWeakArray<SpotLightQueueElement> m_spotLights;
+	Bool m_shadowCastersOnly = false;
+
+	WeakArray<Chunk> m_chunks;
+	/// The lights in the input order. The lights of every chunk are packed at the start of its range.
+	WeakArray<LightBvhLight> m_inputLights;
+	U32 m_lightCount = 0;
+	U32 m_leafCount = 1;
+	Vec3 m_boundsMin = Vec3(0.0f);
+	Vec3 m_boundsMax = Vec3(0.0f);
+
+	/// @name Build state
+	/// @{
+	WeakArray<RadixSortPair> m_pairs;
+	WeakArray<RadixSortPair> m_sortedPairs;
+	WeakArray<LightBvhNode> m_tmpNodes; ///< The nodes are read while building so they are built in CPU memory.
+	WeakArray<LightBvhNode> m_outNodes;
+	WeakArray<LightBvhLight> m_outLights;
+	U32 m_treeDepth = 0; ///< The depth of the leaves.
+	U32 m_subtreeDepth = 0; ///< The depth of the roots of the subtrees that are built in parallel.
+	/// @}
+
+	using TaskCallback = void (*)(LightBvhBuilder& self, U32 taskIdx);
+
+	/// Run a number of tasks in the hive and wait for them. Run them in this thread if it's only one.
+	void runTasks(U32 taskCount, TaskCallback callback);
+
+	/// Get an input light. Returns false if it's not going to be in the tree.
+	Bool getInputLight(U32 inputLightIdx, LightBvhLight& light) const;
+
+	void findChunkLights(U32 chunkIdx);
+	void computeChunkKeys(U32 chunkIdx);
+	void buildSubtree(U32 subtreeIdx);
+
+	/// Compute a node from its children.
+	void buildInternalNode(U32 nodeIdx);
+};
+/// @}
+
+} // end namespace anki
@@ -8,6 +8,7 @@
 #include <anki/renderer/FinalComposite.h>
 #include <anki/renderer/GBuffer.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/GpuSceneUpload.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
 #include <anki/resource/MeshResource.h>
@@ -246,10 +247,14 @@ void ProbeReflections::prepareProbes(RenderingContext& ctx, ReflectionProbeQueue
 	// - Find a probe to update this frame
 	// - Find a probe to update next frame
 	// - Find the cache entries for each probe
+	ProbeUpdateScheduler& scheduler = m_r->getProbeUpdateScheduler();
 	DynamicArray<ReflectionProbeQueueElement> newListOfProbes;
 	newListOfProbes.create(ctx.m_tempAllocator, ctx.m_renderQueue->m_reflectionProbes.getSize());
 	U32 newListOfProbeCount = 0;
-	Bool foundProbeToUpdateNextFrame = false;
+	ReflectionProbeQueueElement* probeToUpdateNextFrame = nullptr;
+	F32 probeToUpdateNextFramePriority = 0.0f;
+	Bool probeToUpdateNextFrameMandatory = false;
+	ProbeUpdateState probeToUpdateNextFrameState;
 	for(U32 probeIdx = 0; probeIdx < ctx.m_renderQueue->m_reflectionProbes.getSize(); ++probeIdx)
 	{
 		ReflectionProbeQueueElement& probe = ctx.m_renderQueue->m_reflectionProbes[probeIdx];
@@ -265,53 +270,74 @@ void ProbeReflections::prepareProbes(RenderingContext& ctx, ReflectionProbeQueue
 			continue;
 		}
 
-		const Bool probeFoundInCache = m_cacheEntries[cacheEntryIdx].m_uuid == probe.m_uuid;
+		CacheEntry& entry = m_cacheEntries[cacheEntryIdx];
+		const Bool probeFoundInCache = entry.m_uuid == probe.m_uuid;
 
-		// Check if we _should_ and _can_ update the probe
-		const Bool needsUpdate = !probeFoundInCache;
-		if(ANKI_UNLIKELY(needsUpdate))
-		{
-			const Bool canUpdateThisFrame = probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr;
-			const Bool canUpdateNextFrame = !foundProbeToUpdateNextFrame;
+		// The render queues are there only if the probe was scheduled for an update last frame
+		const Bool updateThisFrame = probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr;
 
-			if(!canUpdateThisFrame && canUpdateNextFrame)
-			{
-				// Probe will be updated next frame
-				foundProbeToUpdateNextFrame = true;
-				probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData);
-				continue;
-			}
-			else if(!canUpdateThisFrame)
+		// Check if the probe _should_ be updated next frame
+		const Bool mandatoryUpdate = !probeFoundInCache;
+		if(!updateThisFrame)
+		{
+			if(probeFoundInCache)
 			{
-				// Can't be updated this frame so remove it from the list
-				continue;
+				scheduler.trackMotion(probe.m_aabbMin, probe.m_aabbMax, entry.m_updateState);
 			}
-			else
+
+			// If it's not in the cache the entry belongs to some other probe
+			const ProbeUpdateState state = (probeFoundInCache) ? entry.m_updateState : ProbeUpdateState();
+
+			const F32 priority = scheduler.computePriority(probe.m_aabbMin, probe.m_aabbMax, state, mandatoryUpdate);
+			if(priority > probeToUpdateNextFramePriority)
 			{
-				// Can be updated this frame so continue with it
-				probeToUpdateThisFrameCacheEntryIdx = cacheEntryIdx;
-				probeToUpdateThisFrame = &newListOfProbes[newListOfProbeCount];
+				probeToUpdateNextFrame = &probe;
+				probeToUpdateNextFramePriority = priority;
+				probeToUpdateNextFrameMandatory = mandatoryUpdate;
+				probeToUpdateNextFrameState = state;
 			}
 		}
 
+		if(!probeFoundInCache && !updateThisFrame)
+		{
+			// Can't be updated this frame so remove it from the list
+			continue;
+		}
+
 		// All good, can use this probe in this frame
 
 		// Update the cache entry
-		m_cacheEntries[cacheEntryIdx].m_uuid = probe.m_uuid;
-		m_cacheEntries[cacheEntryIdx].m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+		if(!probeFoundInCache)
+		{
+			entry.m_uuid = probe.m_uuid;
+			entry.m_updateState = ProbeUpdateState();
+			m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
+		}
+
+		entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
 
 		// Update the probe
 		probe.m_textureArrayIndex = cacheEntryIdx;
 
-		// Push the probe to the new list
-		newListOfProbes[newListOfProbeCount++] = probe;
-
-		// Update cache map
-		if(!probeFoundInCache)
+		if(updateThisFrame)
 		{
-			m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
+			probeToUpdateThisFrameCacheEntryIdx = cacheEntryIdx;
+			probeToUpdateThisFrame = &newListOfProbes[newListOfProbeCount];
+
+			const U32 cost = ProbeUpdateScheduler::estimateUpdateCost(probe.m_renderQueues);
+			scheduler.consumeBudget(entry.m_updateState, cost);
+			ANKI_TRACE_INC_COUNTER(R_PROBE_UPDATES, 1);
+			ANKI_TRACE_INC_COUNTER(R_PROBE_UPDATE_COST, cost);
+			if(!mandatoryUpdate)
+			{
+				ANKI_TRACE_INC_COUNTER(R_PROBE_REFRESHES, 1);
+			}
+			scheduler.markUpdated(entry.m_updateState);
 		}
 
+		// Push the probe to the new list
+		newListOfProbes[newListOfProbeCount++] = probe;
+
 		// Don't gather renderables next frame
 		if(probe.m_renderQueues[0] != nullptr)
 		{
@@ -319,6 +345,12 @@ void ProbeReflections::prepareProbes(RenderingContext& ctx, ReflectionProbeQueue
 		}
 	}
 
+	// Gather the renderables of a probe next frame if there is enough budget. Otherwise wait for the budget to build up
+	if(probeToUpdateNextFrame && scheduler.canAfford(probeToUpdateNextFrameState, probeToUpdateNextFrameMandatory))
+	{
+		probeToUpdateNextFrame->m_feedbackCallback(true, probeToUpdateNextFrame->m_feedbackCallbackUserData);
+	}
+
 	// Replace the probe list in the queue
 	if(newListOfProbeCount > 0)
 	{
@@ -340,35 +372,27 @@ void ProbeReflections::runGBuffer(RenderPassWorkContext& rgraphCtx)
 	ANKI_TRACE_SCOPED_EVENT(R_CUBE_REFL);
 	const ReflectionProbeQueueElement& probe = *m_ctx.m_probe;
 	const CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const U32 skippedDrawcallCount = cmdb->getSkippedDrawcallCount();
 
-	I32 start, end;
-	U32 startu, endu;
-	splitThreadedProblem(rgraphCtx.m_currentSecondLevelCommandBufferIndex, rgraphCtx.m_secondLevelCommandBufferCount,
-						 m_ctx.m_gbufferRenderableCount, startu, endu);
-	start = I32(startu);
-	end = I32(endu);
-
-	I32 drawcallCount = 0;
-	for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+	for(const DrawWorkSplit::Range& range :
+		m_ctx.m_gbufferWorkSplit.getTaskRanges(rgraphCtx.m_currentSecondLevelCommandBufferIndex))
 	{
-		const I32 faceDrawcallCount = I32(probe.m_renderQueues[faceIdx]->m_renderables.getSize());
-		const I32 localStart = max(I32(0), start - drawcallCount);
-		const I32 localEnd = min(faceDrawcallCount, end - drawcallCount);
+		const U32 faceIdx = range.m_arrayIdx;
+		const U32 viewportX = faceIdx * m_gbuffer.m_tileSize;
+		cmdb->setViewport(viewportX, 0, m_gbuffer.m_tileSize, m_gbuffer.m_tileSize);
+		cmdb->setScissor(viewportX, 0, m_gbuffer.m_tileSize, m_gbuffer.m_tileSize);
+
+		const RenderQueue& rqueue = *probe.m_renderQueues[faceIdx];
+		const RenderableQueueElement* begin = rqueue.m_renderables.getBegin() + range.m_firstRenderable;
+		m_r->getSceneDrawer().drawRange(Pass::GB, rqueue.m_viewMatrix, rqueue.m_viewProjectionMatrix,
+										Mat4::getIdentity(), // Don't care about prev mats
+										cmdb, m_r->getSamplers().m_trilinearRepeat, begin,
+										begin + range.m_renderableCount, MAX_LOD_COUNT - 1);
+	}
 
-		if(localStart < localEnd)
-		{
-			const U32 viewportX = faceIdx * m_gbuffer.m_tileSize;
-			cmdb->setViewport(viewportX, 0, m_gbuffer.m_tileSize, m_gbuffer.m_tileSize);
-			cmdb->setScissor(viewportX, 0, m_gbuffer.m_tileSize, m_gbuffer.m_tileSize);
-
-			const RenderQueue& rqueue = *probe.m_renderQueues[faceIdx];
-			ANKI_ASSERT(localStart >= 0 && localEnd <= faceDrawcallCount);
-			m_r->getSceneDrawer().drawRange(Pass::GB, rqueue.m_viewMatrix, rqueue.m_viewProjectionMatrix,
-											Mat4::getIdentity(), // Don't care about prev mats
-											cmdb, m_r->getSamplers().m_trilinearRepeat,
-											rqueue.m_renderables.getBegin() + localStart,
-											rqueue.m_renderables.getBegin() + localEnd, MAX_LOD_COUNT - 1);
-		}
+	if(cmdb->getSkippedDrawcallCount() != skippedDrawcallCount)
+	{
+		m_drawcallsSkipped.store(true);
 	}
 
 	// Restore state
@@ -424,7 +448,13 @@ void ProbeReflections::runLightShading(U32 faceIdx, RenderPassWorkContext& rgrap
 	dsInfo.m_pointLights = rqueue.m_pointLights;
 	dsInfo.m_spotLights = rqueue.m_spotLights;
 	dsInfo.m_commandBuffer = cmdb;
+
+	const U32 skippedDrawcallCount = cmdb->getSkippedDrawcallCount();
 	m_lightShading.m_deferred.drawLights(dsInfo);
+	if(cmdb->getSkippedDrawcallCount() != skippedDrawcallCount)
+	{
+		m_drawcallsSkipped.store(true);
+	}
 }
 
 void ProbeReflections::runMipmappingOfLightShading(U32 faceIdx, RenderPassWorkContext& rgraphCtx)
@@ -542,13 +572,16 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 		}
 		m_ctx.m_gbufferDepthRt = rgraph.newRenderTarget(m_gbuffer.m_depthRtDescr);
 
-		// Compute task count
-		m_ctx.m_gbufferRenderableCount = 0;
+		// Split the drawcalls of the faces to tasks
+		Array<ConstWeakArray<RenderableQueueElement>, 6> renderables;
+		U32 renderableCount = 0;
 		for(U32 i = 0; i < 6; ++i)
 		{
-			m_ctx.m_gbufferRenderableCount += probeToUpdate->m_renderQueues[i]->m_renderables.getSize();
+			renderables[i] = probeToUpdate->m_renderQueues[i]->m_renderables;
+			renderableCount += renderables[i].getSize();
 		}
-		const U32 taskCount = computeNumberOfSecondLevelCommandBuffers(m_ctx.m_gbufferRenderableCount);
+		const U32 taskCount = computeNumberOfSecondLevelCommandBuffers(renderableCount);
+		m_ctx.m_gbufferWorkSplit.init(rctx.m_tempAllocator, renderables, taskCount);
 
 		// Pass
 		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("CubeRefl gbuff");
@@ -566,6 +599,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({m_ctx.m_gbufferDepthRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+		m_r->getGpuSceneUpload().setDependencies(pass);
 	}
 
 	// Shadow pass. Optional
@@ -589,14 +623,17 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 			lightMat = atlasMtx * lightMat;
 		}
 
-		// Compute task count
-		m_ctx.m_shadowRenderableCount = 0;
+		// Split the drawcalls of the faces to tasks
+		Array<ConstWeakArray<RenderableQueueElement>, 6> renderables;
+		U32 renderableCount = 0;
 		for(U32 i = 0; i < 6; ++i)
 		{
-			m_ctx.m_shadowRenderableCount +=
-				probeToUpdate->m_renderQueues[i]->m_directionalLight.m_shadowRenderQueues[0]->m_renderables.getSize();
+			renderables[i] =
+				probeToUpdate->m_renderQueues[i]->m_directionalLight.m_shadowRenderQueues[0]->m_renderables;
+			renderableCount += renderables[i].getSize();
 		}
-		const U32 taskCount = computeNumberOfSecondLevelCommandBuffers(m_ctx.m_shadowRenderableCount);
+		const U32 taskCount = computeNumberOfSecondLevelCommandBuffers(renderableCount);
+		m_ctx.m_shadowWorkSplit.init(rctx.m_tempAllocator, renderables, taskCount);
 
 		// RT
 		m_ctx.m_shadowMapRt = rgraph.newRenderTarget(m_shadowMapping.m_rtDescr);
@@ -612,6 +649,7 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
 		pass.newDependency({m_ctx.m_shadowMapRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+		m_r->getGpuSceneUpload().setDependencies(pass);
 	}
 	else
 	{
@@ -728,19 +766,14 @@ void ProbeReflections::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 	ANKI_ASSERT(m_ctx.m_probe);
 	ANKI_TRACE_SCOPED_EVENT(R_CUBE_REFL);
 
-	I32 start, end;
-	U32 startu, endu;
-	splitThreadedProblem(rgraphCtx.m_currentSecondLevelCommandBufferIndex, rgraphCtx.m_secondLevelCommandBufferCount,
-						 m_ctx.m_shadowRenderableCount, startu, endu);
-	start = I32(startu);
-	end = I32(endu);
-
 	const CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
 	cmdb->setPolygonOffset(1.0f, 1.0f);
+	const U32 skippedDrawcallCount = cmdb->getSkippedDrawcallCount();
 
-	I32 drawcallCount = 0;
-	for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+	for(const DrawWorkSplit::Range& range :
+		m_ctx.m_shadowWorkSplit.getTaskRanges(rgraphCtx.m_currentSecondLevelCommandBufferIndex))
 	{
+		const U32 faceIdx = range.m_arrayIdx;
 		ANKI_ASSERT(m_ctx.m_probe->m_renderQueues[faceIdx]);
 		const RenderQueue& faceRenderQueue = *m_ctx.m_probe->m_renderQueues[faceIdx];
 		ANKI_ASSERT(faceRenderQueue.m_directionalLight.m_uuid != 0);
@@ -748,24 +781,31 @@ void ProbeReflections::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 		ANKI_ASSERT(faceRenderQueue.m_directionalLight.m_shadowRenderQueues[0]);
 		const RenderQueue& cascadeRenderQueue = *faceRenderQueue.m_directionalLight.m_shadowRenderQueues[0];
 
-		const I32 faceDrawcallCount = I32(cascadeRenderQueue.m_renderables.getSize());
-		const I32 localStart = max(I32(0), start - drawcallCount);
-		const I32 localEnd = min(faceDrawcallCount, end - drawcallCount);
+		const U32 rez = m_shadowMapping.m_rtDescr.m_height;
+		cmdb->setViewport(rez * faceIdx, 0, rez, rez);
+		cmdb->setScissor(rez * faceIdx, 0, rez, rez);
 
-		if(localStart < localEnd)
-		{
-			const U32 rez = m_shadowMapping.m_rtDescr.m_height;
-			cmdb->setViewport(rez * faceIdx, 0, rez, rez);
-			cmdb->setScissor(rez * faceIdx, 0, rez, rez);
-
-			ANKI_ASSERT(localStart >= 0 && localEnd <= faceDrawcallCount);
-			m_r->getSceneDrawer().drawRange(Pass::SM, cascadeRenderQueue.m_viewMatrix,
-											cascadeRenderQueue.m_viewProjectionMatrix,
-											Mat4::getIdentity(), // Don't care about prev matrices here
-											cmdb, m_r->getSamplers().m_trilinearRepeatAniso,
-											cascadeRenderQueue.m_renderables.getBegin() + localStart,
-											cascadeRenderQueue.m_renderables.getBegin() + localEnd, MAX_LOD_COUNT - 1);
-		}
+		const RenderableQueueElement* begin = cascadeRenderQueue.m_renderables.getBegin() + range.m_firstRenderable;
+		m_r->getSceneDrawer().drawRange(Pass::SM, cascadeRenderQueue.m_viewMatrix,
+										cascadeRenderQueue.m_viewProjectionMatrix,
+										Mat4::getIdentity(), // Don't care about prev matrices here
+										cmdb, m_r->getSamplers().m_trilinearRepeatAniso, begin,
+										begin + range.m_renderableCount, MAX_LOD_COUNT - 1);
+	}
+
+	if(cmdb->getSkippedDrawcallCount() != skippedDrawcallCount)
+	{
+		m_drawcallsSkipped.store(true);
+	}
+}
+
+void ProbeReflections::finalize()
+{
+	if(m_drawcallsSkipped.exchange(false))
+	{
+		// The probe is incomplete. Drop it from the cache so it's rendered again before it's used
+		ANKI_ASSERT(m_ctx.m_cacheEntryIdx < m_cacheEntries.getSize());
+		m_cacheEntries[m_ctx.m_cacheEntryIdx].m_uuid = 0;
 	}
 }
 
@@ -9,6 +9,7 @@
 #include <anki/renderer/RendererObject.h>
 #include <anki/renderer/TraditionalDeferredShading.h>
 #include <anki/renderer/ClusterBin.h>
+#include <anki/renderer/DrawWorkSplit.h>
 #include <anki/resource/TextureResource.h>
 
 namespace anki
@@ -32,6 +33,9 @@ public:
 	/// Populate the rendergraph.
 	void populateRenderGraph(RenderingContext& ctx);
 
+	/// Call it after the rendergraph is recorded.
+	void finalize();
+
 	U getReflectionTextureMipmapCount() const
 	{
 		return m_lightShading.m_mipCount;
@@ -106,6 +110,7 @@ private:
 	public:
 		U64 m_uuid; ///< Probe UUID.
 		Timestamp m_lastUsedTimestamp = 0; ///< When it was last seen by the renderer.
+		ProbeUpdateState m_updateState;
 
 		Array<FramebufferDescription, 6> m_lightShadingFbDescrs;
 	};
@@ -129,10 +134,13 @@ private:
 		BufferHandle m_irradianceDiceValuesBuffHandle;
 		RenderTargetHandle m_shadowMapRt;
 
-		U32 m_gbufferRenderableCount = 0;
-		U32 m_shadowRenderableCount = 0;
+		DrawWorkSplit m_gbufferWorkSplit;
+		DrawWorkSplit m_shadowWorkSplit;
 	} m_ctx; ///< Runtime context.
 
+	/// Some drawcalls of the probe were not recorded because their pipelines were not ready.
+	Atomic<Bool> m_drawcallsSkipped = {false};
+
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& cfg);
 	ANKI_USE_RESULT Error initGBuffer(const ConfigSet& cfg);
 	ANKI_USE_RESULT Error initLightShading(const ConfigSet& cfg);
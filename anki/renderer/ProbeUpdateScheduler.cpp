@@ -0,0 +1,131 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/ProbeUpdateScheduler.h>
+#include <anki/renderer/DrawWorkSplit.h>
+#include <anki/renderer/RenderQueue.h>
+
+namespace anki
+{
+
+/// The budget accumulates for that many frames at most.
+static const U32 MAX_BUDGET_FRAMES = 16;
+
+/// Every object that moves inside a probe ages it by that many frames.
+static const U32 MOVED_OBJECT_AGE = 8;
+
+/// Don't let very stale probes take over the probes that are close to the camera.
+static const F32 MAX_STALENESS = 16.0f;
+
+/// Mandatory updates are more important than any refresh.
+static const F32 MANDATORY_PRIORITY = 1000.0f;
+
+void ProbeUpdateScheduler::init(U32 budgetPerFrame, U32 refreshPeriod)
+{
+	m_budgetPerFrame = budgetPerFrame;
+	m_refreshPeriod = refreshPeriod;
+	m_maxBudget = I64(budgetPerFrame) * MAX_BUDGET_FRAMES;
+	m_budget = 0;
+}
+
+void ProbeUpdateScheduler::beginFrame(Timestamp crntTimestamp, const Vec3& cameraPos,
+									  ConstWeakArray<Vec3> movedObjectPositions)
+{
+	m_crntTimestamp = crntTimestamp;
+	m_cameraPos = cameraPos;
+	m_movedObjectPositions = movedObjectPositions;
+
+	m_budget = min(m_budget + I64(m_budgetPerFrame), m_maxBudget);
+}
+
+void ProbeUpdateScheduler::trackMotion(const Vec3& aabbMin, const Vec3& aabbMax, ProbeUpdateState& state) const
+{
+	for(const Vec3& pos : m_movedObjectPositions)
+	{
+		if(pos >= aabbMin && pos <= aabbMax)
+		{
+			++state.m_movedObjectCount;
+		}
+	}
+}
+
+F32 ProbeUpdateScheduler::computePriority(const Vec3& aabbMin, const Vec3& aabbMax, const ProbeUpdateState& state,
+										  Bool mandatory) const
+{
+	// Influence on the screen. 1.0 if the camera is inside the probe and it falls with the distance relative to the
+	// size of the probe
+	const Vec3 closestPoint = m_cameraPos.max(aabbMin).min(aabbMax);
+	const F32 distance = (closestPoint - m_cameraPos).getLength();
+	const F32 radius = (aabbMax - aabbMin).getLength() / 2.0f;
+	const F32 influence = radius / max(radius + distance, EPSILON);
+
+	if(mandatory)
+	{
+		// If the update already started (a half rendered GI probe) finish it before starting others
+		const F32 inProgress = (state.m_cost) ? 1.0f : 0.0f;
+		return MANDATORY_PRIORITY + inProgress + influence;
+	}
+
+	if(m_refreshPeriod == 0 || m_budgetPerFrame == 0)
+	{
+		return 0.0f;
+	}
+
+	// Staleness. The probe should be refreshed when it reaches 1.0
+	ANKI_ASSERT(state.m_lastUpdateTimestamp <= m_crntTimestamp);
+	const F32 age =
+		F32(m_crntTimestamp - state.m_lastUpdateTimestamp) + F32(state.m_movedObjectCount) * F32(MOVED_OBJECT_AGE);
+	const F32 staleness = min(age / F32(m_refreshPeriod), MAX_STALENESS);
+	if(staleness < 1.0f)
+	{
+		return 0.0f;
+	}
+
+	return influence * staleness;
+}
+
+Bool ProbeUpdateScheduler::canAfford(const ProbeUpdateState& state, Bool mandatory) const
+{
+	if(mandatory)
+	{
+		return true;
+	}
+
+	if(m_budgetPerFrame == 0)
+	{
+		return false;
+	}
+
+	// If the cost is not known assume that it's a frame's worth. If it's more than the max the update will happen when
+	// the budget is full
+	const I64 cost = (state.m_cost) ? I64(state.m_cost) : I64(m_budgetPerFrame);
+	return m_budget >= min(cost, m_maxBudget);
+}
+
+void ProbeUpdateScheduler::consumeBudget(ProbeUpdateState& state, U32 cost)
+{
+	state.m_cost = cost;
+	m_budget -= cost;
+}
+
+U32 ProbeUpdateScheduler::estimateUpdateCost(const Array<RenderQueue*, 6>& faceRenderQueues)
+{
+	U64 cost = 0;
+	for(const RenderQueue* rqueue : faceRenderQueues)
+	{
+		ANKI_ASSERT(rqueue);
+		cost += FACE_COST + DrawWorkSplit::estimateCost(rqueue->m_renderables);
+
+		const DirectionalLightQueueElement& dirLight = rqueue->m_directionalLight;
+		if(dirLight.m_uuid && dirLight.m_shadowCascadeCount > 0)
+		{
+			cost += DrawWorkSplit::estimateCost(dirLight.m_shadowRenderQueues[0]->m_renderables);
+		}
+	}
+
+	return U32(min<U64>(cost, MAX_U32));
+}
+
+} // end namespace anki
@@ -0,0 +1,88 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/Common.h>
+#include <anki/Math.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// The update state of a probe. The renderers keep it in their cache entries.
+class ProbeUpdateState
+{
+public:
+	Timestamp m_lastUpdateTimestamp = 0; ///< When the probe was last fully updated. Zero if it was never updated.
+	U32 m_movedObjectCount = 0; ///< Objects that moved inside the probe since the last update.
+	U32 m_cost = 0; ///< The estimated cost of the last update. Zero if it's not known.
+};
+
+/// Decides which probes (reflection or GI) get updated and when. Probes that were never rendered are always updated
+/// first. The rest are refreshed when they become stale, either because of time or because objects moved inside
+/// them, and only if there is enough budget. The budget is a number of estimated cost units per frame that
+/// accumulates up to a limit so expensive updates can be amortized over a few frames.
+class ProbeUpdateScheduler
+{
+public:
+	/// The cost of a face of a probe or a cell of a GI probe excluding the cost of drawing the renderables.
+	static constexpr U32 FACE_COST = 32;
+
+	/// @param budgetPerFrame Cost units per frame. Zero disables the refreshes.
+	/// @param refreshPeriod The frames after which a probe is refreshed. Zero disables the refreshes.
+	void init(U32 budgetPerFrame, U32 refreshPeriod);
+
+	/// Call it once per frame before any probe is scheduled.
+	/// @param crntTimestamp The current frame's timestamp.
+	/// @param cameraPos The position of the camera.
+	/// @param movedObjectPositions The positions of the objects that moved this frame.
+	void beginFrame(Timestamp crntTimestamp, const Vec3& cameraPos, ConstWeakArray<Vec3> movedObjectPositions);
+
+	/// Accumulate the objects that moved inside a probe this frame. Call it once per frame per visible probe.
+	void trackMotion(const Vec3& aabbMin, const Vec3& aabbMax, ProbeUpdateState& state) const;
+
+	/// Compute the priority of a probe update. Bigger is more important.
+	/// @param mandatory The probe can't be used until it's updated.
+	/// @return The priority or zero if the probe doesn't need an update.
+	F32 computePriority(const Vec3& aabbMin, const Vec3& aabbMax, const ProbeUpdateState& state,
+						Bool mandatory) const;
+
+	/// Check if there is enough budget for the update of a probe. Mandatory updates are always allowed.
+	Bool canAfford(const ProbeUpdateState& state, Bool mandatory) const;
+
+	/// Pay for an update that is recorded this frame. The budget can go negative and the debt is paid the next frames.
+	void consumeBudget(ProbeUpdateState& state, U32 cost);
+
+	/// Mark that the probe was fully updated this frame.
+	void markUpdated(ProbeUpdateState& state) const
+	{
+		state.m_lastUpdateTimestamp = m_crntTimestamp;
+		state.m_movedObjectCount = 0;
+	}
+
+	/// Estimate the cost of updating a probe (or a GI cell) using the render queues of its faces.
+	static U32 estimateUpdateCost(const Array<RenderQueue*, 6>& faceRenderQueues);
+
+	I64 getBudget() const
+	{
+		return m_budget;
+	}
+
+private:
+	U32 m_budgetPerFrame = 0;
+	U32 m_refreshPeriod = 0;
+	I64 m_budget = 0;
+	I64 m_maxBudget = 0;
+
+	Timestamp m_crntTimestamp = 0;
+	Vec3 m_cameraPos = Vec3(0.0f);
+	ConstWeakArray<Vec3> m_movedObjectPositions;
+};
+/// @}
+
+} // end namespace anki
@@ -10,6 +10,7 @@
 #include <anki/ui/Canvas.h>
 #include <anki/shaders/include/ClusteredShadingTypes.h>
 #include <anki/shaders/include/ModelTypes.h>
+#include <anki/shaders/include/GpuSceneTypes.h>
 
 namespace anki
 {
@@ -46,11 +47,38 @@ public:
 	StackAllocator<U8> m_frameAllocator;
 	Bool m_debugDraw; ///< If true the drawcall should be drawing some kind of debug mesh.
 	BitSet<U(RenderQueueDebugDrawFlag::COUNT), U32> m_debugDrawFlags = {false};
+
+	/// If not nullptr the instances are culled on the GPU and the callback should issue a single instanced indirect
+	/// draw. The m_key's instance count is 1. The callback fills the m_count, m_firstIndex and m_baseVertex of the draw
+	/// and the GPU fills the instance count. The instances read their GPU scene slots from the remap buffer. The per
+	/// instance uniforms are not used.
+	DrawElementsIndirectInfo* m_indirectArgs = nullptr;
+	BufferPtr m_indirectArgsBuffer;
+	PtrSize m_indirectArgsBufferOffset = 0;
+	BufferPtr m_instanceRemapBuffer;
+	PtrSize m_instanceRemapBufferOffset = 0;
+	PtrSize m_instanceRemapBufferRange = 0;
+
+	/// The GPU scene buffer. Holds a GpuSceneInstance per slot. Materials that read it get the slots as per instance
+	/// uniforms.
+	BufferPtr m_gpuSceneBuffer;
 };
 
 /// Draw callback for drawing.
 using RenderQueueDrawCallback = void (*)(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData);
 
+/// The changes of the persistent GPU scene buffer that the renderer should apply before drawing anything.
+class GpuSceneQueueElement final
+{
+public:
+	Buffer* m_buffer; ///< The buffer with a GpuSceneInstance per slot. The scene owns it.
+	const GpuSceneUpdate* m_updates;
+	U32 m_updateCount;
+};
+
+static_assert(std::is_trivially_destructible<GpuSceneQueueElement>::value == true,
+			  "Should be trivially destructible");
+
 /// Render queue element that contains info on items that populate the G-buffer or the forward shading buffer etc.
 class RenderableQueueElement final
 {
@@ -64,6 +92,14 @@ public:
 
 	F32 m_distanceFromCamera; ///< Don't set this
 
+	U64 m_sortKey; ///< Don't set this. The order of the renderables in their array.
+
+	Vec3 m_aabbMin; ///< Don't set this
+	Vec3 m_aabbMax; ///< Don't set this
+
+	/// The GPU scene slot if the renderable can be culled on the GPU. MAX_U32 otherwise.
+	U32 m_gpuSceneSlot;
+
 	RenderableQueueElement()
 	{
 	}
@@ -72,6 +108,12 @@ public:
 static_assert(std::is_trivially_destructible<RenderableQueueElement>::value == true,
 			  "Should be trivially destructible");
 
+/// Check if the drawcalls of two renderables can be merged.
+inline Bool canMergeRenderableQueueElements(const RenderableQueueElement& a, const RenderableQueueElement& b)
+{
+	return a.m_callback == b.m_callback && a.m_mergeKey != 0 && a.m_mergeKey == b.m_mergeKey;
+}
+
 /// Context that contains variables for the GenericGpuComputeJobQueueElement.
 class GenericGpuComputeJobQueueElementContext final : public RenderingMatrices
 {
@@ -392,9 +434,22 @@ public:
 	/// bugs.
 	RenderQueue* m_rayTracingQueue = nullptr;
 
+	/// Applies only to the main RenderQueue.
+	GpuSceneQueueElement m_gpuScene;
+
+	/// Applies only to the main RenderQueue. The world positions of the objects that moved or were animated this frame.
+	WeakArray<Vec3> m_movedObjectPositions;
+
 	/// Applies only if the RenderQueue holds shadow casters. It's the max timesamp of all shadow casters
 	Timestamp m_shadowRenderablesLastUpdateTimestamp = 0;
 
+	/// Applies only if the RenderQueue holds shadow casters. The first m_staticShadowRenderableCount of m_renderables
+	/// are casters that haven't moved for a while. The rest are the dynamic casters.
+	U32 m_staticShadowRenderableCount = 0;
+
+	/// Applies only if the RenderQueue holds shadow casters. It changes when the static casters or the light change.
+	Timestamp m_staticShadowRenderablesLastUpdateTimestamp = 0;
+
 	F32 m_cameraNear;
 	F32 m_cameraFar;
 	F32 m_cameraFovX;
@@ -407,6 +462,7 @@ public:
 	RenderQueue()
 	{
 		zeroMemory(m_directionalLight);
+		zeroMemory(m_gpuScene);
 	}
 
 	PtrSize countAllRenderables() const;
@@ -36,6 +36,8 @@
 #include <anki/renderer/ShadowmapsResolve.h>
 #include <anki/renderer/RtShadows.h>
 #include <anki/renderer/AccelerationStructureBuilder.h>
+#include <anki/renderer/GpuInstanceCulling.h>
+#include <anki/renderer/GpuSceneUpload.h>
 
 namespace anki
 {
@@ -95,6 +97,8 @@ Error Renderer::initInternal(const ConfigSet& config)
 	m_clusterCount[3] = m_clusterCount[0] * m_clusterCount[1] * m_clusterCount[2];
 
 	m_clusterBin.init(m_alloc, m_clusterCount[0], m_clusterCount[1], m_clusterCount[2], config);
+	m_probeUpdateScheduler.init(config.getNumberU32("r_probeUpdateBudget"),
+								config.getNumberU32("r_probeRefreshPeriod"));
 
 	// A few sanity checks
 	if(m_width < 10 || m_height < 10)
@@ -127,6 +131,9 @@ Error Renderer::initInternal(const ConfigSet& config)
 	ANKI_CHECK(m_resources->loadResource("shaders/ClearTextureCompute.ankiprog", m_clearTexComputeProg));
 
 	// Init the stages. Careful with the order!!!!!!!!!!
+	m_gpuSceneUpload.reset(m_alloc.newInstance<GpuSceneUpload>(this));
+	ANKI_CHECK(m_gpuSceneUpload->init(config));
+
 	m_genericCompute.reset(m_alloc.newInstance<GenericCompute>(this));
 	ANKI_CHECK(m_genericCompute->init(config));
 
@@ -139,6 +146,12 @@ Error Renderer::initInternal(const ConfigSet& config)
 	m_probeReflections.reset(m_alloc.newInstance<ProbeReflections>(this));
 	ANKI_CHECK(m_probeReflections->init(config));
 
+	if(config.getBool("r_gpuInstanceCulling"))
+	{
+		m_gpuInstanceCulling.reset(m_alloc.newInstance<GpuInstanceCulling>(this));
+		ANKI_CHECK(m_gpuInstanceCulling->init(config));
+	}
+
 	m_gbuffer.reset(m_alloc.newInstance<GBuffer>(this));
 	ANKI_CHECK(m_gbuffer->init(config));
 
@@ -303,7 +316,15 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	m_tonemapping->importRenderTargets(ctx);
 	m_depth->importRenderTargets(ctx);
 
+	// The objects that moved this frame will make the probes around them stale
+	{
+		const Vec3 cameraPos = ctx.m_renderQueue->m_cameraTransform.getTranslationPart().xyz();
+		m_probeUpdateScheduler.beginFrame(getGlobalTimestamp(), cameraPos, ctx.m_renderQueue->m_movedObjectPositions);
+		ANKI_TRACE_INC_COUNTER(R_PROBE_UPDATE_BUDGET, U64(max<I64>(m_probeUpdateScheduler.getBudget(), 0)));
+	}
+
 	// Populate render graph. WARNING Watch the order
+	m_gpuSceneUpload->populateRenderGraph(ctx);
 	m_genericCompute->populateRenderGraph(ctx);
 	if(m_accelerationStructureBuilder)
 	{
@@ -313,6 +334,10 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	m_gi->populateRenderGraph(ctx);
 	m_probeReflections->populateRenderGraph(ctx);
 	m_volLighting->populateRenderGraph(ctx);
+	if(m_gpuInstanceCulling)
+	{
+		m_gpuInstanceCulling->populateRenderGraph(ctx);
+	}
 	m_gbuffer->populateRenderGraph(ctx);
 	m_gbufferPost->populateRenderGraph(ctx);
 	m_depth->populateRenderGraph(ctx);
@@ -368,6 +393,11 @@ void Renderer::finalize(const RenderingContext& ctx)
 
 	m_prevMatrices = ctx.m_matrices;
 
+	// The caches re-render what had drawcalls skipped because of pipelines that were created in the background
+	m_shadowMapping->finalize();
+	m_gi->finalize();
+	m_probeReflections->finalize();
+
 	// Inform about the HiZ map. Do it as late as possible
 	if(ctx.m_renderQueue->m_fillCoverageBufferCallback)
 	{
@@ -8,6 +8,7 @@
 #include <anki/renderer/Common.h>
 #include <anki/renderer/Drawer.h>
 #include <anki/renderer/ClusterBin.h>
+#include <anki/renderer/ProbeUpdateScheduler.h>
 #include <anki/Math.h>
 #include <anki/Gr.h>
 #include <anki/resource/Forward.h>
@@ -210,6 +211,26 @@ public:
 		return m_rtShadows.isCreated();
 	}
 
+	GpuSceneUpload& getGpuSceneUpload()
+	{
+		return *m_gpuSceneUpload;
+	}
+
+	GpuInstanceCulling& getGpuInstanceCulling()
+	{
+		return *m_gpuInstanceCulling;
+	}
+
+	Bool getGpuInstanceCullingEnabled() const
+	{
+		return m_gpuInstanceCulling.isCreated();
+	}
+
+	ProbeUpdateScheduler& getProbeUpdateScheduler()
+	{
+		return m_probeUpdateScheduler;
+	}
+
 	Ssr& getSsr()
 	{
 		return *m_ssr;
@@ -294,6 +315,11 @@ public:
 		}
 	}
 
+	ConstWeakArray<F32> getLodDistances() const
+	{
+		return ConstWeakArray<F32>(&m_lodDistances[0], m_lodDistances.getSize());
+	}
+
 	/// Create the init info for a 2D texture that will be used as a render target.
 	ANKI_USE_RESULT TextureInitInfo create2DRenderTargetInitInfo(U32 w, U32 h, Format format, TextureUsageBit usage,
 																 CString name = {});
@@ -434,10 +460,13 @@ private:
 	UniquePtr<ShadowmapsResolve> m_smResolve;
 	UniquePtr<AccelerationStructureBuilder> m_accelerationStructureBuilder;
 	UniquePtr<RtShadows> m_rtShadows;
+	UniquePtr<GpuInstanceCulling> m_gpuInstanceCulling;
+	UniquePtr<GpuSceneUpload> m_gpuSceneUpload;
 	/// @}
 
 	Array<U32, 4> m_clusterCount;
 	ClusterBin m_clusterBin;
+	ProbeUpdateScheduler m_probeUpdateScheduler;
 
 	U32 m_width;
 	U32 m_height;
@@ -6,10 +6,11 @@
 #include <anki/renderer/RtShadows.h>
 #include <anki/renderer/GBuffer.h>
 #include <anki/renderer/Renderer.h>
-#include <anki/renderer/ShadowMapping.h>
 #include <anki/renderer/AccelerationStructureBuilder.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/LightBvhBuilder.h>
 #include <anki/resource/ShaderProgramResourceSystem.h>
+#include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
 
 namespace anki
@@ -75,6 +76,7 @@ Error RtShadows::initInternal(const ConfigSet& cfg)
 	m_renderRt.bake();
 
 	// Misc
+	m_lightSampling = cfg.getBool("r_rtShadowsLightSampling");
 	m_sbtRecordSize = getAlignedRoundUp(getGrManager().getDeviceCapabilities().m_sbtRecordAlignment, m_sbtRecordSize);
 
 	return Error::NONE;
@@ -202,13 +204,15 @@ void RtShadows::populateRenderGraph(RenderingContext& ctx)
 			}
 		}
 	}
+
+	// Build the BVH of the lights that got a layer. The rays are traced to a few lights picked from it
+	buildLightBvh();
 }
 
 void RtShadows::run(RenderPassWorkContext& rgraphCtx)
 {
 	const RenderingContext& ctx = *m_runCtx.m_ctx;
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
-	const ClusterBinOut& rsrc = ctx.m_clusterBinOut;
 
 	cmdb->bindShaderProgram(m_grProg);
 
@@ -229,21 +233,20 @@ void RtShadows::run(RenderPassWorkContext& rgraphCtx)
 
 	bindUniforms(cmdb, 0, 8, ctx.m_lightShadingUniformsToken);
 
-	bindUniforms(cmdb, 0, 9, rsrc.m_pointLightsToken);
-	bindUniforms(cmdb, 0, 10, rsrc.m_spotLightsToken);
-	rgraphCtx.bindColorTexture(0, 11, m_r->getShadowMapping().getShadowmapRt());
-
-	bindStorage(cmdb, 0, 12, rsrc.m_clustersToken);
-	bindStorage(cmdb, 0, 13, rsrc.m_indicesToken);
+	bindStorage(cmdb, 0, 9, m_runCtx.m_lightBvhNodesToken);
+	bindStorage(cmdb, 0, 10, m_runCtx.m_lightBvhLightsToken);
 
 	cmdb->bindAllBindless(1);
 
-	Array<F32, MAX_SHADOW_LAYERS> rejectFactors;
+	// The leaf count of the light BVH, a mask of the layers whose history is rejected and if the lights will be
+	// sampled. Sampling is pointless if the samples and the directional light are as many as the shadowed lights
+	const Bool sampleLights = m_lightSampling && m_runCtx.m_lightBvhLightCount > RT_SHADOWS_LIGHT_SAMPLE_COUNT + 1;
+	UVec4 pc(m_runCtx.m_lightBvhLeafCount, 0u, U32(sampleLights), 0u);
 	for(U32 i = 0; i < MAX_SHADOW_LAYERS; ++i)
 	{
-		rejectFactors[i] = F32(m_runCtx.m_layersWithRejectedHistory.get(i));
+		pc.y() |= U32(m_runCtx.m_layersWithRejectedHistory.get(i)) << i;
 	}
-	cmdb->setPushConstants(&rejectFactors, sizeof(rejectFactors));
+	cmdb->setPushConstants(&pc, sizeof(pc));
 
 	cmdb->traceRays(m_runCtx.m_sbtBuffer, m_runCtx.m_sbtOffset, m_sbtRecordSize, m_runCtx.m_hitGroupCount, 1,
 					m_r->getWidth() / 2, m_r->getHeight() / 2, 1);
@@ -328,6 +331,29 @@ void RtShadows::buildSbt()
 	ANKI_ASSERT(sbtStart + m_sbtRecordSize * (instanceCount + extraSbtRecords) == sbt);
 }
 
+void RtShadows::buildLightBvh()
+{
+	ANKI_TRACE_SCOPED_EVENT(R_RT_SHADOWS_LIGHT_BVH);
+
+	RenderingContext& ctx = *m_runCtx.m_ctx;
+	const RenderQueue& rqueue = *ctx.m_renderQueue;
+
+	LightBvhBuilder builder;
+	builder.init(m_r->getThreadHive(), ctx.m_tempAllocator, rqueue.m_pointLights, rqueue.m_spotLights, true);
+
+	WeakArray<LightBvhNode> nodes(
+		allocateStorage<LightBvhNode*>(sizeof(LightBvhNode) * builder.getNodeCount(), m_runCtx.m_lightBvhNodesToken),
+		builder.getNodeCount());
+	WeakArray<LightBvhLight> lights(
+		allocateStorage<LightBvhLight*>(sizeof(LightBvhLight) * builder.getLeafCount(), m_runCtx.m_lightBvhLightsToken),
+		builder.getLeafCount());
+	builder.build(nodes, lights);
+
+	m_runCtx.m_lightBvhLeafCount = builder.getLeafCount();
+	m_runCtx.m_lightBvhLightCount = builder.getLightCount();
+	ANKI_TRACE_INC_COUNTER(R_RT_SHADOWS_BVH_LIGHTS, builder.getLightCount());
+}
+
 Bool RtShadows::findShadowLayer(U64 lightUuid, U32& layerIdx, Bool& rejectHistoryBuffer)
 {
 	const U64 crntFrame = m_r->getFrameCount();
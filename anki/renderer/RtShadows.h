@@ -52,6 +52,7 @@ public:
 	ShaderProgramPtr m_grDenoiseProg;
 
 	U32 m_sbtRecordSize = 256;
+	Bool m_lightSampling = false;
 
 	static constexpr U32 MAX_SHADOW_LAYERS = 8;
 
@@ -77,6 +78,11 @@ public:
 
 		Array<ShadowLayer, MAX_SHADOW_LAYERS> m_shadowLayers;
 		BitSet<MAX_SHADOW_LAYERS, U8> m_layersWithRejectedHistory = {false};
+
+		StagingGpuMemoryToken m_lightBvhNodesToken;
+		StagingGpuMemoryToken m_lightBvhLightsToken;
+		U32 m_lightBvhLeafCount = 1;
+		U32 m_lightBvhLightCount = 0;
 	} m_runCtx;
 
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& cfg);
@@ -86,6 +92,9 @@ public:
 
 	void buildSbt();
 
+	/// Build the BVH of the lights that cast ray traced shadows.
+	void buildLightBvh();
+
 	Bool findShadowLayer(U64 lightUuid, U32& layerIdx, Bool& rejectHistoryBuffer);
 };
 /// @}
@@ -6,6 +6,8 @@
 #include <anki/renderer/ShadowMapping.h>
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/GpuSceneUpload.h>
+#include <anki/renderer/DrawWorkSplit.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/ThreadHive.h>
 #include <anki/util/Tracer.h>
@@ -13,6 +15,10 @@
 namespace anki
 {
 
+// The layers that the atlas resolve combines. Keep them in sync with ExponentialShadowmappingResolve.ankiprog
+static const U32 DYNAMIC_SHADOW_LAYER = 1u;
+static const U32 STATIC_SHADOW_LAYER = 2u;
+
 class ShadowMapping::Scratch::WorkItem
 {
 public:
@@ -21,6 +27,7 @@ public:
 	U32 m_firstRenderableElement;
 	U32 m_renderableElementCount;
 	U32 m_threadPoolTaskIdx;
+	Bool m_staticCasters; ///< It renders the static casters for the static cache.
 };
 
 class ShadowMapping::Scratch::LightToRenderToScratchInfo
@@ -28,17 +35,30 @@ class ShadowMapping::Scratch::LightToRenderToScratchInfo
 public:
 	Array<U32, 4> m_viewport;
 	RenderQueue* m_renderQueue;
+	U32 m_firstRenderable;
 	U32 m_drawcallCount;
+	Bool m_staticCasters;
 };
 
 class ShadowMapping::Atlas::ResolveWorkItem
 {
 public:
 	Vec4 m_uvIn; ///< UV + size that point to the scratch buffer.
+	Vec4 m_staticUvIn; ///< UV + size that point to the static cache.
 	Array<U32, 4> m_viewportOut; ///< Viewport in the atlas RT.
+	U32 m_layers;
 	Bool m_blur;
 };
 
+class ShadowMapping::StaticCache::CopyWorkItem
+{
+public:
+	Array<U32, 4> m_viewportOut; ///< Viewport in the static cache.
+	UVec2 m_inputOffset; ///< Where the tile starts in the scratch buffer.
+	U64 m_lightUuid;
+	U32 m_lightFace;
+};
+
 ShadowMapping::~ShadowMapping()
 {
 }
@@ -115,22 +135,50 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 		ANKI_CHECK(getResourceManager().loadResource("shaders/ExponentialShadowmappingResolve.ankiprog",
 													 m_atlas.m_resolveProg));
 
-		ShaderProgramResourceVariantInitInfo variantInitInfo(m_atlas.m_resolveProg);
-		variantInitInfo.addConstant("INPUT_TEXTURE_SIZE", UVec2(m_scratch.m_tileCountX * m_scratch.m_tileResolution,
-																m_scratch.m_tileCountY * m_scratch.m_tileResolution));
-
 		const ShaderProgramResourceVariant* variant;
-		m_atlas.m_resolveProg->getOrCreateVariant(variantInitInfo, variant);
+		m_atlas.m_resolveProg->getOrCreateVariant(variant);
 		m_atlas.m_resolveGrProg = variant->getProgram();
 	}
 
 	return Error::NONE;
 }
 
+Error ShadowMapping::initStaticCache(const ConfigSet& cfg)
+{
+	// Texture
+	{
+		const U32 size = m_atlas.m_tileResolution * m_atlas.m_tileCountBothAxis;
+		TextureInitInfo texinit = m_r->create2DRenderTargetInitInfo(
+			size, size, Format::R32_SFLOAT, TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::SAMPLED_COMPUTE,
+			"SM static cache");
+		texinit.m_initialUsage = TextureUsageBit::SAMPLED_COMPUTE;
+		ClearValue clearVal;
+		clearVal.m_colorf[0] = 1.0f;
+		m_staticCache.m_tex = m_r->createAndClearRenderTarget(texinit, clearVal);
+	}
+
+	// Tiles
+	m_staticCache.m_tileAlloc.init(getAllocator(), m_atlas.m_tileCountBothAxis, m_atlas.m_tileCountBothAxis,
+								   m_lodCount, true);
+
+	// Program
+	{
+		ANKI_CHECK(
+			getResourceManager().loadResource("shaders/ShadowMappingStaticCache.ankiprog", m_staticCache.m_copyProg));
+
+		const ShaderProgramResourceVariant* variant;
+		m_staticCache.m_copyProg->getOrCreateVariant(variant);
+		m_staticCache.m_copyGrProg = variant->getProgram();
+	}
+
+	return Error::NONE;
+}
+
 Error ShadowMapping::initInternal(const ConfigSet& cfg)
 {
 	ANKI_CHECK(initScratch(cfg));
 	ANKI_CHECK(initAtlas(cfg));
+	ANKI_CHECK(initStaticCache(cfg));
 
 	m_lodDistances[0] = cfg.getNumberF32("r_shadowMappingLightLodDistance0");
 	m_lodDistances[1] = cfg.getNumberF32("r_shadowMappingLightLodDistance1");
@@ -150,6 +198,7 @@ void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
 	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
 	rgraphCtx.bindTexture(0, 1, m_scratch.m_rt, TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
 	rgraphCtx.bindImage(0, 2, m_atlas.m_rt, {});
+	rgraphCtx.bindColorTexture(0, 3, m_staticCache.m_rt);
 
 	for(const Atlas::ResolveWorkItem& workItem : m_atlas.m_resolveWorkItems)
 	{
@@ -160,16 +209,52 @@ void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
 			UVec4 m_viewport;
 			Vec2 m_uvScale;
 			Vec2 m_uvTranslation;
+			Vec2 m_staticUvScale;
+			Vec2 m_staticUvTranslation;
 			U32 m_blur;
+			U32 m_layers;
 			U32 m_padding0;
 			U32 m_padding1;
-			U32 m_padding2;
 		} unis;
 		unis.m_uvScale = workItem.m_uvIn.zw();
 		unis.m_uvTranslation = workItem.m_uvIn.xy();
+		unis.m_staticUvScale = workItem.m_staticUvIn.zw();
+		unis.m_staticUvTranslation = workItem.m_staticUvIn.xy();
 		unis.m_viewport = UVec4(workItem.m_viewportOut[0], workItem.m_viewportOut[1], workItem.m_viewportOut[2],
 								workItem.m_viewportOut[3]);
 		unis.m_blur = workItem.m_blur;
+		unis.m_layers = workItem.m_layers;
+
+		cmdb->setPushConstants(&unis, sizeof(unis));
+
+		dispatchPPCompute(cmdb, 8, 8, workItem.m_viewportOut[2], workItem.m_viewportOut[3]);
+	}
+}
+
+void ShadowMapping::runStaticCache(RenderPassWorkContext& rgraphCtx)
+{
+	ANKI_ASSERT(m_staticCache.m_copyWorkItems.getSize());
+	ANKI_TRACE_SCOPED_EVENT(R_SM);
+
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_staticCache.m_copyGrProg);
+
+	rgraphCtx.bindTexture(0, 0, m_scratch.m_rt, TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
+	rgraphCtx.bindImage(0, 1, m_staticCache.m_rt, {});
+
+	for(const StaticCache::CopyWorkItem& workItem : m_staticCache.m_copyWorkItems)
+	{
+		struct Uniforms
+		{
+			UVec4 m_viewport;
+			UVec2 m_inputOffset;
+			U32 m_padding0;
+			U32 m_padding1;
+		} unis;
+		unis.m_viewport = UVec4(workItem.m_viewportOut[0], workItem.m_viewportOut[1], workItem.m_viewportOut[2],
+								workItem.m_viewportOut[3]);
+		unis.m_inputOffset = workItem.m_inputOffset;
 
 		cmdb->setPushConstants(&unis, sizeof(unis));
 
@@ -179,7 +264,6 @@ void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
 
 void ShadowMapping::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 {
-	ANKI_ASSERT(m_scratch.m_workItems.getSize());
 	ANKI_TRACE_SCOPED_EVENT(R_SM);
 
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
@@ -196,6 +280,7 @@ void ShadowMapping::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 		cmdb->setViewport(work.m_viewport[0], work.m_viewport[1], work.m_viewport[2], work.m_viewport[3]);
 		cmdb->setScissor(work.m_viewport[0], work.m_viewport[1], work.m_viewport[2], work.m_viewport[3]);
 
+		const U32 skippedDrawcallCount = cmdb->getSkippedDrawcallCount();
 		m_r->getSceneDrawer().drawRange(Pass::SM, work.m_renderQueue->m_viewMatrix,
 										work.m_renderQueue->m_viewProjectionMatrix,
 										Mat4::getIdentity(), // Don't care about prev matrices here
@@ -204,6 +289,23 @@ void ShadowMapping::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 										work.m_renderQueue->m_renderables.getBegin() + work.m_firstRenderableElement
 											+ work.m_renderableElementCount,
 										MAX_LOD_COUNT - 1);
+
+		if(work.m_staticCasters && cmdb->getSkippedDrawcallCount() != skippedDrawcallCount)
+		{
+			m_staticCache.m_drawcallsSkipped.store(true);
+		}
+	}
+}
+
+void ShadowMapping::finalize()
+{
+	if(m_staticCache.m_drawcallsSkipped.exchange(false))
+	{
+		// Some static casters are missing from the tiles that were updated this frame. Update them again next frame
+		for(const StaticCache::CopyWorkItem& workItem : m_staticCache.m_copyWorkItems)
+		{
+			m_staticCache.m_tileAlloc.invalidateCache(workItem.m_lightUuid, workItem.m_lightFace);
+		}
 	}
 }
 
@@ -217,11 +319,11 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 
 	// Build the render graph
 	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
-	if(m_scratch.m_workItems.getSize())
+	if(m_atlas.m_resolveWorkItems.getSize())
 	{
 		// Will have to create render passes
 
-		// Scratch pass
+		// Scratch pass. It might have no drawcalls if all the faces have only cached static casters
 		{
 			// Compute render area
 			const U32 minx = 0, miny = 0;
@@ -232,8 +334,7 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 
 			m_scratch.m_rt = rgraph.newRenderTarget(m_scratch.m_rtDescr);
 			pass.setFramebufferInfo(m_scratch.m_fbDescr, {}, m_scratch.m_rt, minx, miny, width, height);
-			ANKI_ASSERT(threadCountForScratchPass
-						&& threadCountForScratchPass <= m_r->getThreadHive().getThreadCount());
+			ANKI_ASSERT(threadCountForScratchPass <= m_r->getThreadHive().getThreadCount());
 			pass.setWork(
 				[](RenderPassWorkContext& rgraphCtx) {
 					static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runShadowMapping(rgraphCtx);
@@ -242,6 +343,25 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 
 			TextureSubresourceInfo subresource = TextureSubresourceInfo(DepthStencilAspectBit::DEPTH);
 			pass.newDependency({m_scratch.m_rt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT, subresource});
+			m_r->getGpuSceneUpload().setDependencies(pass);
+		}
+
+		m_staticCache.m_rt = rgraph.importRenderTarget(m_staticCache.m_tex);
+
+		// Static cache pass
+		if(m_staticCache.m_copyWorkItems.getSize())
+		{
+			ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SM static cache");
+
+			pass.setWork(
+				[](RenderPassWorkContext& rgraphCtx) {
+					static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runStaticCache(rgraphCtx);
+				},
+				this, 0);
+
+			pass.newDependency({m_scratch.m_rt, TextureUsageBit::SAMPLED_COMPUTE,
+								TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
+			pass.newDependency({m_staticCache.m_rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
 		}
 
 		// Atlas pass
@@ -258,6 +378,7 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 			pass.newDependency({m_scratch.m_rt, TextureUsageBit::SAMPLED_COMPUTE,
 								TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
 			pass.newDependency({m_atlas.m_rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+			pass.newDependency({m_staticCache.m_rt, TextureUsageBit::SAMPLED_COMPUTE});
 		}
 	}
 	else
@@ -423,6 +544,57 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid, U
 	return res;
 }
 
+ShadowMapping::StaticLayer ShadowMapping::allocateStaticLayer(U64 lightUuid, U32 faceIdx, U32 lod,
+															  const RenderQueue& lightRenderQueue,
+															  Viewport& cacheViewport, Viewport& scratchViewport)
+{
+	const U32 staticDrawcallCount = lightRenderQueue.m_staticShadowRenderableCount;
+	if(staticDrawcallCount == 0)
+	{
+		return StaticLayer::NONE;
+	}
+
+	// The cache tile is valid as long as the static casters and the light don't change
+	TileAllocatorResult res = m_staticCache.m_tileAlloc.allocate(
+		m_r->getGlobalTimestamp(), lightRenderQueue.m_staticShadowRenderablesLastUpdateTimestamp, lightUuid, faceIdx,
+		staticDrawcallCount, lod, cacheViewport);
+	if(res == TileAllocatorResult::ALLOCATION_FAILED)
+	{
+		// Not fatal, all the casters will be drawn in the scratch buffer
+		return StaticLayer::NONE;
+	}
+
+	cacheViewport[0] *= m_atlas.m_tileResolution;
+	cacheViewport[1] *= m_atlas.m_tileResolution;
+	cacheViewport[2] *= m_atlas.m_tileResolution;
+	cacheViewport[3] *= m_atlas.m_tileResolution;
+
+	if(res == TileAllocatorResult::CACHED)
+	{
+		return StaticLayer::CACHED;
+	}
+
+	// Need to draw the static casters in their own scratch tile
+	res = m_scratch.m_tileAlloc.allocate(m_r->getGlobalTimestamp(),
+										 lightRenderQueue.m_staticShadowRenderablesLastUpdateTimestamp, lightUuid,
+										 faceIdx, staticDrawcallCount, lod, scratchViewport);
+	if(res == TileAllocatorResult::ALLOCATION_FAILED)
+	{
+		m_staticCache.m_tileAlloc.invalidateCache(lightUuid, faceIdx);
+		return StaticLayer::NONE;
+	}
+
+	scratchViewport[0] *= m_scratch.m_tileResolution;
+	scratchViewport[1] *= m_scratch.m_tileResolution;
+	scratchViewport[2] *= m_scratch.m_tileResolution;
+	scratchViewport[3] *= m_scratch.m_tileResolution;
+
+	m_scratch.m_maxViewportWidth = max(m_scratch.m_maxViewportWidth, scratchViewport[0] + scratchViewport[2]);
+	m_scratch.m_maxViewportHeight = max(m_scratch.m_maxViewportHeight, scratchViewport[1] + scratchViewport[3]);
+
+	return StaticLayer::UPDATE;
+}
+
 void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScratchPass)
 {
 	// Reset the scratch viewport width
@@ -434,6 +606,8 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 	DynamicArrayAuto<Scratch::LightToRenderToScratchInfo> lightsToRender(ctx.m_tempAllocator);
 	U32 drawcallCount = 0;
 	DynamicArrayAuto<Atlas::ResolveWorkItem> atlasWorkItems(ctx.m_tempAllocator);
+	DynamicArrayAuto<StaticCache::CopyWorkItem> staticCacheCopyWorkItems(ctx.m_tempAllocator);
+	const Viewport noViewport = {};
 
 	// First thing, allocate an empty tile for empty faces of point lights
 	Viewport emptyTileViewport;
@@ -513,9 +687,12 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 						createSpotLightTextureMatrix(atlasViewports[activeCascades]) * light.m_textureMatrices[cascade];
 
 					// Push work
+					// The cascades follow the camera so there is no static layer
 					newScratchAndAtlasResloveRenderWorkItems(
 						atlasViewports[activeCascades], scratchViewports[activeCascades], blurAtlass[activeCascades],
-						light.m_shadowRenderQueues[cascade], lightsToRender, atlasWorkItems, drawcallCount);
+						light.m_shadowRenderQueues[cascade], light.m_uuid, U32(cascade), StaticLayer::NONE,
+						noViewport, noViewport, lightsToRender, atlasWorkItems, staticCacheCopyWorkItems,
+						drawcallCount);
 
 					++activeCascades;
 				}
@@ -609,9 +786,20 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 
 					if(subResults[numOfFacesThatHaveDrawcalls] != TileAllocatorResult::CACHED)
 					{
-						newScratchAndAtlasResloveRenderWorkItems(atlasViewport, scratchViewport, blurAtlas,
-																 light.m_shadowRenderQueues[face], lightsToRender,
-																 atlasWorkItems, drawcallCount);
+						Viewport staticCacheViewport = {};
+						Viewport staticScratchViewport = {};
+						const StaticLayer staticLayer =
+							allocateStaticLayer(light.m_uuid, U32(face), lod, *light.m_shadowRenderQueues[face],
+												staticCacheViewport, staticScratchViewport);
+
+						newScratchAndAtlasResloveRenderWorkItems(
+							atlasViewport, scratchViewport, blurAtlas, light.m_shadowRenderQueues[face], light.m_uuid,
+							U32(face), staticLayer, staticCacheViewport, staticScratchViewport, lightsToRender,
+							atlasWorkItems, staticCacheCopyWorkItems, drawcallCount);
+					}
+					else
+					{
+						ANKI_TRACE_INC_COUNTER(R_SHADOW_CACHED_FACES, 1);
 					}
 
 					++numOfFacesThatHaveDrawcalls;
@@ -669,9 +857,19 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 
 			if(subResult != TileAllocatorResult::CACHED)
 			{
+				Viewport staticCacheViewport = {};
+				Viewport staticScratchViewport = {};
+				const StaticLayer staticLayer = allocateStaticLayer(
+					light.m_uuid, faceIdx, lod, *light.m_shadowRenderQueue, staticCacheViewport, staticScratchViewport);
+
 				newScratchAndAtlasResloveRenderWorkItems(atlasViewport, scratchViewport, blurAtlas,
-														 light.m_shadowRenderQueue, lightsToRender, atlasWorkItems,
-														 drawcallCount);
+														 light.m_shadowRenderQueue, light.m_uuid, faceIdx, staticLayer,
+														 staticCacheViewport, staticScratchViewport, lightsToRender,
+														 atlasWorkItems, staticCacheCopyWorkItems, drawcallCount);
+			}
+			else
+			{
+				ANKI_TRACE_INC_COUNTER(R_SHADOW_CACHED_FACES, 1);
 			}
 		}
 		else
@@ -682,96 +880,135 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 	}
 
 	// Split the work that will happen in the scratch buffer
+	threadCountForScratchPass = 0;
+	m_scratch.m_workItems = WeakArray<Scratch::WorkItem>();
 	if(lightsToRender.getSize())
 	{
-		DynamicArrayAuto<Scratch::WorkItem> workItems(ctx.m_tempAllocator);
-		Scratch::LightToRenderToScratchInfo* lightToRender = lightsToRender.getBegin();
-		U32 lightToRenderDrawcallCount = lightToRender->m_drawcallCount;
-		const Scratch::LightToRenderToScratchInfo* lightToRenderEnd = lightsToRender.getEnd();
+		// Split the drawcalls of all the lights to the tasks by their cost
+		DynamicArrayAuto<ConstWeakArray<RenderableQueueElement>> renderables(ctx.m_tempAllocator);
+		renderables.create(lightsToRender.getSize());
+		for(U32 i = 0; i < lightsToRender.getSize(); ++i)
+		{
+			const Scratch::LightToRenderToScratchInfo& lightToRender = lightsToRender[i];
+			renderables[i] = ConstWeakArray<RenderableQueueElement>(
+				lightToRender.m_renderQueue->m_renderables.getBegin() + lightToRender.m_firstRenderable,
+				lightToRender.m_drawcallCount);
+		}
 
 		const U32 threadCount = computeNumberOfSecondLevelCommandBuffers(drawcallCount);
 		threadCountForScratchPass = threadCount;
-		for(U32 taskId = 0; taskId < threadCount; ++taskId)
-		{
-			U32 start, end;
-			splitThreadedProblem(taskId, threadCount, drawcallCount, start, end);
 
-			// While there are drawcalls in this task emit new work items
-			U32 taskDrawcallCount = end - start;
-			ANKI_ASSERT(taskDrawcallCount > 0 && "Because we used computeNumberOfSecondLevelCommandBuffers()");
+		DrawWorkSplit split;
+		split.init(ctx.m_tempAllocator,
+				   ConstWeakArray<ConstWeakArray<RenderableQueueElement>>(&renderables[0], renderables.getSize()),
+				   threadCount);
 
-			while(taskDrawcallCount)
+		DynamicArrayAuto<Scratch::WorkItem> workItems(ctx.m_tempAllocator);
+		for(U32 taskId = 0; taskId < threadCount; ++taskId)
+		{
+			for(const DrawWorkSplit::Range& range : split.getTaskRanges(taskId))
 			{
-				ANKI_ASSERT(lightToRender != lightToRenderEnd);
-				const U32 workItemDrawcallCount = min(lightToRenderDrawcallCount, taskDrawcallCount);
+				const Scratch::LightToRenderToScratchInfo& lightToRender = lightsToRender[range.m_arrayIdx];
 
 				Scratch::WorkItem workItem;
-				workItem.m_viewport = lightToRender->m_viewport;
-				workItem.m_renderQueue = lightToRender->m_renderQueue;
-				workItem.m_firstRenderableElement = lightToRender->m_drawcallCount - lightToRenderDrawcallCount;
-				workItem.m_renderableElementCount = workItemDrawcallCount;
+				workItem.m_viewport = lightToRender.m_viewport;
+				workItem.m_renderQueue = lightToRender.m_renderQueue;
+				workItem.m_firstRenderableElement = lightToRender.m_firstRenderable + range.m_firstRenderable;
+				workItem.m_renderableElementCount = range.m_renderableCount;
 				workItem.m_threadPoolTaskIdx = taskId;
+				workItem.m_staticCasters = lightToRender.m_staticCasters;
 				workItems.emplaceBack(workItem);
-
-				// Decrease the drawcall counts for the task and the light
-				ANKI_ASSERT(taskDrawcallCount >= workItemDrawcallCount);
-				taskDrawcallCount -= workItemDrawcallCount;
-				ANKI_ASSERT(lightToRenderDrawcallCount >= workItemDrawcallCount);
-				lightToRenderDrawcallCount -= workItemDrawcallCount;
-
-				// Move to the next light
-				if(lightToRenderDrawcallCount == 0)
-				{
-					++lightToRender;
-					lightToRenderDrawcallCount =
-						(lightToRender != lightToRenderEnd) ? lightToRender->m_drawcallCount : 0;
-				}
 			}
 		}
 
-		ANKI_ASSERT(lightToRender == lightToRenderEnd);
 		ANKI_ASSERT(lightsToRender.getSize() <= workItems.getSize());
 
 		// All good, store the work items for the threads to pick up
-		{
-			Scratch::WorkItem* items;
-			U32 itemSize;
-			U32 itemStorageSize;
-			workItems.moveAndReset(items, itemSize, itemStorageSize);
-
-			ANKI_ASSERT(items && itemSize && itemStorageSize);
-			m_scratch.m_workItems = WeakArray<Scratch::WorkItem>(items, itemSize);
-
-			Atlas::ResolveWorkItem* atlasItems;
-			atlasWorkItems.moveAndReset(atlasItems, itemSize, itemStorageSize);
-			ANKI_ASSERT(atlasItems && itemSize && itemStorageSize);
-			m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>(atlasItems, itemSize);
-		}
+		Scratch::WorkItem* items;
+		U32 itemSize;
+		U32 itemStorageSize;
+		workItems.moveAndReset(items, itemSize, itemStorageSize);
+
+		ANKI_ASSERT(items && itemSize && itemStorageSize);
+		m_scratch.m_workItems = WeakArray<Scratch::WorkItem>(items, itemSize);
+	}
+
+	// Store the rest of the work items
+	if(atlasWorkItems.getSize())
+	{
+		Atlas::ResolveWorkItem* atlasItems;
+		U32 itemSize;
+		U32 itemStorageSize;
+		atlasWorkItems.moveAndReset(atlasItems, itemSize, itemStorageSize);
+		m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>(atlasItems, itemSize);
 	}
 	else
 	{
-		m_scratch.m_workItems = WeakArray<Scratch::WorkItem>();
 		m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>();
 	}
+
+	if(staticCacheCopyWorkItems.getSize())
+	{
+		StaticCache::CopyWorkItem* copyItems;
+		U32 itemSize;
+		U32 itemStorageSize;
+		staticCacheCopyWorkItems.moveAndReset(copyItems, itemSize, itemStorageSize);
+		m_staticCache.m_copyWorkItems = WeakArray<StaticCache::CopyWorkItem>(copyItems, itemSize);
+	}
+	else
+	{
+		m_staticCache.m_copyWorkItems = WeakArray<StaticCache::CopyWorkItem>();
+	}
 }
 
 void ShadowMapping::newScratchAndAtlasResloveRenderWorkItems(
 	const Viewport& atlasViewport, const Viewport& scratchVewport, Bool blurAtlas, RenderQueue* lightRenderQueue,
-	DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItem,
-	DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem, U32& drawcallCount) const
+	U64 lightUuid, U32 lightFace, StaticLayer staticLayer, const Viewport& staticCacheViewport,
+	const Viewport& staticScratchViewport, DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItem,
+	DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem,
+	DynamicArrayAuto<StaticCache::CopyWorkItem>& staticCacheCopyWorkItems, U32& drawcallCount) const
 {
+	ANKI_TRACE_INC_COUNTER(R_SHADOW_RENDERED_FACES, 1);
+
+	// The static casters are first in the renderables
+	const U32 staticDrawcallCount =
+		(staticLayer != StaticLayer::NONE) ? lightRenderQueue->m_staticShadowRenderableCount : 0;
+	const U32 dynamicDrawcallCount = lightRenderQueue->m_renderables.getSize() - staticDrawcallCount;
+
 	// Scratch work item
+	if(dynamicDrawcallCount)
 	{
-		Scratch::LightToRenderToScratchInfo toRender = {scratchVewport, lightRenderQueue,
-														lightRenderQueue->m_renderables.getSize()};
+		Scratch::LightToRenderToScratchInfo toRender = {scratchVewport, lightRenderQueue, staticDrawcallCount,
+														dynamicDrawcallCount, false};
 		scratchWorkItem.emplaceBack(toRender);
-		drawcallCount += lightRenderQueue->m_renderables.getSize();
+		drawcallCount += dynamicDrawcallCount;
+	}
+
+	// Static cache work items
+	if(staticLayer == StaticLayer::UPDATE)
+	{
+		Scratch::LightToRenderToScratchInfo toRender = {staticScratchViewport, lightRenderQueue, 0,
+														staticDrawcallCount, true};
+		scratchWorkItem.emplaceBack(toRender);
+		drawcallCount += staticDrawcallCount;
+
+		StaticCache::CopyWorkItem copyItem;
+		copyItem.m_viewportOut = staticCacheViewport;
+		copyItem.m_inputOffset = UVec2(staticScratchViewport[0], staticScratchViewport[1]);
+		copyItem.m_lightUuid = lightUuid;
+		copyItem.m_lightFace = lightFace;
+		staticCacheCopyWorkItems.emplaceBack(copyItem);
+	}
+	else if(staticLayer == StaticLayer::CACHED)
+	{
+		ANKI_TRACE_INC_COUNTER(R_SHADOW_STATIC_CACHE_HITS, 1);
 	}
 
 	// Atlas resolve work item
 	{
 		const F32 scratchAtlasWidth = F32(m_scratch.m_tileCountX * m_scratch.m_tileResolution);
 		const F32 scratchAtlasHeight = F32(m_scratch.m_tileCountY * m_scratch.m_tileResolution);
+		const F32 staticCacheSize = F32(m_atlas.m_tileCountBothAxis * m_atlas.m_tileResolution);
 
 		Atlas::ResolveWorkItem atlasItem;
 		atlasItem.m_uvIn[0] = F32(scratchVewport[0]) / scratchAtlasWidth;
@@ -779,7 +1016,14 @@ void ShadowMapping::newScratchAndAtlasResloveRenderWorkItems(
 		atlasItem.m_uvIn[2] = F32(scratchVewport[2]) / scratchAtlasWidth;
 		atlasItem.m_uvIn[3] = F32(scratchVewport[3]) / scratchAtlasHeight;
 
+		atlasItem.m_staticUvIn[0] = F32(staticCacheViewport[0]) / staticCacheSize;
+		atlasItem.m_staticUvIn[1] = F32(staticCacheViewport[1]) / staticCacheSize;
+		atlasItem.m_staticUvIn[2] = F32(staticCacheViewport[2]) / staticCacheSize;
+		atlasItem.m_staticUvIn[3] = F32(staticCacheViewport[3]) / staticCacheSize;
+
 		atlasItem.m_viewportOut = atlasViewport;
+		atlasItem.m_layers = ((dynamicDrawcallCount) ? DYNAMIC_SHADOW_LAYER : 0u)
+							 | ((staticDrawcallCount) ? STATIC_SHADOW_LAYER : 0u);
 		atlasItem.m_blur = blurAtlas;
 
 		atlasResolveWorkItem.emplaceBack(atlasItem);
@@ -32,6 +32,9 @@ public:
 	/// Populate the rendergraph.
 	void populateRenderGraph(RenderingContext& ctx);
 
+	/// Call it after the rendergraph is recorded.
+	void finalize();
+
 	RenderTargetHandle getShadowmapRt() const
 	{
 		return m_atlas.m_rt;
@@ -98,6 +101,48 @@ private:
 	void runShadowMapping(RenderPassWorkContext& rgraphCtx);
 	/// @}
 
+	/// @name Static cache stuff
+	/// @{
+
+	/// How the static shadow casters of a light face are drawn.
+	enum class StaticLayer : U8
+	{
+		NONE, ///< No static layer. All casters are drawn in the scratch buffer.
+		CACHED, ///< The static casters are in the static cache. Only the dynamic casters are drawn.
+		UPDATE ///< The static casters are drawn in a separate scratch tile and they are copied to the static cache.
+	};
+
+	/// Holds the depth of the shadow casters that don't move. When a light face needs re-rendering only its dynamic
+	/// casters are drawn and they are merged with the cached depth.
+	class StaticCache
+	{
+	public:
+		class CopyWorkItem;
+
+		TileAllocator m_tileAlloc; ///< Same layout as the atlas.
+
+		TexturePtr m_tex; ///< Same size as the atlas.
+		RenderTargetHandle m_rt;
+
+		ShaderProgramResourcePtr m_copyProg;
+		ShaderProgramPtr m_copyGrProg;
+
+		WeakArray<CopyWorkItem> m_copyWorkItems;
+
+		/// Some static casters were not drawn because their pipelines were not ready.
+		Atomic<Bool> m_drawcallsSkipped = {false};
+	} m_staticCache;
+
+	ANKI_USE_RESULT Error initStaticCache(const ConfigSet& cfg);
+
+	void runStaticCache(RenderPassWorkContext& rgraphCtx);
+
+	/// Try to allocate a static cache tile for a light face that needs re-rendering. If the static casters need to be
+	/// drawn it will also allocate a scratch tile for them.
+	StaticLayer allocateStaticLayer(U64 lightUuid, U32 faceIdx, U32 lod, const RenderQueue& lightRenderQueue,
+									Viewport& cacheViewport, Viewport& scratchViewport);
+	/// @}
+
 	/// @name Misc & common
 	/// @{
 
@@ -120,8 +165,10 @@ private:
 	/// Add new work to render to scratch buffer and atlas buffer.
 	void newScratchAndAtlasResloveRenderWorkItems(
 		const Viewport& atlasViewport, const Viewport& scratchVewport, Bool blurAtlas, RenderQueue* lightRenderQueue,
-		DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItem,
-		DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem, U32& drawcallCount) const;
+		U64 lightUuid, U32 lightFace, StaticLayer staticLayer, const Viewport& staticCacheViewport,
+		const Viewport& staticScratchViewport, DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItem,
+		DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem,
+		DynamicArrayAuto<StaticCache::CopyWorkItem>& staticCacheCopyWorkItems, U32& drawcallCount) const;
 
 	/// Iterate lights and create work items.
 	void processLights(RenderingContext& ctx, U32& threadCountForScratchPass);
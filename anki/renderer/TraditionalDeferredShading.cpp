@@ -130,6 +130,7 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 	U32 indexCount;
 	bindVertexIndexBuffers(m_plightMesh, cmdb, indexCount);
 	cmdb->bindShaderProgram(m_plightGrProg[info.m_computeSpecular]);
+	Mat4 dequantizationM(m_plightMesh->getPositionDequantizationTransform());
 
 	for(const PointLightQueueElement& plightEl : info.m_pointLights)
 	{
@@ -137,7 +138,8 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 		DeferredVertexUniforms* vert =
 			allocateAndBindUniforms<DeferredVertexUniforms*>(sizeof(DeferredVertexUniforms), cmdb, 0, 0);
 
-		Mat4 modelM(plightEl.m_worldPosition.xyz1(), Mat3::getIdentity(), plightEl.m_radius);
+		const Mat4 modelM =
+			Mat4(plightEl.m_worldPosition.xyz1(), Mat3::getIdentity(), plightEl.m_radius) * dequantizationM;
 
 		vert->m_mvp = info.m_viewProjectionMatrix * modelM;
 
@@ -161,6 +163,7 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 	// Do spot lights
 	bindVertexIndexBuffers(m_slightMesh, cmdb, indexCount);
 	cmdb->bindShaderProgram(m_slightGrProg[info.m_computeSpecular]);
+	dequantizationM = Mat4(m_slightMesh->getPositionDequantizationTransform());
 
 	for(const SpotLightQueueElement& splightEl : info.m_spotLights)
 	{
@@ -175,7 +178,7 @@ void TraditionalDeferredLightShading::drawLights(TraditionalDeferredLightShading
 		scaleM(1, 1) = scaleM(0, 0);
 		scaleM(2, 2) = splightEl.m_distance;
 
-		modelM = modelM * scaleM;
+		modelM = modelM * scaleM * dequantizationM;
 
 		// Update vertex uniforms
 		DeferredVertexUniforms* vert =
@@ -0,0 +1,86 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// WARNING: This file is auto generated.
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/Math.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+static constexpr const char* ANIMATION_MAGIC = "ANKIANI1";
+
+/// A channel of an animation binary. The keys of all channels follow the channel array. For each channel: position
+/// times (F32), positions (3xU16), rotation times (F32), rotations (4xI16 SNORM), scale times (F32), scales (F32).
+class AnimationBinaryChannel
+{
+public:
+	Array<U8, 128> m_name; ///< Null terminated name of the bone or node.
+	U32 m_positionKeyCount;
+	U32 m_rotationKeyCount;
+	U32 m_scaleKeyCount;
+	Vec3 m_positionMin; ///< Positions are quantized in the box defined by min and range.
+	Vec3 m_positionRange;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_name", offsetof(AnimationBinaryChannel, m_name), &self.m_name[0], self.m_name.getSize());
+		s.doValue("m_positionKeyCount", offsetof(AnimationBinaryChannel, m_positionKeyCount), self.m_positionKeyCount);
+		s.doValue("m_rotationKeyCount", offsetof(AnimationBinaryChannel, m_rotationKeyCount), self.m_rotationKeyCount);
+		s.doValue("m_scaleKeyCount", offsetof(AnimationBinaryChannel, m_scaleKeyCount), self.m_scaleKeyCount);
+		s.doValue("m_positionMin", offsetof(AnimationBinaryChannel, m_positionMin), self.m_positionMin);
+		s.doValue("m_positionRange", offsetof(AnimationBinaryChannel, m_positionRange), self.m_positionRange);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryChannel&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryChannel&>(serializer, *this);
+	}
+};
+
+/// The 1st thing that appears in an animation binary.
+class AnimationBinaryHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_channelCount;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(AnimationBinaryHeader, m_magic), &self.m_magic[0], self.m_magic.getSize());
+		s.doValue("m_channelCount", offsetof(AnimationBinaryHeader, m_channelCount), self.m_channelCount);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, AnimationBinaryHeader&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const AnimationBinaryHeader&>(serializer, *this);
+	}
+};
+
+/// @}
+
+} // end namespace anki
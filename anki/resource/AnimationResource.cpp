@@ -4,6 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/resource/AnimationResource.h>
+#include <anki/resource/AnimationBinary.h>
+#include <anki/resource/ResourceFilesystem.h>
 #include <anki/util/Xml.h>
 
 namespace anki
@@ -25,6 +27,138 @@ AnimationResource::~AnimationResource()
 }
 
 Error AnimationResource::load(const ResourceFilename& filename, Bool async)
+{
+	// Check if it's a binary or an XML
+	ResourceFilePtr file;
+	ANKI_CHECK(openFile(filename, file));
+
+	AnimationBinaryHeader header;
+	if(file->getSize() >= sizeof(header))
+	{
+		ANKI_CHECK(file->read(&header, sizeof(header)));
+		if(memcmp(&header.m_magic[0], ANIMATION_MAGIC, sizeof(header.m_magic)) == 0)
+		{
+			return loadBinary(*file, header.m_channelCount);
+		}
+	}
+
+	return loadXml(filename);
+}
+
+Error AnimationResource::loadBinary(ResourceFile& file, U32 channelCount)
+{
+	if(channelCount == 0)
+	{
+		ANKI_RESOURCE_LOGE("Didn't found any channels");
+		return Error::USER_DATA;
+	}
+
+	DynamicArrayAuto<AnimationBinaryChannel> binChannels(getTempAllocator(), channelCount);
+	ANKI_CHECK(file.read(&binChannels[0], binChannels.getSizeInBytes()));
+
+	m_startTime = MAX_SECOND;
+	Second maxTime = MIN_SECOND;
+
+	// Read the key times of a track and validate them
+	auto readTimes = [&](U32 count, DynamicArrayAuto<F32>& times) -> Error {
+		times.create(count);
+		ANKI_CHECK(file.read(&times[0], times.getSizeInBytes()));
+		for(U32 i = 0; i < count; ++i)
+		{
+			if(i > 0 && times[i] < times[i - 1])
+			{
+				ANKI_RESOURCE_LOGE("Key times should be sorted");
+				return Error::USER_DATA;
+			}
+
+			m_startTime = min<Second>(m_startTime, times[i]);
+			maxTime = max<Second>(maxTime, times[i]);
+		}
+
+		return Error::NONE;
+	};
+
+	m_channels.create(getAllocator(), channelCount);
+	for(U32 c = 0; c < channelCount; ++c)
+	{
+		const AnimationBinaryChannel& binChannel = binChannels[c];
+		AnimationChannel& ch = m_channels[c];
+
+		if(binChannel.m_name.getBack() != 0)
+		{
+			ANKI_RESOURCE_LOGE("Channel name is not null terminated");
+			return Error::USER_DATA;
+		}
+		ch.m_name.create(getAllocator(), reinterpret_cast<const char*>(&binChannel.m_name[0]));
+
+		DynamicArrayAuto<F32> times(getTempAllocator());
+
+		// Positions
+		if(binChannel.m_positionKeyCount)
+		{
+			const U32 count = binChannel.m_positionKeyCount;
+			ANKI_CHECK(readTimes(count, times));
+
+			DynamicArrayAuto<U16> values(getTempAllocator(), count * 3);
+			ANKI_CHECK(file.read(&values[0], values.getSizeInBytes()));
+
+			ch.m_positions.create(getAllocator(), count);
+			for(U32 i = 0; i < count; ++i)
+			{
+				Vec3 pos(F32(values[i * 3]), F32(values[i * 3 + 1]), F32(values[i * 3 + 2]));
+				pos = binChannel.m_positionMin + pos / F32(MAX_U16) * binChannel.m_positionRange;
+				ch.m_positions[i] = {times[i], pos};
+			}
+		}
+
+		// Rotations
+		if(binChannel.m_rotationKeyCount)
+		{
+			const U32 count = binChannel.m_rotationKeyCount;
+			ANKI_CHECK(readTimes(count, times));
+
+			DynamicArrayAuto<I16> values(getTempAllocator(), count * 4);
+			ANKI_CHECK(file.read(&values[0], values.getSizeInBytes()));
+
+			ch.m_rotations.create(getAllocator(), count);
+			for(U32 i = 0; i < count; ++i)
+			{
+				Quat rot(F32(values[i * 4]), F32(values[i * 4 + 1]), F32(values[i * 4 + 2]), F32(values[i * 4 + 3]));
+				rot = rot / F32(MAX_I16);
+				rot.normalize();
+				ch.m_rotations[i] = {times[i], rot};
+			}
+		}
+
+		// Scales
+		if(binChannel.m_scaleKeyCount)
+		{
+			const U32 count = binChannel.m_scaleKeyCount;
+			ANKI_CHECK(readTimes(count, times));
+
+			DynamicArrayAuto<F32> values(getTempAllocator(), count);
+			ANKI_CHECK(file.read(&values[0], values.getSizeInBytes()));
+
+			ch.m_scales.create(getAllocator(), count);
+			for(U32 i = 0; i < count; ++i)
+			{
+				ch.m_scales[i] = {times[i], values[i]};
+			}
+		}
+	}
+
+	if(m_startTime > maxTime)
+	{
+		ANKI_RESOURCE_LOGE("Animation doesn't have any keys");
+		return Error::USER_DATA;
+	}
+
+	m_duration = maxTime - m_startTime;
+
+	return Error::NONE;
+}
+
+Error AnimationResource::loadXml(const ResourceFilename& filename)
 {
 	XmlElement el;
 
@@ -203,15 +337,49 @@ Error AnimationResource::load(const ResourceFilename& filename, Bool async)
 	return Error::NONE;
 }
 
-void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Quat& rot, F32& scale) const
+/// Find the keys that surround a time using binary search and interpolate between them. Tracks with less than 2 keys
+/// and times outside the keys give the default value.
+template<typename T, typename TInterpolateFunc>
+static T sampleKeyframes(const DynamicArray<AnimationKeyframe<T>>& keys, Second time, const T& defaultValue,
+						 TInterpolateFunc interpolateFunc)
 {
-	pos = Vec3(0.0f);
-	rot = Quat::getIdentity();
-	scale = 1.0f;
+	if(keys.getSize() < 2 || time < keys.getFront().getTime() || time > keys.getBack().getTime())
+	{
+		return defaultValue;
+	}
+
+	// Find the 1st key that is after the time. If the time is the time of the last key use the last pair
+	auto it = std::upper_bound(keys.getBegin(), keys.getEnd(), time,
+							   [](Second t, const AnimationKeyframe<T>& key) { return t < key.getTime(); });
+	if(it == keys.getEnd())
+	{
+		--it;
+	}
+	ANKI_ASSERT(it != keys.getBegin());
+	const AnimationKeyframe<T>& right = *it;
+	const AnimationKeyframe<T>& left = *(it - 1);
 
+	const Second u = (time - left.getTime()) / (right.getTime() - left.getTime());
+	return interpolateFunc(left.getValue(), right.getValue(), F32(u));
+}
+
+/// Sample all the tracks of a channel. Both AnimationResource::interpolate() and sampleAnimationChannels() use it so
+/// they return the same values.
+static void sampleChannel(const AnimationChannel& channel, Second time, Vec3& pos, Quat& rot, F32& scale)
+{
+	pos = sampleKeyframes(channel.m_positions, time, Vec3(0.0f),
+						  [](const Vec3& a, const Vec3& b, F32 u) { return linearInterpolate(a, b, u); });
+	rot = sampleKeyframes(channel.m_rotations, time, Quat::getIdentity(),
+						  [](const Quat& a, const Quat& b, F32 u) { return a.slerp(b, u); });
+	scale = sampleKeyframes(channel.m_scales, time, 1.0f,
+							[](F32 a, F32 b, F32 u) { return linearInterpolate(a, b, u); });
+}
+
+Bool AnimationResource::adjustTime(Second& time) const
+{
 	if(ANKI_UNLIKELY(time < m_startTime))
 	{
-		return;
+		return false;
 	}
 
 	// Audjust time
@@ -221,56 +389,51 @@ void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Qu
 	}
 
 	ANKI_ASSERT(time >= m_startTime && time <= m_startTime + m_duration);
-	ANKI_ASSERT(channelIndex < m_channels.getSize());
+	return true;
+}
 
-	const AnimationChannel& channel = m_channels[channelIndex];
+void AnimationResource::interpolate(U32 channelIndex, Second time, Vec3& pos, Quat& rot, F32& scale) const
+{
+	pos = Vec3(0.0f);
+	rot = Quat::getIdentity();
+	scale = 1.0f;
 
-	// Position
-	if(channel.m_positions.getSize() > 1)
+	if(!adjustTime(time))
 	{
-		for(U32 i = 0; i < channel.m_positions.getSize() - 1; ++i)
-		{
-			const AnimationKeyframe<Vec3>& left = channel.m_positions[i];
-			const AnimationKeyframe<Vec3>& right = channel.m_positions[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				pos = linearInterpolate(left.m_value, right.m_value, F32(u));
-				break;
-			}
-		}
+		return;
 	}
 
-	// Rotation
-	if(channel.m_rotations.getSize() > 1)
+	ANKI_ASSERT(channelIndex < m_channels.getSize());
+	sampleChannel(m_channels[channelIndex], time, pos, rot, scale);
+}
+
+void AnimationResource::interpolateAll(Second time, WeakArray<Vec3> positions, WeakArray<Quat> rotations,
+									   WeakArray<F32> scales) const
+{
+	if(!adjustTime(time))
 	{
-		for(U32 i = 0; i < channel.m_rotations.getSize() - 1; ++i)
+		for(U32 i = 0; i < m_channels.getSize(); ++i)
 		{
-			const AnimationKeyframe<Quat>& left = channel.m_rotations[i];
-			const AnimationKeyframe<Quat>& right = channel.m_rotations[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				rot = left.m_value.slerp(right.m_value, F32(u));
-				break;
-			}
+			positions[i] = Vec3(0.0f);
+			rotations[i] = Quat::getIdentity();
+			scales[i] = 1.0f;
 		}
+		return;
 	}
 
-	// Scale
-	if(channel.m_scales.getSize() > 1)
+	sampleAnimationChannels(ConstWeakArray<AnimationChannel>(m_channels), time, positions, rotations, scales);
+}
+
+void sampleAnimationChannels(ConstWeakArray<AnimationChannel> channels, Second time, WeakArray<Vec3> positions,
+							 WeakArray<Quat> rotations, WeakArray<F32> scales)
+{
+	ANKI_ASSERT(positions.getSize() >= channels.getSize());
+	ANKI_ASSERT(rotations.getSize() >= channels.getSize());
+	ANKI_ASSERT(scales.getSize() >= channels.getSize());
+
+	for(U32 i = 0; i < channels.getSize(); ++i)
 	{
-		for(U32 i = 0; i < channel.m_scales.getSize() - 1; ++i)
-		{
-			const AnimationKeyframe<F32>& left = channel.m_scales[i];
-			const AnimationKeyframe<F32>& right = channel.m_scales[i + 1];
-			if(time >= left.m_time && time <= right.m_time)
-			{
-				const Second u = (time - left.m_time) / (right.m_time - left.m_time);
-				scale = linearInterpolate(left.m_value, right.m_value, F32(u));
-				break;
-			}
-		}
+		sampleChannel(channels[i], time, positions[i], rotations[i], scales[i]);
 	}
 }
 
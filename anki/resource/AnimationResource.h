@@ -8,12 +8,14 @@
 #include <anki/resource/ResourceObject.h>
 #include <anki/Math.h>
 #include <anki/util/String.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
 
 // Forward
 class XmlElement;
+class ResourceFile;
 
 /// @addtogroup resource
 /// @{
@@ -25,6 +27,14 @@ class AnimationKeyframe
 	friend class AnimationResource;
 
 public:
+	AnimationKeyframe() = default;
+
+	AnimationKeyframe(Second time, const T& value)
+		: m_time(time)
+		, m_value(value)
+	{
+	}
+
 	Second getTime() const
 	{
 		return m_time;
@@ -94,11 +104,29 @@ public:
 	/// Get the interpolated data
 	void interpolate(U32 channelIndex, Second time, Vec3& position, Quat& rotation, F32& scale) const;
 
+	/// Get the interpolated data of all channels. Prefer it over interpolate() when sampling a whole skeleton.
+	/// @param time The time. It will wrap around like in interpolate().
+	/// @param[out] positions One for each channel.
+	/// @param[out] rotations One for each channel.
+	/// @param[out] scales One for each channel.
+	void interpolateAll(Second time, WeakArray<Vec3> positions, WeakArray<Quat> rotations, WeakArray<F32> scales) const;
+
 private:
 	DynamicArray<AnimationChannel> m_channels;
 	Second m_duration;
 	Second m_startTime;
+
+	ANKI_USE_RESULT Error loadXml(const ResourceFilename& filename);
+	ANKI_USE_RESULT Error loadBinary(ResourceFile& file, U32 channelCount);
+
+	/// Wrap the time inside the animation. Returns false if the animation hasn't started yet.
+	Bool adjustTime(Second& time) const;
 };
+
+/// Sample a number of animation channels. The keyframes are found with a binary search. Gives the same values as
+/// AnimationResource::interpolate().
+void sampleAnimationChannels(ConstWeakArray<AnimationChannel> channels, Second time, WeakArray<Vec3> positions,
+							 WeakArray<Quat> rotations, WeakArray<F32> scales);
 /// @}
 
 } // end namespace anki
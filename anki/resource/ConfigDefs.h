@@ -5,8 +5,12 @@
 
 ANKI_CONFIG_OPTION(rsrc_maxTextureSize, 1024u * 1024u, 4u, MAX_U32)
 ANKI_CONFIG_OPTION(rsrc_dumpShaderSources, 0, 0, 1)
+ANKI_CONFIG_OPTION(rsrc_textureCompression, 0, 0, 2,
+				   "The compression of the textures to load if present, else S3TC or raw. 0: S3TC, 1: BC7, 2: ASTC")
 ANKI_CONFIG_OPTION(
 	rsrc_dataPaths, ".",
 	"The engine loads assets only in from these paths. Separate them with : (it's smart enough to identify drive "
 	"letters in Windows)")
 ANKI_CONFIG_OPTION(rsrc_transferScratchMemorySize, 256_MB, 1_MB, 4_GB)
+ANKI_CONFIG_OPTION(rsrc_compileShadersOnDemand, 0, 0, 1,
+				   "Compile the shader programs the first time they are loaded and not when the engine starts")
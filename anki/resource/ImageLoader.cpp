@@ -4,9 +4,9 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/resource/ImageLoader.h>
+#include <anki/resource/ImageTranscoder.h>
 #include <anki/util/Logger.h>
 #include <anki/util/Filesystem.h>
-#include <anki/util/Array.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ASSERT(x) ANKI_ASSERT(x)
@@ -27,21 +27,22 @@ namespace anki
 static const U8 tgaHeaderUncompressed[12] = {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 static const U8 tgaHeaderCompressed[12] = {0, 0, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-class AnkiTextureHeader
+/// Get the number of channels of a RAW texel
+static U32 calcRawChannelCount(const ImageLoaderColorFormat cf)
 {
-public:
-	Array<U8, 8> m_magic;
-	U32 m_width;
-	U32 m_height;
-	U32 m_depthOrLayerCount;
-	ImageLoaderTextureType m_type;
-	ImageLoaderColorFormat m_colorFormat;
-	ImageLoaderDataCompression m_compressionFormats;
-	U32 m_normal;
-	U32 m_mipCount;
-	U8 m_padding[88];
-};
-static_assert(sizeof(AnkiTextureHeader) == 128, "Check sizeof AnkiTextureHeader");
+	switch(cf)
+	{
+	case ImageLoaderColorFormat::R8:
+		return 1;
+	case ImageLoaderColorFormat::RG8:
+		return 2;
+	case ImageLoaderColorFormat::RGB8:
+		return 3;
+	default:
+		ANKI_ASSERT(cf == ImageLoaderColorFormat::RGBA8);
+		return 4;
+	}
+}
 
 /// Get the size in bytes of a single surface
 static PtrSize calcSurfaceSize(const U32 width, const U32 height, const ImageLoaderDataCompression comp,
@@ -54,14 +55,20 @@ static PtrSize calcSurfaceSize(const U32 width, const U32 height, const ImageLoa
 	switch(comp)
 	{
 	case ImageLoaderDataCompression::RAW:
-		out = width * height * ((cf == ImageLoaderColorFormat::RGB8) ? 3 : 4);
+		out = width * height * calcRawChannelCount(cf);
 		break;
 	case ImageLoaderDataCompression::S3TC:
-		out = (width / 4) * (height / 4) * ((cf == ImageLoaderColorFormat::RGB8) ? 8 : 16); // block size
+		// BC1 and BC4 blocks are 8 bytes, BC3 and BC5 are 16
+		out = (width / 4) * (height / 4)
+			  * ((cf == ImageLoaderColorFormat::RGB8 || cf == ImageLoaderColorFormat::R8) ? 8 : 16);
 		break;
 	case ImageLoaderDataCompression::ETC:
 		out = (width / 4) * (height / 4) * 8;
 		break;
+	case ImageLoaderDataCompression::BC7:
+	case ImageLoaderDataCompression::ASTC:
+		out = (width / 4) * (height / 4) * 16;
+		break;
 	default:
 		ANKI_ASSERT(0);
 	}
@@ -82,7 +89,7 @@ static PtrSize calcVolumeSize(const U width, const U height, const U depth, cons
 	switch(comp)
 	{
 	case ImageLoaderDataCompression::RAW:
-		out = width * height * depth * ((cf == ImageLoaderColorFormat::RGB8) ? 3 : 4);
+		out = width * height * depth * calcRawChannelCount(cf);
 		break;
 	default:
 		ANKI_ASSERT(0);
@@ -370,6 +377,8 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file, U32 maxTextureSize,
 	//
 	AnkiTextureHeader header;
 	ANKI_CHECK(file.read(&header, sizeof(AnkiTextureHeader)));
+	const PtrSize fileSize = file.getSize();
+	PtrSize fileOffset = sizeof(AnkiTextureHeader); // Used to validate the sizes that are read from the file
 
 	if(std::memcmp(&header.m_magic[0], "ANKITEX1", 8) != 0)
 	{
@@ -396,24 +405,53 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file, U32 maxTextureSize,
 		return Error::USER_DATA;
 	}
 
-	if(header.m_colorFormat < ImageLoaderColorFormat::RGB8 || header.m_colorFormat > ImageLoaderColorFormat::RGBA8)
+	if(header.m_colorFormat < ImageLoaderColorFormat::RGB8 || header.m_colorFormat > ImageLoaderColorFormat::RG8)
 	{
 		ANKI_RESOURCE_LOGE("Incorrect header: color format");
 		return Error::USER_DATA;
 	}
 
-	if((header.m_compressionFormats & preferredCompression) == ImageLoaderDataCompression::NONE)
+	// The segment to read. Try the preferred compression, then S3TC (if the blocks are only available supercompressed
+	// then transcode them) and last RAW
+	ImageLoaderDataCompression segment = ImageLoaderDataCompression::NONE;
+	for(ImageLoaderDataCompression comp : {preferredCompression, ImageLoaderDataCompression::S3TC,
+										   ImageLoaderDataCompression::S3TC_ZLIB, ImageLoaderDataCompression::RAW})
+	{
+		if((header.m_compressionFormats & comp) != ImageLoaderDataCompression::NONE)
+		{
+			segment = comp;
+			break;
+		}
+	}
+
+	if(segment == ImageLoaderDataCompression::NONE)
+	{
+		ANKI_RESOURCE_LOGE("File does not contain the requested, S3TC or raw compression");
+		return Error::USER_DATA;
+	}
+
+	if(segment != preferredCompression
+	   && !(segment == ImageLoaderDataCompression::S3TC_ZLIB
+			&& preferredCompression == ImageLoaderDataCompression::S3TC))
 	{
 		ANKI_RESOURCE_LOGW("File does not contain the requested compression");
+	}
 
-		// Fallback
-		preferredCompression = ImageLoaderDataCompression::RAW;
+	preferredCompression =
+		(segment == ImageLoaderDataCompression::S3TC_ZLIB) ? ImageLoaderDataCompression::S3TC : segment;
 
-		if((header.m_compressionFormats & preferredCompression) == ImageLoaderDataCompression::NONE)
-		{
-			ANKI_RESOURCE_LOGE("File does not contain raw compression");
-			return Error::USER_DATA;
-		}
+	if((segment == ImageLoaderDataCompression::S3TC_ZLIB || segment == ImageLoaderDataCompression::BC7
+		|| segment == ImageLoaderDataCompression::ASTC)
+	   && header.m_colorFormat != ImageLoaderColorFormat::RGB8 && header.m_colorFormat != ImageLoaderColorFormat::RGBA8)
+	{
+		ANKI_RESOURCE_LOGE("Incorrect header: compression doesn't support the color format");
+		return Error::USER_DATA;
+	}
+
+	if(segment == ImageLoaderDataCompression::S3TC_ZLIB && header.m_type == ImageLoaderTextureType::_3D)
+	{
+		ANKI_RESOURCE_LOGE("Supercompressed S3TC is not supported for 3D textures");
+		return Error::USER_DATA;
 	}
 
 	if(header.m_normal != 0 && header.m_normal != 1)
@@ -454,30 +492,19 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file, U32 maxTextureSize,
 	// Move file pointer
 	//
 
-	if(preferredCompression == ImageLoaderDataCompression::RAW)
-	{
-		// Do nothing
-	}
-	else if(preferredCompression == ImageLoaderDataCompression::S3TC)
+	// Skip all the segments that come before the one to read
+	for(ImageLoaderDataCompression comp : ANKITEX_SEGMENT_ORDER)
 	{
-		if((header.m_compressionFormats & ImageLoaderDataCompression::RAW) != ImageLoaderDataCompression::NONE)
+		if(comp == segment)
 		{
-			// If raw compression is present then skip it
-			ANKI_CHECK(file.seek(calcSizeOfSegment(header, ImageLoaderDataCompression::RAW), FileSeekOrigin::CURRENT));
-		}
-	}
-	else if(preferredCompression == ImageLoaderDataCompression::ETC)
-	{
-		if((header.m_compressionFormats & ImageLoaderDataCompression::RAW) != ImageLoaderDataCompression::NONE)
-		{
-			// If raw compression is present then skip it
-			ANKI_CHECK(file.seek(calcSizeOfSegment(header, ImageLoaderDataCompression::RAW), FileSeekOrigin::CURRENT));
+			break;
 		}
 
-		if((header.m_compressionFormats & ImageLoaderDataCompression::S3TC) != ImageLoaderDataCompression::NONE)
+		if((header.m_compressionFormats & comp) != ImageLoaderDataCompression::NONE)
 		{
-			// If s3tc compression is present then skip it
-			ANKI_CHECK(file.seek(calcSizeOfSegment(header, ImageLoaderDataCompression::S3TC), FileSeekOrigin::CURRENT));
+			const PtrSize segmentSize = calcSizeOfSegment(header, comp);
+			ANKI_CHECK(file.seek(segmentSize, FileSeekOrigin::CURRENT));
+			fileOffset += segmentSize;
 		}
 	}
 
@@ -501,6 +528,22 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file, U32 maxTextureSize,
 					const U32 dataSize =
 						U32(calcSurfaceSize(mipWidth, mipHeight, preferredCompression, header.m_colorFormat));
 
+					// Supercompressed surfaces are prefixed by their size. It's read from the file so check it
+					U32 segmentDataSize = dataSize;
+					if(segment == ImageLoaderDataCompression::S3TC_ZLIB)
+					{
+						ANKI_CHECK(file.read(&segmentDataSize, sizeof(segmentDataSize)));
+						fileOffset += sizeof(segmentDataSize);
+
+						if(segmentDataSize == 0 || segmentDataSize > fileSize - min(fileOffset, fileSize)
+						   || segmentDataSize > computeS3tcZlibMaxSize(dataSize))
+						{
+							ANKI_RESOURCE_LOGE("Incorrect size of a supercompressed surface: %u", segmentDataSize);
+							return Error::USER_DATA;
+						}
+					}
+					fileOffset += segmentDataSize;
+
 					// Check if this mipmap can be skipped because of size
 					if(max(mipWidth, mipHeight) <= maxTextureSize || mip == header.m_mipCount - 1)
 					{
@@ -509,13 +552,25 @@ Error ImageLoader::loadAnkiTexture(FileInterface& file, U32 maxTextureSize,
 						surf.m_height = mipHeight;
 
 						surf.m_data.create(alloc, dataSize);
-						ANKI_CHECK(file.read(&surf.m_data[0], dataSize));
+						if(segment == ImageLoaderDataCompression::S3TC_ZLIB)
+						{
+							DynamicArrayAuto<U8> compressed(alloc);
+							compressed.create(segmentDataSize);
+							ANKI_CHECK(file.read(&compressed[0], segmentDataSize));
+							ANKI_CHECK(transcodeS3tcZlib(compressed,
+														 header.m_colorFormat == ImageLoaderColorFormat::RGBA8, alloc,
+														 WeakArray<U8>(surf.m_data)));
+						}
+						else
+						{
+							ANKI_CHECK(file.read(&surf.m_data[0], dataSize));
+						}
 
 						mipCount = max(header.m_mipCount - mip, mipCount);
 					}
 					else
 					{
-						ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::CURRENT));
+						ANKI_CHECK(file.seek(segmentDataSize, FileSeekOrigin::CURRENT));
 					}
 				}
 			}
@@ -599,12 +654,13 @@ Error ImageLoader::loadStb(FileInterface& fs, U32& width, U32& height, DynamicAr
 	return Error::NONE;
 }
 
-Error ImageLoader::load(ResourceFilePtr rfile, const CString& filename, U32 maxTextureSize)
+Error ImageLoader::load(ResourceFilePtr rfile, const CString& filename, U32 maxTextureSize,
+						ImageLoaderDataCompression preferredCompression)
 {
 	RsrcFile file;
 	file.m_rfile = rfile;
 
-	const Error err = loadInternal(file, filename, maxTextureSize);
+	const Error err = loadInternal(file, filename, maxTextureSize, preferredCompression);
 	if(err)
 	{
 		ANKI_RESOURCE_LOGE("Failed to read image: %s", filename.cstr());
@@ -613,12 +669,12 @@ Error ImageLoader::load(ResourceFilePtr rfile, const CString& filename, U32 maxT
 	return err;
 }
 
-Error ImageLoader::load(const CString& filename, U32 maxTextureSize)
+Error ImageLoader::load(const CString& filename, U32 maxTextureSize, ImageLoaderDataCompression preferredCompression)
 {
 	SystemFile file;
 	ANKI_CHECK(file.m_file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
 
-	const Error err = loadInternal(file, filename, maxTextureSize);
+	const Error err = loadInternal(file, filename, maxTextureSize, preferredCompression);
 	if(err)
 	{
 		ANKI_RESOURCE_LOGE("Failed to read image: %s", filename.cstr());
@@ -627,7 +683,8 @@ Error ImageLoader::load(const CString& filename, U32 maxTextureSize)
 	return err;
 }
 
-Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U32 maxTextureSize)
+Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U32 maxTextureSize,
+								ImageLoaderDataCompression preferredCompression)
 {
 	// get the extension
 	StringAuto ext(m_alloc);
@@ -671,11 +728,7 @@ Error ImageLoader::loadInternal(FileInterface& file, const CString& filename, U3
 	}
 	else if(ext == "ankitex")
 	{
-#if 0
-		compression = ImageLoaderDataCompression::RAW;
-#else
-		m_compression = ImageLoaderDataCompression::S3TC;
-#endif
+		m_compression = preferredCompression;
 
 		ANKI_CHECK(loadAnkiTexture(file, maxTextureSize, m_compression, m_surfaces, m_volumes, m_alloc, m_width,
 								   m_height, m_depth, m_layerCount, m_mipCount, m_textureType, m_colorFormat));
@@ -7,6 +7,7 @@
 
 #include <anki/resource/Common.h>
 #include <anki/resource/ResourceFilesystem.h>
+#include <anki/util/Array.h>
 
 namespace anki
 {
@@ -28,20 +29,31 @@ enum class ImageLoaderColorFormat : U32
 {
 	NONE,
 	RGB8, ///< RGB
-	RGBA8 ///< RGB plus alpha
+	RGBA8, ///< RGB plus alpha
+	R8, ///< Single channel. Its S3TC blocks are BC4.
+	RG8 ///< Two channels. Its S3TC blocks are BC5.
 };
 
-/// The data compression
+/// The data compression. The segments of an .ankitex are stored in the order of ANKITEX_SEGMENT_ORDER.
 /// @memberof ImageLoader
 enum class ImageLoaderDataCompression : U32
 {
 	NONE,
 	RAW = 1 << 0,
-	S3TC = 1 << 1,
-	ETC = 1 << 2
+	S3TC = 1 << 1, ///< BC1 for RGB8, BC3 for RGBA8, BC4 for R8 and BC5 for RG8.
+	ETC = 1 << 2,
+	S3TC_ZLIB = 1 << 3, ///< S3TC blocks split in streams and deflated per surface. Transcoded to S3TC at load time.
+	BC7 = 1 << 4, ///< Only for RGB8 and RGBA8.
+	ASTC = 1 << 5 ///< ASTC 4x4 LDR. Only for RGB8 and RGBA8.
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(ImageLoaderDataCompression)
 
+/// The order of the segments in an .ankitex file. S3TC_ZLIB is last because its size is only known after reading it.
+/// @memberof ImageLoader
+constexpr Array<ImageLoaderDataCompression, 6> ANKITEX_SEGMENT_ORDER = {
+	{ImageLoaderDataCompression::RAW, ImageLoaderDataCompression::S3TC, ImageLoaderDataCompression::ETC,
+	 ImageLoaderDataCompression::BC7, ImageLoaderDataCompression::ASTC, ImageLoaderDataCompression::S3TC_ZLIB}};
+
 /// An image surface
 /// @memberof ImageLoader
 class ImageLoaderSurface
@@ -63,6 +75,25 @@ public:
 	DynamicArray<U8> m_data;
 };
 
+/// The on-disk header of an .ankitex file.
+/// @memberof ImageLoader
+class AnkiTextureHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_width;
+	U32 m_height;
+	U32 m_depthOrLayerCount;
+	ImageLoaderTextureType m_type;
+	ImageLoaderColorFormat m_colorFormat;
+	ImageLoaderDataCompression m_compressionFormats;
+	U32 m_normal;
+	U32 m_mipCount;
+	U64 m_sourceHash; ///< Hash of the source images and the import options. Zero if unknown. Used by importers.
+	U8 m_padding[80];
+};
+static_assert(sizeof(AnkiTextureHeader) == 128, "Check sizeof AnkiTextureHeader");
+
 /// Loads bitmaps from regular system files or resource files. Supported formats are .tga and .ankitex.
 class ImageLoader
 {
@@ -128,10 +159,14 @@ public:
 	const ImageLoaderVolume& getVolume(U32 level) const;
 
 	/// Load a resource image file.
-	ANKI_USE_RESULT Error load(ResourceFilePtr file, const CString& filename, U32 maxTextureSize = MAX_U32);
+	/// @param preferredCompression The segment of .ankitex files to load. If it's not present S3TC and then RAW are
+	///                             tried.
+	ANKI_USE_RESULT Error load(ResourceFilePtr file, const CString& filename, U32 maxTextureSize = MAX_U32,
+							   ImageLoaderDataCompression preferredCompression = ImageLoaderDataCompression::S3TC);
 
 	/// Load a system image file.
-	ANKI_USE_RESULT Error load(const CString& filename, U32 maxTextureSize = MAX_U32);
+	ANKI_USE_RESULT Error load(const CString& filename, U32 maxTextureSize = MAX_U32,
+							   ImageLoaderDataCompression preferredCompression = ImageLoaderDataCompression::S3TC);
 
 private:
 	class FileInterface;
@@ -175,7 +210,8 @@ private:
 					GenericMemoryPoolAllocator<U8>& alloc, U32& width, U32& height, U32& depth, U32& layerCount,
 					U32& mipCount, ImageLoaderTextureType& textureType, ImageLoaderColorFormat& colorFormat);
 
-	ANKI_USE_RESULT Error loadInternal(FileInterface& file, const CString& filename, U32 maxTextureSize);
+	ANKI_USE_RESULT Error loadInternal(FileInterface& file, const CString& filename, U32 maxTextureSize,
+									   ImageLoaderDataCompression preferredCompression);
 };
 
 } // end namespace anki
@@ -0,0 +1,190 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/ImageTranscoder.h>
+#include <anki/math/Simd.h>
+#include <zlib.h>
+
+namespace anki
+{
+
+/// Layout of the streams of a BC1 surface: [color endpoints: 4B][color indices: 4B]
+/// Layout of the streams of a BC3 surface: [alpha endpoints: 2B][alpha indices: 6B][color endpoints: 4B][color
+/// indices: 4B]
+static void getStreamOffsets(U32 blockCount, Bool bc3, U32& alphaEndpoints, U32& alphaIndices, U32& colorEndpoints,
+							 U32& colorIndices)
+{
+	if(bc3)
+	{
+		alphaEndpoints = 0;
+		alphaIndices = blockCount * 2;
+		colorEndpoints = blockCount * 8;
+		colorIndices = blockCount * 12;
+	}
+	else
+	{
+		alphaEndpoints = alphaIndices = MAX_U32;
+		colorEndpoints = 0;
+		colorIndices = blockCount * 4;
+	}
+}
+
+void splitS3tcBlocks(ConstWeakArray<U8> blocks, Bool bc3, WeakArray<U8> streams)
+{
+	const U32 blockSize = (bc3) ? 16 : 8;
+	ANKI_ASSERT(blocks.getSize() == streams.getSize() && (blocks.getSize() % blockSize) == 0);
+	const U32 blockCount = blocks.getSize() / blockSize;
+
+	U32 alphaEndpoints, alphaIndices, colorEndpoints, colorIndices;
+	getStreamOffsets(blockCount, bc3, alphaEndpoints, alphaIndices, colorEndpoints, colorIndices);
+
+	for(U32 i = 0; i < blockCount; ++i)
+	{
+		const U8* block = &blocks[i * blockSize];
+
+		if(bc3)
+		{
+			memcpy(&streams[alphaEndpoints + i * 2], block, 2);
+			memcpy(&streams[alphaIndices + i * 6], block + 2, 6);
+			block += 8;
+		}
+
+		memcpy(&streams[colorEndpoints + i * 4], block, 4);
+		memcpy(&streams[colorIndices + i * 4], block + 4, 4);
+	}
+}
+
+void mergeS3tcBlocks(ConstWeakArray<U8> streams, Bool bc3, WeakArray<U8> blocks)
+{
+	const U32 blockSize = (bc3) ? 16 : 8;
+	ANKI_ASSERT(blocks.getSize() == streams.getSize() && (blocks.getSize() % blockSize) == 0);
+	const U32 blockCount = blocks.getSize() / blockSize;
+
+	U32 alphaEndpoints, alphaIndices, colorEndpoints, colorIndices;
+	getStreamOffsets(blockCount, bc3, alphaEndpoints, alphaIndices, colorEndpoints, colorIndices);
+
+	const U8* inEndpoints = &streams[colorEndpoints];
+	const U8* inIndices = &streams[colorIndices];
+	const U32 colorOffset = (bc3) ? 8 : 0;
+
+	// Interleave the color endpoints and indices 4 blocks at a time
+	U32 i = 0;
+#if ANKI_SIMD_SSE || ANKI_SIMD_NEON
+	for(; i + 4 <= blockCount; i += 4)
+	{
+#	if ANKI_SIMD_SSE
+		const __m128i endpoints = _mm_loadu_si128(reinterpret_cast<const __m128i*>(inEndpoints + i * 4));
+		const __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(inIndices + i * 4));
+		Array<__m128i, 2> colors = {{_mm_unpacklo_epi32(endpoints, indices), _mm_unpackhi_epi32(endpoints, indices)}};
+#	else
+		const uint32x4x2_t zipped = vzipq_u32(vld1q_u32(reinterpret_cast<const U32*>(inEndpoints + i * 4)),
+											  vld1q_u32(reinterpret_cast<const U32*>(inIndices + i * 4)));
+		Array<uint32x4_t, 2> colors = {{zipped.val[0], zipped.val[1]}};
+#	endif
+
+		if(!bc3)
+		{
+			// Blocks are tightly packed, store directly
+			memcpy(&blocks[i * 8], &colors[0], 32);
+		}
+		else
+		{
+			// Gather the alpha half of every block. The indices are read 8 bytes at a time and the extra 2 are shifted
+			// out. The last read stays in the buffer because the color endpoints follow the alpha indices
+			Array<U64, 4> alphas;
+			for(U32 j = 0; j < 4; ++j)
+			{
+				U16 alphaEndpoint;
+				U64 alphaIndex;
+				memcpy(&alphaEndpoint, &streams[alphaEndpoints + (i + j) * 2], 2);
+				memcpy(&alphaIndex, &streams[alphaIndices + (i + j) * 6], 8);
+				alphas[j] = U64(alphaEndpoint) | (alphaIndex << U64(16));
+			}
+
+			// Every block is its alpha and its color half
+			U8* block = &blocks[i * 16];
+#	if ANKI_SIMD_SSE
+			const __m128i alpha01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&alphas[0]));
+			const __m128i alpha23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&alphas[2]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(block + 0), _mm_unpacklo_epi64(alpha01, colors[0]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(block + 16), _mm_unpackhi_epi64(alpha01, colors[0]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(block + 32), _mm_unpacklo_epi64(alpha23, colors[1]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(block + 48), _mm_unpackhi_epi64(alpha23, colors[1]));
+#	else
+			for(U32 j = 0; j < 4; ++j)
+			{
+				const uint64x2_t color = vreinterpretq_u64_u32(colors[j / 2]);
+				const uint64x1_t colorHalf = (j % 2) ? vget_high_u64(color) : vget_low_u64(color);
+				vst1q_u64(reinterpret_cast<U64*>(block + j * 16), vcombine_u64(vdup_n_u64(alphas[j]), colorHalf));
+			}
+#	endif
+		}
+	}
+#endif
+
+	// Remaining blocks
+	for(; i < blockCount; ++i)
+	{
+		U8* block = &blocks[i * blockSize];
+
+		if(bc3)
+		{
+			memcpy(block, &streams[alphaEndpoints + i * 2], 2);
+			memcpy(block + 2, &streams[alphaIndices + i * 6], 6);
+		}
+
+		memcpy(block + colorOffset, inEndpoints + i * 4, 4);
+		memcpy(block + colorOffset + 4, inIndices + i * 4, 4);
+	}
+}
+
+Error compressS3tcZlib(ConstWeakArray<U8> blocks, Bool bc3, DynamicArrayAuto<U8>& out)
+{
+	DynamicArrayAuto<U8> streams(out.getAllocator());
+	streams.create(blocks.getSize());
+	splitS3tcBlocks(blocks, bc3, WeakArray<U8>(streams));
+
+	uLongf compressedSize = compressBound(streams.getSize());
+	out.create(U32(compressedSize));
+	const int ret = compress2(&out[0], &compressedSize, &streams[0], streams.getSize(), Z_BEST_COMPRESSION);
+	if(ret != Z_OK)
+	{
+		ANKI_RESOURCE_LOGE("compress2() failed: %d", ret);
+		return Error::FUNCTION_FAILED;
+	}
+
+	out.resize(U32(compressedSize));
+	return Error::NONE;
+}
+
+PtrSize computeS3tcZlibMaxSize(PtrSize blocksSize)
+{
+	return compressBound(uLong(blocksSize));
+}
+
+Error transcodeS3tcZlib(ConstWeakArray<U8> in, Bool bc3, GenericMemoryPoolAllocator<U8> alloc, WeakArray<U8> blocks)
+{
+	if(in.getSize() == 0)
+	{
+		ANKI_RESOURCE_LOGE("Empty S3TC_ZLIB surface");
+		return Error::USER_DATA;
+	}
+
+	DynamicArrayAuto<U8> streams(alloc);
+	streams.create(blocks.getSize());
+
+	uLongf uncompressedSize = streams.getSize();
+	const int ret = uncompress(&streams[0], &uncompressedSize, &in[0], in.getSize());
+	if(ret != Z_OK || uncompressedSize != streams.getSize())
+	{
+		ANKI_RESOURCE_LOGE("uncompress() failed or the surface has the wrong size: %d", ret);
+		return Error::USER_DATA;
+	}
+
+	mergeS3tcBlocks(ConstWeakArray<U8>(streams), bc3, blocks);
+	return Error::NONE;
+}
+
+} // end namespace anki
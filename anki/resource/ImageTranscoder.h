@@ -0,0 +1,43 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// Reorder S3TC blocks so all the endpoints and all the indices of a surface are stored contiguously. Similar data next
+/// to each other compresses a lot better.
+/// @param blocks The BC1 (8 bytes per block) or BC3 (16 bytes per block) data.
+/// @param bc3 True if the blocks are BC3.
+/// @param[out] streams Same size as blocks.
+void splitS3tcBlocks(ConstWeakArray<U8> blocks, Bool bc3, WeakArray<U8> streams);
+
+/// The inverse of splitS3tcBlocks(). It's SIMD accelerated since it runs at load time.
+void mergeS3tcBlocks(ConstWeakArray<U8> streams, Bool bc3, WeakArray<U8> blocks);
+
+/// Split and deflate S3TC blocks. Used by the importers to write the S3TC_ZLIB segments of ankitex.
+ANKI_USE_RESULT Error compressS3tcZlib(ConstWeakArray<U8> blocks, Bool bc3, DynamicArrayAuto<U8>& out);
+
+/// The max size a S3TC_ZLIB surface can have. Used to reject corrupt surface sizes before reading them.
+/// @param blocksSize The size of the uncompressed S3TC surface.
+PtrSize computeS3tcZlibMaxSize(PtrSize blocksSize);
+
+/// Inflate and merge a S3TC_ZLIB surface back to S3TC blocks that can be uploaded to the GPU.
+/// @param in The compressed surface.
+/// @param bc3 True if the blocks are BC3.
+/// @param alloc Allocator for some temporary memory.
+/// @param[out] blocks The uncompressed S3TC surface. Its size should be known beforehand.
+ANKI_USE_RESULT Error transcodeS3tcZlib(ConstWeakArray<U8> in, Bool bc3, GenericMemoryPoolAllocator<U8> alloc,
+										WeakArray<U8> blocks);
+/// @}
+
+} // end namespace anki
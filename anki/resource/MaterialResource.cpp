@@ -31,10 +31,13 @@ static const Array<BuiltinVarInfo, U(BuiltinMaterialVariableId::COUNT)> BUILTIN_
 	 {"m_ankiProjectionMatrix", ShaderVariableDataType::MAT4, false},
 	 {"m_ankiModelViewMatrix", ShaderVariableDataType::MAT4, true},
 	 {"m_ankiViewProjectionMatrix", ShaderVariableDataType::MAT4, false},
+	 {"m_ankiPreviousViewProjectionMatrix", ShaderVariableDataType::MAT4, false},
+	 {"m_ankiPositionDequantizationMatrix", ShaderVariableDataType::MAT4, false},
 	 {"m_ankiNormalMatrix", ShaderVariableDataType::MAT3, true},
 	 {"m_ankiRotationMatrix", ShaderVariableDataType::MAT3, true},
 	 {"m_ankiCameraRotationMatrix", ShaderVariableDataType::MAT3, false},
 	 {"m_ankiCameraPosition", ShaderVariableDataType::VEC3, false},
+	 {"m_ankiGpuSceneSlot", ShaderVariableDataType::U32, true},
 	 {"u_ankiGlobalSampler", ShaderVariableDataType::SAMPLER, false}}};
 
 static ANKI_USE_RESULT Error checkBuiltin(CString name, ShaderVariableDataType dataType, Bool instanced,
@@ -700,6 +703,37 @@ Error MaterialResource::createVars()
 
 	m_descriptorSetIdx = U8(descriptorSet);
 
+	// The GPU scene and the instance remap are optional
+	for(const ShaderProgramBinaryBlock& block : binary.m_storageBlocks)
+	{
+		if(block.m_name.getBegin() == CString("b_ankiGpuScene"))
+		{
+			if(block.m_set != m_descriptorSetIdx)
+			{
+				ANKI_RESOURCE_LOGE("The set of b_ankiGpuScene should be %u", m_descriptorSetIdx);
+				return Error::USER_DATA;
+			}
+
+			m_gpuSceneBinding = block.m_binding;
+		}
+		else if(block.m_name.getBegin() == CString("b_ankiInstanceRemap"))
+		{
+			if(block.m_set != m_descriptorSetIdx)
+			{
+				ANKI_RESOURCE_LOGE("The set of b_ankiInstanceRemap should be %u", m_descriptorSetIdx);
+				return Error::USER_DATA;
+			}
+
+			m_instanceRemapBinding = block.m_binding;
+		}
+	}
+
+	if(m_instanceRemapBinding != MAX_U32 && m_gpuSceneBinding == MAX_U32)
+	{
+		ANKI_RESOURCE_LOGE("b_ankiInstanceRemap holds GPU scene slots so b_ankiGpuScene is required");
+		return Error::USER_DATA;
+	}
+
 	// Consts
 	for(const ShaderProgramResourceConstant& c : m_prog->getConstants())
 	{
@@ -805,9 +839,8 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 	return Error::NONE;
 }
 
-const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey& key_) const
+MaterialVariant& MaterialResource::getVariantSlot(RenderingKey& key) const
 {
-	RenderingKey key = key_;
 	key.setLod(min<U32>(m_lodCount - 1, key.getLod()));
 
 	if(!isInstanced())
@@ -820,23 +853,32 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 
 	key.setInstanceCount(1 << getInstanceGroupIdx(key.getInstanceCount()));
 
-	MaterialVariant& variant = m_variantMatrix[key.getPass()][key.getLod()][getInstanceGroupIdx(key.getInstanceCount())]
-											  [key.isSkinned()][key.hasVelocity()];
+	return m_variantMatrix[key.getPass()][key.getLod()][getInstanceGroupIdx(key.getInstanceCount())][key.isSkinned()]
+						  [key.hasVelocity()];
+}
+
+Bool MaterialResource::isVariantCreated(const RenderingKey& key_) const
+{
+	RenderingKey key = key_;
+	return getVariantSlot(key).m_initialized.load(AtomicMemoryOrder::ACQUIRE) != 0;
+}
+
+const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey& key_) const
+{
+	RenderingKey key = key_;
+	MaterialVariant& variant = getVariantSlot(key);
 
 	// Check if it's initialized
+	if(variant.m_initialized.load(AtomicMemoryOrder::ACQUIRE))
 	{
-		RLockGuard<RWMutex> lock(m_variantMatrixMtx);
-		if(variant.m_prog.isCreated())
-		{
-			return variant;
-		}
+		return variant;
 	}
 
 	// Not initialized, init it
-	WLockGuard<RWMutex> lock(m_variantMatrixMtx);
+	LockGuard<Mutex> lock(m_variantMatrixMtx);
 
 	// Check again
-	if(variant.m_prog.isCreated())
+	if(variant.m_initialized.load(AtomicMemoryOrder::RELAXED))
 	{
 		return variant;
 	}
@@ -904,10 +946,41 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 
 	// Init the variant
 	initVariant(*progVariant, variant, key.getInstanceCount());
+	variant.m_initialized.store(1, AtomicMemoryOrder::RELEASE);
 
 	return variant;
 }
 
+void MaterialResource::warmupVariants(Bool skinned) const
+{
+	skinned = skinned && m_builtinMutators[BuiltinMutatorId::BONES] != nullptr;
+	const U32 instanceGroupCount = (isInstanced()) ? MAX_INSTANCE_GROUPS : 1;
+
+	for(Pass pass : EnumIterable<Pass>())
+	{
+		// Forward shading materials are drawn only in the FS pass and the rest in all the others
+		if((pass == Pass::FS) != m_forwardShading || (pass == Pass::SM && !m_shadow))
+		{
+			continue;
+		}
+
+		// Only the GBuffer pass draws velocity
+		const U32 velocityCount = (pass == Pass::GB && m_builtinMutators[BuiltinMutatorId::VELOCITY]) ? 2 : 1;
+
+		for(U32 lod = 0; lod < m_lodCount; ++lod)
+		{
+			for(U32 instanceGroup = 0; instanceGroup < instanceGroupCount; ++instanceGroup)
+			{
+				for(U32 velocity = 0; velocity < velocityCount; ++velocity)
+				{
+					const RenderingKey key(pass, lod, 1 << instanceGroup, skinned, velocity != 0);
+					getOrCreateVariant(key);
+				}
+			}
+		}
+	}
+}
+
 void MaterialResource::initVariant(const ShaderProgramResourceVariant& progVariant, MaterialVariant& variant,
 								   U32 instanceCount) const
 {
@@ -33,10 +33,13 @@ enum class BuiltinMaterialVariableId : U8
 	PROJECTION_MATRIX,
 	MODEL_VIEW_MATRIX,
 	VIEW_PROJECTION_MATRIX,
+	PREVIOUS_VIEW_PROJECTION_MATRIX,
+	POSITION_DEQUANTIZATION_MATRIX,
 	NORMAL_MATRIX,
 	ROTATION_MATRIX,
 	CAMERA_ROTATION_MATRIX,
 	CAMERA_POSITION,
+	GPU_SCENE_SLOT,
 	GLOBAL_SAMPLER,
 
 	COUNT,
@@ -248,6 +251,7 @@ private:
 	DynamicArray<I16> m_opaqueBindings;
 	BitSet<128, U32> m_activeVars = {false};
 	U32 m_uniBlockSize = 0;
+	Atomic<U32> m_initialized = {0}; ///< Set when the rest of the members are ready to be read without locking.
 };
 
 /// Material resource.
@@ -334,14 +338,37 @@ public:
 		return m_prevFrameBoneTrfsBinding;
 	}
 
+	/// The binding of the b_ankiGpuScene storage block or MAX_U32 if the program doesn't read the GPU scene.
+	U32 getGpuSceneBinding() const
+	{
+		return m_gpuSceneBinding;
+	}
+
+	/// The binding of the b_ankiInstanceRemap storage block or MAX_U32 if the program can't be drawn by the GPU
+	/// instance culling. The non instanced variants use it.
+	U32 getInstanceRemapBinding() const
+	{
+		return m_instanceRemapBinding;
+	}
+
 	U32 getUniformsBinding() const
 	{
 		ANKI_ASSERT(m_uboBinding != MAX_U32);
 		return m_uboBinding;
 	}
 
+	/// Get a variant. If the variant was created before (see warmupVariants()) it doesn't lock.
+	/// @note It's thread-safe.
 	const MaterialVariant& getOrCreateVariant(const RenderingKey& key) const;
 
+	/// Check if a variant is created. If it is getOrCreateVariant() will return it without locking.
+	/// @note It's thread-safe.
+	Bool isVariantCreated(const RenderingKey& key) const;
+
+	/// Create all variants that a model can use at render time so the rendering won't have to create them.
+	/// @param skinned True if the model has a skeleton.
+	void warmupVariants(Bool skinned) const;
+
 	U32 getShaderGroupHandleIndex(RayType type) const
 	{
 		ANKI_ASSERT(!!(m_rayTypes & RayTypeBit(1 << type)));
@@ -386,10 +413,12 @@ private:
 	U32 m_uboBinding = MAX_U32;
 	U32 m_boneTrfsBinding = MAX_U32;
 	U32 m_prevFrameBoneTrfsBinding = MAX_U32;
+	U32 m_gpuSceneBinding = MAX_U32;
+	U32 m_instanceRemapBinding = MAX_U32;
 
 	/// Matrix of variants.
 	mutable Array5d<MaterialVariant, U(Pass::COUNT), MAX_LOD_COUNT, MAX_INSTANCE_GROUPS, 2, 2> m_variantMatrix;
-	mutable RWMutex m_variantMatrixMtx;
+	mutable Mutex m_variantMatrixMtx; ///< Protects the creation of the variants.
 
 	DynamicArray<MaterialVariable> m_vars;
 
@@ -418,6 +447,9 @@ private:
 
 	static U32 getInstanceGroupIdx(U32 instanceCount);
 
+	/// Get the slot of a variant in m_variantMatrix. It will also adjust the key to the variant's.
+	MaterialVariant& getVariantSlot(RenderingKey& key) const;
+
 	void initVariant(const ShaderProgramResourceVariant& progVariant, MaterialVariant& variant,
 					 U32 instanceCount) const;
 
@@ -18,6 +18,7 @@ MeshLoader::MeshLoader(ResourceManager* manager)
 MeshLoader::~MeshLoader()
 {
 	m_subMeshes.destroy(m_alloc);
+	m_meshlets.destroy(m_alloc);
 }
 
 Error MeshLoader::load(const ResourceFilename& filename)
@@ -26,7 +27,16 @@ Error MeshLoader::load(const ResourceFilename& filename)
 
 	// Load header
 	ANKI_CHECK(m_manager->getFilesystem().openFile(filename, m_file));
-	ANKI_CHECK(m_file->read(&m_header, sizeof(m_header)));
+	ANKI_CHECK(m_file->read(&m_header, MeshBinaryFile::HEADER_SIZE_V4));
+	const Bool v4 = memcmp(&m_header.m_magic[0], MeshBinaryFile::MAGIC_V4, 8) == 0;
+	if(v4)
+	{
+		m_header.m_meshletCount = 0;
+	}
+	else
+	{
+		ANKI_CHECK(m_file->read(&m_header.m_meshletCount, sizeof(m_header.m_meshletCount)));
+	}
 	ANKI_CHECK(checkHeader());
 
 	// Read submesh info
@@ -65,6 +75,14 @@ Error MeshLoader::load(const ResourceFilename& filename)
 		}
 	}
 
+	// Read the meshlets
+	if(m_header.m_meshletCount)
+	{
+		m_meshlets.create(alloc, m_header.m_meshletCount);
+		ANKI_CHECK(m_file->read(&m_meshlets[0], m_meshlets.getSizeInBytes()));
+		ANKI_CHECK(checkMeshlets());
+	}
+
 	// Read vert buffer info
 	{
 		U32 vertBufferMask = 0;
@@ -95,9 +113,10 @@ Error MeshLoader::load(const ResourceFilename& filename)
 
 	// Count and check the file size
 	{
-		U32 totalSize = sizeof(m_header);
+		U32 totalSize = U32((v4) ? MeshBinaryFile::HEADER_SIZE_V4 : sizeof(m_header));
 
 		totalSize += sizeof(MeshBinaryFile::SubMesh) * m_header.m_subMeshCount;
+		totalSize += sizeof(MeshBinaryFile::Meshlet) * m_header.m_meshletCount;
 		totalSize += U32(getIndexBufferSize());
 
 		for(U i = 0; i < m_header.m_vertexBufferCount; ++i)
@@ -143,8 +162,16 @@ Error MeshLoader::checkFormat(VertexAttributeLocation type, ConstWeakArray<Forma
 		return Error::NONE;
 	}
 
-	// Scale should be 1.0 for now
-	if(attrib.m_scale != 1.0f)
+	// Quantized positions need a scale. All the rest should have 1.0 for now
+	if(type == VertexAttributeLocation::POSITION && attrib.m_format == Format::R16G16B16A16_SNORM)
+	{
+		if(!(attrib.m_scale > 0.0f))
+		{
+			ANKI_RESOURCE_LOGE("Quantized positions should have a positive scale");
+			return Error::USER_DATA;
+		}
+	}
+	else if(attrib.m_scale != 1.0f)
 	{
 		ANKI_RESOURCE_LOGE("Vertex attribute %u should have 1.0 scale", U32(type));
 		return Error::USER_DATA;
@@ -158,7 +185,7 @@ Error MeshLoader::checkHeader() const
 	const MeshBinaryFile::Header& h = m_header;
 
 	// Header
-	if(memcmp(&h.m_magic[0], MeshBinaryFile::MAGIC, 8) != 0)
+	if(memcmp(&h.m_magic[0], MeshBinaryFile::MAGIC, 8) != 0 && memcmp(&h.m_magic[0], MeshBinaryFile::MAGIC_V4, 8) != 0)
 	{
 		ANKI_RESOURCE_LOGE("Wrong magic word");
 		return Error::USER_DATA;
@@ -172,8 +199,9 @@ Error MeshLoader::checkHeader() const
 	}
 
 	// Attributes
-	ANKI_CHECK(checkFormat(VertexAttributeLocation::POSITION,
-						   Array<Format, 2>{{Format::R16G16B16A16_SFLOAT, Format::R32G32B32_SFLOAT}}));
+	ANKI_CHECK(checkFormat(
+		VertexAttributeLocation::POSITION,
+		Array<Format, 3>{{Format::R16G16B16A16_SFLOAT, Format::R32G32B32_SFLOAT, Format::R16G16B16A16_SNORM}}));
 	ANKI_CHECK(checkFormat(VertexAttributeLocation::NORMAL, Array<Format, 1>{{Format::A2B10G10R10_SNORM_PACK32}}));
 	ANKI_CHECK(checkFormat(VertexAttributeLocation::TANGENT, Array<Format, 1>{{Format::A2B10G10R10_SNORM_PACK32}}));
 	ANKI_CHECK(
@@ -183,6 +211,14 @@ Error MeshLoader::checkHeader() const
 	ANKI_CHECK(
 		checkFormat(VertexAttributeLocation::BONE_WEIGHTS, Array<Format, 2>{{Format::NONE, Format::R8G8B8A8_UNORM}}));
 
+	// The quantization is applied on the model transform so it can't work with skinning
+	if(h.m_vertexAttributes[VertexAttributeLocation::POSITION].m_format == Format::R16G16B16A16_SNORM
+	   && h.m_vertexAttributes[VertexAttributeLocation::BONE_INDICES].m_format != Format::NONE)
+	{
+		ANKI_RESOURCE_LOGE("Skinned meshes can't have quantized positions");
+		return Error::USER_DATA;
+	}
+
 	// Indices format
 	if(h.m_indexType != IndexType::U16 && h.m_indexType != IndexType::U32)
 	{
@@ -225,6 +261,70 @@ Error MeshLoader::checkHeader() const
 	return Error::NONE;
 }
 
+Error MeshLoader::checkMeshlets() const
+{
+	const U32 indicesPerFace = !!(m_header.m_flags & MeshBinaryFile::Flag::QUAD) ? 4 : 3;
+	if(indicesPerFace != 3)
+	{
+		ANKI_RESOURCE_LOGE("Meshlets are only supported for triangles");
+		return Error::USER_DATA;
+	}
+
+	U32 idxSum = 0;
+	U32 subMeshIdx = 0;
+	for(const MeshBinaryFile::Meshlet& meshlet : m_meshlets)
+	{
+		if(meshlet.m_firstIndex != idxSum || meshlet.m_indexCount == 0 || (meshlet.m_indexCount % 3) != 0
+		   || meshlet.m_indexCount > MeshBinaryFile::MAX_MESHLET_TRIANGLES * 3)
+		{
+			ANKI_RESOURCE_LOGE("Incorrect meshlet info");
+			return Error::USER_DATA;
+		}
+
+		// Shouldn't cross submeshes
+		const MeshBinaryFile::SubMesh* sm = &m_subMeshes[subMeshIdx];
+		if(meshlet.m_firstIndex >= sm->m_firstIndex + sm->m_indexCount)
+		{
+			++subMeshIdx;
+			sm = (subMeshIdx < m_subMeshes.getSize()) ? &m_subMeshes[subMeshIdx] : nullptr;
+		}
+
+		if(!sm || meshlet.m_firstIndex + meshlet.m_indexCount > sm->m_firstIndex + sm->m_indexCount)
+		{
+			ANKI_RESOURCE_LOGE("Meshlet crosses submeshes");
+			return Error::USER_DATA;
+		}
+
+		if(!(meshlet.m_sphereRadius >= 0.0f) || !(meshlet.m_coneCutoff >= 0.0f && meshlet.m_coneCutoff <= 1.0f))
+		{
+			ANKI_RESOURCE_LOGE("Incorrect meshlet bounds");
+			return Error::USER_DATA;
+		}
+
+		idxSum += meshlet.m_indexCount;
+	}
+
+	if(idxSum != m_header.m_totalIndexCount)
+	{
+		ANKI_RESOURCE_LOGE("Meshlets don't cover all the indices");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Transform MeshLoader::getPositionDequantizationTransform() const
+{
+	if(!hasQuantizedPositions())
+	{
+		return Transform::getIdentity();
+	}
+
+	const Vec3 center = (m_header.m_aabbMin + m_header.m_aabbMax) / 2.0f;
+	return Transform(center.xyz0(), Mat3x4::getIdentity(),
+					 m_header.m_vertexAttributes[VertexAttributeLocation::POSITION].m_scale);
+}
+
 Error MeshLoader::storeIndexBuffer(void* ptr, PtrSize size)
 {
 	ANKI_ASSERT(isLoaded());
@@ -308,6 +408,7 @@ Error MeshLoader::storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, Dynami
 		ANKI_CHECK(storeVertexBuffer(attrib.m_bufferBinding, &staging[0], staging.getSizeInBytes()));
 
 		// Copy
+		const Transform dequantization = getPositionDequantizationTransform();
 		for(U32 i = 0; i < m_header.m_totalVertexCount; ++i)
 		{
 			Vec3 vert(0.0f);
@@ -323,6 +424,18 @@ Error MeshLoader::storeIndicesAndPosition(DynamicArrayAuto<U32>& indices, Dynami
 				vert[1] = f16[1].toF32();
 				vert[2] = f16[2].toF32();
 			}
+			else if(attrib.m_format == Format::R16G16B16A16_SNORM)
+			{
+				const I16* snorm =
+					reinterpret_cast<I16*>(&staging[i * buffInfo.m_vertexStride + attrib.m_relativeOffset]);
+
+				for(U32 c = 0; c < 3; ++c)
+				{
+					vert[c] = max(F32(snorm[c]) / F32(MAX_I16), -1.0f);
+				}
+
+				vert = dequantization.transform(vert);
+			}
 			else
 			{
 				ANKI_ASSERT(0);
@@ -21,7 +21,14 @@ namespace anki
 class MeshBinaryFile
 {
 public:
-	static constexpr const char* MAGIC = "ANKIMES4";
+	/// Version 6 adds meshlets and quantized positions. Version 5 is taken by MeshBinary.h.
+	static constexpr const char* MAGIC = "ANKIMES6";
+
+	/// The previous version. It's still loaded.
+	static constexpr const char* MAGIC_V4 = "ANKIMES4";
+
+	static constexpr U32 MAX_MESHLET_VERTICES = 64;
+	static constexpr U32 MAX_MESHLET_TRIANGLES = 124;
 
 	enum class Flag : U32
 	{
@@ -54,6 +61,22 @@ public:
 		Vec3 m_aabbMax; ///< Bounding box max.
 	};
 
+	/// A small cluster of triangles of a submesh that can be culled as a unit. The meshlets cover the index buffer in
+	/// order and none crosses a submesh boundary.
+	///
+	/// The meshlet is backfacing and can be culled if:
+	/// dot(m_sphereCenter - eye, m_coneAxis) >= m_coneCutoff * length(m_sphereCenter - eye) + m_sphereRadius
+	/// A m_coneCutoff of 1.0 means that the normals are too spread and the cone test can't cull anything.
+	struct Meshlet
+	{
+		U32 m_firstIndex;
+		U32 m_indexCount; ///< At most MAX_MESHLET_TRIANGLES * 3.
+		Vec3 m_sphereCenter; ///< Bounding sphere center. In model space.
+		F32 m_sphereRadius;
+		Vec3 m_coneAxis; ///< Average normal of the triangles.
+		F32 m_coneCutoff; ///< The sine of the cone's half angle.
+	};
+
 	struct Header
 	{
 		char m_magic[8]; ///< Magic word.
@@ -73,7 +96,13 @@ public:
 
 		Vec3 m_aabbMin; ///< Bounding box min.
 		Vec3 m_aabbMax; ///< Bounding box max.
+
+		/// Not present in version 4. The meshlets follow the submeshes in the file.
+		U32 m_meshletCount;
 	};
+
+	/// The size of the header in version 4 files.
+	static constexpr PtrSize HEADER_SIZE_V4 = offsetof(Header, m_meshletCount);
 };
 
 /// Mesh data. This class loads the mesh file and the Mesh class loads it to the CPU.
@@ -116,6 +145,24 @@ public:
 		return ConstWeakArray<MeshBinaryFile::SubMesh>(m_subMeshes);
 	}
 
+	/// Empty for version 4 files.
+	ConstWeakArray<MeshBinaryFile::Meshlet> getMeshlets() const
+	{
+		return ConstWeakArray<MeshBinaryFile::Meshlet>(m_meshlets);
+	}
+
+	/// Return true if the positions are stored in R16G16B16A16_SNORM relative to the bounding box. Use
+	/// getPositionDequantizationTransform() to bring them to model space.
+	Bool hasQuantizedPositions() const
+	{
+		ANKI_ASSERT(isLoaded());
+		return m_header.m_vertexAttributes[VertexAttributeLocation::POSITION].m_format == Format::R16G16B16A16_SNORM;
+	}
+
+	/// The transform that brings the positions of the vertex buffer to model space. It's the identity if the
+	/// positions are not quantized.
+	Transform getPositionDequantizationTransform() const;
+
 private:
 	ResourceManager* m_manager;
 	GenericMemoryPoolAllocator<U8> m_alloc;
@@ -125,6 +172,7 @@ private:
 	MeshBinaryFile::Header m_header;
 
 	DynamicArray<MeshBinaryFile::SubMesh> m_subMeshes;
+	DynamicArray<MeshBinaryFile::Meshlet> m_meshlets;
 
 	U32 m_loadedChunk = 0; ///< Because the store methods need to be called in sequence.
 
@@ -139,6 +187,7 @@ private:
 	}
 
 	ANKI_USE_RESULT Error checkHeader() const;
+	ANKI_USE_RESULT Error checkMeshlets() const;
 	ANKI_USE_RESULT Error checkFormat(VertexAttributeLocation type, ConstWeakArray<Format> supportedFormats) const;
 };
 /// @}
@@ -54,6 +54,7 @@ MeshResource::~MeshResource()
 {
 	m_subMeshes.destroy(getAllocator());
 	m_vertBufferInfos.destroy(getAllocator());
+	m_meshlets.destroy(getAllocator());
 }
 
 Bool MeshResource::isCompatible(const MeshResource& other) const
@@ -105,6 +106,18 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 		m_subMeshes[i].m_obb = Obb(obbCenter.xyz0(), Mat3x4::getIdentity(), obbExtend.xyz0());
 	}
 
+	// Get meshlets
+	m_meshlets.create(getAllocator(), loader.getMeshlets().getSize());
+	for(U32 i = 0; i < m_meshlets.getSize(); ++i)
+	{
+		const MeshBinaryFile::Meshlet& in = loader.getMeshlets()[i];
+		Meshlet& out = m_meshlets[i];
+		out.m_firstIndex = in.m_firstIndex;
+		out.m_indexCount = in.m_indexCount;
+		out.m_boundingSphere = Vec4(in.m_sphereCenter, in.m_sphereRadius);
+		out.m_normalCone = Vec4(in.m_coneAxis, in.m_coneCutoff);
+	}
+
 	// Index stuff
 	m_indexCount = header.m_totalIndexCount;
 	ANKI_ASSERT((m_indexCount % 3) == 0 && "Expecting triangles");
@@ -158,10 +171,12 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 			out.m_fmt = in.m_format;
 			out.m_relativeOffset = in.m_relativeOffset;
 			out.m_buffIdx = U8(in.m_bufferBinding);
-			ANKI_ASSERT(in.m_scale == 1.0f && "Not supported ATM");
+			ANKI_ASSERT((in.m_scale == 1.0f || attrib == VertexAttributeLocation::POSITION) && "Not supported ATM");
 		}
 	}
 
+	m_positionDequantization = loader.getPositionDequantizationTransform();
+
 	// Other
 	const Vec3 obbCenter = (header.m_aabbMax + header.m_aabbMin) / 2.0f;
 	const Vec3 obbExtend = header.m_aabbMax - obbCenter;
@@ -55,6 +55,29 @@ public:
 		return m_subMeshes.getSize();
 	}
 
+	/// A cluster of triangles that can be culled as a unit. See MeshBinaryFile::Meshlet for the culling tests.
+	class Meshlet
+	{
+	public:
+		U32 m_firstIndex;
+		U32 m_indexCount;
+		Vec4 m_boundingSphere; ///< Center in xyz and radius in w. In model space.
+		Vec4 m_normalCone; ///< Axis in xyz and cutoff in w.
+	};
+
+	/// Get the meshlets of all submeshes. It's empty for older mesh files.
+	ConstWeakArray<Meshlet> getMeshlets() const
+	{
+		return ConstWeakArray<Meshlet>(m_meshlets);
+	}
+
+	/// The positions might be quantized. This transform brings them to model space and it should be combined with the
+	/// world transform of the instances. It's the identity for meshes with float positions.
+	const Transform& getPositionDequantizationTransform() const
+	{
+		return m_positionDequantization;
+	}
+
 	/// Get all info around vertex indices.
 	void getIndexBufferInfo(BufferPtr& buff, PtrSize& buffOffset, U32& indexCount, IndexType& indexType) const
 	{
@@ -144,6 +167,7 @@ private:
 		Obb m_obb;
 	};
 	DynamicArray<SubMesh> m_subMeshes;
+	DynamicArray<Meshlet> m_meshlets;
 
 	// Index stuff
 	U32 m_indexCount = 0;
@@ -175,6 +199,7 @@ private:
 
 	// Other
 	Obb m_obb;
+	Transform m_positionDequantization = Transform::getIdentity();
 
 	// RT
 	AccelerationStructurePtr m_blas;
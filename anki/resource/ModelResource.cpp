@@ -102,6 +102,7 @@ void ModelPatch::getRenderingInfo(const RenderingKey& key, WeakArray<U8> subMesh
 	inf.m_drawcallCount = 1;
 	inf.m_indicesOffsetArray[0] = 0;
 	inf.m_indicesCountArray[0] = indexCount;
+	inf.m_positionDequantization = mesh.getPositionDequantizationTransform();
 }
 
 void ModelPatch::getRayTracingInfo(U32 lod, ModelRayTracingInfo& info) const
@@ -115,6 +116,7 @@ void ModelPatch::getRayTracingInfo(U32 lod, ModelRayTracingInfo& info) const
 	const MeshResourcePtr& mesh = m_meshes[min(U32(m_meshCount - 1), lod)];
 	info.m_bottomLevelAccelerationStructure = mesh->getBottomLevelAccelerationStructure();
 	info.m_descriptor.m_mesh = mesh->getMeshGpuDescriptor();
+	info.m_positionDequantization = mesh->getPositionDequantizationTransform();
 	info.m_grObjectReferences[info.m_grObjectReferenceCount++] = mesh->getIndexBuffer();
 	info.m_grObjectReferences[info.m_grObjectReferenceCount++] = mesh->getVertexBuffer();
 
@@ -275,6 +277,12 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 		ANKI_CHECK(getManager().loadResource(fname, m_skeleton));
 	}
 
+	// Create the material variants now that it's known if the model is skinned. The rendering will only look them up
+	for(const ModelPatch& patch : m_modelPatches)
+	{
+		patch.getMaterial()->warmupVariants(m_skeleton.isCreated());
+	}
+
 	// Calculate compound bounding volume
 	RenderingKey key;
 	key.setLod(0);
@@ -78,6 +78,10 @@ public:
 
 	U32 m_boneTransformsBinding;
 	U32 m_prevFrameBoneTransformsBinding;
+
+	/// Combine it with the world transform to get the final model matrix. See
+	/// MeshResource::getPositionDequantizationTransform().
+	Transform m_positionDequantization;
 };
 
 /// Part of the information required to create a TLAS and a SBT.
@@ -88,6 +92,9 @@ public:
 	AccelerationStructurePtr m_bottomLevelAccelerationStructure;
 	Array<U32, U(RayType::COUNT)> m_shaderGroupHandleIndices;
 
+	/// Combine it with the world transform of the instance. See MeshResource::getPositionDequantizationTransform().
+	Transform m_positionDequantization;
+
 	/// Get some pointers that the m_descriptor is pointing to. Use these pointers for life tracking.
 	Array<GrObjectPtr, TEXTURE_CHANNEL_COUNT + 2> m_grObjectReferences;
 	U32 m_grObjectReferenceCount;
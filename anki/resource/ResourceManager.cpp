@@ -52,6 +52,10 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	m_maxTextureSize = init.m_config->getNumberU32("rsrc_maxTextureSize");
 	m_dumpShaderSource = init.m_config->getBool("rsrc_dumpShaderSources");
 
+	const Array<ImageLoaderDataCompression, 3> textureCompressions = {
+		{ImageLoaderDataCompression::S3TC, ImageLoaderDataCompression::BC7, ImageLoaderDataCompression::ASTC}};
+	m_preferredTextureCompression = textureCompressions[init.m_config->getNumberU32("rsrc_textureCompression")];
+
 	// Init type resource managers
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) TypeResourceManager<rsrc_>::init(m_alloc);
 #define ANKI_INSTANSIATE_RESOURCE_DELIMITER()
@@ -67,7 +71,8 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	ANKI_CHECK(m_transferGpuAlloc->init(init.m_config->getNumberU32("rsrc_transferScratchMemorySize"), m_gr, m_alloc));
 
 	// Init the programs
-	m_shaderProgramSystem = m_alloc.newInstance<ShaderProgramResourceSystem>(m_cacheDir, m_gr, m_fs, m_alloc);
+	m_shaderProgramSystem = m_alloc.newInstance<ShaderProgramResourceSystem>(
+		m_cacheDir, m_gr, m_fs, m_alloc, init.m_config->getBool("rsrc_compileShadersOnDemand"));
 	ANKI_CHECK(m_shaderProgramSystem->init());
 
 	return Error::NONE;
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/resource/TransferGpuAllocator.h>
+#include <anki/resource/ImageLoader.h>
 #include <anki/util/List.h>
 #include <anki/util/Functions.h>
 #include <anki/util/String.h>
@@ -135,6 +136,11 @@ public:
 		return m_maxTextureSize;
 	}
 
+	ANKI_INTERNAL ImageLoaderDataCompression getPreferredTextureCompression() const
+	{
+		return m_preferredTextureCompression;
+	}
+
 	ANKI_INTERNAL Bool getDumpShaderSource() const
 	{
 		return m_dumpShaderSource;
@@ -216,6 +222,11 @@ public:
 		return *m_shaderProgramSystem;
 	}
 
+	ANKI_INTERNAL ShaderProgramResourceSystem& getShaderProgramResourceSystem()
+	{
+		return *m_shaderProgramSystem;
+	}
+
 private:
 	GrManager* m_gr = nullptr;
 	PhysicsWorld* m_physics = nullptr;
@@ -224,6 +235,7 @@ private:
 	TempResourceAllocator<U8> m_tmpAlloc;
 	String m_cacheDir;
 	U32 m_maxTextureSize;
+	ImageLoaderDataCompression m_preferredTextureCompression = ImageLoaderDataCompression::S3TC;
 	AsyncLoader* m_asyncLoader = nullptr; ///< Async loading thread
 	ShaderProgramResourceSystem* m_shaderProgramSystem = nullptr;
 	U64 m_uuid = 0;
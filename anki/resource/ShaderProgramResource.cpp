@@ -50,6 +50,7 @@ ShaderProgramResource::~ShaderProgramResource()
 Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
 {
 	// Load the binary from the cache. It should have been compiled there
+	ANKI_CHECK(getManager().getShaderProgramResourceSystem().compileOnDemand(filename));
 	StringAuto baseFilename(getTempAllocator());
 	getFilepathFilename(filename, baseFilename);
 	StringAuto binaryFilename(getTempAllocator());
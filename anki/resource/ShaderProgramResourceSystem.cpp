@@ -9,14 +9,328 @@
 #include <anki/gr/GrManager.h>
 #include <anki/shader_compiler/ShaderProgramCompiler.h>
 #include <anki/util/Filesystem.h>
-#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/List.h>
 #include <anki/util/System.h>
 
 namespace anki
 {
 
+/// A content-addressed SPIR-V cache that lives in the cache directory. Every SPIR-V blob is a file named after the hash
+/// of its preprocessed source. The files are written to a temp file that is renamed when complete so the readers never
+/// see a partially written file and the file IO happens without holding any lock.
+class ShaderProgramResourceSystem::SpirvDiskCache : public ShaderProgramSpirvCacheInterface
+{
+public:
+	SpirvDiskCache(CString cacheDir, U64 gpuHash, GenericMemoryPoolAllocator<U8> alloc)
+		: m_cacheDir(cacheDir)
+		, m_gpuHash(gpuHash)
+		, m_alloc(alloc)
+	{
+	}
+
+	~SpirvDiskCache()
+	{
+		m_storedHashes.destroy(m_alloc);
+	}
+
+	Bool find(U64 sourceHash, DynamicArrayAuto<U8>& spirv) final
+	{
+		const U64 hash = appendHash(&m_gpuHash, sizeof(m_gpuHash), sourceHash);
+		StringAuto fname(m_alloc);
+		getFilename(hash, fname, false);
+
+		if(!fileExists(fname))
+		{
+			return false;
+		}
+
+		// Validate the file. Don't trust a file that was partially written by an older version or a crashed process
+		File file;
+		FileHeader header;
+		if(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY) || file.getSize() <= sizeof(header)
+		   || file.read(&header, sizeof(header)) || header.m_hash != hash
+		   || file.getSize() != sizeof(header) + header.m_spirvSize)
+		{
+			ANKI_RESOURCE_LOGW("Ignoring corrupted SPIR-V cache file: %s", fname.cstr());
+			return false;
+		}
+
+		spirv.create(header.m_spirvSize);
+		if(file.read(&spirv[0], spirv.getSizeInBytes()))
+		{
+			spirv.destroy();
+			return false;
+		}
+
+		return true;
+	}
+
+	void store(U64 sourceHash, ConstWeakArray<U8> spirv) final
+	{
+		ANKI_ASSERT(spirv.getSize() > 0);
+		const U64 hash = appendHash(&m_gpuHash, sizeof(m_gpuHash), sourceHash);
+
+		// Only one thread writes a file. The others compiled the same source and have nothing new to store
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			if(m_storedHashes.find(hash) != m_storedHashes.getEnd())
+			{
+				return;
+			}
+
+			m_storedHashes.emplace(m_alloc, hash, true);
+		}
+
+		StringAuto tmpFname(m_alloc);
+		getFilename(hash, tmpFname, true);
+		StringAuto fname(m_alloc);
+		getFilename(hash, fname, false);
+
+		FileHeader header;
+		header.m_hash = hash;
+		header.m_spirvSize = spirv.getSize();
+
+		Error err = Error::NONE;
+		{
+			File file;
+			err = file.open(tmpFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY);
+			if(!err)
+			{
+				err = file.write(&header, sizeof(header));
+			}
+
+			if(!err)
+			{
+				err = file.write(&spirv[0], spirv.getSizeInBytes());
+			}
+		}
+
+		if(!err)
+		{
+			err = renameFile(tmpFname, fname);
+		}
+
+		if(err)
+		{
+			// Not fatal, the next compilation will just miss the cache
+			ANKI_RESOURCE_LOGW("Failed to write SPIR-V cache file: %s", fname.cstr());
+		}
+	}
+
+private:
+	class FileHeader
+	{
+	public:
+		U64 m_hash;
+		U32 m_spirvSize;
+		U32 m_padding = 0;
+	};
+
+	CString m_cacheDir;
+	U64 m_gpuHash;
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	HashMap<U64, Bool> m_storedHashes; ///< The files that this cache wrote or is writing.
+	Mutex m_mtx; ///< Protects m_storedHashes.
+
+	void getFilename(U64 hash, StringAuto& fname, Bool temp) const
+	{
+		fname.sprintf("%s/spirv/%016" PRIx64 ".spv%s", m_cacheDir.cstr(), hash, (temp) ? ".tmp" : "");
+	}
+};
+
+/// A pool of threads that compiles shader programs. The compilation of a program is a job and the compilation of its
+/// variants are jobs as well. While a program waits for its variants it executes variant jobs of any program so all
+/// threads stay busy even if the programs have a few variants.
+class ShaderProgramResourceSystem::CompilationJobPool
+{
+public:
+	using JobCallback = void (*)(void* userData);
+
+	/// A number of variant jobs that someone can wait on.
+	class JobGroup
+	{
+		friend class CompilationJobPool;
+
+	private:
+		U32 m_pendingJobCount = 0;
+	};
+
+	CompilationJobPool(U32 threadCount, GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+		m_threads.create(m_alloc, threadCount);
+		for(Thread*& thread : m_threads)
+		{
+			thread = m_alloc.newInstance<Thread>("anki_shcompile");
+			thread->start(this, threadCallback);
+		}
+	}
+
+	~CompilationJobPool()
+	{
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			ANKI_ASSERT(m_programJobs.isEmpty() && m_variantJobs.isEmpty());
+			m_quit = true;
+			m_condVar.notifyAll();
+		}
+
+		for(Thread* thread : m_threads)
+		{
+			const Error err = thread->join();
+			(void)err;
+			m_alloc.deleteInstance(thread);
+		}
+
+		m_threads.destroy(m_alloc);
+	}
+
+	U32 getThreadCount() const
+	{
+		return m_threads.getSize();
+	}
+
+	/// Submit the compilation of a program.
+	void submitProgramJob(JobCallback callback, void* userData)
+	{
+		Job* job = m_alloc.newInstance<Job>();
+		job->m_callback = callback;
+		job->m_userData = userData;
+
+		LockGuard<Mutex> lock(m_mtx);
+		m_programJobs.pushBack(job);
+		++m_pendingProgramJobCount;
+		m_condVar.notifyAll();
+	}
+
+	/// Submit the compilation of a variant.
+	void submitVariantJob(JobCallback callback, void* userData, JobGroup& group)
+	{
+		Job* job = m_alloc.newInstance<Job>();
+		job->m_callback = callback;
+		job->m_userData = userData;
+		job->m_group = &group;
+
+		LockGuard<Mutex> lock(m_mtx);
+		m_variantJobs.pushBack(job);
+		++group.m_pendingJobCount;
+		m_condVar.notifyAll();
+	}
+
+	/// Wait for the jobs of a group. The calling thread will execute variant jobs while waiting.
+	void waitGroup(JobGroup& group)
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		while(group.m_pendingJobCount > 0)
+		{
+			if(!m_variantJobs.isEmpty())
+			{
+				runJob(m_variantJobs.popFront());
+			}
+			else
+			{
+				m_condVar.wait(m_mtx);
+			}
+		}
+	}
+
+	/// Wait for all program jobs. The calling thread will execute jobs while waiting.
+	void waitAllPrograms()
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		while(m_pendingProgramJobCount > 0)
+		{
+			if(!runNextJob())
+			{
+				m_condVar.wait(m_mtx);
+			}
+		}
+	}
+
+private:
+	class Job : public IntrusiveListEnabled<Job>
+	{
+	public:
+		JobCallback m_callback = nullptr;
+		void* m_userData = nullptr;
+		JobGroup* m_group = nullptr; ///< If it's nullptr it's a program job.
+	};
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	DynamicArray<Thread*> m_threads;
+
+	IntrusiveList<Job> m_programJobs;
+	IntrusiveList<Job> m_variantJobs;
+	U32 m_pendingProgramJobCount = 0;
+	Bool m_quit = false;
+
+	Mutex m_mtx;
+	ConditionVariable m_condVar;
+
+	static Error threadCallback(ThreadCallbackInfo& info)
+	{
+		CompilationJobPool& self = *static_cast<CompilationJobPool*>(info.m_userData);
+
+		LockGuard<Mutex> lock(self.m_mtx);
+		while(!self.m_quit)
+		{
+			if(!self.runNextJob())
+			{
+				self.m_condVar.wait(self.m_mtx);
+			}
+		}
+
+		return Error::NONE;
+	}
+
+	/// Run a job if there is one. Prefer variants to finish the programs that are in flight. Needs m_mtx locked.
+	Bool runNextJob()
+	{
+		if(!m_variantJobs.isEmpty())
+		{
+			runJob(m_variantJobs.popFront());
+			return true;
+		}
+		else if(!m_programJobs.isEmpty())
+		{
+			runJob(m_programJobs.popFront());
+			return true;
+		}
+
+		return false;
+	}
+
+	/// Needs m_mtx locked. It unlocks it while the job is running.
+	void runJob(Job* job)
+	{
+		m_mtx.unlock();
+		job->m_callback(job->m_userData);
+		m_mtx.lock();
+
+		if(job->m_group)
+		{
+			ANKI_ASSERT(job->m_group->m_pendingJobCount > 0);
+			--job->m_group->m_pendingJobCount;
+		}
+		else
+		{
+			ANKI_ASSERT(m_pendingProgramJobCount > 0);
+			--m_pendingProgramJobCount;
+		}
+
+		m_alloc.deleteInstance(job);
+		m_condVar.notifyAll();
+	}
+};
+
 ShaderProgramResourceSystem::~ShaderProgramResourceSystem()
 {
+	if(m_compilationPool)
+	{
+		m_alloc.deleteInstance(m_compilationPool);
+	}
+
 	m_cacheDir.destroy(m_alloc);
 
 	for(ShaderProgramRaytracingLibrary& lib : m_rtLibraries)
@@ -32,8 +346,34 @@ Error ShaderProgramResourceSystem::init()
 {
 	ANKI_TRACE_SCOPED_EVENT(COMPILE_SHADERS);
 
+	// Compute hash for both
+	const GpuDeviceCapabilities caps = m_gr->getDeviceCapabilities();
+	const BindlessLimits limits = m_gr->getBindlessLimits();
+	m_gpuHash = computeHash(&caps, sizeof(caps));
+	m_gpuHash = appendHash(&limits, sizeof(limits), m_gpuHash);
+	m_gpuHash = appendHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), m_gpuHash);
+
+	// Create the dir of the SPIR-V cache
+	StringAuto spirvDir(m_alloc);
+	spirvDir.sprintf("%s/spirv", m_cacheDir.cstr());
+	if(!directoryExists(spirvDir))
+	{
+		ANKI_CHECK(createDirectory(spirvDir));
+	}
+
+	// The main thread works as well so create one thread less
+	m_compilationPool = m_alloc.newInstance<CompilationJobPool>(max(1u, getCpuCoresCount() - 1u), m_alloc);
+
 	StringListAuto rtProgramFilenames(m_alloc);
-	ANKI_CHECK(compileAllShaders(m_cacheDir, *m_gr, *m_fs, m_alloc, rtProgramFilenames));
+	ANKI_CHECK(compileAllShaders(m_cacheDir, m_gpuHash, m_compileOnDemand, *m_gr, *m_fs, *m_compilationPool, m_alloc,
+								 rtProgramFilenames));
+
+	// Keep the threads around only if they are needed later
+	if(!m_compileOnDemand)
+	{
+		m_alloc.deleteInstance(m_compilationPool);
+		m_compilationPool = nullptr;
+	}
 
 	if(m_gr->getDeviceCapabilities().m_rayTracingEnabled)
 	{
@@ -43,30 +383,35 @@ Error ShaderProgramResourceSystem::init()
 	return Error::NONE;
 }
 
-Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, GrManager& gr, ResourceFilesystem& fs,
-													 GenericMemoryPoolAllocator<U8>& alloc,
-													 StringListAuto& rtProgramFilenames)
+Error ShaderProgramResourceSystem::compileOnDemand(CString filename)
 {
-	class MetaFileData
+	if(!m_compileOnDemand)
 	{
-	public:
-		U64 m_hash;
-		ShaderTypeBit m_shaderTypes;
-		Array<U16, 3> m_padding = {};
-	};
+		return Error::NONE;
+	}
 
-	ANKI_RESOURCE_LOGI("Compiling shader programs");
-	U32 shadersCompileCount = 0;
+	ANKI_TRACE_SCOPED_EVENT(COMPILE_SHADERS);
 
-	ThreadHive threadHive(getCpuCoresCount(), alloc, false);
+	// Serialize the compilations. It's simpler and they use all the cores anyway
+	LockGuard<Mutex> lock(m_onDemandMtx);
 
-	// Compute hash for both
-	const GpuDeviceCapabilities caps = gr.getDeviceCapabilities();
-	const BindlessLimits limits = gr.getBindlessLimits();
-	U64 gpuHash = computeHash(&caps, sizeof(caps));
-	gpuHash = appendHash(&limits, sizeof(limits), gpuHash);
-	gpuHash = appendHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
+	Bool compiled;
+	ShaderTypeBit shaderTypes;
+	ANKI_CHECK(compileShaderProgramIfStale(filename, m_cacheDir, m_gpuHash, false, *m_gr, *m_fs, m_compilationPool,
+										   m_alloc, compiled, shaderTypes));
+	return Error::NONE;
+}
+
+Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, U64 gpuHash, Bool compileOnDemand,
+													 GrManager& gr, ResourceFilesystem& fs, CompilationJobPool& pool,
+													 GenericMemoryPoolAllocator<U8>& alloc,
+													 StringListAuto& rtProgramFilenames)
+{
+	ANKI_RESOURCE_LOGI("Compiling shader programs");
+	const Second startTime = HighRezTimer::getCurrentTime();
 
+	// Gather the programs
+	DynamicArrayAuto<CString> fnames(alloc);
 	ANKI_CHECK(fs.iterateAllFilenames([&](CString fname) -> Error {
 		// Check file extension
 		StringAuto extension(alloc);
@@ -82,160 +427,254 @@ Error ShaderProgramResourceSystem::compileAllShaders(CString cacheDir, GrManager
 			return Error::NONE;
 		}
 
-		// Get some filenames
-		StringAuto baseFname(alloc);
-		getFilepathFilename(fname, baseFname);
-		StringAuto metaFname(alloc);
-		metaFname.sprintf("%s/%smeta", cacheDir.cstr(), baseFname.cstr());
+		fnames.emplaceBack(fname);
+		return Error::NONE;
+	}));
 
-		// Get the hash from the meta file
-		U64 metafileHash = 0;
-		ShaderTypeBit metafileShaderTypes = ShaderTypeBit::NONE;
-		if(fileExists(metaFname))
-		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
-			MetaFileData data;
-			ANKI_CHECK(metaFile.read(&data, sizeof(data)));
+	// Compile all programs in parallel. The parsing and the meta file checks are done in parallel as well
+	class ProgramJob
+	{
+	public:
+		CString m_fname;
+		CString m_cacheDir;
+		U64 m_gpuHash;
+		Bool m_compileOnDemand;
+		GrManager* m_gr;
+		ResourceFilesystem* m_fs;
+		CompilationJobPool* m_pool;
+		GenericMemoryPoolAllocator<U8> m_alloc;
+		Atomic<I32>* m_err;
 
-			if(data.m_hash == 0 || data.m_shaderTypes == ShaderTypeBit::NONE)
-			{
-				ANKI_RESOURCE_LOGE("Wrong data found in the metafile: %s", metaFname.cstr());
-				return Error::USER_DATA;
-			}
+		Bool m_compiled = false;
+		ShaderTypeBit m_shaderTypes = ShaderTypeBit::NONE;
+		Second m_time = 0.0;
+	};
+
+	Atomic<I32> err = {0};
+	DynamicArrayAuto<ProgramJob> jobs(alloc, fnames.getSize());
+	for(U32 i = 0; i < fnames.getSize(); ++i)
+	{
+		ProgramJob& job = jobs[i];
+		job.m_fname = fnames[i];
+		job.m_cacheDir = cacheDir;
+		job.m_gpuHash = gpuHash;
+		job.m_compileOnDemand = compileOnDemand;
+		job.m_gr = &gr;
+		job.m_fs = &fs;
+		job.m_pool = &pool;
+		job.m_alloc = alloc;
+		job.m_err = &err;
+
+		pool.submitProgramJob(
+			[](void* userData) {
+				ProgramJob& job = *static_cast<ProgramJob*>(userData);
+				if(job.m_err->load() != 0)
+				{
+					return;
+				}
+
+				const Second startTime = HighRezTimer::getCurrentTime();
+
+				// Ray tracing programs can't be deferred, they are needed to build the libraries
+				const Error err = compileShaderProgramIfStale(job.m_fname, job.m_cacheDir, job.m_gpuHash,
+															  job.m_compileOnDemand, *job.m_gr, *job.m_fs, job.m_pool,
+															  job.m_alloc, job.m_compiled, job.m_shaderTypes);
+				if(err)
+				{
+					job.m_err->store(err._getCode());
+				}
+
+				job.m_time = HighRezTimer::getCurrentTime() - startTime;
+			},
+			&job);
+	}
 
-			metafileHash = data.m_hash;
-			metafileShaderTypes = data.m_shaderTypes;
+	pool.waitAllPrograms();
+	ANKI_CHECK(Error(err.getNonAtomically()));
+
+	// Gather the results
+	U32 shadersCompileCount = 0;
+	Second compileTime = 0.0;
+	for(const ProgramJob& job : jobs)
+	{
+		if(job.m_compiled)
+		{
+			++shadersCompileCount;
+			compileTime += job.m_time;
 		}
 
-		// Load interface
-		class FSystem : public ShaderProgramFilesystemInterface
+		// Gather RT programs
+		if(!!(job.m_shaderTypes & ShaderTypeBit::ALL_RAY_TRACING))
 		{
-		public:
-			ResourceFilesystem* m_fsystem = nullptr;
+			rtProgramFilenames.pushBack(job.m_fname);
+		}
+	}
 
-			Error readAllText(CString filename, StringAuto& txt) final
-			{
-				ResourceFilePtr file;
-				ANKI_CHECK(m_fsystem->openFile(filename, file));
-				ANKI_CHECK(file->readAllText(txt));
-				return Error::NONE;
-			}
-		} fsystem;
-		fsystem.m_fsystem = &fs;
+	ANKI_RESOURCE_LOGI("Compiled %u shader programs out of %u in %fs using %u threads. Sum of compilation times %fs",
+					   shadersCompileCount, jobs.getSize(), HighRezTimer::getCurrentTime() - startTime,
+					   pool.getThreadCount() + 1, compileTime);
+	return Error::NONE;
+}
 
-		// Skip interface
-		class Skip : public ShaderProgramPostParseInterface
-		{
-		public:
-			U64 m_metafileHash;
-			U64 m_newHash;
-			U64 m_gpuHash;
-			CString m_fname;
+Error ShaderProgramResourceSystem::compileShaderProgramIfStale(CString fname, CString cacheDir, U64 gpuHash,
+															   Bool deferNonRayTracing, GrManager& gr,
+															   ResourceFilesystem& fs, CompilationJobPool* pool,
+															   GenericMemoryPoolAllocator<U8>& alloc, Bool& compiled,
+															   ShaderTypeBit& shaderTypes)
+{
+	class MetaFileData
+	{
+	public:
+		U64 m_hash;
+		ShaderTypeBit m_shaderTypes;
+		Array<U16, 3> m_padding = {};
+	};
 
-			Bool skipCompilation(U64 hash)
-			{
-				ANKI_ASSERT(hash != 0);
-				const Array<U64, 2> hashes = {hash, m_gpuHash};
-				const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
+	compiled = false;
+	shaderTypes = ShaderTypeBit::NONE;
 
-				m_newHash = finalHash;
-				const Bool skip = finalHash == m_metafileHash;
+	// Get some filenames
+	StringAuto baseFname(alloc);
+	getFilepathFilename(fname, baseFname);
+	StringAuto metaFname(alloc);
+	metaFname.sprintf("%s/%smeta", cacheDir.cstr(), baseFname.cstr());
 
-				if(!skip)
-				{
-					ANKI_RESOURCE_LOGI("\t%s", m_fname.cstr());
-				}
+	// Get the hash from the meta file
+	U64 metafileHash = 0;
+	ShaderTypeBit metafileShaderTypes = ShaderTypeBit::NONE;
+	if(fileExists(metaFname))
+	{
+		File metaFile;
+		ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+		MetaFileData data;
+		ANKI_CHECK(metaFile.read(&data, sizeof(data)));
 
-				return skip;
-			};
-		} skip;
-		skip.m_metafileHash = metafileHash;
-		skip.m_newHash = 0;
-		skip.m_gpuHash = gpuHash;
-		skip.m_fname = fname;
+		if(data.m_hash == 0 || data.m_shaderTypes == ShaderTypeBit::NONE)
+		{
+			ANKI_RESOURCE_LOGE("Wrong data found in the metafile: %s", metaFname.cstr());
+			return Error::USER_DATA;
+		}
 
-		// Threading interface
-		class TaskManager : public ShaderProgramAsyncTaskInterface
+		metafileHash = data.m_hash;
+		metafileShaderTypes = data.m_shaderTypes;
+	}
+
+	// Load interface
+	class FSystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		ResourceFilesystem* m_fsystem = nullptr;
+
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			ResourceFilePtr file;
+			ANKI_CHECK(m_fsystem->openFile(filename, file));
+			ANKI_CHECK(file->readAllText(txt));
+			return Error::NONE;
+		}
+	} fsystem;
+	fsystem.m_fsystem = &fs;
+
+	// Skip interface
+	class Skip : public ShaderProgramPostParseInterface
+	{
+	public:
+		U64 m_metafileHash;
+		U64 m_newHash;
+		U64 m_gpuHash;
+		CString m_fname;
+		Bool m_deferNonRayTracing;
+		Bool m_deferred = false;
+		ShaderTypeBit m_shaderTypes = ShaderTypeBit::NONE;
+
+		Bool skipCompilation(U64 hash, ShaderTypeBit shaderTypes)
 		{
-		public:
-			ThreadHive* m_hive = nullptr;
-			GenericMemoryPoolAllocator<U8> m_alloc;
+			ANKI_ASSERT(hash != 0);
+			const Array<U64, 2> hashes = {hash, m_gpuHash};
+			const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
 
-			void enqueueTask(void (*callback)(void* userData), void* userData)
+			m_newHash = finalHash;
+			m_shaderTypes = shaderTypes;
+			const Bool skip = finalHash == m_metafileHash;
+
+			if(!skip && m_deferNonRayTracing && !(shaderTypes & ShaderTypeBit::ALL_RAY_TRACING))
 			{
-				class Ctx
-				{
-				public:
-					void (*m_callback)(void* userData);
-					void* m_userData;
-					GenericMemoryPoolAllocator<U8> m_alloc;
-				};
-				Ctx* ctx = m_alloc.newInstance<Ctx>();
-				ctx->m_callback = callback;
-				ctx->m_userData = userData;
-				ctx->m_alloc = m_alloc;
-
-				m_hive->submitTask(
-					[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
-						Ctx* ctx = static_cast<Ctx*>(userData);
-						ctx->m_callback(ctx->m_userData);
-						auto alloc = ctx->m_alloc;
-						alloc.deleteInstance(ctx);
-					},
-					ctx);
+				// Will be compiled when it's loaded
+				m_deferred = true;
+				return true;
 			}
 
-			Error joinTasks()
+			if(!skip)
 			{
-				m_hive->waitAllTasks();
-				return Error::NONE;
+				ANKI_RESOURCE_LOGI("\t%s", m_fname.cstr());
 			}
-		} taskManager;
-		taskManager.m_hive = &threadHive;
-		taskManager.m_alloc = alloc;
 
-		// Compile
-		ShaderProgramBinaryWrapper binary(alloc);
-		ANKI_CHECK(compileShaderProgram(fname, fsystem, &skip, &taskManager, alloc, caps, limits, binary));
+			return skip;
+		};
+	} skip;
+	skip.m_metafileHash = metafileHash;
+	skip.m_newHash = 0;
+	skip.m_gpuHash = gpuHash;
+	skip.m_fname = fname;
+	skip.m_deferNonRayTracing = deferNonRayTracing;
+
+	// Threading interface
+	class TaskManager : public ShaderProgramAsyncTaskInterface
+	{
+	public:
+		CompilationJobPool* m_pool = nullptr;
+		CompilationJobPool::JobGroup m_group;
 
-		const Bool cachedBinIsUpToDate = metafileHash == skip.m_newHash;
-		if(!cachedBinIsUpToDate)
+		void enqueueTask(void (*callback)(void* userData), void* userData)
 		{
-			++shadersCompileCount;
+			m_pool->submitVariantJob(callback, userData, m_group);
 		}
 
-		// Update the meta file
-		if(!cachedBinIsUpToDate)
+		Error joinTasks()
 		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
-
-			MetaFileData data;
-			data.m_hash = skip.m_newHash;
-			data.m_shaderTypes = binary.getBinary().m_presentShaderTypes;
-			metafileShaderTypes = data.m_shaderTypes;
-			ANKI_CHECK(metaFile.write(&data, sizeof(data)));
+			m_pool->waitGroup(m_group);
+			return Error::NONE;
 		}
+	} taskManager;
+	taskManager.m_pool = pool;
 
-		// Save the binary to the cache
-		if(!cachedBinIsUpToDate)
-		{
-			StringAuto storeFname(alloc);
-			storeFname.sprintf("%s/%sbin", cacheDir.cstr(), baseFname.cstr());
-			ANKI_CHECK(binary.serializeToFile(storeFname));
-		}
+	// Compile
+	SpirvDiskCache spirvCache(cacheDir, gpuHash, alloc);
+	ShaderProgramBinaryWrapper binary(alloc);
+	ANKI_CHECK(compileShaderProgram(fname, fsystem, &skip, (pool) ? &taskManager : nullptr, &spirvCache, alloc,
+									gr.getDeviceCapabilities(), gr.getBindlessLimits(), binary));
 
-		// Gather RT programs
-		if(!!(metafileShaderTypes & ShaderTypeBit::ALL_RAY_TRACING))
-		{
-			rtProgramFilenames.pushBack(fname);
-		}
+	if(skip.m_deferred)
+	{
+		shaderTypes = skip.m_shaderTypes;
+		return Error::NONE;
+	}
 
+	const Bool cachedBinIsUpToDate = metafileHash == skip.m_newHash;
+	if(cachedBinIsUpToDate)
+	{
+		shaderTypes = metafileShaderTypes;
 		return Error::NONE;
-	}));
+	}
+
+	compiled = true;
+	shaderTypes = binary.getBinary().m_presentShaderTypes;
+
+	// Save the binary to the cache. Do that before the meta file so that an interruption won't leave a stale binary
+	// with an up to date meta file
+	StringAuto storeFname(alloc);
+	storeFname.sprintf("%s/%sbin", cacheDir.cstr(), baseFname.cstr());
+	ANKI_CHECK(binary.serializeToFile(storeFname));
+
+	// Update the meta file
+	File metaFile;
+	ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	MetaFileData data;
+	data.m_hash = skip.m_newHash;
+	data.m_shaderTypes = shaderTypes;
+	ANKI_CHECK(metaFile.write(&data, sizeof(data)));
 
-	ANKI_RESOURCE_LOGI("Compiled %u shader programs", shadersCompileCount);
 	return Error::NONE;
 }
 
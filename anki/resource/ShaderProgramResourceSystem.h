@@ -9,6 +9,7 @@
 #include <anki/gr/ShaderProgram.h>
 #include <anki/util/HashMap.h>
 #include <anki/util/StringList.h>
+#include <anki/util/Thread.h>
 #include <anki/shader_compiler/ShaderProgramBinary.h>
 
 namespace anki
@@ -86,10 +87,11 @@ class ShaderProgramResourceSystem
 {
 public:
 	ShaderProgramResourceSystem(CString cacheDir, GrManager* gr, ResourceFilesystem* fs,
-								const GenericMemoryPoolAllocator<U8>& alloc)
+								const GenericMemoryPoolAllocator<U8>& alloc, Bool compileOnDemand)
 		: m_alloc(alloc)
 		, m_gr(gr)
 		, m_fs(fs)
+		, m_compileOnDemand(compileOnDemand)
 	{
 		m_cacheDir.create(alloc, cacheDir);
 	}
@@ -103,17 +105,43 @@ public:
 		return m_rtLibraries;
 	}
 
+	/// If the programs are compiled on demand compile a program if its binary in the cache is stale. If not it does
+	/// nothing since all programs were compiled at init().
+	/// @note Thread-safe.
+	ANKI_USE_RESULT Error compileOnDemand(CString filename);
+
 private:
+	class SpirvDiskCache;
+	class CompilationJobPool;
+
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	String m_cacheDir;
 	GrManager* m_gr;
 	ResourceFilesystem* m_fs;
 	DynamicArray<ShaderProgramRaytracingLibrary> m_rtLibraries;
+	U64 m_gpuHash = 0;
 
-	/// Iterate all programs in the filesystem and compile them to AnKi's binary format.
-	static Error compileAllShaders(CString cacheDir, GrManager& gr, ResourceFilesystem& fs,
+	Bool m_compileOnDemand;
+	CompilationJobPool* m_compilationPool = nullptr; ///< It stays alive after init() if compiling on demand.
+	Mutex m_onDemandMtx;
+
+	/// Iterate all programs in the filesystem and compile them to AnKi's binary format. All programs and their variants
+	/// are compiled in parallel.
+	/// @param compileOnDemand If true compile only the ray tracing programs. The rest will be compiled when loaded.
+	static Error compileAllShaders(CString cacheDir, U64 gpuHash, Bool compileOnDemand, GrManager& gr,
+								   ResourceFilesystem& fs, CompilationJobPool& pool,
 								   GenericMemoryPoolAllocator<U8>& alloc, StringListAuto& rtProgramFilenames);
 
+	/// Compile a single program if the binary in the cache doesn't match the source.
+	/// @param deferNonRayTracing If true don't compile non ray tracing programs.
+	/// @param pool If it's nullptr the compilation will happen in the current thread.
+	/// @param[out] compiled True if the program was compiled.
+	/// @param[out] shaderTypes The stages of the program.
+	static Error compileShaderProgramIfStale(CString fname, CString cacheDir, U64 gpuHash, Bool deferNonRayTracing,
+											 GrManager& gr, ResourceFilesystem& fs, CompilationJobPool* pool,
+											 GenericMemoryPoolAllocator<U8>& alloc, Bool& compiled,
+											 ShaderTypeBit& shaderTypes);
+
 	static Error createRayTracingPrograms(CString cacheDir, const StringListAuto& rtProgramFilenames, GrManager& gr,
 										  GenericMemoryPoolAllocator<U8>& alloc,
 										  DynamicArray<ShaderProgramRaytracingLibrary>& libs);
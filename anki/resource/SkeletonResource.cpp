@@ -18,6 +18,7 @@ SkeletonResource::~SkeletonResource()
 	}
 
 	m_bones.destroy(getAllocator());
+	m_hierarchyOrder.destroy(getAllocator());
 }
 
 Error SkeletonResource::load(const ResourceFilename& filename, Bool async)
@@ -123,6 +124,25 @@ Error SkeletonResource::load(const ResourceFilename& filename, Bool async)
 		++it;
 	}
 
+	if(m_rootBoneIdx == MAX_U32)
+	{
+		ANKI_RESOURCE_LOGE("Skeleton doesn't have a root bone");
+		return Error::USER_DATA;
+	}
+
+	// Flatten the hierarchy breadth first
+	m_hierarchyOrder.create(getAllocator(), m_bones.getSize());
+	U32 orderCount = 0;
+	m_hierarchyOrder[orderCount++] = m_rootBoneIdx;
+	for(U32 i = 0; i < orderCount; ++i)
+	{
+		for(const Bone* child : m_bones[m_hierarchyOrder[i]].getChildren())
+		{
+			m_hierarchyOrder[orderCount++] = child->getIndex();
+		}
+	}
+	m_hierarchyOrder.resize(getAllocator(), orderCount);
+
 	return Error::NONE;
 }
 
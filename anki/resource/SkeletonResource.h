@@ -129,8 +129,16 @@ public:
 		return m_bones[m_rootBoneIdx];
 	}
 
+	/// The indices of the bones of the root's hierarchy where parents always come before their children. Iterate it to
+	/// compute the bone transforms without recursion.
+	ConstWeakArray<U32> getBoneIndicesInHierarchyOrder() const
+	{
+		return ConstWeakArray<U32>(m_hierarchyOrder);
+	}
+
 private:
 	DynamicArray<Bone> m_bones;
+	DynamicArray<U32> m_hierarchyOrder;
 	U32 m_rootBoneIdx = MAX_U32;
 };
 /// @}
@@ -75,7 +75,8 @@ Error TextureResource::load(const ResourceFilename& filename, Bool async)
 	ResourceFilePtr file;
 	ANKI_CHECK(openFile(filename, file));
 
-	ANKI_CHECK(loader.load(file, filename, getManager().getMaxTextureSize()));
+	ANKI_CHECK(
+		loader.load(file, filename, getManager().getMaxTextureSize(), getManager().getPreferredTextureCompression()));
 
 	// Various sizes
 	init.m_width = loader.getWidth();
@@ -122,6 +123,12 @@ Error TextureResource::load(const ResourceFilename& filename, Bool async)
 		case ImageLoaderDataCompression::S3TC:
 			init.m_format = Format::BC1_RGB_UNORM_BLOCK;
 			break;
+		case ImageLoaderDataCompression::BC7:
+			init.m_format = Format::BC7_UNORM_BLOCK;
+			break;
+		case ImageLoaderDataCompression::ASTC:
+			init.m_format = Format::ASTC_4x4_UNORM_BLOCK;
+			break;
 		default:
 			ANKI_ASSERT(0);
 		}
@@ -136,6 +143,40 @@ Error TextureResource::load(const ResourceFilename& filename, Bool async)
 		case ImageLoaderDataCompression::S3TC:
 			init.m_format = Format::BC3_UNORM_BLOCK;
 			break;
+		case ImageLoaderDataCompression::BC7:
+			init.m_format = Format::BC7_UNORM_BLOCK;
+			break;
+		case ImageLoaderDataCompression::ASTC:
+			init.m_format = Format::ASTC_4x4_UNORM_BLOCK;
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+	}
+	else if(loader.getColorFormat() == ImageLoaderColorFormat::R8)
+	{
+		switch(loader.getCompression())
+		{
+		case ImageLoaderDataCompression::RAW:
+			init.m_format = Format::R8_UNORM;
+			break;
+		case ImageLoaderDataCompression::S3TC:
+			init.m_format = Format::BC4_UNORM_BLOCK;
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+	}
+	else if(loader.getColorFormat() == ImageLoaderColorFormat::RG8)
+	{
+		switch(loader.getCompression())
+		{
+		case ImageLoaderDataCompression::RAW:
+			init.m_format = Format::R8G8_UNORM;
+			break;
+		case ImageLoaderDataCompression::S3TC:
+			init.m_format = Format::BC5_UNORM_BLOCK;
+			break;
 		default:
 			ANKI_ASSERT(0);
 		}
@@ -4,6 +4,8 @@
 // http://www.anki3d.org/LICENSE
 
 ANKI_CONFIG_OPTION(scene_octreeMaxDepth, 5, 2, 10, "The max depth of the octree")
+ANKI_CONFIG_OPTION(scene_gpuSceneInitialSlotCount, 4096, 1, 1024 * 1024,
+				   "The initial number of renderables that the GPU scene can hold. It grows if needed")
 ANKI_CONFIG_OPTION(scene_earlyZDistance, 10.0, 0.0, MAX_F64,
 				   "Objects with distance lower than that will be used in early Z")
 ANKI_CONFIG_OPTION(scene_lod0MaxDistance, 20.0, 1.0, MAX_F64, "Distance that will be used to calculate the LOD 0")
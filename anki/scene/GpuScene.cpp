@@ -0,0 +1,155 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/GpuScene.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/gr/GrManager.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+GpuScene::~GpuScene()
+{
+	ANKI_ASSERT(getAllocatedSlotCount() == 0 && "Forgot to free some slots");
+
+	m_slots.destroy(m_alloc);
+	m_slotFlags.destroy(m_alloc);
+	m_freeSlots.destroy(m_alloc);
+	m_dirtySlots.destroy(m_alloc);
+}
+
+void GpuScene::init(SceneAllocator<U8> alloc, GrManager* gr, U32 initialSlotCount)
+{
+	ANKI_ASSERT(gr && initialSlotCount > 0);
+	m_alloc = alloc;
+	m_gr = gr;
+	createBuffer(nextPowerOfTwo(initialSlotCount));
+}
+
+void GpuScene::createBuffer(U32 capacity)
+{
+	ANKI_ASSERT(capacity > 0);
+	m_capacity = capacity;
+
+	// Only the GPU writes to it. The old buffer is kept alive by the command buffers that still use it
+	BufferInitInfo buffInit("GpuScene");
+	buffInit.m_size = PtrSize(m_capacity) * sizeof(GpuSceneInstance);
+	buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_WRITE | BufferUsageBit::STORAGE_GEOMETRY_READ;
+	m_buffer = m_gr->newBuffer(buffInit);
+}
+
+U32 GpuScene::allocateSlot()
+{
+	LockGuard<SpinLock> lock(m_mtx);
+
+	U32 slot;
+	if(m_freeSlots.getSize() > 0)
+	{
+		slot = m_freeSlots.getBack();
+		m_freeSlots.popBack(m_alloc);
+	}
+	else
+	{
+		slot = m_slots.getSize();
+		m_slots.emplaceBack(m_alloc);
+		m_slotFlags.emplaceBack(m_alloc, SlotFlag::NONE);
+	}
+
+	ANKI_ASSERT(m_slotFlags[slot] == SlotFlag::NONE);
+	m_slotFlags[slot] = SlotFlag::ALLOCATED;
+	return slot;
+}
+
+void GpuScene::freeSlot(U32 slot)
+{
+	LockGuard<SpinLock> lock(m_mtx);
+
+	ANKI_ASSERT(!!(m_slotFlags[slot] & SlotFlag::ALLOCATED));
+
+	// A dirty slot stays in m_dirtySlots. fillRenderQueue() will skip it
+	m_slotFlags[slot] = SlotFlag::NONE;
+	m_freeSlots.emplaceBack(m_alloc, slot);
+}
+
+void GpuScene::setSlot(U32 slot, const Mat4& worldTransform, const Mat4& previousWorldTransform)
+{
+	LockGuard<SpinLock> lock(m_mtx);
+
+	ANKI_ASSERT(!!(m_slotFlags[slot] & SlotFlag::ALLOCATED));
+	m_slots[slot].m_worldTransform = worldTransform;
+	m_slots[slot].m_previousWorldTransform = previousWorldTransform;
+
+	markDirty(slot);
+}
+
+void GpuScene::markDirty(U32 slot)
+{
+	if(!!(m_slotFlags[slot] & SlotFlag::DIRTY))
+	{
+		return;
+	}
+
+	m_slotFlags[slot] |= SlotFlag::DIRTY;
+
+	// Don't shrink the array every frame, re-use its storage
+	if(m_dirtySlotCount == m_dirtySlots.getSize())
+	{
+		m_dirtySlots.emplaceBack(m_alloc, slot);
+	}
+	else
+	{
+		m_dirtySlots[m_dirtySlotCount] = slot;
+	}
+	++m_dirtySlotCount;
+}
+
+void GpuScene::fillRenderQueue(SceneFrameAllocator<U8>& frameAlloc, GpuSceneQueueElement& el)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_GPU_SCENE);
+	LockGuard<SpinLock> lock(m_mtx);
+
+	// Grow the buffer. The new buffer has no valid data so upload all the slots
+	if(m_slots.getSize() > m_capacity)
+	{
+		createBuffer(nextPowerOfTwo(m_slots.getSize()));
+
+		for(U32 slot = 0; slot < m_slots.getSize(); ++slot)
+		{
+			if(!!(m_slotFlags[slot] & SlotFlag::ALLOCATED))
+			{
+				markDirty(slot);
+			}
+		}
+	}
+
+	GpuSceneUpdate* updates = (m_dirtySlotCount) ? frameAlloc.newArray<GpuSceneUpdate>(m_dirtySlotCount) : nullptr;
+	U32 updateCount = 0;
+	for(U32 i = 0; i < m_dirtySlotCount; ++i)
+	{
+		const U32 slot = m_dirtySlots[i];
+		if(!(m_slotFlags[slot] & SlotFlag::DIRTY))
+		{
+			// Freed after it was set
+			continue;
+		}
+
+		m_slotFlags[slot] &= ~SlotFlag::DIRTY;
+
+		GpuSceneUpdate& update = updates[updateCount++];
+		update.m_instance = m_slots[slot];
+		update.m_slot = slot;
+	}
+
+	m_dirtySlotCount = 0;
+
+	ANKI_TRACE_INC_COUNTER(SCENE_GPU_SCENE_UPDATES, updateCount);
+
+	el.m_buffer = m_buffer.get();
+	el.m_updates = updates;
+	el.m_updateCount = updateCount;
+}
+
+} // end namespace anki
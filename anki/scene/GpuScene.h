@@ -0,0 +1,96 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/scene/Common.h>
+#include <anki/Math.h>
+#include <anki/gr/Buffer.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+#include <anki/util/Enum.h>
+#include <anki/shaders/include/GpuSceneTypes.h>
+
+namespace anki
+{
+
+// Forward
+class GpuSceneQueueElement;
+
+/// @addtogroup scene
+/// @{
+
+/// A persistent GPU buffer that holds a GpuSceneInstance per renderable. Renderables allocate a slot once and write it
+/// only when their data change. The changes are gathered once per frame and the renderer scatters them to the buffer.
+class GpuScene : public NonCopyable
+{
+public:
+	GpuScene() = default;
+
+	~GpuScene();
+
+	void init(SceneAllocator<U8> alloc, GrManager* gr, U32 initialSlotCount);
+
+	/// Allocate a slot. Its data are undefined until the first setSlot().
+	/// @note It's thread-safe.
+	U32 allocateSlot();
+
+	/// Free a slot allocated with allocateSlot().
+	/// @note It's thread-safe.
+	void freeSlot(U32 slot);
+
+	/// Change the data of a slot. The GPU will see them the next frame that the scene is rendered.
+	/// @note It's thread-safe.
+	void setSlot(U32 slot, const Mat4& worldTransform, const Mat4& previousWorldTransform);
+
+	/// Gather the changes since the last call and give them to the renderer. Grows the buffer if needed.
+	void fillRenderQueue(SceneFrameAllocator<U8>& frameAlloc, GpuSceneQueueElement& el);
+
+	const BufferPtr& getBuffer() const
+	{
+		return m_buffer;
+	}
+
+	/// The number of slots the buffer can hold.
+	U32 getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	/// The number of slots that have been allocated and not freed.
+	U32 getAllocatedSlotCount() const
+	{
+		return m_slots.getSize() - m_freeSlots.getSize();
+	}
+
+private:
+	enum class SlotFlag : U8
+	{
+		NONE = 0,
+		ALLOCATED = 1 << 0,
+		DIRTY = 1 << 1
+	};
+	ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS_FRIEND(SlotFlag)
+
+	SceneAllocator<U8> m_alloc;
+	GrManager* m_gr = nullptr;
+
+	BufferPtr m_buffer;
+	U32 m_capacity = 0;
+
+	DynamicArray<GpuSceneInstance> m_slots; ///< A CPU copy of the buffer's content.
+	DynamicArray<SlotFlag> m_slotFlags;
+	DynamicArray<U32> m_freeSlots;
+	DynamicArray<U32> m_dirtySlots;
+	U32 m_dirtySlotCount = 0;
+	SpinLock m_mtx;
+
+	void createBuffer(U32 capacity);
+
+	void markDirty(U32 slot);
+};
+/// @}
+
+} // end namespace anki
@@ -6,6 +6,7 @@
 #include <anki/scene/ModelNode.h>
 #include <anki/scene/SceneGraph.h>
 #include <anki/scene/DebugDrawer.h>
+#include <anki/scene/GpuScene.h>
 #include <anki/scene/components/BodyComponent.h>
 #include <anki/scene/components/SkinComponent.h>
 #include <anki/scene/components/RenderComponent.h>
@@ -32,13 +33,19 @@ public:
 
 		const MoveComponent& move = node.getFirstComponentOfType<MoveComponent>();
 		const SkinComponent* skin = node.tryGetFirstComponentOfType<SkinComponent>();
-		if(move.getTimestamp() == node.getGlobalTimestamp()
-		   || (skin && skin->getTimestamp() == node.getGlobalTimestamp()))
+		ModelNode& mnode = static_cast<ModelNode&>(node);
+		const Bool moved = move.getTimestamp() == node.getGlobalTimestamp();
+		if(moved || (skin && skin->getTimestamp() == node.getGlobalTimestamp()))
 		{
-			ModelNode& mnode = static_cast<ModelNode&>(node);
 			mnode.updateSpatialComponent(move);
 		}
 
+		// The frame after a move the previous transform changes as well
+		if(moved || mnode.m_gpuSceneNeedsPrevTransformUpdate)
+		{
+			mnode.updateGpuScene(move);
+		}
+
 		return Error::NONE;
 	}
 };
@@ -78,6 +85,10 @@ ModelNode::ModelNode(SceneGraph* scene, CString name)
 
 ModelNode::~ModelNode()
 {
+	if(m_gpuSceneSlot != MAX_U32)
+	{
+		getSceneGraph().getGpuScene().freeSlot(m_gpuSceneSlot);
+	}
 }
 
 Error ModelNode::init(ModelResourcePtr resource, U32 modelPatchIdx)
@@ -119,6 +130,15 @@ Error ModelNode::init(ModelResourcePtr resource, U32 modelPatchIdx)
 
 	m_obbLocal = m_model->getModelPatches()[m_modelPatchIdx].getBoundingShape();
 
+	m_gpuSceneSlot = getSceneGraph().getGpuScene().allocateSlot();
+
+	// The GPU instance culling draws whole buckets with one draw. That doesn't work with the per node bones
+	if(!m_model->getSkeleton().isCreated()
+	   && m_model->getModelPatches()[m_modelPatchIdx].getMaterial()->getInstanceRemapBinding() != MAX_U32)
+	{
+		rcomp->setGpuSceneSlot(m_gpuSceneSlot);
+	}
+
 	return Error::NONE;
 }
 
@@ -151,6 +171,72 @@ void ModelNode::updateSpatialComponent(const MoveComponent& move)
 	sp.setSpatialOrigin(move.getWorldTransform().getOrigin());
 }
 
+void ModelNode::updateGpuScene(const MoveComponent& move)
+{
+	const Mat4 trf(move.getWorldTransform());
+	const Mat4 prevTrf(move.getPreviousWorldTransform());
+	getSceneGraph().getGpuScene().setSlot(m_gpuSceneSlot, trf, prevTrf);
+	m_gpuSceneNeedsPrevTransformUpdate = trf != prevTrf;
+}
+
+void ModelNode::setVertexState(const ModelRenderingInfo& modelInf, CommandBufferPtr& cmdb)
+{
+	// Set attributes
+	for(U i = 0; i < modelInf.m_vertexAttributeCount; ++i)
+	{
+		const VertexAttributeInfo& attrib = modelInf.m_vertexAttributes[i];
+		ANKI_ASSERT(attrib.m_format != Format::NONE);
+		cmdb->setVertexAttribute(U32(attrib.m_location), attrib.m_bufferBinding, attrib.m_format,
+								 attrib.m_relativeOffset);
+	}
+
+	// Set vertex buffers
+	for(U32 i = 0; i < modelInf.m_vertexBufferBindingCount; ++i)
+	{
+		const VertexBufferBinding& binding = modelInf.m_vertexBufferBindings[i];
+		cmdb->bindVertexBuffer(i, binding.m_buffer, binding.m_offset, binding.m_stride, VertexStepRate::VERTEX);
+	}
+
+	// Index buffer
+	cmdb->bindIndexBuffer(modelInf.m_indexBuffer, 0, IndexType::U16);
+}
+
+void ModelNode::drawGpuCulled(RenderQueueDrawContext& ctx, const ModelPatch& patch) const
+{
+	const MaterialResourcePtr& mtl = patch.getMaterial();
+	ANKI_ASSERT(ctx.m_key.getInstanceCount() == 1 && mtl->getInstanceRemapBinding() != MAX_U32);
+	ANKI_ASSERT(!m_model->getSkeleton());
+	CommandBufferPtr& cmdb = ctx.m_commandBuffer;
+
+	// Some instances of the bucket may have moved. The GPU scene has the previous transforms of all of them
+	ctx.m_key.setVelocity(ctx.m_key.getPass() == Pass::GB);
+	ModelRenderingInfo modelInf;
+	patch.getRenderingInfo(ctx.m_key, WeakArray<U8>(), modelInf);
+
+	ANKI_ASSERT(ctx.m_gpuSceneBuffer.isCreated() && ctx.m_instanceRemapBuffer.isCreated());
+	cmdb->bindStorageBuffer(mtl->getDescriptorSetIndex(), mtl->getGpuSceneBinding(), ctx.m_gpuSceneBuffer, 0,
+							MAX_PTR_SIZE);
+	cmdb->bindStorageBuffer(mtl->getDescriptorSetIndex(), mtl->getInstanceRemapBinding(), ctx.m_instanceRemapBuffer,
+							ctx.m_instanceRemapBufferOffset, ctx.m_instanceRemapBufferRange);
+
+	cmdb->bindShaderProgram(modelInf.m_program);
+
+	// Only the per draw uniforms. That slot makes the shader read the remap buffer
+	const U32 remappedSlot = MAX_U32;
+	RenderComponent::allocateAndSetupUniforms(mtl, ctx, ConstWeakArray<Mat4>(), ConstWeakArray<Mat4>(),
+											  *ctx.m_stagingGpuAllocator, ConstWeakArray<U32>(&remappedSlot, 1),
+											  Mat4(modelInf.m_positionDequantization));
+
+	setVertexState(modelInf, cmdb);
+
+	// The GPU culling sets the instance count
+	ctx.m_indirectArgs->m_count = modelInf.m_indicesCountArray[0];
+	ctx.m_indirectArgs->m_firstIndex = U32(modelInf.m_indicesOffsetArray[0] / sizeof(U16));
+	ctx.m_indirectArgs->m_baseVertex = 0;
+	cmdb->drawElementsIndirect(PrimitiveTopology::TRIANGLES, 1, ctx.m_indirectArgsBufferOffset,
+							   ctx.m_indirectArgsBuffer);
+}
+
 void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData) const
 {
 	ANKI_ASSERT(userData.getSize() > 0 && userData.getSize() <= MAX_INSTANCES);
@@ -166,6 +252,13 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		// anywhere
 		ANKI_ASSERT(patch.getSubMeshCount() == 1);
 
+		if(ctx.m_indirectArgs)
+		{
+			ANKI_ASSERT(userData.getSize() == 1 && "The GPU culling only passes the 1st instance of the bucket");
+			drawGpuCulled(ctx, patch);
+			return;
+		}
+
 		// Transforms
 		Array<Mat4, MAX_INSTANCES> trfs;
 		Array<Mat4, MAX_INSTANCES> prevTrfs;
@@ -187,6 +280,17 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		ModelRenderingInfo modelInf;
 		patch.getRenderingInfo(ctx.m_key, WeakArray<U8>(), modelInf);
 
+		// Fold the dequantization of the positions into the transforms
+		if(modelInf.m_positionDequantization != Transform::getIdentity())
+		{
+			const Mat4 dequantization(modelInf.m_positionDequantization);
+			for(U32 i = 0; i < userData.getSize(); ++i)
+			{
+				trfs[i] = trfs[i] * dequantization;
+				prevTrfs[i] = prevTrfs[i] * dequantization;
+			}
+		}
+
 		// Bones storage
 		if(m_model->getSkeleton())
 		{
@@ -211,33 +315,44 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 									tokenPrev.m_range);
 		}
 
-		// Program
-		cmdb->bindShaderProgram(modelInf.m_program);
+		// GPU scene. The shader reads the transforms from there and the uniforms only hold the slots
+		Array<U32, MAX_INSTANCES> gpuSceneSlots;
+		U32 gpuSceneSlotCount = 0;
+		const U32 gpuSceneBinding = patch.getMaterial()->getGpuSceneBinding();
+		if(gpuSceneBinding != MAX_U32)
+		{
+			ANKI_ASSERT(ctx.m_gpuSceneBuffer.isCreated());
+			cmdb->bindStorageBuffer(patch.getMaterial()->getDescriptorSetIndex(), gpuSceneBinding,
+									ctx.m_gpuSceneBuffer, 0, MAX_PTR_SIZE);
 
-		// Uniforms
-		RenderComponent::allocateAndSetupUniforms(m_model->getModelPatches()[m_modelPatchIdx].getMaterial(), ctx,
-												  ConstWeakArray<Mat4>(&trfs[0], userData.getSize()),
-												  ConstWeakArray<Mat4>(&prevTrfs[0], userData.getSize()),
-												  *ctx.m_stagingGpuAllocator);
+			for(U32 i = 0; i < userData.getSize(); ++i)
+			{
+				const ModelNode& self2 = *static_cast<const ModelNode*>(userData[i]);
+				ANKI_ASSERT(self2.m_gpuSceneSlot != MAX_U32);
+				gpuSceneSlots[i] = self2.m_gpuSceneSlot;
+			}
+			gpuSceneSlotCount = userData.getSize();
 
-		// Set attributes
-		for(U i = 0; i < modelInf.m_vertexAttributeCount; ++i)
-		{
-			const VertexAttributeInfo& attrib = modelInf.m_vertexAttributes[i];
-			ANKI_ASSERT(attrib.m_format != Format::NONE);
-			cmdb->setVertexAttribute(U32(attrib.m_location), attrib.m_bufferBinding, attrib.m_format,
-									 attrib.m_relativeOffset);
+			// The non instanced variants can read the remap buffer as well. They won't because the slot is valid
+			const U32 instanceRemapBinding = patch.getMaterial()->getInstanceRemapBinding();
+			if(instanceRemapBinding != MAX_U32 && userData.getSize() == 1)
+			{
+				cmdb->bindStorageBuffer(patch.getMaterial()->getDescriptorSetIndex(), instanceRemapBinding,
+										ctx.m_gpuSceneBuffer, 0, MAX_PTR_SIZE);
+			}
 		}
 
-		// Set vertex buffers
-		for(U32 i = 0; i < modelInf.m_vertexBufferBindingCount; ++i)
-		{
-			const VertexBufferBinding& binding = modelInf.m_vertexBufferBindings[i];
-			cmdb->bindVertexBuffer(i, binding.m_buffer, binding.m_offset, binding.m_stride, VertexStepRate::VERTEX);
-		}
+		// Program
+		cmdb->bindShaderProgram(modelInf.m_program);
+
+		// Uniforms
+		RenderComponent::allocateAndSetupUniforms(
+			m_model->getModelPatches()[m_modelPatchIdx].getMaterial(), ctx,
+			ConstWeakArray<Mat4>(&trfs[0], userData.getSize()), ConstWeakArray<Mat4>(&prevTrfs[0], userData.getSize()),
+			*ctx.m_stagingGpuAllocator, ConstWeakArray<U32>(&gpuSceneSlots[0], gpuSceneSlotCount),
+			Mat4(modelInf.m_positionDequantization));
 
-		// Index buffer
-		cmdb->bindIndexBuffer(modelInf.m_indexBuffer, 0, IndexType::U16);
+		setVertexState(modelInf, cmdb);
 
 		// Draw
 		cmdb->drawElements(PrimitiveTopology::TRIANGLES, modelInf.m_indicesCountArray[0], userData.getSize(),
@@ -356,7 +471,7 @@ void ModelNode::setupRayTracingInstanceQueueElement(U32 lod, const void* userDat
 	// Set the descriptor
 	el.m_modelDescriptor = info.m_descriptor;
 	const MoveComponent& movec = self.getFirstComponentOfType<MoveComponent>();
-	const Mat3x4 worldTrf(movec.getWorldTransform());
+	const Mat3x4 worldTrf(movec.getWorldTransform().combineTransformations(info.m_positionDequantization));
 	memcpy(&el.m_modelDescriptor.m_worldTransform, &worldTrf, sizeof(worldTrf));
 	el.m_modelDescriptor.m_worldRotation = movec.getWorldTransform().getRotation().getRotationPart();
 
@@ -48,13 +48,22 @@ private:
 	Obb m_obbWorld;
 	U64 m_mergeKey = 0;
 	U32 m_modelPatchIdx = 0;
+	U32 m_gpuSceneSlot = MAX_U32;
+	Bool m_gpuSceneNeedsPrevTransformUpdate = false;
 
 	DebugDrawer2 m_dbgDrawer;
 
 	void updateSpatialComponent(const MoveComponent& move);
 
+	void updateGpuScene(const MoveComponent& move);
+
 	void draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData) const;
 
+	/// Draw a bucket of the GPU instance culling. It doesn't touch the instances.
+	void drawGpuCulled(RenderQueueDrawContext& ctx, const ModelPatch& patch) const;
+
+	static void setVertexState(const ModelRenderingInfo& modelInf, CommandBufferPtr& cmdb);
+
 	static void setupRayTracingInstanceQueueElement(U32 lod, const void* userData, RayTracingInstanceQueueElement& el);
 };
 /// @}
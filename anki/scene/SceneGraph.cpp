@@ -8,7 +8,10 @@
 #include <anki/scene/PhysicsDebugNode.h>
 #include <anki/scene/ModelNode.h>
 #include <anki/scene/Octree.h>
+#include <anki/scene/GpuScene.h>
 #include <anki/scene/components/FrustumComponent.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/scene/components/SkinComponent.h>
 #include <anki/physics/PhysicsWorld.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/renderer/MainRenderer.h>
@@ -33,6 +36,16 @@ public:
 	Second m_crntTime;
 };
 
+class SceneGraph::UpdateSkinComponentsCtx
+{
+public:
+	WeakArray<SkinComponent*> m_skins;
+	Atomic<U32> m_crntSkin = {0};
+
+	Second m_prevUpdateTime;
+	Second m_crntTime;
+};
+
 SceneGraph::SceneGraph()
 {
 }
@@ -51,6 +64,11 @@ SceneGraph::~SceneGraph()
 	{
 		m_alloc.deleteInstance(m_octree);
 	}
+
+	if(m_gpuScene)
+	{
+		m_alloc.deleteInstance(m_gpuScene);
+	}
 }
 
 Error SceneGraph::init(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* threadHive,
@@ -79,12 +97,16 @@ Error SceneGraph::init(AllocAlignedCallback allocCb, void* allocCbData, ThreadHi
 	m_config.m_maxLodDistances[0] = config.getNumberF32("scene_lod0MaxDistance");
 	m_config.m_maxLodDistances[1] = config.getNumberF32("scene_lod1MaxDistance");
 	m_config.m_maxLodDistances[2] = config.getNumberF32("scene_lod2MaxDistance");
+	m_config.m_gpuInstanceCulling = config.getBool("r_gpuInstanceCulling");
 
 	ANKI_CHECK(m_events.init(this));
 
 	m_octree = m_alloc.newInstance<Octree>(m_alloc);
 	m_octree->init(m_sceneMin, m_sceneMax, config.getNumberU32("scene_octreeMaxDepth"));
 
+	m_gpuScene = m_alloc.newInstance<GpuScene>();
+	m_gpuScene->init(m_alloc, m_gr, config.getNumberU32("scene_gpuSceneInitialSlotCount"));
+
 	// Init the default main camera
 	ANKI_CHECK(newSceneNode<PerspectiveCameraNode>("mainCamera", m_defaultMainCam));
 	m_defaultMainCam->getFirstComponentOfType<FrustumComponent>().setPerspective(0.1f, 1000.0f, toRad(60.0f),
@@ -203,6 +225,11 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		deleteNodesMarkedForDeletion();
 	}
 
+	// Make room for the nodes that will move this frame
+	m_movedObjectCount.setNonAtomically(0);
+	m_movedObjectPositions = (m_nodesCount) ? WeakArray<Vec3>(m_frameAlloc.newArray<Vec3>(m_nodesCount), m_nodesCount)
+											: WeakArray<Vec3>();
+
 	// Update
 	{
 		ANKI_TRACE_SCOPED_EVENT(SCENE_PHYSICS_UPDATE);
@@ -215,6 +242,9 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		ANKI_TRACE_SCOPED_EVENT(SCENE_NODES_UPDATE);
 		ANKI_CHECK(m_events.updateAllEvents(prevUpdateTime, crntTime));
 
+		// Then the skins since the nodes depend on them
+		updateSkinComponents(prevUpdateTime, crntTime);
+
 		// Then the rest
 		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
 		UpdateSceneNodesCtx updateCtx;
@@ -247,6 +277,9 @@ void SceneGraph::doVisibilityTests(RenderQueue& rqueue)
 {
 	m_stats.m_visibilityTestsTime = HighRezTimer::getCurrentTime();
 	doVisibilityTests(*m_mainCam, *this, rqueue);
+	m_gpuScene->fillRenderQueue(m_frameAlloc, rqueue.m_gpuScene);
+	const U32 movedObjectCount = min(m_movedObjectCount.getNonAtomically(), m_movedObjectPositions.getSize());
+	rqueue.m_movedObjectPositions = WeakArray<Vec3>(m_movedObjectPositions.getBegin(), movedObjectCount);
 	m_stats.m_visibilityTestsTime = HighRezTimer::getCurrentTime() - m_stats.m_visibilityTestsTime;
 }
 
@@ -258,6 +291,7 @@ Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
 
 	// Components update
 	Timestamp componentTimestamp = 0;
+	Bool moved = false;
 	err = node.iterateComponents([&](SceneComponent& comp) -> Error {
 		Bool updated = false;
 		Error e = comp.update(node, prevTime, crntTime, updated);
@@ -267,11 +301,18 @@ Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
 			comp.setTimestamp(node.getSceneGraph().m_timestamp);
 			componentTimestamp = max(componentTimestamp, node.getSceneGraph().m_timestamp);
 			ANKI_ASSERT(componentTimestamp > 0);
+
+			moved = moved || comp.getType() == SceneComponentType::MOVE || comp.getType() == SceneComponentType::SKIN;
 		}
 
 		return e;
 	});
 
+	if(moved)
+	{
+		node.getSceneGraph().addMovedObject(node);
+	}
+
 	// Update children
 	if(!err)
 	{
@@ -347,4 +388,78 @@ Error SceneGraph::updateNodes(UpdateSceneNodesCtx& ctx) const
 	return err;
 }
 
+void SceneGraph::addMovedObject(const SceneNode& node)
+{
+	const MoveComponent* move = node.tryGetFirstComponentOfType<MoveComponent>();
+	if(!move)
+	{
+		return;
+	}
+
+	// Nodes created during the update may not fit. The probes will just miss their motion for a frame
+	const U32 idx = m_movedObjectCount.fetchAdd(1);
+	if(idx < m_movedObjectPositions.getSize())
+	{
+		m_movedObjectPositions[idx] = move->getWorldTransform().getOrigin().xyz();
+	}
+}
+
+void SceneGraph::registerSkinComponent(SkinComponent& skin)
+{
+	LockGuard<SpinLock> lock(m_skinComponentsLock);
+	m_skinComponents.pushBack(&skin);
+	++m_skinComponentCount;
+}
+
+void SceneGraph::unregisterSkinComponent(SkinComponent& skin)
+{
+	LockGuard<SpinLock> lock(m_skinComponentsLock);
+	m_skinComponents.erase(&skin);
+	ANKI_ASSERT(m_skinComponentCount > 0);
+	--m_skinComponentCount;
+}
+
+void SceneGraph::updateSkinComponents(Second prevUpdateTime, Second crntTime)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_SKINS_UPDATE);
+
+	if(m_skinComponentCount == 0)
+	{
+		return;
+	}
+
+	// Flatten the list so the threads can fetch skins with an atomic
+	DynamicArrayAuto<SkinComponent*> skins(m_frameAlloc, m_skinComponentCount);
+	U32 count = 0;
+	for(SkinComponent& skin : m_skinComponents)
+	{
+		skins[count++] = &skin;
+	}
+
+	UpdateSkinComponentsCtx ctx;
+	ctx.m_skins = WeakArray<SkinComponent*>(skins);
+	ctx.m_prevUpdateTime = prevUpdateTime;
+	ctx.m_crntTime = crntTime;
+
+	// Skins are big units of work so fetch them one by one
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+	const U32 threadCount = min(m_threadHive->getThreadCount(), m_skinComponentCount);
+	for(U32 i = 0; i < threadCount; i++)
+	{
+		tasks[i] = ANKI_THREAD_HIVE_TASK(
+			{
+				ANKI_TRACE_SCOPED_EVENT(SCENE_SKINS_UPDATE);
+				U32 idx;
+				while((idx = self->m_crntSkin.fetchAdd(1)) < self->m_skins.getSize())
+				{
+					self->m_skins[idx]->evaluatePose(self->m_prevUpdateTime, self->m_crntTime);
+				}
+			},
+			&ctx, nullptr, nullptr);
+	}
+
+	m_threadHive->submitTasks(&tasks[0], threadCount);
+	m_threadHive->waitAllTasks();
+}
+
 } // end namespace anki
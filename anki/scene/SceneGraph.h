@@ -11,6 +11,7 @@
 #include <anki/util/Singleton.h>
 #include <anki/util/HighRezTimer.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/WeakArray.h>
 #include <anki/core/App.h>
 #include <anki/scene/events/EventManager.h>
 #include <anki/resource/Common.h>
@@ -27,6 +28,8 @@ class ConfigSet;
 class PerspectiveCameraNode;
 class UpdateSceneNodesCtx;
 class Octree;
+class SkinComponent;
+class GpuScene;
 
 /// @addtogroup scene
 /// @{
@@ -50,12 +53,14 @@ public:
 	Bool m_rayTracedShadows = false;
 	F32 m_rayTracingExtendedFrustumDistance = 100.0f; ///< The frustum distance from the eye to every direction.
 	Array<F32, MAX_LOD_COUNT> m_maxLodDistances = {};
+	Bool m_gpuInstanceCulling = false; ///< The renderer culls the G-buffer renderables of the camera.
 };
 
 /// The scene graph that  all the scene entities
 class SceneGraph
 {
 	friend class SceneNode;
+	friend class SkinComponent;
 	friend class UpdateSceneNodesTask;
 
 public:
@@ -227,8 +232,15 @@ public:
 		return *m_octree;
 	}
 
+	GpuScene& getGpuScene()
+	{
+		ANKI_ASSERT(m_gpuScene);
+		return *m_gpuScene;
+	}
+
 private:
 	class UpdateSceneNodesCtx;
+	class UpdateSkinComponentsCtx;
 
 	const Timestamp* m_globalTimestamp = nullptr;
 	Timestamp m_timestamp = 0; ///< Cached timestamp
@@ -248,6 +260,10 @@ private:
 	U32 m_nodesCount = 0;
 	HashMap<CString, SceneNode*> m_nodesDict;
 
+	IntrusiveList<SkinComponent> m_skinComponents;
+	U32 m_skinComponentCount = 0;
+	SpinLock m_skinComponentsLock;
+
 	SceneNode* m_mainCam = nullptr;
 	Timestamp m_activeCameraChangeTimestamp = 0;
 	PerspectiveCameraNode* m_defaultMainCam = nullptr;
@@ -256,6 +272,12 @@ private:
 
 	Octree* m_octree = nullptr;
 
+	GpuScene* m_gpuScene = nullptr;
+
+	/// The world positions of the nodes that moved or got a new pose this frame. Allocated from the frame allocator.
+	WeakArray<Vec3> m_movedObjectPositions;
+	Atomic<U32> m_movedObjectCount = {0};
+
 	Vec3 m_sceneMin = {-1000.0f, -200.0f, -1000.0f};
 	Vec3 m_sceneMax = {1000.0f, 200.0f, 1000.0f};
 
@@ -276,6 +298,16 @@ private:
 	ANKI_USE_RESULT Error updateNodes(UpdateSceneNodesCtx& ctx) const;
 	ANKI_USE_RESULT static Error updateNode(Second prevTime, Second crntTime, SceneNode& node);
 
+	/// Remember the position of a node that moved or got a new pose. It's thread-safe.
+	void addMovedObject(const SceneNode& node);
+
+	void registerSkinComponent(SkinComponent& skin);
+	void unregisterSkinComponent(SkinComponent& skin);
+
+	/// Evaluate the poses of all skins in parallel. It runs before the nodes get updated so the nodes can use the
+	/// results.
+	void updateSkinComponents(Second prevUpdateTime, Second crntTime);
+
 	/// Do visibility tests.
 	static void doVisibilityTests(SceneNode& frustumable, SceneGraph& scene, RenderQueue& rqueue);
 };
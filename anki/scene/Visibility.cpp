@@ -135,7 +135,7 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, const Frustum
 	// Combind results task
 	ANKI_ASSERT(frcCtx->m_visTestsSignalSem);
 	ThreadHiveTask combineTask = ANKI_THREAD_HIVE_TASK(
-		{ self->combine(); }, alloc.newInstance<CombineResultsTask>(frcCtx), frcCtx->m_visTestsSignalSem, nullptr);
+		{ self->combine(hive); }, alloc.newInstance<CombineResultsTask>(frcCtx), frcCtx->m_visTestsSignalSem, nullptr);
 	hive.submitTasks(&combineTask, 1);
 }
 
@@ -239,9 +239,17 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 	Timestamp& timestamp = m_frcCtx->m_queueViews[taskId].m_timestamp;
 	timestamp = testedNode.getComponentMaxTimestamp();
 
+	// The static shadow layer of the light changes if the light moves
+	Timestamp& staticShadowTimestamp = m_frcCtx->m_queueViews[taskId].m_staticShadowTimestamp;
+	staticShadowTimestamp = testedNode.getComponentMaxTimestamp();
+	const Bool isShadowFrustum = !!(enabledVisibilityTests & FrustumComponentVisibilityTestFlag::SHADOW_CASTERS);
+	const Timestamp globalTimestamp = testedNode.getGlobalTimestamp();
+
 	const Bool wantsEarlyZ = !!(enabledVisibilityTests & FrustumComponentVisibilityTestFlag::EARLY_Z)
 							 && m_frcCtx->m_visCtx->m_earlyZDist > 0.0f;
 
+	const Bool gpuCulledFrustum = m_frcCtx->m_visCtx->m_gpuCulledFrustum == &testedFrc;
+
 	// Iterate
 	RenderQueueView& result = m_frcCtx->m_queueViews[taskId];
 	for(U i = 0; i < m_spatialToTestCount; ++i)
@@ -305,6 +313,12 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			continue;
 		}
 
+		// The renderer culls them on the GPU against the frustum and the Hi-Z. Don't test them here unless the node
+		// has something else to test
+		const Bool gpuCulled = gpuCulledFrustum && rc && rc->getGpuSceneSlot() != MAX_U32
+							   && !(rc->getFlags() & RenderComponentFlag::FORWARD_SHADING) && !rtRc && !lc && !lfc
+							   && !reflc && !decalc && !fogc && !giprobec && !computec;
+
 		// Test all spatial components of that node
 		struct SpatialTemp
 		{
@@ -317,7 +331,7 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		U32 spIdx = 0;
 		U32 count = 0;
 		Error err = node.iterateComponentsOfType<SpatialComponent>([&](SpatialComponent& sp) {
-			if(spatialInsideFrustum(testedFrc, sp) && testAgainstRasterizer(sp.getAabb()))
+			if(gpuCulled || (spatialInsideFrustum(testedFrc, sp) && testAgainstRasterizer(sp.getAabb())))
 			{
 				// Inside
 				ANKI_ASSERT(spIdx < MAX_U8);
@@ -359,6 +373,13 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			{
 				el = result.m_forwardShadingRenderables.newElement(alloc);
 			}
+			else if(isShadowFrustum && isStaticShadowCaster(node.getComponentMaxTimestamp(), globalTimestamp))
+			{
+				// Didn't move for a while, it goes to the static shadow layer
+				el = result.m_staticShadowRenderables.newElement(alloc);
+				staticShadowTimestamp =
+					accumulateStaticShadowTimestamp(staticShadowTimestamp, node.getComponentMaxTimestamp());
+			}
 			else
 			{
 				el = result.m_renderables.newElement(alloc);
@@ -372,11 +393,22 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 										   ? testedFrc.getFar()
 										   : max(0.0f, testPlane(nearPlane, sps[0].m_sp->getAabb()));
 
+			el->m_aabbMin = sps[0].m_sp->getAabb().getMin().xyz();
+			el->m_aabbMax = sps[0].m_sp->getAabb().getMax().xyz();
+
+			// Forward shading is drawn back to front because of blending
+			el->m_sortKey = !!(rc->getFlags() & RenderComponentFlag::FORWARD_SHADING)
+								? computeReverseDistanceSortKey(el->m_distanceFromCamera)
+								: computeMaterialDistanceSortKey(*el, RENDERABLE_SORT_DISTANCE_GRANULARITY);
+
+			// The early Z is drawn from the CPU so test the few GPU culled renderables that are close enough
 			if(wantsEarlyZ && el->m_distanceFromCamera < m_frcCtx->m_visCtx->m_earlyZDist
-			   && !(rc->getFlags() & RenderComponentFlag::FORWARD_SHADING))
+			   && !(rc->getFlags() & RenderComponentFlag::FORWARD_SHADING)
+			   && (!gpuCulled || spatialInsideFrustum(testedFrc, *sps[0].m_sp)))
 			{
 				RenderableQueueElement* el2 = result.m_earlyZRenderables.newElement(alloc);
 				*el2 = *el;
+				el2->m_sortKey = computeDistanceSortKey(el->m_distanceFromCamera);
 			}
 		}
 
@@ -638,7 +670,7 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 	} // end for
 }
 
-void CombineResultsTask::combine()
+void CombineResultsTask::combine(ThreadHive& hive)
 {
 	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_COMBINE_RESULTS);
 
@@ -655,6 +687,13 @@ void CombineResultsTask::combine()
 	}
 	ANKI_ASSERT(results.m_shadowRenderablesLastUpdateTimestamp);
 
+	results.m_staticShadowRenderablesLastUpdateTimestamp = 0;
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		results.m_staticShadowRenderablesLastUpdateTimestamp = max(
+			results.m_staticShadowRenderablesLastUpdateTimestamp, m_frcCtx->m_queueViews[i].m_staticShadowTimestamp);
+	}
+
 #define ANKI_VIS_COMBINE(t_, member_) \
 	{ \
 		Array<TRenderQueueElementStorage<t_>, 64> subStorages; \
@@ -687,6 +726,34 @@ void CombineResultsTask::combine()
 		}
 	}
 
+	// The static shadow casters go first
+	WeakArray<RenderableQueueElement> staticShadowRenderables;
+	{
+		Array<TRenderQueueElementStorage<RenderableQueueElement>, 64> subStorages;
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			subStorages[i] = m_frcCtx->m_queueViews[i].m_staticShadowRenderables;
+		}
+		combineQueueElements<RenderableQueueElement>(
+			alloc, WeakArray<TRenderQueueElementStorage<RenderableQueueElement>>(&subStorages[0], threadCount), nullptr,
+			staticShadowRenderables, nullptr);
+	}
+
+	results.m_staticShadowRenderableCount = staticShadowRenderables.getSize();
+	if(staticShadowRenderables.getSize() > 0 && results.m_renderables.getSize() > 0)
+	{
+		const U32 totalCount = staticShadowRenderables.getSize() + results.m_renderables.getSize();
+		RenderableQueueElement* allRenderables = alloc.newArray<RenderableQueueElement>(totalCount);
+		memcpy(allRenderables, staticShadowRenderables.getBegin(), staticShadowRenderables.getSizeInBytes());
+		memcpy(allRenderables + staticShadowRenderables.getSize(), results.m_renderables.getBegin(),
+			   results.m_renderables.getSizeInBytes());
+		results.m_renderables = WeakArray<RenderableQueueElement>(allRenderables, totalCount);
+	}
+	else if(staticShadowRenderables.getSize() > 0)
+	{
+		results.m_renderables = staticShadowRenderables;
+	}
+
 #undef ANKI_VIS_COMBINE
 
 	const Bool isShadowFrustum =
@@ -695,13 +762,9 @@ void CombineResultsTask::combine()
 	// Sort some of the arrays
 	if(!isShadowFrustum)
 	{
-		std::sort(results.m_renderables.getBegin(), results.m_renderables.getEnd(), MaterialDistanceSortFunctor(20.0f));
-
-		std::sort(results.m_earlyZRenderables.getBegin(), results.m_earlyZRenderables.getEnd(),
-				  DistanceSortFunctor<RenderableQueueElement>());
-
-		std::sort(results.m_forwardShadingRenderables.getBegin(), results.m_forwardShadingRenderables.getEnd(),
-				  RevDistanceSortFunctor<RenderableQueueElement>());
+		sortRenderables(hive, alloc, results.m_renderables);
+		sortRenderables(hive, alloc, results.m_earlyZRenderables);
+		sortRenderables(hive, alloc, results.m_forwardShadingRenderables);
 	}
 
 	std::sort(results.m_giProbes.getBegin(), results.m_giProbes.getEnd());
@@ -738,6 +801,63 @@ void CombineResultsTask::combine()
 	}
 }
 
+void CombineResultsTask::sortRenderables(ThreadHive& hive, SceneFrameAllocator<U8>& alloc,
+										 WeakArray<RenderableQueueElement>& renderables)
+{
+	const U32 count = renderables.getSize();
+	if(count <= 1)
+	{
+		return;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_SORT);
+
+	// Sort the keys and not the big elements. Then copy the elements to a new array in the sorted order
+	WeakArray<RadixSortPair> pairs(alloc.newArray<RadixSortPair>(count), count);
+	WeakArray<RadixSortPair> scratch(alloc.newArray<RadixSortPair>(count), count);
+	for(U32 i = 0; i < count; ++i)
+	{
+		pairs[i].m_key = renderables[i].m_sortKey;
+		pairs[i].m_index = i;
+	}
+
+	RenderableQueueElement* sortedRenderables = alloc.newArray<RenderableQueueElement>(count);
+
+	if(count < PARALLEL_SORT_MIN_RENDERABLES)
+	{
+		const ConstWeakArray<RadixSortPair> sorted = radixSort(pairs, scratch);
+		for(U32 i = 0; i < count; ++i)
+		{
+			sortedRenderables[i] = renderables[sorted[i].m_index];
+		}
+	}
+	else
+	{
+		WeakArray<RadixSortPair> sorted;
+		ThreadHiveSemaphore* sortDoneSemaphore;
+		radixSort(hive, alloc, pairs, scratch, sorted, sortDoneSemaphore);
+
+		// Nobody reads the renderables before the hive is done so the copy can happen later
+		const U32 taskCount = min(hive.getThreadCount(), count / (PARALLEL_SORT_MIN_RENDERABLES / 2));
+		const U32 renderablesPerTask = (count + taskCount - 1) / taskCount;
+		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+		for(U32 i = 0; i < taskCount; ++i)
+		{
+			GatherSortedRenderablesTask* gatherTask = alloc.newInstance<GatherSortedRenderablesTask>();
+			gatherTask->m_unsorted = renderables;
+			gatherTask->m_sorted = sorted;
+			gatherTask->m_out = sortedRenderables;
+			gatherTask->m_begin = i * renderablesPerTask;
+			gatherTask->m_end = min(gatherTask->m_begin + renderablesPerTask, count);
+
+			tasks[i] = ANKI_THREAD_HIVE_TASK({ self->gather(); }, gatherTask, sortDoneSemaphore, nullptr);
+		}
+		hive.submitTasks(&tasks[0], taskCount);
+	}
+
+	renderables = WeakArray<RenderableQueueElement>(sortedRenderables, count);
+}
+
 template<typename T>
 void CombineResultsTask::combineQueueElements(SceneFrameAllocator<U8>& alloc,
 											  WeakArray<TRenderQueueElementStorage<T>> subStorages,
@@ -843,6 +963,7 @@ void SceneGraph::doVisibilityTests(SceneNode& fsn, SceneGraph& scene, RenderQueu
 	ctx.m_scene = &scene;
 	ctx.m_earlyZDist = scene.getConfig().m_earlyZDistance;
 	const FrustumComponent& mainFrustum = fsn.getFirstComponentOfType<FrustumComponent>();
+	ctx.m_gpuCulledFrustum = (scene.getConfig().m_gpuInstanceCulling) ? &mainFrustum : nullptr;
 	ctx.submitNewWork(mainFrustum, nullptr, rqueue, hive);
 
 	const FrustumComponent* extendedFrustum = fsn.tryGetNthComponentOfType<FrustumComponent>(1);
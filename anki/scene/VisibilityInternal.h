@@ -11,6 +11,7 @@
 #include <anki/scene/Octree.h>
 #include <anki/util/Thread.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/RadixSort.h>
 #include <anki/renderer/RenderQueue.h>
 
 namespace anki
@@ -23,54 +24,64 @@ static const U32 MAX_SPATIALS_PER_VIS_TEST = 48; ///< Num of spatials to test in
 static const U32 SW_RASTERIZER_WIDTH = 80;
 static const U32 SW_RASTERIZER_HEIGHT = 50;
 
-/// Sort objects on distance
-template<typename T>
-class DistanceSortFunctor
-{
-public:
-	Bool operator()(const T& a, const T& b)
-	{
-		return a.m_distanceFromCamera < b.m_distanceFromCamera;
-	}
-};
+/// The distance steps of computeMaterialDistanceSortKey().
+static const F32 RENDERABLE_SORT_DISTANCE_GRANULARITY = 20.0f;
 
-template<typename T>
-class RevDistanceSortFunctor
+/// Sort the renderables with more than that in the ThreadHive.
+static const U32 PARALLEL_SORT_MIN_RENDERABLES = 8 * 1024;
+
+/// A shadow caster that hasn't changed for that many frames goes to the static shadow layer.
+static const Timestamp STATIC_SHADOW_CASTER_MIN_FRAMES = 10;
+
+/// Check if a shadow caster goes to the static shadow layer.
+inline Bool isStaticShadowCaster(Timestamp casterTimestamp, Timestamp globalTimestamp)
 {
-public:
-	Bool operator()(const T& a, const T& b)
-	{
-		return a.m_distanceFromCamera > b.m_distanceFromCamera;
-	}
-};
+	return casterTimestamp + STATIC_SHADOW_CASTER_MIN_FRAMES <= globalTimestamp;
+}
+
+/// The static shadow layer of a light changes when the light changes or when a caster becomes static. A caster that
+/// stops being static changes the caster count of the layer instead.
+/// @param layerTimestamp The timestamp of the layer so far. Starts with the timestamp of the light.
+/// @param casterTimestamp The timestamp of a static caster.
+inline Timestamp accumulateStaticShadowTimestamp(Timestamp layerTimestamp, Timestamp casterTimestamp)
+{
+	return max(layerTimestamp, casterTimestamp + STATIC_SHADOW_CASTER_MIN_FRAMES);
+}
 
-/// Material and distance sort.
-class MaterialDistanceSortFunctor
+/// Sort key for the renderables that are drawn front to back. The bits of positive floats sort like integers.
+inline U64 computeDistanceSortKey(F32 distanceFromCamera)
 {
-public:
-	MaterialDistanceSortFunctor(F32 distanceGranularity)
-		: m_distGranularity(1.0f / distanceGranularity)
-	{
-	}
+	ANKI_ASSERT(distanceFromCamera >= 0.0f);
+	U32 bits;
+	memcpy(&bits, &distanceFromCamera, sizeof(bits));
+	return bits;
+}
+
+/// Sort key for the renderables that are drawn back to front.
+inline U64 computeReverseDistanceSortKey(F32 distanceFromCamera)
+{
+	return U64(~U32(computeDistanceSortKey(distanceFromCamera)));
+}
+
+/// Sort key for the renderables that are drawn roughly front to back but grouped by state. From the MSB:
+/// - 12 bits of the distance in steps of distanceGranularity.
+/// - 16 bits of a hash of the callback.
+/// - 24 bits of the merge key. Renderables that can be merged end up next to each other.
+/// - 12 bits of the distance inside the step.
+inline U64 computeMaterialDistanceSortKey(const RenderableQueueElement& el, F32 distanceGranularity)
+{
+	const F32 steps = el.m_distanceFromCamera / distanceGranularity;
+	const U64 maxSteps = 0xFFF;
+	const U64 coarseDistance = min(U64(steps), maxSteps);
+	const U64 fineDistance = (coarseDistance < maxSteps) ? U64((steps - F32(coarseDistance)) * F32(0xFFF)) : 0xFFF;
 
-	Bool operator()(const RenderableQueueElement& a, const RenderableQueueElement& b)
-	{
-		const U32 aClass = U32(a.m_distanceFromCamera * m_distGranularity);
-		const U32 bClass = U32(b.m_distanceFromCamera * m_distGranularity);
+	const U64 callbackAddr = ptrToNumber(el.m_callback);
+	const U64 callbackHash = ((callbackAddr >> 4) ^ (callbackAddr >> 20) ^ (callbackAddr >> 36)) & 0xFFFF;
 
-		if(aClass == bClass && a.m_callback == b.m_callback)
-		{
-			return a.m_mergeKey < b.m_mergeKey;
-		}
-		else
-		{
-			return a.m_distanceFromCamera < b.m_distanceFromCamera;
-		}
-	}
+	const U64 mergeKey = el.m_mergeKey >> 40;
 
-private:
-	F32 m_distGranularity;
-};
+	return (coarseDistance << 52) | (callbackHash << 36) | (mergeKey << 12) | fineDistance;
+}
 
 /// Storage for a single element type.
 template<typename T, U32 INITIAL_STORAGE_SIZE = 32, U32 STORAGE_GROW_RATE = 4>
@@ -104,6 +115,7 @@ class RenderQueueView
 {
 public:
 	TRenderQueueElementStorage<RenderableQueueElement> m_renderables; ///< Deferred shading or shadow renderables.
+	TRenderQueueElementStorage<RenderableQueueElement> m_staticShadowRenderables;
 	TRenderQueueElementStorage<RenderableQueueElement> m_forwardShadingRenderables;
 	TRenderQueueElementStorage<RenderableQueueElement> m_earlyZRenderables;
 	TRenderQueueElementStorage<PointLightQueueElement> m_pointLights;
@@ -118,6 +130,7 @@ public:
 	TRenderQueueElementStorage<RayTracingInstanceQueueElement> m_rayTracingInstances;
 
 	Timestamp m_timestamp = 0;
+	Timestamp m_staticShadowTimestamp = 0;
 
 	RenderQueueView()
 	{
@@ -136,6 +149,9 @@ public:
 
 	F32 m_earlyZDist = -1.0f; ///< Cache this.
 
+	/// The renderables of that frustum that can be culled on the GPU skip the frustum tests.
+	const FrustumComponent* m_gpuCulledFrustum = nullptr;
+
 	List<const FrustumComponent*> m_testedFrcs;
 	Mutex m_mtx;
 
@@ -245,9 +261,13 @@ public:
 		ANKI_ASSERT(m_frcCtx);
 	}
 
-	void combine();
+	void combine(ThreadHive& hive);
 
 private:
+	/// Reorder the renderables based on their sort keys.
+	static void sortRenderables(ThreadHive& hive, SceneFrameAllocator<U8>& alloc,
+								WeakArray<RenderableQueueElement>& renderables);
+
 	template<typename T>
 	static void combineQueueElements(SceneFrameAllocator<U8>& alloc,
 									 WeakArray<TRenderQueueElementStorage<T>> subStorages,
@@ -255,6 +275,28 @@ private:
 									 WeakArray<T*>* ptrCombined);
 };
 static_assert(std::is_trivially_destructible<CombineResultsTask>::value == true, "Should be trivially destructible");
+
+/// Task that copies a range of renderables to their sorted position.
+class GatherSortedRenderablesTask
+{
+public:
+	ConstWeakArray<RenderableQueueElement> m_unsorted;
+	ConstWeakArray<RadixSortPair> m_sorted;
+	RenderableQueueElement* m_out = nullptr;
+	U32 m_begin = 0;
+	U32 m_end = 0;
+
+	void gather()
+	{
+		ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_SORT);
+		for(U32 i = m_begin; i < m_end; ++i)
+		{
+			m_out[i] = m_unsorted[m_sorted[i].m_index];
+		}
+	}
+};
+static_assert(std::is_trivially_destructible<GatherSortedRenderablesTask>::value == true,
+			  "Should be trivially destructible");
 /// @}
 
 } // end namespace anki
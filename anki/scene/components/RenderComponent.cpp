@@ -14,7 +14,8 @@ namespace anki
 
 void RenderComponent::allocateAndSetupUniforms(const MaterialResourcePtr& mtl, const RenderQueueDrawContext& ctx,
 											   ConstWeakArray<Mat4> transforms, ConstWeakArray<Mat4> prevTransforms,
-											   StagingGpuMemoryManager& alloc)
+											   StagingGpuMemoryManager& alloc, ConstWeakArray<U32> gpuSceneSlots,
+											   const Mat4& positionDequantization)
 {
 	ANKI_ASSERT(transforms.getSize() <= MAX_INSTANCES);
 	ANKI_ASSERT(prevTransforms.getSize() == transforms.getSize());
@@ -40,6 +41,29 @@ void RenderComponent::allocateAndSetupUniforms(const MaterialResourcePtr& mtl, c
 
 		switch(mvar.getDataType())
 		{
+		case ShaderVariableDataType::U32:
+		{
+			switch(mvar.getBuiltin())
+			{
+			case BuiltinMaterialVariableId::NONE:
+			{
+				const U32 val = mvar.getValue<U32>();
+				variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
+				break;
+			}
+			case BuiltinMaterialVariableId::GPU_SCENE_SLOT:
+			{
+				ANKI_ASSERT(gpuSceneSlots.getSize() > 0);
+				variant.writeShaderBlockMemory(mvar, &gpuSceneSlots[0], gpuSceneSlots.getSize(), uniformsBegin,
+											   uniformsEnd);
+				break;
+			}
+			default:
+				ANKI_ASSERT(0);
+			}
+
+			break;
+		}
 		case ShaderVariableDataType::F32:
 		{
 			const F32 val = mvar.getValue<F32>();
@@ -188,10 +212,20 @@ void RenderComponent::allocateAndSetupUniforms(const MaterialResourcePtr& mtl, c
 			}
 			case BuiltinMaterialVariableId::VIEW_PROJECTION_MATRIX:
 			{
-				ANKI_ASSERT(transforms.getSize() == 0 && "Cannot have transform");
 				variant.writeShaderBlockMemory(mvar, &ctx.m_viewProjectionMatrix, 1, uniformsBegin, uniformsEnd);
 				break;
 			}
+			case BuiltinMaterialVariableId::PREVIOUS_VIEW_PROJECTION_MATRIX:
+			{
+				variant.writeShaderBlockMemory(mvar, &ctx.m_previousViewProjectionMatrix, 1, uniformsBegin,
+											   uniformsEnd);
+				break;
+			}
+			case BuiltinMaterialVariableId::POSITION_DEQUANTIZATION_MATRIX:
+			{
+				variant.writeShaderBlockMemory(mvar, &positionDequantization, 1, uniformsBegin, uniformsEnd);
+				break;
+			}
 			case BuiltinMaterialVariableId::VIEW_MATRIX:
 			{
 				variant.writeShaderBlockMemory(mvar, &ctx.m_viewMatrix, 1, uniformsBegin, uniformsEnd);
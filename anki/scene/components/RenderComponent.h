@@ -82,6 +82,20 @@ public:
 		el.m_userData = m_userData;
 		ANKI_ASSERT(el.m_mergeKey != MAX_U64);
 		el.m_mergeKey = m_mergeKey;
+		el.m_gpuSceneSlot = m_gpuSceneSlot;
+	}
+
+	/// Set the GPU scene slot of a renderable that the GPU instance culling can draw. Its material should read the
+	/// GPU scene and the instance remap buffer.
+	void setGpuSceneSlot(U32 slot)
+	{
+		m_gpuSceneSlot = slot;
+	}
+
+	/// The GPU scene slot or MAX_U32 if the renderable can't be culled on the GPU.
+	U32 getGpuSceneSlot() const
+	{
+		return m_gpuSceneSlot;
 	}
 
 	void setupRayTracingInstanceQueueElement(U32 lod, RayTracingInstanceQueueElement& el) const
@@ -96,14 +110,20 @@ public:
 	}
 
 	/// Helper function.
+	/// @param gpuSceneSlots The GpuScene slots of the instances. Only for materials that read the GPU scene.
+	/// @param positionDequantization Only for materials that read the GPU scene. The rest get it folded into the
+	///                               transforms.
 	static void allocateAndSetupUniforms(const MaterialResourcePtr& mtl, const RenderQueueDrawContext& ctx,
 										 ConstWeakArray<Mat4> transforms, ConstWeakArray<Mat4> prevTransforms,
-										 StagingGpuMemoryManager& alloc);
+										 StagingGpuMemoryManager& alloc,
+										 ConstWeakArray<U32> gpuSceneSlots = ConstWeakArray<U32>(),
+										 const Mat4& positionDequantization = Mat4::getIdentity());
 
 private:
 	RenderQueueDrawCallback m_callback = nullptr;
 	const void* m_userData = nullptr;
 	U64 m_mergeKey = MAX_U64;
+	U32 m_gpuSceneSlot = MAX_U32;
 	FillRayTracingInstanceQueueElementCallback m_rtCallback = nullptr;
 	const void* m_rtCallbackUserData = nullptr;
 	RenderComponentFlag m_flags = RenderComponentFlag::NONE;
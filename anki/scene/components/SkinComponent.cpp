@@ -4,7 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/scene/components/SkinComponent.h>
-#include <anki/scene/SceneNode.h>
+#include <anki/scene/SceneGraph.h>
 #include <anki/resource/SkeletonResource.h>
 #include <anki/resource/AnimationResource.h>
 #include <anki/util/BitSet.h>
@@ -23,13 +23,22 @@ SkinComponent::SkinComponent(SceneNode* node, SkeletonResourcePtr skeleton)
 	m_boneTrfs[1].create(m_node->getAllocator(), m_skeleton->getBones().getSize(), Mat4::getIdentity());
 	m_animationTrfs.create(m_node->getAllocator(), m_skeleton->getBones().getSize(),
 						   {Vec3(0.0f), Quat::getIdentity(), 1.0f});
+
+	m_node->getSceneGraph().registerSkinComponent(*this);
 }
 
 SkinComponent::~SkinComponent()
 {
+	m_node->getSceneGraph().unregisterSkinComponent(*this);
+
 	m_boneTrfs[0].destroy(m_node->getAllocator());
 	m_boneTrfs[1].destroy(m_node->getAllocator());
 	m_animationTrfs.destroy(m_node->getAllocator());
+
+	for(Track& track : m_tracks)
+	{
+		track.m_channelBones.destroy(m_node->getAllocator());
+	}
 }
 
 void SkinComponent::playAnimation(U32 track, AnimationResourcePtr anim, const AnimationPlayInfo& info)
@@ -50,17 +59,38 @@ void SkinComponent::playAnimation(U32 track, AnimationResourcePtr anim, const An
 		m_tracks[track].m_blendOutTime = 0.0; // Irrelevant
 	}
 	m_tracks[track].m_repeatTimes = info.m_repeatTimes;
+
+	// Resolve the bones once instead of every frame
+	DynamicArray<U32>& channelBones = m_tracks[track].m_channelBones;
+	channelBones.resize(m_node->getAllocator(), anim->getChannels().getSize());
+	for(U32 i = 0; i < anim->getChannels().getSize(); ++i)
+	{
+		const AnimationChannel& channel = anim->getChannels()[i];
+		const Bone* bone = m_skeleton->tryFindBone(channel.m_name.toCString());
+		if(!bone)
+		{
+			ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", &channel.m_name[0]);
+		}
+
+		channelBones[i] = (bone) ? bone->getIndex() : MAX_U32;
+	}
 }
 
 Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
 {
 	ANKI_ASSERT(&node == m_node);
 
-	updated = false;
-	const Second dt = crntTime - prevTime;
+	// The pose was evaluated by the SceneGraph earlier in the frame
+	updated = m_poseUpdated;
+	m_poseUpdated = false;
 
-	Vec4 minExtend(MAX_F32, MAX_F32, MAX_F32, 0.0f);
-	Vec4 maxExtend(MIN_F32, MIN_F32, MIN_F32, 0.0f);
+	return Error::NONE;
+}
+
+void SkinComponent::evaluatePose(Second prevTime, Second crntTime)
+{
+	Bool updated = false;
+	const Second dt = crntTime - prevTime;
 
 	BitSet<128> bonesAnimated(false);
 
@@ -91,23 +121,26 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 		const Second animTime = track.m_relativeTimePassed;
 		track.m_relativeTimePassed += dt;
 
-		// Iterate the animation channels and interpolate
-		for(U32 i = 0; i < track.m_anim->getChannels().getSize(); ++i)
+		// Sample all the animation channels at once
+		const U32 channelCount = track.m_anim->getChannels().getSize();
+		DynamicArrayAuto<Vec3> positions(m_node->getFrameAllocator(), channelCount);
+		DynamicArrayAuto<Quat> rotations(m_node->getFrameAllocator(), channelCount);
+		DynamicArrayAuto<F32> scales(m_node->getFrameAllocator(), channelCount);
+		track.m_anim->interpolateAll(animTime, WeakArray<Vec3>(positions), WeakArray<Quat>(rotations),
+									 WeakArray<F32>(scales));
+
+		// Iterate the animation channels
+		for(U32 i = 0; i < channelCount; ++i)
 		{
-			const AnimationChannel& channel = track.m_anim->getChannels()[i];
-			const Bone* bone = m_skeleton->tryFindBone(channel.m_name.toCString());
-			if(!bone)
+			const U32 boneIdx = track.m_channelBones[i];
+			if(boneIdx == MAX_U32)
 			{
-				ANKI_SCENE_LOGW("Animation is referencing unknown bone \"%s\"", &channel.m_name[0]);
 				continue;
 			}
-			const U32 boneIdx = bone->getIndex();
 
-			// Interpolate
-			Vec3 position;
-			Quat rotation;
-			F32 scale;
-			track.m_anim->interpolate(i, animTime, position, rotation, scale);
+			Vec3 position = positions[i];
+			Quat rotation = rotations[i];
+			F32 scale = scales[i];
 
 			// Blend with previous track
 			if(bonesAnimated.get(boneIdx) && (track.m_blendInTime > 0.0 || track.m_blendOutTime > 0.0))
@@ -158,49 +191,56 @@ Error SkinComponent::update(SceneNode& node, Second prevTime, Second crntTime, B
 		m_prevBoneTrfs = m_crntBoneTrfs;
 		m_crntBoneTrfs = m_crntBoneTrfs ^ 1;
 
-		// Walk the bone hierarchy to add additional transforms
-		visitBones(m_skeleton->getRootBone(), Mat4::getIdentity(), bonesAnimated, minExtend, maxExtend);
-
-		const Vec4 E(EPSILON, EPSILON, EPSILON, 0.0f);
-		m_boneBoundingVolume.setMin(minExtend - E);
-		m_boneBoundingVolume.setMax(maxExtend + E);
+		computeBoneTransforms(bonesAnimated);
 	}
 	else
 	{
 		m_prevBoneTrfs = m_crntBoneTrfs;
 	}
 
+	m_poseUpdated = updated;
 	m_absoluteTime += dt;
-
-	return Error::NONE;
 }
 
-void SkinComponent::visitBones(const Bone& bone, const Mat4& parentTrf, const BitSet<128>& bonesAnimated,
-							   Vec4& minExtend, Vec4& maxExtend)
+void SkinComponent::computeBoneTransforms(const BitSet<128, U8>& bonesAnimated)
 {
-	Mat4 outMat;
+	const DynamicArray<Bone>& bones = m_skeleton->getBones();
+	DynamicArrayAuto<Mat4> modelTrfs(m_node->getFrameAllocator(), bones.getSize());
+	WeakArray<Mat4> outTrfs(m_boneTrfs[m_crntBoneTrfs]);
 
-	if(bonesAnimated.get(bone.getIndex()))
-	{
-		const Trf& t = m_animationTrfs[bone.getIndex()];
-		outMat = parentTrf * Mat4(t.m_translation.xyz1(), Mat3(t.m_rotation), t.m_scale);
-	}
-	else
+	Vec4 minExtend(MAX_F32, MAX_F32, MAX_F32, 0.0f);
+	Vec4 maxExtend(MIN_F32, MIN_F32, MIN_F32, 0.0f);
+
+	// Parents come first so there is no need to recurse
+	for(U32 boneIdx : m_skeleton->getBoneIndicesInHierarchyOrder())
 	{
-		outMat = parentTrf * bone.getTransform();
-	}
+		const Bone& bone = bones[boneIdx];
 
-	m_boneTrfs[m_crntBoneTrfs][bone.getIndex()] = outMat * bone.getVertexTransform();
+		Mat4 localTrf;
+		if(bonesAnimated.get(boneIdx))
+		{
+			const Trf& t = m_animationTrfs[boneIdx];
+			localTrf = Mat4(t.m_translation.xyz1(), Mat3(t.m_rotation), t.m_scale);
+		}
+		else
+		{
+			localTrf = bone.getTransform();
+		}
 
-	// Update volume
-	const Vec4 bonePos = outMat * Vec4(0.0f, 0.0f, 0.0f, 1.0f);
-	minExtend = minExtend.min(bonePos.xyz0());
-	maxExtend = maxExtend.max(bonePos.xyz0());
+		modelTrfs[boneIdx] = (bone.getParent()) ? modelTrfs[bone.getParent()->getIndex()] * localTrf : localTrf;
+		const Mat4& modelTrf = modelTrfs[boneIdx];
 
-	for(const Bone* child : bone.getChildren())
-	{
-		visitBones(*child, outMat, bonesAnimated, minExtend, maxExtend);
+		outTrfs[boneIdx] = modelTrf * bone.getVertexTransform();
+
+		// Update volume
+		const Vec4 bonePos = modelTrf.getTranslationPart().xyz0();
+		minExtend = minExtend.min(bonePos);
+		maxExtend = maxExtend.max(bonePos);
 	}
+
+	const Vec4 E(EPSILON, EPSILON, EPSILON, 0.0f);
+	m_boneBoundingVolume.setMin(minExtend - E);
+	m_boneBoundingVolume.setMax(maxExtend + E);
 }
 
 } // end namespace anki
@@ -10,6 +10,7 @@
 #include <anki/collision/Aabb.h>
 #include <anki/util/Forward.h>
 #include <anki/util/WeakArray.h>
+#include <anki/util/List.h>
 #include <anki/Math.h>
 
 namespace anki
@@ -35,9 +36,12 @@ public:
 	Second m_blendOutTime = 0.0f;
 };
 
-/// Skin component.
-class SkinComponent : public SceneComponent
+/// Skin component. The poses of all the skin components of the scene are evaluated in parallel by the SceneGraph
+/// before the scene nodes get updated.
+class SkinComponent : public SceneComponent, public IntrusiveListEnabled<SkinComponent>
 {
+	friend class SceneGraph;
+
 public:
 	static constexpr SceneComponentType CLASS_TYPE = SceneComponentType::SKIN;
 	static constexpr U32 MAX_ANIMATION_TRACKS = 4;
@@ -80,6 +84,7 @@ private:
 		Second m_blendInTime = 0.0;
 		Second m_blendOutTime = 0.0f;
 		F32 m_repeatTimes = 1.0f;
+		DynamicArray<U32> m_channelBones; ///< The bone index of each animation channel. MAX_U32 if there is none.
 	};
 
 	class Trf
@@ -99,9 +104,12 @@ private:
 	Second m_absoluteTime = 0.0;
 	U8 m_crntBoneTrfs = 0;
 	U8 m_prevBoneTrfs = 1;
+	Bool m_poseUpdated = false;
+
+	/// Sample and blend the tracks and compute the bone transforms. It's thread-safe against other skins.
+	void evaluatePose(Second prevTime, Second crntTime);
 
-	void visitBones(const Bone& bone, const Mat4& parentTrf, const BitSet<128, U8>& bonesAnimated, Vec4& minExtend,
-					Vec4& maxExtend);
+	void computeBoneTransforms(const BitSet<128, U8>& bonesAnimated);
 };
 /// @}
 
@@ -8,6 +8,8 @@
 #include <anki/util/Logger.h>
 #include <anki/util/String.h>
 #include <anki/util/BitSet.h>
+#include <anki/util/WeakArray.h>
+#include <anki/gr/Enums.h>
 
 namespace anki
 {
@@ -35,7 +37,7 @@ public:
 class ShaderProgramPostParseInterface
 {
 public:
-	virtual Bool skipCompilation(U64 programHash) = 0;
+	virtual Bool skipCompilation(U64 programHash, ShaderTypeBit shaderTypes) = 0;
 };
 
 /// An interface for asynchronous shader compilation.
@@ -46,6 +48,20 @@ public:
 
 	virtual ANKI_USE_RESULT Error joinTasks() = 0;
 };
+
+/// A content-addressed cache of SPIR-V. The key is the hash of the preprocessed source of a single shader stage. It
+/// allows the compiler to skip the GLSL compilation of variants that haven't changed since the last time.
+class ShaderProgramSpirvCacheInterface
+{
+public:
+	/// Find the SPIR-V of some source. Return false if it's not in the cache.
+	/// @note It's called from multiple threads.
+	virtual Bool find(U64 sourceHash, DynamicArrayAuto<U8>& spirv) = 0;
+
+	/// Store the SPIR-V of some source.
+	/// @note It's called from multiple threads.
+	virtual void store(U64 sourceHash, ConstWeakArray<U8> spirv) = 0;
+};
 /// @}
 
 } // end namespace anki
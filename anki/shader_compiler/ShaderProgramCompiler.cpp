@@ -168,152 +168,282 @@ static Bool spinDials(DynamicArrayAuto<U32>& dials, ConstWeakArray<ShaderProgram
 	return done;
 }
 
-static Error compileSpirv(ConstWeakArray<MutatorValue> mutation, const ShaderProgramParser& parser,
-						  GenericMemoryPoolAllocator<U8>& tmpAlloc,
-						  Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)>& spirv)
+/// Compiles the variants of a program. It preprocesses the source of every stage of every variant and it compiles each
+/// unique preprocessed source only once. Mutations that differ only in mutators that a stage doesn't care about share
+/// the same SPIR-V.
+class VariantCompiler : public NonCopyable
 {
-	// Generate the source and the rest for the variant
-	ShaderProgramParserVariant parserVariant;
-	ANKI_CHECK(parser.generateVariant(mutation, parserVariant));
+public:
+	VariantCompiler(const ShaderProgramParser& parser, ShaderProgramAsyncTaskInterface& taskManager,
+					ShaderProgramSpirvCacheInterface* spirvCache, GenericMemoryPoolAllocator<U8> tmpAlloc)
+		: m_parser(parser)
+		, m_taskManager(taskManager)
+		, m_spirvCache(spirvCache)
+		, m_tmpAlloc(tmpAlloc)
+		, m_variantJobs(tmpAlloc)
+		, m_stageJobs(tmpAlloc)
+	{
+	}
 
-	// Compile stages
-	for(ShaderType shaderType : EnumIterable<ShaderType>())
+	~VariantCompiler()
 	{
-		if(!(ShaderTypeBit(1 << shaderType) & parser.getShaderTypes()))
+		for(VariantJob* job : m_variantJobs)
 		{
-			continue;
+			m_tmpAlloc.deleteInstance(job);
 		}
 
-		// Compile
-		ANKI_CHECK(compilerGlslToSpirv(parserVariant.getSource(shaderType), shaderType, tmpAlloc, spirv[shaderType]));
-		ANKI_ASSERT(spirv[shaderType].getSize() > 0);
+		for(StageJob* job : m_stageJobs)
+		{
+			m_tmpAlloc.deleteInstance(job);
+		}
 	}
 
-	return Error::NONE;
-}
+	/// Schedule the preprocessing of a variant.
+	void preprocessVariantAsync(ConstWeakArray<MutatorValue> mutation, ShaderProgramBinaryVariant& variant);
 
-static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation, const ShaderProgramParser& parser,
-								ShaderProgramBinaryVariant& variant,
-								DynamicArrayAuto<ShaderProgramBinaryCodeBlock>& codeBlocks,
-								DynamicArrayAuto<U64>& codeBlockHashes, GenericMemoryPoolAllocator<U8>& tmpAlloc,
-								GenericMemoryPoolAllocator<U8>& binaryAlloc,
-								ShaderProgramAsyncTaskInterface& taskManager, Mutex& mtx, Atomic<I32>& error)
-{
-	variant = {};
+	/// Wait for the preprocessing, compile the unique sources and create the code blocks.
+	ANKI_USE_RESULT Error compile(GenericMemoryPoolAllocator<U8> binaryAlloc,
+								  DynamicArrayAuto<ShaderProgramBinaryCodeBlock>& codeBlocks);
+
+	void logStats(CString fname) const
+	{
+		const U32 uniqueCount = m_stageJobs.getSize();
+		ANKI_SHADER_COMPILER_LOGI("%s: %u variants, %u shaders, %u compiled, %u deduplicated, %u found in the cache",
+								  fname.cstr(), m_variantJobs.getSize(), uniqueCount + m_dedupCount,
+								  uniqueCount - m_cacheHitCount.getNonAtomically(), m_dedupCount,
+								  m_cacheHitCount.getNonAtomically());
+	}
 
-	class Ctx
+private:
+	class VariantJob
 	{
 	public:
-		GenericMemoryPoolAllocator<U8> m_tmpAlloc;
-		GenericMemoryPoolAllocator<U8> m_binaryAlloc;
-		DynamicArrayAuto<MutatorValue> m_mutation = {m_tmpAlloc};
-		const ShaderProgramParser* m_parser;
-		ShaderProgramBinaryVariant* m_variant;
-		DynamicArrayAuto<ShaderProgramBinaryCodeBlock>* m_codeBlocks;
-		DynamicArrayAuto<U64>* m_codeBlockHashes;
-		Mutex* m_mtx;
-		Atomic<I32>* m_err;
-
-		Ctx(GenericMemoryPoolAllocator<U8> tmpAlloc)
-			: m_tmpAlloc(tmpAlloc)
+		VariantCompiler* m_compiler = nullptr;
+		DynamicArrayAuto<MutatorValue> m_mutation;
+		ShaderProgramBinaryVariant* m_variant = nullptr;
+		Array<U64, U32(ShaderType::COUNT)> m_sourceHashes = {};
+
+		VariantJob(GenericMemoryPoolAllocator<U8> alloc)
+			: m_mutation(alloc)
 		{
 		}
 	};
 
-	Ctx* ctx = tmpAlloc.newInstance<Ctx>(tmpAlloc);
-	ctx->m_binaryAlloc = binaryAlloc;
-	ctx->m_mutation.create(mutation.getSize());
-	memcpy(ctx->m_mutation.getBegin(), mutation.getBegin(), mutation.getSizeInBytes());
-	ctx->m_parser = &parser;
-	ctx->m_variant = &variant;
-	ctx->m_codeBlocks = &codeBlocks;
-	ctx->m_codeBlockHashes = &codeBlockHashes;
-	ctx->m_mtx = &mtx;
-	ctx->m_err = &error;
-
-	auto callback = [](void* userData) {
-		Ctx& ctx = *static_cast<Ctx*>(userData);
-		GenericMemoryPoolAllocator<U8>& tmpAlloc = ctx.m_tmpAlloc;
-
-		if(ctx.m_err->load() != 0)
+	class StageJob
+	{
+	public:
+		VariantCompiler* m_compiler = nullptr;
+		const VariantJob* m_variantJob = nullptr;
+		ShaderType m_shaderType = ShaderType::COUNT;
+		DynamicArrayAuto<U8> m_spirv;
+
+		StageJob(GenericMemoryPoolAllocator<U8> alloc)
+			: m_spirv(alloc)
 		{
-			// Cleanup and return
-			tmpAlloc.deleteInstance(&ctx);
-			return;
 		}
+	};
+
+	const ShaderProgramParser& m_parser;
+	ShaderProgramAsyncTaskInterface& m_taskManager;
+	ShaderProgramSpirvCacheInterface* m_spirvCache;
+	GenericMemoryPoolAllocator<U8> m_tmpAlloc;
+
+	DynamicArrayAuto<VariantJob*> m_variantJobs;
+	DynamicArrayAuto<StageJob*> m_stageJobs;
+
+	Atomic<I32> m_err = {0};
+	Atomic<U32> m_cacheHitCount = {0};
+	U32 m_dedupCount = 0;
+
+	static void preprocessVariantCallback(void* userData);
+	static void compileStageCallback(void* userData);
+};
+
+void VariantCompiler::preprocessVariantAsync(ConstWeakArray<MutatorValue> mutation,
+											 ShaderProgramBinaryVariant& variant)
+{
+	variant = {};
+
+	VariantJob* job = m_tmpAlloc.newInstance<VariantJob>(m_tmpAlloc);
+	job->m_compiler = this;
+	if(mutation.getSize())
+	{
+		job->m_mutation.create(mutation.getSize());
+		memcpy(job->m_mutation.getBegin(), mutation.getBegin(), mutation.getSizeInBytes());
+	}
+	job->m_variant = &variant;
+	m_variantJobs.emplaceBack(job);
+
+	m_taskManager.enqueueTask(preprocessVariantCallback, job);
+}
 
-		// All good, compile the variant
-		Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)> spirvs = {{{tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc},
-																	   {tmpAlloc}}};
-		const Error err = compileSpirv(ctx.m_mutation, *ctx.m_parser, tmpAlloc, spirvs);
-
-		if(!err)
+void VariantCompiler::preprocessVariantCallback(void* userData)
+{
+	VariantJob& job = *static_cast<VariantJob*>(userData);
+	VariantCompiler& self = *job.m_compiler;
+
+	if(self.m_err.load() != 0)
+	{
+		return;
+	}
+
+	ShaderProgramParserVariant parserVariant;
+	const Error err = self.m_parser.generateVariant(job.m_mutation, parserVariant);
+	if(err)
+	{
+		self.m_err.store(err._getCode());
+		return;
+	}
+
+	for(ShaderType shaderType : EnumIterable<ShaderType>())
+	{
+		if(!(ShaderTypeBit(1 << shaderType) & self.m_parser.getShaderTypes()))
 		{
-			// No error, check if the spirvs are common with some other variant and store it
+			continue;
+		}
 
-			LockGuard<Mutex> lock(*ctx.m_mtx);
+		// Run the preprocessor to get rid of the mutators that this stage doesn't care about. If it fails use the
+		// unprocessed source, the compilation will report the error
+		const CString source = parserVariant.getSource(shaderType);
+		StringAuto preprocessed(self.m_tmpAlloc);
+		U64 hash;
+		if(!preprocessGlsl(source, preprocessed) && preprocessed.getLength() > 0)
+		{
+			hash = computeHash(preprocessed.cstr(), preprocessed.getLength());
+		}
+		else
+		{
+			hash = computeHash(source.cstr(), source.getLength());
+		}
 
-			for(ShaderType shaderType : EnumIterable<ShaderType>())
-			{
-				DynamicArrayAuto<U8>& spirv = spirvs[shaderType];
+		job.m_sourceHashes[shaderType] = appendHash(&shaderType, sizeof(shaderType), hash);
+	}
+}
 
-				if(spirv.isEmpty())
-				{
-					ctx.m_variant->m_codeBlockIndices[shaderType] = MAX_U32;
-					continue;
-				}
+void VariantCompiler::compileStageCallback(void* userData)
+{
+	StageJob& job = *static_cast<StageJob*>(userData);
+	VariantCompiler& self = *job.m_compiler;
+	const U64 sourceHash = job.m_variantJob->m_sourceHashes[job.m_shaderType];
 
-				// Check if the spirv is already generated
-				const U64 newHash = computeHash(&spirv[0], spirv.getSize());
-				Bool found = false;
-				for(U32 i = 0; i < ctx.m_codeBlockHashes->getSize(); ++i)
-				{
-					if((*ctx.m_codeBlockHashes)[i] == newHash)
-					{
-						// Found it
-						ctx.m_variant->m_codeBlockIndices[shaderType] = i;
-						found = true;
-						break;
-					}
-				}
+	if(self.m_err.load() != 0)
+	{
+		return;
+	}
 
-				// Create it if not found
-				if(!found)
-				{
-					U8* code = ctx.m_binaryAlloc.allocate(spirv.getSizeInBytes());
-					memcpy(code, &spirv[0], spirv.getSizeInBytes());
+	// Check the cache first
+	if(self.m_spirvCache && self.m_spirvCache->find(sourceHash, job.m_spirv))
+	{
+		ANKI_ASSERT(job.m_spirv.getSize() > 0);
+		self.m_cacheHitCount.fetchAdd(1);
+		return;
+	}
 
-					ShaderProgramBinaryCodeBlock block;
-					block.m_binary.setArray(code, U32(spirv.getSizeInBytes()));
-					block.m_hash = newHash;
+	// Regenerate the source. It's cheaper than keeping the sources of all variants around
+	ShaderProgramParserVariant parserVariant;
+	Error err = self.m_parser.generateVariant(job.m_variantJob->m_mutation, parserVariant);
+	if(!err)
+	{
+		err = compilerGlslToSpirv(parserVariant.getSource(job.m_shaderType), job.m_shaderType, self.m_tmpAlloc,
+								  job.m_spirv);
+	}
 
-					ctx.m_codeBlocks->emplaceBack(block);
-					ctx.m_codeBlockHashes->emplaceBack(newHash);
+	if(err)
+	{
+		self.m_err.store(err._getCode());
+		return;
+	}
 
-					ctx.m_variant->m_codeBlockIndices[shaderType] = ctx.m_codeBlocks->getSize() - 1;
-				}
+	ANKI_ASSERT(job.m_spirv.getSize() > 0);
+	if(self.m_spirvCache)
+	{
+		self.m_spirvCache->store(sourceHash, job.m_spirv);
+	}
+}
+
+Error VariantCompiler::compile(GenericMemoryPoolAllocator<U8> binaryAlloc,
+							   DynamicArrayAuto<ShaderProgramBinaryCodeBlock>& codeBlocks)
+{
+	// Wait for the preprocessing
+	ANKI_CHECK(m_taskManager.joinTasks());
+	ANKI_CHECK(Error(m_err.getNonAtomically()));
+
+	// Compile the unique sources. The code block indices of the variants will temporarily point to the stage jobs
+	HashMapAuto<U64, U32> sourceHashToStageJob(m_tmpAlloc);
+	for(const VariantJob* variantJob : m_variantJobs)
+	{
+		for(ShaderType shaderType : EnumIterable<ShaderType>())
+		{
+			if(!(ShaderTypeBit(1 << shaderType) & m_parser.getShaderTypes()))
+			{
+				variantJob->m_variant->m_codeBlockIndices[shaderType] = MAX_U32;
+				continue;
+			}
+
+			const U64 sourceHash = variantJob->m_sourceHashes[shaderType];
+			auto it = sourceHashToStageJob.find(sourceHash);
+			if(it != sourceHashToStageJob.getEnd())
+			{
+				variantJob->m_variant->m_codeBlockIndices[shaderType] = *it;
+				++m_dedupCount;
+				continue;
 			}
+
+			StageJob* stageJob = m_tmpAlloc.newInstance<StageJob>(m_tmpAlloc);
+			stageJob->m_compiler = this;
+			stageJob->m_variantJob = variantJob;
+			stageJob->m_shaderType = shaderType;
+			m_stageJobs.emplaceBack(stageJob);
+
+			sourceHashToStageJob.emplace(sourceHash, m_stageJobs.getSize() - 1);
+			variantJob->m_variant->m_codeBlockIndices[shaderType] = m_stageJobs.getSize() - 1;
+
+			m_taskManager.enqueueTask(compileStageCallback, stageJob);
 		}
-		else
+	}
+
+	ANKI_CHECK(m_taskManager.joinTasks());
+	ANKI_CHECK(Error(m_err.getNonAtomically()));
+
+	// Create the code blocks. Different sources may still produce the same SPIR-V so dedup that as well
+	DynamicArrayAuto<U32> stageJobToCodeBlock(m_tmpAlloc, m_stageJobs.getSize());
+	HashMapAuto<U64, U32> spirvHashToCodeBlock(m_tmpAlloc);
+	for(U32 i = 0; i < m_stageJobs.getSize(); ++i)
+	{
+		const DynamicArrayAuto<U8>& spirv = m_stageJobs[i]->m_spirv;
+		const U64 spirvHash = computeHash(&spirv[0], spirv.getSizeInBytes());
+
+		auto it = spirvHashToCodeBlock.find(spirvHash);
+		if(it != spirvHashToCodeBlock.getEnd())
 		{
-			ctx.m_err->store(err._getCode());
+			stageJobToCodeBlock[i] = *it;
+			continue;
 		}
 
-		// Cleanup
-		tmpAlloc.deleteInstance(&ctx);
-	};
+		U8* code = binaryAlloc.allocate(spirv.getSizeInBytes());
+		memcpy(code, &spirv[0], spirv.getSizeInBytes());
+
+		ShaderProgramBinaryCodeBlock block;
+		block.m_binary.setArray(code, U32(spirv.getSizeInBytes()));
+		block.m_hash = spirvHash;
+		codeBlocks.emplaceBack(block);
+
+		stageJobToCodeBlock[i] = codeBlocks.getSize() - 1;
+		spirvHashToCodeBlock.emplace(spirvHash, codeBlocks.getSize() - 1);
+	}
+
+	for(const VariantJob* variantJob : m_variantJobs)
+	{
+		for(U32& idx : variantJob->m_variant->m_codeBlockIndices)
+		{
+			if(idx != MAX_U32)
+			{
+				idx = stageJobToCodeBlock[idx];
+			}
+		}
+	}
 
-	taskManager.enqueueTask(callback, ctx);
+	return Error::NONE;
 }
 
 class Refl final : public ShaderReflectionVisitorInterface
@@ -767,6 +897,7 @@ static Error doReflection(ShaderProgramBinary& binary, GenericMemoryPoolAllocato
 Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterface& fsystem,
 								   ShaderProgramPostParseInterface* postParseCallback,
 								   ShaderProgramAsyncTaskInterface* taskManager_,
+								   ShaderProgramSpirvCacheInterface* spirvCache,
 								   GenericMemoryPoolAllocator<U8> tempAllocator,
 								   const GpuDeviceCapabilities& gpuCapabilities, const BindlessLimits& bindlessLimits,
 								   ShaderProgramBinaryWrapper& binaryW)
@@ -784,7 +915,7 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 	ShaderProgramParser parser(fname, &fsystem, tempAllocator, gpuCapabilities, bindlessLimits);
 	ANKI_CHECK(parser.parse());
 
-	if(postParseCallback && postParseCallback->skipCompilation(parser.getHash()))
+	if(postParseCallback && postParseCallback->skipCompilation(parser.getHash(), parser.getShaderTypes()))
 	{
 		return Error::NONE;
 	}
@@ -817,8 +948,6 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 	}
 
 	// Create all variants
-	Mutex mtx;
-	Atomic<I32> errorAtomic(0);
 	class SyncronousShaderProgramAsyncTaskInterface : public ShaderProgramAsyncTaskInterface
 	{
 	public:
@@ -834,6 +963,7 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 		}
 	} syncTaskManager;
 	ShaderProgramAsyncTaskInterface& taskManager = (taskManager_) ? *taskManager_ : syncTaskManager;
+	VariantCompiler variantCompiler(parser, taskManager, spirvCache, tempAllocator);
 
 	if(parser.getMutators().getSize() > 0)
 	{
@@ -844,7 +974,6 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 		DynamicArrayAuto<ShaderProgramBinaryVariant> variants(binaryAllocator);
 		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
 		DynamicArrayAuto<ShaderProgramBinaryMutation> mutations(binaryAllocator, mutationCount);
-		DynamicArrayAuto<U64> codeBlockHashes(tempAllocator);
 		HashMapAuto<U64, U32> mutationHashToIdx(tempAllocator);
 
 		// Grow the storage of the variants array. Can't have it resize, threads will work on stale data
@@ -854,7 +983,7 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 		mutationCount = 0;
 
 		// Spin for all possible combinations of mutators and
-		// - Create the spirv
+		// - Preprocess the variant
 		// - Populate the binary variant
 		do
 		{
@@ -885,8 +1014,7 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 				ShaderProgramBinaryVariant& variant = *variants.emplaceBack();
 				baseVariant = (baseVariant == nullptr) ? variants.getBegin() : baseVariant;
 
-				compileVariantAsync(originalMutationValues, parser, variant, codeBlocks, codeBlockHashes, tempAllocator,
-									binaryAllocator, taskManager, mtx, errorAtomic);
+				variantCompiler.preprocessVariantAsync(originalMutationValues, variant);
 
 				mutation.m_variantIndex = variants.getSize() - 1;
 
@@ -908,8 +1036,7 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 					variant = variants.emplaceBack();
 					baseVariant = (baseVariant == nullptr) ? variants.getBegin() : baseVariant;
 
-					compileVariantAsync(originalMutationValues, parser, *variant, codeBlocks, codeBlockHashes,
-										tempAllocator, binaryAllocator, taskManager, mtx, errorAtomic);
+					variantCompiler.preprocessVariantAsync(originalMutationValues, *variant);
 
 					ShaderProgramBinaryMutation& otherMutation = mutations[mutationCount++];
 					otherMutation.m_values.setArray(
@@ -934,9 +1061,8 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 		ANKI_ASSERT(mutationCount == mutations.getSize());
 		ANKI_ASSERT(baseVariant == variants.getBegin() && "Can't have the variants array grow");
 
-		// Done, wait the threads
-		ANKI_CHECK(taskManager.joinTasks());
-		ANKI_CHECK(Error(errorAtomic.getNonAtomically()));
+		// Done, compile the unique sources
+		ANKI_CHECK(variantCompiler.compile(binaryAllocator, codeBlocks));
 
 		// Store temp containers to binary
 		U32 size, storage;
@@ -956,15 +1082,11 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 	{
 		DynamicArrayAuto<MutatorValue> mutation(tempAllocator);
 		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
-		DynamicArrayAuto<U64> codeBlockHashes(tempAllocator);
 
 		binary.m_variants.setArray(binaryAllocator.newInstance<ShaderProgramBinaryVariant>(), 1);
 
-		compileVariantAsync(mutation, parser, binary.m_variants[0], codeBlocks, codeBlockHashes, tempAllocator,
-							binaryAllocator, taskManager, mtx, errorAtomic);
-
-		ANKI_CHECK(taskManager.joinTasks());
-		ANKI_CHECK(Error(errorAtomic.getNonAtomically()));
+		variantCompiler.preprocessVariantAsync(mutation, binary.m_variants[0]);
+		ANKI_CHECK(variantCompiler.compile(binaryAllocator, codeBlocks));
 
 		ANKI_ASSERT(codeBlocks.getSize() == U32(__builtin_popcount(U32(parser.getShaderTypes()))));
 
@@ -978,6 +1100,8 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 		binary.m_mutations[0].m_variantIndex = 0;
 	}
 
+	variantCompiler.logStats(fname);
+
 	// Sort the mutations
 	std::sort(
 		binary.m_mutations.getBegin(), binary.m_mutations.getEnd(),
@@ -1008,12 +1132,12 @@ Error compileShaderProgramInternal(CString fname, ShaderProgramFilesystemInterfa
 
 Error compileShaderProgram(CString fname, ShaderProgramFilesystemInterface& fsystem,
 						   ShaderProgramPostParseInterface* postParseCallback,
-						   ShaderProgramAsyncTaskInterface* taskManager, GenericMemoryPoolAllocator<U8> tempAllocator,
-						   const GpuDeviceCapabilities& gpuCapabilities, const BindlessLimits& bindlessLimits,
-						   ShaderProgramBinaryWrapper& binaryW)
+						   ShaderProgramAsyncTaskInterface* taskManager, ShaderProgramSpirvCacheInterface* spirvCache,
+						   GenericMemoryPoolAllocator<U8> tempAllocator, const GpuDeviceCapabilities& gpuCapabilities,
+						   const BindlessLimits& bindlessLimits, ShaderProgramBinaryWrapper& binaryW)
 {
-	const Error err = compileShaderProgramInternal(fname, fsystem, postParseCallback, taskManager, tempAllocator,
-												   gpuCapabilities, bindlessLimits, binaryW);
+	const Error err = compileShaderProgramInternal(fname, fsystem, postParseCallback, taskManager, spirvCache,
+												   tempAllocator, gpuCapabilities, bindlessLimits, binaryW);
 	if(err)
 	{
 		ANKI_SHADER_COMPILER_LOGE("Failed to compile: %s", fname.cstr());
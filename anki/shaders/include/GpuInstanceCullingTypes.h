@@ -0,0 +1,37 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/shaders/include/Common.h>
+
+ANKI_BEGIN_NAMESPACE
+
+// Per instance data of the GPU instance culling
+struct GpuCullingInstance
+{
+	Vec3 m_aabbMin;
+	U32 m_gpuSceneSlot;
+	Vec3 m_aabbMax;
+	U32 m_padding0;
+};
+
+// A range of instances that will be drawn with a single instanced draw
+struct GpuCullingBucket
+{
+	U32 m_firstInstance;
+	U32 m_instanceCount;
+};
+
+struct GpuInstanceCullingUniforms
+{
+	Mat4 m_viewProjMat;
+	Mat4 m_prevViewProjMat; // The Hi-Z is from the previous frame
+	UVec2 m_hizSize;
+	U32 m_hizMipCount;
+	U32 m_occlusionCulling; // Zero if the Hi-Z of the previous frame can't be trusted
+};
+
+ANKI_END_NAMESPACE
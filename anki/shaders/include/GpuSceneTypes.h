@@ -0,0 +1,29 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/shaders/include/Common.h>
+
+ANKI_BEGIN_NAMESPACE
+
+// The persistent data of a renderable that live in the GPU scene buffer
+struct GpuSceneInstance
+{
+	Mat4 m_worldTransform;
+	Mat4 m_previousWorldTransform;
+};
+
+// Writes a GpuSceneInstance to a slot of the GPU scene buffer
+struct GpuSceneUpdate
+{
+	GpuSceneInstance m_instance;
+	U32 m_slot;
+	U32 m_padding0;
+	U32 m_padding1;
+	U32 m_padding2;
+};
+
+ANKI_END_NAMESPACE
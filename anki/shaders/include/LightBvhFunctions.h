@@ -0,0 +1,82 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/shaders/include/LightBvhTypes.h>
+
+ANKI_BEGIN_NAMESPACE
+
+// The importance of the lights of a node at some point. Used to walk the tree and pick lights with probability
+// proportional to it
+ANKI_SHADER_FUNC_INLINE F32 computeLightBvhNodeImportance(LightBvhNode node, Vec3 pos)
+{
+	// The AABB encloses the volumes of the lights so none of them reaches points outside of it
+	if(pos.x() < node.m_aabbMin.x() || pos.y() < node.m_aabbMin.y() || pos.z() < node.m_aabbMin.z()
+	   || pos.x() > node.m_aabbMax.x() || pos.y() > node.m_aabbMax.y() || pos.z() > node.m_aabbMax.z())
+	{
+		return 0.0f;
+	}
+
+	// Power over the squared distance. Clamp the distance to the size of the node so it doesn't explode near the
+	// lights and inside big nodes
+	const Vec3 halfSize = (node.m_aabbMax - node.m_aabbMin) * 0.5f;
+	const Vec3 toCenter = pos - (node.m_aabbMin + halfSize);
+	const F32 distSquared = max(dot(toCenter, toCenter), dot(halfSize, halfSize));
+	return node.m_power / max(distSquared, 0.0001f);
+}
+
+// Pick a child of a node to continue walking the light BVH. The probability of a child is proportional to its
+// importance. Returns 0 for the left child, 1 for the right and MAX_U32 if none of them reaches the point. A point can
+// be inside a node and outside both children (a point between 2 lights). The random number in [0.0, 1.0) is remapped
+// to [0.0, 1.0) so it can be used for the next level
+ANKI_SHADER_FUNC_INLINE U32 chooseLightBvhChild(F32 leftImportance, F32 rightImportance,
+												ANKI_SHADER_INOUT(F32) random01)
+{
+	const F32 importanceSum = leftImportance + rightImportance;
+	if(importanceSum <= 0.0f)
+	{
+		return MAX_U32;
+	}
+
+	const F32 leftProbability = leftImportance / importanceSum;
+	U32 child;
+	if(random01 < leftProbability)
+	{
+		child = 0u;
+		random01 = random01 / leftProbability;
+	}
+	else
+	{
+		child = 1u;
+		random01 = (random01 - leftProbability) / (1.0f - leftProbability);
+	}
+
+	random01 = min(random01, 0.9999f);
+	return child;
+}
+
+// The lights of a shadow layer are traced every frame when the layer has no usable history. Either because the history
+// of the layer was rejected or because the pixel was disoccluded (the blend factor reached 1.0)
+ANKI_SHADER_FUNC_INLINE Bool shadowLayerNeedsTrace(U32 shadowLayer, U32 rejectedLayerMask, F32 blendFactor)
+{
+	return blendFactor >= 1.0f || (rejectedLayerMask & (1u << shadowLayer)) != 0u;
+}
+
+// The weight of the shadow factor of this frame when blending it with the history. The layers that were not traced keep
+// their history if it's usable. If it's not all the lights of the layer that reach the point were traced (see
+// shadowLayerNeedsTrace()) so take the current value
+ANKI_SHADER_FUNC_INLINE F32 computeShadowLayerBlendFactor(U32 shadowLayer, U32 rejectedLayerMask, U32 tracedLayerMask,
+														  F32 blendFactor)
+{
+	if(shadowLayerNeedsTrace(shadowLayer, rejectedLayerMask, blendFactor))
+	{
+		return 1.0f;
+	}
+
+	return ((tracedLayerMask & (1u << shadowLayer)) != 0u) ? blendFactor : 0.0f;
+}
+
+ANKI_END_NAMESPACE
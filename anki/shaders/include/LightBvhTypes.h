@@ -0,0 +1,40 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/shaders/include/Common.h>
+
+ANKI_BEGIN_NAMESPACE
+
+// A node of the light BVH. The tree is a complete binary tree stored in an array. The children of node i are 2i+1 and
+// 2i+2 and the last half of the nodes (plus one) are the leaves. Every leaf has one light or none
+struct LightBvhNode
+{
+	Vec3 m_aabbMin; // Encloses the volumes of the lights of the node
+	F32 m_power; // The sum of the power of the lights of the node. Zero if it has no lights
+	Vec3 m_aabbMax;
+	U32 m_padding0;
+};
+const U32 _ANKI_SIZEOF_LightBvhNode = 2u * ANKI_SIZEOF(Vec4);
+ANKI_SHADER_STATIC_ASSERT(sizeof(LightBvhNode) == _ANKI_SIZEOF_LightBvhNode);
+
+// A light of the light BVH. The lights are in the same order as the leaves
+struct LightBvhLight
+{
+	Vec3 m_position;
+	F32 m_radius;
+	F32 m_power;
+	U32 m_shadowLayer; // MAX_U32 if it doesn't have one
+	U32 m_padding0;
+	U32 m_padding1;
+};
+const U32 _ANKI_SIZEOF_LightBvhLight = 2u * ANKI_SIZEOF(Vec4);
+ANKI_SHADER_STATIC_ASSERT(sizeof(LightBvhLight) == _ANKI_SIZEOF_LightBvhLight);
+
+// The lights that the RT shadows trace per pixel when they sample the light BVH
+const U32 RT_SHADOWS_LIGHT_SAMPLE_COUNT = 2u;
+
+ANKI_END_NAMESPACE
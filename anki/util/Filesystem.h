@@ -43,6 +43,11 @@ ANKI_USE_RESULT Error removeDirectory(const CString& dir, GenericMemoryPoolAlloc
 /// Equivalent to: mkdir dir
 ANKI_USE_RESULT Error createDirectory(const CString& dir);
 
+/// Equivalent to: mv oldName newName
+/// If @a newName exists it's replaced. On the same filesystem the rename is atomic so readers of @a newName will either
+/// see the old file or the new one but never a partially written file.
+ANKI_USE_RESULT Error renameFile(const CString& oldName, const CString& newName);
+
 /// Get the home directory.
 /// Write the home directory to @a buff. The @a buffSize is the size of the @a buff. If the @buffSize is not enough the
 /// function will throw an exception.
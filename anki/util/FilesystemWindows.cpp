@@ -66,6 +66,18 @@ Error createDirectory(const CString& dir)
 	return err;
 }
 
+Error renameFile(const CString& oldName, const CString& newName)
+{
+	Error err = Error::NONE;
+	if(MoveFileExA(oldName.cstr(), newName.cstr(), MOVEFILE_REPLACE_EXISTING) == 0)
+	{
+		ANKI_UTIL_LOGE("Failed to rename file %s to %s", oldName.cstr(), newName.cstr());
+		err = Error::FUNCTION_FAILED;
+	}
+
+	return err;
+}
+
 Error getHomeDirectory(StringAuto& out)
 {
 	char path[MAX_PATH];
@@ -0,0 +1,240 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/RadixSort.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/Array.h>
+
+namespace anki
+{
+
+static const U32 RADIX_BITS = 8;
+static const U32 RADIX_SIZE = 1u << RADIX_BITS;
+static const U32 DIGIT_COUNT = 64 / RADIX_BITS;
+
+/// Don't split the pairs to chunks smaller than that. The tasks would cost more than the sorting.
+static const U32 MIN_PAIRS_PER_CHUNK = 4 * 1024;
+
+static U32 getDigit(U64 key, U32 digit)
+{
+	return U32(key >> U64(digit * RADIX_BITS)) & (RADIX_SIZE - 1);
+}
+
+/// Find the bytes that are not the same on all keys. The passes of the rest can be skipped.
+static U32 computeVaryingDigitMask(ConstWeakArray<RadixSortPair> pairs)
+{
+	const U64 firstKey = pairs[0].m_key;
+	U64 diff = 0;
+	for(const RadixSortPair& pair : pairs)
+	{
+		diff |= pair.m_key ^ firstKey;
+	}
+
+	U32 mask = 0;
+	for(U32 digit = 0; digit < DIGIT_COUNT; ++digit)
+	{
+		if(getDigit(diff, digit))
+		{
+			mask |= 1u << digit;
+		}
+	}
+
+	return mask;
+}
+
+WeakArray<RadixSortPair> radixSort(WeakArray<RadixSortPair> pairs, WeakArray<RadixSortPair> scratch)
+{
+	ANKI_ASSERT(pairs.getSize() == scratch.getSize());
+	if(pairs.getSize() <= 1)
+	{
+		return pairs;
+	}
+
+	const U32 mask = computeVaryingDigitMask(pairs);
+	if(mask == 0)
+	{
+		return pairs;
+	}
+
+	// The counts don't depend on the order of the pairs so count all the bytes in one go
+	Array2d<U32, DIGIT_COUNT, RADIX_SIZE> offsets;
+	memset(&offsets[0][0], 0, sizeof(offsets));
+	for(const RadixSortPair& pair : pairs)
+	{
+		for(U32 digit = 0; digit < DIGIT_COUNT; ++digit)
+		{
+			++offsets[digit][getDigit(pair.m_key, digit)];
+		}
+	}
+
+	WeakArray<RadixSortPair> src = pairs;
+	WeakArray<RadixSortPair> dst = scratch;
+	for(U32 digit = 0; digit < DIGIT_COUNT; ++digit)
+	{
+		if(!(mask & (1u << digit)))
+		{
+			continue;
+		}
+
+		// Exclusive prefix sum
+		U32 offset = 0;
+		for(U32& count : offsets[digit])
+		{
+			const U32 c = count;
+			count = offset;
+			offset += c;
+		}
+
+		for(const RadixSortPair& pair : src)
+		{
+			dst[offsets[digit][getDigit(pair.m_key, digit)]++] = pair;
+		}
+
+		std::swap(src, dst);
+	}
+
+	return src;
+}
+
+/// The data that all the tasks of a parallel sort share.
+class RadixSortContext
+{
+public:
+	Array<WeakArray<RadixSortPair>, 2> m_buffers;
+	U32* m_counts; ///< RADIX_SIZE counters per chunk.
+	U32 m_chunkCount;
+	U32 m_pairsPerChunk;
+};
+
+/// A task that works on a chunk of pairs for a single pass.
+class RadixSortTask
+{
+public:
+	RadixSortContext* m_ctx;
+	U32 m_chunk;
+	U32 m_digit;
+	U32 m_srcBuffer;
+
+	/// Count the bytes of the chunk.
+	void count()
+	{
+		ConstWeakArray<RadixSortPair> src = getSourceChunk();
+		U32* counts = m_ctx->m_counts + m_chunk * RADIX_SIZE;
+		memset(counts, 0, sizeof(U32) * RADIX_SIZE);
+
+		for(const RadixSortPair& pair : src)
+		{
+			++counts[getDigit(pair.m_key, m_digit)];
+		}
+	}
+
+	/// Scatter the chunk to the other buffer. The pairs of the previous chunks with the same byte go first.
+	void scatter()
+	{
+		Array<U32, RADIX_SIZE> offsets;
+		U32 offset = 0;
+		for(U32 b = 0; b < RADIX_SIZE; ++b)
+		{
+			for(U32 chunk = 0; chunk < m_ctx->m_chunkCount; ++chunk)
+			{
+				if(chunk == m_chunk)
+				{
+					offsets[b] = offset;
+				}
+
+				offset += m_ctx->m_counts[chunk * RADIX_SIZE + b];
+			}
+		}
+
+		WeakArray<RadixSortPair> dst = m_ctx->m_buffers[m_srcBuffer ^ 1u];
+		for(const RadixSortPair& pair : getSourceChunk())
+		{
+			dst[offsets[getDigit(pair.m_key, m_digit)]++] = pair;
+		}
+	}
+
+private:
+	ConstWeakArray<RadixSortPair> getSourceChunk() const
+	{
+		const WeakArray<RadixSortPair>& src = m_ctx->m_buffers[m_srcBuffer];
+		const U32 begin = m_chunk * m_ctx->m_pairsPerChunk;
+		const U32 end = min(begin + m_ctx->m_pairsPerChunk, src.getSize());
+		return ConstWeakArray<RadixSortPair>(&src[begin], end - begin);
+	}
+};
+
+void radixSort(ThreadHive& hive, StackAllocator<U8> alloc, WeakArray<RadixSortPair> pairs,
+			   WeakArray<RadixSortPair> scratch, WeakArray<RadixSortPair>& sorted, ThreadHiveSemaphore*& doneSemaphore)
+{
+	ANKI_ASSERT(pairs.getSize() == scratch.getSize());
+	sorted = pairs;
+	doneSemaphore = nullptr;
+
+	if(pairs.getSize() <= 1)
+	{
+		return;
+	}
+
+	const U32 mask = computeVaryingDigitMask(pairs);
+	if(mask == 0)
+	{
+		return;
+	}
+
+	RadixSortContext* ctx = alloc.newInstance<RadixSortContext>();
+	ctx->m_buffers[0] = pairs;
+	ctx->m_buffers[1] = scratch;
+	ctx->m_chunkCount = min((pairs.getSize() + MIN_PAIRS_PER_CHUNK - 1) / MIN_PAIRS_PER_CHUNK, hive.getThreadCount());
+	ctx->m_chunkCount = max(ctx->m_chunkCount, 1u);
+	ctx->m_pairsPerChunk = (pairs.getSize() + ctx->m_chunkCount - 1) / ctx->m_chunkCount;
+	ctx->m_chunkCount = (pairs.getSize() + ctx->m_pairsPerChunk - 1) / ctx->m_pairsPerChunk;
+	ctx->m_counts = alloc.newArray<U32>(ctx->m_chunkCount * RADIX_SIZE);
+
+	// Submit all the passes. Every pass waits for the previous one
+	U32 srcBuffer = 0;
+	ThreadHiveSemaphore* waitSemaphore = nullptr;
+	for(U32 digit = 0; digit < DIGIT_COUNT; ++digit)
+	{
+		if(!(mask & (1u << digit)))
+		{
+			continue;
+		}
+
+		RadixSortTask* tasks = alloc.newArray<RadixSortTask>(ctx->m_chunkCount);
+		for(U32 chunk = 0; chunk < ctx->m_chunkCount; ++chunk)
+		{
+			tasks[chunk].m_ctx = ctx;
+			tasks[chunk].m_chunk = chunk;
+			tasks[chunk].m_digit = digit;
+			tasks[chunk].m_srcBuffer = srcBuffer;
+		}
+
+		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> hiveTasks;
+
+		ThreadHiveSemaphore* countSemaphore = hive.newSemaphore(ctx->m_chunkCount);
+		for(U32 chunk = 0; chunk < ctx->m_chunkCount; ++chunk)
+		{
+			hiveTasks[chunk] =
+				ANKI_THREAD_HIVE_TASK({ self->count(); }, &tasks[chunk], waitSemaphore, countSemaphore);
+		}
+		hive.submitTasks(&hiveTasks[0], ctx->m_chunkCount);
+
+		ThreadHiveSemaphore* scatterSemaphore = hive.newSemaphore(ctx->m_chunkCount);
+		for(U32 chunk = 0; chunk < ctx->m_chunkCount; ++chunk)
+		{
+			hiveTasks[chunk] =
+				ANKI_THREAD_HIVE_TASK({ self->scatter(); }, &tasks[chunk], countSemaphore, scatterSemaphore);
+		}
+		hive.submitTasks(&hiveTasks[0], ctx->m_chunkCount);
+
+		waitSemaphore = scatterSemaphore;
+		srcBuffer ^= 1u;
+	}
+
+	sorted = ctx->m_buffers[srcBuffer];
+	doneSemaphore = waitSemaphore;
+}
+
+} // end namespace anki
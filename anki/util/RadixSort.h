@@ -0,0 +1,50 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/WeakArray.h>
+#include <anki/util/Allocator.h>
+
+namespace anki
+{
+
+// Forward
+class ThreadHive;
+class ThreadHiveSemaphore;
+
+/// @addtogroup util_other
+/// @{
+
+/// A sort key and the index of the element it was computed from. The elements are sorted indirectly through those.
+class RadixSortPair
+{
+public:
+	U64 m_key;
+	U32 m_index;
+	U32 m_padding;
+};
+
+/// Stable LSD radix sort on the keys. It sorts 8 bits per pass and skips the passes of the bytes that are the same on
+/// all keys.
+/// @param pairs The pairs to sort.
+/// @param scratch Scratch memory with the same size as pairs.
+/// @return The sorted pairs. It's either pairs or scratch.
+WeakArray<RadixSortPair> radixSort(WeakArray<RadixSortPair> pairs, WeakArray<RadixSortPair> scratch);
+
+/// Same as radixSort() but the passes are split into ThreadHive tasks. Every pass has one task per chunk of pairs
+/// that counts the bytes and one that scatters them.
+/// @param hive The hive to submit the tasks to. It can be called by a ThreadHive task.
+/// @param alloc Allocates the memory of the tasks. Nothing is freed so it's better to be a frame allocator.
+/// @param pairs The pairs to sort.
+/// @param scratch Scratch memory with the same size as pairs.
+/// @param[out] sorted The sorted pairs. It's either pairs or scratch. Read it after doneSemaphore reaches zero.
+/// @param[out] doneSemaphore Reaches zero when the sorting is done. It's nullptr if there was nothing to sort.
+/// @note The pairs, the scratch memory and the alloc should stay alive until the tasks are done.
+void radixSort(ThreadHive& hive, StackAllocator<U8> alloc, WeakArray<RadixSortPair> pairs,
+			   WeakArray<RadixSortPair> scratch, WeakArray<RadixSortPair>& sorted, ThreadHiveSemaphore*& doneSemaphore);
+/// @}
+
+} // end namespace anki
@@ -100,6 +100,7 @@ ANKI_WINBASEAPI HRESULT ANKI_WINAPI SHGetFolderPathA(HWND hwnd, int csidl, HANDL
 ANKI_WINBASEAPI HANDLE ANKI_WINAPI FindFirstFileA(LPCSTR lpFileName, LPWIN32_FIND_DATAA lpFindFileData);
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindClose(HANDLE hFindFile);
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI MoveFileExA(LPCSTR lpExistingFileName, LPCSTR lpNewFileName, DWORD dwFlags);
 
 // Other
 ANKI_WINBASEAPI DWORD ANKI_WINAPI GetLastError(VOID);
@@ -133,6 +134,7 @@ constexpr WORD FOF_NOCONFIRMATION = 0x0010;
 constexpr WORD FOF_NOERRORUI = 0x0400;
 constexpr WORD FOF_SILENT = 0x0004;
 constexpr WORD CSIDL_PROFILE = 0x0028;
+constexpr DWORD MOVEFILE_REPLACE_EXISTING = 0x00000001;
 constexpr DWORD STD_OUTPUT_HANDLE = (DWORD)-11;
 constexpr HRESULT S_OK = 0;
 constexpr DWORD INFINITE = 0xFFFFFFFF;
@@ -409,6 +411,11 @@ inline BOOL FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData)
 	return ::FindNextFileA(hFindFile, reinterpret_cast<::LPWIN32_FIND_DATAA>(lpFindFileData));
 }
 
+inline BOOL MoveFileExA(LPCSTR lpExistingFileName, LPCSTR lpNewFileName, DWORD dwFlags)
+{
+	return ::MoveFileExA(lpExistingFileName, lpNewFileName, dwFlags);
+}
+
 // Other
 inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency)
 {
@@ -0,0 +1,33 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/util/Tracer.h>
+
+using namespace anki;
+
+int main(int argc, char** argv)
+{
+	// Call a few singletons to avoid memory leak confusion
+	LoggerSingleton::get();
+
+	// The engine code has trace events. Keep the tracer disabled so it doesn't skew the results
+#if ANKI_ENABLE_TRACE
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	TracerSingleton::init(alloc);
+	TracerSingleton::get().setEnabled(false);
+#endif
+
+	const int exitcode = getBenchmarkRunnerSingleton().run(argc, argv);
+
+#if ANKI_ENABLE_TRACE
+	TracerSingleton::destroy();
+#endif
+	LoggerSingleton::destroy();
+
+	deleteBenchmarkRunnerSingleton();
+
+	return exitcode;
+}
@@ -0,0 +1,134 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/Collision.h>
+
+namespace anki
+{
+
+static const U32 SHAPE_COUNT = 1024;
+
+/// Shapes in a small volume so that roughly half of the pairs collide.
+class CollisionShapes
+{
+public:
+	std::vector<Aabb> m_aabbs;
+	std::vector<Sphere> m_spheres;
+	std::vector<Obb> m_obbs;
+	std::vector<Plane> m_planes;
+
+	CollisionShapes()
+	{
+		m_aabbs.resize(SHAPE_COUNT);
+		m_spheres.resize(SHAPE_COUNT);
+		m_obbs.resize(SHAPE_COUNT);
+		m_planes.resize(SHAPE_COUNT);
+
+		for(U32 i = 0; i < SHAPE_COUNT; ++i)
+		{
+			const Vec4 center = randomPoint();
+			const F32 extend = getRandomRange(0.5f, 2.0f);
+			m_aabbs[i] = Aabb(center - Vec4(extend, extend, extend, 0.0f), center + Vec4(extend, extend, extend, 0.0f));
+
+			m_spheres[i] = Sphere(randomPoint(), getRandomRange(0.5f, 2.0f));
+
+			const Euler rot(getRandomRange(-PI, PI), getRandomRange(-PI, PI), getRandomRange(-PI, PI));
+			const F32 ex = getRandomRange(0.5f, 2.0f);
+			const Vec4 obbExtend(ex, getRandomRange(0.5f, 2.0f), getRandomRange(0.5f, 2.0f), 0.0f);
+			m_obbs[i] = Obb(randomPoint(), Mat3x4(Vec3(0.0f), rot), obbExtend);
+
+			const Vec4 normal =
+				Vec4(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f) + 0.1f, 0.0f)
+					.getNormalized();
+			m_planes[i] = Plane(normal, getRandomRange(-5.0f, 5.0f));
+		}
+	}
+
+private:
+	static Vec4 randomPoint()
+	{
+		return Vec4(getRandomRange(-5.0f, 5.0f), getRandomRange(-5.0f, 5.0f), getRandomRange(-5.0f, 5.0f), 0.0f);
+	}
+};
+
+/// Test every shape of A against the shape with the same index in B.
+template<typename TA, typename TB>
+static void benchmarkCollision(Benchmark& bench, const std::vector<TA>& a, const std::vector<TB>& b)
+{
+	bench.setItemsPerIteration(SHAPE_COUNT);
+	bench.measure([&]() {
+		U64 collisionCount = 0;
+		for(U32 i = 0; i < SHAPE_COUNT; ++i)
+		{
+			collisionCount += testCollision(a[i], b[(i * 7) % SHAPE_COUNT]);
+		}
+		bench.consume(collisionCount);
+	});
+}
+
+template<typename T>
+static void benchmarkPlane(Benchmark& bench, const std::vector<Plane>& planes, const std::vector<T>& shapes)
+{
+	bench.setItemsPerIteration(SHAPE_COUNT);
+	bench.measure([&]() {
+		F32 sum = 0.0f;
+		for(U32 i = 0; i < SHAPE_COUNT; ++i)
+		{
+			sum += testPlane(planes[i], shapes[i]);
+		}
+		bench.consume(U64(sum));
+	});
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Collision, AabbAabb)
+{
+	CollisionShapes shapes;
+	benchmarkCollision(bench, shapes.m_aabbs, shapes.m_aabbs);
+}
+
+ANKI_BENCHMARK(Collision, AabbSphere)
+{
+	CollisionShapes shapes;
+	benchmarkCollision(bench, shapes.m_aabbs, shapes.m_spheres);
+}
+
+ANKI_BENCHMARK(Collision, SphereSphere)
+{
+	CollisionShapes shapes;
+	benchmarkCollision(bench, shapes.m_spheres, shapes.m_spheres);
+}
+
+ANKI_BENCHMARK(Collision, AabbObb)
+{
+	CollisionShapes shapes;
+	benchmarkCollision(bench, shapes.m_aabbs, shapes.m_obbs);
+}
+
+ANKI_BENCHMARK(Collision, ObbObb)
+{
+	CollisionShapes shapes;
+	benchmarkCollision(bench, shapes.m_obbs, shapes.m_obbs);
+}
+
+ANKI_BENCHMARK(Collision, PlaneAabb)
+{
+	CollisionShapes shapes;
+	benchmarkPlane(bench, shapes.m_planes, shapes.m_aabbs);
+}
+
+ANKI_BENCHMARK(Collision, PlaneSphere)
+{
+	CollisionShapes shapes;
+	benchmarkPlane(bench, shapes.m_planes, shapes.m_spheres);
+}
+
+ANKI_BENCHMARK(Collision, PlaneObb)
+{
+	CollisionShapes shapes;
+	benchmarkPlane(bench, shapes.m_planes, shapes.m_obbs);
+}
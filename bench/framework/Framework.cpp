@@ -0,0 +1,226 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/util/File.h>
+#include <anki/util/System.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace anki
+{
+
+U32 Benchmark::getThreadCount() const
+{
+	// The hives are pinned to cores so there can't be more threads than cores
+	const U32 coreCount = getCpuCoresCount();
+	return (m_config->m_threadCount) ? min(m_config->m_threadCount, coreCount) : coreCount;
+}
+
+void Benchmark::run()
+{
+	ANKI_BENCH_LOGI("Running %s %s", m_suite.c_str(), m_name.c_str());
+
+	m_measured = false;
+	m_callback(*this);
+
+	if(!m_measured)
+	{
+		ANKI_BENCH_LOGF("The benchmark didn't call measure()");
+	}
+
+	const BenchmarkResult& r = m_result;
+	if(r.m_itemsPerIteration)
+	{
+		ANKI_BENCH_LOGI("%s %s: median %.3fus, min %.3fus, stddev %.2f%%, %.3f Mitems/s", m_suite.c_str(),
+						m_name.c_str(), r.m_median * 1.0e+6, r.m_min * 1.0e+6,
+						r.m_standardDeviation / r.m_mean * 100.0, F64(r.m_itemsPerIteration) / r.m_median * 1.0e-6);
+	}
+	else
+	{
+		ANKI_BENCH_LOGI("%s %s: median %.3fus, min %.3fus, stddev %.2f%%", m_suite.c_str(), m_name.c_str(),
+						r.m_median * 1.0e+6, r.m_min * 1.0e+6, r.m_standardDeviation / r.m_mean * 100.0);
+	}
+}
+
+void Benchmark::computeStatistics(std::vector<Second>& samples, U64 iterations)
+{
+	ANKI_ASSERT(samples.size() > 0);
+	std::sort(samples.begin(), samples.end());
+
+	BenchmarkResult& r = m_result;
+	r.m_repeatCount = U32(samples.size());
+	r.m_iterationsPerRepeat = iterations;
+	r.m_min = samples.front();
+	r.m_max = samples.back();
+
+	const size_t mid = samples.size() / 2;
+	r.m_median = (samples.size() & 1) ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0;
+
+	Second sum = 0.0;
+	for(Second s : samples)
+	{
+		sum += s;
+	}
+	r.m_mean = sum / Second(samples.size());
+
+	Second variance = 0.0;
+	for(Second s : samples)
+	{
+		variance += (s - r.m_mean) * (s - r.m_mean);
+	}
+	r.m_standardDeviation = std::sqrt(variance / Second(samples.size()));
+
+	m_measured = true;
+}
+
+BenchmarkRunner::~BenchmarkRunner()
+{
+	for(Benchmark* b : m_benchmarks)
+	{
+		delete b;
+	}
+}
+
+void BenchmarkRunner::addBenchmark(const char* name, const char* suite, BenchmarkCallback callback)
+{
+	Benchmark* b = new Benchmark;
+	b->m_suite = suite;
+	b->m_name = name;
+	b->m_callback = callback;
+	b->m_config = &m_config;
+	m_benchmarks.push_back(b);
+}
+
+int BenchmarkRunner::run(int argc, char** argv)
+{
+	const std::string helpMessage = std::string("Usage: ") + argv[0] + R"( [options]
+Options:
+  --help               Print this message
+  --list               List all the benchmarks
+  --filter <str>       Run the benchmarks that have <str> in their "suite name"
+  --repeats <N>        Number of measurements per benchmark. Default: 10
+  --min-time <sec>     Minimum duration of a single measurement. Default: 0.05
+  --threads <N>        Thread count of the benchmarks that use a ThreadHive. Max and default: the number of cores
+  --json <file>        Write the results to a JSON file)";
+
+	std::string filter;
+	std::string jsonFilename;
+
+	for(int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const Bool hasValue = i + 1 < argc;
+
+		if(strcmp(arg, "--help") == 0)
+		{
+			std::cout << helpMessage << std::endl;
+			return 0;
+		}
+		else if(strcmp(arg, "--list") == 0)
+		{
+			for(const Benchmark* b : m_benchmarks)
+			{
+				std::cout << b->m_suite << " " << b->m_name << std::endl;
+			}
+			return 0;
+		}
+		else if(strcmp(arg, "--filter") == 0 && hasValue)
+		{
+			filter = argv[++i];
+		}
+		else if(strcmp(arg, "--repeats") == 0 && hasValue)
+		{
+			m_config.m_repeatCount = max(1u, U32(atoi(argv[++i])));
+		}
+		else if(strcmp(arg, "--min-time") == 0 && hasValue)
+		{
+			m_config.m_minRepeatTime = atof(argv[++i]);
+		}
+		else if(strcmp(arg, "--threads") == 0 && hasValue)
+		{
+			m_config.m_threadCount = U32(atoi(argv[++i]));
+		}
+		else if(strcmp(arg, "--json") == 0 && hasValue)
+		{
+			jsonFilename = argv[++i];
+		}
+		else
+		{
+			std::cerr << helpMessage << std::endl;
+			return 1;
+		}
+	}
+
+	// Run
+	std::vector<const Benchmark*> ran;
+	for(Benchmark* b : m_benchmarks)
+	{
+		const std::string fullName = b->m_suite + " " + b->m_name;
+		if(filter.empty() || fullName.find(filter) != std::string::npos)
+		{
+			b->run();
+			ran.push_back(b);
+		}
+	}
+
+	if(!jsonFilename.empty() && writeJson(jsonFilename.c_str(), ran))
+	{
+		ANKI_BENCH_LOGE("Failed to write %s", jsonFilename.c_str());
+		return 1;
+	}
+
+	return 0;
+}
+
+Error BenchmarkRunner::writeJson(CString filename, const std::vector<const Benchmark*>& benchmarks) const
+{
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::WRITE));
+
+	ANKI_CHECK(file.writeText("{\n"));
+	ANKI_CHECK(file.writeText("\t\"context\": {\"cpu_count\": %u, \"repeats\": %u, \"min_repeat_time\": %f, "
+							  "\"extra_checks\": %s},\n",
+							  getCpuCoresCount(), m_config.m_repeatCount, m_config.m_minRepeatTime,
+							  (ANKI_EXTRA_CHECKS) ? "true" : "false"));
+	ANKI_CHECK(file.writeText("\t\"benchmarks\": [\n"));
+
+	for(U32 i = 0; i < benchmarks.size(); ++i)
+	{
+		const Benchmark& b = *benchmarks[i];
+		const BenchmarkResult& r = b.m_result;
+
+		ANKI_CHECK(file.writeText("\t\t{\"suite\": \"%s\", \"name\": \"%s\", \"repeats\": %u, \"iterations\": %llu, ",
+								  b.m_suite.c_str(), b.m_name.c_str(), r.m_repeatCount,
+								  static_cast<unsigned long long>(r.m_iterationsPerRepeat)));
+		ANKI_CHECK(file.writeText("\"min_ns\": %f, \"max_ns\": %f, \"mean_ns\": %f, \"median_ns\": %f, "
+								  "\"stddev_ns\": %f, ",
+								  r.m_min * 1.0e+9, r.m_max * 1.0e+9, r.m_mean * 1.0e+9, r.m_median * 1.0e+9,
+								  r.m_standardDeviation * 1.0e+9));
+		ANKI_CHECK(file.writeText("\"items_per_iteration\": %llu, \"items_per_second\": %f}%s\n",
+								  static_cast<unsigned long long>(r.m_itemsPerIteration),
+								  F64(r.m_itemsPerIteration) / r.m_median, (i + 1 < benchmarks.size()) ? "," : ""));
+	}
+
+	ANKI_CHECK(file.writeText("\t]\n}\n"));
+	return Error::NONE;
+}
+
+static BenchmarkRunner* g_benchmarkRunnerInstance = nullptr;
+
+BenchmarkRunner& getBenchmarkRunnerSingleton()
+{
+	return *(g_benchmarkRunnerInstance ? g_benchmarkRunnerInstance
+									   : (g_benchmarkRunnerInstance = new BenchmarkRunner));
+}
+
+void deleteBenchmarkRunnerSingleton()
+{
+	delete g_benchmarkRunnerInstance;
+}
+
+} // end namespace anki
@@ -0,0 +1,163 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/Allocator.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/Logger.h>
+#include <anki/util/String.h>
+#include <vector>
+#include <string>
+
+namespace anki
+{
+
+// Forward
+class Benchmark;
+
+#define ANKI_BENCH_LOGI(...) ANKI_LOG("BNCH", NORMAL, __VA_ARGS__)
+#define ANKI_BENCH_LOGE(...) ANKI_LOG("BNCH", ERROR, __VA_ARGS__)
+#define ANKI_BENCH_LOGW(...) ANKI_LOG("BNCH", WARNING, __VA_ARGS__)
+#define ANKI_BENCH_LOGF(...) ANKI_LOG("BNCH", FATAL, __VA_ARGS__)
+
+/// The benchmark function. It does the setup and calls Benchmark::measure() once.
+using BenchmarkCallback = void (*)(Benchmark&);
+
+/// Options that apply to all benchmarks.
+class BenchmarkConfig
+{
+public:
+	U32 m_repeatCount = 10; ///< How many times to measure. The statistics are computed on those.
+	Second m_minRepeatTime = 0.05; ///< Every repeat runs the measured code as many times as it takes to reach that.
+	U32 m_threadCount = 0; ///< For the benchmarks that use a ThreadHive. Zero means the number of cores.
+};
+
+/// The statistics of a benchmark. All times are the time of a single iteration.
+class BenchmarkResult
+{
+public:
+	U32 m_repeatCount = 0;
+	U64 m_iterationsPerRepeat = 0;
+	Second m_min = 0.0;
+	Second m_max = 0.0;
+	Second m_mean = 0.0;
+	Second m_median = 0.0;
+	Second m_standardDeviation = 0.0;
+	U64 m_itemsPerIteration = 0; ///< Zero if the throughput doesn't make sense.
+};
+
+/// A single benchmark.
+class Benchmark
+{
+public:
+	std::string m_suite;
+	std::string m_name;
+	BenchmarkCallback m_callback = nullptr;
+
+	const BenchmarkConfig* m_config = nullptr;
+	HeapAllocator<U8> m_alloc = {allocAligned, nullptr};
+	BenchmarkResult m_result;
+	Bool m_measured = false;
+
+	/// Time a piece of code. Everything before that call is considered setup. The functor runs once to warm up the
+	/// caches and to estimate how many iterations fit in BenchmarkConfig::m_minRepeatTime.
+	template<typename TFunc>
+	void measure(TFunc func)
+	{
+		ANKI_ASSERT(!m_measured && "measure() can be called only once");
+
+		HighRezTimer timer;
+		timer.start();
+		func();
+		timer.stop();
+		const Second warmupTime = max(timer.getElapsedTime(), 1.0e-9);
+		const U64 iterations = max<U64>(1, U64(m_config->m_minRepeatTime / warmupTime));
+
+		std::vector<Second> samples(m_config->m_repeatCount);
+		for(Second& sample : samples)
+		{
+			timer.start();
+			for(U64 i = 0; i < iterations; ++i)
+			{
+				func();
+			}
+			timer.stop();
+			sample = timer.getElapsedTime() / Second(iterations);
+		}
+
+		computeStatistics(samples, iterations);
+	}
+
+	/// How many items (tasks, allocations, lookups etc) one call of the measured functor processes. Optional.
+	void setItemsPerIteration(U64 count)
+	{
+		m_result.m_itemsPerIteration = count;
+	}
+
+	/// Feed it with results of the measured code so the compiler can't throw the code away.
+	void consume(U64 x)
+	{
+		m_sink = m_sink ^ x;
+	}
+
+	U32 getThreadCount() const;
+
+	void run();
+
+private:
+	volatile U64 m_sink = 0;
+
+	void computeStatistics(std::vector<Second>& samples, U64 iterations);
+};
+
+/// Holds all the benchmarks.
+class BenchmarkRunner
+{
+public:
+	std::vector<Benchmark*> m_benchmarks;
+	BenchmarkConfig m_config;
+
+	~BenchmarkRunner();
+
+	void addBenchmark(const char* name, const char* suite, BenchmarkCallback callback);
+
+	int run(int argc, char** argv);
+
+private:
+	ANKI_USE_RESULT Error writeJson(CString filename, const std::vector<const Benchmark*>& benchmarks) const;
+};
+
+/// Singleton so we can do the ANKI_BENCHMARK trick.
+extern BenchmarkRunner& getBenchmarkRunnerSingleton();
+
+/// Delete the instance to make valgrind a bit happy.
+extern void deleteBenchmarkRunnerSingleton();
+
+/// Create a new benchmark and add it. Same trick as ANKI_TEST.
+#define ANKI_BENCHMARK(suiteName_, name_) \
+	using namespace anki; \
+	void bench_##suiteName_##name_(Benchmark&); \
+	struct BenchFoo##suiteName_##name_ \
+	{ \
+		BenchFoo##suiteName_##name_() \
+		{ \
+			getBenchmarkRunnerSingleton().addBenchmark(#name_, #suiteName_, bench_##suiteName_##name_); \
+		} \
+	}; \
+	static BenchFoo##suiteName_##name_ benchYada##suiteName_##name_; \
+	void bench_##suiteName_##name_(Benchmark& bench)
+
+/// Abort the benchmark if an Error is returned.
+#define ANKI_BENCH_CHECK(x_) \
+	do \
+	{ \
+		if(x_) \
+		{ \
+			ANKI_BENCH_LOGF("Benchmark failed: %s (%s:%d)", #x_, __FILE__, __LINE__); \
+		} \
+	} while(0)
+
+} // end namespace anki
@@ -0,0 +1,162 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/renderer/ClusterBin.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/ThreadHive.h>
+
+namespace anki
+{
+
+static const U32 POINT_LIGHT_COUNT = 256;
+static const U32 SPOT_LIGHT_COUNT = 64;
+
+/// A camera at the origin looking at -Z surrounded by lights. No shadows, no decals and no probes so the GPU objects
+/// are not needed.
+class ClusterBinScene
+{
+public:
+	std::vector<PointLightQueueElement> m_pointLights;
+	std::vector<SpotLightQueueElement> m_spotLights;
+	RenderQueue m_queue;
+
+	/// The more lights the smaller they are so the number of lights per cluster stays reasonable.
+	ClusterBinScene(U32 pointLightCount = POINT_LIGHT_COUNT, U32 spotLightCount = SPOT_LIGHT_COUNT,
+					F32 maxLightSize = 1.0f)
+	{
+		m_pointLights.resize(pointLightCount);
+		for(PointLightQueueElement& light : m_pointLights)
+		{
+			zeroMemory(light);
+			light.m_worldPosition =
+				Vec3(getRandomRange(-60.0f, 60.0f), getRandomRange(-5.0f, 15.0f), -getRandomRange(0.0f, 150.0f));
+			light.m_radius = getRandomRange(1.0f, 10.0f) * maxLightSize;
+			light.m_diffuseColor = Vec3(1.0f);
+		}
+
+		m_spotLights.resize(spotLightCount);
+		for(SpotLightQueueElement& light : m_spotLights)
+		{
+			zeroMemory(light);
+			const Vec4 origin(getRandomRange(-60.0f, 60.0f), getRandomRange(0.0f, 15.0f), -getRandomRange(0.0f, 150.0f),
+							  0.0f);
+			const Euler rot(getRandomRange(-PI, PI), getRandomRange(-PI, PI), 0.0f);
+			light.m_worldTransform = Mat4(Transform(origin, Mat3x4(Vec3(0.0f), rot), 1.0f));
+			light.m_distance = getRandomRange(5.0f, 20.0f) * maxLightSize;
+			light.m_outerAngle = toRad(getRandomRange(20.0f, 60.0f));
+			light.m_innerAngle = light.m_outerAngle / 2.0f;
+			light.m_diffuseColor = Vec3(1.0f);
+		}
+
+		m_queue.m_pointLights = WeakArray<PointLightQueueElement>(&m_pointLights[0], pointLightCount);
+		m_queue.m_spotLights = WeakArray<SpotLightQueueElement>(&m_spotLights[0], spotLightCount);
+
+		m_queue.m_cameraNear = 0.1f;
+		m_queue.m_cameraFar = 200.0f;
+		m_queue.m_cameraFovX = toRad(90.0f);
+		m_queue.m_cameraFovY = toRad(60.0f);
+		m_queue.m_cameraTransform = Mat4::getIdentity();
+		m_queue.m_viewMatrix = Mat4::getIdentity();
+		m_queue.m_projectionMatrix = Mat4::calculatePerspectiveProjectionMatrix(
+			m_queue.m_cameraFovX, m_queue.m_cameraFovY, m_queue.m_cameraNear, m_queue.m_cameraFar);
+		m_queue.m_viewProjectionMatrix = m_queue.m_projectionMatrix;
+		m_queue.m_previousViewProjectionMatrix = m_queue.m_projectionMatrix;
+	}
+};
+
+/// Bin a number of lights to a cluster grid. 3/4 of the lights are point lights and the rest spot lights.
+static void benchmarkClusterBin(Benchmark& bench, U32 lightCount, U32 clusterCountX, U32 clusterCountY,
+								Bool objectCentric, Bool simd)
+{
+	const U32 spotLightCount = lightCount / 4;
+	const U32 pointLightCount = lightCount - spotLightCount;
+	ClusterBinScene scene(pointLightCount, spotLightCount, min(1.0f, sqrt(F32(POINT_LIGHT_COUNT) / F32(lightCount))));
+
+	ConfigSet config = DefaultConfigSet::get();
+	config.set("r_avgObjectsPerCluster", 128u);
+	config.set("r_objectCentricClusterBinning", objectCentric);
+	config.set("r_clusterBinSimd", simd);
+
+	ClusterBin clusterBin;
+	clusterBin.init(bench.m_alloc, clusterCountX, clusterCountY, 32, config);
+
+	ThreadHive hive(bench.getThreadCount(), bench.m_alloc, true);
+	StackAllocator<U8> tempAlloc(allocAligned, nullptr, 64 * 1024 * 1024, 1.0f);
+
+	ClusterBinIn in;
+	in.m_threadHive = &hive;
+	in.m_tempAlloc = tempAlloc;
+	in.m_renderQueue = &scene.m_queue;
+	in.m_stagingMem = nullptr;
+	in.m_shadowsEnabled = false;
+
+	bench.setItemsPerIteration(lightCount);
+	bench.measure([&]() {
+		ClusterBinOut out;
+		clusterBin.bin(in, out);
+		tempAlloc.getMemoryPool().reset();
+	});
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Renderer, ClusterBin)
+{
+	ClusterBinScene scene;
+
+	ConfigSet config = DefaultConfigSet::get();
+	config.set("r_avgObjectsPerCluster", 32u);
+
+	ClusterBin clusterBin;
+	clusterBin.init(bench.m_alloc, 16, 9, 32, config);
+
+	ThreadHive hive(bench.getThreadCount(), bench.m_alloc, true);
+	StackAllocator<U8> tempAlloc(allocAligned, nullptr, 4 * 1024 * 1024, 1.0f);
+
+	ClusterBinIn in;
+	in.m_threadHive = &hive;
+	in.m_tempAlloc = tempAlloc;
+	in.m_renderQueue = &scene.m_queue;
+	in.m_stagingMem = nullptr;
+	in.m_shadowsEnabled = false;
+
+	bench.setItemsPerIteration(POINT_LIGHT_COUNT + SPOT_LIGHT_COUNT);
+	bench.measure([&]() {
+		ClusterBinOut out;
+		clusterBin.bin(in, out);
+		tempAlloc.getMemoryPool().reset();
+	});
+}
+
+// Tile-centric vs object-centric binning and SIMD vs scalar. The scalar tile-centric binning is the baseline. The grids
+// are the ones of 60 pixel tiles at 1080p and 4K
+#define ANKI_CLUSTER_BIN_BENCHMARK(name_, lightCount_, clusterCountX_, clusterCountY_) \
+	ANKI_BENCHMARK(Renderer, ClusterBinTileCentricScalar##name_) \
+	{ \
+		benchmarkClusterBin(bench, lightCount_, clusterCountX_, clusterCountY_, false, false); \
+	} \
+	ANKI_BENCHMARK(Renderer, ClusterBinTileCentric##name_) \
+	{ \
+		benchmarkClusterBin(bench, lightCount_, clusterCountX_, clusterCountY_, false, true); \
+	} \
+	ANKI_BENCHMARK(Renderer, ClusterBinObjectCentric##name_) \
+	{ \
+		benchmarkClusterBin(bench, lightCount_, clusterCountX_, clusterCountY_, true, true); \
+	} \
+	ANKI_BENCHMARK(Renderer, ClusterBinObjectCentricScalar##name_) \
+	{ \
+		benchmarkClusterBin(bench, lightCount_, clusterCountX_, clusterCountY_, true, false); \
+	}
+
+ANKI_CLUSTER_BIN_BENCHMARK(100Lights1080p, 100, 32, 18)
+ANKI_CLUSTER_BIN_BENCHMARK(1KLights1080p, 1000, 32, 18)
+ANKI_CLUSTER_BIN_BENCHMARK(10KLights1080p, 10000, 32, 18)
+ANKI_CLUSTER_BIN_BENCHMARK(100Lights4K, 100, 64, 36)
+ANKI_CLUSTER_BIN_BENCHMARK(1KLights4K, 1000, 64, 36)
+ANKI_CLUSTER_BIN_BENCHMARK(10KLights4K, 10000, 64, 36)
+
+#undef ANKI_CLUSTER_BIN_BENCHMARK
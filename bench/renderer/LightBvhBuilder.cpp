@@ -0,0 +1,72 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/renderer/LightBvhBuilder.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/util/ThreadHive.h>
+
+namespace anki
+{
+
+/// Build the BVH of a number of lights. 3/4 of the lights are point lights and the rest spot lights.
+static void benchmarkLightBvhBuilder(Benchmark& bench, U32 lightCount, U32 threadCount)
+{
+	const U32 spotLightCount = lightCount / 4;
+	const U32 pointLightCount = lightCount - spotLightCount;
+
+	std::vector<PointLightQueueElement> pointLights(pointLightCount);
+	for(PointLightQueueElement& light : pointLights)
+	{
+		zeroMemory(light);
+		light.m_worldPosition =
+			Vec3(getRandomRange(-200.0f, 200.0f), getRandomRange(-5.0f, 15.0f), getRandomRange(-200.0f, 200.0f));
+		light.m_radius = getRandomRange(1.0f, 10.0f);
+		light.m_diffuseColor = Vec3(getRandomRange(0.1f, 10.0f));
+	}
+
+	std::vector<SpotLightQueueElement> spotLights(spotLightCount);
+	for(SpotLightQueueElement& light : spotLights)
+	{
+		zeroMemory(light);
+		const Vec4 origin(getRandomRange(-200.0f, 200.0f), getRandomRange(0.0f, 15.0f), getRandomRange(-200.0f, 200.0f),
+						  0.0f);
+		const Euler rot(getRandomRange(-PI, PI), getRandomRange(-PI, PI), 0.0f);
+		light.m_worldTransform = Mat4(Transform(origin, Mat3x4(Vec3(0.0f), rot), 1.0f));
+		light.m_distance = getRandomRange(5.0f, 20.0f);
+		light.m_diffuseColor = Vec3(getRandomRange(0.1f, 10.0f));
+	}
+
+	ThreadHive hive(threadCount, bench.m_alloc, true);
+	StackAllocator<U8> tempAlloc(allocAligned, nullptr, 16 * 1024 * 1024, 1.0f);
+
+	// Same size as the tree of the first iteration. The lights don't change so it stays the same
+	std::vector<LightBvhNode> nodes(nextPowerOfTwo(lightCount) * 2 - 1);
+	std::vector<LightBvhLight> lights(nextPowerOfTwo(lightCount));
+
+	bench.setItemsPerIteration(lightCount);
+	bench.measure([&]() {
+		LightBvhBuilder builder;
+		builder.init(hive, tempAlloc, ConstWeakArray<PointLightQueueElement>(&pointLights[0], pointLightCount),
+					 ConstWeakArray<SpotLightQueueElement>(&spotLights[0], spotLightCount), false);
+		ANKI_ASSERT(builder.getNodeCount() == nodes.size());
+
+		builder.build(WeakArray<LightBvhNode>(&nodes[0], builder.getNodeCount()),
+					  WeakArray<LightBvhLight>(&lights[0], builder.getLeafCount()));
+		tempAlloc.getMemoryPool().reset();
+	});
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Renderer, LightBvhBuilder10KLights)
+{
+	benchmarkLightBvhBuilder(bench, 10000, bench.getThreadCount());
+}
+
+ANKI_BENCHMARK(Renderer, LightBvhBuilder10KLightsSingleThread)
+{
+	benchmarkLightBvhBuilder(bench, 10000, 1);
+}
@@ -0,0 +1,115 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/resource/AnimationResource.h>
+
+namespace anki
+{
+
+static const U32 BONE_COUNT = 200;
+static const U32 KEY_COUNT = 61; ///< 2 seconds at 30FPS.
+
+/// Channels of a rig where every bone has a position and a rotation track.
+class AnimationRig
+{
+public:
+	HeapAllocator<U8> m_alloc;
+	DynamicArrayAuto<AnimationChannel> m_channels;
+	DynamicArrayAuto<Vec3> m_positions;
+	DynamicArrayAuto<Quat> m_rotations;
+	DynamicArrayAuto<F32> m_scales;
+
+	AnimationRig(HeapAllocator<U8> alloc)
+		: m_alloc(alloc)
+		, m_channels(alloc, BONE_COUNT)
+		, m_positions(alloc, BONE_COUNT)
+		, m_rotations(alloc, BONE_COUNT)
+		, m_scales(alloc, BONE_COUNT)
+	{
+		for(U32 b = 0; b < BONE_COUNT; ++b)
+		{
+			AnimationChannel& channel = m_channels[b];
+			channel.m_positions.create(alloc, KEY_COUNT);
+			channel.m_rotations.create(alloc, KEY_COUNT);
+			for(U32 k = 0; k < KEY_COUNT; ++k)
+			{
+				const Second time = Second(k) / 30.0;
+				const F32 angle = F32(time) * PI * 0.5f + F32(b) * 0.1f;
+				channel.m_positions[k] = {time, Vec3(sin(angle), cos(angle), F32(b))};
+				channel.m_rotations[k] = {time, Quat(Axisang(angle, Vec3(0.0f, 1.0f, 0.0f)))};
+			}
+		}
+	}
+
+	~AnimationRig()
+	{
+		for(AnimationChannel& channel : m_channels)
+		{
+			channel.destroy(m_alloc);
+		}
+	}
+};
+
+/// Sample a channel with a linear search and slerp. That's how the channels were sampled one by one.
+static void linearSearchSample(const AnimationChannel& channel, Second time, Vec3& pos, Quat& rot)
+{
+	for(U32 i = 0; i < channel.m_positions.getSize() - 1; ++i)
+	{
+		const auto& left = channel.m_positions[i];
+		const auto& right = channel.m_positions[i + 1];
+		if(time >= left.getTime() && time <= right.getTime())
+		{
+			const F32 u = F32((time - left.getTime()) / (right.getTime() - left.getTime()));
+			pos = linearInterpolate(left.getValue(), right.getValue(), u);
+			break;
+		}
+	}
+
+	for(U32 i = 0; i < channel.m_rotations.getSize() - 1; ++i)
+	{
+		const auto& left = channel.m_rotations[i];
+		const auto& right = channel.m_rotations[i + 1];
+		if(time >= left.getTime() && time <= right.getTime())
+		{
+			const F32 u = F32((time - left.getTime()) / (right.getTime() - left.getTime()));
+			rot = left.getValue().slerp(right.getValue(), u);
+			break;
+		}
+	}
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Resource, AnimationSampling200Bones)
+{
+	AnimationRig rig(bench.m_alloc);
+	Second time = 0.0;
+
+	bench.setItemsPerIteration(BONE_COUNT);
+	bench.measure([&]() {
+		sampleAnimationChannels(ConstWeakArray<AnimationChannel>(rig.m_channels), time,
+								WeakArray<Vec3>(rig.m_positions), WeakArray<Quat>(rig.m_rotations),
+								WeakArray<F32>(rig.m_scales));
+		time = (time >= 2.0) ? 0.0 : time + 0.002;
+	});
+	bench.consume(U64(rig.m_positions[BONE_COUNT / 2].x() * 1000.0f));
+}
+
+ANKI_BENCHMARK(Resource, AnimationSampling200BonesLinearSearch)
+{
+	AnimationRig rig(bench.m_alloc);
+	Second time = 0.0;
+
+	bench.setItemsPerIteration(BONE_COUNT);
+	bench.measure([&]() {
+		for(U32 b = 0; b < BONE_COUNT; ++b)
+		{
+			linearSearchSample(rig.m_channels[b], time, rig.m_positions[b], rig.m_rotations[b]);
+		}
+		time = (time >= 2.0) ? 0.0 : time + 0.002;
+	});
+	bench.consume(U64(rig.m_positions[BONE_COUNT / 2].x() * 1000.0f));
+}
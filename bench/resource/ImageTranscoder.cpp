@@ -0,0 +1,103 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/resource/ImageTranscoder.h>
+#include <anki/importer/ImageImporter.h>
+
+namespace anki
+{
+
+static const U32 SURFACE_SIZE = 1024;
+
+/// Create a surface of S3TC blocks out of a smooth image so it compresses like the real thing.
+static void createS3tcSurface(Bool bc3, DynamicArrayAuto<U8>& blocks)
+{
+	const U32 blockSize = (bc3) ? 16 : 8;
+	const U32 blocksPerRow = SURFACE_SIZE / 4;
+	blocks.create(blocksPerRow * blocksPerRow * blockSize);
+
+	Array<U8, 16 * 4> texels;
+	for(U32 b = 0; b < blocksPerRow * blocksPerRow; ++b)
+	{
+		const U32 bx = (b % blocksPerRow) * 4;
+		const U32 by = (b / blocksPerRow) * 4;
+		for(U32 t = 0; t < 16; ++t)
+		{
+			const U32 x = bx + t % 4;
+			const U32 y = by + t / 4;
+			texels[t * 4 + 0] = U8(x * 255 / SURFACE_SIZE);
+			texels[t * 4 + 1] = U8(y * 255 / SURFACE_SIZE);
+			texels[t * 4 + 2] = U8(((x ^ y) & 0xF) * 16);
+			texels[t * 4 + 3] = U8((x + y) * 255 / (SURFACE_SIZE * 2));
+		}
+
+		if(bc3)
+		{
+			compressBc3Block(&texels[0], &blocks[b * blockSize]);
+		}
+		else
+		{
+			compressBc1Block(&texels[0], &blocks[b * blockSize]);
+		}
+	}
+}
+
+/// Inflate and merge a supercompressed surface. That's what the loader does.
+static void benchmarkTranscode(Benchmark& bench, Bool bc3)
+{
+	DynamicArrayAuto<U8> blocks(bench.m_alloc);
+	createS3tcSurface(bc3, blocks);
+
+	DynamicArrayAuto<U8> compressed(bench.m_alloc);
+	ANKI_BENCH_CHECK(compressS3tcZlib(blocks, bc3, compressed));
+	ANKI_BENCH_LOGI("%s supercompressed to %f%%", (bc3) ? "BC3" : "BC1",
+					F64(compressed.getSize()) / F64(blocks.getSize()) * 100.0);
+
+	DynamicArrayAuto<U8> transcoded(bench.m_alloc, blocks.getSize());
+	bench.setItemsPerIteration(blocks.getSize());
+	bench.measure([&]() {
+		ANKI_BENCH_CHECK(transcodeS3tcZlib(compressed, bc3, bench.m_alloc, WeakArray<U8>(transcoded)));
+	});
+	bench.consume(transcoded[transcoded.getSize() / 2]);
+}
+
+/// Only merge the streams.
+static void benchmarkMerge(Benchmark& bench, Bool bc3)
+{
+	DynamicArrayAuto<U8> blocks(bench.m_alloc);
+	createS3tcSurface(bc3, blocks);
+
+	DynamicArrayAuto<U8> streams(bench.m_alloc, blocks.getSize());
+	splitS3tcBlocks(blocks, bc3, WeakArray<U8>(streams));
+
+	bench.setItemsPerIteration(blocks.getSize());
+	bench.measure([&]() {
+		mergeS3tcBlocks(streams, bc3, WeakArray<U8>(blocks));
+	});
+	bench.consume(blocks[blocks.getSize() / 2]);
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Resource, ImageTranscoderTranscodeBc1)
+{
+	benchmarkTranscode(bench, false);
+}
+
+ANKI_BENCHMARK(Resource, ImageTranscoderTranscodeBc3)
+{
+	benchmarkTranscode(bench, true);
+}
+
+ANKI_BENCHMARK(Resource, ImageTranscoderMergeBc1)
+{
+	benchmarkMerge(bench, false);
+}
+
+ANKI_BENCHMARK(Resource, ImageTranscoderMergeBc3)
+{
+	benchmarkMerge(bench, true);
+}
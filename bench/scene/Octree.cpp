@@ -0,0 +1,139 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/scene/Octree.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/Collision.h>
+
+namespace anki
+{
+
+static const U32 PLACEABLE_COUNT = 10 * 1000;
+static const F32 SCENE_SIZE = 500.0f;
+
+/// Objects of various sizes scattered in the scene.
+static void generateVolumes(std::vector<Aabb>& volumes)
+{
+	volumes.resize(PLACEABLE_COUNT);
+	for(Aabb& volume : volumes)
+	{
+		const F32 height = SCENE_SIZE / 10.0f;
+		const Vec3 center(getRandomRange(-SCENE_SIZE, SCENE_SIZE), getRandomRange(-height, height),
+						  getRandomRange(-SCENE_SIZE, SCENE_SIZE));
+		const F32 extend = (getRandom() % 16 == 0) ? getRandomRange(10.0f, 50.0f) : getRandomRange(0.5f, 4.0f);
+		volume = Aabb((center - extend).xyz0(), (center + extend).xyz0());
+	}
+}
+
+static void computeFrustumPlanes(Array<Plane, 6>& planes)
+{
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(60.0f), 0.1f, 300.0f);
+	const Transform camTrf(Vec4(10.0f, 5.0f, 0.0f, 0.0f), Mat3x4(Vec3(0.0f), Euler(0.0f, toRad(30.0f), 0.0f)), 1.0f);
+	const Mat4 view = Mat4(camTrf).getInverse();
+	extractClipPlanes(proj * view, planes);
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Scene, OctreePlace)
+{
+	std::vector<Aabb> volumes;
+	generateVolumes(volumes);
+	std::vector<OctreePlaceable> placeables(PLACEABLE_COUNT);
+
+	Octree octree(bench.m_alloc);
+	octree.init(Vec3(-SCENE_SIZE), Vec3(SCENE_SIZE), 5);
+
+	// Move all the objects every iteration
+	bench.setItemsPerIteration(PLACEABLE_COUNT);
+	bench.measure([&]() {
+		for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+		{
+			placeables[i].m_userData = &placeables[i];
+			octree.place(volumes[i], &placeables[i], true);
+		}
+
+		for(OctreePlaceable& placeable : placeables)
+		{
+			octree.remove(placeable);
+		}
+	});
+}
+
+ANKI_BENCHMARK(Scene, OctreeGather)
+{
+	std::vector<Aabb> volumes;
+	generateVolumes(volumes);
+	std::vector<OctreePlaceable> placeables(PLACEABLE_COUNT);
+
+	Octree octree(bench.m_alloc);
+	octree.init(Vec3(-SCENE_SIZE), Vec3(SCENE_SIZE), 5);
+	for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+	{
+		placeables[i].m_userData = &placeables[i];
+		octree.place(volumes[i], &placeables[i], true);
+	}
+
+	Array<Plane, 6> planes;
+	computeFrustumPlanes(planes);
+
+	DynamicArrayAuto<void*> visible(bench.m_alloc);
+	bench.setItemsPerIteration(PLACEABLE_COUNT);
+	bench.measure([&]() {
+		for(OctreePlaceable& placeable : placeables)
+		{
+			placeable.reset();
+		}
+
+		visible.destroy();
+		octree.gatherVisible(&planes[0], 0, nullptr, nullptr, visible);
+		bench.consume(visible.getSize());
+	});
+
+	for(OctreePlaceable& placeable : placeables)
+	{
+		octree.remove(placeable);
+	}
+}
+
+ANKI_BENCHMARK(Scene, OctreeGatherParallel)
+{
+	std::vector<Aabb> volumes;
+	generateVolumes(volumes);
+	std::vector<OctreePlaceable> placeables(PLACEABLE_COUNT);
+
+	Octree octree(bench.m_alloc);
+	octree.init(Vec3(-SCENE_SIZE), Vec3(SCENE_SIZE), 5);
+	for(U32 i = 0; i < PLACEABLE_COUNT; ++i)
+	{
+		placeables[i].m_userData = &placeables[i];
+		octree.place(volumes[i], &placeables[i], true);
+	}
+
+	Array<Plane, 6> planes;
+	computeFrustumPlanes(planes);
+
+	ThreadHive hive(bench.getThreadCount(), bench.m_alloc, true);
+	DynamicArrayAuto<void*> visible(bench.m_alloc);
+	bench.setItemsPerIteration(PLACEABLE_COUNT);
+	bench.measure([&]() {
+		for(OctreePlaceable& placeable : placeables)
+		{
+			placeable.reset();
+		}
+
+		visible.destroy();
+		ThreadHiveSemaphore* signalSemaphore = nullptr;
+		octree.gatherVisibleParallel(&planes[0], 0, nullptr, nullptr, &visible, hive, nullptr, signalSemaphore);
+		hive.waitAllTasks();
+		bench.consume(visible.getSize());
+	});
+
+	for(OctreePlaceable& placeable : placeables)
+	{
+		octree.remove(placeable);
+	}
+}
@@ -0,0 +1,151 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/scene/VisibilityInternal.h>
+#include <anki/util/RadixSort.h>
+#include <anki/util/ThreadHive.h>
+
+namespace anki
+{
+
+static const U32 RENDERABLE_COUNT = 200 * 1000;
+
+static void drawCallbackA(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData)
+{
+}
+
+static void drawCallbackB(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData)
+{
+}
+
+/// Renderables of a few hundred models at various distances, like the visibility tests output them.
+static void generateRenderables(std::vector<RenderableQueueElement>& renderables)
+{
+	renderables.resize(RENDERABLE_COUNT);
+	for(RenderableQueueElement& el : renderables)
+	{
+		zeroMemory(el);
+		el.m_callback = (getRandom() % 8 == 0) ? drawCallbackB : drawCallbackA;
+		el.m_mergeKey = computeHash(&el.m_callback, sizeof(el.m_callback), getRandom() % 300);
+		el.m_distanceFromCamera = getRandomRange(0.0f, 500.0f);
+		el.m_sortKey = computeMaterialDistanceSortKey(el, RENDERABLE_SORT_DISTANCE_GRANULARITY);
+	}
+}
+
+/// The old way, std::sort on the elements.
+class MaterialDistanceCompare
+{
+public:
+	Bool operator()(const RenderableQueueElement& a, const RenderableQueueElement& b) const
+	{
+		const U32 aClass = U32(a.m_distanceFromCamera / RENDERABLE_SORT_DISTANCE_GRANULARITY);
+		const U32 bClass = U32(b.m_distanceFromCamera / RENDERABLE_SORT_DISTANCE_GRANULARITY);
+
+		if(aClass == bClass && a.m_callback == b.m_callback)
+		{
+			return a.m_mergeKey < b.m_mergeKey;
+		}
+		else
+		{
+			return a.m_distanceFromCamera < b.m_distanceFromCamera;
+		}
+	}
+};
+
+/// Count the draws after merging to compare the state coherency of the orders.
+static U64 countDraws(const std::vector<RenderableQueueElement>& renderables)
+{
+	U64 draws = 1;
+	for(U32 i = 1; i < renderables.size(); ++i)
+	{
+		draws += !canMergeRenderableQueueElements(renderables[i - 1], renderables[i]);
+	}
+	return draws;
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Scene, RenderableSortStdSort)
+{
+	std::vector<RenderableQueueElement> unsorted;
+	generateRenderables(unsorted);
+	std::vector<RenderableQueueElement> renderables;
+
+	bench.setItemsPerIteration(RENDERABLE_COUNT);
+	bench.measure([&]() {
+		renderables = unsorted;
+		std::sort(renderables.begin(), renderables.end(), MaterialDistanceCompare());
+	});
+
+	ANKI_BENCH_LOGI("std::sort draws: %" PRIu64, countDraws(renderables));
+	bench.consume(renderables[0].m_mergeKey);
+}
+
+ANKI_BENCHMARK(Scene, RenderableSortRadix)
+{
+	std::vector<RenderableQueueElement> unsorted;
+	generateRenderables(unsorted);
+	std::vector<RenderableQueueElement> renderables(RENDERABLE_COUNT);
+	std::vector<RadixSortPair> pairs(RENDERABLE_COUNT);
+	std::vector<RadixSortPair> scratch(RENDERABLE_COUNT);
+
+	// Same work as the visibility, gather the keys, sort and copy the elements in the sorted order
+	bench.setItemsPerIteration(RENDERABLE_COUNT);
+	bench.measure([&]() {
+		for(U32 i = 0; i < RENDERABLE_COUNT; ++i)
+		{
+			pairs[i].m_key = unsorted[i].m_sortKey;
+			pairs[i].m_index = i;
+		}
+
+		const ConstWeakArray<RadixSortPair> sorted = radixSort(WeakArray<RadixSortPair>(&pairs[0], RENDERABLE_COUNT),
+															   WeakArray<RadixSortPair>(&scratch[0], RENDERABLE_COUNT));
+
+		for(U32 i = 0; i < RENDERABLE_COUNT; ++i)
+		{
+			renderables[i] = unsorted[sorted[i].m_index];
+		}
+	});
+
+	ANKI_BENCH_LOGI("Radix sort draws: %" PRIu64, countDraws(renderables));
+	bench.consume(renderables[0].m_mergeKey);
+}
+
+ANKI_BENCHMARK(Scene, RenderableSortRadixParallel)
+{
+	std::vector<RenderableQueueElement> unsorted;
+	generateRenderables(unsorted);
+	std::vector<RenderableQueueElement> renderables(RENDERABLE_COUNT);
+	std::vector<RadixSortPair> pairs(RENDERABLE_COUNT);
+	std::vector<RadixSortPair> scratch(RENDERABLE_COUNT);
+
+	ThreadHive hive(bench.getThreadCount(), bench.m_alloc, true);
+	StackAllocator<U8> tmpAlloc(allocAligned, nullptr, 64 * 1024);
+
+	bench.setItemsPerIteration(RENDERABLE_COUNT);
+	bench.measure([&]() {
+		for(U32 i = 0; i < RENDERABLE_COUNT; ++i)
+		{
+			pairs[i].m_key = unsorted[i].m_sortKey;
+			pairs[i].m_index = i;
+		}
+
+		WeakArray<RadixSortPair> sorted;
+		ThreadHiveSemaphore* doneSemaphore;
+		radixSort(hive, tmpAlloc, WeakArray<RadixSortPair>(&pairs[0], RENDERABLE_COUNT),
+				  WeakArray<RadixSortPair>(&scratch[0], RENDERABLE_COUNT), sorted, doneSemaphore);
+		hive.waitAllTasks();
+
+		for(U32 i = 0; i < RENDERABLE_COUNT; ++i)
+		{
+			renderables[i] = unsorted[sorted[i].m_index];
+		}
+
+		tmpAlloc.getMemoryPool().reset();
+	});
+
+	bench.consume(renderables[0].m_mergeKey);
+}
@@ -0,0 +1,97 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/scene/SoftwareRasterizer.h>
+#include <anki/Collision.h>
+
+namespace anki
+{
+
+static const U32 OCCLUDER_COUNT = 64;
+static const U32 BUFFER_WIDTH = 256;
+static const U32 BUFFER_HEIGHT = 128;
+
+/// Quads (2 triangles each) facing the camera at various distances. That is what the occluders of a scene look like.
+static void generateOccluders(std::vector<Vec4>& verts)
+{
+	verts.resize(OCCLUDER_COUNT * 6);
+	for(U32 i = 0; i < OCCLUDER_COUNT; ++i)
+	{
+		const Vec2 center(getRandomRange(-40.0f, 40.0f), getRandomRange(-10.0f, 10.0f));
+		const F32 z = -getRandomRange(5.0f, 100.0f);
+		const F32 size = getRandomRange(1.0f, 8.0f);
+
+		const Vec4 a(center.x() - size, center.y() - size, z, 1.0f);
+		const Vec4 b(center.x() + size, center.y() - size, z, 1.0f);
+		const Vec4 c(center.x() + size, center.y() + size, z, 1.0f);
+		const Vec4 d(center.x() - size, center.y() + size, z, 1.0f);
+
+		Vec4* quad = &verts[i * 6];
+		quad[0] = a;
+		quad[1] = b;
+		quad[2] = c;
+		quad[3] = a;
+		quad[4] = c;
+		quad[5] = d;
+	}
+}
+
+static void generateTestVolumes(std::vector<Aabb>& volumes)
+{
+	volumes.resize(4 * 1024);
+	for(Aabb& volume : volumes)
+	{
+		const Vec3 center(getRandomRange(-50.0f, 50.0f), getRandomRange(-15.0f, 15.0f), -getRandomRange(5.0f, 150.0f));
+		const F32 extend = getRandomRange(0.25f, 3.0f);
+		volume = Aabb((center - extend).xyz0(), (center + extend).xyz0());
+	}
+}
+
+static Mat4 computeProjectionMatrix()
+{
+	return Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(60.0f), 0.1f, 200.0f);
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Scene, SoftwareRasterizerDraw)
+{
+	std::vector<Vec4> verts;
+	generateOccluders(verts);
+
+	SoftwareRasterizer rasterizer;
+	rasterizer.init(bench.m_alloc);
+	const Mat4 proj = computeProjectionMatrix();
+
+	bench.setItemsPerIteration(verts.size() / 3);
+	bench.measure([&]() {
+		rasterizer.prepare(Mat4::getIdentity(), proj, BUFFER_WIDTH, BUFFER_HEIGHT);
+		rasterizer.draw(&verts[0][0], U(verts.size()), sizeof(Vec4), false);
+	});
+}
+
+ANKI_BENCHMARK(Scene, SoftwareRasterizerVisibilityTest)
+{
+	std::vector<Vec4> verts;
+	generateOccluders(verts);
+	std::vector<Aabb> volumes;
+	generateTestVolumes(volumes);
+
+	SoftwareRasterizer rasterizer;
+	rasterizer.init(bench.m_alloc);
+	rasterizer.prepare(Mat4::getIdentity(), computeProjectionMatrix(), BUFFER_WIDTH, BUFFER_HEIGHT);
+	rasterizer.draw(&verts[0][0], U(verts.size()), sizeof(Vec4), false);
+
+	bench.setItemsPerIteration(volumes.size());
+	bench.measure([&]() {
+		U64 visibleCount = 0;
+		for(const Aabb& volume : volumes)
+		{
+			visibleCount += rasterizer.visibilityTest(volume);
+		}
+		bench.consume(visibleCount);
+	});
+}
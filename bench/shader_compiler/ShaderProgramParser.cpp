@@ -0,0 +1,119 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/shader_compiler/ShaderProgramParser.h>
+
+namespace anki
+{
+
+static const char* PROGRAM_SOURCE = R"(
+#pragma anki mutator INSTANCE_COUNT 1 2 4 8 16 32 64
+#pragma anki mutator LOD 0 1 2
+#pragma anki mutator PASS 0 1 2 3
+#pragma anki mutator BONES 0 1
+#pragma anki mutator DIFFUSE_TEX 0 1
+#pragma anki mutator NORMAL_TEX 0 1
+
+#pragma anki rewrite_mutation PASS 1 DIFFUSE_TEX 1 to PASS 1 DIFFUSE_TEX 0
+
+#include <Common.glsl>
+
+#pragma anki start vert
+layout(location = 0) in Vec3 in_position;
+layout(location = 1) in Vec2 in_uv;
+layout(location = 0) out Vec2 out_uv;
+
+void main()
+{
+#if BONES
+	const Vec3 pos = skin(in_position);
+#else
+	const Vec3 pos = in_position;
+#endif
+	out_uv = in_uv;
+	gl_Position = u_mvp[gl_InstanceID] * Vec4(pos, 1.0);
+}
+#pragma anki end
+
+#pragma anki start frag
+layout(location = 0) in Vec2 in_uv;
+layout(location = 0) out Vec4 out_color;
+
+void main()
+{
+#if DIFFUSE_TEX
+	out_color = texture(u_diffuse, in_uv);
+#else
+	out_color = Vec4(1.0);
+#endif
+#if NORMAL_TEX && PASS == 0
+	out_color.xyz *= texture(u_normal, in_uv).xyz;
+#endif
+}
+#pragma anki end
+)";
+
+static const char* INCLUDE_SOURCE = R"(
+#pragma once
+
+#define Vec2 vec2
+#define Vec3 vec3
+#define Vec4 vec4
+#define Mat4 mat4
+
+layout(set = 0, binding = 0) uniform b_ubo
+{
+	Mat4 u_mvp[INSTANCE_COUNT];
+};
+
+layout(set = 0, binding = 1) uniform sampler2D u_diffuse;
+layout(set = 0, binding = 2) uniform sampler2D u_normal;
+
+Vec3 skin(Vec3 pos)
+{
+	return pos;
+}
+)";
+
+class BenchFilesystemInterface : public ShaderProgramFilesystemInterface
+{
+public:
+	Error readAllText(CString filename, StringAuto& txt) final
+	{
+		txt = (filename == "Common.glsl") ? INCLUDE_SOURCE : PROGRAM_SOURCE;
+		return Error::NONE;
+	}
+};
+
+} // end namespace anki
+
+ANKI_BENCHMARK(ShaderCompiler, ShaderProgramParserParse)
+{
+	BenchFilesystemInterface iface;
+	GpuDeviceCapabilities gpuCapabilities;
+	BindlessLimits bindlessLimits;
+
+	bench.measure([&]() {
+		ShaderProgramParser parser("Program.ankiprog", &iface, bench.m_alloc, gpuCapabilities, bindlessLimits);
+		ANKI_BENCH_CHECK(parser.parse());
+	});
+}
+
+ANKI_BENCHMARK(ShaderCompiler, ShaderProgramParserGenerateVariant)
+{
+	BenchFilesystemInterface iface;
+	GpuDeviceCapabilities gpuCapabilities;
+	BindlessLimits bindlessLimits;
+	ShaderProgramParser parser("Program.ankiprog", &iface, bench.m_alloc, gpuCapabilities, bindlessLimits);
+	ANKI_BENCH_CHECK(parser.parse());
+
+	const Array<MutatorValue, 6> mutation = {{16, 1, 0, 1, 1, 1}};
+	bench.measure([&]() {
+		ShaderProgramParserVariant variant;
+		ANKI_BENCH_CHECK(parser.generateVariant(mutation, variant));
+		bench.consume(variant.getSource(ShaderType::FRAGMENT).getLength());
+	});
+}
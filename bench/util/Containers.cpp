@@ -0,0 +1,118 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/SparseArray.h>
+#include <anki/util/Functions.h>
+
+namespace anki
+{
+
+static const U32 ELEMENT_COUNT = 16 * 1024;
+
+/// Unique random keys. The resource and shader caches use hashes as keys so random U64s are representative.
+static void generateKeys(std::vector<U64>& keys)
+{
+	keys.resize(ELEMENT_COUNT);
+	for(U32 i = 0; i < ELEMENT_COUNT; ++i)
+	{
+		keys[i] = (getRandom() << 16) | i;
+	}
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Util, HashMapInsertErase)
+{
+	std::vector<U64> keys;
+	generateKeys(keys);
+
+	HashMapAuto<U64, U64> map(bench.m_alloc);
+
+	bench.setItemsPerIteration(ELEMENT_COUNT * 2);
+	bench.measure([&]() {
+		for(U64 key : keys)
+		{
+			map.emplace(key, key);
+		}
+
+		for(U64 key : keys)
+		{
+			map.erase(map.find(key));
+		}
+	});
+}
+
+ANKI_BENCHMARK(Util, HashMapFind)
+{
+	std::vector<U64> keys;
+	generateKeys(keys);
+
+	HashMapAuto<U64, U64> map(bench.m_alloc);
+	for(U32 i = 0; i < ELEMENT_COUNT / 2; ++i)
+	{
+		map.emplace(keys[i], keys[i]);
+	}
+
+	// Half of the lookups will miss
+	bench.setItemsPerIteration(ELEMENT_COUNT);
+	bench.measure([&]() {
+		U64 sum = 0;
+		for(U64 key : keys)
+		{
+			auto it = map.find(key);
+			sum += (it != map.getEnd()) ? *it : 1;
+		}
+		bench.consume(sum);
+	});
+}
+
+ANKI_BENCHMARK(Util, SparseArrayInsertErase)
+{
+	std::vector<U64> keys;
+	generateKeys(keys);
+
+	SparseArray<U64, U64> arr;
+
+	bench.setItemsPerIteration(ELEMENT_COUNT * 2);
+	bench.measure([&]() {
+		for(U64 key : keys)
+		{
+			arr.emplace(bench.m_alloc, key, key);
+		}
+
+		for(U64 key : keys)
+		{
+			arr.erase(bench.m_alloc, arr.find(key));
+		}
+	});
+
+	arr.destroy(bench.m_alloc);
+}
+
+ANKI_BENCHMARK(Util, SparseArrayIterate)
+{
+	std::vector<U64> keys;
+	generateKeys(keys);
+
+	SparseArray<U64, U64> arr;
+	for(U64 key : keys)
+	{
+		arr.emplace(bench.m_alloc, key, key);
+	}
+
+	bench.setItemsPerIteration(ELEMENT_COUNT);
+	bench.measure([&]() {
+		U64 sum = 0;
+		for(U64 v : arr)
+		{
+			sum += v;
+		}
+		bench.consume(sum);
+	});
+
+	arr.destroy(bench.m_alloc);
+}
@@ -0,0 +1,89 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/util/Memory.h>
+#include <anki/util/Functions.h>
+
+namespace anki
+{
+
+static const U32 ALLOCATION_COUNT = 4096;
+
+/// Random sizes that resemble the allocations of a frame.
+static void generateAllocationSizes(Array<PtrSize, ALLOCATION_COUNT>& sizes)
+{
+	for(PtrSize& size : sizes)
+	{
+		size = (getRandom() % 8 == 0) ? getRandomRange<PtrSize>(1024, 16 * 1024) : getRandomRange<PtrSize>(8, 256);
+	}
+}
+
+template<typename TPool>
+static void allocateAndFree(TPool& pool, const Array<PtrSize, ALLOCATION_COUNT>& sizes,
+							Array<void*, ALLOCATION_COUNT>& ptrs, Benchmark& bench)
+{
+	for(U32 i = 0; i < ALLOCATION_COUNT; ++i)
+	{
+		ptrs[i] = pool.allocate(sizes[i], 16);
+	}
+
+	bench.consume(ptrToNumber(ptrs[ALLOCATION_COUNT - 1]));
+
+	for(U32 i = 0; i < ALLOCATION_COUNT; ++i)
+	{
+		pool.free(ptrs[i]);
+	}
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Util, HeapMemoryPool)
+{
+	Array<PtrSize, ALLOCATION_COUNT> sizes;
+	generateAllocationSizes(sizes);
+	Array<void*, ALLOCATION_COUNT> ptrs;
+
+	HeapMemoryPool pool;
+	pool.create(allocAligned, nullptr);
+
+	bench.setItemsPerIteration(ALLOCATION_COUNT);
+	bench.measure([&]() { allocateAndFree(pool, sizes, ptrs, bench); });
+}
+
+ANKI_BENCHMARK(Util, StackMemoryPool)
+{
+	Array<PtrSize, ALLOCATION_COUNT> sizes;
+	generateAllocationSizes(sizes);
+	Array<void*, ALLOCATION_COUNT> ptrs;
+
+	StackMemoryPool pool;
+	pool.create(allocAligned, nullptr, 1024 * 1024);
+
+	// Frame allocator usage: allocate and then reset
+	bench.setItemsPerIteration(ALLOCATION_COUNT);
+	bench.measure([&]() {
+		for(U32 i = 0; i < ALLOCATION_COUNT; ++i)
+		{
+			ptrs[i] = pool.allocate(sizes[i], 16);
+		}
+
+		bench.consume(ptrToNumber(ptrs[ALLOCATION_COUNT - 1]));
+		pool.reset();
+	});
+}
+
+ANKI_BENCHMARK(Util, ChainMemoryPool)
+{
+	Array<PtrSize, ALLOCATION_COUNT> sizes;
+	generateAllocationSizes(sizes);
+	Array<void*, ALLOCATION_COUNT> ptrs;
+
+	ChainMemoryPool pool;
+	pool.create(allocAligned, nullptr, 1024 * 1024);
+
+	bench.setItemsPerIteration(ALLOCATION_COUNT);
+	bench.measure([&]() { allocateAndFree(pool, sizes, ptrs, bench); });
+}
@@ -0,0 +1,112 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/util/Serializer.h>
+#include <anki/shader_compiler/ShaderProgramBinary.h>
+
+namespace anki
+{
+
+static const CString SERIALIZED_FILENAME = "bench_serialized.bin";
+
+/// A program binary that looks like a material with a few mutators. The binary is the most common serialized type.
+class SerializerProgramBinary
+{
+public:
+	static const U32 MUTATION_COUNT = 256;
+	static const U32 CODE_BLOCK_COUNT = 64;
+	static const U32 CODE_BLOCK_SIZE = 8 * 1024;
+
+	ShaderProgramBinary m_binary;
+	std::vector<ShaderProgramBinaryCodeBlock> m_codeBlocks;
+	std::vector<std::vector<U8>> m_code;
+	std::vector<ShaderProgramBinaryVariant> m_variants;
+	std::vector<ShaderProgramBinaryMutation> m_mutations;
+	std::vector<MutatorValue> m_mutationValues;
+
+	SerializerProgramBinary()
+	{
+		m_code.resize(CODE_BLOCK_COUNT);
+		m_codeBlocks.resize(CODE_BLOCK_COUNT);
+		for(U32 i = 0; i < CODE_BLOCK_COUNT; ++i)
+		{
+			m_code[i].resize(CODE_BLOCK_SIZE);
+			for(U8& byte : m_code[i])
+			{
+				byte = U8(getRandom());
+			}
+
+			m_codeBlocks[i].m_binary = WeakArray<U8>(&m_code[i][0], CODE_BLOCK_SIZE);
+			m_codeBlocks[i].m_hash = getRandom();
+		}
+
+		m_variants.resize(CODE_BLOCK_COUNT / 2);
+		for(U32 i = 0; i < m_variants.size(); ++i)
+		{
+			for(U32& idx : m_variants[i].m_codeBlockIndices)
+			{
+				idx = MAX_U32;
+			}
+			m_variants[i].m_codeBlockIndices[ShaderType::VERTEX] = i * 2;
+			m_variants[i].m_codeBlockIndices[ShaderType::FRAGMENT] = i * 2 + 1;
+		}
+
+		m_mutationValues.resize(MUTATION_COUNT * 4);
+		m_mutations.resize(MUTATION_COUNT);
+		for(U32 i = 0; i < MUTATION_COUNT; ++i)
+		{
+			for(U32 j = 0; j < 4; ++j)
+			{
+				m_mutationValues[i * 4 + j] = MutatorValue((i >> (j * 2)) & 3);
+			}
+
+			m_mutations[i].m_values = WeakArray<MutatorValue>(&m_mutationValues[i * 4], 4);
+			m_mutations[i].m_variantIndex = i % m_variants.size();
+			m_mutations[i].m_hash = i;
+		}
+
+		m_binary.m_codeBlocks = WeakArray<ShaderProgramBinaryCodeBlock>(&m_codeBlocks[0], CODE_BLOCK_COUNT);
+		m_binary.m_variants = WeakArray<ShaderProgramBinaryVariant>(&m_variants[0], U32(m_variants.size()));
+		m_binary.m_mutations = WeakArray<ShaderProgramBinaryMutation>(&m_mutations[0], MUTATION_COUNT);
+		m_binary.m_presentShaderTypes = ShaderTypeBit::VERTEX | ShaderTypeBit::FRAGMENT;
+	}
+};
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Util, BinarySerializer)
+{
+	SerializerProgramBinary program;
+
+	bench.measure([&]() {
+		File file;
+		ANKI_BENCH_CHECK(file.open(SERIALIZED_FILENAME, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_BENCH_CHECK(serializer.serialize(program.m_binary, bench.m_alloc, file));
+	});
+}
+
+ANKI_BENCHMARK(Util, BinaryDeserializer)
+{
+	{
+		SerializerProgramBinary program;
+		File file;
+		ANKI_BENCH_CHECK(file.open(SERIALIZED_FILENAME, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_BENCH_CHECK(serializer.serialize(program.m_binary, bench.m_alloc, file));
+	}
+
+	File file;
+	ANKI_BENCH_CHECK(file.open(SERIALIZED_FILENAME, FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+	bench.measure([&]() {
+		ANKI_BENCH_CHECK(file.seek(0, FileSeekOrigin::BEGINNING));
+		ShaderProgramBinary* binary;
+		ANKI_BENCH_CHECK(BinaryDeserializer::deserialize(binary, bench.m_alloc, file));
+		bench.consume(binary->m_codeBlocks.getSize());
+		bench.m_alloc.deleteInstance(binary);
+	});
+}
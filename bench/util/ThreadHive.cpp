@@ -0,0 +1,86 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <bench/framework/Framework.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/Atomic.h>
+
+namespace anki
+{
+
+/// The hive allocates the submitted tasks from a small stack allocator so submit in batches, like the engine does.
+static const U32 SUBMIT_BATCH_SIZE = 32;
+
+/// Some work that takes roughly the same time on every task.
+static U64 smallWork(U64 seed)
+{
+	U64 x = seed;
+	for(U32 i = 0; i < 64; ++i)
+	{
+		x = x * 6364136223846793005ull + 1442695040888963407ull;
+	}
+	return x;
+}
+
+} // end namespace anki
+
+ANKI_BENCHMARK(Util, ThreadHiveIndependentTasks)
+{
+	ThreadHive hive(bench.getThreadCount(), bench.m_alloc, true);
+
+	const U32 taskCount = 4096;
+	Atomic<U64> result = {0};
+	std::vector<ThreadHiveTask> tasks(taskCount);
+	for(ThreadHiveTask& task : tasks)
+	{
+		task = ANKI_THREAD_HIVE_TASK({ self->fetchAdd(smallWork(threadId)); }, &result, nullptr, nullptr);
+	}
+
+	bench.setItemsPerIteration(taskCount);
+	bench.measure([&]() {
+		for(U32 i = 0; i < taskCount; i += SUBMIT_BATCH_SIZE)
+		{
+			hive.submitTasks(&tasks[i], SUBMIT_BATCH_SIZE);
+		}
+		hive.waitAllTasks();
+	});
+
+	bench.consume(result.load());
+}
+
+ANKI_BENCHMARK(Util, ThreadHiveDependentTasks)
+{
+	ThreadHive hive(bench.getThreadCount(), bench.m_alloc, true);
+
+	// Waves of tasks where every wave depends on the previous one. That's how the scene and the renderer use the hive
+	const U32 waveCount = 16;
+	const U32 tasksPerWave = 256;
+	Atomic<U64> result = {0};
+
+	bench.setItemsPerIteration(waveCount * tasksPerWave);
+	bench.measure([&]() {
+		ThreadHiveSemaphore* waitSem = nullptr;
+		for(U32 wave = 0; wave < waveCount; ++wave)
+		{
+			ThreadHiveSemaphore* signalSem = (wave + 1 < waveCount) ? hive.newSemaphore(tasksPerWave) : nullptr;
+
+			Array<ThreadHiveTask, tasksPerWave> tasks;
+			for(ThreadHiveTask& task : tasks)
+			{
+				task = ANKI_THREAD_HIVE_TASK({ self->fetchAdd(smallWork(threadId)); }, &result, waitSem, signalSem);
+			}
+
+			for(U32 i = 0; i < tasksPerWave; i += SUBMIT_BATCH_SIZE)
+			{
+				hive.submitTasks(&tasks[i], SUBMIT_BATCH_SIZE);
+			}
+			waitSem = signalSem;
+		}
+
+		hive.waitAllTasks();
+	});
+
+	bench.consume(result.load());
+}
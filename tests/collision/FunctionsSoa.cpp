@@ -0,0 +1,133 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Collision.h>
+
+namespace anki
+{
+
+static const U32 VOLUME_COUNT = 70; // More than 64 to use 2 mask words and not a multiple of 4
+
+/// Coordinates on a coarse grid so that a good number of the volumes just touch.
+static F32 randomCoord()
+{
+	return F32(I32(getRandomRange(-16.0f, 16.0f))) * 0.5f;
+}
+
+static Vec4 randomPoint()
+{
+	return Vec4(randomCoord(), randomCoord(), randomCoord(), 0.0f);
+}
+
+/// Run a kernel for a few ranges and compare with the results of the scalar function.
+template<typename TKernel, typename TScalar>
+static void testKernel(TKernel kernel, TScalar scalar)
+{
+	const Array<Array<U32, 2>, 4> ranges = {{{0, VOLUME_COUNT}, {3, 9}, {5, 6}, {62, 67}}};
+	for(const Array<U32, 2>& range : ranges)
+	{
+		Array<U64, 2> mask = {0xAAAAAAAAAAAAAAAAull, 0x5555555555555555ull};
+		const Array<U64, 2> initialMask = mask;
+		kernel(range[0], range[1], WeakArray<U64>(mask));
+
+		for(U32 i = 0; i < VOLUME_COUNT; ++i)
+		{
+			const Bool set = (mask[i / 64] & (U64(1) << U64(i % 64))) != 0;
+			if(i >= range[0] && i < range[1])
+			{
+				ANKI_TEST_EXPECT_EQ(set, scalar(i));
+			}
+			else
+			{
+				// Untouched
+				ANKI_TEST_EXPECT_EQ(set, (initialMask[i / 64] & (U64(1) << U64(i % 64))) != 0);
+			}
+		}
+	}
+}
+
+ANKI_TEST(Collision, FunctionsSoa)
+{
+	// Create the volumes. Pad them to a multiple of 4
+	const U32 paddedCount = getAlignedRoundUp(4, VOLUME_COUNT);
+	Array<std::vector<F32>, 6> boxesSoa;
+	Array<std::vector<F32>, 4> spheresSoa;
+	std::vector<Aabb> boxes;
+	std::vector<Sphere> spheres;
+	for(U32 i = 0; i < VOLUME_COUNT; ++i)
+	{
+		const Vec4 a = randomPoint();
+		const Vec4 size(getRandomRange(1.0f, 4.0f), getRandomRange(1.0f, 4.0f), getRandomRange(1.0f, 4.0f), 0.0f);
+		boxes.push_back(Aabb(a, a + size));
+		spheres.push_back(Sphere(randomPoint(), F32(U32(getRandomRange(1.0f, 8.0f))) * 0.5f));
+	}
+
+	for(U32 i = 0; i < 3; ++i)
+	{
+		boxesSoa[i].resize(paddedCount, 0.0f);
+		boxesSoa[i + 3].resize(paddedCount, 0.0f);
+		spheresSoa[i].resize(paddedCount, 0.0f);
+		for(U32 v = 0; v < VOLUME_COUNT; ++v)
+		{
+			boxesSoa[i][v] = boxes[v].getMin()[i];
+			boxesSoa[i + 3][v] = boxes[v].getMax()[i];
+			spheresSoa[i][v] = spheres[v].getCenter()[i];
+		}
+	}
+
+	spheresSoa[3].resize(paddedCount, 0.0f);
+	for(U32 v = 0; v < VOLUME_COUNT; ++v)
+	{
+		spheresSoa[3][v] = spheres[v].getRadius();
+	}
+
+	AabbSoa boxesView;
+	SphereSoa spheresView;
+	for(U32 i = 0; i < 3; ++i)
+	{
+		boxesView.m_min[i] = &boxesSoa[i][0];
+		boxesView.m_max[i] = &boxesSoa[i + 3][0];
+		spheresView.m_center[i] = &spheresSoa[i][0];
+	}
+	spheresView.m_radius = &spheresSoa[3][0];
+
+	for(U32 iteration = 0; iteration < 50; ++iteration)
+	{
+		// Sphere vs AABBs
+		const Sphere sphere(randomPoint(), F32(U32(getRandomRange(1.0f, 8.0f))) * 0.5f);
+		testKernel(
+			[&](U32 begin, U32 end, WeakArray<U64> mask) {
+				testCollisionSoa(sphere, boxesView, begin, end, mask);
+			},
+			[&](U32 i) {
+				return testCollision(boxes[i], sphere);
+			});
+
+		// AABB vs AABBs
+		const Vec4 a = randomPoint();
+		const Aabb aabb(a, a + Vec4(getRandomRange(1.0f, 4.0f), getRandomRange(1.0f, 4.0f), 1.0f, 0.0f));
+		testKernel(
+			[&](U32 begin, U32 end, WeakArray<U64> mask) {
+				testCollisionSoa(aabb, boxesView, begin, end, mask);
+			},
+			[&](U32 i) {
+				return testCollision(aabb, boxes[i]);
+			});
+
+		// Cone vs spheres
+		const Vec4 dir = Vec4(getRandomRange(-1.0f, 1.0f), getRandomRange(-1.0f, 1.0f), 1.0f, 0.0f).getNormalized();
+		const Cone cone(randomPoint(), dir, getRandomRange(1.0f, 20.0f), toRad(getRandomRange(10.0f, 90.0f)));
+		testKernel(
+			[&](U32 begin, U32 end, WeakArray<U64> mask) {
+				testCollisionSoa(cone, spheresView, begin, end, mask);
+			},
+			[&](U32 i) {
+				return testCollision(spheres[i], cone);
+			});
+	}
+}
+
+} // end namespace anki
@@ -179,6 +179,13 @@ Options:
 		}
 	}
 
+	if(run == 0)
+	{
+		// Don't let a test that was renamed or compiled out pass silently
+		std::cout << "No tests matched" << std::endl;
+		return 1;
+	}
+
 	int failed = run - passed;
 	std::cout << "========\nRun " << run << " tests, failed " << failed << std::endl;
 
@@ -8,12 +8,15 @@
 #include <anki/core/NativeWindow.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/HighRezTimer.h>
+#include <anki/util/Filesystem.h>
 #include <anki/core/StagingGpuMemoryManager.h>
 #include <anki/resource/TransferGpuAllocator.h>
 #include <anki/shader_compiler/Glslang.h>
 #include <anki/shader_compiler/ShaderProgramParser.h>
 #include <anki/collision/Aabb.h>
 #include <ctime>
+#include <cstdio>
+#include <algorithm>
 
 namespace anki
 {
@@ -298,6 +301,7 @@ static StagingGpuMemoryManager* stagingMem = nullptr;
 	cfg.set("gr_vsync", false); \
 	cfg.set("gr_rayTracing", true); \
 	cfg.set("gr_debugMarkers", true); \
+	cfg.set("gr_pipelineCreationThreadCount", 0); \
 	win = createWindow(cfg); \
 	gr = createGrManager(cfg, win); \
 	ANKI_TEST_EXPECT_NO_ERR(stagingMem->init(gr, cfg)); \
@@ -752,6 +756,104 @@ ANKI_TEST(Gr, Buffer)
 	COMMON_END()
 }
 
+ANKI_TEST(Gr, StagingGpuMemory)
+{
+	COMMON_BEGIN()
+
+	const U32 BUSY_FRAME_COUNT = 5;
+	const U32 TUNE_FRAME_COUNT = 4;
+
+	// A manager with little memory that has to grow
+	ConfigSet smallCfg = DefaultConfigSet::get();
+	smallCfg.set("core_uniformPerFrameMemorySize", 1_MB);
+	smallCfg.set("core_stagingMemoryTuneFrameCount", TUNE_FRAME_COUNT);
+	StagingGpuMemoryManager* smallStagingMem = new StagingGpuMemoryManager();
+	ANKI_TEST_EXPECT_NO_ERR(smallStagingMem->init(gr, smallCfg));
+
+	class Allocation
+	{
+	public:
+		const Buffer* m_buffer;
+		PtrSize m_begin;
+		PtrSize m_end;
+
+		Bool operator<(const Allocation& b) const
+		{
+			return (m_buffer != b.m_buffer) ? m_buffer < b.m_buffer : m_begin < b.m_begin;
+		}
+	};
+
+	class ThreadCtx
+	{
+	public:
+		StagingGpuMemoryManager* m_stagingMem;
+		U32 m_allocationCount;
+		std::vector<Allocation> m_allocations;
+	};
+
+	const U32 THREAD_COUNT = 4;
+	for(U32 frame = 0; frame < BUSY_FRAME_COUNT + TUNE_FRAME_COUNT + MAX_FRAMES_IN_FLIGHT + 2; ++frame)
+	{
+		// Many allocations in the first frames and then a few to see the memory shrinking
+		Array<ThreadCtx, THREAD_COUNT> ctxs;
+		Array<Thread*, THREAD_COUNT> threads;
+		for(U32 t = 0; t < THREAD_COUNT; ++t)
+		{
+			ctxs[t].m_stagingMem = smallStagingMem;
+			ctxs[t].m_allocationCount = (frame < BUSY_FRAME_COUNT) ? 4000 : 100;
+			threads[t] = new Thread("Staging");
+			threads[t]->start(&ctxs[t], [](ThreadCallbackInfo& info) -> Error {
+				ThreadCtx& ctx = *static_cast<ThreadCtx*>(info.m_userData);
+				for(U32 i = 0; i < ctx.m_allocationCount; ++i)
+				{
+					const PtrSize size = (i % 64 == 0) ? 10_KB : (i % 16 + 1) * 16;
+					StagingGpuMemoryToken token;
+					void* mem = ctx.m_stagingMem->allocateFrame(size, StagingGpuMemoryType::UNIFORM, token);
+					memset(mem, 0xAB, size);
+					ctx.m_allocations.push_back({token.m_buffer.get(), token.m_offset, token.m_offset + token.m_range});
+				}
+				return Error::NONE;
+			});
+		}
+
+		std::vector<Allocation> all;
+		for(U32 t = 0; t < THREAD_COUNT; ++t)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(threads[t]->join());
+			delete threads[t];
+			all.insert(all.end(), ctxs[t].m_allocations.begin(), ctxs[t].m_allocations.end());
+		}
+
+		// No allocation should overlap with another
+		std::sort(all.begin(), all.end());
+		for(U32 i = 1; i < all.size(); ++i)
+		{
+			if(all[i].m_buffer == all[i - 1].m_buffer)
+			{
+				ANKI_TEST_EXPECT_LEQ(all[i - 1].m_end, all[i].m_begin);
+			}
+		}
+
+		smallStagingMem->endFrame();
+
+		const StagingGpuMemoryStats& stats = smallStagingMem->getStats();
+		ANKI_TEST_EXPECT_GEQ(stats.m_allocatedMemory[StagingGpuMemoryType::UNIFORM],
+							 stats.m_usedMemory[StagingGpuMemoryType::UNIFORM]);
+		ANKI_TEST_EXPECT_GEQ(stats.m_highWaterMark[StagingGpuMemoryType::UNIFORM],
+							 stats.m_usedMemory[StagingGpuMemoryType::UNIFORM]);
+
+		if(frame >= BUSY_FRAME_COUNT + TUNE_FRAME_COUNT + MAX_FRAMES_IN_FLIGHT)
+		{
+			// The memory went back to the initial size
+			ANKI_TEST_EXPECT_LEQ(stats.m_allocatedMemory[StagingGpuMemoryType::UNIFORM], 1_MB);
+		}
+	}
+
+	delete smallStagingMem;
+
+	COMMON_END()
+}
+
 ANKI_TEST(Gr, DrawWithUniforms)
 {
 	COMMON_BEGIN()
@@ -3508,4 +3610,131 @@ void main()
 	COMMON_END();
 }
 
+static const char* FRAG_COUNT_SRC = R"(layout(location = 0) out vec4 out_color;
+
+layout(set = 0, binding = 0) buffer b_ss
+{
+	uint u_fragmentCount;
+};
+
+void main()
+{
+	atomicAdd(u_fragmentCount, 1u);
+	out_color = vec4(1.0);
+})";
+
+/// Draw a triangle that covers one pixel and return the number of the fragments that got shaded. It's zero if the
+/// drawcall was skipped because the pipeline was not ready.
+static U32 drawOneFragment(GrManager& gr, ShaderProgramPtr prog, TexturePtr tex, FramebufferPtr fb, BufferPtr counter)
+{
+	CommandBufferInitInfo cinit;
+	cinit.m_flags = CommandBufferFlag::GRAPHICS_WORK;
+	CommandBufferPtr cmdb = gr.newCommandBuffer(cinit);
+
+	cmdb->fillBuffer(counter, 0, sizeof(U32), 0);
+	cmdb->setBufferBarrier(counter, BufferUsageBit::TRANSFER_DESTINATION, BufferUsageBit::STORAGE_FRAGMENT_WRITE, 0,
+						   MAX_PTR_SIZE);
+	cmdb->setTextureSurfaceBarrier(tex, TextureUsageBit::NONE, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE,
+								   TextureSurfaceInfo(0, 0, 0, 0));
+
+	cmdb->beginRenderPass(fb, {{TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE}}, {});
+	cmdb->setViewport(0, 0, 1, 1);
+	cmdb->bindShaderProgram(prog);
+	cmdb->bindStorageBuffer(0, 0, counter, 0, MAX_PTR_SIZE);
+	cmdb->drawArrays(PrimitiveTopology::TRIANGLES, 3);
+	cmdb->endRenderPass();
+
+	FencePtr fence;
+	cmdb->flush(&fence);
+	ANKI_TEST_EXPECT_EQ(fence->clientWait(10.0), true);
+
+	const U32 count = *static_cast<const U32*>(counter->map(0, sizeof(U32), BufferMapAccessBit::READ));
+	counter->unmap();
+
+	// The command buffer knows if it dropped the drawcall
+	ANKI_TEST_EXPECT_EQ(cmdb->getSkippedDrawcallCount(), (count == 0) ? 1u : 0u);
+	return count;
+}
+
+/// Create a GrManager with some pipeline creation threads and draw until the pipeline of a program is ready. Returns
+/// the number of drawcalls that were skipped.
+static U32 drawUntilPipelineIsReady(U32 pipelineCreationThreadCount, Bool waitForWarmup)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	cfg.set("width", WIDTH);
+	cfg.set("height", HEIGHT);
+	cfg.set("gr_debugContext", true);
+	cfg.set("gr_pipelineCreationThreadCount", pipelineCreationThreadCount);
+	cfg.set("gr_pipelineManifest", true);
+	win = createWindow(cfg);
+	gr = createGrManager(cfg, win);
+
+	U32 skippedDrawcallCount = 0;
+	{
+		TextureInitInfo texInit;
+		texInit.m_format = Format::R8G8B8A8_UNORM;
+		texInit.m_usage = TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT;
+		texInit.m_width = texInit.m_height = 4;
+		TexturePtr tex = gr->newTexture(texInit);
+		FramebufferPtr fb = createColorFb(*gr, tex);
+
+		BufferPtr counter = gr->newBuffer(BufferInitInfo(sizeof(U32), BufferUsageBit::ALL_STORAGE
+																		  | BufferUsageBit::TRANSFER_DESTINATION,
+														 BufferMapAccessBit::READ));
+
+		ShaderProgramPtr prog = createProgram(VERT_SRC, FRAG_COUNT_SRC, *gr);
+		if(waitForWarmup)
+		{
+			// Wait for the warmup jobs of the program to finish
+			gr->finish();
+		}
+
+		const U32 MAX_ITERATIONS = 1000;
+		U32 count = 0;
+		while(count == 0 && skippedDrawcallCount < MAX_ITERATIONS)
+		{
+			count = drawOneFragment(*gr, prog, tex, fb, counter);
+			if(count == 0)
+			{
+				++skippedDrawcallCount;
+				HighRezTimer::sleep(0.001);
+			}
+		}
+
+		// The pipeline got created and the drawcalls are not skipped any more
+		ANKI_TEST_EXPECT_EQ(count, 1);
+		ANKI_TEST_EXPECT_EQ(drawOneFragment(*gr, prog, tex, fb, counter), 1);
+
+		// Start creating a pipeline and delete its program while the job might be queued or running
+		ShaderProgramPtr otherProg = createProgram(VERT_QUAD_SRC, FRAG_COUNT_SRC, *gr);
+		drawOneFragment(*gr, otherProg, tex, fb, counter);
+	}
+
+	gr->finish();
+	GrManager::deleteInstance(gr);
+	delete win;
+	win = nullptr;
+	gr = nullptr;
+	return skippedDrawcallCount;
+}
+
+ANKI_TEST(Gr, PipelineCreation)
+{
+	const CString manifestFilename = ".//vk_pipeline_manifest";
+	std::remove(manifestFilename.cstr());
+
+	// Synchronous creation never skips drawcalls
+	ANKI_TEST_EXPECT_EQ(drawUntilPipelineIsReady(0, false), 0);
+	ANKI_TEST_EXPECT_EQ(fileExists(manifestFilename), true);
+
+	// Background creation skips the drawcalls until the pipeline is ready
+	std::remove(manifestFilename.cstr());
+	ANKI_TEST_EXPECT_GT(drawUntilPipelineIsReady(2, false), 0);
+	ANKI_TEST_EXPECT_EQ(fileExists(manifestFilename), true);
+
+	// The manifest of the previous run creates the pipeline when the program is created. It's ready before the first
+	// drawcall
+	ANKI_TEST_EXPECT_EQ(drawUntilPipelineIsReady(2, true), 0);
+}
+
 } // end namespace anki
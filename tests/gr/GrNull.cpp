@@ -0,0 +1,630 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Gr.h>
+#include <anki/core/ConfigSet.h>
+
+#if ANKI_GR_BACKEND_NULL
+#	include <anki/gr/null/GrManagerImpl.h>
+#	include <anki/gr/null/CommandBufferImpl.h>
+
+namespace anki
+{
+
+static void recordFrame(GrManager& gr, BufferPtr& src, BufferPtr& dst, OcclusionQueryPtr& query,
+						TimestampQueryPtr& timestamp)
+{
+	CommandBufferInitInfo cinit;
+	cinit.m_flags = CommandBufferFlag::TRANSFER_WORK | CommandBufferFlag::SMALL_BATCH;
+	CommandBufferPtr cmdb = gr.newCommandBuffer(cinit);
+
+	cmdb->copyBufferToBuffer(src, 0, dst, 0, 64);
+	cmdb->setBufferBarrier(dst, BufferUsageBit::TRANSFER_DESTINATION, BufferUsageBit::TRANSFER_DESTINATION, 0,
+						   MAX_PTR_SIZE);
+	cmdb->fillBuffer(dst, 64, 64, 0xABCD);
+	cmdb->resetOcclusionQuery(query);
+	cmdb->beginOcclusionQuery(query);
+	cmdb->endOcclusionQuery(query);
+	cmdb->resetTimestampQuery(timestamp);
+	cmdb->writeTimestamp(timestamp);
+
+	FencePtr fence;
+	cmdb->flush(&fence);
+	ANKI_TEST_EXPECT_EQ(fence->clientWait(0.0), true);
+
+	gr.swapBuffers();
+}
+
+ANKI_TEST(Gr, NullBackend)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	cfg.set("width", 64);
+	cfg.set("height", 64);
+	cfg.set("gr_nullRecordCommands", true);
+	GrManager* gr = createGrManager(cfg, nullptr);
+
+	{
+		BufferPtr src = gr->newBuffer(
+			BufferInitInfo(128, BufferUsageBit::TRANSFER_SOURCE, BufferMapAccessBit::WRITE, "Src"));
+		BufferPtr dst = gr->newBuffer(
+			BufferInitInfo(128, BufferUsageBit::TRANSFER_DESTINATION, BufferMapAccessBit::READ, "Dst"));
+		OcclusionQueryPtr query = gr->newOcclusionQuery();
+		TimestampQueryPtr timestamp = gr->newTimestampQuery();
+
+		U32* srcData = static_cast<U32*>(src->map(0, MAX_PTR_SIZE, BufferMapAccessBit::WRITE));
+		for(U32 i = 0; i < 32; ++i)
+		{
+			srcData[i] = i;
+		}
+		src->unmap();
+
+		recordFrame(*gr, src, dst, query, timestamp);
+
+		// The transfers and the queries are executed at flush time
+		const U32* dstData = static_cast<const U32*>(dst->map(0, MAX_PTR_SIZE, BufferMapAccessBit::READ));
+		for(U32 i = 0; i < 16; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(dstData[i], i);
+			ANKI_TEST_EXPECT_EQ(dstData[i + 16], 0xABCD);
+		}
+		dst->unmap();
+
+		ANKI_TEST_EXPECT_EQ(query->getResult(), OcclusionQueryResult::VISIBLE);
+		Second time;
+		ANKI_TEST_EXPECT_EQ(timestamp->getResult(time), TimestampQueryResult::AVAILABLE);
+
+		// Check the stats
+		const GrManagerImpl& impl = static_cast<const GrManagerImpl&>(*gr);
+		const NullFrameStats stats = impl.getLastFrameStats();
+		ANKI_TEST_EXPECT_EQ(stats.m_commandBufferCount, 1);
+		ANKI_TEST_EXPECT_EQ(stats.m_commandCount, 8);
+		ANKI_TEST_EXPECT_EQ(stats.m_barrierCount, 1);
+		ANKI_TEST_EXPECT_EQ(stats.m_transferBytes, 128);
+		ANKI_TEST_EXPECT_EQ(impl.getLastFrameCommands().getSize(), stats.m_commandCount);
+		ANKI_TEST_EXPECT_EQ(impl.getLastFrameCommands()[0].m_type, NullCommandType::COPY_BUFFER_TO_BUFFER);
+		ANKI_TEST_EXPECT_EQ(stats.m_queueSignalCount, 0); // The fence is for the CPU
+
+		// The same frame should give the same command stream
+		recordFrame(*gr, src, dst, query, timestamp);
+		ANKI_TEST_EXPECT_EQ(impl.getLastFrameStats().m_commandStreamHash, stats.m_commandStreamHash);
+
+		GrManagerStats gstats = gr->getStats();
+		ANKI_TEST_EXPECT_GEQ(gstats.m_gpuMemory, 256);
+	}
+
+	GrManager::deleteInstance(gr);
+}
+
+static void buildRenderGraph(RenderGraphDescription& descr, Array<TexturePtr, 2>& history, U32 frame, Bool extraPass)
+{
+	RenderTargetDescription colorDescr("Color");
+	colorDescr.m_width = colorDescr.m_height = 64;
+	colorDescr.m_format = Format::R8G8B8A8_UNORM;
+	colorDescr.bake();
+	const RenderTargetHandle colorRt = descr.newRenderTarget(colorDescr);
+
+	// Ping-pong the history like the temporal passes of the renderer do
+	const RenderTargetHandle historyRt = descr.importRenderTarget(history[frame & 1], TextureUsageBit::SAMPLED_COMPUTE);
+	const RenderTargetHandle outRt = descr.importRenderTarget(history[!(frame & 1)], TextureUsageBit::SAMPLED_COMPUTE);
+
+	FramebufferDescription fbDescr;
+	fbDescr.m_colorAttachmentCount = 1;
+	fbDescr.bake();
+
+	GraphicsRenderPassDescription& gpass = descr.newGraphicsRenderPass("Draw");
+	gpass.setFramebufferInfo(fbDescr, {{colorRt}}, {});
+	gpass.newDependency({colorRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+	gpass.setWork([](RenderPassWorkContext&) {}, nullptr, 0);
+
+	ComputeRenderPassDescription& cpass = descr.newComputeRenderPass("Resolve");
+	cpass.newDependency({colorRt, TextureUsageBit::SAMPLED_COMPUTE});
+	cpass.newDependency({historyRt, TextureUsageBit::SAMPLED_COMPUTE});
+	cpass.newDependency({outRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+	cpass.setWork([](RenderPassWorkContext&) {}, nullptr, 0);
+
+	if(extraPass)
+	{
+		ComputeRenderPassDescription& pass = descr.newComputeRenderPass("Extra");
+		pass.newDependency({outRt, TextureUsageBit::SAMPLED_COMPUTE});
+		pass.setWork([](RenderPassWorkContext&) {}, nullptr, 0);
+	}
+}
+
+ANKI_TEST(Gr, NullRenderGraphCache)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	cfg.set("width", 64);
+	cfg.set("height", 64);
+	GrManager* gr = createGrManager(cfg, nullptr);
+
+	{
+		const GrManagerImpl& impl = static_cast<const GrManagerImpl&>(*gr);
+		StackAllocator<U8> alloc(allocAligned, nullptr, 1_MB);
+		RenderGraphPtr rgraph = gr->newRenderGraph();
+
+		TextureInitInfo texInit("History");
+		texInit.m_width = texInit.m_height = 64;
+		texInit.m_format = Format::R8G8B8A8_UNORM;
+		texInit.m_usage = TextureUsageBit::SAMPLED_COMPUTE | TextureUsageBit::IMAGE_COMPUTE_WRITE;
+		Array<TexturePtr, 2> history = {{gr->newTexture(texInit), gr->newTexture(texInit)}};
+
+		const U32 FRAME_COUNT = 6;
+		Array<NullFrameStats, FRAME_COUNT> frameStats;
+		for(U32 frame = 0; frame < FRAME_COUNT; ++frame)
+		{
+			{
+				RenderGraphDescription descr(alloc);
+				buildRenderGraph(descr, history, frame, frame >= 4);
+
+				rgraph->compileNewGraph(descr, alloc);
+				rgraph->run();
+				rgraph->flush();
+				rgraph->reset();
+			}
+
+			alloc.getMemoryPool().reset();
+			gr->swapBuffers();
+			frameStats[frame] = impl.getLastFrameStats();
+		}
+
+		// The 1st and the 5th frames compile from scratch
+		RenderGraphStatistics stats;
+		rgraph->getStatistics(stats);
+		ANKI_TEST_EXPECT_EQ(stats.m_compiledGraphCacheMisses, 2);
+		ANKI_TEST_EXPECT_EQ(stats.m_compiledGraphCacheHits, 4);
+
+		// The cached graphs should produce the same commands. Same textures every 2 frames
+		ANKI_TEST_EXPECT_GT(frameStats[0].m_barrierCount, 0);
+		ANKI_TEST_EXPECT_EQ(frameStats[0].m_commandStreamHash, frameStats[2].m_commandStreamHash);
+		ANKI_TEST_EXPECT_EQ(frameStats[1].m_commandStreamHash, frameStats[3].m_commandStreamHash);
+		ANKI_TEST_EXPECT_EQ(frameStats[0].m_barrierCount, frameStats[1].m_barrierCount);
+		ANKI_TEST_EXPECT_EQ(frameStats[4].m_barrierCount, frameStats[5].m_barrierCount);
+	}
+
+	GrManager::deleteInstance(gr);
+}
+
+ANKI_TEST(Gr, NullRenderGraphAliasing)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	cfg.set("width", 64);
+	cfg.set("height", 64);
+	GrManager* gr = createGrManager(cfg, nullptr);
+
+	{
+		StackAllocator<U8> alloc(allocAligned, nullptr, 1_MB);
+		RenderGraphPtr rgraph = gr->newRenderGraph();
+
+		TextureInitInfo texInit("Out");
+		texInit.m_width = texInit.m_height = 64;
+		texInit.m_format = Format::R8G8B8A8_UNORM;
+		texInit.m_usage =
+			TextureUsageBit::SAMPLED_FRAGMENT | TextureUsageBit::SAMPLED_COMPUTE | TextureUsageBit::IMAGE_COMPUTE_WRITE;
+		TexturePtr outTex = gr->newTexture(texInit);
+
+		class Resolve
+		{
+		public:
+			RenderTargetHandle m_rt;
+			TexturePtr m_texture;
+		};
+		Array<Resolve, 2> resolves;
+
+		for(U32 frame = 0; frame < 2; ++frame)
+		{
+			{
+				RenderGraphDescription descr(alloc);
+
+				// Two transient RTs with the same description that are never alive at the same time
+				RenderTargetDescription rtDescr("Transient");
+				rtDescr.m_width = rtDescr.m_height = 64;
+				rtDescr.m_format = Format::R8G8B8A8_UNORM;
+				rtDescr.bake();
+				const Array<RenderTargetHandle, 2> rts = {
+					{descr.newRenderTarget(rtDescr), descr.newRenderTarget(rtDescr)}};
+				const RenderTargetHandle outRt = descr.importRenderTarget(outTex, TextureUsageBit::SAMPLED_COMPUTE);
+
+				FramebufferDescription fbDescr;
+				fbDescr.m_colorAttachmentCount = 1;
+				fbDescr.bake();
+
+				for(U32 i = 0; i < 2; ++i)
+				{
+					GraphicsRenderPassDescription& gpass = descr.newGraphicsRenderPass("Draw");
+					gpass.setFramebufferInfo(fbDescr, {{rts[i]}}, {});
+					gpass.newDependency({rts[i], TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+					if(i == 1)
+					{
+						// Force it after the 1st resolve
+						gpass.newDependency({outRt, TextureUsageBit::SAMPLED_FRAGMENT});
+					}
+					gpass.setWork([](RenderPassWorkContext&) {}, nullptr, 0);
+
+					ComputeRenderPassDescription& cpass = descr.newComputeRenderPass("Resolve");
+					cpass.newDependency({rts[i], TextureUsageBit::SAMPLED_COMPUTE});
+					cpass.newDependency({outRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+					resolves[i].m_rt = rts[i];
+					cpass.setWork(
+						[](RenderPassWorkContext& rgraphCtx) {
+							Resolve& resolve = *static_cast<Resolve*>(rgraphCtx.m_userData);
+							TextureUsageBit usage;
+							rgraphCtx.getRenderTargetState(resolve.m_rt, TextureSubresourceInfo(), resolve.m_texture,
+														   usage);
+						},
+						&resolves[i], 0);
+				}
+
+				rgraph->compileNewGraph(descr, alloc);
+				rgraph->run();
+				rgraph->flush();
+				rgraph->reset();
+			}
+
+			alloc.getMemoryPool().reset();
+			gr->swapBuffers();
+
+			// Both RTs live in the same texture and only that texture is counted
+			ANKI_TEST_EXPECT_EQ(resolves[0].m_texture->getUuid(), resolves[1].m_texture->getUuid());
+
+			RenderGraphStatistics stats;
+			rgraph->getStatistics(stats);
+			ANKI_TEST_EXPECT_EQ(stats.m_transientMemoryBeforeAliasing, 2 * 64 * 64 * 4);
+			ANKI_TEST_EXPECT_EQ(stats.m_transientMemoryAfterAliasing, 64 * 64 * 4);
+
+			resolves[0].m_texture.reset(nullptr);
+			resolves[1].m_texture.reset(nullptr);
+		}
+	}
+
+	GrManager::deleteInstance(gr);
+}
+
+/// Records the order the passes of a RenderGraph run and the queue they run in.
+class PassRecorder
+{
+public:
+	class Pass
+	{
+	public:
+		PassRecorder* m_recorder;
+		U32 m_idx;
+	};
+
+	Array<Pass, 16> m_passes;
+	Array<U32, 16> m_order;
+	Array<Bool, 16> m_async;
+	Array<const CommandBuffer*, 16> m_cmdbs; ///< The command buffer each pass was recorded to.
+	U32 m_count = 0;
+
+	PassRecorder()
+	{
+		for(U32 i = 0; i < m_passes.getSize(); ++i)
+		{
+			m_passes[i] = {this, i};
+		}
+	}
+
+	void setWork(RenderPassDescriptionBase& pass, U32 idx)
+	{
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				const Pass& pass = *static_cast<const Pass*>(rgraphCtx.m_userData);
+				PassRecorder& self = *pass.m_recorder;
+				self.m_order[self.m_count] = pass.m_idx;
+				self.m_async[pass.m_idx] =
+					static_cast<const CommandBufferImpl&>(*rgraphCtx.m_commandBuffer).isAsyncCompute();
+				self.m_cmdbs[pass.m_idx] = rgraphCtx.m_commandBuffer.get();
+				++self.m_count;
+			},
+			&m_passes[idx], 0);
+	}
+
+	/// Position of a pass in the execution order.
+	U32 getPosition(U32 idx) const
+	{
+		for(U32 i = 0; i < m_count; ++i)
+		{
+			if(m_order[i] == idx)
+			{
+				return i;
+			}
+		}
+		return MAX_U32;
+	}
+};
+
+ANKI_TEST(Gr, NullRenderGraphAsyncCompute)
+{
+	enum
+	{
+		GBUFFER,
+		SHADOWS,
+		DEPTH_DOWNSCALE,
+		FOG,
+		SSAO,
+		LIGHTS,
+		HZB_DEBUG,
+		PASS_COUNT
+	};
+
+	for(U32 asyncCompute = 0; asyncCompute < 2; ++asyncCompute)
+	{
+		ConfigSet cfg = DefaultConfigSet::get();
+		cfg.set("width", 64);
+		cfg.set("height", 64);
+		cfg.set("gr_asyncCompute", asyncCompute);
+		GrManager* gr = createGrManager(cfg, nullptr);
+
+		{
+			const GrManagerImpl& impl = static_cast<const GrManagerImpl&>(*gr);
+			StackAllocator<U8> alloc(allocAligned, nullptr, 1_MB);
+			RenderGraphPtr rgraph = gr->newRenderGraph();
+
+			TextureInitInfo texInit("Out");
+			texInit.m_width = texInit.m_height = 64;
+			texInit.m_format = Format::R8G8B8A8_UNORM;
+			texInit.m_usage = TextureUsageBit::SAMPLED_COMPUTE | TextureUsageBit::IMAGE_COMPUTE_WRITE;
+			TexturePtr outTex = gr->newTexture(texInit);
+
+			PassRecorder recorder;
+
+			{
+				RenderGraphDescription descr(alloc);
+
+				RenderTargetDescription rtDescr("RT");
+				rtDescr.m_width = rtDescr.m_height = 64;
+				rtDescr.m_format = Format::R8G8B8A8_UNORM;
+				rtDescr.bake();
+				const RenderTargetHandle depthRt = descr.newRenderTarget(rtDescr);
+				const RenderTargetHandle shadowsRt = descr.newRenderTarget(rtDescr);
+				const RenderTargetHandle hzbRt = descr.newRenderTarget(rtDescr);
+				const RenderTargetHandle fogRt = descr.newRenderTarget(rtDescr);
+				const RenderTargetHandle ssaoRt = descr.newRenderTarget(rtDescr);
+				const RenderTargetHandle outRt = descr.importRenderTarget(outTex, TextureUsageBit::SAMPLED_COMPUTE);
+
+				FramebufferDescription fbDescr;
+				fbDescr.m_colorAttachmentCount = 1;
+				fbDescr.bake();
+
+				GraphicsRenderPassDescription& gbuffer = descr.newGraphicsRenderPass("GBuffer");
+				gbuffer.setFramebufferInfo(fbDescr, {{depthRt}}, {});
+				gbuffer.newDependency({depthRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+				recorder.setWork(gbuffer, GBUFFER);
+
+				auto newComputePass = [&](CString name, U32 idx, Bool async) -> ComputeRenderPassDescription& {
+					ComputeRenderPassDescription& pass = descr.newComputeRenderPass(name);
+					pass.setAsyncCompute(async);
+					recorder.setWork(pass, idx);
+					return pass;
+				};
+
+				ComputeRenderPassDescription& shadows = newComputePass("Shadows", SHADOWS, false);
+				shadows.newDependency({depthRt, TextureUsageBit::SAMPLED_COMPUTE});
+				shadows.newDependency({shadowsRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+
+				ComputeRenderPassDescription& downscale = newComputePass("DepthDownscale", DEPTH_DOWNSCALE, true);
+				downscale.newDependency({depthRt, TextureUsageBit::SAMPLED_COMPUTE});
+				downscale.newDependency({hzbRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+
+				ComputeRenderPassDescription& fog = newComputePass("Fog", FOG, false);
+				fog.newDependency({shadowsRt, TextureUsageBit::SAMPLED_COMPUTE});
+				fog.newDependency({fogRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+
+				ComputeRenderPassDescription& ssao = newComputePass("Ssao", SSAO, true);
+				ssao.newDependency({hzbRt, TextureUsageBit::SAMPLED_COMPUTE});
+				ssao.newDependency({ssaoRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+
+				ComputeRenderPassDescription& lights = newComputePass("Lights", LIGHTS, false);
+				lights.newDependency({fogRt, TextureUsageBit::SAMPLED_COMPUTE});
+				lights.newDependency({ssaoRt, TextureUsageBit::SAMPLED_COMPUTE});
+				lights.newDependency({outRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+
+				ComputeRenderPassDescription& hzbDebug = newComputePass("HzbDebug", HZB_DEBUG, false);
+				hzbDebug.newDependency({hzbRt, TextureUsageBit::SAMPLED_COMPUTE});
+
+				rgraph->compileNewGraph(descr, alloc);
+				rgraph->run();
+				rgraph->flush();
+				rgraph->reset();
+			}
+
+			alloc.getMemoryPool().reset();
+			gr->swapBuffers();
+			const NullFrameStats& stats = impl.getLastFrameStats();
+
+			ANKI_TEST_EXPECT_EQ(recorder.m_count, PASS_COUNT);
+			ANKI_TEST_EXPECT_EQ(recorder.getPosition(GBUFFER), 0);
+			for(U32 i = 0; i < PASS_COUNT; ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(recorder.m_async[i], asyncCompute && (i == DEPTH_DOWNSCALE || i == SSAO));
+			}
+
+			if(asyncCompute)
+			{
+				// The general passes that need async work are postponed to give the async queue time. HzbDebug goes
+				// after Fog and the Lights after HzbDebug
+				ANKI_TEST_EXPECT_LT(recorder.getPosition(FOG), recorder.getPosition(SSAO));
+				ANKI_TEST_EXPECT_LT(recorder.getPosition(SSAO), recorder.getPosition(HZB_DEBUG));
+				ANKI_TEST_EXPECT_LT(recorder.getPosition(HZB_DEBUG), recorder.getPosition(LIGHTS));
+
+				// One async command buffer that waits on the Shadows and one general that waits on it
+				ANKI_TEST_EXPECT_EQ(stats.m_asyncComputeCommandBufferCount, 1);
+				ANKI_TEST_EXPECT_EQ(stats.m_commandBufferCount, 4);
+				ANKI_TEST_EXPECT_EQ(stats.m_queueWaitCount, 2);
+				ANKI_TEST_EXPECT_EQ(stats.m_queueSignalCount, 2);
+			}
+			else
+			{
+				ANKI_TEST_EXPECT_EQ(stats.m_asyncComputeCommandBufferCount, 0);
+				ANKI_TEST_EXPECT_EQ(stats.m_commandBufferCount, 1);
+				ANKI_TEST_EXPECT_EQ(stats.m_queueWaitCount, 0);
+				ANKI_TEST_EXPECT_EQ(stats.m_queueSignalCount, 0);
+			}
+		}
+
+		GrManager::deleteInstance(gr);
+	}
+}
+
+ANKI_TEST(Gr, NullRenderGraphAsyncComputeRenderer)
+{
+	// The passes of the renderer that matter for the async compute and their dependencies
+	enum
+	{
+		SHADOWS,
+		GI_GBUFFER,
+		GI_LIGHT_SHADING,
+		GI_IRRADIANCE,
+		VOL_LIGHTING,
+		GBUFFER,
+		GBUFFER_POST,
+		HIZ,
+		VOL_FOG,
+		SSAO_MAIN,
+		SSAO_BLUR,
+		LIGHT_SHADING,
+		PASS_COUNT
+	};
+
+	ConfigSet cfg = DefaultConfigSet::get();
+	cfg.set("width", 64);
+	cfg.set("height", 64);
+	cfg.set("gr_asyncCompute", true);
+	GrManager* gr = createGrManager(cfg, nullptr);
+
+	{
+		const GrManagerImpl& impl = static_cast<const GrManagerImpl&>(*gr);
+		StackAllocator<U8> alloc(allocAligned, nullptr, 1_MB);
+		RenderGraphPtr rgraph = gr->newRenderGraph();
+		PassRecorder recorder;
+
+		{
+			RenderGraphDescription descr(alloc);
+
+			RenderTargetDescription rtDescr("RT");
+			rtDescr.m_width = rtDescr.m_height = 64;
+			rtDescr.m_format = Format::R8G8B8A8_UNORM;
+			rtDescr.bake();
+			const RenderTargetHandle shadowsRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle giGbufferRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle giLightShadingRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle giIrradianceRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle volLightingRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle gbufferRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle hizRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle fogRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle ssaoRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle ssaoBlurRt = descr.newRenderTarget(rtDescr);
+			const RenderTargetHandle outRt = descr.newRenderTarget(rtDescr);
+
+			FramebufferDescription fbDescr;
+			fbDescr.m_colorAttachmentCount = 1;
+			fbDescr.bake();
+
+			auto newGraphicsPass = [&](CString name, U32 idx, RenderTargetHandle rt) -> GraphicsRenderPassDescription& {
+				GraphicsRenderPassDescription& pass = descr.newGraphicsRenderPass(name);
+				pass.setFramebufferInfo(fbDescr, {{rt}}, {});
+				pass.newDependency({rt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+				recorder.setWork(pass, idx);
+				return pass;
+			};
+
+			auto newComputePass = [&](CString name, U32 idx, RenderTargetHandle rt) -> ComputeRenderPassDescription& {
+				ComputeRenderPassDescription& pass = descr.newComputeRenderPass(name);
+				pass.newDependency({rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+				recorder.setWork(pass, idx);
+				return pass;
+			};
+
+			// Same order as Renderer::populateRenderGraph()
+			newGraphicsPass("Shadows", SHADOWS, shadowsRt);
+
+			newGraphicsPass("GI gbuff", GI_GBUFFER, giGbufferRt);
+
+			GraphicsRenderPassDescription& giLs = newGraphicsPass("GI LS", GI_LIGHT_SHADING, giLightShadingRt);
+			giLs.newDependency({giGbufferRt, TextureUsageBit::SAMPLED_FRAGMENT});
+			giLs.newDependency({shadowsRt, TextureUsageBit::SAMPLED_FRAGMENT});
+
+			ComputeRenderPassDescription& giIr = newComputePass("GI IR", GI_IRRADIANCE, giIrradianceRt);
+			giIr.setAsyncCompute();
+			giIr.newDependency({giLightShadingRt, TextureUsageBit::SAMPLED_COMPUTE});
+			giIr.newDependency({giGbufferRt, TextureUsageBit::SAMPLED_COMPUTE});
+
+			ComputeRenderPassDescription& volLighting = newComputePass("Vol light", VOL_LIGHTING, volLightingRt);
+			volLighting.setAsyncCompute();
+			volLighting.newDependency({shadowsRt, TextureUsageBit::SAMPLED_COMPUTE});
+			volLighting.newDependency({giIrradianceRt, TextureUsageBit::SAMPLED_COMPUTE});
+
+			newGraphicsPass("GBuffer", GBUFFER, gbufferRt);
+
+			GraphicsRenderPassDescription& gbufferPost = newGraphicsPass("GBuffPost", GBUFFER_POST, gbufferRt);
+			gbufferPost.newDependency({gbufferRt, TextureUsageBit::ALL_FRAMEBUFFER_ATTACHMENT});
+
+			ComputeRenderPassDescription& hiz = newComputePass("HiZ", HIZ, hizRt);
+			hiz.setAsyncCompute();
+			hiz.newDependency({gbufferRt, TextureUsageBit::SAMPLED_COMPUTE});
+
+			ComputeRenderPassDescription& volFog = newComputePass("Vol fog", VOL_FOG, fogRt);
+			volFog.newDependency({volLightingRt, TextureUsageBit::SAMPLED_COMPUTE});
+
+			ComputeRenderPassDescription& ssao = newComputePass("SSAO main", SSAO_MAIN, ssaoRt);
+			ssao.setAsyncCompute();
+			ssao.newDependency({hizRt, TextureUsageBit::SAMPLED_COMPUTE});
+
+			ComputeRenderPassDescription& ssaoBlur = newComputePass("SSAO blur", SSAO_BLUR, ssaoBlurRt);
+			ssaoBlur.setAsyncCompute();
+			ssaoBlur.newDependency({ssaoRt, TextureUsageBit::SAMPLED_COMPUTE});
+
+			GraphicsRenderPassDescription& ls = newGraphicsPass("Light shading", LIGHT_SHADING, outRt);
+			ls.newDependency({gbufferRt, TextureUsageBit::SAMPLED_FRAGMENT});
+			ls.newDependency({ssaoBlurRt, TextureUsageBit::SAMPLED_FRAGMENT});
+			ls.newDependency({fogRt, TextureUsageBit::SAMPLED_FRAGMENT});
+			ls.newDependency({giIrradianceRt, TextureUsageBit::SAMPLED_FRAGMENT});
+
+			rgraph->compileNewGraph(descr, alloc);
+			rgraph->run();
+			rgraph->flush();
+			rgraph->reset();
+		}
+
+		alloc.getMemoryPool().reset();
+		gr->swapBuffers();
+		const NullFrameStats& stats = impl.getLastFrameStats();
+
+		ANKI_TEST_EXPECT_EQ(recorder.m_count, PASS_COUNT);
+		for(U32 i = 0; i < PASS_COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(recorder.m_async[i], i == GI_IRRADIANCE || i == VOL_LIGHTING || i == HIZ
+														 || i == SSAO_MAIN || i == SSAO_BLUR);
+		}
+
+		// The HiZ and the SSAO start right after the GBuffer and the GI passes run on the general queue meanwhile. The
+		// rest of the async passes need the GI so they run after it
+		ANKI_TEST_EXPECT_EQ(stats.m_commandBufferCount, 5);
+		ANKI_TEST_EXPECT_EQ(stats.m_asyncComputeCommandBufferCount, 2);
+		ANKI_TEST_EXPECT_EQ(stats.m_queueWaitCount, 3);
+		ANKI_TEST_EXPECT_EQ(stats.m_queueSignalCount, 3);
+
+		ANKI_TEST_EXPECT_EQ(recorder.m_cmdbs[GBUFFER], recorder.m_cmdbs[GBUFFER_POST]);
+		ANKI_TEST_EXPECT_EQ(recorder.m_cmdbs[HIZ], recorder.m_cmdbs[SSAO_MAIN]);
+		ANKI_TEST_EXPECT_EQ(recorder.m_cmdbs[GI_IRRADIANCE], recorder.m_cmdbs[VOL_LIGHTING]);
+		ANKI_TEST_EXPECT_EQ(recorder.m_cmdbs[GI_IRRADIANCE], recorder.m_cmdbs[SSAO_BLUR]);
+		for(U32 pass : {SHADOWS, GI_GBUFFER, GI_LIGHT_SHADING})
+		{
+			ANKI_TEST_EXPECT_NEQ(recorder.m_cmdbs[pass], recorder.m_cmdbs[GBUFFER]);
+			ANKI_TEST_EXPECT_NEQ(recorder.m_cmdbs[pass], recorder.m_cmdbs[LIGHT_SHADING]);
+			ANKI_TEST_EXPECT_EQ(recorder.getPosition(pass) > recorder.getPosition(GBUFFER_POST), true);
+			ANKI_TEST_EXPECT_EQ(recorder.getPosition(pass) < recorder.getPosition(GI_IRRADIANCE), true);
+		}
+		ANKI_TEST_EXPECT_EQ(recorder.m_cmdbs[VOL_FOG], recorder.m_cmdbs[LIGHT_SHADING]);
+	}
+
+	GrManager::deleteInstance(gr);
+}
+
+} // end namespace anki
+
+#endif
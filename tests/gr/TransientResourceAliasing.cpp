@@ -0,0 +1,79 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/utils/TransientResourceAliasing.h>
+#include <tests/framework/Framework.h>
+
+namespace anki
+{
+
+static TransientResourceLifetime newLifetime(U64 key, PtrSize size, U32 firstBatch, U32 lastBatch)
+{
+	TransientResourceLifetime l;
+	l.m_compatibilityKey = key;
+	l.m_memorySize = size;
+	l.m_firstBatch = firstBatch;
+	l.m_lastBatch = lastBatch;
+	return l;
+}
+
+ANKI_TEST(Gr, TransientResourceAliasing)
+{
+	StackAllocator<U8> alloc(allocAligned, nullptr, 64_KB);
+
+	// Chain of compatible resources with disjoint lifetimes
+	{
+		Array<TransientResourceLifetime, 3> resources = {
+			{newLifetime(1, 100, 0, 1), newLifetime(1, 100, 2, 3), newLifetime(1, 100, 4, 4)}};
+		Array<U32, 3> aliasOf;
+
+		const PtrSize size = computeTransientResourceAliasing(resources, aliasOf, alloc);
+		ANKI_TEST_EXPECT_EQ(size, 100);
+		ANKI_TEST_EXPECT_EQ(aliasOf[0], MAX_U32);
+		ANKI_TEST_EXPECT_EQ(aliasOf[1], 0);
+		ANKI_TEST_EXPECT_EQ(aliasOf[2], 1);
+	}
+
+	// Overlapping lifetimes, incompatible keys and unused resources don't alias
+	{
+		Array<TransientResourceLifetime, 4> resources = {{newLifetime(1, 100, 0, 2), newLifetime(1, 100, 2, 3),
+														  newLifetime(2, 50, 3, 4), TransientResourceLifetime()}};
+		resources[3].m_compatibilityKey = 1;
+		resources[3].m_memorySize = 10;
+		Array<U32, 4> aliasOf;
+
+		const PtrSize size = computeTransientResourceAliasing(resources, aliasOf, alloc);
+		ANKI_TEST_EXPECT_EQ(size, 260);
+		for(U32 idx : aliasOf)
+		{
+			ANKI_TEST_EXPECT_EQ(idx, MAX_U32);
+		}
+	}
+
+	// The resources are declared in a different order than they are used. The one that got free last is preferred
+	{
+		Array<TransientResourceLifetime, 4> resources = {{newLifetime(1, 100, 5, 6), newLifetime(1, 100, 0, 0),
+														  newLifetime(1, 100, 0, 3), newLifetime(1, 100, 4, 4)}};
+		Array<U32, 4> aliasOf;
+
+		const PtrSize size = computeTransientResourceAliasing(resources, aliasOf, alloc);
+		ANKI_TEST_EXPECT_EQ(size, 200);
+		ANKI_TEST_EXPECT_EQ(aliasOf[1], MAX_U32);
+		ANKI_TEST_EXPECT_EQ(aliasOf[2], MAX_U32);
+		ANKI_TEST_EXPECT_EQ(aliasOf[3], 2);
+		ANKI_TEST_EXPECT_EQ(aliasOf[0], 3);
+
+		// No resource shares memory with a resource it overlaps with
+		for(U32 i = 0; i < resources.getSize(); ++i)
+		{
+			if(aliasOf[i] != MAX_U32)
+			{
+				ANKI_TEST_EXPECT_EQ(resources[i].overlaps(resources[aliasOf[i]]), false);
+			}
+		}
+	}
+}
+
+} // end namespace anki
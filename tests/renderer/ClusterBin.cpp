@@ -0,0 +1,376 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/ClusterBin.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/ThreadHive.h>
+#include <algorithm>
+
+namespace anki
+{
+
+static const U32 CLUSTER_COUNT_X = 16;
+static const U32 CLUSTER_COUNT_Y = 9;
+static const U32 CLUSTER_COUNT_Z = 30; // Not a multiple of 4 to test the padding of the SIMD kernels
+
+static Vec3 randomPosition()
+{
+	return Vec3(getRandomRange(-60.0f, 60.0f), getRandomRange(-20.0f, 20.0f), getRandomRange(-150.0f, 150.0f));
+}
+
+/// Bin and return the objects of every cluster. One array per cluster and type.
+static std::vector<std::vector<U32>> binToClusters(const RenderQueue& queue, Bool objectCentric, Bool simd)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	ConfigSet config = DefaultConfigSet::get();
+	config.set("r_avgObjectsPerCluster", 256u);
+	config.set("r_objectCentricClusterBinning", objectCentric);
+	config.set("r_clusterBinSimd", simd);
+
+	ClusterBin clusterBin;
+	clusterBin.init(alloc, CLUSTER_COUNT_X, CLUSTER_COUNT_Y, CLUSTER_COUNT_Z, config);
+
+	ThreadHive hive(2, alloc, false);
+	StackAllocator<U8> tempAlloc(allocAligned, nullptr, 32 * 1024 * 1024, 1.0f);
+
+	ClusterBinIn in;
+	in.m_threadHive = &hive;
+	in.m_tempAlloc = tempAlloc;
+	in.m_renderQueue = &queue;
+	in.m_stagingMem = nullptr;
+	in.m_shadowsEnabled = false;
+
+	ClusterBinOut out;
+	clusterBin.bin(in, out);
+
+	// Every cluster points to the first object and the object lists of every type end with a MAX_U32
+	std::vector<std::vector<U32>> lists(out.m_clusters.getSize() * TYPED_OBJECT_COUNT);
+	for(U32 cluster = 0; cluster < out.m_clusters.getSize(); ++cluster)
+	{
+		U32 idx = out.m_clusters[cluster];
+		for(U32 type = 0; type < TYPED_OBJECT_COUNT; ++type)
+		{
+			while(out.m_indices[idx] != MAX_U32)
+			{
+				lists[cluster * TYPED_OBJECT_COUNT + type].push_back(out.m_indices[idx++]);
+			}
+			++idx;
+		}
+	}
+
+	return lists;
+}
+
+/// A rotated camera so the cluster AABBs are not aligned with the frustum.
+static void setRotatedCamera(RenderQueue& queue)
+{
+	const Transform cameraTrf(Vec4(3.0f, 1.0f, 5.0f, 0.0f),
+							  Mat3x4(Vec3(0.0f), Euler(toRad(10.0f), toRad(35.0f), toRad(5.0f))), 1.0f);
+	queue.m_cameraNear = 0.1f;
+	queue.m_cameraFar = 200.0f;
+	queue.m_cameraFovX = toRad(90.0f);
+	queue.m_cameraFovY = toRad(60.0f);
+	queue.m_cameraTransform = Mat4(cameraTrf);
+	queue.m_viewMatrix = Mat4(cameraTrf.getInverse());
+	queue.m_projectionMatrix = Mat4::calculatePerspectiveProjectionMatrix(queue.m_cameraFovX, queue.m_cameraFovY,
+																		   queue.m_cameraNear, queue.m_cameraFar);
+	queue.m_viewProjectionMatrix = queue.m_projectionMatrix * queue.m_viewMatrix;
+	queue.m_previousViewProjectionMatrix = queue.m_viewProjectionMatrix;
+}
+
+/// The world position of a point of the screen in NDC at some distance from the camera.
+static Vec3 ndcToWorld(const RenderQueue& queue, F32 ndcX, F32 ndcY, F32 depth)
+{
+	const Vec4 viewPos(ndcX * depth * tan(queue.m_cameraFovX / 2.0f), ndcY * depth * tan(queue.m_cameraFovY / 2.0f),
+					   -depth, 1.0f);
+	return (queue.m_cameraTransform * viewPos).xyz();
+}
+
+/// The distance from the camera where a depth split starts. Same as computeClusterNear().
+static F32 splitDepth(const RenderQueue& queue, U32 k)
+{
+	const F32 magic = (queue.m_cameraFar - queue.m_cameraNear) / F32(CLUSTER_COUNT_Z * CLUSTER_COUNT_Z);
+	return magic * F32(k * k) + queue.m_cameraNear;
+}
+
+/// Find the cluster that contains a point. Returns false if it's outside the frustum.
+static Bool computeCluster(const RenderQueue& queue, const Vec3& pos, U32& clusterIdx)
+{
+	const Vec4 viewPos = queue.m_viewMatrix * pos.xyz1();
+	const F32 depth = -viewPos.z();
+	if(depth <= queue.m_cameraNear || depth >= queue.m_cameraFar)
+	{
+		return false;
+	}
+
+	const Vec4 clip = queue.m_projectionMatrix * viewPos;
+	const Vec2 ndc = clip.xy() / clip.w();
+	if(ndc.x() <= -1.0f || ndc.x() >= 1.0f || ndc.y() <= -1.0f || ndc.y() >= 1.0f)
+	{
+		return false;
+	}
+
+	const U32 x = min(U32((ndc.x() * 0.5f + 0.5f) * F32(CLUSTER_COUNT_X)), CLUSTER_COUNT_X - 1);
+	const U32 y = min(U32((ndc.y() * 0.5f + 0.5f) * F32(CLUSTER_COUNT_Y)), CLUSTER_COUNT_Y - 1);
+	U32 z = 0;
+	while(z + 1 < CLUSTER_COUNT_Z && splitDepth(queue, z + 1) <= depth)
+	{
+		++z;
+	}
+
+	clusterIdx = (z * CLUSTER_COUNT_Y + y) * CLUSTER_COUNT_X + x;
+	return true;
+}
+
+ANKI_TEST(Renderer, ClusterBinSimd)
+{
+	// Create a scene with everything but decals. Decals need textures and they are always tested without SIMD
+	std::vector<PointLightQueueElement> pointLights(600);
+	for(PointLightQueueElement& light : pointLights)
+	{
+		zeroMemory(light);
+		light.m_worldPosition = randomPosition();
+		light.m_radius = getRandomRange(0.5f, 8.0f);
+	}
+
+	std::vector<SpotLightQueueElement> spotLights(200);
+	for(SpotLightQueueElement& light : spotLights)
+	{
+		zeroMemory(light);
+		const Euler rot(getRandomRange(-PI, PI), getRandomRange(-PI, PI), 0.0f);
+		light.m_worldTransform = Mat4(Transform(randomPosition().xyz0(), Mat3x4(Vec3(0.0f), rot), 1.0f));
+		light.m_distance = getRandomRange(2.0f, 20.0f);
+		light.m_outerAngle = toRad(getRandomRange(20.0f, 60.0f));
+		light.m_innerAngle = light.m_outerAngle / 2.0f;
+	}
+
+	std::vector<ReflectionProbeQueueElement> probes(30);
+	for(ReflectionProbeQueueElement& probe : probes)
+	{
+		zeroMemory(probe);
+		probe.m_worldPosition = randomPosition();
+		probe.m_aabbMin = probe.m_worldPosition - getRandomRange(1.0f, 10.0f);
+		probe.m_aabbMax = probe.m_worldPosition + getRandomRange(1.0f, 10.0f);
+	}
+
+	std::vector<GlobalIlluminationProbeQueueElement> giProbes(10);
+	for(GlobalIlluminationProbeQueueElement& probe : giProbes)
+	{
+		const Vec3 center = randomPosition();
+		probe.m_aabbMin = center - getRandomRange(5.0f, 20.0f);
+		probe.m_aabbMax = center + getRandomRange(5.0f, 20.0f);
+		probe.m_cellCounts = UVec3(4);
+	}
+
+	std::vector<FogDensityQueueElement> fogVolumes(20);
+	for(U32 i = 0; i < fogVolumes.size(); ++i)
+	{
+		FogDensityQueueElement& vol = fogVolumes[i];
+		zeroMemory(vol);
+		vol.m_isBox = (i % 2) == 0;
+		if(vol.m_isBox)
+		{
+			const Vec3 center = randomPosition();
+			vol.m_aabbMin = center - getRandomRange(1.0f, 5.0f);
+			vol.m_aabbMax = center + getRandomRange(1.0f, 5.0f);
+		}
+		else
+		{
+			vol.m_sphereCenter = randomPosition();
+			vol.m_sphereRadius = getRandomRange(1.0f, 5.0f);
+		}
+	}
+
+	RenderQueue queue;
+	queue.m_pointLights = WeakArray<PointLightQueueElement>(&pointLights[0], U32(pointLights.size()));
+	queue.m_spotLights = WeakArray<SpotLightQueueElement>(&spotLights[0], U32(spotLights.size()));
+	queue.m_reflectionProbes = WeakArray<ReflectionProbeQueueElement>(&probes[0], U32(probes.size()));
+	queue.m_giProbes = WeakArray<GlobalIlluminationProbeQueueElement>(&giProbes[0], U32(giProbes.size()));
+	queue.m_fogDensityVolumes = WeakArray<FogDensityQueueElement>(&fogVolumes[0], U32(fogVolumes.size()));
+
+	setRotatedCamera(queue);
+
+	for(U32 objectCentric = 0; objectCentric < 2; ++objectCentric)
+	{
+		const std::vector<std::vector<U32>> scalar = binToClusters(queue, objectCentric, false);
+		const std::vector<std::vector<U32>> simd = binToClusters(queue, objectCentric, true);
+
+		ANKI_TEST_EXPECT_EQ(scalar.size(), simd.size());
+
+		U32 objectCount = 0;
+		U32 mismatchCount = 0;
+		for(U32 i = 0; i < scalar.size(); ++i)
+		{
+			objectCount += U32(scalar[i].size());
+			mismatchCount += scalar[i] != simd[i];
+		}
+
+		ANKI_TEST_EXPECT_GT(objectCount, 0);
+		ANKI_TEST_EXPECT_EQ(mismatchCount, 0);
+	}
+}
+
+ANKI_TEST(Renderer, ClusterBinObjectCentric)
+{
+	RenderQueue queue;
+	setRotatedCamera(queue);
+
+	std::vector<PointLightQueueElement> pointLights;
+	std::vector<SpotLightQueueElement> spotLights;
+	std::vector<ReflectionProbeQueueElement> probes;
+	std::vector<FogDensityQueueElement> fogVolumes(20);
+
+	auto addPointLight = [&](const Vec3& pos, F32 radius) {
+		PointLightQueueElement light;
+		zeroMemory(light);
+		light.m_worldPosition = pos;
+		light.m_radius = radius;
+		pointLights.push_back(light);
+	};
+
+	auto addProbe = [&](const Vec3& center, F32 halfSize) {
+		ReflectionProbeQueueElement probe;
+		zeroMemory(probe);
+		probe.m_worldPosition = center;
+		probe.m_aabbMin = center - halfSize;
+		probe.m_aabbMax = center + halfSize;
+		probes.push_back(probe);
+	};
+
+	// Small objects on the corners of the tiles and on the depth splits. Their ranges end exactly on a boundary
+	for(U32 k = 1; k < CLUSTER_COUNT_Z; k += 3)
+	{
+		const F32 depth = splitDepth(queue, k);
+		for(U32 y = 0; y <= CLUSTER_COUNT_Y; ++y)
+		{
+			for(U32 x = 0; x <= CLUSTER_COUNT_X; x += 2)
+			{
+				const F32 ndcX = F32(x) / F32(CLUSTER_COUNT_X) * 2.0f - 1.0f;
+				const F32 ndcY = F32(y) / F32(CLUSTER_COUNT_Y) * 2.0f - 1.0f;
+				const Vec3 pos = ndcToWorld(queue, ndcX, ndcY, depth);
+
+				if((x + y) % 2)
+				{
+					addPointLight(pos, depth * 0.001f);
+				}
+				else
+				{
+					addProbe(pos, depth * 0.001f);
+				}
+			}
+		}
+	}
+
+	// Objects that cross the near plane, that contain the camera and that are behind it
+	const Vec3 cameraPos = queue.m_cameraTransform.getTranslationPart().xyz();
+	const Vec3 cameraDir = -queue.m_cameraTransform.getColumn(2).xyz().getNormalized();
+	addPointLight(cameraPos, 0.5f);
+	addPointLight(cameraPos + cameraDir * queue.m_cameraNear, 0.05f);
+	addPointLight(ndcToWorld(queue, 0.9f, -0.9f, queue.m_cameraNear), 2.0f);
+	addPointLight(cameraPos - cameraDir * 3.0f, 2.5f);
+	addProbe(cameraPos + cameraDir * 2.0f, 2.5f);
+	addProbe(ndcToWorld(queue, -1.0f, 1.0f, queue.m_cameraNear), 1.0f);
+	addProbe(cameraPos - cameraDir * 10.0f, 1.0f);
+
+	// And the rest of the scene
+	for(U32 i = 0; i < 200; ++i)
+	{
+		addPointLight(randomPosition(), getRandomRange(0.5f, 8.0f));
+	}
+
+	for(U32 i = 0; i < 100; ++i)
+	{
+		SpotLightQueueElement light;
+		zeroMemory(light);
+		const Vec3 origin = (i < 10) ? cameraPos : randomPosition();
+		const Euler rot(getRandomRange(-PI, PI), getRandomRange(-PI, PI), 0.0f);
+		light.m_worldTransform = Mat4(Transform(origin.xyz0(), Mat3x4(Vec3(0.0f), rot), 1.0f));
+		light.m_distance = getRandomRange(2.0f, 20.0f);
+		light.m_outerAngle = toRad(getRandomRange(20.0f, 60.0f));
+		light.m_innerAngle = light.m_outerAngle / 2.0f;
+		spotLights.push_back(light);
+	}
+
+	for(U32 i = 0; i < fogVolumes.size(); ++i)
+	{
+		FogDensityQueueElement& vol = fogVolumes[i];
+		zeroMemory(vol);
+		vol.m_isBox = (i % 2) == 0;
+		const Vec3 center = (i < 4) ? cameraPos : randomPosition();
+		if(vol.m_isBox)
+		{
+			vol.m_aabbMin = center - getRandomRange(1.0f, 5.0f);
+			vol.m_aabbMax = center + getRandomRange(1.0f, 5.0f);
+		}
+		else
+		{
+			vol.m_sphereCenter = center;
+			vol.m_sphereRadius = getRandomRange(1.0f, 5.0f);
+		}
+	}
+
+	queue.m_pointLights = WeakArray<PointLightQueueElement>(&pointLights[0], U32(pointLights.size()));
+	queue.m_spotLights = WeakArray<SpotLightQueueElement>(&spotLights[0], U32(spotLights.size()));
+	queue.m_reflectionProbes = WeakArray<ReflectionProbeQueueElement>(&probes[0], U32(probes.size()));
+	queue.m_fogDensityVolumes = WeakArray<FogDensityQueueElement>(&fogVolumes[0], U32(fogVolumes.size()));
+
+	for(Bool simd : {false, true})
+	{
+		const std::vector<std::vector<U32>> legacy = binToClusters(queue, false, simd);
+		const std::vector<std::vector<U32>> objectCentric = binToClusters(queue, true, simd);
+
+		ANKI_TEST_EXPECT_EQ(legacy.size(), objectCentric.size());
+
+		// The object-centric binning only skips tests so it finds a subset of what the legacy finds. It's not the same
+		// because the legacy tests the AABBs of the clusters and those are bigger than the clusters
+		U32 objectCount = 0;
+		U32 extraCount = 0;
+		for(U32 i = 0; i < legacy.size(); ++i)
+		{
+			objectCount += U32(legacy[i].size());
+
+			for(U32 idx : objectCentric[i])
+			{
+				extraCount += std::find(legacy[i].begin(), legacy[i].end(), idx) == legacy[i].end();
+			}
+		}
+
+		ANKI_TEST_EXPECT_GT(objectCount, 0);
+		ANKI_TEST_EXPECT_EQ(extraCount, 0);
+
+		// The ranges of the objects are conservative so the cluster of the center of an object is always found
+		U32 centerCount = 0;
+		U32 missingCount = 0;
+		auto checkCenter = [&](const Vec3& center, U32 typeIdx, U32 objectIdx) {
+			U32 clusterIdx;
+			if(!computeCluster(queue, center, clusterIdx))
+			{
+				return;
+			}
+
+			const std::vector<U32>& list = objectCentric[clusterIdx * TYPED_OBJECT_COUNT + typeIdx];
+			++centerCount;
+			missingCount += std::find(list.begin(), list.end(), objectIdx) == list.end();
+		};
+
+		for(U32 i = 0; i < pointLights.size(); ++i)
+		{
+			checkCenter(pointLights[i].m_worldPosition, 0, i);
+		}
+
+		for(U32 i = 0; i < probes.size(); ++i)
+		{
+			checkCenter(probes[i].m_worldPosition, 2, i);
+		}
+
+		ANKI_TEST_EXPECT_GT(centerCount, 0);
+		ANKI_TEST_EXPECT_EQ(missingCount, 0);
+	}
+}
+
+} // end namespace anki
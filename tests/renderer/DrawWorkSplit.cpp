@@ -0,0 +1,103 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/DrawWorkSplit.h>
+#include <anki/renderer/RenderQueue.h>
+
+namespace anki
+{
+
+static void drawCallback(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData)
+{
+}
+
+ANKI_TEST(Renderer, DrawWorkSplit)
+{
+	StackAllocator<U8> alloc(allocAligned, nullptr, 1024 * 1024);
+
+	// One light with many casters, some of them instanced, and a few small lights
+	const U32 arraySizes[] = {1000, 10, 0, 20, 3};
+	DynamicArrayAuto<RenderableQueueElement> storage(alloc);
+	storage.create(1033);
+	U32 idx = 0;
+	for(RenderableQueueElement& el : storage)
+	{
+		zeroMemory(el);
+		el.m_callback = drawCallback;
+		el.m_mergeKey = (idx < 500) ? (idx / 50 + 1) : 0;
+		++idx;
+	}
+
+	Array<ConstWeakArray<RenderableQueueElement>, 5> arrays;
+	U32 offset = 0;
+	for(U32 i = 0; i < arrays.getSize(); ++i)
+	{
+		arrays[i] = ConstWeakArray<RenderableQueueElement>(&storage[offset], arraySizes[i]);
+		offset += arraySizes[i];
+	}
+
+	for(U32 taskCount : {1u, 3u, 8u, 64u})
+	{
+		DrawWorkSplit split;
+		split.init(alloc, ConstWeakArray<ConstWeakArray<RenderableQueueElement>>(&arrays[0], arrays.getSize()),
+				   taskCount);
+		ANKI_TEST_EXPECT_EQ(split.getTaskCount(), taskCount);
+
+		// All the renderables are drawn once and in order
+		U32 arrayIdx = 0;
+		U32 nextRenderable = 0;
+		U64 maxTaskCost = 0;
+		for(U32 task = 0; task < taskCount; ++task)
+		{
+			U64 taskCost = 0;
+			for(const DrawWorkSplit::Range& range : split.getTaskRanges(task))
+			{
+				if(range.m_arrayIdx != arrayIdx)
+				{
+					ANKI_TEST_EXPECT_EQ(nextRenderable, arrays[arrayIdx].getSize());
+					ANKI_TEST_EXPECT_GT(range.m_arrayIdx, arrayIdx);
+					arrayIdx = range.m_arrayIdx;
+					nextRenderable = 0;
+				}
+
+				ANKI_TEST_EXPECT_EQ(range.m_firstRenderable, nextRenderable);
+				ANKI_TEST_EXPECT_GT(range.m_renderableCount, 0);
+				nextRenderable += range.m_renderableCount;
+				ANKI_TEST_EXPECT_LEQ(nextRenderable, arrays[arrayIdx].getSize());
+
+				// Merged drawcalls are not split
+				if(nextRenderable < arrays[arrayIdx].getSize())
+				{
+					ANKI_TEST_EXPECT_EQ(canMergeRenderableQueueElements(arrays[arrayIdx][nextRenderable - 1],
+																		arrays[arrayIdx][nextRenderable]),
+										false);
+				}
+
+				taskCost += DrawWorkSplit::estimateCost(ConstWeakArray<RenderableQueueElement>(
+					&arrays[arrayIdx][range.m_firstRenderable], range.m_renderableCount));
+			}
+
+			maxTaskCost = max(maxTaskCost, taskCost);
+		}
+
+		ANKI_TEST_EXPECT_EQ(arrayIdx, arrays.getSize() - 1);
+		ANKI_TEST_EXPECT_EQ(nextRenderable, arrays[arrayIdx].getSize());
+
+		// Balanced. A task might get an extra drawcall of cost 8 and the merged drawcalls can't be split
+		U64 totalCost = 0;
+		for(const ConstWeakArray<RenderableQueueElement>& renderables : arrays)
+		{
+			totalCost += DrawWorkSplit::estimateCost(renderables);
+		}
+
+		if(taskCount <= 8)
+		{
+			ANKI_TEST_EXPECT_LEQ(maxTaskCost, totalCost / taskCount + 8 + 49);
+		}
+	}
+}
+
+} // end namespace anki
@@ -0,0 +1,149 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/GpuInstanceCulling.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/core/ConfigSet.h>
+
+#if ANKI_GR_BACKEND_NULL
+#	include <anki/gr/null/BufferImpl.h>
+
+namespace anki
+{
+
+static void drawCallbackA(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData)
+{
+}
+
+static void drawCallbackB(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData)
+{
+}
+
+static void addRenderables(std::vector<RenderableQueueElement>& renderables, U32 count,
+						   RenderQueueDrawCallback callback, U64 mergeKey, F32 distance, Bool gpuCulled = true)
+{
+	for(U32 i = 0; i < count; ++i)
+	{
+		RenderableQueueElement el;
+		zeroMemory(el);
+		el.m_callback = callback;
+		el.m_userData = &renderables;
+		el.m_mergeKey = mergeKey;
+		el.m_distanceFromCamera = distance;
+		el.m_aabbMin = Vec3(F32(renderables.size()));
+		el.m_aabbMax = el.m_aabbMin + 1.0f;
+		el.m_gpuSceneSlot = (gpuCulled) ? U32(renderables.size()) * 10 : MAX_U32;
+		renderables.push_back(el);
+	}
+}
+
+ANKI_TEST(Renderer, GpuInstanceCulling)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	cfg.set("width", 64);
+	cfg.set("height", 64);
+	GrManager* gr = createGrManager(cfg, nullptr);
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	{
+		GpuInstanceBuckets buckets;
+		buckets.init(gr, alloc, 16);
+		ANKI_TEST_EXPECT_EQ(buckets.getCapacity(), MAX_INSTANCES);
+
+		std::vector<RenderableQueueElement> renderables;
+		addRenderables(renderables, 70, drawCallbackA, 1, 1.0f); // More than MAX_INSTANCES, 2 buckets
+		addRenderables(renderables, 10, drawCallbackA, 2, 1.0f);
+		addRenderables(renderables, 10, drawCallbackB, 2, 1.0f); // Same key, other callback
+		addRenderables(renderables, 10, drawCallbackB, 2, 15.0f); // Other LOD
+		addRenderables(renderables, 10, drawCallbackB, 0, 15.0f); // Zero key, never merged
+		addRenderables(renderables, 40, drawCallbackA, 3, 100.0f);
+		addRenderables(renderables, 5, drawCallbackA, 3, 100.0f, false); // Same key but drawn by the CPU
+
+		// First instance, instance count, LOD and GPU culled
+		const Array<F32, 2> lodDistances = {10.0f, 20.0f};
+		const Array<Array<U32, 4>, 17> expectedBuckets = {{{0, 64, 0, 1},
+														   {64, 6, 0, 1},
+														   {70, 10, 0, 1},
+														   {80, 10, 0, 1},
+														   {90, 10, 1, 1},
+														   {100, 1, 1, 1},
+														   {101, 1, 1, 1},
+														   {102, 1, 1, 1},
+														   {103, 1, 1, 1},
+														   {104, 1, 1, 1},
+														   {105, 1, 1, 1},
+														   {106, 1, 1, 1},
+														   {107, 1, 1, 1},
+														   {108, 1, 1, 1},
+														   {109, 1, 1, 1},
+														   {110, 40, 2, 1},
+														   {150, 5, 2, 0}}};
+
+		for(U64 frame = 0; frame < MAX_FRAMES_IN_FLIGHT + 1; ++frame)
+		{
+			buckets.update(frame, ConstWeakArray<RenderableQueueElement>(&renderables[0], U32(renderables.size())),
+						   ConstWeakArray<F32>(&lodDistances[0], lodDistances.getSize()));
+
+			// The buffers grew to fit all the instances of all the frames in flight
+			ANKI_TEST_EXPECT_EQ(buckets.getInstanceCount(), renderables.size());
+			ANKI_TEST_EXPECT_EQ(buckets.getCapacity(), 256);
+			ANKI_TEST_EXPECT_EQ(buckets.getInstanceBuffer()->getSize(),
+								256 * MAX_FRAMES_IN_FLIGHT * sizeof(GpuCullingInstance));
+			ANKI_TEST_EXPECT_EQ(buckets.getIndirectArgsBuffer()->getSize(),
+								256 * MAX_FRAMES_IN_FLIGHT * sizeof(DrawElementsIndirectInfo));
+			ANKI_TEST_EXPECT_EQ(buckets.getInstanceRemapBuffer()->getSize(), 256 * MAX_FRAMES_IN_FLIGHT * sizeof(U32));
+			ANKI_TEST_EXPECT_EQ(buckets.getInstanceBufferOffset(),
+								(frame % MAX_FRAMES_IN_FLIGHT) * 256 * sizeof(GpuCullingInstance));
+			ANKI_TEST_EXPECT_EQ(buckets.getInstanceRemapBufferOffset(),
+								(frame % MAX_FRAMES_IN_FLIGHT) * 256 * sizeof(U32));
+			ANKI_TEST_EXPECT_EQ(buckets.hasCpuDrawnInstances(), true);
+
+			// Check the buckets
+			ANKI_TEST_EXPECT_EQ(buckets.getBuckets().getSize(), expectedBuckets.getSize());
+			for(U32 i = 0; i < expectedBuckets.getSize(); ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(buckets.getBuckets()[i].m_firstInstance, expectedBuckets[i][0]);
+				ANKI_TEST_EXPECT_EQ(buckets.getBuckets()[i].m_instanceCount, expectedBuckets[i][1]);
+				ANKI_TEST_EXPECT_EQ(buckets.getBuckets()[i].m_lod, expectedBuckets[i][2]);
+				ANKI_TEST_EXPECT_EQ(buckets.getBuckets()[i].m_gpuCulled, expectedBuckets[i][3] != 0);
+			}
+
+			// Check the AABBs and the slots that the GPU will read
+			BufferImpl& instanceBuff = static_cast<BufferImpl&>(*buckets.getInstanceBuffer());
+			const GpuCullingInstance* instances = reinterpret_cast<const GpuCullingInstance*>(
+				instanceBuff.getMemory() + buckets.getInstanceBufferOffset());
+			for(U32 i = 0; i < renderables.size(); ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(instances[i].m_aabbMin, renderables[i].m_aabbMin);
+				ANKI_TEST_EXPECT_EQ(instances[i].m_aabbMax, renderables[i].m_aabbMax);
+				ANKI_TEST_EXPECT_EQ(instances[i].m_gpuSceneSlot, renderables[i].m_gpuSceneSlot);
+			}
+
+			// One draw per bucket. It's in the part of the buffer that will be drawn and its instances start from the
+			// bucket's part of the remap buffer
+			BufferImpl& argsBuff = static_cast<BufferImpl&>(*buckets.getIndirectArgsBuffer());
+			ANKI_TEST_EXPECT_EQ(
+				reinterpret_cast<U8*>(buckets.getIndirectArgs(15)),
+				argsBuff.getMemory() + buckets.getIndirectArgsBufferOffset() + 15 * sizeof(DrawElementsIndirectInfo));
+			for(U32 i = 0; i < expectedBuckets.getSize() - 1; ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(buckets.getIndirectArgs(i)->m_baseInstance, expectedBuckets[i][0]);
+			}
+		}
+
+		// Without the CPU drawn renderables the Hi-Z can be trusted
+		renderables.resize(150);
+		buckets.update(0, ConstWeakArray<RenderableQueueElement>(&renderables[0], U32(renderables.size())),
+					   ConstWeakArray<F32>(&lodDistances[0], lodDistances.getSize()));
+		ANKI_TEST_EXPECT_EQ(buckets.hasCpuDrawnInstances(), false);
+	}
+
+	GrManager::deleteInstance(gr);
+}
+
+} // end namespace anki
+
+#endif
@@ -0,0 +1,243 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/LightBvhBuilder.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/shaders/include/LightBvhFunctions.h>
+
+namespace anki
+{
+
+static void buildLightBvh(U32 threadCount, ConstWeakArray<PointLightQueueElement> pointLights,
+						  ConstWeakArray<SpotLightQueueElement> spotLights, Bool shadowCastersOnly,
+						  std::vector<LightBvhNode>& nodes, std::vector<LightBvhLight>& lights)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(threadCount, alloc, false);
+	StackAllocator<U8> tempAlloc(allocAligned, nullptr, 8 * 1024 * 1024, 1.0f);
+
+	LightBvhBuilder builder;
+	builder.init(hive, tempAlloc, pointLights, spotLights, shadowCastersOnly);
+
+	nodes.resize(builder.getNodeCount());
+	lights.resize(builder.getLeafCount());
+	builder.build(WeakArray<LightBvhNode>(&nodes[0], builder.getNodeCount()),
+				  WeakArray<LightBvhLight>(&lights[0], builder.getLeafCount()));
+}
+
+/// Check that every node encloses its children and has their power.
+static void validateLightBvh(const std::vector<LightBvhNode>& nodes, const std::vector<LightBvhLight>& lights)
+{
+	const U32 leafCount = U32(lights.size());
+	ANKI_TEST_EXPECT_EQ(nodes.size(), leafCount * 2 - 1);
+
+	for(U32 i = 0; i < leafCount; ++i)
+	{
+		const LightBvhNode& leaf = nodes[leafCount - 1 + i];
+		const LightBvhLight& light = lights[i];
+		ANKI_TEST_EXPECT_EQ(leaf.m_power, light.m_power);
+		if(light.m_power > 0.0f)
+		{
+			ANKI_TEST_EXPECT_EQ(leaf.m_aabbMin <= light.m_position && leaf.m_aabbMax >= light.m_position, true);
+		}
+	}
+
+	for(U32 i = 0; i < leafCount - 1; ++i)
+	{
+		const LightBvhNode& node = nodes[i];
+		F32 power = 0.0f;
+		for(U32 c = 1; c <= 2; ++c)
+		{
+			const LightBvhNode& child = nodes[i * 2 + c];
+			power += child.m_power;
+			if(child.m_power > 0.0f)
+			{
+				ANKI_TEST_EXPECT_EQ(node.m_aabbMin <= child.m_aabbMin && node.m_aabbMax >= child.m_aabbMax, true);
+			}
+		}
+
+		ANKI_TEST_EXPECT_NEAR(node.m_power, power, node.m_power * 0.0001f);
+	}
+}
+
+/// Same as pickLight() of RtShadowsRayGen.ankiprog.
+static U32 pickLight(const std::vector<LightBvhNode>& nodes, U32 leafCount, const Vec3& pos, F32 random01)
+{
+	const U32 firstLeaf = leafCount - 1;
+	U32 nodeIdx = 0;
+	while(nodeIdx < firstLeaf)
+	{
+		const U32 leftIdx = nodeIdx * 2 + 1;
+		const U32 child = chooseLightBvhChild(computeLightBvhNodeImportance(nodes[leftIdx], pos),
+											  computeLightBvhNodeImportance(nodes[leftIdx + 1], pos), random01);
+		if(child == MAX_U32)
+		{
+			return MAX_U32;
+		}
+
+		nodeIdx = leftIdx + child;
+	}
+
+	if(computeLightBvhNodeImportance(nodes[nodeIdx], pos) <= 0.0f)
+	{
+		return MAX_U32;
+	}
+
+	return nodeIdx - firstLeaf;
+}
+
+ANKI_TEST(Renderer, LightBvhBuilder)
+{
+	// Lights with a power that is their index so they can be identified. Every third one has a shadow
+	RenderQueue shadowQueue;
+	std::vector<PointLightQueueElement> pointLights(3000);
+	for(U32 i = 0; i < pointLights.size(); ++i)
+	{
+		PointLightQueueElement& light = pointLights[i];
+		zeroMemory(light);
+		light.m_worldPosition = Vec3(getRandomRange(-100.0f, 100.0f), getRandomRange(-10.0f, 10.0f),
+									 getRandomRange(-100.0f, 100.0f));
+		light.m_radius = getRandomRange(0.5f, 8.0f);
+		light.m_diffuseColor = Vec3(F32(i + 1));
+		light.m_shadowRenderQueues[0] = (i % 3 == 0) ? &shadowQueue : nullptr;
+		light.m_shadowLayer = U8(i % 3 == 0);
+	}
+
+	std::vector<SpotLightQueueElement> spotLights(1000);
+	for(U32 i = 0; i < spotLights.size(); ++i)
+	{
+		SpotLightQueueElement& light = spotLights[i];
+		zeroMemory(light);
+		const Vec4 origin(getRandomRange(-100.0f, 100.0f), getRandomRange(-10.0f, 10.0f),
+						  getRandomRange(-100.0f, 100.0f), 0.0f);
+		light.m_worldTransform = Mat4(Transform(origin, Mat3x4::getIdentity(), 1.0f));
+		light.m_distance = getRandomRange(1.0f, 15.0f);
+		light.m_diffuseColor = Vec3(F32(pointLights.size() + i + 1));
+		light.m_shadowRenderQueue = (i % 3 == 0) ? &shadowQueue : nullptr;
+		light.m_shadowLayer = U8(2 + (i % 3 == 0));
+	}
+
+	const ConstWeakArray<PointLightQueueElement> pointLightsArr(&pointLights[0], U32(pointLights.size()));
+	const ConstWeakArray<SpotLightQueueElement> spotLightsArr(&spotLights[0], U32(spotLights.size()));
+
+	for(Bool shadowCastersOnly : {false, true})
+	{
+		std::vector<LightBvhNode> serialNodes, nodes;
+		std::vector<LightBvhLight> serialLights, lights;
+		buildLightBvh(1, pointLightsArr, spotLightsArr, shadowCastersOnly, serialNodes, serialLights);
+		buildLightBvh(8, pointLightsArr, spotLightsArr, shadowCastersOnly, nodes, lights);
+
+		validateLightBvh(nodes, lights);
+
+		// The tasks shouldn't change the result
+		ANKI_TEST_EXPECT_EQ(nodes.size(), serialNodes.size());
+		ANKI_TEST_EXPECT_EQ(memcmp(&nodes[0], &serialNodes[0], sizeof(nodes[0]) * nodes.size()), 0);
+		ANKI_TEST_EXPECT_EQ(memcmp(&lights[0], &serialLights[0], sizeof(lights[0]) * lights.size()), 0);
+
+		// Every light is in the tree once
+		std::vector<U32> lightLeafCounts(pointLights.size() + spotLights.size(), 0);
+		for(const LightBvhLight& light : lights)
+		{
+			if(light.m_power == 0.0f)
+			{
+				ANKI_TEST_EXPECT_EQ(light.m_shadowLayer, MAX_U32);
+				continue;
+			}
+
+			const U32 lightIdx = U32(light.m_power + 0.5f) - 1;
+			++lightLeafCounts[lightIdx];
+
+			if(lightIdx < pointLights.size())
+			{
+				const PointLightQueueElement& pointLight = pointLights[lightIdx];
+				ANKI_TEST_EXPECT_EQ(light.m_shadowLayer, (pointLight.hasShadow()) ? pointLight.m_shadowLayer : MAX_U32);
+			}
+			else
+			{
+				const SpotLightQueueElement& spotLight = spotLights[lightIdx - pointLights.size()];
+				ANKI_TEST_EXPECT_EQ(light.m_shadowLayer, (spotLight.hasShadow()) ? spotLight.m_shadowLayer : MAX_U32);
+			}
+		}
+
+		for(U32 i = 0; i < lightLeafCounts.size(); ++i)
+		{
+			const Bool hasShadow = (i % 3 == 0);
+			ANKI_TEST_EXPECT_EQ(lightLeafCounts[i], (hasShadow || !shadowCastersOnly) ? 1u : 0u);
+		}
+	}
+
+	// No lights
+	{
+		std::vector<LightBvhNode> nodes;
+		std::vector<LightBvhLight> lights;
+		buildLightBvh(4, ConstWeakArray<PointLightQueueElement>(), ConstWeakArray<SpotLightQueueElement>(), false,
+					  nodes, lights);
+		ANKI_TEST_EXPECT_EQ(nodes.size(), 1);
+		ANKI_TEST_EXPECT_EQ(nodes[0].m_power, 0.0f);
+		ANKI_TEST_EXPECT_EQ(lights[0].m_shadowLayer, MAX_U32);
+	}
+}
+
+ANKI_TEST(Renderer, LightBvhSampling)
+{
+	// 3 lights so there is a padding leaf. The padding leaf is the last one and the walk ends there if it goes right on
+	// every level
+	RenderQueue shadowQueue;
+	const Array<Vec3, 3> positions = {{Vec3(-50.0f, 0.0f, 0.0f), Vec3(50.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 50.0f)}};
+	std::vector<PointLightQueueElement> pointLights(positions.getSize());
+	for(U32 i = 0; i < pointLights.size(); ++i)
+	{
+		PointLightQueueElement& light = pointLights[i];
+		zeroMemory(light);
+		light.m_worldPosition = positions[i];
+		light.m_radius = 5.0f;
+		light.m_diffuseColor = Vec3(1.0f);
+		light.m_shadowRenderQueues[0] = &shadowQueue;
+		light.m_shadowLayer = U8(i);
+	}
+
+	std::vector<LightBvhNode> nodes;
+	std::vector<LightBvhLight> lights;
+	buildLightBvh(1, ConstWeakArray<PointLightQueueElement>(&pointLights[0], U32(pointLights.size())),
+				  ConstWeakArray<SpotLightQueueElement>(), true, nodes, lights);
+	const U32 leafCount = U32(lights.size());
+	ANKI_TEST_EXPECT_EQ(leafCount, 4);
+
+	for(U32 i = 0; i < 100; ++i)
+	{
+		const F32 random01 = F32(i) / 100.0f;
+
+		// Inside the root but outside of every light. Nothing is picked
+		ANKI_TEST_EXPECT_EQ(pickLight(nodes, leafCount, Vec3(0.0f), random01), MAX_U32);
+
+		// Next to a light. Only that is picked
+		for(U32 l = 0; l < positions.getSize(); ++l)
+		{
+			const U32 leafIdx = pickLight(nodes, leafCount, positions[l] + Vec3(1.0f), random01);
+			ANKI_TEST_EXPECT_NEQ(leafIdx, MAX_U32);
+			ANKI_TEST_EXPECT_EQ(lights[leafIdx].m_shadowLayer, l);
+		}
+	}
+
+	// Layers with usable history that were not traced keep the history
+	const U32 layer = 2;
+	const F32 nominalBlendFactor = 0.1f;
+	ANKI_TEST_EXPECT_EQ(shadowLayerNeedsTrace(layer, 0, nominalBlendFactor), false);
+	ANKI_TEST_EXPECT_EQ(computeShadowLayerBlendFactor(layer, 0, 1u << layer, nominalBlendFactor), nominalBlendFactor);
+	ANKI_TEST_EXPECT_EQ(computeShadowLayerBlendFactor(layer, 0, 0, nominalBlendFactor), 0.0f);
+
+	// Disoccluded pixels trace all the layers and don't use the history even if a layer wasn't traced
+	ANKI_TEST_EXPECT_EQ(shadowLayerNeedsTrace(layer, 0, 1.0f), true);
+	ANKI_TEST_EXPECT_EQ(computeShadowLayerBlendFactor(layer, 0, 0, 1.0f), 1.0f);
+
+	// Same for rejected layers
+	ANKI_TEST_EXPECT_EQ(shadowLayerNeedsTrace(layer, 1u << layer, nominalBlendFactor), true);
+	ANKI_TEST_EXPECT_EQ(shadowLayerNeedsTrace(layer, 1u << (layer + 1), nominalBlendFactor), false);
+	ANKI_TEST_EXPECT_EQ(computeShadowLayerBlendFactor(layer, 1u << layer, 0, nominalBlendFactor), 1.0f);
+}
+
+} // end namespace anki
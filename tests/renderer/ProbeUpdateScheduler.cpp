@@ -0,0 +1,140 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/ProbeUpdateScheduler.h>
+
+namespace anki
+{
+
+ANKI_TEST(Renderer, ProbeUpdateScheduler)
+{
+	const Vec3 nearMin(-1.0f), nearMax(1.0f);
+	const Vec3 farMin(99.0f), farMax(101.0f);
+	const U32 refreshPeriod = 100;
+	const U32 budgetPerFrame = 100;
+
+	// Priorities
+	{
+		ProbeUpdateScheduler scheduler;
+		scheduler.init(budgetPerFrame, refreshPeriod);
+		scheduler.beginFrame(1000, Vec3(0.0f), ConstWeakArray<Vec3>());
+
+		// Probes that were never rendered come first and the closest of them first
+		ProbeUpdateState state;
+		const F32 nearMandatory = scheduler.computePriority(nearMin, nearMax, state, true);
+		const F32 farMandatory = scheduler.computePriority(farMin, farMax, state, true);
+		ANKI_TEST_EXPECT_GT(nearMandatory, farMandatory);
+
+		// Unless an update already started
+		ProbeUpdateState startedState;
+		startedState.m_cost = 10;
+		ANKI_TEST_EXPECT_GT(scheduler.computePriority(farMin, farMax, startedState, true), nearMandatory);
+
+		// Fresh probes don't need a refresh
+		state.m_lastUpdateTimestamp = 1000 - refreshPeriod / 2;
+		ANKI_TEST_EXPECT_EQ(scheduler.computePriority(nearMin, nearMax, state, false), 0.0f);
+
+		// Stale probes do, the staler and the closer first
+		state.m_lastUpdateTimestamp = 1000 - refreshPeriod;
+		const F32 nearStale = scheduler.computePriority(nearMin, nearMax, state, false);
+		const F32 farStale = scheduler.computePriority(farMin, farMax, state, false);
+		ANKI_TEST_EXPECT_GT(nearStale, 0.0f);
+		ANKI_TEST_EXPECT_GT(nearStale, farStale);
+		ANKI_TEST_EXPECT_GT(farMandatory, nearStale);
+
+		state.m_lastUpdateTimestamp = 1000 - refreshPeriod * 2;
+		ANKI_TEST_EXPECT_GT(scheduler.computePriority(nearMin, nearMax, state, false), nearStale);
+	}
+
+	// Motion
+	{
+		ProbeUpdateScheduler scheduler;
+		scheduler.init(budgetPerFrame, refreshPeriod);
+
+		ProbeUpdateState nearState, farState;
+		nearState.m_lastUpdateTimestamp = farState.m_lastUpdateTimestamp = 1;
+
+		// An object moves inside the near probe for a few frames
+		const Array<Vec3, 2> movedObjects = {{Vec3(0.5f), Vec3(50.0f)}};
+		Timestamp ts = 2;
+		for(; ts < 20; ++ts)
+		{
+			scheduler.beginFrame(ts, Vec3(0.0f), movedObjects);
+			scheduler.trackMotion(nearMin, nearMax, nearState);
+			scheduler.trackMotion(farMin, farMax, farState);
+		}
+
+		ANKI_TEST_EXPECT_EQ(nearState.m_movedObjectCount, 18);
+		ANKI_TEST_EXPECT_EQ(farState.m_movedObjectCount, 0);
+		ANKI_TEST_EXPECT_GT(scheduler.computePriority(nearMin, nearMax, nearState, false), 0.0f);
+		ANKI_TEST_EXPECT_EQ(scheduler.computePriority(farMin, farMax, farState, false), 0.0f);
+
+		// The update resets it
+		scheduler.markUpdated(nearState);
+		ANKI_TEST_EXPECT_EQ(nearState.m_movedObjectCount, 0);
+		ANKI_TEST_EXPECT_EQ(nearState.m_lastUpdateTimestamp, ts - 1);
+		ANKI_TEST_EXPECT_EQ(scheduler.computePriority(nearMin, nearMax, nearState, false), 0.0f);
+	}
+
+	// Budget
+	{
+		ProbeUpdateScheduler scheduler;
+		scheduler.init(budgetPerFrame, refreshPeriod);
+		Timestamp ts = 1;
+
+		// Mandatory updates don't wait for the budget but they pay for it
+		ProbeUpdateState state;
+		scheduler.beginFrame(ts++, Vec3(0.0f), ConstWeakArray<Vec3>());
+		ANKI_TEST_EXPECT_EQ(scheduler.canAfford(state, true), true);
+		scheduler.consumeBudget(state, 250);
+		ANKI_TEST_EXPECT_EQ(scheduler.getBudget(), -150);
+		ANKI_TEST_EXPECT_EQ(state.m_cost, 250);
+
+		// A refresh of the same cost waits until the debt is paid and the budget builds up
+		U32 framesWaited = 0;
+		while(true)
+		{
+			scheduler.beginFrame(ts++, Vec3(0.0f), ConstWeakArray<Vec3>());
+			if(scheduler.canAfford(state, false))
+			{
+				break;
+			}
+			++framesWaited;
+		}
+		ANKI_TEST_EXPECT_EQ(framesWaited, 3);
+		scheduler.consumeBudget(state, 250);
+
+		// An update that costs more than the max budget happens when the budget is full
+		state.m_cost = 100 * budgetPerFrame;
+		framesWaited = 0;
+		while(true)
+		{
+			scheduler.beginFrame(ts++, Vec3(0.0f), ConstWeakArray<Vec3>());
+			if(scheduler.canAfford(state, false))
+			{
+				break;
+			}
+			++framesWaited;
+		}
+		ANKI_TEST_EXPECT_GT(framesWaited, 0);
+		ANKI_TEST_EXPECT_LT(framesWaited, 100);
+	}
+
+	// No budget, no refreshes
+	{
+		ProbeUpdateScheduler scheduler;
+		scheduler.init(0, refreshPeriod);
+		scheduler.beginFrame(1000, Vec3(0.0f), ConstWeakArray<Vec3>());
+
+		ProbeUpdateState state;
+		state.m_lastUpdateTimestamp = 1;
+		ANKI_TEST_EXPECT_EQ(scheduler.computePriority(nearMin, nearMax, state, false), 0.0f);
+		ANKI_TEST_EXPECT_EQ(scheduler.canAfford(state, false), false);
+		ANKI_TEST_EXPECT_EQ(scheduler.canAfford(state, true), true);
+	}
+}
+
+} // end namespace anki
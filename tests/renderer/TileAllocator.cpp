@@ -5,6 +5,7 @@
 
 #include <tests/framework/Framework.h>
 #include <anki/renderer/TileAllocator.h>
+#include <anki/scene/VisibilityInternal.h>
 
 namespace anki
 {
@@ -71,4 +72,99 @@ ANKI_TEST(Renderer, TileAllocator)
 	}
 }
 
-} // end namespace anki
\ No newline at end of file
+/// Split the shadow casters of a light face like the visibility does and allocate a static shadow cache tile like the
+/// ShadowMapping does.
+static TileAllocatorResult allocateStaticCacheTile(TileAllocator& talloc, Timestamp crntTimestamp,
+												   Timestamp lightTimestamp, const std::vector<Timestamp>& casters,
+												   U32& staticCasterCount)
+{
+	staticCasterCount = 0;
+	Timestamp staticTimestamp = lightTimestamp;
+	for(Timestamp casterTimestamp : casters)
+	{
+		if(isStaticShadowCaster(casterTimestamp, crntTimestamp))
+		{
+			++staticCasterCount;
+			staticTimestamp = accumulateStaticShadowTimestamp(staticTimestamp, casterTimestamp);
+		}
+	}
+
+	if(staticCasterCount == 0)
+	{
+		// No static layer
+		return TileAllocatorResult::ALLOCATION_FAILED;
+	}
+
+	Array<U32, 4> viewport;
+	return talloc.allocate(crntTimestamp, staticTimestamp, 1, 0, staticCasterCount, 0, viewport);
+}
+
+ANKI_TEST(Renderer, ShadowStaticCache)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	TileAllocator talloc;
+	talloc.init(alloc, 8, 8, 3, true);
+
+	// 3 casters that are created with the light
+	Timestamp crntTimestamp = 1;
+	Timestamp lightTimestamp = 1;
+	std::vector<Timestamp> casters = {1, 1, 1};
+	U32 staticCasterCount;
+
+	// The casters are dynamic until their timestamp settles
+	for(; crntTimestamp < 1 + STATIC_SHADOW_CASTER_MIN_FRAMES; ++crntTimestamp)
+	{
+		ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp, lightTimestamp, casters, staticCasterCount),
+							TileAllocatorResult::ALLOCATION_FAILED);
+		ANKI_TEST_EXPECT_EQ(staticCasterCount, 0);
+	}
+
+	// Then they become static. The cache is rendered once and then reused
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::ALLOCATION_SUCCEEDED);
+	ANKI_TEST_EXPECT_EQ(staticCasterCount, 3);
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::CACHED);
+
+	// A caster moves. The count changes so the cache is invalidated
+	casters[1] = crntTimestamp;
+	const Timestamp movedCasterStaticTimestamp = crntTimestamp + STATIC_SHADOW_CASTER_MIN_FRAMES;
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::ALLOCATION_SUCCEEDED);
+	ANKI_TEST_EXPECT_EQ(staticCasterCount, 2);
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::CACHED);
+
+	// A new caster appears. It's dynamic so the static layer stays
+	casters.push_back(crntTimestamp);
+	for(; crntTimestamp < movedCasterStaticTimestamp; ++crntTimestamp)
+	{
+		ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp, lightTimestamp, casters, staticCasterCount),
+							TileAllocatorResult::CACHED);
+	}
+
+	// The moved caster becomes static again
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::ALLOCATION_SUCCEEDED);
+	ANKI_TEST_EXPECT_EQ(staticCasterCount, 3);
+
+	// Find the frame that the new caster becomes static and move another caster the same frame. The count stays the
+	// same but the timestamp of the layer changes
+	crntTimestamp = casters[3] + STATIC_SHADOW_CASTER_MIN_FRAMES;
+	casters[0] = crntTimestamp;
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::ALLOCATION_SUCCEEDED);
+	ANKI_TEST_EXPECT_EQ(staticCasterCount, 3);
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::CACHED);
+
+	// The light moves
+	lightTimestamp = crntTimestamp;
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::ALLOCATION_SUCCEEDED);
+	ANKI_TEST_EXPECT_EQ(allocateStaticCacheTile(talloc, crntTimestamp++, lightTimestamp, casters, staticCasterCount),
+						TileAllocatorResult::CACHED);
+}
+
+} // end namespace anki
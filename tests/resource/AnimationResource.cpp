@@ -0,0 +1,129 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include <anki/resource/AnimationResource.h>
+
+namespace anki
+{
+
+/// The old way of sampling a channel. Linear search and slerp.
+static void referenceSample(const AnimationChannel& channel, Second time, Vec3& pos, Quat& rot)
+{
+	for(U32 i = 0; i < channel.m_positions.getSize() - 1; ++i)
+	{
+		const auto& left = channel.m_positions[i];
+		const auto& right = channel.m_positions[i + 1];
+		if(time >= left.getTime() && time <= right.getTime())
+		{
+			const F32 u = F32((time - left.getTime()) / (right.getTime() - left.getTime()));
+			pos = linearInterpolate(left.getValue(), right.getValue(), u);
+			break;
+		}
+	}
+
+	for(U32 i = 0; i < channel.m_rotations.getSize() - 1; ++i)
+	{
+		const auto& left = channel.m_rotations[i];
+		const auto& right = channel.m_rotations[i + 1];
+		if(time >= left.getTime() && time <= right.getTime())
+		{
+			const F32 u = F32((time - left.getTime()) / (right.getTime() - left.getTime()));
+			rot = left.getValue().slerp(right.getValue(), u);
+			break;
+		}
+	}
+}
+
+} // end namespace anki
+
+ANKI_TEST(Resource, AnimationSampling)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Create a rig of 200 bones with 2 seconds of 30FPS keys
+	const U32 boneCount = 200;
+	const U32 keyCount = 61;
+	DynamicArrayAuto<AnimationChannel> channels(alloc, boneCount);
+	for(U32 b = 0; b < boneCount; ++b)
+	{
+		AnimationChannel& channel = channels[b];
+		channel.m_positions.create(alloc, keyCount);
+		channel.m_rotations.create(alloc, keyCount);
+		for(U32 k = 0; k < keyCount; ++k)
+		{
+			const Second time = Second(k) / 30.0;
+			const F32 angle = F32(time) * PI * 0.5f + F32(b) * 0.1f;
+			channel.m_positions[k] = {time, Vec3(sin(angle), cos(angle), F32(b))};
+			channel.m_rotations[k] = {time, Quat(Axisang(angle, Vec3(0.0f, 1.0f, 0.0f)))};
+		}
+	}
+
+	DynamicArrayAuto<Vec3> positions(alloc, boneCount);
+	DynamicArrayAuto<Quat> rotations(alloc, boneCount);
+	DynamicArrayAuto<F32> scales(alloc, boneCount);
+
+	// Compare with the reference
+	for(Second time : {0.0, 0.01, 0.5, 1.0 / 3.0, 1.999, 2.0})
+	{
+		sampleAnimationChannels(ConstWeakArray<AnimationChannel>(channels), time, WeakArray<Vec3>(positions),
+								WeakArray<Quat>(rotations), WeakArray<F32>(scales));
+
+		for(U32 b = 0; b < boneCount; ++b)
+		{
+			Vec3 refPos;
+			Quat refRot;
+			referenceSample(channels[b], time, refPos, refRot);
+
+			ANKI_TEST_EXPECT_NEAR(positions[b].x(), refPos.x(), 0.0001f);
+			ANKI_TEST_EXPECT_NEAR(positions[b].y(), refPos.y(), 0.0001f);
+			ANKI_TEST_EXPECT_NEAR(positions[b].z(), refPos.z(), 0.0001f);
+			ANKI_TEST_EXPECT_NEAR(rotations[b].x(), refRot.x(), 0.0001f);
+			ANKI_TEST_EXPECT_NEAR(rotations[b].y(), refRot.y(), 0.0001f);
+			ANKI_TEST_EXPECT_NEAR(rotations[b].z(), refRot.z(), 0.0001f);
+			ANKI_TEST_EXPECT_NEAR(rotations[b].w(), refRot.w(), 0.0001f);
+			ANKI_TEST_EXPECT_EQ(scales[b], 1.0f);
+		}
+	}
+
+	// Single key tracks, empty tracks and times outside of the keys give the defaults
+	{
+		DynamicArrayAuto<AnimationChannel> edgeChannels(alloc, 2);
+		edgeChannels[0].m_positions.create(alloc, 1);
+		edgeChannels[0].m_positions[0] = {0.5, Vec3(1.0f, 2.0f, 3.0f)};
+		edgeChannels[1].m_positions.create(alloc, 2);
+		edgeChannels[1].m_positions[0] = {0.5, Vec3(1.0f)};
+		edgeChannels[1].m_positions[1] = {1.0, Vec3(3.0f)};
+		edgeChannels[1].m_scales.create(alloc, 2);
+		edgeChannels[1].m_scales[0] = {0.5, 2.0f};
+		edgeChannels[1].m_scales[1] = {1.0, 4.0f};
+
+		for(Second time : {0.0, 0.5, 1.0, 2.0})
+		{
+			sampleAnimationChannels(ConstWeakArray<AnimationChannel>(edgeChannels), time, WeakArray<Vec3>(positions),
+									WeakArray<Quat>(rotations), WeakArray<F32>(scales));
+
+			const Bool inside = time >= 0.5 && time <= 1.0;
+			ANKI_TEST_EXPECT_EQ(positions[0], Vec3(0.0f));
+			ANKI_TEST_EXPECT_EQ(positions[1], (inside) ? Vec3((time == 0.5) ? 1.0f : 3.0f) : Vec3(0.0f));
+			ANKI_TEST_EXPECT_EQ(scales[0], 1.0f);
+			ANKI_TEST_EXPECT_EQ(scales[1], (inside) ? ((time == 0.5) ? 2.0f : 4.0f) : 1.0f);
+			for(U32 c = 0; c < 2; ++c)
+			{
+				ANKI_TEST_EXPECT_EQ(rotations[c], Quat::getIdentity());
+			}
+		}
+
+		for(AnimationChannel& channel : edgeChannels)
+		{
+			channel.destroy(alloc);
+		}
+	}
+
+	for(AnimationChannel& channel : channels)
+	{
+		channel.destroy(alloc);
+	}
+}
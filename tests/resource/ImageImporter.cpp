@@ -0,0 +1,207 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include <anki/importer/ImageImporter.h>
+
+namespace anki
+{
+
+/// Reads the fields of a 128bit block starting from the LSB.
+class BlockBitReader
+{
+public:
+	const U8* m_block;
+	U32 m_bitOffset = 0;
+
+	BlockBitReader(const U8* block)
+		: m_block(block)
+	{
+	}
+
+	U32 getBit(U32 bit) const
+	{
+		return (m_block[bit / 8] >> (bit % 8)) & 1;
+	}
+
+	U32 read(U32 bitCount)
+	{
+		U32 value = 0;
+		for(U32 i = 0; i < bitCount; ++i)
+		{
+			value |= getBit(m_bitOffset + i) << i;
+		}
+
+		m_bitOffset += bitCount;
+		return value;
+	}
+};
+
+static void decodeBc4Block(const U8* block, U32 channel, U8* rgba)
+{
+	Array<U32, 8> palette;
+	palette[0] = block[0];
+	palette[1] = block[1];
+	for(U32 i = 2; i < 8; ++i)
+	{
+		palette[i] = (block[0] > block[1]) ? ((8 - i) * block[0] + (i - 1) * block[1]) / 7
+										   : ((i < 6) ? ((6 - i) * block[0] + (i - 1) * block[1]) / 5 : (i - 6) * 255);
+	}
+
+	BlockBitReader reader(block);
+	reader.m_bitOffset = 16;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		rgba[i * 4 + channel] = U8(palette[reader.read(3)]);
+	}
+}
+
+static void decodeBc7Block(const U8* block, U8* rgba)
+{
+	BlockBitReader reader(block);
+	ANKI_TEST_EXPECT_EQ(reader.read(7), 1u << 6); // Only mode 6 is expected
+
+	Array2d<U32, 2, 4> endpoints;
+	for(U32 c = 0; c < 4; ++c)
+	{
+		endpoints[0][c] = reader.read(7) << 1;
+		endpoints[1][c] = reader.read(7) << 1;
+	}
+
+	const U32 p0 = reader.read(1);
+	const U32 p1 = reader.read(1);
+	static const Array<U32, 16> weights = {{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64}};
+	for(U32 i = 0; i < 16; ++i)
+	{
+		const U32 w = weights[reader.read((i == 0) ? 3 : 4)];
+		for(U32 c = 0; c < 4; ++c)
+		{
+			rgba[i * 4 + c] = U8(((endpoints[0][c] | p0) * (64 - w) + (endpoints[1][c] | p1) * w + 32) >> 6);
+		}
+	}
+}
+
+/// Decodes the subset of ASTC 4x4 that compressAstcBlock() produces.
+static void decodeAstcBlock(const U8* block, U8* rgba)
+{
+	BlockBitReader reader(block);
+	const U32 blockMode = reader.read(11);
+	ANKI_TEST_EXPECT_EQ(blockMode == 0x53 || blockMode == 0x42, true);
+	ANKI_TEST_EXPECT_EQ(reader.read(2), 0u); // Single partition
+
+	const U32 cem = reader.read(4);
+	const Bool opaque = blockMode == 0x53;
+	ANKI_TEST_EXPECT_EQ(cem, (opaque) ? 8u : 12u);
+
+	Array<U32, 8> v;
+	for(U32 i = 0; i < ((opaque) ? 6u : 8u); ++i)
+	{
+		v[i] = reader.read(8);
+	}
+
+	// The encoder should never trigger the blue contraction
+	ANKI_TEST_EXPECT_GEQ(v[1] + v[3] + v[5], v[0] + v[2] + v[4]);
+	const Array<U32, 4> e0 = {{v[0], v[2], v[4], (opaque) ? 255 : v[6]}};
+	const Array<U32, 4> e1 = {{v[1], v[3], v[5], (opaque) ? 255 : v[7]}};
+
+	static const Array<U32, 8> weights3 = {{0, 9, 18, 27, 37, 46, 55, 64}};
+	static const Array<U32, 4> weights2 = {{0, 21, 43, 64}};
+	const U32 weightBitCount = (opaque) ? 3 : 2;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		// Weights are stored bit reversed from the top of the block
+		U32 q = 0;
+		for(U32 bit = 0; bit < weightBitCount; ++bit)
+		{
+			q |= reader.getBit(127 - (i * weightBitCount + bit)) << bit;
+		}
+		const U32 w = (opaque) ? weights3[q] : weights2[q];
+
+		for(U32 c = 0; c < 4; ++c)
+		{
+			const U32 c0 = (e0[c] << 8) | e0[c];
+			const U32 c1 = (e1[c] << 8) | e1[c];
+			rgba[i * 4 + c] = U8(((c0 * (64 - w) + c1 * w + 32) >> 6) >> 8);
+		}
+	}
+}
+
+/// Root mean square error of the channels in [firstChannel, lastChannel].
+static F32 computeBlockError(const U8* a, const U8* b, U32 firstChannel, U32 lastChannel)
+{
+	F32 error = 0.0f;
+	for(U32 i = 0; i < 16; ++i)
+	{
+		for(U32 c = firstChannel; c <= lastChannel; ++c)
+		{
+			const F32 d = F32(a[i * 4 + c]) - F32(b[i * 4 + c]);
+			error += d * d;
+		}
+	}
+
+	return sqrt(error / F32(16 * (lastChannel - firstChannel + 1)));
+}
+
+} // end namespace anki
+
+ANKI_TEST(Resource, ImageBlockEncoders)
+{
+	// A gradient, a noisy block, an opaque 2D gradient and a solid color
+	Array<Array<U8, 16 * 4>, 4> blocks;
+	for(U32 t = 0; t < 16; ++t)
+	{
+		const U32 x = t % 4;
+		const U32 y = t / 4;
+		const U8 gradient[] = {U8(40 + t * 10), U8(200 - t * 12), U8(90 + t * 4), U8(255 - t * 10)};
+		memcpy(&blocks[0][t * 4], gradient, 4);
+
+		for(U32 c = 0; c < 4; ++c)
+		{
+			blocks[1][t * 4 + c] = U8(getRandom());
+		}
+
+		const U8 opaque[] = {U8(x * 60), U8(x * 50 + 20), U8(y * 30), 255};
+		memcpy(&blocks[2][t * 4], opaque, 4);
+
+		const U8 solid[] = {10, 128, 250, 255};
+		memcpy(&blocks[3][t * 4], solid, 4);
+	}
+
+	// The max RMS error of BC4/BC5, BC7 and ASTC for each block
+	const Array2d<F32, 4, 3> maxErrors = {{{{8.0f, 2.0f, 14.0f}},
+										   {{20.0f, 90.0f, 90.0f}},
+										   {{8.0f, 24.0f, 24.0f}},
+										   {{1.0f, 1.0f, 1.0f}}}};
+
+	for(U32 b = 0; b < blocks.getSize(); ++b)
+	{
+		const U8* texels = &blocks[b][0];
+		Array<U8, 16> compressed;
+		Array<U8, 16 * 4> decoded = {};
+
+		compressBc4Block(texels, &compressed[0]);
+		decodeBc4Block(&compressed[0], 0, &decoded[0]);
+		ANKI_TEST_EXPECT_LEQ(computeBlockError(texels, &decoded[0], 0, 0), maxErrors[b][0]);
+
+		compressBc5Block(texels, &compressed[0]);
+		decodeBc4Block(&compressed[0], 0, &decoded[0]);
+		decodeBc4Block(&compressed[8], 1, &decoded[0]);
+		ANKI_TEST_EXPECT_LEQ(computeBlockError(texels, &decoded[0], 0, 1), maxErrors[b][0]);
+
+		compressBc7Block(texels, &compressed[0]);
+		decodeBc7Block(&compressed[0], &decoded[0]);
+		ANKI_TEST_EXPECT_LEQ(computeBlockError(texels, &decoded[0], 0, 3), maxErrors[b][1]);
+
+		compressAstcBlock(texels, &compressed[0]);
+		decodeAstcBlock(&compressed[0], &decoded[0]);
+		ANKI_TEST_EXPECT_LEQ(computeBlockError(texels, &decoded[0], 0, 3), maxErrors[b][2]);
+
+		// Opaque blocks stay opaque
+		for(U32 t = 0; t < 16 && b >= 2; ++t)
+		{
+			ANKI_TEST_EXPECT_EQ(decoded[t * 4 + 3], 255);
+		}
+	}
+}
@@ -0,0 +1,95 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include "tests/framework/Framework.h"
+#include <anki/resource/ImageTranscoder.h>
+#include <anki/importer/ImageImporter.h>
+
+namespace anki
+{
+
+/// Create a surface of S3TC blocks out of a smooth image so the data looks like the real thing.
+static void createS3tcSurface(U32 size, Bool bc3, DynamicArrayAuto<U8>& blocks)
+{
+	const U32 blockSize = (bc3) ? 16 : 8;
+	const U32 blockCount = (size / 4) * (size / 4);
+	blocks.create(blockCount * blockSize);
+
+	Array<U8, 16 * 4> texels;
+	for(U32 b = 0; b < blockCount; ++b)
+	{
+		const U32 bx = (b % (size / 4)) * 4;
+		const U32 by = (b / (size / 4)) * 4;
+		for(U32 t = 0; t < 16; ++t)
+		{
+			const U32 x = bx + t % 4;
+			const U32 y = by + t / 4;
+			texels[t * 4 + 0] = U8(x * 255 / size);
+			texels[t * 4 + 1] = U8(y * 255 / size);
+			texels[t * 4 + 2] = U8(((x ^ y) & 0xF) * 16);
+			texels[t * 4 + 3] = U8((x + y) * 255 / (size * 2));
+		}
+
+		if(bc3)
+		{
+			compressBc3Block(&texels[0], &blocks[b * blockSize]);
+		}
+		else
+		{
+			compressBc1Block(&texels[0], &blocks[b * blockSize]);
+		}
+	}
+}
+
+} // end namespace anki
+
+ANKI_TEST(Resource, ImageTranscoder)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Split and merge round trip. Use a block count that is not a multiple of the SIMD width
+	for(Bool bc3 : {false, true})
+	{
+		const U32 blockSize = (bc3) ? 16 : 8;
+		const U32 blockCount = 4 * 7 + 3;
+		DynamicArrayAuto<U8> blocks(alloc);
+		blocks.create(blockCount * blockSize);
+		for(U8& b : blocks)
+		{
+			b = U8(getRandom());
+		}
+
+		DynamicArrayAuto<U8> streams(alloc, blocks.getSize());
+		splitS3tcBlocks(blocks, bc3, WeakArray<U8>(streams));
+
+		DynamicArrayAuto<U8> merged(alloc, blocks.getSize());
+		mergeS3tcBlocks(streams, bc3, WeakArray<U8>(merged));
+
+		ANKI_TEST_EXPECT_EQ(memcmp(&blocks[0], &merged[0], blocks.getSize()), 0);
+	}
+
+	// Supercompress and transcode a real looking surface
+	for(Bool bc3 : {false, true})
+	{
+		DynamicArrayAuto<U8> blocks(alloc);
+		createS3tcSurface(256, bc3, blocks);
+
+		DynamicArrayAuto<U8> compressed(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(compressS3tcZlib(blocks, bc3, compressed));
+		ANKI_TEST_EXPECT_LT(compressed.getSize(), blocks.getSize());
+
+		DynamicArrayAuto<U8> transcoded(alloc, blocks.getSize());
+		ANKI_TEST_EXPECT_NO_ERR(transcodeS3tcZlib(compressed, bc3, alloc, WeakArray<U8>(transcoded)));
+		ANKI_TEST_EXPECT_EQ(memcmp(&blocks[0], &transcoded[0], blocks.getSize()), 0);
+		ANKI_TEST_EXPECT_LEQ(compressed.getSize(), computeS3tcZlibMaxSize(blocks.getSize()));
+
+		// Empty and truncated surfaces fail
+		ANKI_TEST_EXPECT_EQ(transcodeS3tcZlib(ConstWeakArray<U8>(), bc3, alloc, WeakArray<U8>(transcoded)),
+							Error::USER_DATA);
+		ANKI_TEST_EXPECT_EQ(transcodeS3tcZlib(ConstWeakArray<U8>(&compressed[0], compressed.getSize() / 2), bc3, alloc,
+											  WeakArray<U8>(transcoded)),
+							Error::USER_DATA);
+	}
+}
@@ -0,0 +1,189 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/resource/MaterialResource.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/File.h>
+#include <anki/util/ThreadHive.h>
+
+namespace anki
+{
+
+static const char* MATERIAL_SRC = R"(<?xml version="1.0" encoding="UTF-8" ?>
+<material shaderProgram="anki/shaders/GBufferGeneric.ankiprog">
+	<mutation>
+		<mutator name="DIFFUSE_TEX" value="0"/>
+		<mutator name="SPECULAR_TEX" value="0"/>
+		<mutator name="ROUGHNESS_TEX" value="0"/>
+		<mutator name="METAL_TEX" value="0"/>
+		<mutator name="NORMAL_TEX" value="0"/>
+		<mutator name="PARALLAX" value="0"/>
+		<mutator name="EMISSIVE_TEX" value="0"/>
+	</mutation>
+
+	<inputs>
+		<input shaderVar="m_diffColor" value="0.5 0.5 0.5"/>
+		<input shaderVar="m_specColor" value="0.04 0.04 0.04"/>
+		<input shaderVar="m_roughness" value="0.5"/>
+		<input shaderVar="m_metallic" value="0.0"/>
+		<input shaderVar="m_emission" value="0.0 0.0 0.0"/>
+		<input shaderVar="m_subsurface" value="0.0"/>
+	</inputs>
+</material>
+)";
+
+/// Looks up the same variants many times from a thread.
+class VariantLookupTask
+{
+public:
+	static const U32 ITERATION_COUNT = 1000;
+
+	const MaterialResource* m_mtl = nullptr;
+	ConstWeakArray<RenderingKey> m_keys;
+	Barrier* m_barrier = nullptr; ///< All tasks start looking up at the same time.
+	std::vector<const MaterialVariant*> m_variants; ///< What the 1st iteration found.
+	U32 m_mismatchCount = 0; ///< How many times a later iteration found something else.
+
+	void run()
+	{
+		m_variants.resize(m_keys.getSize());
+		m_barrier->wait();
+		for(U32 i = 0; i < ITERATION_COUNT; ++i)
+		{
+			for(U32 k = 0; k < m_keys.getSize(); ++k)
+			{
+				const MaterialVariant& variant = m_mtl->getOrCreateVariant(m_keys[k]);
+				if(i == 0)
+				{
+					m_variants[k] = &variant;
+				}
+				else
+				{
+					m_mismatchCount += m_variants[k] != &variant;
+				}
+			}
+		}
+	}
+};
+
+/// Run one VariantLookupTask per thread and check that all threads got the same variants. There are as many tasks as
+/// threads so every task runs in its own thread and the barrier can't deadlock.
+static void lookupVariantsFromThreads(ThreadHive& hive, const MaterialResource& mtl, ConstWeakArray<RenderingKey> keys,
+									  std::vector<const MaterialVariant*>& variants)
+{
+	Barrier barrier(hive.getThreadCount());
+	std::vector<VariantLookupTask> tasks(hive.getThreadCount());
+	std::vector<ThreadHiveTask> hiveTasks;
+	for(VariantLookupTask& task : tasks)
+	{
+		task.m_mtl = &mtl;
+		task.m_keys = keys;
+		task.m_barrier = &barrier;
+		hiveTasks.push_back(ANKI_THREAD_HIVE_TASK({ self->run(); }, &task, nullptr, nullptr));
+	}
+
+	hive.submitTasks(&hiveTasks[0], U32(hiveTasks.size()));
+	hive.waitAllTasks();
+
+	variants = tasks[0].m_variants;
+	for(const VariantLookupTask& task : tasks)
+	{
+		ANKI_TEST_EXPECT_EQ(task.m_mismatchCount, 0);
+		ANKI_TEST_EXPECT_EQ(task.m_variants == variants, true);
+	}
+
+	for(const MaterialVariant* variant : variants)
+	{
+		ANKI_TEST_EXPECT_NEQ(variant->getShaderProgram().get(), nullptr);
+	}
+}
+
+} // end namespace anki
+
+ANKI_TEST(Resource, MaterialVariants)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	initConfig(cfg);
+
+	NativeWindow* win = createWindow(cfg);
+	GrManager* gr = createGrManager(cfg, win);
+	PhysicsWorld* physics;
+	ResourceFilesystem* fs;
+	ResourceManager* resources = createResourceManager(cfg, gr, physics, fs);
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("test_material.ankimtl", FileOpenFlag::WRITE));
+		ANKI_TEST_EXPECT_NO_ERR(file.writeText("%s", MATERIAL_SRC));
+	}
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(4, alloc, false);
+
+	{
+		MaterialResourcePtr mtl;
+		ANKI_TEST_EXPECT_NO_ERR(resources->loadResource("test_material.ankimtl", mtl));
+
+		// The keys that warmupVariants() of a non skinned model creates
+		std::vector<RenderingKey> keys;
+		const U32 instanceGroupCount = (mtl->isInstanced()) ? MAX_INSTANCE_GROUPS : 1;
+		for(Pass pass : {Pass::GB, Pass::SM, Pass::EZ})
+		{
+			if(pass == Pass::SM && !mtl->castsShadow())
+			{
+				continue;
+			}
+
+			for(U32 lod = 0; lod < mtl->getLodCount(); ++lod)
+			{
+				for(U32 instanceGroup = 0; instanceGroup < instanceGroupCount; ++instanceGroup)
+				{
+					keys.push_back(RenderingKey(pass, lod, 1 << instanceGroup, false, false));
+					if(pass == Pass::GB)
+					{
+						keys.push_back(RenderingKey(pass, lod, 1 << instanceGroup, false, true));
+					}
+				}
+			}
+		}
+
+		for(const RenderingKey& key : keys)
+		{
+			ANKI_TEST_EXPECT_EQ(mtl->isVariantCreated(key), false);
+		}
+
+		// Warm up and look up the variants from many threads. They are all created so the lookups don't lock
+		mtl->warmupVariants(false);
+		for(const RenderingKey& key : keys)
+		{
+			ANKI_TEST_EXPECT_EQ(mtl->isVariantCreated(key), true);
+		}
+
+		std::vector<const MaterialVariant*> variants;
+		lookupVariantsFromThreads(hive, *mtl, ConstWeakArray<RenderingKey>(&keys[0], U32(keys.size())), variants);
+		for(U32 k = 0; k < keys.size(); ++k)
+		{
+			ANKI_TEST_EXPECT_EQ(variants[k], &mtl->getOrCreateVariant(keys[k]));
+		}
+
+		// The skinned variants were not warmed up. All threads ask for one at the same time, it's created under the
+		// lock once and then it's found without locking
+		const RenderingKey skinnedKey(Pass::GB, 0, 1, true, false);
+		ANKI_TEST_EXPECT_EQ(mtl->isVariantCreated(skinnedKey), false);
+
+		lookupVariantsFromThreads(hive, *mtl, ConstWeakArray<RenderingKey>(&skinnedKey, 1), variants);
+		ANKI_TEST_EXPECT_EQ(mtl->isVariantCreated(skinnedKey), true);
+		ANKI_TEST_EXPECT_EQ(variants[0], &mtl->getOrCreateVariant(skinnedKey));
+		ANKI_TEST_EXPECT_NEQ(variants[0]->getShaderProgram(), mtl->getOrCreateVariant(keys[0]).getShaderProgram());
+	}
+
+	delete resources;
+	delete physics;
+	delete fs;
+	GrManager::deleteInstance(gr);
+	delete win;
+}
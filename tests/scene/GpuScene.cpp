@@ -0,0 +1,93 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/GpuScene.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/core/ConfigSet.h>
+
+namespace anki
+{
+
+ANKI_TEST(Scene, GpuScene)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	cfg.set("width", 64);
+	cfg.set("height", 64);
+	GrManager* gr = createGrManager(cfg, nullptr);
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	{
+		StackAllocator<U8> frameAlloc(allocAligned, nullptr, 1024 * 1024);
+		GpuScene scene;
+		scene.init(alloc, gr, 3);
+		ANKI_TEST_EXPECT_EQ(scene.getCapacity(), 4);
+		const Buffer* firstBuffer = scene.getBuffer().get();
+
+		// Allocate and set some slots
+		Array<U32, 4> slots;
+		for(U32 i = 0; i < slots.getSize(); ++i)
+		{
+			slots[i] = scene.allocateSlot();
+			ANKI_TEST_EXPECT_EQ(slots[i], i);
+			scene.setSlot(slots[i], Mat4(F32(i)), Mat4(F32(i + 10)));
+		}
+		ANKI_TEST_EXPECT_EQ(scene.getAllocatedSlotCount(), 4);
+
+		// Setting twice uploads once
+		scene.setSlot(slots[1], Mat4(100.0f), Mat4(1.0f));
+
+		GpuSceneQueueElement el;
+		scene.fillRenderQueue(frameAlloc, el);
+		ANKI_TEST_EXPECT_EQ(el.m_buffer, firstBuffer);
+		ANKI_TEST_EXPECT_EQ(el.m_updateCount, 4);
+		for(U32 i = 0; i < el.m_updateCount; ++i)
+		{
+			const GpuSceneUpdate& update = el.m_updates[i];
+			ANKI_TEST_EXPECT_EQ(update.m_slot, slots[i]);
+			const F32 expected = (i == 1) ? 100.0f : F32(i);
+			ANKI_TEST_EXPECT_EQ(update.m_instance.m_worldTransform(0, 0), expected);
+		}
+
+		// Nothing changed
+		scene.fillRenderQueue(frameAlloc, el);
+		ANKI_TEST_EXPECT_EQ(el.m_updateCount, 0);
+
+		// A freed slot is not uploaded and it's reused
+		scene.setSlot(slots[2], Mat4(5.0f), Mat4(5.0f));
+		scene.setSlot(slots[3], Mat4(6.0f), Mat4(6.0f));
+		scene.freeSlot(slots[2]);
+		scene.fillRenderQueue(frameAlloc, el);
+		ANKI_TEST_EXPECT_EQ(el.m_updateCount, 1);
+		ANKI_TEST_EXPECT_EQ(el.m_updates[0].m_slot, slots[3]);
+		ANKI_TEST_EXPECT_EQ(el.m_updates[0].m_instance.m_previousWorldTransform(0, 0), 6.0f);
+
+		slots[2] = scene.allocateSlot();
+		ANKI_TEST_EXPECT_EQ(slots[2], 2);
+		ANKI_TEST_EXPECT_EQ(scene.getAllocatedSlotCount(), 4);
+
+		// Grow. All the allocated slots go to the new buffer
+		const U32 extraSlot = scene.allocateSlot();
+		scene.setSlot(extraSlot, Mat4(7.0f), Mat4(7.0f));
+		scene.fillRenderQueue(frameAlloc, el);
+		ANKI_TEST_EXPECT_EQ(scene.getCapacity(), 8);
+		ANKI_TEST_EXPECT_NEQ(el.m_buffer, firstBuffer);
+		ANKI_TEST_EXPECT_EQ(el.m_updateCount, 5);
+
+		scene.fillRenderQueue(frameAlloc, el);
+		ANKI_TEST_EXPECT_EQ(el.m_updateCount, 0);
+
+		for(U32 slot : slots)
+		{
+			scene.freeSlot(slot);
+		}
+		scene.freeSlot(extraSlot);
+		ANKI_TEST_EXPECT_EQ(scene.getAllocatedSlotCount(), 0);
+	}
+
+	GrManager::deleteInstance(gr);
+}
+
+} // end namespace anki
@@ -6,6 +6,7 @@
 #include <tests/framework/Framework.h>
 #include <anki/shader_compiler/ShaderProgramCompiler.h>
 #include <anki/util/ThreadHive.h>
+#include <anki/util/HashMap.h>
 
 ANKI_TEST(ShaderCompiler, ShaderProgramCompilerSimple)
 {
@@ -139,14 +140,70 @@ void main()
 	ShaderProgramBinaryWrapper binary(alloc);
 	BindlessLimits bindlessLimits;
 	GpuDeviceCapabilities gpuCapabilities;
-	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", fsystem, nullptr, &taskManager, alloc, gpuCapabilities,
-												 bindlessLimits, binary));
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", fsystem, nullptr, &taskManager, nullptr, alloc,
+												 gpuCapabilities, bindlessLimits, binary));
 
 #if 1
 	StringAuto dis(alloc);
 	dumpShaderProgramBinary(binary.getBinary(), dis);
 	ANKI_LOGI("Binary disassembly:\n%s\n", dis.cstr());
 #endif
+
+	// Compile twice with a SPIR-V cache. The 2nd time nothing should be compiled
+	class SpirvCache : public ShaderProgramSpirvCacheInterface
+	{
+	public:
+		HashMapAuto<U64, DynamicArrayAuto<U8>> m_entries;
+		GenericMemoryPoolAllocator<U8> m_alloc;
+		Mutex m_mtx;
+		U32 m_hitCount = 0;
+		U32 m_storeCount = 0;
+
+		SpirvCache(GenericMemoryPoolAllocator<U8> alloc)
+			: m_entries(alloc)
+			, m_alloc(alloc)
+		{
+		}
+
+		Bool find(U64 sourceHash, DynamicArrayAuto<U8>& spirv) final
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			auto it = m_entries.find(sourceHash);
+			if(it == m_entries.getEnd())
+			{
+				return false;
+			}
+
+			spirv.create(it->getSize());
+			memcpy(&spirv[0], &(*it)[0], it->getSizeInBytes());
+			++m_hitCount;
+			return true;
+		}
+
+		void store(U64 sourceHash, ConstWeakArray<U8> spirv) final
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			if(m_entries.find(sourceHash) == m_entries.getEnd())
+			{
+				auto it = m_entries.emplace(sourceHash, m_alloc);
+				it->create(spirv.getSize());
+				memcpy(&(*it)[0], &spirv[0], spirv.getSizeInBytes());
+			}
+			++m_storeCount;
+		}
+	} spirvCache(alloc);
+
+	ShaderProgramBinaryWrapper binary2(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", fsystem, nullptr, &taskManager, &spirvCache, alloc,
+												 gpuCapabilities, bindlessLimits, binary2));
+	const U32 storeCount = spirvCache.m_storeCount;
+	ANKI_TEST_EXPECT_GT(storeCount, 0);
+
+	ShaderProgramBinaryWrapper binary3(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", fsystem, nullptr, &taskManager, &spirvCache, alloc,
+												 gpuCapabilities, bindlessLimits, binary3));
+	ANKI_TEST_EXPECT_EQ(spirvCache.m_storeCount, storeCount);
+	ANKI_TEST_EXPECT_EQ(binary3.getBinary().m_codeBlocks.getSize(), binary.getBinary().m_codeBlocks.getSize());
 }
 
 ANKI_TEST(ShaderCompiler, ShaderProgramCompiler)
@@ -336,8 +393,8 @@ void main()
 	ShaderProgramBinaryWrapper binary(alloc);
 	BindlessLimits bindlessLimits;
 	GpuDeviceCapabilities gpuCapabilities;
-	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", fsystem, nullptr, &taskManager, alloc, gpuCapabilities,
-												 bindlessLimits, binary));
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", fsystem, nullptr, &taskManager, nullptr, alloc,
+												 gpuCapabilities, bindlessLimits, binary));
 
 #if 1
 	StringAuto dis(alloc);
@@ -345,3 +402,155 @@ void main()
 	ANKI_LOGI("Binary disassembly:\n%s\n", dis.cstr());
 #endif
 }
+
+ANKI_TEST(ShaderCompiler, ShaderProgramCompilerDedup)
+{
+	// COLOR is only used by the fragment shader so the vertex shader should be compiled only once
+	const CString sourceCode = R"(
+#pragma anki mutator COLOR 0 1 2
+
+#pragma anki start vert
+out gl_PerVertex
+{
+	Vec4 gl_Position;
+};
+
+void main()
+{
+	gl_Position = Vec4(gl_VertexID);
+}
+#pragma anki end
+
+#pragma anki start frag
+layout(location = 0) out Vec3 out_color;
+
+void main()
+{
+	out_color = Vec3(COLOR);
+}
+#pragma anki end
+	)";
+
+	// Write the file
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("test.glslp", FileOpenFlag::WRITE));
+		ANKI_TEST_EXPECT_NO_ERR(file.writeText(sourceCode));
+	}
+
+	class Fsystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			File file;
+			ANKI_CHECK(file.open(filename, FileOpenFlag::READ));
+			ANKI_CHECK(file.readAllText(txt));
+			return Error::NONE;
+		}
+	} fsystem;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const U32 threadCount = 8;
+	ThreadHive hive(threadCount, alloc);
+
+	class TaskManager : public ShaderProgramAsyncTaskInterface
+	{
+	public:
+		ThreadHive* m_hive = nullptr;
+		HeapAllocator<U8> m_alloc;
+
+		void enqueueTask(void (*callback)(void* userData), void* userData)
+		{
+			struct Ctx
+			{
+				void (*m_callback)(void* userData);
+				void* m_userData;
+				HeapAllocator<U8> m_alloc;
+			};
+			Ctx* ctx = m_alloc.newInstance<Ctx>();
+			ctx->m_callback = callback;
+			ctx->m_userData = userData;
+			ctx->m_alloc = m_alloc;
+
+			m_hive->submitTask(
+				[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+					Ctx* ctx = static_cast<Ctx*>(userData);
+					ctx->m_callback(ctx->m_userData);
+					auto alloc = ctx->m_alloc;
+					alloc.deleteInstance(ctx);
+				},
+				ctx);
+		}
+
+		Error joinTasks()
+		{
+			m_hive->waitAllTasks();
+			return Error::NONE;
+		}
+	} taskManager;
+	taskManager.m_hive = &hive;
+	taskManager.m_alloc = alloc;
+
+	// Every unique source is looked up in the cache and stored once. Count the lookups and the stores per stage
+	class SpirvCache : public ShaderProgramSpirvCacheInterface
+	{
+	public:
+		Mutex m_mtx;
+		U32 m_findCount = 0;
+		U32 m_storeCount = 0;
+
+		Bool find(U64 sourceHash, DynamicArrayAuto<U8>& spirv) final
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			++m_findCount;
+			return false;
+		}
+
+		void store(U64 sourceHash, ConstWeakArray<U8> spirv) final
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			++m_storeCount;
+		}
+	} spirvCache;
+
+	ShaderProgramBinaryWrapper binary(alloc);
+	BindlessLimits bindlessLimits;
+	GpuDeviceCapabilities gpuCapabilities;
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram("test.glslp", fsystem, nullptr, &taskManager, &spirvCache, alloc,
+												 gpuCapabilities, bindlessLimits, binary));
+
+	// 3 variants with 2 stages each. 1 unique vertex and 3 unique fragment shaders, the other 2 are duplicates
+	const ShaderProgramBinary& bin = binary.getBinary();
+	const U32 variantCount = 3;
+	const U32 uniqueCount = 1 + variantCount;
+	const U32 duplicateCount = variantCount * 2 - uniqueCount;
+	ANKI_TEST_EXPECT_EQ(bin.m_variants.getSize(), variantCount);
+	ANKI_TEST_EXPECT_EQ(spirvCache.m_findCount, uniqueCount);
+	ANKI_TEST_EXPECT_EQ(spirvCache.m_storeCount, uniqueCount);
+	ANKI_TEST_EXPECT_EQ(bin.m_codeBlocks.getSize(), uniqueCount);
+
+	// All variants share the vertex shader and each has its own fragment shader
+	const U32 vertCodeBlock = bin.m_variants[0].m_codeBlockIndices[ShaderType::VERTEX];
+	for(const ShaderProgramBinaryVariant& variant : bin.m_variants)
+	{
+		ANKI_TEST_EXPECT_EQ(variant.m_codeBlockIndices[ShaderType::VERTEX], vertCodeBlock);
+		ANKI_TEST_EXPECT_NEQ(variant.m_codeBlockIndices[ShaderType::FRAGMENT], vertCodeBlock);
+	}
+
+	// Count the shaders that point to a code block that an earlier shader uses
+	Array<Bool, 8> codeBlockUsed = {};
+	U32 sharedCount = 0;
+	for(const ShaderProgramBinaryVariant& variant : bin.m_variants)
+	{
+		for(ShaderType shaderType : {ShaderType::VERTEX, ShaderType::FRAGMENT})
+		{
+			const U32 idx = variant.m_codeBlockIndices[shaderType];
+			ANKI_TEST_EXPECT_LT(idx, bin.m_codeBlocks.getSize());
+			sharedCount += codeBlockUsed[idx];
+			codeBlockUsed[idx] = true;
+		}
+	}
+	ANKI_TEST_EXPECT_EQ(sharedCount, duplicateCount);
+}
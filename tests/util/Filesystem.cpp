@@ -53,6 +53,26 @@ ANKI_TEST(Util, Directory)
 	ANKI_TEST_EXPECT_EQ(directoryExists("./dir"), false);
 }
 
+ANKI_TEST(Util, RenameFile)
+{
+	File file;
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_old", FileOpenFlag::WRITE));
+	ANKI_TEST_EXPECT_NO_ERR(file.writeText("old"));
+	file.close();
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_new", FileOpenFlag::WRITE));
+	ANKI_TEST_EXPECT_NO_ERR(file.writeText("new!"));
+	file.close();
+
+	// The destination is replaced
+	ANKI_TEST_EXPECT_NO_ERR(renameFile("./tmp_old", "./tmp_new"));
+	ANKI_TEST_EXPECT_EQ(fileExists("./tmp_old"), false);
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./tmp_new", FileOpenFlag::READ));
+	ANKI_TEST_EXPECT_EQ(file.getSize(), 3);
+	file.close();
+
+	ANKI_TEST_EXPECT_ERR(renameFile("./tmp_old", "./tmp_new"), Error::FUNCTION_FAILED);
+}
+
 ANKI_TEST(Util, HomeDir)
 {
 	HeapAllocator<char> alloc(allocAligned, nullptr);
@@ -0,0 +1,97 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/RadixSort.h>
+#include <anki/util/ThreadHive.h>
+#include <vector>
+#include <algorithm>
+
+namespace anki
+{
+
+/// Some keys with only a few bytes that change, like the sort keys of the renderables.
+static void generatePairs(U32 count, U32 seed, std::vector<RadixSortPair>& pairs)
+{
+	pairs.resize(count);
+	U64 x = seed;
+	for(U32 i = 0; i < count; ++i)
+	{
+		x = x * 6364136223846793005ull + 1442695040888963407ull;
+		pairs[i].m_key = (x >> 16) & 0xFF00FF00FFFF00FFull;
+		pairs[i].m_index = i;
+		pairs[i].m_padding = 0;
+	}
+}
+
+static void checkSorted(std::vector<RadixSortPair> unsorted, ConstWeakArray<RadixSortPair> sorted)
+{
+	// Radix sort is stable so it should match the stable sort
+	std::stable_sort(unsorted.begin(), unsorted.end(),
+					 [](const RadixSortPair& a, const RadixSortPair& b) { return a.m_key < b.m_key; });
+
+	ANKI_TEST_EXPECT_EQ(sorted.getSize(), unsorted.size());
+	for(U32 i = 0; i < sorted.getSize(); ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(sorted[i].m_key, unsorted[i].m_key);
+		ANKI_TEST_EXPECT_EQ(sorted[i].m_index, unsorted[i].m_index);
+	}
+}
+
+ANKI_TEST(Util, RadixSort)
+{
+	// Serial
+	for(U32 count : {1u, 2u, 100u, 10000u})
+	{
+		std::vector<RadixSortPair> unsorted;
+		generatePairs(count, count, unsorted);
+
+		std::vector<RadixSortPair> pairs = unsorted;
+		std::vector<RadixSortPair> scratch(count);
+		const WeakArray<RadixSortPair> sorted =
+			radixSort(WeakArray<RadixSortPair>(&pairs[0], count), WeakArray<RadixSortPair>(&scratch[0], count));
+
+		checkSorted(unsorted, sorted);
+	}
+
+	// All keys are the same, nothing to do
+	{
+		std::vector<RadixSortPair> pairs(10);
+		for(U32 i = 0; i < pairs.size(); ++i)
+		{
+			pairs[i].m_key = 123;
+			pairs[i].m_index = i;
+		}
+
+		std::vector<RadixSortPair> scratch(pairs.size());
+		const WeakArray<RadixSortPair> sorted = radixSort(WeakArray<RadixSortPair>(&pairs[0], U32(pairs.size())),
+														  WeakArray<RadixSortPair>(&scratch[0], U32(scratch.size())));
+		ANKI_TEST_EXPECT_EQ(sorted.getBegin(), &pairs[0]);
+		ANKI_TEST_EXPECT_EQ(sorted[9].m_index, 9);
+	}
+
+	// Parallel
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StackAllocator<U8> stackAlloc(allocAligned, nullptr, 64 * 1024);
+	ThreadHive hive(4, alloc);
+
+	for(U32 count : {100u, 50000u, 200000u})
+	{
+		std::vector<RadixSortPair> unsorted;
+		generatePairs(count, count, unsorted);
+
+		std::vector<RadixSortPair> pairs = unsorted;
+		std::vector<RadixSortPair> scratch(count);
+		WeakArray<RadixSortPair> sorted;
+		ThreadHiveSemaphore* doneSemaphore;
+		radixSort(hive, stackAlloc, WeakArray<RadixSortPair>(&pairs[0], count),
+				  WeakArray<RadixSortPair>(&scratch[0], count), sorted, doneSemaphore);
+		hive.waitAllTasks();
+
+		checkSorted(unsorted, sorted);
+	}
+}
+
+} // end namespace anki
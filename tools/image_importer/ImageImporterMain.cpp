@@ -0,0 +1,243 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/importer/ImageImporter.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/System.h>
+
+using namespace anki;
+
+static const char* USAGE = R"(Usage: %s [options] -i <in_file(s)> -o <out_file>
+Options:
+-t <2D|cube|2DArray>   : The type of the texture. Default: 2D
+-format <R|RG|RGB|RGBA> : The channels to store. Default: RGB or RGBA depending on the alpha of the images
+-no-alpha <0|1>        : Drop the alpha channel. Default: 0
+-normal <0|1>          : The images are normal maps. Default: 0
+-srgb <0|1>            : The images are sRGB. Mips will be filtered in linear space. Default: 1
+-store-raw <0|1>       : Store uncompressed data. Default: 0
+-store-s3tc <0|1>      : Store S3TC compressed data. Default: 1
+-store-s3tc-zlib <0|1> : Store supercompressed S3TC data. Default: 0
+-store-bc7 <0|1>       : Store BC7 compressed data. Only for RGB and RGBA. Default: 0
+-store-astc <0|1>      : Store ASTC 4x4 compressed data. Only for RGB and RGBA. Default: 0
+-mip-count <N>         : Max number of mipmaps. Default: all
+-force <0|1>           : Import even if the output is up-to-date. Default: 0
+-j <thread_count>      : Number of threads. Defaults to system's max
+)";
+
+class CmdLineArgs
+{
+public:
+	HeapAllocator<U8> m_alloc = {allocAligned, nullptr};
+	DynamicArrayAuto<CString> m_inputFnames = {m_alloc};
+	CString m_outFname;
+	ImageLoaderTextureType m_type = ImageLoaderTextureType::_2D;
+	ImageLoaderColorFormat m_colorFormat = ImageLoaderColorFormat::NONE;
+	Bool m_noAlpha = false;
+	Bool m_normal = false;
+	Bool m_sRgb = true;
+	Bool m_storeRaw = false;
+	Bool m_storeS3tc = true;
+	Bool m_storeS3tcZlib = false;
+	Bool m_storeBc7 = false;
+	Bool m_storeAstc = false;
+	Bool m_force = false;
+	U32 m_mipCount = MAX_U32;
+	U32 m_threadCount = getCpuCoresCount();
+};
+
+static Error parseBool(CString str, Bool& out)
+{
+	I32 val = 0;
+	ANKI_CHECK(str.toNumber(val));
+	out = val != 0;
+	return Error::NONE;
+}
+
+static Error parseCommandLineArgs(int argc, char** argv, CmdLineArgs& info)
+{
+	for(I32 i = 1; i < argc; i++)
+	{
+		const CString arg = argv[i];
+
+		if(arg == "-i")
+		{
+			while(i + 1 < argc && argv[i + 1][0] != '-')
+			{
+				info.m_inputFnames.emplaceBack(argv[++i]);
+			}
+			continue;
+		}
+
+		// All the other options have a value
+		if(++i >= argc)
+		{
+			return Error::USER_DATA;
+		}
+		const CString val = argv[i];
+
+		if(arg == "-o")
+		{
+			info.m_outFname = val;
+		}
+		else if(arg == "-t")
+		{
+			if(val == "2D")
+			{
+				info.m_type = ImageLoaderTextureType::_2D;
+			}
+			else if(val == "cube")
+			{
+				info.m_type = ImageLoaderTextureType::CUBE;
+			}
+			else if(val == "2DArray")
+			{
+				info.m_type = ImageLoaderTextureType::_2D_ARRAY;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(arg == "-format")
+		{
+			if(val == "R")
+			{
+				info.m_colorFormat = ImageLoaderColorFormat::R8;
+			}
+			else if(val == "RG")
+			{
+				info.m_colorFormat = ImageLoaderColorFormat::RG8;
+			}
+			else if(val == "RGB")
+			{
+				info.m_colorFormat = ImageLoaderColorFormat::RGB8;
+			}
+			else if(val == "RGBA")
+			{
+				info.m_colorFormat = ImageLoaderColorFormat::RGBA8;
+			}
+			else
+			{
+				return Error::USER_DATA;
+			}
+		}
+		else if(arg == "-no-alpha")
+		{
+			ANKI_CHECK(parseBool(val, info.m_noAlpha));
+		}
+		else if(arg == "-normal")
+		{
+			ANKI_CHECK(parseBool(val, info.m_normal));
+		}
+		else if(arg == "-srgb")
+		{
+			ANKI_CHECK(parseBool(val, info.m_sRgb));
+		}
+		else if(arg == "-store-raw")
+		{
+			ANKI_CHECK(parseBool(val, info.m_storeRaw));
+		}
+		else if(arg == "-store-s3tc")
+		{
+			ANKI_CHECK(parseBool(val, info.m_storeS3tc));
+		}
+		else if(arg == "-store-s3tc-zlib")
+		{
+			ANKI_CHECK(parseBool(val, info.m_storeS3tcZlib));
+		}
+		else if(arg == "-store-bc7")
+		{
+			ANKI_CHECK(parseBool(val, info.m_storeBc7));
+		}
+		else if(arg == "-store-astc")
+		{
+			ANKI_CHECK(parseBool(val, info.m_storeAstc));
+		}
+		else if(arg == "-force")
+		{
+			ANKI_CHECK(parseBool(val, info.m_force));
+		}
+		else if(arg == "-mip-count")
+		{
+			ANKI_CHECK(val.toNumber(info.m_mipCount));
+		}
+		else if(arg == "-j")
+		{
+			ANKI_CHECK(val.toNumber(info.m_threadCount));
+		}
+		else
+		{
+			return Error::USER_DATA;
+		}
+	}
+
+	if(info.m_inputFnames.getSize() == 0 || info.m_outFname.isEmpty()
+	   || (!info.m_storeRaw && !info.m_storeS3tc && !info.m_storeS3tcZlib && !info.m_storeBc7 && !info.m_storeAstc))
+	{
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+int main(int argc, char** argv)
+{
+	CmdLineArgs cmdArgs;
+	if(parseCommandLineArgs(argc, argv, cmdArgs))
+	{
+		ANKI_IMPORTER_LOGE(USAGE, argv[0]);
+		return 1;
+	}
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive* hive =
+		(cmdArgs.m_threadCount) ? alloc.newInstance<ThreadHive>(cmdArgs.m_threadCount, alloc, true) : nullptr;
+
+	ImageImporterConfig config;
+	config.m_allocator = alloc;
+	config.m_inputFilenames = ConstWeakArray<CString>(&cmdArgs.m_inputFnames[0], cmdArgs.m_inputFnames.getSize());
+	config.m_outFilename = cmdArgs.m_outFname;
+	config.m_type = cmdArgs.m_type;
+	config.m_colorFormat = cmdArgs.m_colorFormat;
+	config.m_compressions = ImageLoaderDataCompression::NONE;
+	if(cmdArgs.m_storeRaw)
+	{
+		config.m_compressions |= ImageLoaderDataCompression::RAW;
+	}
+	if(cmdArgs.m_storeS3tc)
+	{
+		config.m_compressions |= ImageLoaderDataCompression::S3TC;
+	}
+	if(cmdArgs.m_storeS3tcZlib)
+	{
+		config.m_compressions |= ImageLoaderDataCompression::S3TC_ZLIB;
+	}
+	if(cmdArgs.m_storeBc7)
+	{
+		config.m_compressions |= ImageLoaderDataCompression::BC7;
+	}
+	if(cmdArgs.m_storeAstc)
+	{
+		config.m_compressions |= ImageLoaderDataCompression::ASTC;
+	}
+	config.m_mipmapCount = cmdArgs.m_mipCount;
+	config.m_noAlpha = cmdArgs.m_noAlpha;
+	config.m_normalMap = cmdArgs.m_normal;
+	config.m_sRgbInput = cmdArgs.m_sRgb;
+	config.m_ignoreCache = cmdArgs.m_force;
+	config.m_hive = hive;
+
+	const Error err = importImage(config);
+
+	alloc.deleteInstance(hive);
+
+	if(err)
+	{
+		ANKI_IMPORTER_LOGE("Failed");
+		return 1;
+	}
+
+	return 0;
+}